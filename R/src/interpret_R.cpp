@@ -360,6 +360,43 @@ IntegerDataType * ConvertDoublesToIndexes(const SEXP items, size_t * const pcIte
    return aItems;
 }
 
+// binned data can be large, so rather than copying it into IntegerDataType we check that every item is a valid index and then hand R's doubles to
+// the core in place as BinnedDataTypeFloat64
+const double * CheckDoublesAreIndexes(const SEXP items, size_t * const pcItems) {
+   EBM_ASSERT(nullptr != items);
+   EBM_ASSERT(nullptr != pcItems);
+   if(REALSXP != TYPEOF(items)) {
+      LOG_0(TraceLevelError, "ERROR CheckDoublesAreIndexes REALSXP != TYPEOF(items)");
+      return nullptr;
+   }
+   const R_xlen_t countItemsR = xlength(items);
+   if(!IsNumberConvertable<size_t, R_xlen_t>(countItemsR)) {
+      LOG_0(TraceLevelError, "ERROR CheckDoublesAreIndexes !IsNumberConvertable<size_t, R_xlen_t>(countItemsR)");
+      return nullptr;
+   }
+   const size_t cItems = static_cast<size_t>(countItemsR);
+   if(!IsNumberConvertable<IntegerDataType, size_t>(cItems)) {
+      LOG_0(TraceLevelError, "ERROR CheckDoublesAreIndexes !IsNumberConvertable<IntegerDataType, size_t>(cItems)");
+      return nullptr;
+   }
+   *pcItems = cItems;
+
+   const double * aItems = static_cast<const double *>(INVALID_POINTER);
+   if(0 != cItems) {
+      aItems = REAL(items);
+      const double * pItem = aItems;
+      const double * const pItemEnd = aItems + cItems;
+      do {
+         if(!IsDoubleToIntegerDataTypeIndexValid(*pItem)) {
+            LOG_0(TraceLevelError, "ERROR CheckDoublesAreIndexes !IsDoubleToIntegerDataTypeIndexValid(*pItem)");
+            return nullptr;
+         }
+         ++pItem;
+      } while(pItemEnd != pItem);
+   }
+   return aItems;
+}
+
 FractionalDataType * ConvertDoublesToDoubles(const SEXP items, size_t * const pcItems) {
    EBM_ASSERT(nullptr != items);
    EBM_ASSERT(nullptr != pcItems);
@@ -469,7 +506,7 @@ SEXP InitializeTrainingRegression_R(
    const IntegerDataType countTrainingTargets = static_cast<IntegerDataType>(cTrainingInstances);
 
    size_t cTrainingBinnedData;
-   IntegerDataType * const aTrainingBinnedData = ConvertDoublesToIndexes(trainingBinnedData, &cTrainingBinnedData);
+   const double * const aTrainingBinnedData = CheckDoublesAreIndexes(trainingBinnedData, &cTrainingBinnedData);
    if(nullptr == aTrainingBinnedData) {
       // we've already logged any errors
       return R_NilValue;
@@ -506,7 +543,7 @@ SEXP InitializeTrainingRegression_R(
    const IntegerDataType countValidationTargets = static_cast<IntegerDataType>(cValidationInstances);
 
    size_t cValidationBinnedData;
-   IntegerDataType * const aValidationBinnedData = ConvertDoublesToIndexes(validationBinnedData, &cValidationBinnedData);
+   const double * const aValidationBinnedData = CheckDoublesAreIndexes(validationBinnedData, &cValidationBinnedData);
    if(nullptr == aValidationBinnedData) {
       // we've already logged any errors
       return R_NilValue;
@@ -545,7 +582,10 @@ SEXP InitializeTrainingRegression_R(
    }
    IntegerDataType countInnerBagsLocal = static_cast<IntegerDataType>(countInnerBagsInt);
 
-   PEbmTraining pEbmTraining = InitializeTrainingRegression(randomSeedLocal, countFeatures, aFeatures, countFeatureCombinations, aFeatureCombinations, aFeatureCombinationIndexes, countTrainingTargets, aTrainingTargets, aTrainingBinnedData, aTrainingPredictorScores, countValidationTargets, aValidationTargets, aValidationBinnedData, aValidationPredictorScores, countInnerBagsLocal);
+   // R stores its matrices one column after another, so each feature is a run of doubles that the core can read in place
+   const EbmCoreBinnedData trainingBinnedDataStrided = { BinnedDataTypeFloat64, 1, countTrainingTargets, aTrainingBinnedData };
+   const EbmCoreBinnedData validationBinnedDataStrided = { BinnedDataTypeFloat64, 1, countValidationTargets, aValidationBinnedData };
+   PEbmTraining pEbmTraining = InitializeTrainingRegressionStrided(randomSeedLocal, countFeatures, aFeatures, countFeatureCombinations, aFeatureCombinations, aFeatureCombinationIndexes, countTrainingTargets, aTrainingTargets, &trainingBinnedDataStrided, aTrainingPredictorScores, countValidationTargets, aValidationTargets, &validationBinnedDataStrided, aValidationPredictorScores, countInnerBagsLocal);
 
    if(nullptr == pEbmTraining) {
       return R_NilValue;
@@ -652,7 +692,7 @@ SEXP InitializeTrainingClassification_R(
    const IntegerDataType countTrainingTargets = static_cast<IntegerDataType>(cTrainingInstances);
 
    size_t cTrainingBinnedData;
-   IntegerDataType * const aTrainingBinnedData = ConvertDoublesToIndexes(trainingBinnedData, &cTrainingBinnedData);
+   const double * const aTrainingBinnedData = CheckDoublesAreIndexes(trainingBinnedData, &cTrainingBinnedData);
    if(nullptr == aTrainingBinnedData) {
       // we've already logged any errors
       return R_NilValue;
@@ -693,7 +733,7 @@ SEXP InitializeTrainingClassification_R(
    const IntegerDataType countValidationTargets = static_cast<IntegerDataType>(cValidationInstances);
 
    size_t cValidationBinnedData;
-   IntegerDataType * const aValidationBinnedData = ConvertDoublesToIndexes(validationBinnedData, &cValidationBinnedData);
+   const double * const aValidationBinnedData = CheckDoublesAreIndexes(validationBinnedData, &cValidationBinnedData);
    if(nullptr == aValidationBinnedData) {
       // we've already logged any errors
       return R_NilValue;
@@ -736,7 +776,10 @@ SEXP InitializeTrainingClassification_R(
    }
    IntegerDataType countInnerBagsLocal = static_cast<IntegerDataType>(countInnerBagsInt);
 
-   PEbmTraining pEbmTraining = InitializeTrainingClassification(randomSeedLocal, countFeatures, aFeatures, countFeatureCombinations, aFeatureCombinations, aFeatureCombinationIndexes, static_cast<IntegerDataType>(cTargetClasses), countTrainingTargets, aTrainingTargets, aTrainingBinnedData, aTrainingPredictorScores, countValidationTargets, aValidationTargets, aValidationBinnedData, aValidationPredictorScores, countInnerBagsLocal);
+   // R stores its matrices one column after another, so each feature is a run of doubles that the core can read in place
+   const EbmCoreBinnedData trainingBinnedDataStrided = { BinnedDataTypeFloat64, 1, countTrainingTargets, aTrainingBinnedData };
+   const EbmCoreBinnedData validationBinnedDataStrided = { BinnedDataTypeFloat64, 1, countValidationTargets, aValidationBinnedData };
+   PEbmTraining pEbmTraining = InitializeTrainingClassificationStrided(randomSeedLocal, countFeatures, aFeatures, countFeatureCombinations, aFeatureCombinations, aFeatureCombinationIndexes, static_cast<IntegerDataType>(cTargetClasses), countTrainingTargets, aTrainingTargets, &trainingBinnedDataStrided, aTrainingPredictorScores, countValidationTargets, aValidationTargets, &validationBinnedDataStrided, aValidationPredictorScores, countInnerBagsLocal);
 
    if(nullptr == pEbmTraining) {
       return R_NilValue;
@@ -1043,7 +1086,7 @@ SEXP InitializeInteractionRegression_R(
    const IntegerDataType countInstances = static_cast<IntegerDataType>(cInstances);
 
    size_t cBinnedData;
-   IntegerDataType * const aBinnedData = ConvertDoublesToIndexes(binnedData, &cBinnedData);
+   const double * const aBinnedData = CheckDoublesAreIndexes(binnedData, &cBinnedData);
    if(nullptr == aBinnedData) {
       // we've already logged any errors
       return R_NilValue;
@@ -1071,7 +1114,9 @@ SEXP InitializeInteractionRegression_R(
       }
    }
 
-   PEbmInteraction pEbmInteraction = InitializeInteractionRegression(countFeatures, aFeatures, countInstances, aTargets, aBinnedData, aPredictorScores);
+   // R stores its matrices one column after another, so each feature is a run of doubles that the core can read in place
+   const EbmCoreBinnedData binnedDataStrided = { BinnedDataTypeFloat64, 1, countInstances, aBinnedData };
+   PEbmInteraction pEbmInteraction = InitializeInteractionRegressionStrided(countFeatures, aFeatures, countInstances, aTargets, &binnedDataStrided, aPredictorScores);
 
    if(nullptr == pEbmInteraction) {
       return R_NilValue;
@@ -1132,7 +1177,7 @@ SEXP InitializeInteractionClassification_R(
    const IntegerDataType countInstances = static_cast<IntegerDataType>(cInstances);
 
    size_t cBinnedData;
-   IntegerDataType * const aBinnedData = ConvertDoublesToIndexes(binnedData, &cBinnedData);
+   const double * const aBinnedData = CheckDoublesAreIndexes(binnedData, &cBinnedData);
    if(nullptr == aBinnedData) {
       // we've already logged any errors
       return R_NilValue;
@@ -1164,7 +1209,9 @@ SEXP InitializeInteractionClassification_R(
       }
    }
 
-   PEbmInteraction pEbmInteraction = InitializeInteractionClassification(countFeatures, aFeatures, static_cast<IntegerDataType>(cTargetClasses), countInstances, aTargets, aBinnedData, aPredictorScores);
+   // R stores its matrices one column after another, so each feature is a run of doubles that the core can read in place
+   const EbmCoreBinnedData binnedDataStrided = { BinnedDataTypeFloat64, 1, countInstances, aBinnedData };
+   PEbmInteraction pEbmInteraction = InitializeInteractionClassificationStrided(countFeatures, aFeatures, static_cast<IntegerDataType>(cTargetClasses), countInstances, aTargets, &binnedDataStrided, aPredictorScores);
 
    if(nullptr == pEbmInteraction) {
       return R_NilValue;
@@ -6,14 +6,34 @@ os_type=`uname`
 root_path=`dirname "$0"`
 
 build_32_bit=0
+float_residuals=0
+test_hooks=0
 for arg in "$@"; do
    if [ "$arg" = "-32bit" ]; then
       build_32_bit=1
    fi
+   if [ "$arg" = "-float_residuals" ]; then
+      float_residuals=1
+   fi
+   if [ "$arg" = "-test_hooks" ]; then
+      test_hooks=1
+   fi
 done
 
 # re-enable these warnings when they are better supported by g++ or clang: -Wduplicated-cond -Wduplicated-branches -Wrestrict
-compile_all="\"$root_path/core/DataSetByFeature.cpp\" \"$root_path/core/DataSetByFeatureCombination.cpp\" \"$root_path/core/InteractionDetection.cpp\" \"$root_path/core/Logging.cpp\" \"$root_path/core/SamplingWithReplacement.cpp\" \"$root_path/core/Training.cpp\" -I\"$root_path/core\" -I\"$root_path/core/inc\" -Wall -Wextra -Wno-parentheses -Wold-style-cast -Wdouble-promotion -Wshadow -Wformat=2 -std=c++11 -fvisibility=hidden -fvisibility-inlines-hidden -O3 -march=core2 -DEBMCORE_EXPORTS -fpic"
+compile_all="\"$root_path/core/ArenaAllocator.cpp\" \"$root_path/core/DataSetByFeature.cpp\" \"$root_path/core/DataSetByFeatureCombination.cpp\" \"$root_path/core/EbmDataSet.cpp\" \"$root_path/core/EbmModel.cpp\" \"$root_path/core/EnsembleTraining.cpp\" \"$root_path/core/FileMapping.cpp\" \"$root_path/core/InteractionDetection.cpp\" \"$root_path/core/IsaKernels.cpp\" \"$root_path/core/IsaKernelsAvx2.cpp\" \"$root_path/core/IsaKernelsAvx512.cpp\" \"$root_path/core/Logging.cpp\" \"$root_path/core/SamplingWithReplacement.cpp\" \"$root_path/core/Scoring.cpp\" \"$root_path/core/Training.cpp\" \"$root_path/core/ThreadPool.cpp\" -I\"$root_path/core\" -I\"$root_path/core/inc\" -Wall -Wextra -Wno-parentheses -Wold-style-cast -Wdouble-promotion -Wshadow -Wformat=2 -std=c++11 -pthread -fvisibility=hidden -fvisibility-inlines-hidden -O3 -march=core2 -DEBMCORE_EXPORTS -fpic"
+library_suffix=""
+if [ $float_residuals -eq 1 ]; then
+   # store the per-instance residuals and predictor scores in single precision.  Sums and the model stay in double precision
+   compile_all="$compile_all -DEBM_FLOAT_RESIDUALS"
+   # the float build gets its own file names so that it can't be mistaken for, or overwrite, the double build
+   library_suffix="_float"
+fi
+if [ $test_hooks -eq 1 ]; then
+   # adds the diagnostic functions that only our tests call (see ebmcore_test_hooks.h).  This build gets its own file names so that it never ships
+   compile_all="$compile_all -DEBM_TEST_HOOKS"
+   library_suffix="${library_suffix}_test"
+fi
 
 if [ "$os_type" = "Darwin" ]; then
    # reference on rpath & install_name: https://www.mikeash.com/pyblog/friday-qa-2009-11-06-linking-and-install-names.html
@@ -44,7 +64,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$clang_pp_bin $compile_mac -m64 -DNDEBUG -install_name @rpath/lib_ebmcore_mac_x64.dylib -o \"$root_path/tmp/clang/bin/release/mac/x64/ebmcore/lib_ebmcore_mac_x64.dylib\" 2>&1"
+   compile_command="$clang_pp_bin $compile_mac -m64 -DNDEBUG -install_name @rpath/lib_ebmcore_mac_x64${library_suffix}.dylib -o \"$root_path/tmp/clang/bin/release/mac/x64/ebmcore/lib_ebmcore_mac_x64${library_suffix}.dylib\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    printf "%s\n" "$compile_out"
@@ -52,12 +72,12 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/tmp/clang/bin/release/mac/x64/ebmcore/lib_ebmcore_mac_x64.dylib" "$root_path/python/interpret-core/interpret/lib/"
+   cp "$root_path/tmp/clang/bin/release/mac/x64/ebmcore/lib_ebmcore_mac_x64${library_suffix}.dylib" "$root_path/python/interpret-core/interpret/lib/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/tmp/clang/bin/release/mac/x64/ebmcore/lib_ebmcore_mac_x64.dylib" "$root_path/staging/"
+   cp "$root_path/tmp/clang/bin/release/mac/x64/ebmcore/lib_ebmcore_mac_x64${library_suffix}.dylib" "$root_path/staging/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -74,7 +94,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$clang_pp_bin $compile_mac -m64 -install_name @rpath/lib_ebmcore_mac_x64_debug.dylib -o \"$root_path/tmp/clang/bin/debug/mac/x64/ebmcore/lib_ebmcore_mac_x64_debug.dylib\" 2>&1"
+   compile_command="$clang_pp_bin $compile_mac -m64 -install_name @rpath/lib_ebmcore_mac_x64${library_suffix}_debug.dylib -o \"$root_path/tmp/clang/bin/debug/mac/x64/ebmcore/lib_ebmcore_mac_x64${library_suffix}_debug.dylib\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    printf "%s\n" "$compile_out"
@@ -82,12 +102,12 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/tmp/clang/bin/debug/mac/x64/ebmcore/lib_ebmcore_mac_x64_debug.dylib" "$root_path/python/interpret-core/interpret/lib/"
+   cp "$root_path/tmp/clang/bin/debug/mac/x64/ebmcore/lib_ebmcore_mac_x64${library_suffix}_debug.dylib" "$root_path/python/interpret-core/interpret/lib/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/tmp/clang/bin/debug/mac/x64/ebmcore/lib_ebmcore_mac_x64_debug.dylib" "$root_path/staging/"
+   cp "$root_path/tmp/clang/bin/debug/mac/x64/ebmcore/lib_ebmcore_mac_x64${library_suffix}_debug.dylib" "$root_path/staging/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -105,7 +125,7 @@ if [ "$os_type" = "Darwin" ]; then
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      compile_command="$clang_pp_bin $compile_mac -m32 -DNDEBUG -install_name @rpath/lib_ebmcore_mac_x86.dylib -o \"$root_path/tmp/clang/bin/release/mac/x86/ebmcore/lib_ebmcore_mac_x86.dylib\" 2>&1"
+      compile_command="$clang_pp_bin $compile_mac -m32 -DNDEBUG -install_name @rpath/lib_ebmcore_mac_x86${library_suffix}.dylib -o \"$root_path/tmp/clang/bin/release/mac/x86/ebmcore/lib_ebmcore_mac_x86${library_suffix}.dylib\" 2>&1"
       compile_out=`eval $compile_command`
       ret_code=$?
       printf "%s\n" "$compile_out"
@@ -113,12 +133,12 @@ if [ "$os_type" = "Darwin" ]; then
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      cp "$root_path/tmp/clang/bin/release/mac/x86/ebmcore/lib_ebmcore_mac_x86.dylib" "$root_path/python/interpret-core/interpret/lib/"
+      cp "$root_path/tmp/clang/bin/release/mac/x86/ebmcore/lib_ebmcore_mac_x86${library_suffix}.dylib" "$root_path/python/interpret-core/interpret/lib/"
       ret_code=$?
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      cp "$root_path/tmp/clang/bin/release/mac/x86/ebmcore/lib_ebmcore_mac_x86.dylib" "$root_path/staging/"
+      cp "$root_path/tmp/clang/bin/release/mac/x86/ebmcore/lib_ebmcore_mac_x86${library_suffix}.dylib" "$root_path/staging/"
       ret_code=$?
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
@@ -135,7 +155,7 @@ if [ "$os_type" = "Darwin" ]; then
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      compile_command="$clang_pp_bin $compile_mac -m32 -install_name @rpath/lib_ebmcore_mac_x86_debug.dylib -o \"$root_path/tmp/clang/bin/debug/mac/x86/ebmcore/lib_ebmcore_mac_x86_debug.dylib\" 2>&1"
+      compile_command="$clang_pp_bin $compile_mac -m32 -install_name @rpath/lib_ebmcore_mac_x86${library_suffix}_debug.dylib -o \"$root_path/tmp/clang/bin/debug/mac/x86/ebmcore/lib_ebmcore_mac_x86${library_suffix}_debug.dylib\" 2>&1"
       compile_out=`eval $compile_command`
       ret_code=$?
       printf "%s\n" "$compile_out"
@@ -143,12 +163,12 @@ if [ "$os_type" = "Darwin" ]; then
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      cp "$root_path/tmp/clang/bin/debug/mac/x86/ebmcore/lib_ebmcore_mac_x86_debug.dylib" "$root_path/python/interpret-core/interpret/lib/"
+      cp "$root_path/tmp/clang/bin/debug/mac/x86/ebmcore/lib_ebmcore_mac_x86${library_suffix}_debug.dylib" "$root_path/python/interpret-core/interpret/lib/"
       ret_code=$?
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      cp "$root_path/tmp/clang/bin/debug/mac/x86/ebmcore/lib_ebmcore_mac_x86_debug.dylib" "$root_path/staging/"
+      cp "$root_path/tmp/clang/bin/debug/mac/x86/ebmcore/lib_ebmcore_mac_x86${library_suffix}_debug.dylib" "$root_path/staging/"
       ret_code=$?
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
@@ -159,7 +179,14 @@ elif [ "$os_type" = "Linux" ]; then
    # to cross compile for different architectures x86/x64, run the following command: sudo apt-get install g++-multilib
 
    # try moving some of these g++ specific warnings into compile_all if clang eventually supports them
-   compile_linux="$compile_all -Wlogical-op -Wl,--version-script=\"$root_path/core/ebmcore_exports.txt\" -Wl,--exclude-libs,ALL -Wl,--wrap=memcpy \"$root_path/core/wrap_func.cpp\" -static-libgcc -static-libstdc++ -shared"
+   compile_linux="$compile_all -Wlogical-op -Wl,--exclude-libs,ALL -Wl,--wrap=memcpy \"$root_path/core/wrap_func.cpp\" -static-libgcc -static-libstdc++ -shared"
+   if [ $test_hooks -eq 1 ]; then
+      # count every allocation the library makes so that the tests can check that steady state training doesn't allocate.  The hooks aren't in
+      # ebmcore_exports.txt, so this build relies on -fvisibility=hidden alone to limit what it exports
+      compile_linux="$compile_linux -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -Wl,--wrap=mmap -DEBM_COUNT_HEAP_ALLOCATIONS"
+   else
+      compile_linux="$compile_linux -Wl,--version-script=\"$root_path/core/ebmcore_exports.txt\""
+   fi
 
    printf "%s\n" "Creating initial directories"
    [ -d "$root_path/staging" ] || mkdir -p "$root_path/staging"
@@ -184,7 +211,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$g_pp_bin $compile_linux -m64 -DNDEBUG -o \"$root_path/tmp/gcc/bin/release/linux/x64/ebmcore/lib_ebmcore_linux_x64.so\" 2>&1"
+   compile_command="$g_pp_bin $compile_linux -m64 -DNDEBUG -o \"$root_path/tmp/gcc/bin/release/linux/x64/ebmcore/lib_ebmcore_linux_x64${library_suffix}.so\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    printf "%s\n" "$compile_out"
@@ -192,12 +219,12 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/tmp/gcc/bin/release/linux/x64/ebmcore/lib_ebmcore_linux_x64.so" "$root_path/python/interpret-core/interpret/lib/"
+   cp "$root_path/tmp/gcc/bin/release/linux/x64/ebmcore/lib_ebmcore_linux_x64${library_suffix}.so" "$root_path/python/interpret-core/interpret/lib/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/tmp/gcc/bin/release/linux/x64/ebmcore/lib_ebmcore_linux_x64.so" "$root_path/staging/"
+   cp "$root_path/tmp/gcc/bin/release/linux/x64/ebmcore/lib_ebmcore_linux_x64${library_suffix}.so" "$root_path/staging/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -214,7 +241,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$g_pp_bin $compile_linux -m64 -o \"$root_path/tmp/gcc/bin/debug/linux/x64/ebmcore/lib_ebmcore_linux_x64_debug.so\" 2>&1"
+   compile_command="$g_pp_bin $compile_linux -m64 -o \"$root_path/tmp/gcc/bin/debug/linux/x64/ebmcore/lib_ebmcore_linux_x64${library_suffix}_debug.so\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    printf "%s\n" "$compile_out"
@@ -222,12 +249,12 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/tmp/gcc/bin/debug/linux/x64/ebmcore/lib_ebmcore_linux_x64_debug.so" "$root_path/python/interpret-core/interpret/lib/"
+   cp "$root_path/tmp/gcc/bin/debug/linux/x64/ebmcore/lib_ebmcore_linux_x64${library_suffix}_debug.so" "$root_path/python/interpret-core/interpret/lib/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/tmp/gcc/bin/debug/linux/x64/ebmcore/lib_ebmcore_linux_x64_debug.so" "$root_path/staging/"
+   cp "$root_path/tmp/gcc/bin/debug/linux/x64/ebmcore/lib_ebmcore_linux_x64${library_suffix}_debug.so" "$root_path/staging/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -245,7 +272,7 @@ elif [ "$os_type" = "Linux" ]; then
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      compile_command="$g_pp_bin $compile_linux -m32 -DNDEBUG -o \"$root_path/tmp/gcc/bin/release/linux/x86/ebmcore/lib_ebmcore_linux_x86.so\" 2>&1"
+      compile_command="$g_pp_bin $compile_linux -m32 -DNDEBUG -o \"$root_path/tmp/gcc/bin/release/linux/x86/ebmcore/lib_ebmcore_linux_x86${library_suffix}.so\" 2>&1"
       compile_out=`eval $compile_command`
       ret_code=$?
       printf "%s\n" "$compile_out"
@@ -253,12 +280,12 @@ elif [ "$os_type" = "Linux" ]; then
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      cp "$root_path/tmp/gcc/bin/release/linux/x86/ebmcore/lib_ebmcore_linux_x86.so" "$root_path/python/interpret-core/interpret/lib/"
+      cp "$root_path/tmp/gcc/bin/release/linux/x86/ebmcore/lib_ebmcore_linux_x86${library_suffix}.so" "$root_path/python/interpret-core/interpret/lib/"
       ret_code=$?
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      cp "$root_path/tmp/gcc/bin/release/linux/x86/ebmcore/lib_ebmcore_linux_x86.so" "$root_path/staging/"
+      cp "$root_path/tmp/gcc/bin/release/linux/x86/ebmcore/lib_ebmcore_linux_x86${library_suffix}.so" "$root_path/staging/"
       ret_code=$?
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
@@ -275,7 +302,7 @@ elif [ "$os_type" = "Linux" ]; then
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      compile_command="$g_pp_bin $compile_linux -m32 -o \"$root_path/tmp/gcc/bin/debug/linux/x86/ebmcore/lib_ebmcore_linux_x86_debug.so\" 2>&1"
+      compile_command="$g_pp_bin $compile_linux -m32 -o \"$root_path/tmp/gcc/bin/debug/linux/x86/ebmcore/lib_ebmcore_linux_x86${library_suffix}_debug.so\" 2>&1"
       compile_out=`eval $compile_command`
       ret_code=$?
       printf "%s\n" "$compile_out"
@@ -283,12 +310,12 @@ elif [ "$os_type" = "Linux" ]; then
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      cp "$root_path/tmp/gcc/bin/debug/linux/x86/ebmcore/lib_ebmcore_linux_x86_debug.so" "$root_path/python/interpret-core/interpret/lib/"
+      cp "$root_path/tmp/gcc/bin/debug/linux/x86/ebmcore/lib_ebmcore_linux_x86${library_suffix}_debug.so" "$root_path/python/interpret-core/interpret/lib/"
       ret_code=$?
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
       fi
-      cp "$root_path/tmp/gcc/bin/debug/linux/x86/ebmcore/lib_ebmcore_linux_x86_debug.so" "$root_path/staging/"
+      cp "$root_path/tmp/gcc/bin/debug/linux/x86/ebmcore/lib_ebmcore_linux_x86${library_suffix}_debug.so" "$root_path/staging/"
       ret_code=$?
       if [ $ret_code -ne 0 ]; then 
          exit $ret_code
@@ -0,0 +1,135 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+
+#if defined(__linux__)
+#include <sys/mman.h> // mmap, madvise
+#endif // defined(__linux__)
+
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+
+#include "ArenaAllocator.h"
+
+// the transparent huge page size on x64 Linux.  Blocks this big or bigger are worth backing with huge pages
+constexpr size_t k_cBytesArenaHugePage = size_t { 2 } * 1024 * 1024;
+// the first block is small since many states are small, and each new block doubles until it reaches a huge page
+constexpr size_t k_cBytesArenaBlockFirst = size_t { 64 } * 1024;
+
+// the Block header sits at the start of its own memory, and the allocations follow it on the next aligned boundary
+constexpr size_t k_cBytesArenaBlockHeader = k_cBytesArenaAlignment;
+
+ArenaAllocator::~ArenaAllocator() {
+   Block * pBlock = m_pBlockFirst;
+   while(nullptr != pBlock) {
+      Block * const pNext = pBlock->m_pNext;
+      FreeBlock(pBlock);
+      pBlock = pNext;
+   }
+}
+
+ArenaAllocator::Block * ArenaAllocator::AllocateBlock(const size_t cBytesCapacity) {
+   static_assert(sizeof(Block) <= k_cBytesArenaBlockHeader, "our Block header needs to fit before the first allocation");
+   EBM_ASSERT(0 == cBytesCapacity % k_cBytesArenaAlignment);
+   EBM_ASSERT(k_cBytesArenaBlockHeader < cBytesCapacity);
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+   if(m_bHugePages && k_cBytesArenaHugePage <= cBytesCapacity && !IsAddError(cBytesCapacity, k_cBytesArenaHugePage - 1)) {
+      // mmap only aligns to the normal page size, so we ask for an extra huge page worth of address space and start our block on the first huge
+      // page boundary inside it.  The kernel only commits the pages we touch, so the slack costs us nothing but address space
+      const size_t cBytesRounded = (cBytesCapacity + k_cBytesArenaHugePage - 1) & ~(k_cBytesArenaHugePage - 1);
+      if(!IsAddError(cBytesRounded, k_cBytesArenaHugePage)) {
+         const size_t cBytesMapping = cBytesRounded + k_cBytesArenaHugePage;
+         void * const pMapping = mmap(nullptr, cBytesMapping, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+         if(MAP_FAILED != pMapping) {
+            const size_t iStart = (reinterpret_cast<size_t>(pMapping) + k_cBytesArenaHugePage - 1) & ~(k_cBytesArenaHugePage - 1);
+            // huge pages are only a hint.  If the kernel has them turned off we still have perfectly good memory
+            madvise(reinterpret_cast<void *>(iStart), cBytesRounded, MADV_HUGEPAGE);
+            Block * const pBlock = reinterpret_cast<Block *>(iStart);
+            pBlock->m_pNext = nullptr;
+            pBlock->m_pAllocation = pMapping;
+            pBlock->m_cBytesAllocation = cBytesMapping;
+            pBlock->m_cBytesCapacity = cBytesRounded;
+            pBlock->m_bMapped = true;
+            return pBlock;
+         }
+         LOG_0(TraceLevelWarning, "WARNING ArenaAllocator::AllocateBlock mmap failed, so falling back to malloc");
+      }
+   }
+#endif // defined(__linux__) && defined(MADV_HUGEPAGE)
+
+   if(IsAddError(cBytesCapacity, k_cBytesArenaAlignment - 1)) {
+      LOG_0(TraceLevelWarning, "WARNING ArenaAllocator::AllocateBlock IsAddError(cBytesCapacity, k_cBytesArenaAlignment - 1)");
+      return nullptr;
+   }
+   const size_t cBytesAllocation = cBytesCapacity + k_cBytesArenaAlignment - 1;
+   void * const pAllocation = malloc(cBytesAllocation);
+   if(UNLIKELY(nullptr == pAllocation)) {
+      LOG_0(TraceLevelWarning, "WARNING ArenaAllocator::AllocateBlock nullptr == pAllocation");
+      return nullptr;
+   }
+   const size_t iStart = (reinterpret_cast<size_t>(pAllocation) + k_cBytesArenaAlignment - 1) & ~(k_cBytesArenaAlignment - 1);
+   Block * const pBlock = reinterpret_cast<Block *>(iStart);
+   pBlock->m_pNext = nullptr;
+   pBlock->m_pAllocation = pAllocation;
+   pBlock->m_cBytesAllocation = cBytesAllocation;
+   pBlock->m_cBytesCapacity = cBytesCapacity;
+   pBlock->m_bMapped = false;
+   return pBlock;
+}
+
+void ArenaAllocator::FreeBlock(Block * const pBlock) {
+   EBM_ASSERT(nullptr != pBlock);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+   if(pBlock->m_bMapped) {
+      munmap(pBlock->m_pAllocation, pBlock->m_cBytesAllocation);
+      return;
+   }
+#endif // defined(__linux__) && defined(MADV_HUGEPAGE)
+   EBM_ASSERT(!pBlock->m_bMapped);
+   free(pBlock->m_pAllocation);
+}
+
+void * ArenaAllocator::AllocateSlow(const size_t cBytes) {
+   EBM_ASSERT(0 == cBytes % k_cBytesArenaAlignment);
+
+   // after a ResetToMark there can be blocks past our current one that we've already allocated, so use the next one if the request fits in it
+   Block * const pBlockNext = nullptr == m_pBlockCurrent ? m_pBlockFirst : m_pBlockCurrent->m_pNext;
+   Block * pBlock = pBlockNext;
+   if(nullptr == pBlock || pBlock->m_cBytesCapacity - k_cBytesArenaBlockHeader < cBytes) {
+      if(IsAddError(cBytes, k_cBytesArenaBlockHeader)) {
+         LOG_0(TraceLevelWarning, "WARNING ArenaAllocator::AllocateSlow IsAddError(cBytes, k_cBytesArenaBlockHeader)");
+         return nullptr;
+      }
+      const size_t cBytesBlockMin = cBytes + k_cBytesArenaBlockHeader;
+      size_t cBytesBlock = 0 == m_cBytesBlockNext ? k_cBytesArenaBlockFirst : m_cBytesBlockNext;
+      cBytesBlock = cBytesBlock < cBytesBlockMin ? cBytesBlockMin : cBytesBlock;
+      pBlock = AllocateBlock(cBytesBlock);
+      if(UNLIKELY(nullptr == pBlock)) {
+         LOG_0(TraceLevelWarning, "WARNING ArenaAllocator::AllocateSlow nullptr == pBlock");
+         return nullptr;
+      }
+      if(m_cBytesBlockNext < k_cBytesArenaHugePage) {
+         m_cBytesBlockNext = 0 == m_cBytesBlockNext ? k_cBytesArenaBlockFirst << 1 : m_cBytesBlockNext << 1;
+      }
+
+      // we insert the new block after our current one.  Any block that was too small for this request stays after it to be used later
+      pBlock->m_pNext = pBlockNext;
+      if(nullptr == m_pBlockCurrent) {
+         m_pBlockFirst = pBlock;
+      } else {
+         m_pBlockCurrent->m_pNext = pBlock;
+      }
+   }
+
+   unsigned char * const pStart = reinterpret_cast<unsigned char *>(pBlock);
+   m_pBlockCurrent = pBlock;
+   m_pNext = pStart + k_cBytesArenaBlockHeader + cBytes;
+   m_pEnd = pStart + pBlock->m_cBytesCapacity;
+   return pStart + k_cBytesArenaBlockHeader;
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef ARENA_ALLOCATOR_H
+#define ARENA_ALLOCATOR_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+
+// every allocation from an arena starts on a cache line
+constexpr size_t k_cBytesArenaAlignment = 64;
+
+// a bump allocator that owns a chain of blocks.  Everything allocated from an arena lives until the arena is destroyed, except for allocations
+// made after a Mark, which are all released together by ResetToMark.  ResetToMark keeps the blocks, so scratch memory that is allocated and reset
+// the same way on every call only touches the system allocator the first time.  Blocks of at least k_cBytesArenaHugePage can be backed by huge
+// pages where the operating system allows us to ask for them, which cuts down on TLB misses when walking large arrays
+class ArenaAllocator final {
+   struct Block final {
+      Block * m_pNext;
+      void * m_pAllocation;
+      size_t m_cBytesAllocation;
+      size_t m_cBytesCapacity;
+      bool m_bMapped;
+   };
+
+   Block * m_pBlockFirst;
+   Block * m_pBlockCurrent;
+   unsigned char * m_pNext;
+   unsigned char * m_pEnd;
+   size_t m_cBytesBlockNext;
+   const bool m_bHugePages;
+
+   void * AllocateSlow(const size_t cBytes);
+   Block * AllocateBlock(const size_t cBytesCapacity);
+   static void FreeBlock(Block * const pBlock);
+
+   // the arena owns its blocks, so copying it would free them twice
+   ArenaAllocator(const ArenaAllocator &) = delete;
+   ArenaAllocator & operator=(const ArenaAllocator &) = delete;
+
+public:
+
+   struct Mark final {
+      Block * m_pBlock;
+      unsigned char * m_pNext;
+   };
+
+   EBM_INLINE ArenaAllocator(const bool bHugePages)
+      : m_pBlockFirst(nullptr)
+      , m_pBlockCurrent(nullptr)
+      , m_pNext(nullptr)
+      , m_pEnd(nullptr)
+      , m_cBytesBlockNext(0)
+      , m_bHugePages(bHugePages) {
+   }
+
+   ~ArenaAllocator();
+
+   // returns nullptr on error
+   EBM_INLINE void * Allocate(const size_t cBytes) {
+      // round up so that the next allocation stays aligned.  A zero byte request still gets its own address
+      if(IsAddError(cBytes, k_cBytesArenaAlignment)) {
+         LOG_0(TraceLevelWarning, "WARNING ArenaAllocator::Allocate IsAddError(cBytes, k_cBytesArenaAlignment)");
+         return nullptr;
+      }
+      const size_t cBytesAligned = (cBytes + (k_cBytesArenaAlignment - 1)) & ~(k_cBytesArenaAlignment - 1);
+      const size_t cBytesRequest = 0 == cBytesAligned ? k_cBytesArenaAlignment : cBytesAligned;
+      if(LIKELY(cBytesRequest <= static_cast<size_t>(m_pEnd - m_pNext))) {
+         void * const pRet = m_pNext;
+         m_pNext += cBytesRequest;
+         return pRet;
+      }
+      return AllocateSlow(cBytesRequest);
+   }
+
+   template<typename T>
+   EBM_INLINE T * AllocateArray(const size_t cItems) {
+      if(IsMultiplyError(sizeof(T), cItems)) {
+         LOG_0(TraceLevelWarning, "WARNING ArenaAllocator::AllocateArray IsMultiplyError(sizeof(T), cItems)");
+         return nullptr;
+      }
+      return static_cast<T *>(Allocate(sizeof(T) * cItems));
+   }
+
+   EBM_INLINE Mark GetMark() const {
+      Mark mark;
+      mark.m_pBlock = m_pBlockCurrent;
+      mark.m_pNext = m_pNext;
+      return mark;
+   }
+
+   // releases everything allocated since mark was taken, but keeps the blocks for the allocations that follow
+   EBM_INLINE void ResetToMark(const Mark & mark) {
+      m_pBlockCurrent = mark.m_pBlock;
+      m_pNext = mark.m_pNext;
+      m_pEnd = nullptr == mark.m_pBlock ? nullptr : reinterpret_cast<unsigned char *>(mark.m_pBlock) + mark.m_pBlock->m_cBytesCapacity;
+   }
+};
+
+#endif // ARENA_ALLOCATOR_H
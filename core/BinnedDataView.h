@@ -0,0 +1,173 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef BINNED_DATA_VIEW_H
+#define BINNED_DATA_VIEW_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // numeric_limits
+
+#include "ebmcore.h" // EbmCoreBinnedData
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "FeatureCore.h"
+
+// an internal data type for binned data that an EbmDataSet already bit packed by feature.  Our callers can't pass this value in
+constexpr IntegerDataType k_binnedDataTypePackedCore = -1;
+
+// our caller's binned data, which we read in place while bit packing it into our own datasets.  The packing loops are templated on a reader for the
+// item type, so the only per item cost of a narrow or instance major buffer is the stride
+class BinnedDataView final {
+   IntegerDataType m_dataType;
+   const void * m_aData;
+   size_t m_cItemsStrideInstance;
+   size_t m_cItemsStrideFeature;
+   // only for k_binnedDataTypePackedCore
+   const FeatureCore * m_aPackedFeatures;
+   const IntegerDataType * m_aInstanceIndexes;
+
+public:
+
+   // a subset of the instances of an EbmDataSet, in the order of aInstanceIndexes, or all of them in order if aInstanceIndexes is nullptr.  The
+   // indexes need to have been checked already
+   EBM_INLINE void InitializePacked(const FeatureCore * const aPackedFeatures, const StorageDataTypeCore * const * const aaPackedData, const IntegerDataType * const aInstanceIndexes) {
+      m_dataType = k_binnedDataTypePackedCore;
+      m_aData = aaPackedData;
+      m_cItemsStrideInstance = 0;
+      m_cItemsStrideFeature = 0;
+      m_aPackedFeatures = aPackedFeatures;
+      m_aInstanceIndexes = aInstanceIndexes;
+   }
+
+   // our original entry points take IntegerDataType values in feature major order
+   EBM_INLINE void InitializeFeatureMajor(const size_t cInstances, const IntegerDataType * const aBinnedData) {
+      m_dataType = BinnedDataTypeInt64;
+      m_aData = aBinnedData;
+      m_cItemsStrideInstance = 1;
+      m_cItemsStrideFeature = cInstances;
+      m_aPackedFeatures = nullptr;
+      m_aInstanceIndexes = nullptr;
+   }
+
+   EBM_INLINE bool Initialize(const size_t cFeatures, const size_t cInstances, const EbmCoreBinnedData * const pBinnedData) {
+      if(nullptr == pBinnedData) {
+         LOG_0(TraceLevelError, "ERROR BinnedDataView::Initialize nullptr == pBinnedData");
+         return true;
+      }
+      m_dataType = pBinnedData->dataType;
+      if(BinnedDataTypeUInt8 != m_dataType && BinnedDataTypeUInt16 != m_dataType && BinnedDataTypeInt32 != m_dataType && BinnedDataTypeInt64 != m_dataType && BinnedDataTypeFloat64 != m_dataType) {
+         LOG_0(TraceLevelError, "ERROR BinnedDataView::Initialize unrecognized dataType");
+         return true;
+      }
+      if(pBinnedData->strideInstance < 0 || pBinnedData->strideFeature < 0) {
+         LOG_0(TraceLevelError, "ERROR BinnedDataView::Initialize strideInstance and strideFeature can't be negative");
+         return true;
+      }
+      if(!IsNumberConvertable<size_t, IntegerDataType>(pBinnedData->strideInstance) || !IsNumberConvertable<size_t, IntegerDataType>(pBinnedData->strideFeature)) {
+         LOG_0(TraceLevelWarning, "WARNING BinnedDataView::Initialize !IsNumberConvertable<size_t, IntegerDataType>(stride)");
+         return true;
+      }
+      m_aData = pBinnedData->data;
+      m_cItemsStrideInstance = static_cast<size_t>(pBinnedData->strideInstance);
+      m_cItemsStrideFeature = static_cast<size_t>(pBinnedData->strideFeature);
+      m_aPackedFeatures = nullptr;
+      m_aInstanceIndexes = nullptr;
+
+      if(0 != cFeatures && 0 != cInstances) {
+         if(nullptr == m_aData) {
+            LOG_0(TraceLevelError, "ERROR BinnedDataView::Initialize nullptr == data");
+            return true;
+         }
+         // the offset of our last item needs to fit into a size_t, otherwise our caller can't have allocated it
+         if(IsMultiplyError(cInstances - 1, m_cItemsStrideInstance) || IsMultiplyError(cFeatures - 1, m_cItemsStrideFeature) || IsAddError((cInstances - 1) * m_cItemsStrideInstance, (cFeatures - 1) * m_cItemsStrideFeature)) {
+            LOG_0(TraceLevelWarning, "WARNING BinnedDataView::Initialize the strides overflow");
+            return true;
+         }
+      }
+      return false;
+   }
+
+   EBM_INLINE IntegerDataType GetDataType() const {
+      return m_dataType;
+   }
+   EBM_INLINE size_t GetCountItemsStrideInstance() const {
+      return m_cItemsStrideInstance;
+   }
+   template<typename T>
+   EBM_INLINE const T * GetFeatureData(const size_t iFeatureData) const {
+      EBM_ASSERT(nullptr != m_aData);
+      EBM_ASSERT(k_binnedDataTypePackedCore != m_dataType);
+      return static_cast<const T *>(m_aData) + iFeatureData * m_cItemsStrideFeature;
+   }
+   EBM_INLINE const FeatureCore * GetPackedFeature(const size_t iFeatureData) const {
+      EBM_ASSERT(k_binnedDataTypePackedCore == m_dataType);
+      EBM_ASSERT(nullptr != m_aPackedFeatures);
+      return &m_aPackedFeatures[iFeatureData];
+   }
+   EBM_INLINE const StorageDataTypeCore * GetPackedFeatureData(const size_t iFeatureData) const {
+      EBM_ASSERT(k_binnedDataTypePackedCore == m_dataType);
+      EBM_ASSERT(nullptr != m_aData);
+      return static_cast<const StorageDataTypeCore * const *>(m_aData)[iFeatureData];
+   }
+   EBM_INLINE const IntegerDataType * GetInstanceIndexes() const {
+      return m_aInstanceIndexes;
+   }
+};
+
+// reads one feature of our caller's buffer, one instance after another
+template<typename T>
+class BinnedDataReaderStrided final {
+   const T * m_pInputData;
+   size_t m_cItemsStrideInstance;
+
+public:
+
+   EBM_INLINE void Initialize(const BinnedDataView * const pBinnedData, const size_t iFeatureData) {
+      m_pInputData = pBinnedData->GetFeatureData<T>(iFeatureData);
+      m_cItemsStrideInstance = pBinnedData->GetCountItemsStrideInstance();
+   }
+
+   EBM_INLINE size_t Next() {
+      const T data = *m_pInputData;
+      m_pInputData += m_cItemsStrideInstance;
+      EBM_ASSERT(0 <= data);
+      EBM_ASSERT((IsNumberConvertable<size_t, T>(data))); // data must be lower than cBins and cBins fits into a size_t which we checked earlier
+      return static_cast<size_t>(data);
+   }
+};
+
+// reads one feature of an EbmDataSet, one instance after another in the order of the view's instance indexes
+class BinnedDataReaderPacked final {
+   const StorageDataTypeCore * m_aPackedData;
+   const IntegerDataType * m_pInstanceIndex;
+   size_t m_iInstance;
+   size_t m_cItemsPerBitPackDataUnit;
+   size_t m_cBitsPerItemMax;
+   size_t m_maskBits;
+
+public:
+
+   EBM_INLINE void Initialize(const BinnedDataView * const pBinnedData, const size_t iFeatureData) {
+      m_aPackedData = pBinnedData->GetPackedFeatureData(iFeatureData);
+      m_pInstanceIndex = pBinnedData->GetInstanceIndexes();
+      m_iInstance = 0;
+      m_cItemsPerBitPackDataUnit = pBinnedData->GetPackedFeature(iFeatureData)->m_cItemsPerBitPackDataUnit;
+      m_cBitsPerItemMax = GetCountBits(m_cItemsPerBitPackDataUnit);
+      m_maskBits = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - m_cBitsPerItemMax);
+   }
+
+   EBM_INLINE size_t Next() {
+      size_t iInstance = m_iInstance;
+      if(nullptr != m_pInstanceIndex) {
+         iInstance = static_cast<size_t>(*m_pInstanceIndex);
+         ++m_pInstanceIndex;
+      } else {
+         ++m_iInstance;
+      }
+      const size_t shift = iInstance % m_cItemsPerBitPackDataUnit * m_cBitsPerItemMax;
+      return m_maskBits & (static_cast<size_t>(m_aPackedData[iInstance / m_cItemsPerBitPackDataUnit]) >> shift);
+   }
+};
+
+#endif // BINNED_DATA_VIEW_H
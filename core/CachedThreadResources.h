@@ -8,6 +8,7 @@
 #include <queue>
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uintptr_t
 
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
@@ -23,9 +24,14 @@ public:
    }
 };
 
+// a cache line, which is also the width of an AVX-512 register, so the split sweep can load whole vectors from any array that starts on this boundary
+constexpr size_t k_cBytesSplitSweepAlignment = 64;
+
 template<bool bClassification>
 struct HistogramBucketVectorEntry;
 
+class ThreadPool;
+
 template<bool bClassification>
 class CachedTrainingThreadResources {
    bool m_bError;
@@ -37,6 +43,29 @@ class CachedTrainingThreadResources {
    void * m_aThreadByteBuffer2;
    size_t m_cThreadByteBufferCapacity2;
 
+   // private histograms for all but the first chunk when a single sampling set is binned in chunks
+   void * m_aHistogramChunkBuffer;
+   size_t m_cHistogramChunkBufferCapacity;
+
+   // the structure of arrays that the single dimensional split sweep copies the histogram into.  m_aSplitSweepBuffer is what malloc gave us
+   // and m_aSplitSweepBufferAligned is the first cache line boundary within it
+   void * m_aSplitSweepBuffer;
+   FractionalDataType * m_aSplitSweepBufferAligned;
+   size_t m_cSplitSweepBufferCapacity;
+
+#ifndef NDEBUG
+   // the copy of the binned tensor that the debug checks in DimensionMultiple.h compare against
+   void * m_aDebugByteBuffer;
+   size_t m_cDebugByteBufferCapacity;
+#endif // NDEBUG
+
+   // the pool, and the number of threads from it including the one that owns these resources, that can bin a single sampling set in parallel
+   ThreadPool * m_pBinningThreadPool;
+   size_t m_cBinningThreads;
+
+   // the histogram of the sampling set being trained if the training set was already binned for it, or nullptr if we need to bin it ourselves
+   const void * m_aPrebinnedHistogram;
+
 public:
 
    HistogramBucketVectorEntry<bClassification> * const m_aSumHistogramBucketVectorEntry;
@@ -55,6 +84,18 @@ public:
       , m_cThreadByteBufferCapacity1(0)
       , m_aThreadByteBuffer2(nullptr)
       , m_cThreadByteBufferCapacity2(0)
+      , m_aHistogramChunkBuffer(nullptr)
+      , m_cHistogramChunkBufferCapacity(0)
+      , m_aSplitSweepBuffer(nullptr)
+      , m_aSplitSweepBufferAligned(nullptr)
+      , m_cSplitSweepBufferCapacity(0)
+#ifndef NDEBUG
+      , m_aDebugByteBuffer(nullptr)
+      , m_cDebugByteBufferCapacity(0)
+#endif // NDEBUG
+      , m_pBinningThreadPool(nullptr)
+      , m_cBinningThreads(1)
+      , m_aPrebinnedHistogram(nullptr)
       , m_aSumHistogramBucketVectorEntry(new (std::nothrow) HistogramBucketVectorEntry<bClassification>[cVectorLength])
       , m_aSumHistogramBucketVectorEntry1(new (std::nothrow) HistogramBucketVectorEntry<bClassification>[cVectorLength])
       , m_aSumHistogramBucketVectorEntryBest(new (std::nothrow) HistogramBucketVectorEntry<bClassification>[cVectorLength])
@@ -79,6 +120,11 @@ public:
 
       free(m_aThreadByteBuffer1);
       free(m_aThreadByteBuffer2);
+      free(m_aHistogramChunkBuffer);
+      free(m_aSplitSweepBuffer);
+#ifndef NDEBUG
+      free(m_aDebugByteBuffer);
+#endif // NDEBUG
       delete[] m_aSumHistogramBucketVectorEntry;
       delete[] m_aSumHistogramBucketVectorEntry1;
       delete[] m_aSumHistogramBucketVectorEntryBest;
@@ -103,31 +149,103 @@ public:
       return m_aThreadByteBuffer1;
    }
 
-   // TODO : we can probably avoid redoing any tree growing IF realloc doesn't move the memory since all the internal pointers would still be valid in that case
-   EBM_INLINE bool GrowThreadByteBuffer2(const size_t cByteBoundaries) {
-      // by adding cByteBoundaries and shifting our existing size, we do 2 things:
-      //   1) we ensure that if we have zero size, we'll get some size that we'll get a non-zero size after the shift
-      //   2) we'll always get back an odd number of items, which is good because we always have an odd number of TreeNodeChilden
-      EBM_ASSERT(0 == m_cThreadByteBufferCapacity2 % cByteBoundaries);
-      m_cThreadByteBufferCapacity2 = cByteBoundaries + (m_cThreadByteBufferCapacity2 << 1);
-      LOG_N(TraceLevelInfo, "Growing CachedTrainingThreadResources::ThreadByteBuffer2 to %zu", m_cThreadByteBufferCapacity2);
-      // TODO : can we use malloc here?  We only need realloc if we need to keep the existing data
-      void * const aNewThreadByteBuffer = realloc(m_aThreadByteBuffer2, m_cThreadByteBufferCapacity2);
-      if(UNLIKELY(nullptr == aNewThreadByteBuffer)) {
-         // according to the realloc spec, if realloc fails to allocate the new memory, it returns nullptr BUT the old memory is valid.
-         // we leave m_aThreadByteBuffer1 alone in this instance and will free that memory later in the destructor
-         return true;
+   // GrowDecisionTree asks for the largest tree it could build before it starts, since the priority queue holds pointers into this buffer and
+   // moving the buffer in the middle of a tree would leave them dangling.  We don't keep the old contents, so we don't need realloc
+   EBM_INLINE void * GetThreadByteBuffer2(const size_t cBytesRequired) {
+      if(UNLIKELY(m_cThreadByteBufferCapacity2 < cBytesRequired)) {
+         free(m_aThreadByteBuffer2);
+         m_aThreadByteBuffer2 = nullptr;
+         m_cThreadByteBufferCapacity2 = 0;
+         LOG_N(TraceLevelInfo, "Growing CachedTrainingThreadResources::ThreadByteBuffer2 to %zu", cBytesRequired);
+         void * const aNewThreadByteBuffer = malloc(cBytesRequired);
+         if(UNLIKELY(nullptr == aNewThreadByteBuffer)) {
+            return nullptr;
+         }
+         m_aThreadByteBuffer2 = aNewThreadByteBuffer;
+         m_cThreadByteBufferCapacity2 = cBytesRequired;
+      }
+      return m_aThreadByteBuffer2;
+   }
+
+   EBM_INLINE void * GetHistogramChunkBuffer(const size_t cBytesRequired) {
+      if(UNLIKELY(m_cHistogramChunkBufferCapacity < cBytesRequired)) {
+         // we overwrite everything in this buffer on each use, so we don't need realloc to preserve the old contents
+         free(m_aHistogramChunkBuffer);
+         m_aHistogramChunkBuffer = nullptr;
+         m_cHistogramChunkBufferCapacity = 0;
+         LOG_N(TraceLevelInfo, "Growing CachedTrainingThreadResources::HistogramChunkBuffer to %zu", cBytesRequired);
+         void * const aNewHistogramChunkBuffer = malloc(cBytesRequired);
+         if(UNLIKELY(nullptr == aNewHistogramChunkBuffer)) {
+            return nullptr;
+         }
+         m_aHistogramChunkBuffer = aNewHistogramChunkBuffer;
+         m_cHistogramChunkBufferCapacity = cBytesRequired;
       }
-      m_aThreadByteBuffer2 = aNewThreadByteBuffer;
-      return false;
+      return m_aHistogramChunkBuffer;
    }
 
-   EBM_INLINE void * GetThreadByteBuffer2() {
-      return m_aThreadByteBuffer2;
+   // returns cItems FractionalDataType items that start on a k_cBytesSplitSweepAlignment boundary, or nullptr if we're out of memory
+   EBM_INLINE FractionalDataType * GetSplitSweepBuffer(const size_t cItems) {
+      if(UNLIKELY(m_cSplitSweepBufferCapacity < cItems)) {
+         // we overwrite everything in this buffer on each use, so we don't need realloc to preserve the old contents
+         free(m_aSplitSweepBuffer);
+         m_aSplitSweepBuffer = nullptr;
+         m_aSplitSweepBufferAligned = nullptr;
+         m_cSplitSweepBufferCapacity = 0;
+         if(IsMultiplyError(sizeof(FractionalDataType), cItems) || IsAddError(sizeof(FractionalDataType) * cItems, k_cBytesSplitSweepAlignment)) {
+            return nullptr;
+         }
+         LOG_N(TraceLevelInfo, "Growing CachedTrainingThreadResources::SplitSweepBuffer to %zu", cItems);
+         void * const aNewSplitSweepBuffer = malloc(sizeof(FractionalDataType) * cItems + k_cBytesSplitSweepAlignment);
+         if(UNLIKELY(nullptr == aNewSplitSweepBuffer)) {
+            return nullptr;
+         }
+         m_aSplitSweepBuffer = aNewSplitSweepBuffer;
+         const uintptr_t iAligned = (reinterpret_cast<uintptr_t>(aNewSplitSweepBuffer) + k_cBytesSplitSweepAlignment - 1) & ~static_cast<uintptr_t>(k_cBytesSplitSweepAlignment - 1);
+         m_aSplitSweepBufferAligned = reinterpret_cast<FractionalDataType *>(iAligned);
+         m_cSplitSweepBufferCapacity = cItems;
+      }
+      return m_aSplitSweepBufferAligned;
+   }
+
+#ifndef NDEBUG
+   EBM_INLINE void * GetDebugByteBuffer(const size_t cBytesRequired) {
+      if(UNLIKELY(m_cDebugByteBufferCapacity < cBytesRequired)) {
+         // we overwrite everything in this buffer on each use, so we don't need realloc to preserve the old contents
+         free(m_aDebugByteBuffer);
+         m_aDebugByteBuffer = nullptr;
+         m_cDebugByteBufferCapacity = 0;
+         void * const aNewDebugByteBuffer = malloc(cBytesRequired);
+         if(UNLIKELY(nullptr == aNewDebugByteBuffer)) {
+            return nullptr;
+         }
+         m_aDebugByteBuffer = aNewDebugByteBuffer;
+         m_cDebugByteBufferCapacity = cBytesRequired;
+      }
+      return m_aDebugByteBuffer;
+   }
+#endif // NDEBUG
+
+   EBM_INLINE ThreadPool * GetBinningThreadPool() const {
+      return m_pBinningThreadPool;
+   }
+
+   EBM_INLINE size_t GetCountBinningThreads() const {
+      return m_cBinningThreads;
+   }
+
+   EBM_INLINE void SetBinningThreads(ThreadPool * const pBinningThreadPool, const size_t cBinningThreads) {
+      EBM_ASSERT(1 <= cBinningThreads);
+      m_pBinningThreadPool = pBinningThreadPool;
+      m_cBinningThreads = cBinningThreads;
+   }
+
+   EBM_INLINE const void * GetPrebinnedHistogram() const {
+      return m_aPrebinnedHistogram;
    }
 
-   EBM_INLINE size_t GetThreadByteBuffer2Size() const {
-      return m_cThreadByteBufferCapacity2;
+   EBM_INLINE void SetPrebinnedHistogram(const void * const aPrebinnedHistogram) {
+      m_aPrebinnedHistogram = aPrebinnedHistogram;
    }
 
    EBM_INLINE bool IsError() const {
@@ -6,15 +6,17 @@
 
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint8_t, uint16_t, int32_t
 
 #include "ebmcore.h" // FractionalDataType
 #include "EbmInternal.h" // FeatureTypeCore
 #include "Logging.h" // EBM_ASSERT & LOG
 #include "FeatureCore.h"
+#include "BinnedDataView.h"
 #include "DataSetByFeature.h"
 #include "InitializeResiduals.h"
 
-EBM_INLINE static const FractionalDataType * ConstructResidualErrors(const size_t cInstances, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+EBM_INLINE static const StorageFractionalDataTypeCore * ConstructResidualErrors(const size_t cInstances, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    LOG_0(TraceLevelInfo, "Entered DataSetByFeature::ConstructResidualErrors");
 
    EBM_ASSERT(1 <= cInstances);
@@ -30,13 +32,13 @@ EBM_INLINE static const FractionalDataType * ConstructResidualErrors(const size_
 
    const size_t cElements = cInstances * cVectorLength;
 
-   if(IsMultiplyError(sizeof(FractionalDataType), cElements)) {
-      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructResidualErrors IsMultiplyError(sizeof(FractionalDataType), cElements)");
+   if(IsMultiplyError(sizeof(StorageFractionalDataTypeCore), cElements)) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructResidualErrors IsMultiplyError(sizeof(StorageFractionalDataTypeCore), cElements)");
       return nullptr;
    }
 
-   const size_t cBytes = sizeof(FractionalDataType) * cElements;
-   FractionalDataType * aResidualErrors = static_cast<FractionalDataType *>(malloc(cBytes));
+   const size_t cBytes = sizeof(StorageFractionalDataTypeCore) * cElements;
+   StorageFractionalDataTypeCore * aResidualErrors = static_cast<StorageFractionalDataTypeCore *>(malloc(cBytes));
 
    if(IsRegression(runtimeLearningTypeOrCountTargetClasses)) {
       InitializeResiduals<k_Regression>(cInstances, aTargetData, aPredictorScores, aResidualErrors, k_Regression);
@@ -52,20 +54,52 @@ EBM_INLINE static const FractionalDataType * ConstructResidualErrors(const size_
    return aResidualErrors;
 }
 
-EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aBinnedData) {
+template<typename TReader>
+EBM_INLINE static void PackInputDataFeature(const FeatureCore * const pFeature, const size_t cInstances, const BinnedDataView * const pBinnedData, StorageDataTypeCore * pInputDataTo) {
+   const size_t cItemsPerBitPackDataUnit = pFeature->m_cItemsPerBitPackDataUnit;
+   EBM_ASSERT(1 <= cItemsPerBitPackDataUnit);
+   EBM_ASSERT(cItemsPerBitPackDataUnit <= k_cCountItemsBitPackedMax);
+   const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
+
+   TReader reader;
+   reader.Initialize(pBinnedData, pFeature->m_iFeatureData);
+   size_t cItemsRemaining = cInstances;
+   do {
+      // the last data unit can be partially filled
+      const size_t cItemsInUnit = cItemsRemaining < cItemsPerBitPackDataUnit ? cItemsRemaining : cItemsPerBitPackDataUnit;
+      cItemsRemaining -= cItemsInUnit;
+
+      // put our first item in the least significant bits, like DataSetByFeatureCombination does, so that unpacking is just a mask and a shift
+      size_t bits = 0;
+      const size_t shiftEnd = cBitsPerItemMax * cItemsInUnit;
+      size_t shift = 0;
+      do {
+         const size_t data = reader.Next();
+         EBM_ASSERT(data < pFeature->m_cBins);
+         EBM_ASSERT(shift < k_cBitsForStorageType);
+         bits |= data << shift;
+         shift += cBitsPerItemMax;
+      } while(shiftEnd != shift);
+      EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(bits)));
+      *pInputDataTo = static_cast<StorageDataTypeCore>(bits);
+      ++pInputDataTo;
+   } while(0 != cItemsRemaining);
+}
+
+const StorageDataTypeCore * const * DataSetByFeature::ConstructInputData(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const BinnedDataView * const pBinnedData) {
    LOG_0(TraceLevelInfo, "Entered DataSetByFeature::ConstructInputData");
 
    EBM_ASSERT(0 < cFeatures);
    EBM_ASSERT(nullptr != aFeatures);
    EBM_ASSERT(0 < cInstances);
-   EBM_ASSERT(nullptr != aBinnedData);
+   EBM_ASSERT(nullptr != pBinnedData);
 
    if(IsMultiplyError(sizeof(StorageDataTypeCore), cInstances)) {
-      // we're checking this early instead of checking it inside our loop
+      // we're checking this early instead of checking it inside our loop.  Every feature packs at least one item into each data unit, so no feature
+      // needs more than this
       LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputData IsMultiplyError(sizeof(StorageDataTypeCore), cInstances)");
       return nullptr;
    }
-   const size_t cSubBytesData = sizeof(StorageDataTypeCore) * cInstances;
 
    if(IsMultiplyError(sizeof(void *), cFeatures)) {
       LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputData IsMultiplyError(sizeof(void *), cFeatures)");
@@ -82,7 +116,11 @@ EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const s
    const FeatureCore * pFeature = aFeatures;
    const FeatureCore * const pFeatureEnd = aFeatures + cFeatures;
    do {
-      StorageDataTypeCore * pInputDataTo = static_cast<StorageDataTypeCore *>(malloc(cSubBytesData));
+      const size_t cItemsPerBitPackDataUnit = pFeature->m_cItemsPerBitPackDataUnit;
+      EBM_ASSERT(1 <= cItemsPerBitPackDataUnit);
+      const size_t cDataUnits = (cInstances - 1) / cItemsPerBitPackDataUnit + 1; // this can't overflow or underflow
+
+      StorageDataTypeCore * pInputDataTo = static_cast<StorageDataTypeCore *>(malloc(sizeof(StorageDataTypeCore) * cDataUnits));
       if(nullptr == pInputDataTo) {
          LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputData nullptr == pInputDataTo");
          goto free_all;
@@ -90,18 +128,28 @@ EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const s
       *paInputDataTo = pInputDataTo;
       ++paInputDataTo;
 
-      const IntegerDataType * pInputDataFrom = &aBinnedData[pFeature->m_iFeatureData * cInstances];
-      const IntegerDataType * pInputDataFromEnd = &pInputDataFrom[cInstances];
-      do {
-         const IntegerDataType data = *pInputDataFrom;
-         EBM_ASSERT(0 <= data);
-         EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(data))); // data must be lower than cBins and cBins fits into a size_t which we checked earlier
-         EBM_ASSERT(static_cast<size_t>(data) < pFeature->m_cBins);
-         EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, IntegerDataType>(data)));
-         *pInputDataTo = static_cast<StorageDataTypeCore>(data);
-         ++pInputDataTo;
-         ++pInputDataFrom;
-      } while(pInputDataFromEnd != pInputDataFrom);
+      // the switch is per feature, so the packing loop itself is specialized for the item type
+      switch(pBinnedData->GetDataType()) {
+      case BinnedDataTypeUInt8:
+         PackInputDataFeature<BinnedDataReaderStrided<uint8_t>>(pFeature, cInstances, pBinnedData, pInputDataTo);
+         break;
+      case BinnedDataTypeUInt16:
+         PackInputDataFeature<BinnedDataReaderStrided<uint16_t>>(pFeature, cInstances, pBinnedData, pInputDataTo);
+         break;
+      case BinnedDataTypeInt32:
+         PackInputDataFeature<BinnedDataReaderStrided<int32_t>>(pFeature, cInstances, pBinnedData, pInputDataTo);
+         break;
+      case BinnedDataTypeInt64:
+         PackInputDataFeature<BinnedDataReaderStrided<IntegerDataType>>(pFeature, cInstances, pBinnedData, pInputDataTo);
+         break;
+      case BinnedDataTypeFloat64:
+         PackInputDataFeature<BinnedDataReaderStrided<double>>(pFeature, cInstances, pBinnedData, pInputDataTo);
+         break;
+      default:
+         EBM_ASSERT(k_binnedDataTypePackedCore == pBinnedData->GetDataType());
+         PackInputDataFeature<BinnedDataReaderPacked>(pFeature, cInstances, pBinnedData, pInputDataTo);
+         break;
+      }
 
       ++pFeature;
    } while(pFeatureEnd != pFeature);
@@ -118,30 +166,48 @@ free_all:
    return nullptr;
 }
 
-DataSetByFeature::DataSetByFeature(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aBinnedData, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses)
+void DataSetByFeature::FreeInputData(const size_t cFeatures, const StorageDataTypeCore * const * const aaInputData) {
+   if(nullptr != aaInputData) {
+      EBM_ASSERT(1 <= cFeatures);
+      const StorageDataTypeCore * const * paInputData = aaInputData;
+      const StorageDataTypeCore * const * const paInputDataEnd = aaInputData + cFeatures;
+      do {
+         EBM_ASSERT(nullptr != *paInputData);
+         free(const_cast<StorageDataTypeCore *>(*paInputData));
+         ++paInputData;
+      } while(paInputDataEnd != paInputData);
+      free(const_cast<StorageDataTypeCore * *>(aaInputData));
+   }
+}
+
+DataSetByFeature::DataSetByFeature(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const BinnedDataView * const pBinnedData, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses)
    : m_aResidualErrors(ConstructResidualErrors(cInstances, aTargetData, aPredictorScores, runtimeLearningTypeOrCountTargetClasses))
-   , m_aaInputData(0 == cFeatures ? nullptr : ConstructInputData(cFeatures, aFeatures, cInstances, aBinnedData))
+   , m_aaInputData(0 == cFeatures ? nullptr : ConstructInputData(cFeatures, aFeatures, cInstances, pBinnedData))
    , m_cInstances(cInstances)
-   , m_cFeatures(cFeatures) {
+   , m_cFeatures(cFeatures)
+   , m_bSharedInputData(false) {
 
    EBM_ASSERT(0 < cInstances);
 }
 
+DataSetByFeature::DataSetByFeature(const size_t cFeatures, const StorageDataTypeCore * const * const aaSharedInputData, const size_t cInstances, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses)
+   : m_aResidualErrors(ConstructResidualErrors(cInstances, aTargetData, aPredictorScores, runtimeLearningTypeOrCountTargetClasses))
+   , m_aaInputData(aaSharedInputData)
+   , m_cInstances(cInstances)
+   , m_cFeatures(cFeatures)
+   , m_bSharedInputData(true) {
+
+   EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(0 == cFeatures || nullptr != aaSharedInputData);
+}
+
 DataSetByFeature::~DataSetByFeature() {
    LOG_0(TraceLevelInfo, "Entered ~DataSetByFeature");
 
-   FractionalDataType * aResidualErrors = const_cast<FractionalDataType *>(m_aResidualErrors);
+   StorageFractionalDataTypeCore * aResidualErrors = const_cast<StorageFractionalDataTypeCore *>(m_aResidualErrors);
    free(aResidualErrors);
-   if(nullptr != m_aaInputData) {
-      EBM_ASSERT(1 <= m_cFeatures);
-      const StorageDataTypeCore * const * paInputData = m_aaInputData;
-      const StorageDataTypeCore * const * const paInputDataEnd = m_aaInputData + m_cFeatures;
-      do {
-         EBM_ASSERT(nullptr != *paInputData);
-         free(const_cast<StorageDataTypeCore *>(*paInputData));
-         ++paInputData;
-      } while(paInputDataEnd != paInputData);
-      free(const_cast<StorageDataTypeCore * *>(m_aaInputData));
+   if(!m_bSharedInputData) {
+      FreeInputData(m_cFeatures, m_aaInputData);
    }
 
    LOG_0(TraceLevelInfo, "Exited ~DataSetByFeature");
@@ -11,24 +11,33 @@
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
 #include "FeatureCore.h"
+#include "BinnedDataView.h"
 
 // TODO: rename this to DataSetByFeature
 class DataSetByFeature final {
-   const FractionalDataType * const m_aResidualErrors;
+   const StorageFractionalDataTypeCore * const m_aResidualErrors;
    const StorageDataTypeCore * const * const m_aaInputData;
    const size_t m_cInstances;
    const size_t m_cFeatures;
+   // true if m_aaInputData belongs to an EbmDataSet
+   const bool m_bSharedInputData;
 
 public:
 
-   DataSetByFeature(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aInputDataFrom, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses);
+   // bit packs every feature.  Returns nullptr on error
+   static const StorageDataTypeCore * const * ConstructInputData(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const BinnedDataView * const pBinnedData);
+   static void FreeInputData(const size_t cFeatures, const StorageDataTypeCore * const * const aaInputData);
+
+   DataSetByFeature(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const BinnedDataView * const pBinnedData, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses);
+   // uses input data that ConstructInputData packed for an EbmDataSet, which needs to outlive this object, but has its own residuals
+   DataSetByFeature(const size_t cFeatures, const StorageDataTypeCore * const * const aaSharedInputData, const size_t cInstances, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses);
    ~DataSetByFeature();
 
    EBM_INLINE bool IsError() const {
       return nullptr == m_aResidualErrors || (0 != m_cFeatures && nullptr == m_aaInputData);
    }
 
-   EBM_INLINE const FractionalDataType * GetResidualPointer() const {
+   EBM_INLINE const StorageFractionalDataTypeCore * GetResidualPointer() const {
       EBM_ASSERT(nullptr != m_aResidualErrors);
       return m_aResidualErrors;
    }
@@ -7,15 +7,18 @@
 #include <string.h> // memset
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint8_t, uint16_t, int32_t
 
 #include "ebmcore.h" // FractionalDataType
 #include "EbmInternal.h" // FeatureTypeCore
 #include "Logging.h" // EBM_ASSERT & LOG
+#include "EbmStatistics.h"
 #include "FeatureCore.h"
 #include "FeatureCombinationCore.h"
+#include "BinnedDataView.h"
 #include "DataSetByFeatureCombination.h"
 
-EBM_INLINE static FractionalDataType * ConstructResidualErrors(const size_t cInstances, const size_t cVectorLength) {
+EBM_INLINE static StorageFractionalDataTypeCore * ConstructResidualErrors(const size_t cInstances, const size_t cVectorLength) {
    LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination::ConstructResidualErrors");
 
    EBM_ASSERT(1 <= cInstances);
@@ -28,19 +31,19 @@ EBM_INLINE static FractionalDataType * ConstructResidualErrors(const size_t cIns
 
    const size_t cElements = cInstances * cVectorLength;
 
-   if(IsMultiplyError(sizeof(FractionalDataType), cElements)) {
-      LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::ConstructResidualErrors IsMultiplyError(sizeof(FractionalDataType), cElements)");
+   if(IsMultiplyError(sizeof(StorageFractionalDataTypeCore), cElements)) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::ConstructResidualErrors IsMultiplyError(sizeof(StorageFractionalDataTypeCore), cElements)");
       return nullptr;
    }
 
-   const size_t cBytes = sizeof(FractionalDataType) * cElements;
-   FractionalDataType * aResidualErrors = static_cast<FractionalDataType *>(malloc(cBytes));
+   const size_t cBytes = sizeof(StorageFractionalDataTypeCore) * cElements;
+   StorageFractionalDataTypeCore * aResidualErrors = static_cast<StorageFractionalDataTypeCore *>(malloc(cBytes));
 
    LOG_0(TraceLevelInfo, "Exited DataSetByFeatureCombination::ConstructResidualErrors");
    return aResidualErrors;
 }
 
-EBM_INLINE static FractionalDataType * ConstructPredictorScores(const size_t cInstances, const size_t cVectorLength, const FractionalDataType * const aPredictorScoresFrom) {
+EBM_INLINE static StorageFractionalDataTypeCore * ConstructPredictorScores(const size_t cInstances, const size_t cVectorLength, const FractionalDataType * const aPredictorScoresFrom) {
    LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination::ConstructPredictorScores");
 
    EBM_ASSERT(0 < cInstances);
@@ -53,13 +56,13 @@ EBM_INLINE static FractionalDataType * ConstructPredictorScores(const size_t cIn
 
    const size_t cElements = cInstances * cVectorLength;
 
-   if(IsMultiplyError(sizeof(FractionalDataType), cElements)) {
-      LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::ConstructPredictorScores IsMultiplyError(sizeof(FractionalDataType), cElements)");
+   if(IsMultiplyError(sizeof(StorageFractionalDataTypeCore), cElements)) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::ConstructPredictorScores IsMultiplyError(sizeof(StorageFractionalDataTypeCore), cElements)");
       return nullptr;
    }
 
-   const size_t cBytes = sizeof(FractionalDataType) * cElements;
-   FractionalDataType * const aPredictorScoresTo = static_cast<FractionalDataType *>(malloc(cBytes));
+   const size_t cBytes = sizeof(StorageFractionalDataTypeCore) * cElements;
+   StorageFractionalDataTypeCore * const aPredictorScoresTo = static_cast<StorageFractionalDataTypeCore *>(malloc(cBytes));
    if(nullptr == aPredictorScoresTo) {
       LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::ConstructPredictorScores nullptr == aPredictorScoresTo");
       return nullptr;
@@ -68,15 +71,18 @@ EBM_INLINE static FractionalDataType * ConstructPredictorScores(const size_t cIn
    if(nullptr == aPredictorScoresFrom) {
       memset(aPredictorScoresTo, 0, cBytes);
    } else {
-      memcpy(aPredictorScoresTo, aPredictorScoresFrom, cBytes);
+      // the caller's scores are always FractionalDataType, which we round if we store them in single precision
+      for(size_t iElement = 0; iElement < cElements; ++iElement) {
+         aPredictorScoresTo[iElement] = static_cast<StorageFractionalDataTypeCore>(aPredictorScoresFrom[iElement]);
+      }
       constexpr bool bZeroingLogits = 0 <= k_iZeroClassificationLogitAtInitialize;
       if(bZeroingLogits) {
          // TODO : integrate this subtraction into the copy instead of doing it afterwards
-         FractionalDataType * pScore = aPredictorScoresTo;
-         const FractionalDataType * const pScoreExteriorEnd = pScore + cVectorLength * cInstances;
+         StorageFractionalDataTypeCore * pScore = aPredictorScoresTo;
+         const StorageFractionalDataTypeCore * const pScoreExteriorEnd = pScore + cVectorLength * cInstances;
          do {
-            FractionalDataType scoreShift = pScore[k_iZeroClassificationLogitAtInitialize];
-            const FractionalDataType * const pScoreInteriorEnd = pScore + cVectorLength;
+            StorageFractionalDataTypeCore scoreShift = pScore[k_iZeroClassificationLogitAtInitialize];
+            const StorageFractionalDataTypeCore * const pScoreInteriorEnd = pScore + cVectorLength;
             do {
                *pScore -= scoreShift;
                ++pScore;
@@ -123,18 +129,89 @@ EBM_INLINE static const StorageDataTypeCore * ConstructTargetData(const size_t c
    return aTargetData;
 }
 
-struct InputDataPointerAndCountBins {
-   const IntegerDataType * m_pInputData;
+template<typename TReader>
+struct InputDataReaderAndCountBins {
+   TReader m_reader;
    size_t m_cBins;
 };
 
-EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const IntegerDataType * const aInputDataFrom) {
+template<typename TReader>
+EBM_INLINE static void PackInputDataFeatureCombination(const FeatureCombinationCore * const pFeatureCombination, const size_t cInstances, const BinnedDataView * const pBinnedData, StorageDataTypeCore * pInputDataTo, const size_t cBytesData) {
+   const size_t cFeatures = pFeatureCombination->m_cFeatures;
+   const size_t cItemsPerBitPackDataUnit = pFeatureCombination->m_cItemsPerBitPackDataUnit;
+   const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
+   EBM_ASSERT(cBitsPerItemMax <= CountBitsRequiredPositiveMax<StorageDataTypeCore>()); // if we have 1 item, it can't be larger than the number of bits of storage
+
+   // stop on the last item in our array AND then do one special last loop with less or equal iterations to the normal loop
+   const StorageDataTypeCore * const pInputDataToLast = reinterpret_cast<const StorageDataTypeCore *>(reinterpret_cast<const char *>(pInputDataTo) + cBytesData) - 1;
+   EBM_ASSERT(pInputDataTo <= pInputDataToLast); // we have 1 item or more, and therefore the last one can't be before the first item
+
+   const FeatureCombinationCore::FeatureCombinationEntry * pFeatureCombinationEntry = &pFeatureCombination->m_FeatureCombinationEntry[0];
+   InputDataReaderAndCountBins<TReader> dimensionInfo[k_cDimensionsMax];
+   InputDataReaderAndCountBins<TReader> * pDimensionInfo = &dimensionInfo[0];
+   EBM_ASSERT(0 < cFeatures);
+   const InputDataReaderAndCountBins<TReader> * const pDimensionInfoEnd = &dimensionInfo[cFeatures];
+   do {
+      const FeatureCore * const pFeature = pFeatureCombinationEntry->m_pFeature;
+      pDimensionInfo->m_reader.Initialize(pBinnedData, pFeature->m_iFeatureData);
+      pDimensionInfo->m_cBins = pFeature->m_cBins;
+      ++pFeatureCombinationEntry;
+      ++pDimensionInfo;
+   } while(pDimensionInfoEnd != pDimensionInfo);
+
+   // THIS IS NOT A CONSTANT FOR A REASON.. WE CHANGE IT ON OUR LAST ITERATION
+   // if we ever template this function on cItemsPerBitPackDataUnit, then we'd want
+   // to make this a constant so that the compiler could reason about it an eliminate loops
+   // as it is, it isn't a constant, so the compiler would not be able to figure out that most
+   // of the time it is a constant
+   size_t shiftEnd = cBitsPerItemMax * cItemsPerBitPackDataUnit;
+   while(pInputDataTo < pInputDataToLast) /* do the last iteration AFTER we re-enter this loop through the goto label! */ {
+   one_last_loop:;
+      EBM_ASSERT(shiftEnd <= CountBitsRequiredPositiveMax<StorageDataTypeCore>());
+
+      size_t bits = 0;
+      size_t shift = 0;
+      do {
+         size_t tensorMultiple = 1;
+         size_t tensorIndex = 0;
+         pDimensionInfo = &dimensionInfo[0];
+         do {
+            const size_t inputData = pDimensionInfo->m_reader.Next();
+            EBM_ASSERT(inputData < pDimensionInfo->m_cBins);
+            EBM_ASSERT(!IsMultiplyError(tensorMultiple, pDimensionInfo->m_cBins)); // we check for overflows during FeatureCombination construction, but let's check here again
+
+            tensorIndex += tensorMultiple * inputData; // this can't overflow if the multiplication below doesn't overflow, and we checked for that above
+            tensorMultiple *= pDimensionInfo->m_cBins;
+
+            ++pDimensionInfo;
+         } while(pDimensionInfoEnd != pDimensionInfo);
+         // put our first item in the least significant bits.  We do this so that later when
+         // unpacking the indexes, we can just AND our mask with the bitfield to get the index and in subsequent loops
+         // we can just shift down.  This eliminates one extra shift that we'd otherwise need to make if the first
+         // item was in the MSB
+         EBM_ASSERT(shift < CountBitsRequiredPositiveMax<StorageDataTypeCore>());
+         bits |= tensorIndex << shift;
+         shift += cBitsPerItemMax;
+      } while(shiftEnd != shift);
+      EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(bits)));
+      *pInputDataTo = static_cast<StorageDataTypeCore>(bits);
+      ++pInputDataTo;
+   }
+
+   if(pInputDataTo == pInputDataToLast) {
+      // if this is the first time we've exited the loop, then re-enter it to do our last loop, but reduce the number of times we do the inner loop
+      shiftEnd = cBitsPerItemMax * ((cInstances - 1) % cItemsPerBitPackDataUnit + 1);
+      goto one_last_loop;
+   }
+}
+
+EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const BinnedDataView * const pBinnedData, bool ** const pabBorrowedInputData) {
    LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination::ConstructInputData");
 
    EBM_ASSERT(0 < cFeatureCombinations);
    EBM_ASSERT(nullptr != apFeatureCombination);
    EBM_ASSERT(0 < cInstances);
-   // aInputDataFrom can be nullptr EVEN if 0 < cFeatureCombinations && 0 < cInstances IF the featureCombinations are all empty, which makes none of them refer to features, so the aInputDataFrom pointer isn't necessary
+   // pBinnedData can be nullptr EVEN if 0 < cFeatureCombinations && 0 < cInstances IF the featureCombinations are all empty, which makes none of them refer to features, so the pBinnedData pointer isn't necessary
 
    if(IsMultiplyError(sizeof(void *), cFeatureCombinations)) {
       LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::ConstructInputData IsMultiplyError(sizeof(void *), cFeatureCombinations)");
@@ -147,6 +224,7 @@ EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const s
       return nullptr;
    }
 
+   bool * abBorrowedInputData = nullptr;
    StorageDataTypeCore ** paInputDataTo = aaInputDataTo;
    const FeatureCombinationCore * const * ppFeatureCombination = apFeatureCombination;
    const FeatureCombinationCore * const * const ppFeatureCombinationEnd = apFeatureCombination + cFeatureCombinations;
@@ -156,12 +234,23 @@ EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const s
       const size_t cFeatures = pFeatureCombination->m_cFeatures;
       if(0 == cFeatures) {
          *paInputDataTo = nullptr; // free will skip over these later
+      } else if(1 == cFeatures && nullptr != pBinnedData && k_binnedDataTypePackedCore == pBinnedData->GetDataType() && nullptr == pBinnedData->GetInstanceIndexes()) {
+         // a single feature over every instance of an EbmDataSet in order is bit packed exactly like the dataset's column for that feature, so we
+         // use the column in place.  For a dataset that was opened from a file, we then train straight from the mapped pages
+         const size_t iFeatureData = pFeatureCombination->m_FeatureCombinationEntry[0].m_pFeature->m_iFeatureData;
+         EBM_ASSERT(pFeatureCombination->m_cItemsPerBitPackDataUnit == pBinnedData->GetPackedFeature(iFeatureData)->m_cItemsPerBitPackDataUnit);
+         if(nullptr == abBorrowedInputData) {
+            abBorrowedInputData = static_cast<bool *>(calloc(cFeatureCombinations, sizeof(bool)));
+            if(nullptr == abBorrowedInputData) {
+               LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::ConstructInputData nullptr == abBorrowedInputData");
+               goto free_all;
+            }
+         }
+         abBorrowedInputData[paInputDataTo - aaInputDataTo] = true;
+         *paInputDataTo = const_cast<StorageDataTypeCore *>(pBinnedData->GetPackedFeatureData(iFeatureData));
       } else {
          const size_t cItemsPerBitPackDataUnit = pFeatureCombination->m_cItemsPerBitPackDataUnit;
          EBM_ASSERT(cItemsPerBitPackDataUnit <= CountBitsRequiredPositiveMax<StorageDataTypeCore>()); // for a 32/64 bit storage item, we can't have more than 32/64 bit packed items stored
-         const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
-         EBM_ASSERT(cBitsPerItemMax <= CountBitsRequiredPositiveMax<StorageDataTypeCore>()); // if we have 1 item, it can't be larger than the number of bits of storage
-
          EBM_ASSERT(0 < cInstances);
          const size_t cDataUnits = (cInstances - 1) / cItemsPerBitPackDataUnit + 1; // this can't overflow or underflow
 
@@ -177,102 +266,79 @@ EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const s
          }
          *paInputDataTo = pInputDataTo;
 
-         // stop on the last item in our array AND then do one special last loop with less or equal iterations to the normal loop
-         const StorageDataTypeCore * const pInputDataToLast = reinterpret_cast<const StorageDataTypeCore *>(reinterpret_cast<const char *>(pInputDataTo) + cBytesData) - 1;
-         EBM_ASSERT(pInputDataTo <= pInputDataToLast); // we have 1 item or more, and therefore the last one can't be before the first item
-
-         EBM_ASSERT(nullptr != aInputDataFrom);
-
-         const FeatureCombinationCore::FeatureCombinationEntry * pFeatureCombinationEntry = &pFeatureCombination->m_FeatureCombinationEntry[0];
-         InputDataPointerAndCountBins dimensionInfo[k_cDimensionsMax];
-         InputDataPointerAndCountBins * pDimensionInfo = &dimensionInfo[0];
-         EBM_ASSERT(0 < cFeatures);
-         const InputDataPointerAndCountBins * const pDimensionInfoEnd = &dimensionInfo[cFeatures];
-         do {
-            const FeatureCore * const pFeature = pFeatureCombinationEntry->m_pFeature;
-            pDimensionInfo->m_pInputData = &aInputDataFrom[pFeature->m_iFeatureData * cInstances];
-            pDimensionInfo->m_cBins = pFeature->m_cBins;
-            ++pFeatureCombinationEntry;
-            ++pDimensionInfo;
-         } while(pDimensionInfoEnd != pDimensionInfo);
-
-         // THIS IS NOT A CONSTANT FOR A REASON.. WE CHANGE IT ON OUR LAST ITERATION
-         // if we ever template this function on cItemsPerBitPackDataUnit, then we'd want
-         // to make this a constant so that the compiler could reason about it an eliminate loops
-         // as it is, it isn't a constant, so the compiler would not be able to figure out that most
-         // of the time it is a constant
-         size_t shiftEnd = cBitsPerItemMax * cItemsPerBitPackDataUnit;
-         while(pInputDataTo < pInputDataToLast) /* do the last iteration AFTER we re-enter this loop through the goto label! */ {
-         one_last_loop:;
-            EBM_ASSERT(shiftEnd <= CountBitsRequiredPositiveMax<StorageDataTypeCore>());
-
-            size_t bits = 0;
-            size_t shift = 0;
-            do {
-               size_t tensorMultiple = 1;
-               size_t tensorIndex = 0;
-               pDimensionInfo = &dimensionInfo[0];
-               do {
-                  const IntegerDataType * pInputData = pDimensionInfo->m_pInputData;
-                  const IntegerDataType inputData = *pInputData;
-                  pDimensionInfo->m_pInputData = pInputData + 1;
-
-                  EBM_ASSERT(0 <= inputData);
-                  EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(inputData))); // data must be lower than inputData and inputData fits into a size_t which we checked earlier
-                  EBM_ASSERT(static_cast<size_t>(inputData) < pDimensionInfo->m_cBins);
-                  EBM_ASSERT(!IsMultiplyError(tensorMultiple, pDimensionInfo->m_cBins)); // we check for overflows during FeatureCombination construction, but let's check here again
-
-                  tensorIndex += tensorMultiple * static_cast<size_t>(inputData); // this can't overflow if the multiplication below doesn't overflow, and we checked for that above
-                  tensorMultiple *= pDimensionInfo->m_cBins;
-
-                  ++pDimensionInfo;
-               } while(pDimensionInfoEnd != pDimensionInfo);
-               // put our first item in the least significant bits.  We do this so that later when
-               // unpacking the indexes, we can just AND our mask with the bitfield to get the index and in subsequent loops
-               // we can just shift down.  This eliminates one extra shift that we'd otherwise need to make if the first
-               // item was in the MSB
-               EBM_ASSERT(shift < CountBitsRequiredPositiveMax<StorageDataTypeCore>());
-               bits |= tensorIndex << shift;
-               shift += cBitsPerItemMax;
-            } while(shiftEnd != shift);
-            EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(bits)));
-            *pInputDataTo = static_cast<StorageDataTypeCore>(bits);
-            ++pInputDataTo;
-         }
-
-         if(pInputDataTo == pInputDataToLast) {
-            // if this is the first time we've exited the loop, then re-enter it to do our last loop, but reduce the number of times we do the inner loop
-            shiftEnd = cBitsPerItemMax * ((cInstances - 1) % cItemsPerBitPackDataUnit + 1);
-            goto one_last_loop;
+         EBM_ASSERT(nullptr != pBinnedData);
+         // the switch is per feature combination, so the packing loop itself is specialized for the item type
+         switch(pBinnedData->GetDataType()) {
+         case BinnedDataTypeUInt8:
+            PackInputDataFeatureCombination<BinnedDataReaderStrided<uint8_t>>(pFeatureCombination, cInstances, pBinnedData, pInputDataTo, cBytesData);
+            break;
+         case BinnedDataTypeUInt16:
+            PackInputDataFeatureCombination<BinnedDataReaderStrided<uint16_t>>(pFeatureCombination, cInstances, pBinnedData, pInputDataTo, cBytesData);
+            break;
+         case BinnedDataTypeInt32:
+            PackInputDataFeatureCombination<BinnedDataReaderStrided<int32_t>>(pFeatureCombination, cInstances, pBinnedData, pInputDataTo, cBytesData);
+            break;
+         case BinnedDataTypeInt64:
+            PackInputDataFeatureCombination<BinnedDataReaderStrided<IntegerDataType>>(pFeatureCombination, cInstances, pBinnedData, pInputDataTo, cBytesData);
+            break;
+         case BinnedDataTypeFloat64:
+            PackInputDataFeatureCombination<BinnedDataReaderStrided<double>>(pFeatureCombination, cInstances, pBinnedData, pInputDataTo, cBytesData);
+            break;
+         default:
+            EBM_ASSERT(k_binnedDataTypePackedCore == pBinnedData->GetDataType());
+            PackInputDataFeatureCombination<BinnedDataReaderPacked>(pFeatureCombination, cInstances, pBinnedData, pInputDataTo, cBytesData);
+            break;
          }
       }
       ++paInputDataTo;
       ++ppFeatureCombination;
    } while(ppFeatureCombinationEnd != ppFeatureCombination);
 
+   *pabBorrowedInputData = abBorrowedInputData;
    LOG_0(TraceLevelInfo, "Exited DataSetByFeatureCombination::ConstructInputData");
    return aaInputDataTo;
 
 free_all:
    while(aaInputDataTo != paInputDataTo) {
       --paInputDataTo;
-      free(*paInputDataTo);
+      if(nullptr == abBorrowedInputData || !abBorrowedInputData[paInputDataTo - aaInputDataTo]) {
+         free(*paInputDataTo);
+      }
    }
+   free(abBorrowedInputData);
    free(aaInputDataTo);
    return nullptr;
 }
 
-DataSetByFeatureCombination::DataSetByFeatureCombination(const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bAllocateTargetData, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const IntegerDataType * const aInputDataFrom, const void * const aTargets, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength)
-   : m_aResidualErrors(bAllocateResidualErrors ? ConstructResidualErrors(cInstances, cVectorLength) : static_cast<FractionalDataType *>(INVALID_POINTER))
-   , m_aPredictorScores(bAllocatePredictorScores ? ConstructPredictorScores(cInstances, cVectorLength, aPredictorScoresFrom) : static_cast<FractionalDataType *>(INVALID_POINTER))
+DataSetByFeatureCombination::DataSetByFeatureCombination(const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bAllocateTargetData, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const BinnedDataView * const pBinnedData, const void * const aTargets, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength)
+   : m_aResidualErrors(bAllocateResidualErrors ? ConstructResidualErrors(cInstances, cVectorLength) : static_cast<StorageFractionalDataTypeCore *>(INVALID_POINTER))
+   , m_aDenominators(nullptr)
+   , m_aPredictorScores(bAllocatePredictorScores ? ConstructPredictorScores(cInstances, cVectorLength, aPredictorScoresFrom) : static_cast<StorageFractionalDataTypeCore *>(INVALID_POINTER))
    , m_aTargetData(bAllocateTargetData ? ConstructTargetData(cInstances, static_cast<const IntegerDataType *>(aTargets)) : static_cast<const StorageDataTypeCore *>(INVALID_POINTER))
-   , m_aaInputData(0 == cFeatureCombinations ? nullptr : ConstructInputData(cFeatureCombinations, apFeatureCombination, cInstances, aInputDataFrom))
+   , m_abBorrowedInputData(nullptr)
+   , m_aaInputData(0 == cFeatureCombinations ? nullptr : ConstructInputData(cFeatureCombinations, apFeatureCombination, cInstances, pBinnedData, &m_abBorrowedInputData))
    , m_cInstances(cInstances)
-   , m_cFeatureCombinations(cFeatureCombinations) {
+   , m_cFeatureCombinations(cFeatureCombinations)
+   , m_bSharedData(false) {
 
    EBM_ASSERT(0 < cInstances);
 }
 
+DataSetByFeatureCombination::DataSetByFeatureCombination(const DataSetByFeatureCombination * const pSharedDataSet, const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength)
+   : m_aResidualErrors(bAllocateResidualErrors ? ConstructResidualErrors(pSharedDataSet->m_cInstances, cVectorLength) : static_cast<StorageFractionalDataTypeCore *>(INVALID_POINTER))
+   , m_aDenominators(nullptr)
+   , m_aPredictorScores(bAllocatePredictorScores ? ConstructPredictorScores(pSharedDataSet->m_cInstances, cVectorLength, aPredictorScoresFrom) : static_cast<StorageFractionalDataTypeCore *>(INVALID_POINTER))
+   , m_aTargetData(pSharedDataSet->m_aTargetData)
+   , m_abBorrowedInputData(nullptr)
+   , m_aaInputData(pSharedDataSet->m_aaInputData)
+   , m_cInstances(pSharedDataSet->m_cInstances)
+   , m_cFeatureCombinations(pSharedDataSet->m_cFeatureCombinations)
+   , m_bSharedData(true) {
+
+   EBM_ASSERT(0 < m_cInstances);
+   EBM_ASSERT(!pSharedDataSet->m_bSharedData);
+}
+
 DataSetByFeatureCombination::~DataSetByFeatureCombination() {
    LOG_0(TraceLevelInfo, "Entered ~DataSetByFeatureCombination");
 
@@ -282,19 +348,53 @@ DataSetByFeatureCombination::~DataSetByFeatureCombination() {
    if(INVALID_POINTER != m_aPredictorScores) {
       free(m_aPredictorScores);
    }
+   free(m_aDenominators);
+   if(m_bSharedData) {
+      LOG_0(TraceLevelInfo, "Exited ~DataSetByFeatureCombination shared data");
+      return;
+   }
    if(INVALID_POINTER != m_aTargetData) {
       free(const_cast<StorageDataTypeCore *>(m_aTargetData));
    }
    if(nullptr != m_aaInputData) {
       EBM_ASSERT(0 < m_cFeatureCombinations);
-      const StorageDataTypeCore * const * paInputData = m_aaInputData;
-      const StorageDataTypeCore * const * const paInputDataEnd = m_aaInputData + m_cFeatureCombinations;
-      do {
-         free(const_cast<StorageDataTypeCore *>(*paInputData));
-         ++paInputData;
-      } while(paInputDataEnd != paInputData);
+      for(size_t iFeatureCombination = 0; iFeatureCombination < m_cFeatureCombinations; ++iFeatureCombination) {
+         if(nullptr == m_abBorrowedInputData || !m_abBorrowedInputData[iFeatureCombination]) {
+            free(const_cast<StorageDataTypeCore *>(m_aaInputData[iFeatureCombination]));
+         }
+      }
+      free(m_abBorrowedInputData);
       free(const_cast<StorageDataTypeCore **>(m_aaInputData));
    }
 
    LOG_0(TraceLevelInfo, "Exited ~DataSetByFeatureCombination");
 }
+
+bool DataSetByFeatureCombination::AllocateDenominators(const size_t cVectorLength) {
+   LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination::AllocateDenominators");
+
+   EBM_ASSERT(INVALID_POINTER != m_aResidualErrors);
+   EBM_ASSERT(nullptr != m_aResidualErrors);
+
+   if(nullptr == m_aDenominators) {
+      // the denominators are the same shape as the residuals
+      StorageFractionalDataTypeCore * const aDenominators = ConstructResidualErrors(m_cInstances, cVectorLength);
+      if(UNLIKELY(nullptr == aDenominators)) {
+         LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::AllocateDenominators nullptr == aDenominators");
+         return true;
+      }
+      const size_t cElements = m_cInstances * cVectorLength;
+      for(size_t iElement = 0; iElement < cElements; ++iElement) {
+         aDenominators[iElement] = static_cast<StorageFractionalDataTypeCore>(EbmStatistics::ComputeNewtonRaphsonStep(static_cast<FractionalDataType>(m_aResidualErrors[iElement])));
+      }
+      m_aDenominators = aDenominators;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited DataSetByFeatureCombination::AllocateDenominators");
+   return false;
+}
+
+void DataSetByFeatureCombination::FreeDenominators() {
+   free(m_aDenominators);
+   m_aDenominators = nullptr;
+}
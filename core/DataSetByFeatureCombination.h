@@ -12,39 +12,61 @@
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
 #include "FeatureCombinationCore.h"
+#include "BinnedDataView.h"
 
 // TODO: let's take how clean this class is (with almost everything const and the arrays constructed in initialization list) and apply it to as many other classes as we can
 // TODO: rename this to DataSetByFeatureCombination
 class DataSetByFeatureCombination final {
-   FractionalDataType * const m_aResidualErrors;
-   FractionalDataType * const m_aPredictorScores;
+   StorageFractionalDataTypeCore * const m_aResidualErrors;
+   // nullptr unless our caller asked for the Newton-Raphson denominators of classification residuals to be kept next to m_aResidualErrors.  The
+   // denominators are rewritten together with the residuals, and the binning of every sampling set then reads them instead of recomputing them
+   StorageFractionalDataTypeCore * m_aDenominators;
+   StorageFractionalDataTypeCore * const m_aPredictorScores;
    const StorageDataTypeCore * const m_aTargetData;
+   // nullptr unless some of m_aaInputData are feature columns of an EbmDataSet that we use in place, in which case they are marked true here.
+   // ConstructInputData sets this while it constructs m_aaInputData, so it needs to be declared first
+   bool * m_abBorrowedInputData;
    const StorageDataTypeCore * const * const m_aaInputData;
    const size_t m_cInstances;
    const size_t m_cFeatureCombinations;
+   // true if m_aTargetData and m_aaInputData belong to another DataSetByFeatureCombination
+   const bool m_bSharedData;
 
 public:
 
-   DataSetByFeatureCombination(const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bAllocateTargetData, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const IntegerDataType * const aInputDataFrom, const void * const aTargets, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength);
+   DataSetByFeatureCombination(const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bAllocateTargetData, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const BinnedDataView * const pBinnedData, const void * const aTargets, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength);
+   // uses the packed input data and target data of pSharedDataSet, which needs to outlive this object, but has its own residuals and predictor scores.
+   // This allows several models to train on the same instances while keeping only one copy of the packed data
+   DataSetByFeatureCombination(const DataSetByFeatureCombination * const pSharedDataSet, const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength);
    ~DataSetByFeatureCombination();
 
    EBM_INLINE bool IsError() const {
       return nullptr == m_aResidualErrors || nullptr == m_aPredictorScores || nullptr == m_aTargetData || (0 != m_cFeatureCombinations && nullptr == m_aaInputData);
    }
 
-   EBM_INLINE FractionalDataType * GetResidualPointer() {
+   EBM_INLINE StorageFractionalDataTypeCore * GetResidualPointer() {
       EBM_ASSERT(nullptr != m_aResidualErrors);
       return m_aResidualErrors;
    }
-   EBM_INLINE const FractionalDataType * GetResidualPointer() const {
+   EBM_INLINE const StorageFractionalDataTypeCore * GetResidualPointer() const {
       EBM_ASSERT(nullptr != m_aResidualErrors);
       return m_aResidualErrors;
    }
-   EBM_INLINE FractionalDataType * GetPredictorScores() {
+   // returns true on error.  Fills the denominators from the current residuals
+   bool AllocateDenominators(const size_t cVectorLength);
+   void FreeDenominators();
+   // nullptr if we don't keep denominators
+   EBM_INLINE StorageFractionalDataTypeCore * GetDenominatorPointer() {
+      return m_aDenominators;
+   }
+   EBM_INLINE const StorageFractionalDataTypeCore * GetDenominatorPointer() const {
+      return m_aDenominators;
+   }
+   EBM_INLINE StorageFractionalDataTypeCore * GetPredictorScores() {
       EBM_ASSERT(nullptr != m_aPredictorScores);
       return m_aPredictorScores;
    }
-   EBM_INLINE const FractionalDataType * GetPredictorScores() const {
+   EBM_INLINE const StorageFractionalDataTypeCore * GetPredictorScores() const {
       EBM_ASSERT(nullptr != m_aPredictorScores);
       return m_aPredictorScores;
    }
@@ -19,6 +19,18 @@
 
 #ifndef NDEBUG
 
+// the debug copy of the binned tensor always has one spare bucket after its last bin.  The debug checks build their slow totals in that bucket
+// instead of allocating one, since otherwise debug builds would allocate on every boosting step and we couldn't check that steady state doesn't
+template<bool bClassification>
+EBM_INLINE HistogramBucket<bClassification> * GetDebugScratchBucket(const HistogramBucket<bClassification> * const aHistogramBucketsDebugCopy, const FeatureCombinationCore * const pFeatureCombination, const size_t cBytesPerHistogramBucket) {
+   size_t cTotalBucketsDebug = 1;
+   for(size_t iDimensionDebug = 0; iDimensionDebug < pFeatureCombination->m_cFeatures; ++iDimensionDebug) {
+      cTotalBucketsDebug *= pFeatureCombination->m_FeatureCombinationEntry[iDimensionDebug].m_pFeature->m_cBins;
+   }
+   // the checks only read the copy itself, and the spare bucket belongs to them, so casting away the const here doesn't write anything that's shared
+   return GetHistogramBucketByIndex<bClassification>(cBytesPerHistogramBucket, const_cast<HistogramBucket<bClassification> *>(aHistogramBucketsDebugCopy), static_cast<ptrdiff_t>(cTotalBucketsDebug));
+}
+
 // TODO: remove the templating on these debug functions.  We don't need to replicate this function 63 times!!
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
 void GetTotalsDebugSlow(const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const size_t * const aiStart, const size_t * const aiLast, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pRet) {
@@ -96,13 +108,9 @@ void CompareTotalsDebug(const HistogramBucket<IsClassification(compilerLearningT
       directionVectorDestroy >>= 1;
    }
 
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pComparison2 = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(malloc(cBytesPerHistogramBucket));
-   if(nullptr != pComparison2) {
-      // if we can't obtain the memory, then don't do the comparison and exit
-      GetTotalsDebugSlow<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, aiLast, runtimeLearningTypeOrCountTargetClasses, pComparison2);
-      EBM_ASSERT(pComparison->cInstancesInBucket == pComparison2->cInstancesInBucket);
-      free(pComparison2);
-   }
+   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pComparison2 = GetDebugScratchBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)>(aHistogramBuckets, pFeatureCombination, cBytesPerHistogramBucket);
+   GetTotalsDebugSlow<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, aiLast, runtimeLearningTypeOrCountTargetClasses, pComparison2);
+   EBM_ASSERT(pComparison->cInstancesInBucket == pComparison2->cInstancesInBucket);
 }
 
 #endif // NDEBUG
@@ -374,6 +382,46 @@ void CompareTotalsDebug(const HistogramBucket<IsClassification(compilerLearningT
 
 
 
+#ifndef NDEBUG
+// the same check that BuildFastTotals makes as it goes, for when the kernels in g_pIsaKernels built the totals
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
+void CheckFastTotalsDebug(const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const FeatureCombinationCore * const pFeatureCombination, const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucketsDebugCopy) {
+   if(nullptr == aHistogramBucketsDebugCopy) {
+      return;
+   }
+   const size_t cDimensions = GET_ATTRIBUTE_COMBINATION_DIMENSIONS(countCompilerDimensions, pFeatureCombination->m_cFeatures);
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pDebugBucket = GetDebugScratchBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)>(aHistogramBucketsDebugCopy, pFeatureCombination, cBytesPerHistogramBucket);
+
+   size_t aiStart[k_cDimensionsMax];
+   size_t aiLast[k_cDimensionsMax];
+   for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+      aiStart[iDimension] = 0;
+      aiLast[iDimension] = 0;
+   }
+   const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pHistogramBucket = aHistogramBuckets;
+   while(true) {
+      GetTotalsDebugSlow<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBucketsDebugCopy, pFeatureCombination, aiStart, aiLast, runtimeLearningTypeOrCountTargetClasses, pDebugBucket);
+      EBM_ASSERT(pDebugBucket->cInstancesInBucket == pHistogramBucket->cInstancesInBucket);
+      pHistogramBucket = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pHistogramBucket, 1);
+
+      size_t iDimension = 0;
+      while(true) {
+         ++aiLast[iDimension];
+         if(pFeatureCombination->m_FeatureCombinationEntry[iDimension].m_pFeature->m_cBins != aiLast[iDimension]) {
+            break;
+         }
+         aiLast[iDimension] = 0;
+         ++iDimension;
+         if(cDimensions == iDimension) {
+            return;
+         }
+      }
+   }
+}
+#endif // NDEBUG
+
 template<bool bClassification>
 struct FastTotalState {
    HistogramBucket<bClassification> * pDimensionalCur;
@@ -398,6 +446,21 @@ void BuildFastTotals(HistogramBucket<IsClassification(compilerLearningTypeOrCoun
    EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
    const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
 
+   if(1 == cVectorLength) {
+      // regression and binary classification have a single score per bucket, which the kernels compiled for each instruction set handle
+      EBM_ASSERT(sizeof(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)>) == cBytesPerHistogramBucket);
+      size_t acBins[k_cDimensionsMax];
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         acBins[iDimension] = pFeatureCombination->m_FeatureCombinationEntry[iDimension].m_pFeature->m_cBins;
+      }
+      BuildFastTotalsSingleScore(aHistogramBuckets, cDimensions, acBins, pBucketAuxiliaryBuildZone);
+#ifndef NDEBUG
+      CheckFastTotalsDebug<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, runtimeLearningTypeOrCountTargetClasses, pFeatureCombination, aHistogramBucketsDebugCopy);
+#endif // NDEBUG
+      LOG_0(TraceLevelVerbose, "Exited BuildFastTotals");
+      return;
+   }
+
    FastTotalState<IsClassification(compilerLearningTypeOrCountTargetClasses)> fastTotalState[k_cDimensionsMax];
    const FastTotalState<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pFastTotalStateEnd = &fastTotalState[cDimensions];
    {
@@ -436,7 +499,7 @@ void BuildFastTotals(HistogramBucket<IsClassification(compilerLearningTypeOrCoun
    }
 
 #ifndef NDEBUG
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pDebugBucket = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(malloc(cBytesPerHistogramBucket));
+   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pDebugBucket = nullptr == aHistogramBucketsDebugCopy ? nullptr : GetDebugScratchBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)>(aHistogramBucketsDebugCopy, pFeatureCombination, cBytesPerHistogramBucket);
 #endif //NDEBUG
 
    HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pHistogramBucket = aHistogramBuckets;
@@ -487,9 +550,6 @@ void BuildFastTotals(HistogramBucket<IsClassification(compilerLearningTypeOrCoun
          ++pFastTotalState;
 
          if(UNLIKELY(pFastTotalStateEnd == pFastTotalState)) {
-#ifndef NDEBUG
-            free(pDebugBucket);
-#endif // NDEBUG
 
             LOG_0(TraceLevelVerbose, "Exited BuildFastTotals");
             return;
@@ -563,7 +623,7 @@ void BuildFastTotalsZeroMemoryIncrease(HistogramBucket<IsClassification(compiler
    ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pPrevious, aHistogramBucketsEndDebug);
 
 #ifndef NDEBUG
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pDebugBucket = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(malloc(cBytesPerHistogramBucket));
+   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pDebugBucket = nullptr == aHistogramBucketsDebugCopy ? nullptr : GetDebugScratchBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)>(aHistogramBucketsDebugCopy, pFeatureCombination, cBytesPerHistogramBucket);
    pPrevious->AssertZero();
 #endif //NDEBUG
 
@@ -678,9 +738,6 @@ void BuildFastTotalsZeroMemoryIncrease(HistogramBucket<IsClassification(compiler
          pCurrentIndexAndCountBins->multipliedIndexCur = 0;
          ++pCurrentIndexAndCountBins;
          if(UNLIKELY(pCurrentIndexAndCountBinsEnd == pCurrentIndexAndCountBins)) {
-#ifndef NDEBUG
-            free(pDebugBucket);
-#endif // NDEBUG
             return;
          }
       }
@@ -952,11 +1009,15 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
    const unsigned char * const aHistogramBucketsEndDebug = reinterpret_cast<unsigned char *>(aHistogramBuckets) + cBytesBuffer;
 #endif // NDEBUG
 
-   RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 2>::Recursive(cDimensions, aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+   const bool bBinError = RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 2>::Recursive(cDimensions, pCachedThreadResources, aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
       , aHistogramBucketsEndDebug
 #endif // NDEBUG
    );
+   if(UNLIKELY(bBinError)) {
+      LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional RecursiveBinDataSetTraining failed");
+      return true;
+   }
 
 #ifndef NDEBUG
    // make a copy of the original binned buckets for debugging purposes
@@ -968,7 +1029,8 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
    }
    EBM_ASSERT(!IsMultiplyError(cTotalBucketsDebug, cBytesPerHistogramBucket)); // we wouldn't have been able to allocate our main buffer above if this wasn't ok
    const size_t cBytesBufferDebug = cTotalBucketsDebug * cBytesPerHistogramBucket;
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucketsDebugCopy = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(malloc(cBytesBufferDebug));
+   // we don't need to free this!  It's tracked and reused by pCachedThreadResources.  The extra bucket is for GetDebugScratchBucket
+   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucketsDebugCopy = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pCachedThreadResources->GetDebugByteBuffer(cBytesBufferDebug + cBytesPerHistogramBucket));
    if(nullptr != aHistogramBucketsDebugCopy) {
       // if we can't allocate, don't fail.. just stop checking
       memcpy(aHistogramBucketsDebugCopy, aHistogramBuckets, cBytesBufferDebug);
@@ -1202,9 +1264,6 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
       if(bCutFirst2) {
          if(pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(1, 1)) {
             LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(1, 1)");
-#ifndef NDEBUG
-            free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
             return true;
          }
          pSmallChangeToModelOverwriteSingleSamplingSet->GetDivisionPointer(1)[0] = cutFirst2Best;
@@ -1212,16 +1271,10 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          if(cutFirst2LowBest < cutFirst2HighBest) {
             if(pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 6)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 6)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
             if(pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, 2)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, 2)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
             pSmallChangeToModelOverwriteSingleSamplingSet->GetDivisionPointer(0)[0] = cutFirst2LowBest;
@@ -1229,16 +1282,10 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          } else if(cutFirst2HighBest < cutFirst2LowBest) {
             if(pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 6)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 6)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
             if(pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, 2)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, 2)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
             pSmallChangeToModelOverwriteSingleSamplingSet->GetDivisionPointer(0)[0] = cutFirst2HighBest;
@@ -1246,17 +1293,11 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          } else {
             if(pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, 1)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, 1)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
 
             if(pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 4)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 4)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
             pSmallChangeToModelOverwriteSingleSamplingSet->GetDivisionPointer(0)[0] = cutFirst2LowBest;
@@ -1307,9 +1348,6 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
       } else {
          if(pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, 1)) {
             LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, 1)");
-#ifndef NDEBUG
-            free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
             return true;
          }
          pSmallChangeToModelOverwriteSingleSamplingSet->GetDivisionPointer(0)[0] = cutFirst1Best;
@@ -1317,17 +1355,11 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          if(cutFirst1LowBest < cutFirst1HighBest) {
             if(pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 6)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 6)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
 
             if(pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(1, 2)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(1, 2)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
             pSmallChangeToModelOverwriteSingleSamplingSet->GetDivisionPointer(1)[0] = cutFirst1LowBest;
@@ -1335,17 +1367,11 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          } else if(cutFirst1HighBest < cutFirst1LowBest) {
             if(pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 6)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 6)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
 
             if(pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(1, 2)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(1, 2)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
             pSmallChangeToModelOverwriteSingleSamplingSet->GetDivisionPointer(1)[0] = cutFirst1HighBest;
@@ -1353,16 +1379,10 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          } else {
             if(pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(1, 1)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(1, 1)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
             if(pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 4)) {
                LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional pSmallChangeToModelOverwriteSingleSamplingSet->EnsureValueCapacity(cVectorLength * 4)");
-#ifndef NDEBUG
-               free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
                return true;
             }
             pSmallChangeToModelOverwriteSingleSamplingSet->GetDivisionPointer(1)[0] = cutFirst1LowBest;
@@ -1417,14 +1437,10 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
       // TODO: handle this better
 #ifndef NDEBUG
       EBM_ASSERT(false);
-      free(aHistogramBucketsDebugCopy);
 #endif // NDEBUG
       return true;
    }
 
-#ifndef NDEBUG
-   free(aHistogramBucketsDebugCopy);
-#endif // NDEBUG
 
    LOG_0(TraceLevelVerbose, "Exited TrainMultiDimensional");
    return false;
@@ -1791,7 +1807,8 @@ bool CalculateInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetC
    }
    EBM_ASSERT(!IsMultiplyError(cTotalBucketsDebug, cBytesPerHistogramBucket)); // we wouldn't have been able to allocate our main buffer above if this wasn't ok
    const size_t cBytesBufferDebug = cTotalBucketsDebug * cBytesPerHistogramBucket;
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucketsDebugCopy = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(malloc(cBytesBufferDebug));
+   // the extra bucket is for GetDebugScratchBucket
+   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucketsDebugCopy = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(malloc(cBytesBufferDebug + cBytesPerHistogramBucket));
    if(nullptr != aHistogramBucketsDebugCopy) {
       // if we can't allocate, don't fail.. just stop checking
       memcpy(aHistogramBucketsDebugCopy, aHistogramBuckets, cBytesBufferDebug);
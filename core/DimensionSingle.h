@@ -67,39 +67,92 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
    EBM_ASSERT(0 <= BEST_nodeSplittingScore);
    const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * BEST_pHistogramBucketEntry = pHistogramBucketEntryCur;
    size_t BEST_cInstancesLeft = cInstancesLeft;
-   for(pHistogramBucketEntryCur = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pHistogramBucketEntryCur, 1); pHistogramBucketEntryLast != pHistogramBucketEntryCur; pHistogramBucketEntryCur = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pHistogramBucketEntryCur, 1)) {
-      ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucketEntryCur, aHistogramBucketsEndDebug);
 
-      const size_t CHANGE_cInstances = pHistogramBucketEntryCur->cInstancesInBucket;
-      cInstancesLeft += CHANGE_cInstances;
-      cInstancesRight -= CHANGE_cInstances;
-
-      FractionalDataType nodeSplittingScore = 0;
-      for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+   // with one vector item we copy the left and right sums at every split point into a structure of arrays, and the ISA kernels then score several
+   // split points per instruction.  The sums are added in the same order as the loop below, so both ways find exactly the same split
+   const size_t cSplitPoints = static_cast<size_t>(reinterpret_cast<const char *>(pHistogramBucketEntryLast) - reinterpret_cast<const char *>(pHistogramBucketEntryCur)) / cBytesPerHistogramBucket;
+   constexpr size_t cItemsPerAlignment = k_cBytesSplitSweepAlignment / sizeof(FractionalDataType);
+   static_assert(0 == k_cBytesSplitSweepAlignment % sizeof(FractionalDataType), "our arrays need to start on a boundary");
+   // this can't overflow since we already have cSplitPoints histogram buckets, which are each larger than a FractionalDataType
+   const size_t cItemsPerArray = (cSplitPoints + cItemsPerAlignment - 1) / cItemsPerAlignment * cItemsPerAlignment;
+   FractionalDataType * const aSplitSweep = 1 == cVectorLength && 1 < cSplitPoints ? pCachedThreadResources->GetSplitSweepBuffer(cItemsPerArray * (IsClassification(compilerLearningTypeOrCountTargetClasses) ? 4 : 3)) : nullptr;
+   if(nullptr != aSplitSweep) {
+      FractionalDataType * const aSplitSweepCountsLeft = aSplitSweep;
+      FractionalDataType * const aSplitSweepSumResidualErrorsLeft = aSplitSweepCountsLeft + cItemsPerArray;
+      FractionalDataType * const aSplitSweepSumResidualErrorsRight = aSplitSweepSumResidualErrorsLeft + cItemsPerArray;
+      FractionalDataType * const aSplitSweepSumDenominatorsLeft = aSplitSweepSumResidualErrorsRight + cItemsPerArray;
+
+      FractionalDataType sumResidualErrorLeft = aSumHistogramBucketVectorEntryLeft[0].sumResidualError;
+      FractionalDataType sumResidualErrorRight = aSumResidualErrorsRight[0];
+      FractionalDataType sumDenominatorLeft = 0;
+      aSplitSweepCountsLeft[0] = static_cast<FractionalDataType>(cInstancesLeft);
+      aSplitSweepSumResidualErrorsLeft[0] = sumResidualErrorLeft;
+      aSplitSweepSumResidualErrorsRight[0] = sumResidualErrorRight;
+      if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
+         sumDenominatorLeft = aSumHistogramBucketVectorEntryLeft[0].GetSumDenominator();
+         aSplitSweepSumDenominatorsLeft[0] = sumDenominatorLeft;
+      }
+      for(size_t iSplitPoint = 1; iSplitPoint < cSplitPoints; ++iSplitPoint) {
+         pHistogramBucketEntryCur = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pHistogramBucketEntryCur, 1);
+         ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucketEntryCur, aHistogramBucketsEndDebug);
+
+         cInstancesLeft += pHistogramBucketEntryCur->cInstancesInBucket;
+         const FractionalDataType CHANGE_sumResidualError = pHistogramBucketEntryCur->aHistogramBucketVectorEntry[0].sumResidualError;
+         sumResidualErrorLeft = sumResidualErrorLeft + CHANGE_sumResidualError;
+         sumResidualErrorRight = sumResidualErrorRight - CHANGE_sumResidualError;
+         aSplitSweepCountsLeft[iSplitPoint] = static_cast<FractionalDataType>(cInstancesLeft);
+         aSplitSweepSumResidualErrorsLeft[iSplitPoint] = sumResidualErrorLeft;
+         aSplitSweepSumResidualErrorsRight[iSplitPoint] = sumResidualErrorRight;
          if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
-            aSumHistogramBucketVectorEntryLeft[iVector].SetSumDenominator(aSumHistogramBucketVectorEntryLeft[iVector].GetSumDenominator() + pHistogramBucketEntryCur->aHistogramBucketVectorEntry[iVector].GetSumDenominator());
+            sumDenominatorLeft = sumDenominatorLeft + pHistogramBucketEntryCur->aHistogramBucketVectorEntry[0].GetSumDenominator();
+            aSplitSweepSumDenominatorsLeft[iSplitPoint] = sumDenominatorLeft;
          }
+      }
 
-         const FractionalDataType CHANGE_sumResidualError = pHistogramBucketEntryCur->aHistogramBucketVectorEntry[iVector].sumResidualError;
-         const FractionalDataType sumResidualErrorLeft = aSumHistogramBucketVectorEntryLeft[iVector].sumResidualError + CHANGE_sumResidualError;
-         const FractionalDataType sumResidualErrorRight = aSumResidualErrorsRight[iVector] - CHANGE_sumResidualError;
+      const size_t iBest = EbmStatistics::FindBestSplitPoint(cSplitPoints, static_cast<FractionalDataType>(pTreeNode->GetInstances()), aSplitSweepCountsLeft, aSplitSweepSumResidualErrorsLeft, aSplitSweepSumResidualErrorsRight, &BEST_nodeSplittingScore);
+      EBM_ASSERT(iBest < cSplitPoints);
+      EBM_ASSERT(0 <= BEST_nodeSplittingScore);
+      BEST_pHistogramBucketEntry = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, BEST_pHistogramBucketEntry, iBest);
+      BEST_cInstancesLeft = static_cast<size_t>(aSplitSweepCountsLeft[iBest]);
+      aSumHistogramBucketVectorEntryBest[0].sumResidualError = aSplitSweepSumResidualErrorsLeft[iBest];
+      if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
+         aSumHistogramBucketVectorEntryBest[0].SetSumDenominator(aSplitSweepSumDenominatorsLeft[iBest]);
+      }
+   } else {
+      for(pHistogramBucketEntryCur = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pHistogramBucketEntryCur, 1); pHistogramBucketEntryLast != pHistogramBucketEntryCur; pHistogramBucketEntryCur = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pHistogramBucketEntryCur, 1)) {
+         ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucketEntryCur, aHistogramBucketsEndDebug);
 
-         aSumHistogramBucketVectorEntryLeft[iVector].sumResidualError = sumResidualErrorLeft;
-         aSumResidualErrorsRight[iVector] = sumResidualErrorRight;
+         const size_t CHANGE_cInstances = pHistogramBucketEntryCur->cInstancesInBucket;
+         cInstancesLeft += CHANGE_cInstances;
+         cInstancesRight -= CHANGE_cInstances;
 
-         // TODO : we can make this faster by doing the division in ComputeNodeSplittingScore after we add all the numerators
-         const FractionalDataType nodeSplittingScoreOneVector = EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorLeft, cInstancesLeft) + EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorRight, cInstancesRight);
+         FractionalDataType nodeSplittingScore = 0;
+         for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+            if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
+               aSumHistogramBucketVectorEntryLeft[iVector].SetSumDenominator(aSumHistogramBucketVectorEntryLeft[iVector].GetSumDenominator() + pHistogramBucketEntryCur->aHistogramBucketVectorEntry[iVector].GetSumDenominator());
+            }
+
+            const FractionalDataType CHANGE_sumResidualError = pHistogramBucketEntryCur->aHistogramBucketVectorEntry[iVector].sumResidualError;
+            const FractionalDataType sumResidualErrorLeft = aSumHistogramBucketVectorEntryLeft[iVector].sumResidualError + CHANGE_sumResidualError;
+            const FractionalDataType sumResidualErrorRight = aSumResidualErrorsRight[iVector] - CHANGE_sumResidualError;
+
+            aSumHistogramBucketVectorEntryLeft[iVector].sumResidualError = sumResidualErrorLeft;
+            aSumResidualErrorsRight[iVector] = sumResidualErrorRight;
+
+            // TODO : we can make this faster by doing the division in ComputeNodeSplittingScore after we add all the numerators
+            const FractionalDataType nodeSplittingScoreOneVector = EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorLeft, cInstancesLeft) + EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorRight, cInstancesRight);
+            EBM_ASSERT(0 <= nodeSplittingScore);
+            nodeSplittingScore += nodeSplittingScoreOneVector;
+         }
          EBM_ASSERT(0 <= nodeSplittingScore);
-         nodeSplittingScore += nodeSplittingScoreOneVector;
-      }
-      EBM_ASSERT(0 <= nodeSplittingScore);
-
-      if(UNLIKELY(BEST_nodeSplittingScore < nodeSplittingScore)) {
-         // TODO : randomly choose a node if BEST_entropyTotalChildren == entropyTotalChildren, but if there are 3 choice make sure that each has a 1/3 probability of being selected (same as interview question to select a random line from a file)
-         BEST_nodeSplittingScore = nodeSplittingScore;
-         BEST_pHistogramBucketEntry = pHistogramBucketEntryCur;
-         BEST_cInstancesLeft = cInstancesLeft;
-         memcpy(aSumHistogramBucketVectorEntryBest, aSumHistogramBucketVectorEntryLeft, sizeof(*aSumHistogramBucketVectorEntryBest) * cVectorLength);
+
+         if(UNLIKELY(BEST_nodeSplittingScore < nodeSplittingScore)) {
+            // TODO : randomly choose a node if BEST_entropyTotalChildren == entropyTotalChildren, but if there are 3 choice make sure that each has a 1/3 probability of being selected (same as interview question to select a random line from a file)
+            BEST_nodeSplittingScore = nodeSplittingScore;
+            BEST_pHistogramBucketEntry = pHistogramBucketEntryCur;
+            BEST_cInstancesLeft = cInstancesLeft;
+            memcpy(aSumHistogramBucketVectorEntryBest, aSumHistogramBucketVectorEntryLeft, sizeof(*aSumHistogramBucketVectorEntryBest) * cVectorLength);
+         }
       }
    }
 
@@ -204,19 +257,26 @@ bool GrowDecisionTree(CachedTrainingThreadResources<IsClassification(compilerLea
    EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
    const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
 
-retry_with_bigger_tree_node_children_array:
-   size_t cBytesBuffer2 = pCachedThreadResources->GetThreadByteBuffer2Size();
+   // every TreeNode that we examine gets 2 children, and only TreeNodes that span 2 or more buckets get examined.  There can't be more than
+   // cHistogramBuckets - 1 of those in one tree, and since each split examines at most 2 new TreeNodes there also can't be more than 1 + 2 * cTreeSplitsMax.
+   // We allocate for the largest tree up front since the priority queue below holds pointers into this buffer that a reallocation would leave dangling
+   size_t cTreeNodesMax = (cHistogramBuckets << 1) - 1;
+   if(cTreeSplitsMax < (cHistogramBuckets - 2) >> 1) {
+      cTreeNodesMax = 3 + (cTreeSplitsMax << 2);
+   }
+   if(IsMultiplyError(cTreeNodesMax, cBytesPerTreeNode)) {
+      LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree IsMultiplyError(cTreeNodesMax, cBytesPerTreeNode)");
+      return true;
+   }
+   const size_t cBytesBuffer2 = cTreeNodesMax * cBytesPerTreeNode;
    const size_t cBytesInitialNeededAllocation = 3 * cBytesPerTreeNode; // we need 1 TreeNode for the root, 1 for the left child of the root and 1 for the right child of the root
-   if(cBytesBuffer2 < cBytesInitialNeededAllocation) {
-      // TODO : we can eliminate this check as long as we ensure that the ThreadByteBuffer2 is always initialized to be equal to the size of three TreeNodes (left and right) == GET_SIZEOF_ONE_TREE_NODE_CHILDREN(cBytesPerTreeNode)
-      if(pCachedThreadResources->GrowThreadByteBuffer2(cBytesInitialNeededAllocation)) {
-         LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree pCachedThreadResources->GrowThreadByteBuffer2(cBytesInitialNeededAllocation)");
-         return true;
-      }
-      cBytesBuffer2 = pCachedThreadResources->GetThreadByteBuffer2Size();
-      EBM_ASSERT(cBytesInitialNeededAllocation <= cBytesBuffer2);
+   EBM_ASSERT(cBytesInitialNeededAllocation <= cBytesBuffer2);
+   void * const aThreadByteBuffer2 = pCachedThreadResources->GetThreadByteBuffer2(cBytesBuffer2);
+   if(UNLIKELY(nullptr == aThreadByteBuffer2)) {
+      LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree nullptr == aThreadByteBuffer2");
+      return true;
    }
-   TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pRootTreeNode = static_cast<TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pCachedThreadResources->GetThreadByteBuffer2());
+   TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pRootTreeNode = static_cast<TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(aThreadByteBuffer2);
 
    pRootTreeNode->m_UNION.beforeExaminationForPossibleSplitting.pHistogramBucketEntryFirst = aHistogramBucket;
    pRootTreeNode->m_UNION.beforeExaminationForPossibleSplitting.pHistogramBucketEntryLast = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, aHistogramBucket, cHistogramBuckets - 1);
@@ -307,13 +367,7 @@ retry_with_bigger_tree_node_children_array:
          TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pLeftChild = GetLeftTreeNodeChild<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pParentTreeNode->m_UNION.afterExaminationForPossibleSplitting.pTreeNodeChildren, cBytesPerTreeNode);
          if(pLeftChild->IsSplittable(cInstancesRequiredForParentSplitMin)) {
             TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNodeChildrenAvailableStorageSpaceNext = AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pTreeNodeChildrenAvailableStorageSpaceCur, cBytesPerTreeNode << 1);
-            if(cBytesBuffer2 < static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceNext) - reinterpret_cast<char *>(pRootTreeNode))) {
-               if(pCachedThreadResources->GrowThreadByteBuffer2(cBytesPerTreeNode)) {
-                  LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree pCachedThreadResources->GrowThreadByteBuffer2(cBytesPerTreeNode)");
-                  return true;
-               }
-               goto retry_with_bigger_tree_node_children_array;
-            }
+            EBM_ASSERT(static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceNext) - reinterpret_cast<char *>(pRootTreeNode)) <= cBytesBuffer2);
             // the act of splitting it implicitly sets INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED because splitting sets splitGain to a non-NaN value
             ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint<compilerLearningTypeOrCountTargetClasses>(pLeftChild, pCachedThreadResources, pTreeNodeChildrenAvailableStorageSpaceCur, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
@@ -331,13 +385,7 @@ retry_with_bigger_tree_node_children_array:
          TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pRightChild = GetRightTreeNodeChild<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pParentTreeNode->m_UNION.afterExaminationForPossibleSplitting.pTreeNodeChildren, cBytesPerTreeNode);
          if(pRightChild->IsSplittable(cInstancesRequiredForParentSplitMin)) {
             TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNodeChildrenAvailableStorageSpaceNext = AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pTreeNodeChildrenAvailableStorageSpaceCur, cBytesPerTreeNode << 1);
-            if(cBytesBuffer2 < static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceNext) - reinterpret_cast<char *>(pRootTreeNode))) {
-               if(pCachedThreadResources->GrowThreadByteBuffer2(cBytesPerTreeNode)) {
-                  LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree pCachedThreadResources->GrowThreadByteBuffer2(cBytesPerTreeNode)");
-                  return true;
-               }
-               goto retry_with_bigger_tree_node_children_array;
-            }
+            EBM_ASSERT(static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceNext) - reinterpret_cast<char *>(pRootTreeNode)) <= cBytesBuffer2);
             // the act of splitting it implicitly sets INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED because splitting sets splitGain to a non-NaN value
             ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint<compilerLearningTypeOrCountTargetClasses>(pRightChild, pCachedThreadResources, pTreeNodeChildrenAvailableStorageSpaceCur, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
@@ -410,7 +458,10 @@ bool TrainZeroDimensional(CachedTrainingThreadResources<IsClassification(compile
    }
    memset(pHistogramBucket, 0, cBytesPerHistogramBucket);
 
-   BinDataSetTrainingZeroDimensions<compilerLearningTypeOrCountTargetClasses>(pHistogramBucket, pTrainingSet, runtimeLearningTypeOrCountTargetClasses);
+   if(UNLIKELY(BinDataSetTrainingZeroDimensions<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pHistogramBucket, pTrainingSet, runtimeLearningTypeOrCountTargetClasses))) {
+      LOG_0(TraceLevelWarning, "WARNING TrainZeroDimensional BinDataSetTrainingZeroDimensions failed");
+      return true;
+   }
 
    const HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aSumHistogramBucketVectorEntry = &pHistogramBucket->aHistogramBucketVectorEntry[0];
    if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
@@ -463,11 +514,15 @@ bool TrainSingleDimensional(CachedTrainingThreadResources<IsClassification(compi
    const unsigned char * const aHistogramBucketsEndDebug = reinterpret_cast<unsigned char *>(aHistogramBuckets) + cBytesBuffer;
 #endif // NDEBUG
 
-   BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 1>(aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+   const bool bBinError = BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 1>(pCachedThreadResources, aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
       , aHistogramBucketsEndDebug
 #endif // NDEBUG
    );
+   if(UNLIKELY(bBinError)) {
+      LOG_0(TraceLevelWarning, "WARNING TrainSingleDimensional BinDataSetTraining failed");
+      return true;
+   }
 
    HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aSumHistogramBucketVectorEntry = pCachedThreadResources->m_aSumHistogramBucketVectorEntry;
    memset(aSumHistogramBucketVectorEntry, 0, sizeof(*aSumHistogramBucketVectorEntry) * cVectorLength); // can't overflow, accessing existing memory
@@ -0,0 +1,613 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <string.h> // memcpy, memcmp
+#include <stdlib.h> // malloc, realloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdio.h> // FILE, fopen, fwrite
+#include <cmath> // std::isnan, std::isinf
+#include <limits> // numeric_limits
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "FileMapping.h"
+// feature includes
+#include "FeatureCore.h"
+// dataset depends on features
+#include "BinnedDataView.h"
+#include "DataSetByFeature.h"
+
+#include "EbmDataSet.h"
+
+#ifndef NDEBUG
+void CheckTargets(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cInstances, const void * const aTargets);
+#endif // NDEBUG
+
+// a dataset file is this header, then m_cFeatures EbmCoreFeature items, then m_cInstances targets, then the initial predictor scores if there
+// are any, then the bit packed column of each feature in order.  The targets are FractionalDataType for regression and IntegerDataType for
+// classification, and each column is in the layout that DataSetByFeature::GetDataPointer returns.  Everything before the columns is a multiple
+// of 8 bytes, so every array is aligned within the mapping.  The file is in our native byte order, and the bit packing depends on the size of
+// StorageDataTypeCore, so we record that and refuse files from other builds
+struct DataSetFileHeader final {
+   char m_magic[8];
+   IntegerDataType m_version;
+   IntegerDataType m_cBytesStorageDataType;
+   IntegerDataType m_runtimeLearningTypeOrCountTargetClasses;
+   IntegerDataType m_cFeatures;
+   IntegerDataType m_cInstances;
+   IntegerDataType m_bPredictorScores;
+};
+static_assert(0 == sizeof(DataSetFileHeader) % 8, "the arrays after our header need to be aligned");
+
+static constexpr char k_dataSetFileMagic[8] = { 'E', 'B', 'M', 'D', 'A', 'T', 'A', '\0' };
+static constexpr IntegerDataType k_dataSetFileVersion = 1;
+
+EbmDataSet::~EbmDataSet() {
+   LOG_0(TraceLevelInfo, "Entered ~EbmDataSet");
+
+   if(nullptr != m_pMapping) {
+      // our columns, targets and scores are in the mapping, but the array of column pointers is our own
+      free(const_cast<StorageDataTypeCore * *>(m_aaInputData));
+      free(m_aFeatures);
+      UnmapFile(m_pMapping, m_cBytesMapping);
+   } else {
+      DataSetByFeature::FreeInputData(m_cFeatures, m_aaInputData);
+      free(const_cast<void *>(m_aTargets));
+      free(m_aFeatures);
+      free(const_cast<EbmCoreFeature *>(m_aEbmCoreFeatures));
+   }
+
+   LOG_0(TraceLevelInfo, "Exited ~EbmDataSet");
+}
+
+bool EbmDataSet::InitializeFeatures(const EbmCoreFeature * const aFeatures) {
+   EBM_ASSERT(0 != m_cFeatures);
+   EBM_ASSERT(nullptr != aFeatures);
+   EBM_ASSERT(nullptr == m_aFeatures);
+
+   if(IsMultiplyError(sizeof(FeatureCore), m_cFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmDataSet::InitializeFeatures IsMultiplyError(sizeof(FeatureCore), m_cFeatures)");
+      return true;
+   }
+   m_aFeatures = static_cast<FeatureCore *>(malloc(sizeof(FeatureCore) * m_cFeatures));
+   if(nullptr == m_aFeatures) {
+      LOG_0(TraceLevelWarning, "WARNING EbmDataSet::InitializeFeatures nullptr == m_aFeatures");
+      return true;
+   }
+   for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+      const EbmCoreFeature * const pFeature = &aFeatures[iFeature];
+      if(FeatureTypeOrdinal != pFeature->featureType && FeatureTypeNominal != pFeature->featureType) {
+         LOG_0(TraceLevelError, "ERROR EbmDataSet::InitializeFeatures featureType must either be FeatureTypeOrdinal or FeatureTypeNominal");
+         return true;
+      }
+      if(0 != pFeature->hasMissing && 1 != pFeature->hasMissing) {
+         LOG_0(TraceLevelError, "ERROR EbmDataSet::InitializeFeatures hasMissing must either be 0 or 1");
+         return true;
+      }
+      if(pFeature->countBins < 0) {
+         LOG_0(TraceLevelError, "ERROR EbmDataSet::InitializeFeatures countBins can't be negative");
+         return true;
+      }
+      if(!IsNumberConvertable<size_t, IntegerDataType>(pFeature->countBins)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmDataSet::InitializeFeatures !IsNumberConvertable<size_t, IntegerDataType>(countBins)");
+         return true;
+      }
+      const size_t cBins = static_cast<size_t>(pFeature->countBins);
+      if(0 == cBins && 0 != m_cInstances) {
+         LOG_0(TraceLevelError, "ERROR EbmDataSet::InitializeFeatures countBins can't be zero unless there are no instances");
+         return true;
+      }
+      // this is an in-place new, so there is no new memory allocated, and we already knew where it was going, so we don't need the resulting pointer returned
+      new (&m_aFeatures[iFeature]) FeatureCore(cBins, iFeature, static_cast<FeatureTypeCore>(pFeature->featureType), 0 != pFeature->hasMissing);
+   }
+   return false;
+}
+
+bool EbmDataSet::Initialize(const EbmCoreFeature * const aFeatures, const void * const aTargets, const BinnedDataView * const pBinnedData) {
+   LOG_0(TraceLevelInfo, "Entered EbmDataSet::Initialize");
+
+   if(0 != m_cFeatures) {
+      EBM_ASSERT(nullptr != aFeatures);
+      if(IsMultiplyError(sizeof(EbmCoreFeature), m_cFeatures)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmDataSet::Initialize IsMultiplyError(sizeof(EbmCoreFeature), m_cFeatures)");
+         return true;
+      }
+      EbmCoreFeature * const aEbmCoreFeatures = static_cast<EbmCoreFeature *>(malloc(sizeof(EbmCoreFeature) * m_cFeatures));
+      if(nullptr == aEbmCoreFeatures) {
+         LOG_0(TraceLevelWarning, "WARNING EbmDataSet::Initialize nullptr == aEbmCoreFeatures");
+         return true;
+      }
+      memcpy(aEbmCoreFeatures, aFeatures, sizeof(EbmCoreFeature) * m_cFeatures);
+      m_aEbmCoreFeatures = aEbmCoreFeatures;
+
+      if(InitializeFeatures(aFeatures)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmDataSet::Initialize InitializeFeatures");
+         return true;
+      }
+   }
+
+   if(0 != m_cInstances) {
+      EBM_ASSERT(nullptr != aTargets);
+#ifndef NDEBUG
+      CheckTargets(m_runtimeLearningTypeOrCountTargetClasses, m_cInstances, aTargets);
+#endif // NDEBUG
+
+      // FractionalDataType and IntegerDataType are the same size, so regression and classification targets take the same number of bytes
+      static_assert(sizeof(FractionalDataType) == sizeof(IntegerDataType), "we use the same target buffer size for regression and classification");
+      if(IsMultiplyError(sizeof(IntegerDataType), m_cInstances)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmDataSet::Initialize IsMultiplyError(sizeof(IntegerDataType), m_cInstances)");
+         return true;
+      }
+      void * const aTargetsCopy = malloc(sizeof(IntegerDataType) * m_cInstances);
+      if(nullptr == aTargetsCopy) {
+         LOG_0(TraceLevelWarning, "WARNING EbmDataSet::Initialize nullptr == aTargetsCopy");
+         return true;
+      }
+      memcpy(aTargetsCopy, aTargets, sizeof(IntegerDataType) * m_cInstances);
+      m_aTargets = aTargetsCopy;
+
+      if(0 != m_cFeatures) {
+         m_aaInputData = DataSetByFeature::ConstructInputData(m_cFeatures, m_aFeatures, m_cInstances, pBinnedData);
+         if(nullptr == m_aaInputData) {
+            LOG_0(TraceLevelWarning, "WARNING EbmDataSet::Initialize nullptr == m_aaInputData");
+            return true;
+         }
+      }
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmDataSet::Initialize");
+   return false;
+}
+
+// the sizes of each part of a dataset file after the header.  Returns true if the sizes overflow
+static bool GetDataSetFileLayout(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatures, const size_t cInstances, const bool bPredictorScores, size_t * const pcBytesFeatures, size_t * const pcBytesTargets, size_t * const pcBytesPredictorScores) {
+   if(IsMultiplyError(sizeof(EbmCoreFeature), cFeatures) || IsMultiplyError(sizeof(IntegerDataType), cInstances)) {
+      return true;
+   }
+   *pcBytesFeatures = sizeof(EbmCoreFeature) * cFeatures;
+   *pcBytesTargets = sizeof(IntegerDataType) * cInstances;
+   *pcBytesPredictorScores = 0;
+   if(bPredictorScores) {
+      const size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+      if(IsMultiplyError(cVectorLength, cInstances) || IsMultiplyError(sizeof(FractionalDataType), cVectorLength * cInstances)) {
+         return true;
+      }
+      *pcBytesPredictorScores = sizeof(FractionalDataType) * cVectorLength * cInstances;
+   }
+   return false;
+}
+
+// a dataset file could have been written by anything, so unlike the targets that our callers give us directly, we check the targets in the file
+// even in release builds.  Returns true if a target is out of range
+static bool AreMappedTargetsInvalid(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cInstances, const void * const aTargets) {
+   if(IsRegression(runtimeLearningTypeOrCountTargetClasses)) {
+      const FractionalDataType * const aRegressionTargets = static_cast<const FractionalDataType *>(aTargets);
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         const FractionalDataType target = aRegressionTargets[iInstance];
+         if(std::isnan(target) || std::isinf(target)) {
+            return true;
+         }
+      }
+   } else {
+      EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+      const IntegerDataType * const aClassificationTargets = static_cast<const IntegerDataType *>(aTargets);
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         const IntegerDataType target = aClassificationTargets[iInstance];
+         if(target < 0 || !IsNumberConvertable<ptrdiff_t, IntegerDataType>(target) || runtimeLearningTypeOrCountTargetClasses <= static_cast<ptrdiff_t>(target)) {
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+// the bins in a column index histograms and model tensors directly, so every item that we read needs to be below the feature's count of bins.  Columns
+// where every value that fits in the bits of an item is a valid bin can't be wrong, so we don't page those in.  Returns true if a bin is out of range
+static bool AreMappedBinsInvalid(const FeatureCore * const pFeature, const size_t cInstances, const StorageDataTypeCore * const aPackedData) {
+   const size_t cItemsPerBitPackDataUnit = pFeature->m_cItemsPerBitPackDataUnit;
+   const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
+   const size_t maskBits = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMax);
+   if(maskBits < pFeature->m_cBins) {
+      return false;
+   }
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      const size_t shift = iInstance % cItemsPerBitPackDataUnit * cBitsPerItemMax;
+      const size_t iBin = maskBits & (static_cast<size_t>(aPackedData[iInstance / cItemsPerBitPackDataUnit]) >> shift);
+      if(pFeature->m_cBins <= iBin) {
+         return true;
+      }
+   }
+   return false;
+}
+
+bool EbmDataSet::InitializeMapping(void * const pMapping, const size_t cBytesMapping) {
+   LOG_0(TraceLevelInfo, "Entered EbmDataSet::InitializeMapping");
+
+   EBM_ASSERT(nullptr != pMapping);
+   EBM_ASSERT(sizeof(DataSetFileHeader) <= cBytesMapping);
+   m_pMapping = pMapping;
+   m_cBytesMapping = cBytesMapping;
+
+   const DataSetFileHeader * const pHeader = static_cast<const DataSetFileHeader *>(pMapping);
+   const bool bPredictorScores = 0 != pHeader->m_bPredictorScores;
+   size_t cBytesFeatures;
+   size_t cBytesTargets;
+   size_t cBytesPredictorScores;
+   if(GetDataSetFileLayout(m_runtimeLearningTypeOrCountTargetClasses, m_cFeatures, m_cInstances, bPredictorScores, &cBytesFeatures, &cBytesTargets, &cBytesPredictorScores)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmDataSet::InitializeMapping GetDataSetFileLayout");
+      return true;
+   }
+   // each step checks that the part fits within the file before we point at it
+   const char * pNext = static_cast<const char *>(pMapping) + sizeof(DataSetFileHeader);
+   size_t cBytesRemaining = cBytesMapping - sizeof(DataSetFileHeader);
+
+   if(cBytesRemaining < cBytesFeatures) {
+      LOG_0(TraceLevelError, "ERROR EbmDataSet::InitializeMapping the file is truncated in the features");
+      return true;
+   }
+   const EbmCoreFeature * const aEbmCoreFeatures = reinterpret_cast<const EbmCoreFeature *>(pNext);
+   pNext += cBytesFeatures;
+   cBytesRemaining -= cBytesFeatures;
+   if(0 != m_cFeatures) {
+      m_aEbmCoreFeatures = aEbmCoreFeatures;
+      if(InitializeFeatures(aEbmCoreFeatures)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmDataSet::InitializeMapping InitializeFeatures");
+         return true;
+      }
+   }
+
+   if(cBytesRemaining < cBytesTargets + cBytesPredictorScores) {
+      LOG_0(TraceLevelError, "ERROR EbmDataSet::InitializeMapping the file is truncated in the targets or predictor scores");
+      return true;
+   }
+   if(0 != m_cInstances) {
+      m_aTargets = pNext;
+      if(AreMappedTargetsInvalid(m_runtimeLearningTypeOrCountTargetClasses, m_cInstances, m_aTargets)) {
+         LOG_0(TraceLevelError, "ERROR EbmDataSet::InitializeMapping the file has targets that are NaN, infinite, or not one of the classes");
+         return true;
+      }
+      if(bPredictorScores) {
+         m_aPredictorScores = reinterpret_cast<const FractionalDataType *>(pNext + cBytesTargets);
+      }
+   }
+   pNext += cBytesTargets + cBytesPredictorScores;
+   cBytesRemaining -= cBytesTargets + cBytesPredictorScores;
+
+   if(0 != m_cFeatures && 0 != m_cInstances) {
+      if(IsMultiplyError(sizeof(void *), m_cFeatures)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmDataSet::InitializeMapping IsMultiplyError(sizeof(void *), m_cFeatures)");
+         return true;
+      }
+      const StorageDataTypeCore ** const aaInputData = static_cast<const StorageDataTypeCore **>(malloc(sizeof(void *) * m_cFeatures));
+      if(nullptr == aaInputData) {
+         LOG_0(TraceLevelWarning, "WARNING EbmDataSet::InitializeMapping nullptr == aaInputData");
+         return true;
+      }
+      m_aaInputData = aaInputData;
+      for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+         const size_t cDataUnits = (m_cInstances - 1) / m_aFeatures[iFeature].m_cItemsPerBitPackDataUnit + 1; // this can't overflow or underflow
+         if(IsMultiplyError(sizeof(StorageDataTypeCore), cDataUnits) || cBytesRemaining < sizeof(StorageDataTypeCore) * cDataUnits) {
+            LOG_0(TraceLevelError, "ERROR EbmDataSet::InitializeMapping the file is truncated in the feature columns");
+            return true;
+         }
+         aaInputData[iFeature] = reinterpret_cast<const StorageDataTypeCore *>(pNext);
+         if(AreMappedBinsInvalid(&m_aFeatures[iFeature], m_cInstances, aaInputData[iFeature])) {
+            LOG_0(TraceLevelError, "ERROR EbmDataSet::InitializeMapping the file has a bin that is not below the count of bins of its feature");
+            return true;
+         }
+         pNext += sizeof(StorageDataTypeCore) * cDataUnits;
+         cBytesRemaining -= sizeof(StorageDataTypeCore) * cDataUnits;
+      }
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmDataSet::InitializeMapping");
+   return false;
+}
+
+bool EbmDataSet::CheckInstanceIndexes(const size_t cIndexes, const IntegerDataType * const aInstanceIndexes) const {
+   if(nullptr == aInstanceIndexes) {
+      if(m_cInstances != cIndexes) {
+         LOG_0(TraceLevelError, "ERROR EbmDataSet::CheckInstanceIndexes the count of instances must match the dataset if there are no instance indexes");
+         return true;
+      }
+      return false;
+   }
+   for(size_t iIndex = 0; iIndex < cIndexes; ++iIndex) {
+      const IntegerDataType index = aInstanceIndexes[iIndex];
+      if(index < 0 || !IsNumberConvertable<size_t, IntegerDataType>(index) || m_cInstances <= static_cast<size_t>(index)) {
+         LOG_0(TraceLevelError, "ERROR EbmDataSet::CheckInstanceIndexes instance index out of range");
+         return true;
+      }
+   }
+   return false;
+}
+
+void * EbmDataSet::GatherTargets(const size_t cIndexes, const IntegerDataType * const aInstanceIndexes) const {
+   EBM_ASSERT(0 != cIndexes);
+   EBM_ASSERT(nullptr != aInstanceIndexes);
+   EBM_ASSERT(nullptr != m_aTargets);
+
+   if(IsMultiplyError(sizeof(IntegerDataType), cIndexes)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmDataSet::GatherTargets IsMultiplyError(sizeof(IntegerDataType), cIndexes)");
+      return nullptr;
+   }
+   IntegerDataType * const aTargetsTo = static_cast<IntegerDataType *>(malloc(sizeof(IntegerDataType) * cIndexes));
+   if(nullptr == aTargetsTo) {
+      LOG_0(TraceLevelWarning, "WARNING EbmDataSet::GatherTargets nullptr == aTargetsTo");
+      return nullptr;
+   }
+   // regression targets are the same size, and we only move them, so we can copy both kinds as IntegerDataType
+   const IntegerDataType * const aTargetsFrom = static_cast<const IntegerDataType *>(m_aTargets);
+   for(size_t iIndex = 0; iIndex < cIndexes; ++iIndex) {
+      aTargetsTo[iIndex] = aTargetsFrom[static_cast<size_t>(aInstanceIndexes[iIndex])];
+   }
+   return aTargetsTo;
+}
+
+bool EbmDataSet::GetStartingPredictorScores(const FractionalDataType * const aPredictorScoresCaller, const size_t cIndexes, const IntegerDataType * const aInstanceIndexes, const FractionalDataType ** const paPredictorScoresReturn, FractionalDataType ** const paGathered) const {
+   *paGathered = nullptr;
+   if(nullptr != aPredictorScoresCaller || nullptr == m_aPredictorScores || nullptr == aInstanceIndexes) {
+      *paPredictorScoresReturn = nullptr != aPredictorScoresCaller ? aPredictorScoresCaller : m_aPredictorScores;
+      return false;
+   }
+   *paPredictorScoresReturn = nullptr;
+   if(0 == cIndexes) {
+      return false;
+   }
+
+   const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
+   if(IsMultiplyError(cVectorLength, cIndexes) || IsMultiplyError(sizeof(FractionalDataType), cVectorLength * cIndexes)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmDataSet::GetStartingPredictorScores IsMultiplyError(sizeof(FractionalDataType), cVectorLength * cIndexes)");
+      return true;
+   }
+   FractionalDataType * const aGathered = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * cVectorLength * cIndexes));
+   if(nullptr == aGathered) {
+      LOG_0(TraceLevelWarning, "WARNING EbmDataSet::GetStartingPredictorScores nullptr == aGathered");
+      return true;
+   }
+   FractionalDataType * pGathered = aGathered;
+   for(size_t iIndex = 0; iIndex < cIndexes; ++iIndex) {
+      const FractionalDataType * const pFrom = &m_aPredictorScores[static_cast<size_t>(aInstanceIndexes[iIndex]) * cVectorLength];
+      memcpy(pGathered, pFrom, sizeof(FractionalDataType) * cVectorLength);
+      pGathered += cVectorLength;
+   }
+   *paGathered = aGathered;
+   *paPredictorScoresReturn = aGathered;
+   return false;
+}
+
+static EbmDataSet * AllocateDataSet(const IntegerDataType countFeatures, const EbmCoreFeature * const features, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const IntegerDataType countInstances, const void * const targets, const EbmCoreBinnedData * const binnedData) {
+   if(countFeatures < 0) {
+      LOG_0(TraceLevelError, "ERROR AllocateDataSet countFeatures can't be negative");
+      return nullptr;
+   }
+   if(0 != countFeatures && nullptr == features) {
+      LOG_0(TraceLevelError, "ERROR AllocateDataSet features can't be nullptr");
+      return nullptr;
+   }
+   if(countInstances < 0) {
+      LOG_0(TraceLevelError, "ERROR AllocateDataSet countInstances can't be negative");
+      return nullptr;
+   }
+   if(0 != countInstances && nullptr == targets) {
+      LOG_0(TraceLevelError, "ERROR AllocateDataSet targets can't be nullptr");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateDataSet !IsNumberConvertable<size_t, IntegerDataType>(countFeatures)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateDataSet !IsNumberConvertable<size_t, IntegerDataType>(countInstances)");
+      return nullptr;
+   }
+
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cInstances = static_cast<size_t>(countInstances);
+
+   BinnedDataView binnedDataView;
+   if(binnedDataView.Initialize(cFeatures, cInstances, binnedData)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateDataSet binnedDataView.Initialize");
+      return nullptr;
+   }
+
+   EbmDataSet * const pEbmDataSet = new (std::nothrow) EbmDataSet(runtimeLearningTypeOrCountTargetClasses, cFeatures, cInstances);
+   if(UNLIKELY(nullptr == pEbmDataSet)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateDataSet nullptr == pEbmDataSet");
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmDataSet->Initialize(features, targets, &binnedDataView))) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateDataSet pEbmDataSet->Initialize");
+      EbmDataSet::Release(pEbmDataSet);
+      return nullptr;
+   }
+   return pEbmDataSet;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmDataSet EBMCORE_CALLING_CONVENTION CreateDataSetRegression(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const EbmCoreBinnedData * binnedData
+) {
+   LOG_N(TraceLevelInfo, "Entered CreateDataSetRegression: countFeatures=%" IntegerDataTypePrintf ", features=%p, countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p", countFeatures, static_cast<const void *>(features), countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData));
+   const PEbmDataSet pEbmDataSet = reinterpret_cast<PEbmDataSet>(AllocateDataSet(countFeatures, features, k_Regression, countInstances, targets, binnedData));
+   LOG_N(TraceLevelInfo, "Exited CreateDataSetRegression %p", static_cast<void *>(pEbmDataSet));
+   return pEbmDataSet;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmDataSet EBMCORE_CALLING_CONVENTION CreateDataSetClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const EbmCoreBinnedData * binnedData
+) {
+   LOG_N(TraceLevelInfo, "Entered CreateDataSetClassification: countFeatures=%" IntegerDataTypePrintf ", features=%p, countTargetClasses=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p", countFeatures, static_cast<const void *>(features), countTargetClasses, countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData));
+   if(countTargetClasses < 0) {
+      LOG_0(TraceLevelError, "ERROR CreateDataSetClassification countTargetClasses can't be negative");
+      return nullptr;
+   }
+   if(0 == countTargetClasses && 0 != countInstances) {
+      LOG_0(TraceLevelError, "ERROR CreateDataSetClassification countTargetClasses can't be zero unless there are no instances");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
+      LOG_0(TraceLevelWarning, "WARNING CreateDataSetClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      return nullptr;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
+   const PEbmDataSet pEbmDataSet = reinterpret_cast<PEbmDataSet>(AllocateDataSet(countFeatures, features, runtimeLearningTypeOrCountTargetClasses, countInstances, targets, binnedData));
+   LOG_N(TraceLevelInfo, "Exited CreateDataSetClassification %p", static_cast<void *>(pEbmDataSet));
+   return pEbmDataSet;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeDataSet(
+   PEbmDataSet ebmDataSet
+) {
+   LOG_N(TraceLevelInfo, "Entered FreeDataSet: ebmDataSet=%p", static_cast<void *>(ebmDataSet));
+   EbmDataSet * const pEbmDataSet = reinterpret_cast<EbmDataSet *>(ebmDataSet);
+   EBM_ASSERT(nullptr != pEbmDataSet);
+   // training and interaction states that still use our packed data keep the dataset alive until they are freed
+   EbmDataSet::Release(pEbmDataSet);
+   LOG_0(TraceLevelInfo, "Exited FreeDataSet");
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION WriteDataSetFile(
+   PEbmDataSet ebmDataSet,
+   const FractionalDataType * predictorScores,
+   const char * path
+) {
+   LOG_N(TraceLevelInfo, "Entered WriteDataSetFile: ebmDataSet=%p, predictorScores=%p, path=%p", static_cast<void *>(ebmDataSet), static_cast<const void *>(predictorScores), static_cast<const void *>(path));
+
+   const EbmDataSet * const pEbmDataSet = reinterpret_cast<const EbmDataSet *>(ebmDataSet);
+   if(nullptr == pEbmDataSet) {
+      LOG_0(TraceLevelError, "ERROR WriteDataSetFile nullptr == ebmDataSet");
+      return 1;
+   }
+   if(nullptr == path) {
+      LOG_0(TraceLevelError, "ERROR WriteDataSetFile nullptr == path");
+      return 1;
+   }
+   const FractionalDataType * const aPredictorScores = nullptr != predictorScores ? predictorScores : pEbmDataSet->m_aPredictorScores;
+
+   size_t cBytesFeatures;
+   size_t cBytesTargets;
+   size_t cBytesPredictorScores;
+   if(GetDataSetFileLayout(pEbmDataSet->m_runtimeLearningTypeOrCountTargetClasses, pEbmDataSet->m_cFeatures, pEbmDataSet->m_cInstances, nullptr != aPredictorScores, &cBytesFeatures, &cBytesTargets, &cBytesPredictorScores)) {
+      LOG_0(TraceLevelWarning, "WARNING WriteDataSetFile GetDataSetFileLayout");
+      return 1;
+   }
+
+   DataSetFileHeader header;
+   memcpy(header.m_magic, k_dataSetFileMagic, sizeof(header.m_magic));
+   header.m_version = k_dataSetFileVersion;
+   header.m_cBytesStorageDataType = static_cast<IntegerDataType>(sizeof(StorageDataTypeCore));
+   header.m_runtimeLearningTypeOrCountTargetClasses = static_cast<IntegerDataType>(pEbmDataSet->m_runtimeLearningTypeOrCountTargetClasses);
+   header.m_cFeatures = static_cast<IntegerDataType>(pEbmDataSet->m_cFeatures);
+   header.m_cInstances = static_cast<IntegerDataType>(pEbmDataSet->m_cInstances);
+   header.m_bPredictorScores = nullptr != aPredictorScores && 0 != pEbmDataSet->m_cInstances ? 1 : 0;
+
+   FILE * const pFile = fopen(path, "wb");
+   if(nullptr == pFile) {
+      LOG_0(TraceLevelWarning, "WARNING WriteDataSetFile fopen");
+      return 1;
+   }
+   // we write everything in one sequential pass
+   bool bError = 1 != fwrite(&header, sizeof(header), 1, pFile);
+   if(!bError && 0 != cBytesFeatures) {
+      bError = 1 != fwrite(pEbmDataSet->m_aEbmCoreFeatures, cBytesFeatures, 1, pFile);
+   }
+   if(!bError && 0 != pEbmDataSet->m_cInstances) {
+      bError = 1 != fwrite(pEbmDataSet->m_aTargets, cBytesTargets, 1, pFile);
+      if(!bError && 0 != header.m_bPredictorScores) {
+         bError = 1 != fwrite(aPredictorScores, cBytesPredictorScores, 1, pFile);
+      }
+      if(!bError && 0 != pEbmDataSet->m_cFeatures) {
+         for(size_t iFeature = 0; iFeature < pEbmDataSet->m_cFeatures; ++iFeature) {
+            const size_t cDataUnits = (pEbmDataSet->m_cInstances - 1) / pEbmDataSet->m_aFeatures[iFeature].m_cItemsPerBitPackDataUnit + 1; // this can't overflow or underflow
+            if(1 != fwrite(pEbmDataSet->m_aaInputData[iFeature], sizeof(StorageDataTypeCore) * cDataUnits, 1, pFile)) {
+               bError = true;
+               break;
+            }
+         }
+      }
+   }
+   if(0 != fclose(pFile)) {
+      bError = true;
+   }
+   if(bError) {
+      LOG_0(TraceLevelWarning, "WARNING WriteDataSetFile fwrite");
+      return 1;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited WriteDataSetFile");
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmDataSet EBMCORE_CALLING_CONVENTION OpenDataSetFile(
+   const char * path
+) {
+   LOG_N(TraceLevelInfo, "Entered OpenDataSetFile: path=%p", static_cast<const void *>(path));
+
+   if(nullptr == path) {
+      LOG_0(TraceLevelError, "ERROR OpenDataSetFile nullptr == path");
+      return nullptr;
+   }
+   size_t cBytesMapping = 0;
+   void * const pMapping = MapFile(path, sizeof(DataSetFileHeader), &cBytesMapping);
+   if(nullptr == pMapping) {
+      LOG_0(TraceLevelWarning, "WARNING OpenDataSetFile MapFile");
+      return nullptr;
+   }
+
+   const DataSetFileHeader * const pHeader = static_cast<const DataSetFileHeader *>(pMapping);
+   if(0 != memcmp(pHeader->m_magic, k_dataSetFileMagic, sizeof(pHeader->m_magic))) {
+      LOG_0(TraceLevelError, "ERROR OpenDataSetFile the file is not an EBM dataset");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+   if(k_dataSetFileVersion != pHeader->m_version) {
+      LOG_0(TraceLevelError, "ERROR OpenDataSetFile unsupported file version");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+   if(static_cast<IntegerDataType>(sizeof(StorageDataTypeCore)) != pHeader->m_cBytesStorageDataType) {
+      LOG_0(TraceLevelError, "ERROR OpenDataSetFile the file was bit packed by a build with a different StorageDataTypeCore");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+   if(pHeader->m_cFeatures < 0 || pHeader->m_cInstances < 0 || !IsNumberConvertable<size_t, IntegerDataType>(pHeader->m_cFeatures) || !IsNumberConvertable<size_t, IntegerDataType>(pHeader->m_cInstances) || !IsNumberConvertable<ptrdiff_t, IntegerDataType>(pHeader->m_runtimeLearningTypeOrCountTargetClasses)) {
+      LOG_0(TraceLevelError, "ERROR OpenDataSetFile invalid counts");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(pHeader->m_runtimeLearningTypeOrCountTargetClasses);
+   if(!IsRegression(runtimeLearningTypeOrCountTargetClasses) && (runtimeLearningTypeOrCountTargetClasses < 0 || 0 == runtimeLearningTypeOrCountTargetClasses && 0 != pHeader->m_cInstances)) {
+      LOG_0(TraceLevelError, "ERROR OpenDataSetFile invalid countTargetClasses");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+
+   EbmDataSet * const pEbmDataSet = new (std::nothrow) EbmDataSet(runtimeLearningTypeOrCountTargetClasses, static_cast<size_t>(pHeader->m_cFeatures), static_cast<size_t>(pHeader->m_cInstances));
+   if(UNLIKELY(nullptr == pEbmDataSet)) {
+      LOG_0(TraceLevelWarning, "WARNING OpenDataSetFile nullptr == pEbmDataSet");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmDataSet->InitializeMapping(pMapping, cBytesMapping))) {
+      LOG_0(TraceLevelWarning, "WARNING OpenDataSetFile pEbmDataSet->InitializeMapping");
+      EbmDataSet::Release(pEbmDataSet);
+      return nullptr;
+   }
+
+   const PEbmDataSet ebmDataSet = reinterpret_cast<PEbmDataSet>(pEbmDataSet);
+   LOG_N(TraceLevelInfo, "Exited OpenDataSetFile %p", static_cast<void *>(ebmDataSet));
+   return ebmDataSet;
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef EBM_DATA_SET_H
+#define EBM_DATA_SET_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <atomic>
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+// feature includes
+#include "FeatureCore.h"
+// dataset depends on features
+#include "BinnedDataView.h"
+
+// a binned dataset that our caller creates once, and then uses for any number of training and interaction states with different feature
+// combinations and instance subsets.  We bit pack each feature the same way that DataSetByFeature does, so an interaction state over every
+// instance can use our packed data directly, and everything else re-packs from it through BinnedDataReaderPacked instead of from our caller's
+// buffer.  The states that share our memory hold a reference, so our caller can free the dataset as soon as the states are initialized.
+// A dataset can also be written to a file and opened again by mapping the file, in which case our arrays point into the mapped pages
+class EbmDataSet final {
+   std::atomic<size_t> m_cReferences;
+
+public:
+   const ptrdiff_t m_runtimeLearningTypeOrCountTargetClasses;
+   const size_t m_cFeatures;
+   const size_t m_cInstances;
+   // we keep our caller's feature descriptions so that the training and interaction states can initialize their features the same way as always
+   const EbmCoreFeature * m_aEbmCoreFeatures;
+   FeatureCore * m_aFeatures;
+   // FractionalDataType for regression, IntegerDataType for classification
+   const void * m_aTargets;
+   const StorageDataTypeCore * const * m_aaInputData;
+   // the initial predictor scores of a dataset opened from a file, or nullptr.  States that are given no predictor scores start from these
+   const FractionalDataType * m_aPredictorScores;
+   // if we were opened from a file, then everything above except m_aFeatures and the m_aaInputData array itself lives in this mapping
+   void * m_pMapping;
+   size_t m_cBytesMapping;
+
+   EBM_INLINE EbmDataSet(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatures, const size_t cInstances)
+      : m_cReferences(1)
+      , m_runtimeLearningTypeOrCountTargetClasses(runtimeLearningTypeOrCountTargetClasses)
+      , m_cFeatures(cFeatures)
+      , m_cInstances(cInstances)
+      , m_aEbmCoreFeatures(nullptr)
+      , m_aFeatures(nullptr)
+      , m_aTargets(nullptr)
+      , m_aaInputData(nullptr)
+      , m_aPredictorScores(nullptr)
+      , m_pMapping(nullptr)
+      , m_cBytesMapping(0) {
+   }
+
+   ~EbmDataSet();
+
+   EBM_INLINE void AddReference() {
+      m_cReferences.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   // deletes the dataset once the last reference is gone.  pEbmDataSet can be nullptr
+   EBM_INLINE static void Release(EbmDataSet * const pEbmDataSet) {
+      if(nullptr != pEbmDataSet) {
+         if(1 == pEbmDataSet->m_cReferences.fetch_sub(1, std::memory_order_acq_rel)) {
+            delete pEbmDataSet;
+         }
+      }
+   }
+
+   bool InitializeFeatures(const EbmCoreFeature * const aFeatures);
+   bool Initialize(const EbmCoreFeature * const aFeatures, const void * const aTargets, const BinnedDataView * const pBinnedData);
+   // takes ownership of the mapping, even on error
+   bool InitializeMapping(void * const pMapping, const size_t cBytesMapping);
+
+   // returns true if any of the indexes is outside of our instances
+   bool CheckInstanceIndexes(const size_t cIndexes, const IntegerDataType * const aInstanceIndexes) const;
+   // copies the targets of aInstanceIndexes in order into a new buffer that our caller frees.  Returns nullptr on error
+   void * GatherTargets(const size_t cIndexes, const IntegerDataType * const aInstanceIndexes) const;
+   // the predictor scores to start a state from, which are our caller's if they gave us any, then ours, or nullptr for zeros.  If we gather a
+   // subset of our scores, *paGathered receives the buffer, which our caller frees.  Returns true on error
+   bool GetStartingPredictorScores(const FractionalDataType * const aPredictorScoresCaller, const size_t cIndexes, const IntegerDataType * const aInstanceIndexes, const FractionalDataType ** const paPredictorScoresReturn, FractionalDataType ** const paGathered) const;
+
+   EBM_INLINE void InitializeBinnedDataView(BinnedDataView * const pBinnedData, const IntegerDataType * const aInstanceIndexes) const {
+      pBinnedData->InitializePacked(m_aFeatures, m_aaInputData, aInstanceIndexes);
+   }
+};
+
+#endif // EBM_DATA_SET_H
@@ -0,0 +1,75 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <ebm@koch.ninja>
+
+#ifndef EBM_ENSEMBLE_TRAINING_STATE_H
+#define EBM_ENSEMBLE_TRAINING_STATE_H
+
+#include <string.h> // memset
+#include <stddef.h> // size_t, ptrdiff_t
+#include <new> // std::nothrow
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "DataSetByFeatureCombination.h"
+#include "EbmTrainingState.h"
+#include "ThreadPool.h"
+
+// an ensemble of outer bags that are trained on the same instances.  The packed input data and the targets are held once in m_pSharedDataSet, and
+// every bag is an ordinary EbmTrainingState with its own predictor scores, residuals, sampling sets and models whose training set shares that packed data.
+// Each bag holds out a different subset of the instances for validation
+class EbmEnsembleTrainingState final {
+public:
+   const ptrdiff_t m_runtimeLearningTypeOrCountTargetClasses;
+   const size_t m_cFeatureCombinations;
+
+   DataSetByFeatureCombination * m_pSharedDataSet;
+
+   const size_t m_cBags;
+   EbmTrainingState ** const m_apBags;
+
+   // the bags are trained in parallel on this pool with one bag per thread at a time, and each bag trains serially on the thread that picked it up
+   size_t m_cThreads;
+   ThreadPool * m_pThreadPool;
+
+   EBM_INLINE EbmEnsembleTrainingState(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatureCombinations, const size_t cBags, const size_t cThreads)
+      : m_runtimeLearningTypeOrCountTargetClasses(runtimeLearningTypeOrCountTargetClasses)
+      , m_cFeatureCombinations(cFeatureCombinations)
+      , m_pSharedDataSet(nullptr)
+      , m_cBags(cBags)
+      , m_apBags(new (std::nothrow) EbmTrainingState *[cBags])
+      // SetCountThreads sets these for real once we know how many threads the pool was able to start
+      , m_cThreads(cThreads)
+      , m_pThreadPool(nullptr) {
+      EBM_ASSERT(1 <= cBags);
+      EBM_ASSERT(1 <= cThreads);
+      if(nullptr != m_apBags) {
+         memset(m_apBags, 0, sizeof(*m_apBags) * cBags); // this needs to be done immediately after allocation otherwise we might attempt to free random garbage on an error
+      }
+   }
+
+   EBM_INLINE ~EbmEnsembleTrainingState() {
+      LOG_0(TraceLevelInfo, "Entered ~EbmEnsembleTrainingState");
+
+      // stop the pool threads before freeing anything that a task could be using
+      ThreadPool::Free(m_pThreadPool);
+
+      if(nullptr != m_apBags) {
+         // the bags share the packed data of m_pSharedDataSet, so they need to go first
+         for(size_t iBag = 0; iBag < m_cBags; ++iBag) {
+            delete m_apBags[iBag];
+         }
+         delete[] m_apBags;
+      }
+      delete m_pSharedDataSet;
+
+      LOG_0(TraceLevelInfo, "Exited ~EbmEnsembleTrainingState");
+   }
+
+   bool SetCountThreads(const size_t cThreads);
+   bool SetPrecomputedDenominators(const bool bPrecomputedDenominators);
+   bool Initialize(const IntegerDataType * const aRandomSeeds, const size_t cFeatures, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cInnerBags, const size_t cInstances, const void * const aTargets, const IntegerDataType * const aBinnedData, const FractionalDataType * const aPredictorScores, const IntegerDataType * const aValidationMasks);
+};
+
+#endif // EBM_ENSEMBLE_TRAINING_STATE_H
@@ -5,6 +5,7 @@
 #ifndef EBM_INTERACTION_STATE_H
 #define EBM_INTERACTION_STATE_H
 
+#include <string.h> // memset
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // numeric_limits
@@ -16,6 +17,9 @@
 #include "FeatureCore.h"
 // dataset depends on features
 #include "DataSetByFeature.h"
+#include "EbmDataSet.h"
+#include "CachedThreadResources.h"
+#include "ThreadPool.h"
 
 class EbmInteractionState {
 public:
@@ -25,15 +29,33 @@ public:
    // TODO : in the future, we can allocate this inside a function so that even the objects inside are const
    FeatureCore * const m_aFeatures;
    DataSetByFeature * m_pDataSet;
+   // if m_pDataSet uses the bit packed data of an EbmDataSet, we hold a reference to it so that it outlives m_pDataSet
+   EbmDataSet * m_pSharedDataSet;
+
+   // the total number of threads we can use, including the calling thread.  The pool threads are shared by every parallel kernel that works on this state
+   size_t m_cThreads;
+   ThreadPool * m_pThreadPool;
+
+   // the resources for the calling thread, which we keep between calls so that we don't need to reallocate our histograms for every interaction score
+   CachedInteractionThreadResources * const m_pCachedThreadResources;
+   // when we score many feature combinations at once, worker zero is the calling thread and uses m_pCachedThreadResources above.  Each additional
+   // worker runs as a task on the thread pool, so it needs its own resources.  There is one additional worker for each pool thread
+   CachedInteractionThreadResources ** m_apAdditionalWorkerCachedThreadResources;
 
    unsigned int m_cLogEnterMessages;
    unsigned int m_cLogExitMessages;
 
-   EBM_INLINE EbmInteractionState(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatures)
+   EBM_INLINE EbmInteractionState(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatures, const size_t cThreads)
       : m_runtimeLearningTypeOrCountTargetClasses(runtimeLearningTypeOrCountTargetClasses)
       , m_cFeatures(cFeatures)
       , m_aFeatures(0 == cFeatures || IsMultiplyError(sizeof(FeatureCore), cFeatures) ? nullptr : static_cast<FeatureCore *>(malloc(sizeof(FeatureCore) * cFeatures)))
       , m_pDataSet(nullptr)
+      , m_pSharedDataSet(nullptr)
+      // SetCountThreads sets these for real once we know how many threads the pool was able to start
+      , m_cThreads(cThreads)
+      , m_pThreadPool(nullptr)
+      , m_pCachedThreadResources(new (std::nothrow) CachedInteractionThreadResources())
+      , m_apAdditionalWorkerCachedThreadResources(nullptr)
       , m_cLogEnterMessages(1000)
       , m_cLogExitMessages(1000) {
    }
@@ -41,15 +63,104 @@ public:
    EBM_INLINE ~EbmInteractionState() {
       LOG_0(TraceLevelInfo, "Entered ~EbmInteractionState");
 
+      // stop the pool threads before freeing anything that a task could be using
+      ThreadPool::Free(m_pThreadPool);
+      DeleteAdditionalWorkers();
+      delete m_pCachedThreadResources;
+
       delete m_pDataSet;
+      EbmDataSet::Release(m_pSharedDataSet);
       free(m_aFeatures);
 
       LOG_0(TraceLevelInfo, "Exited ~EbmInteractionState");
    }
 
-   EBM_INLINE bool InitializeInteraction(const EbmCoreFeature * const aFeatures, const size_t cInstances, const void * const aTargets, const IntegerDataType * const aBinnedData, const FractionalDataType * const aPredictorScores) {
+   EBM_INLINE void DeleteAdditionalWorkers() {
+      if(nullptr != m_apAdditionalWorkerCachedThreadResources) {
+         EBM_ASSERT(1 < m_cThreads);
+         const size_t cAdditionalWorkers = m_cThreads - 1;
+         for(size_t iAdditionalWorker = 0; iAdditionalWorker < cAdditionalWorkers; ++iAdditionalWorker) {
+            delete m_apAdditionalWorkerCachedThreadResources[iAdditionalWorker];
+         }
+         delete[] m_apAdditionalWorkerCachedThreadResources;
+         m_apAdditionalWorkerCachedThreadResources = nullptr;
+      }
+   }
+
+   EBM_INLINE bool InitializeAdditionalWorkers() {
+      EBM_ASSERT(nullptr == m_apAdditionalWorkerCachedThreadResources);
+      EBM_ASSERT(1 <= m_cThreads);
+      const size_t cAdditionalWorkers = m_cThreads - 1;
+      if(0 != cAdditionalWorkers) {
+         m_apAdditionalWorkerCachedThreadResources = new (std::nothrow) CachedInteractionThreadResources *[cAdditionalWorkers];
+         if(UNLIKELY(nullptr == m_apAdditionalWorkerCachedThreadResources)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmInteractionState::InitializeAdditionalWorkers nullptr == m_apAdditionalWorkerCachedThreadResources");
+            return true;
+         }
+         memset(m_apAdditionalWorkerCachedThreadResources, 0, sizeof(*m_apAdditionalWorkerCachedThreadResources) * cAdditionalWorkers); // this needs to be done immediately after allocation otherwise we might attempt to free random garbage on an error
+         for(size_t iAdditionalWorker = 0; iAdditionalWorker < cAdditionalWorkers; ++iAdditionalWorker) {
+            CachedInteractionThreadResources * const pCachedThreadResources = new (std::nothrow) CachedInteractionThreadResources();
+            if(UNLIKELY(nullptr == pCachedThreadResources)) {
+               LOG_0(TraceLevelWarning, "WARNING EbmInteractionState::InitializeAdditionalWorkers nullptr == pCachedThreadResources");
+               return true;
+            }
+            m_apAdditionalWorkerCachedThreadResources[iAdditionalWorker] = pCachedThreadResources;
+         }
+      }
+      return false;
+   }
+
+   EBM_INLINE CachedInteractionThreadResources * GetCachedThreadResources(const size_t iWorker) {
+      EBM_ASSERT(iWorker < m_cThreads);
+      return 0 == iWorker ? m_pCachedThreadResources : m_apAdditionalWorkerCachedThreadResources[iWorker - 1];
+   }
+
+   EBM_INLINE bool SetCountThreads(const size_t cThreads) {
+      LOG_N(TraceLevelInfo, "Entered EbmInteractionState::SetCountThreads: cThreads=%zu", cThreads);
+
+      EBM_ASSERT(1 <= cThreads);
+
+      // the pool threads only run tasks while we're inside a call that is waiting on them, so there is nothing running right now
+      ThreadPool::Free(m_pThreadPool);
+      m_pThreadPool = nullptr;
+      DeleteAdditionalWorkers();
+      m_cThreads = 1;
+
+      ThreadPool * const pThreadPool = ThreadPool::Allocate(cThreads);
+      if(UNLIKELY(nullptr == pThreadPool)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmInteractionState::SetCountThreads nullptr == pThreadPool");
+         return true;
+      }
+      m_pThreadPool = pThreadPool;
+      m_cThreads = pThreadPool->GetCountThreads();
+      if(UNLIKELY(InitializeAdditionalWorkers())) {
+         LOG_0(TraceLevelWarning, "WARNING EbmInteractionState::SetCountThreads InitializeAdditionalWorkers()");
+         // leave ourselves in a state where we can still score on the calling thread
+         DeleteAdditionalWorkers();
+         ThreadPool::Free(m_pThreadPool);
+         m_pThreadPool = nullptr;
+         m_cThreads = 1;
+         return true;
+      }
+
+      LOG_0(TraceLevelInfo, "Exited EbmInteractionState::SetCountThreads");
+      return false;
+   }
+
+   // if pSharedDataSet isn't nullptr, then our instances are all of its instances in order, and we use its bit packed data instead of pBinnedData
+   EBM_INLINE bool InitializeInteraction(const EbmCoreFeature * const aFeatures, const size_t cInstances, const void * const aTargets, const BinnedDataView * const pBinnedData, const FractionalDataType * const aPredictorScores, EbmDataSet * const pSharedDataSet) {
       LOG_0(TraceLevelInfo, "Entered InitializeInteraction");
 
+      if(UNLIKELY(nullptr == m_pCachedThreadResources)) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeInteraction nullptr == m_pCachedThreadResources");
+         return true;
+      }
+
+      if(UNLIKELY(SetCountThreads(m_cThreads))) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeInteraction SetCountThreads(m_cThreads)");
+         return true;
+      }
+
       if(0 != m_cFeatures && nullptr == m_aFeatures) {
          LOG_0(TraceLevelWarning, "WARNING InitializeInteraction 0 != m_cFeatures && nullptr == m_aFeatures");
          return true;
@@ -99,7 +210,15 @@ public:
       LOG_0(TraceLevelInfo, "Entered DataSetByFeature");
       EBM_ASSERT(nullptr == m_pDataSet);
       if(0 != cInstances) {
-         m_pDataSet = new (std::nothrow) DataSetByFeature(m_cFeatures, m_aFeatures, cInstances, aBinnedData, aTargets, aPredictorScores, m_runtimeLearningTypeOrCountTargetClasses);
+         if(nullptr != pSharedDataSet) {
+            EBM_ASSERT(cInstances == pSharedDataSet->m_cInstances);
+            EBM_ASSERT(m_cFeatures == pSharedDataSet->m_cFeatures);
+            pSharedDataSet->AddReference();
+            m_pSharedDataSet = pSharedDataSet;
+            m_pDataSet = new (std::nothrow) DataSetByFeature(m_cFeatures, pSharedDataSet->m_aaInputData, cInstances, aTargets, aPredictorScores, m_runtimeLearningTypeOrCountTargetClasses);
+         } else {
+            m_pDataSet = new (std::nothrow) DataSetByFeature(m_cFeatures, m_aFeatures, cInstances, pBinnedData, aTargets, aPredictorScores, m_runtimeLearningTypeOrCountTargetClasses);
+         }
          if(nullptr == m_pDataSet || m_pDataSet->IsError()) {
             LOG_0(TraceLevelWarning, "WARNING InitializeInteraction nullptr == pDataSet || pDataSet->IsError()");
             return true;
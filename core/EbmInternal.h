@@ -168,6 +168,16 @@ static_assert(2 <= k_cCompilerOptimizedTargetClassesMax, "we special case binary
 // TODO : eliminate this typedef.. we bitpack our memory now, so we'll always want to use the biggest chunk of memory possible, which will be size_t
 typedef size_t StorageDataTypeCore;
 
+// the per-instance residuals and predictor scores are the largest arrays that we stream through on every boosting step, so building with
+// EBM_FLOAT_RESIDUALS stores them in single precision to halve that memory and bandwidth.  Everything that accumulates over instances (histogram
+// buckets, tree nodes, gains, validation metrics and the model tensors) stays in FractionalDataType, and we always compute in FractionalDataType
+// and only round when storing back into these arrays
+#ifdef EBM_FLOAT_RESIDUALS
+typedef float StorageFractionalDataTypeCore;
+#else // EBM_FLOAT_RESIDUALS
+typedef double StorageFractionalDataTypeCore;
+#endif // EBM_FLOAT_RESIDUALS
+
 // TODO : add a MinusOneSizet const (size_t)(-1) -> turn most ptrdiff_t into size_t and use this constant where we just need a single negative number
 // TODO : eliminate this typedef.. we bitpack our memory now, so we'll always want to use the biggest chunk of memory possible, which will be size_t
 // we get a signed/unsigned mismatch if we use size_t in SegmentedRegion because we use whole numbers there
@@ -0,0 +1,1403 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stdlib.h> // malloc, free
+#include <string.h> // memcpy, memcmp, memset, strlen
+#include <stddef.h> // size_t, ptrdiff_t
+#include <inttypes.h> // uint64_t
+#include <stdio.h> // FILE, fopen, fwrite
+#include <atomic>
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "FileMapping.h"
+#include "IsaKernels.h"
+#include "ParallelChunks.h"
+#include "Scoring.h"
+#include "ThreadPool.h"
+
+#include "EbmModel.h"
+
+// if a bucket of categories can't find a displacement that puts them all in free slots after this many tries, then our caller almost certainly
+// gave us something we can't hash, so we give up instead of looping for a very long time
+constexpr IntegerDataType k_cCategoryDisplacementTriesMax = IntegerDataType { 1 } << 24;
+
+// a model file is this header, then m_cScores intercept logits, then m_cFeatures ModelFileFeature items, then m_cTerms ModelFileTerm items, then
+// the m_cDimensions ModelFileDimension items of all the terms, then m_cTerms ModelFileQuantizedTerm items if the model is quantized, then the cut
+// points of the ordinal features, then the displacements of the nominal features, then their EbmModelCategory slots, then the tensors of the
+// terms, and last the text of the categories.  Each of these parts holds the parts of every feature or term one after another in order.  The
+// tensors hold FractionalDataType items, or m_cBitsQuantized bit unsigned integers followed by zero padding to a multiple of 8 bytes.  Every other
+// item is 8 bytes, so every array is aligned within the mapping.  The file is little endian with IEEE doubles, which is what every host that we
+// build for uses, and we refuse to read or write it anywhere else.  Opening a file only reads the small parts before the tensors, so the tensors
+// are paged in as scoring reads them
+struct ModelFileHeader final {
+   char m_magic[8];
+   IntegerDataType m_version;
+   IntegerDataType m_cScores;
+   IntegerDataType m_cFeatures;
+   IntegerDataType m_cTerms;
+   IntegerDataType m_cDimensions;
+   IntegerDataType m_cCuts;
+   IntegerDataType m_cCategories;
+   IntegerDataType m_cTensorItems;
+   IntegerDataType m_cBytesCategoryText;
+   IntegerDataType m_cBitsQuantized;
+};
+static_assert(0 == sizeof(ModelFileHeader) % 8, "the arrays after our header need to be aligned");
+
+struct ModelFileFeature final {
+   IntegerDataType m_featureType;
+   IntegerDataType m_cBins;
+   IntegerDataType m_cBytesCategoryText;
+};
+
+struct ModelFileTerm final {
+   IntegerDataType m_cDimensions;
+   IntegerDataType m_cItems;
+};
+
+struct ModelFileDimension final {
+   IntegerDataType m_iFeature;
+   IntegerDataType m_cItemsMultiple;
+};
+
+struct ModelFileQuantizedTerm final {
+   FractionalDataType m_scale;
+   FractionalDataType m_offset;
+};
+
+static_assert(8 == sizeof(IntegerDataType) && 8 == sizeof(FractionalDataType) && std::numeric_limits<FractionalDataType>::is_iec559, "model files hold 8 byte integers and IEEE doubles");
+static_assert(0 == sizeof(EbmModelCategory) % 8, "the arrays after our categories need to be aligned");
+
+static constexpr char k_modelFileMagic[8] = { 'E', 'B', 'M', 'M', 'O', 'D', 'E', 'L' };
+static constexpr IntegerDataType k_modelFileVersion = 1;
+
+EBM_INLINE static bool IsLittleEndian() {
+   const uint16_t one = 1;
+   unsigned char firstByte;
+   memcpy(&firstByte, &one, sizeof(firstByte));
+   return 1 == firstByte;
+}
+
+// FNV-1a over the text with the seed folded into its starting value, followed by the splitmix64 finalizer so that every bit of the seed and the
+// text reaches the low bits, which are the ones that the modulo keeps.  Each seed gives an independent enough hash for the displacement search
+EBM_INLINE static uint64_t HashCategory(const uint64_t seed, const char * const pText, const size_t cBytes) {
+   uint64_t hash = uint64_t { 0xCBF29CE484222325 } ^ (seed * uint64_t { 0x9E3779B97F4A7C15 });
+   for(size_t iByte = 0; iByte < cBytes; ++iByte) {
+      hash ^= static_cast<uint64_t>(static_cast<unsigned char>(pText[iByte]));
+      hash *= uint64_t { 0x100000001B3 };
+   }
+   hash ^= hash >> 30;
+   hash *= uint64_t { 0xBF58476D1CE4E5B9 };
+   hash ^= hash >> 27;
+   hash *= uint64_t { 0x94D049BB133111EB };
+   hash ^= hash >> 31;
+   return hash;
+}
+
+EBM_INLINE static size_t GetCutBin(const FractionalDataType * const aCuts, const size_t cCuts, const FractionalDataType value) {
+   if(0 == cCuts) {
+      return 0;
+   }
+   // a branchless upper bound.  Each step halves the range with a conditional move instead of a hard to predict branch, and the loop count only
+   // depends on cCuts
+   const FractionalDataType * pBase = aCuts;
+   size_t cRemaining = cCuts;
+   while(1 < cRemaining) {
+      const size_t cHalf = cRemaining >> 1;
+      pBase = value < pBase[cHalf] ? pBase : pBase + cHalf;
+      cRemaining -= cHalf;
+   }
+   return static_cast<size_t>(pBase - aCuts) + (value < *pBase ? size_t { 0 } : size_t { 1 });
+}
+
+EBM_INLINE static size_t GetCategoryBin(const EbmModelFeature * const pFeature, const char * const sCategory) {
+   if(nullptr == sCategory) {
+      return 0;
+   }
+   const size_t cBytes = strlen(sCategory);
+   const size_t cSlots = pFeature->m_cBins;
+   const IntegerDataType displacement = pFeature->m_aDisplacements[HashCategory(0, sCategory, cBytes) % cSlots];
+   const size_t iSlot = displacement < 0 ? static_cast<size_t>(-(displacement + 1)) : static_cast<size_t>(HashCategory(static_cast<uint64_t>(displacement), sCategory, cBytes) % cSlots);
+   const EbmModelCategory * const pCategory = &pFeature->m_aCategories[iSlot];
+   // a category that we've never seen hashes to some other category's slot, so we need to compare the text
+   if(static_cast<size_t>(pCategory->m_cBytesText) == cBytes && 0 == memcmp(&pFeature->m_aCategoryText[pCategory->m_iTextStart], sCategory, cBytes)) {
+      return static_cast<size_t>(pCategory->m_iBin);
+   }
+   return 0;
+}
+
+// returns true on error
+static bool BuildCategoryTable(EbmModelFeature * const pFeature, const char * const * const asCategories) {
+   const size_t cCategories = pFeature->m_cBins;
+   EBM_ASSERT(1 <= cCategories);
+
+   size_t cBytesText = 0;
+   for(size_t iCategory = 0; iCategory < cCategories; ++iCategory) {
+      if(nullptr == asCategories[iCategory]) {
+         LOG_0(TraceLevelError, "ERROR BuildCategoryTable categories can't be null");
+         return true;
+      }
+      const size_t cBytes = strlen(asCategories[iCategory]);
+      if(IsAddError(cBytesText, cBytes)) {
+         LOG_0(TraceLevelWarning, "WARNING BuildCategoryTable IsAddError(cBytesText, cBytes)");
+         return true;
+      }
+      cBytesText += cBytes;
+   }
+   if(IsMultiplyError(sizeof(EbmModelCategory), cCategories) || IsMultiplyError(sizeof(size_t), cCategories + 1)) {
+      LOG_0(TraceLevelWarning, "WARNING BuildCategoryTable IsMultiplyError(sizeof(EbmModelCategory), cCategories) || IsMultiplyError(sizeof(size_t), cCategories + 1)");
+      return true;
+   }
+
+   // we hand our tables to pFeature right away, so our caller frees them if we fail part way through
+   char * const aText = static_cast<char *>(malloc(0 == cBytesText ? size_t { 1 } : cBytesText));
+   pFeature->m_aCategoryText = aText;
+   EbmModelCategory * const aCategories = static_cast<EbmModelCategory *>(malloc(sizeof(EbmModelCategory) * cCategories));
+   pFeature->m_aCategories = aCategories;
+   IntegerDataType * const aDisplacements = static_cast<IntegerDataType *>(malloc(sizeof(IntegerDataType) * cCategories));
+   pFeature->m_aDisplacements = aDisplacements;
+
+   EbmModelCategory * const aItems = static_cast<EbmModelCategory *>(malloc(sizeof(EbmModelCategory) * cCategories));
+   size_t * const aBucketStarts = static_cast<size_t *>(malloc(sizeof(size_t) * (cCategories + 1)));
+   size_t * const aBucketItems = static_cast<size_t *>(malloc(sizeof(size_t) * cCategories));
+   size_t * const aiBucket = static_cast<size_t *>(malloc(sizeof(size_t) * cCategories));
+   size_t * const aiSlotsTrial = static_cast<size_t *>(malloc(sizeof(size_t) * cCategories));
+   unsigned char * const aSlotUsed = static_cast<unsigned char *>(malloc(cCategories));
+
+   bool bError = true;
+   if(nullptr == aText || nullptr == aCategories || nullptr == aDisplacements || nullptr == aItems || nullptr == aBucketStarts || nullptr == aBucketItems || nullptr == aiBucket || nullptr == aiSlotsTrial || nullptr == aSlotUsed) {
+      LOG_0(TraceLevelWarning, "WARNING BuildCategoryTable nullptr == allocation");
+      goto exit_cleanup;
+   }
+
+   {
+      size_t iText = 0;
+      for(size_t iCategory = 0; iCategory < cCategories; ++iCategory) {
+         const size_t cBytes = strlen(asCategories[iCategory]);
+         memcpy(&aText[iText], asCategories[iCategory], cBytes);
+         aItems[iCategory].m_iTextStart = static_cast<IntegerDataType>(iText);
+         aItems[iCategory].m_cBytesText = static_cast<IntegerDataType>(cBytes);
+         aItems[iCategory].m_iBin = static_cast<IntegerDataType>(iCategory);
+         iText += cBytes;
+      }
+
+      // group the categories by the bucket of their first hash with a counting sort
+      memset(aBucketStarts, 0, sizeof(size_t) * (cCategories + 1));
+      for(size_t iCategory = 0; iCategory < cCategories; ++iCategory) {
+         const size_t iBucket = static_cast<size_t>(HashCategory(0, &aText[aItems[iCategory].m_iTextStart], static_cast<size_t>(aItems[iCategory].m_cBytesText)) % cCategories);
+         aiBucket[iCategory] = iBucket;
+         ++aBucketStarts[iBucket + 1];
+      }
+      size_t cBucketItemsMax = 0;
+      for(size_t iBucket = 0; iBucket < cCategories; ++iBucket) {
+         cBucketItemsMax = cBucketItemsMax < aBucketStarts[iBucket + 1] ? aBucketStarts[iBucket + 1] : cBucketItemsMax;
+         aBucketStarts[iBucket + 1] += aBucketStarts[iBucket];
+      }
+      // aiSlotsTrial isn't needed yet, so it holds each bucket's fill position for now
+      memcpy(aiSlotsTrial, aBucketStarts, sizeof(size_t) * cCategories);
+      for(size_t iCategory = 0; iCategory < cCategories; ++iCategory) {
+         aBucketItems[aiSlotsTrial[aiBucket[iCategory]]] = iCategory;
+         ++aiSlotsTrial[aiBucket[iCategory]];
+      }
+
+      // identical categories always share a bucket, and they would never find separate slots
+      for(size_t iBucket = 0; iBucket < cCategories; ++iBucket) {
+         for(size_t iItem1 = aBucketStarts[iBucket]; iItem1 < aBucketStarts[iBucket + 1]; ++iItem1) {
+            const EbmModelCategory * const pItem1 = &aItems[aBucketItems[iItem1]];
+            for(size_t iItem2 = iItem1 + 1; iItem2 < aBucketStarts[iBucket + 1]; ++iItem2) {
+               const EbmModelCategory * const pItem2 = &aItems[aBucketItems[iItem2]];
+               if(pItem1->m_cBytesText == pItem2->m_cBytesText && 0 == memcmp(&aText[pItem1->m_iTextStart], &aText[pItem2->m_iTextStart], static_cast<size_t>(pItem1->m_cBytesText))) {
+                  LOG_0(TraceLevelError, "ERROR BuildCategoryTable categories must be unique");
+                  goto exit_cleanup;
+               }
+            }
+         }
+      }
+
+      memset(aSlotUsed, 0, cCategories);
+      for(size_t iBucket = 0; iBucket < cCategories; ++iBucket) {
+         aDisplacements[iBucket] = 0;
+      }
+      // the biggest buckets are the hardest to place, so they go first while most of the slots are still free
+      for(size_t cBucketItems = cBucketItemsMax; 2 <= cBucketItems; --cBucketItems) {
+         for(size_t iBucket = 0; iBucket < cCategories; ++iBucket) {
+            const size_t iItemStart = aBucketStarts[iBucket];
+            if(cBucketItems != aBucketStarts[iBucket + 1] - iItemStart) {
+               continue;
+            }
+            IntegerDataType displacement = 1;
+            while(true) {
+               if(k_cCategoryDisplacementTriesMax < displacement) {
+                  LOG_0(TraceLevelWarning, "WARNING BuildCategoryTable k_cCategoryDisplacementTriesMax < displacement");
+                  goto exit_cleanup;
+               }
+               size_t iItem = 0;
+               for(; iItem < cBucketItems; ++iItem) {
+                  const EbmModelCategory * const pItem = &aItems[aBucketItems[iItemStart + iItem]];
+                  const size_t iSlot = static_cast<size_t>(HashCategory(static_cast<uint64_t>(displacement), &aText[pItem->m_iTextStart], static_cast<size_t>(pItem->m_cBytesText)) % cCategories);
+                  if(0 != aSlotUsed[iSlot]) {
+                     break;
+                  }
+                  // we mark the slot so that two items of this bucket can't both take it
+                  aSlotUsed[iSlot] = 1;
+                  aiSlotsTrial[iItem] = iSlot;
+               }
+               if(cBucketItems == iItem) {
+                  break;
+               }
+               for(size_t iItemUndo = 0; iItemUndo < iItem; ++iItemUndo) {
+                  aSlotUsed[aiSlotsTrial[iItemUndo]] = 0;
+               }
+               ++displacement;
+            }
+            for(size_t iItem = 0; iItem < cBucketItems; ++iItem) {
+               aCategories[aiSlotsTrial[iItem]] = aItems[aBucketItems[iItemStart + iItem]];
+            }
+            aDisplacements[iBucket] = displacement;
+         }
+      }
+      // a bucket with a single category can take any free slot, which we store directly as a negative displacement
+      size_t iSlotFree = 0;
+      for(size_t iBucket = 0; iBucket < cCategories; ++iBucket) {
+         if(1 != aBucketStarts[iBucket + 1] - aBucketStarts[iBucket]) {
+            continue;
+         }
+         while(0 != aSlotUsed[iSlotFree]) {
+            ++iSlotFree;
+         }
+         aSlotUsed[iSlotFree] = 1;
+         aCategories[iSlotFree] = aItems[aBucketItems[aBucketStarts[iBucket]]];
+         aDisplacements[iBucket] = -static_cast<IntegerDataType>(iSlotFree) - 1;
+      }
+   }
+   bError = false;
+
+exit_cleanup:;
+   free(aItems);
+   free(aBucketStarts);
+   free(aBucketItems);
+   free(aiBucket);
+   free(aiSlotsTrial);
+   free(aSlotUsed);
+   return bError;
+}
+
+EbmModel::~EbmModel() {
+   LOG_0(TraceLevelInfo, "Entered ~EbmModel");
+   ThreadPool::Free(m_pThreadPool);
+   free(m_aiFeatureColumns);
+   free(m_aQuantizedTerms);
+   free(m_aQuantizedTensorsOwned);
+   free(m_aQuantizedIntercept);
+   if(nullptr != m_pMapping) {
+      // our cuts, category tables, tensors and intercept are in the mapping, but the arrays that point into it are our own
+      free(m_aFeatures);
+      free(m_aiFeaturesUsed);
+      UnmapFile(m_pMapping, m_cBytesMapping);
+   } else {
+      if(nullptr != m_aFeatures) {
+         for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+            free(const_cast<FractionalDataType *>(m_aFeatures[iFeature].m_aCuts));
+            free(const_cast<IntegerDataType *>(m_aFeatures[iFeature].m_aDisplacements));
+            free(const_cast<EbmModelCategory *>(m_aFeatures[iFeature].m_aCategories));
+            free(const_cast<char *>(m_aFeatures[iFeature].m_aCategoryText));
+         }
+         free(m_aFeatures);
+      }
+      free(m_aiFeaturesUsed);
+      free(const_cast<FractionalDataType *>(m_aTensors));
+      free(const_cast<FractionalDataType *>(m_aIntercept));
+   }
+   LOG_0(TraceLevelInfo, "Exited ~EbmModel");
+}
+
+bool EbmModel::InitializeFeaturesUsed() {
+   EBM_ASSERT(nullptr == m_aiFeaturesUsed);
+   EBM_ASSERT(nullptr == m_aiFeatureColumns);
+   EBM_ASSERT(!IsMultiplyError(sizeof(size_t), m_cFeatures));
+   size_t * const aiFeaturesUsed = static_cast<size_t *>(malloc(sizeof(size_t) * (0 == m_cFeatures ? size_t { 1 } : m_cFeatures)));
+   m_aiFeaturesUsed = aiFeaturesUsed;
+   size_t * const aiFeatureColumns = static_cast<size_t *>(malloc(sizeof(size_t) * (0 == m_cFeatures ? size_t { 1 } : m_cFeatures)));
+   m_aiFeatureColumns = aiFeatureColumns;
+   if(nullptr == aiFeaturesUsed || nullptr == aiFeatureColumns) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::InitializeFeaturesUsed nullptr == aiFeaturesUsed || nullptr == aiFeatureColumns");
+      return true;
+   }
+
+   // aiFeaturesUsed starts out as a flag per feature, and then we compact it into the list of flagged features
+   memset(aiFeaturesUsed, 0, sizeof(size_t) * m_cFeatures);
+   for(size_t iTerm = 0; iTerm < m_terms.m_cTerms; ++iTerm) {
+      const ScoringTerm * const pTerm = &m_terms.m_aTerms[iTerm];
+      for(size_t iDimension = 0; iDimension < pTerm->m_cDimensions; ++iDimension) {
+         aiFeaturesUsed[m_terms.m_aDimensions[pTerm->m_iDimensionFirst + iDimension].m_iFeature] = 1;
+      }
+   }
+   for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+      // the features that no term uses keep a column too, but nothing ever reads it
+      aiFeatureColumns[iFeature] = m_cFeaturesUsed;
+      if(0 != aiFeaturesUsed[iFeature]) {
+         aiFeaturesUsed[m_cFeaturesUsed] = iFeature;
+         ++m_cFeaturesUsed;
+      }
+   }
+   return false;
+}
+
+bool EbmModel::Initialize(
+   const EbmCoreFeature * const aFeatures,
+   const FractionalDataType * const * const aaFeatureCuts,
+   const char * const * const * const aasFeatureCategories,
+   const size_t cFeatureCombinations,
+   const EbmCoreFeatureCombination * const aFeatureCombinations,
+   const IntegerDataType * const aFeatureCombinationIndexes,
+   const FractionalDataType * const * const apModels,
+   const FractionalDataType * const aIntercept
+) {
+   LOG_0(TraceLevelInfo, "Entered EbmModel::Initialize");
+
+   if(0 != m_cFeatures && nullptr == aFeatures) {
+      LOG_0(TraceLevelError, "ERROR EbmModel::Initialize features can't be null");
+      return true;
+   }
+   if(IsMultiplyError(sizeof(EbmModelFeature), m_cFeatures) || IsMultiplyError(sizeof(size_t), m_cFeatures) || IsMultiplyError(sizeof(FractionalDataType), m_cScores)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize IsMultiplyError(sizeof(EbmModelFeature), m_cFeatures) || IsMultiplyError(sizeof(size_t), m_cFeatures) || IsMultiplyError(sizeof(FractionalDataType), m_cScores)");
+      return true;
+   }
+   // malloc can return nullptr for zero bytes, so we always ask for at least one item
+   m_aFeatures = static_cast<EbmModelFeature *>(malloc(sizeof(EbmModelFeature) * (0 == m_cFeatures ? size_t { 1 } : m_cFeatures)));
+   FractionalDataType * const aInterceptCopy = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * m_cScores));
+   m_aIntercept = aInterceptCopy;
+   if(nullptr == m_aFeatures || nullptr == aInterceptCopy) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize nullptr == m_aFeatures || nullptr == aInterceptCopy");
+      // our destructor walks m_aFeatures, so it can't be left half allocated
+      free(m_aFeatures);
+      m_aFeatures = nullptr;
+      return true;
+   }
+   for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+      m_aFeatures[iFeature].m_featureType = FeatureTypeOrdinal;
+      m_aFeatures[iFeature].m_cBins = 0;
+      m_aFeatures[iFeature].m_aCuts = nullptr;
+      m_aFeatures[iFeature].m_aDisplacements = nullptr;
+      m_aFeatures[iFeature].m_aCategories = nullptr;
+      m_aFeatures[iFeature].m_aCategoryText = nullptr;
+   }
+   for(size_t iScore = 0; iScore < m_cScores; ++iScore) {
+      aInterceptCopy[iScore] = nullptr == aIntercept ? FractionalDataType { 0 } : aIntercept[iScore];
+   }
+
+   for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+      EbmModelFeature * const pFeature = &m_aFeatures[iFeature];
+      const EbmCoreFeature * const pFeatureInterop = &aFeatures[iFeature];
+      if(pFeatureInterop->countBins < 1 || !IsNumberConvertable<size_t, IntegerDataType>(pFeatureInterop->countBins)) {
+         LOG_0(TraceLevelError, "ERROR EbmModel::Initialize countBins must be 1 or more");
+         return true;
+      }
+      const size_t cBins = static_cast<size_t>(pFeatureInterop->countBins);
+      pFeature->m_featureType = pFeatureInterop->featureType;
+      pFeature->m_cBins = cBins;
+      if(FeatureTypeOrdinal == pFeatureInterop->featureType) {
+         const size_t cCuts = cBins - 1;
+         if(0 == cCuts) {
+            continue;
+         }
+         if(nullptr == aaFeatureCuts || nullptr == aaFeatureCuts[iFeature]) {
+            LOG_0(TraceLevelError, "ERROR EbmModel::Initialize featureCuts can't be null for an ordinal feature with more than one bin");
+            return true;
+         }
+         const FractionalDataType * const aCutsFrom = aaFeatureCuts[iFeature];
+         for(size_t iCut = 0; iCut < cCuts; ++iCut) {
+            // this also rejects NaN cut points, since every comparison with NaN is false
+            if(!(aCutsFrom[iCut] == aCutsFrom[iCut]) || (0 != iCut && !(aCutsFrom[iCut - 1] <= aCutsFrom[iCut]))) {
+               LOG_0(TraceLevelError, "ERROR EbmModel::Initialize featureCuts must be in ascending order");
+               return true;
+            }
+         }
+         if(IsMultiplyError(sizeof(FractionalDataType), cCuts)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize IsMultiplyError(sizeof(FractionalDataType), cCuts)");
+            return true;
+         }
+         FractionalDataType * const aCuts = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * cCuts));
+         if(nullptr == aCuts) {
+            LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize nullptr == aCuts");
+            return true;
+         }
+         memcpy(aCuts, aCutsFrom, sizeof(FractionalDataType) * cCuts);
+         pFeature->m_aCuts = aCuts;
+      } else if(FeatureTypeNominal == pFeatureInterop->featureType) {
+         if(nullptr == aasFeatureCategories || nullptr == aasFeatureCategories[iFeature]) {
+            LOG_0(TraceLevelError, "ERROR EbmModel::Initialize featureCategories can't be null for a nominal feature");
+            return true;
+         }
+         if(BuildCategoryTable(pFeature, aasFeatureCategories[iFeature])) {
+            LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize BuildCategoryTable");
+            return true;
+         }
+      } else {
+         LOG_0(TraceLevelError, "ERROR EbmModel::Initialize featureType must be FeatureTypeOrdinal or FeatureTypeNominal");
+         return true;
+      }
+   }
+
+   if(m_terms.Initialize(m_cScores, m_cFeatures, aFeatures, cFeatureCombinations, aFeatureCombinations, aFeatureCombinationIndexes, apModels)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize m_terms.Initialize");
+      return true;
+   }
+
+   size_t cItemsTensors = 0;
+   for(size_t iTerm = 0; iTerm < m_terms.m_cTerms; ++iTerm) {
+      if(IsAddError(cItemsTensors, m_terms.m_aTerms[iTerm].m_cItems)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize IsAddError(cItemsTensors, m_cItems)");
+         return true;
+      }
+      cItemsTensors += m_terms.m_aTerms[iTerm].m_cItems;
+   }
+   if(IsMultiplyError(sizeof(FractionalDataType), cItemsTensors)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize IsMultiplyError(sizeof(FractionalDataType), cItemsTensors)");
+      return true;
+   }
+   FractionalDataType * const aTensors = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * (0 == cItemsTensors ? size_t { 1 } : cItemsTensors)));
+   if(nullptr == aTensors) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize nullptr == aTensors");
+      return true;
+   }
+   m_aTensors = aTensors;
+   FractionalDataType * pTensor = aTensors;
+   for(size_t iTerm = 0; iTerm < m_terms.m_cTerms; ++iTerm) {
+      ScoringTerm * const pTerm = &m_terms.m_aTerms[iTerm];
+      memcpy(pTensor, pTerm->m_aModel, sizeof(FractionalDataType) * pTerm->m_cItems);
+      pTerm->m_aModel = pTensor;
+      pTensor += pTerm->m_cItems;
+   }
+
+   if(InitializeFeaturesUsed()) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::Initialize InitializeFeaturesUsed");
+      return true;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmModel::Initialize");
+   return false;
+}
+
+bool EbmModel::InitializeQuantizedIntercept() {
+   EBM_ASSERT(nullptr == m_aQuantizedIntercept);
+   EBM_ASSERT(nullptr != m_aQuantizedTerms);
+   FractionalDataType * const aQuantizedIntercept = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * m_cScores));
+   if(nullptr == aQuantizedIntercept) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::InitializeQuantizedIntercept nullptr == aQuantizedIntercept");
+      return true;
+   }
+   for(size_t iScore = 0; iScore < m_cScores; ++iScore) {
+      aQuantizedIntercept[iScore] = m_aIntercept[iScore];
+   }
+   for(size_t iTerm = 0; iTerm < m_terms.m_cTerms; ++iTerm) {
+      for(size_t iScore = 0; iScore < m_cScores; ++iScore) {
+         aQuantizedIntercept[iScore] += m_aQuantizedTerms[iTerm].m_offset;
+      }
+   }
+   m_aQuantizedIntercept = aQuantizedIntercept;
+   return false;
+}
+
+// fills aQuantized with the integers nearest to the logits of aModel, and returns the largest difference between a logit and its quantized value
+template<typename TQuantized>
+static FractionalDataType QuantizeTensor(
+   const size_t cItems,
+   const FractionalDataType * const aModel,
+   const FractionalDataType scale,
+   const FractionalDataType offset,
+   TQuantized * const aQuantized
+) {
+   const FractionalDataType quantizedMax = static_cast<FractionalDataType>(std::numeric_limits<TQuantized>::max());
+   FractionalDataType maxError = 0;
+   for(size_t iItem = 0; iItem < cItems; ++iItem) {
+      const FractionalDataType value = aModel[iItem];
+      FractionalDataType quantized = FractionalDataType { 0 } == scale ? FractionalDataType { 0 } : std::round((value - offset) / scale);
+      // rounding can land one past either end of our range
+      quantized = quantized < FractionalDataType { 0 } ? FractionalDataType { 0 } : quantizedMax < quantized ? quantizedMax : quantized;
+      aQuantized[iItem] = static_cast<TQuantized>(quantized);
+      // this is the arithmetic that scoring does, so the error is exactly what scoring sees
+      const FractionalDataType error = std::abs(value - (offset + scale * quantized));
+      maxError = maxError < error ? error : maxError;
+   }
+   return maxError;
+}
+
+bool EbmModel::Quantize(const size_t cBitsQuantized, FractionalDataType * const aMaxErrorsReturn) {
+   LOG_0(TraceLevelInfo, "Entered EbmModel::Quantize");
+
+   EBM_ASSERT(8 == cBitsQuantized || 16 == cBitsQuantized);
+   if(0 != m_cBitsQuantized) {
+      LOG_0(TraceLevelError, "ERROR EbmModel::Quantize the model is already quantized");
+      return true;
+   }
+   const size_t cTerms = m_terms.m_cTerms;
+   const size_t cBytesItem = cBitsQuantized / 8;
+   // our FractionalDataType tensors fit in memory, so tensors of smaller items can't overflow
+   size_t cItemsTensors = 0;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      cItemsTensors += m_terms.m_aTerms[iTerm].m_cItems;
+   }
+   EbmModelQuantizedTerm * const aQuantizedTerms = static_cast<EbmModelQuantizedTerm *>(malloc(sizeof(EbmModelQuantizedTerm) * (0 == cTerms ? size_t { 1 } : cTerms)));
+   unsigned char * const aQuantizedTensors = static_cast<unsigned char *>(malloc(0 == cItemsTensors ? size_t { 1 } : cBytesItem * cItemsTensors));
+   if(nullptr == aQuantizedTerms || nullptr == aQuantizedTensors) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::Quantize nullptr == aQuantizedTerms || nullptr == aQuantizedTensors");
+      free(aQuantizedTerms);
+      free(aQuantizedTensors);
+      return true;
+   }
+
+   unsigned char * pQuantized = aQuantizedTensors;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const ScoringTerm * const pTerm = &m_terms.m_aTerms[iTerm];
+      EBM_ASSERT(1 <= pTerm->m_cItems);
+      FractionalDataType valueMin = pTerm->m_aModel[0];
+      FractionalDataType valueMax = pTerm->m_aModel[0];
+      for(size_t iItem = 0; iItem < pTerm->m_cItems; ++iItem) {
+         const FractionalDataType value = pTerm->m_aModel[iItem];
+         valueMin = value < valueMin ? value : valueMin;
+         valueMax = valueMax < value ? value : valueMax;
+      }
+      // the whole range of integers spans the range of the logits, so the error of each logit is at most half of scale.  NaN values fail this too
+      const FractionalDataType scale = (valueMax - valueMin) / static_cast<FractionalDataType>((size_t { 1 } << cBitsQuantized) - 1);
+      if(!std::isfinite(valueMin) || !std::isfinite(valueMax) || !std::isfinite(scale)) {
+         LOG_0(TraceLevelError, "ERROR EbmModel::Quantize the logits of a term need a finite range to be quantized");
+         free(aQuantizedTerms);
+         free(aQuantizedTensors);
+         return true;
+      }
+      aQuantizedTerms[iTerm].m_scale = scale;
+      aQuantizedTerms[iTerm].m_offset = valueMin;
+      aQuantizedTerms[iTerm].m_aQuantized = pQuantized;
+      FractionalDataType maxError;
+      if(8 == cBitsQuantized) {
+         maxError = QuantizeTensor(pTerm->m_cItems, pTerm->m_aModel, scale, valueMin, reinterpret_cast<uint8_t *>(pQuantized));
+      } else {
+         maxError = QuantizeTensor(pTerm->m_cItems, pTerm->m_aModel, scale, valueMin, reinterpret_cast<uint16_t *>(pQuantized));
+      }
+      if(nullptr != aMaxErrorsReturn) {
+         aMaxErrorsReturn[iTerm] = maxError;
+      }
+      pQuantized += cBytesItem * pTerm->m_cItems;
+   }
+
+   m_aQuantizedTerms = aQuantizedTerms;
+   if(InitializeQuantizedIntercept()) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::Quantize InitializeQuantizedIntercept");
+      m_aQuantizedTerms = nullptr;
+      free(aQuantizedTerms);
+      free(aQuantizedTensors);
+      return true;
+   }
+   m_aQuantizedTensorsOwned = aQuantizedTensors;
+   m_cBitsQuantized = cBitsQuantized;
+
+   // nothing reads our FractionalDataType tensors anymore, so we free them.  The tensors of a mapped file stay in pages that we won't touch again
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      m_terms.m_aTerms[iTerm].m_aModel = nullptr;
+   }
+   if(nullptr == m_pMapping) {
+      free(const_cast<FractionalDataType *>(m_aTensors));
+      m_aTensors = nullptr;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmModel::Quantize");
+   return false;
+}
+
+bool EbmModel::WriteFile(const char * const sPath) const {
+   LOG_0(TraceLevelInfo, "Entered EbmModel::WriteFile");
+
+   if(!IsLittleEndian()) {
+      LOG_0(TraceLevelError, "ERROR EbmModel::WriteFile model files are little endian");
+      return true;
+   }
+
+   // our counts all came from arrays that fit in memory, so none of these sums or conversions can overflow
+   ModelFileHeader header;
+   memcpy(header.m_magic, k_modelFileMagic, sizeof(header.m_magic));
+   header.m_version = k_modelFileVersion;
+   header.m_cScores = static_cast<IntegerDataType>(m_cScores);
+   header.m_cFeatures = static_cast<IntegerDataType>(m_cFeatures);
+   header.m_cTerms = static_cast<IntegerDataType>(m_terms.m_cTerms);
+   header.m_cDimensions = 0;
+   header.m_cCuts = 0;
+   header.m_cCategories = 0;
+   header.m_cTensorItems = 0;
+   header.m_cBytesCategoryText = 0;
+   header.m_cBitsQuantized = static_cast<IntegerDataType>(m_cBitsQuantized);
+   for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+      const EbmModelFeature * const pFeature = &m_aFeatures[iFeature];
+      if(FeatureTypeOrdinal == pFeature->m_featureType) {
+         header.m_cCuts += static_cast<IntegerDataType>(pFeature->m_cBins - 1);
+      } else {
+         header.m_cCategories += static_cast<IntegerDataType>(pFeature->m_cBins);
+         for(size_t iCategory = 0; iCategory < pFeature->m_cBins; ++iCategory) {
+            header.m_cBytesCategoryText += pFeature->m_aCategories[iCategory].m_cBytesText;
+         }
+      }
+   }
+   for(size_t iTerm = 0; iTerm < m_terms.m_cTerms; ++iTerm) {
+      header.m_cDimensions += static_cast<IntegerDataType>(m_terms.m_aTerms[iTerm].m_cDimensions);
+      header.m_cTensorItems += static_cast<IntegerDataType>(m_terms.m_aTerms[iTerm].m_cItems);
+   }
+
+   FILE * const pFile = fopen(sPath, "wb");
+   if(nullptr == pFile) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::WriteFile fopen");
+      return true;
+   }
+   // we write everything in one sequential pass, one part after another
+   bool bError = 1 != fwrite(&header, sizeof(header), 1, pFile);
+   bError = bError || m_cScores != fwrite(m_aIntercept, sizeof(FractionalDataType), m_cScores, pFile);
+   for(size_t iFeature = 0; !bError && iFeature < m_cFeatures; ++iFeature) {
+      const EbmModelFeature * const pFeature = &m_aFeatures[iFeature];
+      ModelFileFeature feature;
+      feature.m_featureType = pFeature->m_featureType;
+      feature.m_cBins = static_cast<IntegerDataType>(pFeature->m_cBins);
+      feature.m_cBytesCategoryText = 0;
+      if(FeatureTypeNominal == pFeature->m_featureType) {
+         for(size_t iCategory = 0; iCategory < pFeature->m_cBins; ++iCategory) {
+            feature.m_cBytesCategoryText += pFeature->m_aCategories[iCategory].m_cBytesText;
+         }
+      }
+      bError = 1 != fwrite(&feature, sizeof(feature), 1, pFile);
+   }
+   for(size_t iTerm = 0; !bError && iTerm < m_terms.m_cTerms; ++iTerm) {
+      ModelFileTerm term;
+      term.m_cDimensions = static_cast<IntegerDataType>(m_terms.m_aTerms[iTerm].m_cDimensions);
+      term.m_cItems = static_cast<IntegerDataType>(m_terms.m_aTerms[iTerm].m_cItems);
+      bError = 1 != fwrite(&term, sizeof(term), 1, pFile);
+   }
+   for(size_t iTerm = 0; !bError && iTerm < m_terms.m_cTerms; ++iTerm) {
+      const ScoringTerm * const pTerm = &m_terms.m_aTerms[iTerm];
+      for(size_t iDimension = 0; !bError && iDimension < pTerm->m_cDimensions; ++iDimension) {
+         const ScoringDimension * const pDimension = &m_terms.m_aDimensions[pTerm->m_iDimensionFirst + iDimension];
+         ModelFileDimension dimension;
+         dimension.m_iFeature = static_cast<IntegerDataType>(pDimension->m_iFeature);
+         dimension.m_cItemsMultiple = static_cast<IntegerDataType>(pDimension->m_cItemsMultiple);
+         bError = 1 != fwrite(&dimension, sizeof(dimension), 1, pFile);
+      }
+   }
+   for(size_t iTerm = 0; !bError && 0 != m_cBitsQuantized && iTerm < m_terms.m_cTerms; ++iTerm) {
+      ModelFileQuantizedTerm quantizedTerm;
+      quantizedTerm.m_scale = m_aQuantizedTerms[iTerm].m_scale;
+      quantizedTerm.m_offset = m_aQuantizedTerms[iTerm].m_offset;
+      bError = 1 != fwrite(&quantizedTerm, sizeof(quantizedTerm), 1, pFile);
+   }
+   for(size_t iFeature = 0; !bError && iFeature < m_cFeatures; ++iFeature) {
+      const EbmModelFeature * const pFeature = &m_aFeatures[iFeature];
+      if(FeatureTypeOrdinal == pFeature->m_featureType && 1 < pFeature->m_cBins) {
+         bError = pFeature->m_cBins - 1 != fwrite(pFeature->m_aCuts, sizeof(FractionalDataType), pFeature->m_cBins - 1, pFile);
+      }
+   }
+   for(size_t iFeature = 0; !bError && iFeature < m_cFeatures; ++iFeature) {
+      const EbmModelFeature * const pFeature = &m_aFeatures[iFeature];
+      if(FeatureTypeNominal == pFeature->m_featureType) {
+         bError = pFeature->m_cBins != fwrite(pFeature->m_aDisplacements, sizeof(IntegerDataType), pFeature->m_cBins, pFile);
+      }
+   }
+   for(size_t iFeature = 0; !bError && iFeature < m_cFeatures; ++iFeature) {
+      const EbmModelFeature * const pFeature = &m_aFeatures[iFeature];
+      if(FeatureTypeNominal == pFeature->m_featureType) {
+         bError = pFeature->m_cBins != fwrite(pFeature->m_aCategories, sizeof(EbmModelCategory), pFeature->m_cBins, pFile);
+      }
+   }
+   if(0 == m_cBitsQuantized) {
+      for(size_t iTerm = 0; !bError && iTerm < m_terms.m_cTerms; ++iTerm) {
+         const ScoringTerm * const pTerm = &m_terms.m_aTerms[iTerm];
+         bError = pTerm->m_cItems != fwrite(pTerm->m_aModel, sizeof(FractionalDataType), pTerm->m_cItems, pFile);
+      }
+   } else {
+      const size_t cBytesItem = m_cBitsQuantized / 8;
+      size_t cBytesTensors = 0;
+      for(size_t iTerm = 0; !bError && iTerm < m_terms.m_cTerms; ++iTerm) {
+         const size_t cBytesTensor = cBytesItem * m_terms.m_aTerms[iTerm].m_cItems;
+         bError = 1 != fwrite(m_aQuantizedTerms[iTerm].m_aQuantized, cBytesTensor, 1, pFile);
+         cBytesTensors += cBytesTensor;
+      }
+      // the text after the tensors doesn't need to be aligned, but we keep every part a multiple of 8 bytes anyways
+      static constexpr char k_padding[8] = { 0 };
+      const size_t cBytesPadding = (8 - cBytesTensors % 8) % 8;
+      bError = bError || (0 != cBytesPadding && 1 != fwrite(k_padding, cBytesPadding, 1, pFile));
+   }
+   for(size_t iFeature = 0; !bError && iFeature < m_cFeatures; ++iFeature) {
+      const EbmModelFeature * const pFeature = &m_aFeatures[iFeature];
+      if(FeatureTypeNominal == pFeature->m_featureType) {
+         size_t cBytesText = 0;
+         for(size_t iCategory = 0; iCategory < pFeature->m_cBins; ++iCategory) {
+            cBytesText += static_cast<size_t>(pFeature->m_aCategories[iCategory].m_cBytesText);
+         }
+         bError = 0 != cBytesText && 1 != fwrite(pFeature->m_aCategoryText, cBytesText, 1, pFile);
+      }
+   }
+   if(0 != fclose(pFile)) {
+      bError = true;
+   }
+   if(bError) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::WriteFile fwrite");
+      return true;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmModel::WriteFile");
+   return false;
+}
+
+// returns the number of items in a part of a model file, or SIZE_MAX if the count is negative or the part can't fit in memory
+EBM_INLINE static size_t GetCountModelFileItems(const IntegerDataType count, const size_t cBytesItem) {
+   if(count < 0 || !IsNumberConvertable<size_t, IntegerDataType>(count) || IsMultiplyError(cBytesItem, static_cast<size_t>(count))) {
+      return std::numeric_limits<size_t>::max();
+   }
+   return static_cast<size_t>(count);
+}
+
+bool EbmModel::InitializeMapping(void * const pMapping, const size_t cBytesMapping) {
+   LOG_0(TraceLevelInfo, "Entered EbmModel::InitializeMapping");
+
+   EBM_ASSERT(nullptr != pMapping);
+   EBM_ASSERT(sizeof(ModelFileHeader) <= cBytesMapping);
+   m_pMapping = pMapping;
+   m_cBytesMapping = cBytesMapping;
+
+   const ModelFileHeader * const pHeader = static_cast<const ModelFileHeader *>(pMapping);
+   const size_t cTerms = GetCountModelFileItems(pHeader->m_cTerms, sizeof(ModelFileTerm));
+   const size_t cDimensions = GetCountModelFileItems(pHeader->m_cDimensions, sizeof(ModelFileDimension));
+   const size_t cCuts = GetCountModelFileItems(pHeader->m_cCuts, sizeof(FractionalDataType));
+   const size_t cCategories = GetCountModelFileItems(pHeader->m_cCategories, sizeof(IntegerDataType) + sizeof(EbmModelCategory));
+   const size_t cTensorItems = GetCountModelFileItems(pHeader->m_cTensorItems, sizeof(FractionalDataType));
+   const size_t cBytesCategoryText = GetCountModelFileItems(pHeader->m_cBytesCategoryText, 1);
+   if(0 != pHeader->m_cBitsQuantized && 8 != pHeader->m_cBitsQuantized && 16 != pHeader->m_cBitsQuantized) {
+      LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping m_cBitsQuantized must be 0, 8 or 16");
+      return true;
+   }
+   const size_t cBitsQuantized = static_cast<size_t>(pHeader->m_cBitsQuantized);
+   if(std::numeric_limits<size_t>::max() == cTerms || std::numeric_limits<size_t>::max() == cDimensions || std::numeric_limits<size_t>::max() == cCuts || std::numeric_limits<size_t>::max() == cCategories || std::numeric_limits<size_t>::max() == cTensorItems || std::numeric_limits<size_t>::max() == cBytesCategoryText) {
+      LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping invalid counts");
+      return true;
+   }
+
+   // each part is checked against what remains of the file before we point at it
+   const char * pNext = static_cast<const char *>(pMapping) + sizeof(ModelFileHeader);
+   size_t cBytesRemaining = cBytesMapping - sizeof(ModelFileHeader);
+   const size_t acBytesParts[] = {
+      sizeof(FractionalDataType) * m_cScores,
+      sizeof(ModelFileFeature) * m_cFeatures,
+      sizeof(ModelFileTerm) * cTerms,
+      sizeof(ModelFileDimension) * cDimensions,
+      0 == cBitsQuantized ? size_t { 0 } : sizeof(ModelFileQuantizedTerm) * cTerms,
+      sizeof(FractionalDataType) * cCuts,
+      sizeof(IntegerDataType) * cCategories,
+      sizeof(EbmModelCategory) * cCategories,
+      // cTensorItems FractionalDataType items fit, so the padding of smaller items can't overflow
+      0 == cBitsQuantized ? sizeof(FractionalDataType) * cTensorItems : (cBitsQuantized / 8 * cTensorItems + 7) / 8 * 8,
+      cBytesCategoryText
+   };
+   const char * apParts[sizeof(acBytesParts) / sizeof(acBytesParts[0])];
+   for(size_t iPart = 0; iPart < sizeof(acBytesParts) / sizeof(acBytesParts[0]); ++iPart) {
+      if(cBytesRemaining < acBytesParts[iPart]) {
+         LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping the file is truncated");
+         return true;
+      }
+      apParts[iPart] = pNext;
+      pNext += acBytesParts[iPart];
+      cBytesRemaining -= acBytesParts[iPart];
+   }
+   m_aIntercept = reinterpret_cast<const FractionalDataType *>(apParts[0]);
+   const ModelFileFeature * const aFileFeatures = reinterpret_cast<const ModelFileFeature *>(apParts[1]);
+   const ModelFileTerm * const aFileTerms = reinterpret_cast<const ModelFileTerm *>(apParts[2]);
+   const ModelFileDimension * const aFileDimensions = reinterpret_cast<const ModelFileDimension *>(apParts[3]);
+   const ModelFileQuantizedTerm * const aFileQuantizedTerms = reinterpret_cast<const ModelFileQuantizedTerm *>(apParts[4]);
+   const FractionalDataType * pCuts = reinterpret_cast<const FractionalDataType *>(apParts[5]);
+   const IntegerDataType * pDisplacements = reinterpret_cast<const IntegerDataType *>(apParts[6]);
+   const EbmModelCategory * pCategories = reinterpret_cast<const EbmModelCategory *>(apParts[7]);
+   const char * pTensors = apParts[8];
+   const char * pCategoryText = apParts[9];
+
+   m_aFeatures = static_cast<EbmModelFeature *>(malloc(sizeof(EbmModelFeature) * (0 == m_cFeatures ? size_t { 1 } : m_cFeatures)));
+   m_terms.m_aTerms = static_cast<ScoringTerm *>(malloc(sizeof(ScoringTerm) * (0 == cTerms ? size_t { 1 } : cTerms)));
+   m_terms.m_aDimensions = static_cast<ScoringDimension *>(malloc(sizeof(ScoringDimension) * (0 == cDimensions ? size_t { 1 } : cDimensions)));
+   if(0 != cBitsQuantized) {
+      m_aQuantizedTerms = static_cast<EbmModelQuantizedTerm *>(malloc(sizeof(EbmModelQuantizedTerm) * (0 == cTerms ? size_t { 1 } : cTerms)));
+   }
+   if(nullptr == m_aFeatures || nullptr == m_terms.m_aTerms || nullptr == m_terms.m_aDimensions || (0 != cBitsQuantized && nullptr == m_aQuantizedTerms)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::InitializeMapping nullptr == m_aFeatures || nullptr == m_terms.m_aTerms || nullptr == m_terms.m_aDimensions || nullptr == m_aQuantizedTerms");
+      return true;
+   }
+
+   // a bad file could send scoring outside of our arrays, so we check everything that picks an index.  The cuts are checked too since they're
+   // small, but we leave the tensors alone so that they stay on disk until scoring needs them
+   size_t cCutsSeen = 0;
+   size_t cCategoriesSeen = 0;
+   size_t cBytesCategoryTextSeen = 0;
+   for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+      const ModelFileFeature * const pFileFeature = &aFileFeatures[iFeature];
+      EbmModelFeature * const pFeature = &m_aFeatures[iFeature];
+      if(pFileFeature->m_cBins < 1 || !IsNumberConvertable<size_t, IntegerDataType>(pFileFeature->m_cBins)) {
+         LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping countBins must be 1 or more");
+         return true;
+      }
+      const size_t cBins = static_cast<size_t>(pFileFeature->m_cBins);
+      pFeature->m_featureType = pFileFeature->m_featureType;
+      pFeature->m_cBins = cBins;
+      pFeature->m_aCuts = nullptr;
+      pFeature->m_aDisplacements = nullptr;
+      pFeature->m_aCategories = nullptr;
+      pFeature->m_aCategoryText = nullptr;
+      if(FeatureTypeOrdinal == pFileFeature->m_featureType) {
+         const size_t cFeatureCuts = cBins - 1;
+         if(cCuts - cCutsSeen < cFeatureCuts) {
+            LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping the features have more cuts than the file");
+            return true;
+         }
+         for(size_t iCut = 0; iCut < cFeatureCuts; ++iCut) {
+            if(!(pCuts[iCut] == pCuts[iCut]) || (0 != iCut && !(pCuts[iCut - 1] <= pCuts[iCut]))) {
+               LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping cuts must be in ascending order");
+               return true;
+            }
+         }
+         pFeature->m_aCuts = pCuts;
+         pCuts += cFeatureCuts;
+         cCutsSeen += cFeatureCuts;
+      } else if(FeatureTypeNominal == pFileFeature->m_featureType) {
+         if(cCategories - cCategoriesSeen < cBins || pFileFeature->m_cBytesCategoryText < 0 || cBytesCategoryText - cBytesCategoryTextSeen < static_cast<uint64_t>(pFileFeature->m_cBytesCategoryText)) {
+            LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping the features have more categories than the file");
+            return true;
+         }
+         const size_t cFeatureBytesText = static_cast<size_t>(pFileFeature->m_cBytesCategoryText);
+         for(size_t iCategory = 0; iCategory < cBins; ++iCategory) {
+            const IntegerDataType displacement = pDisplacements[iCategory];
+            const EbmModelCategory * const pCategory = &pCategories[iCategory];
+            if((displacement < 0 && cBins <= static_cast<size_t>(-(displacement + 1))) || pCategory->m_iBin < 0 || cBins <= static_cast<uint64_t>(pCategory->m_iBin) || pCategory->m_iTextStart < 0 || pCategory->m_cBytesText < 0 || cFeatureBytesText < static_cast<uint64_t>(pCategory->m_iTextStart) || cFeatureBytesText - static_cast<size_t>(pCategory->m_iTextStart) < static_cast<uint64_t>(pCategory->m_cBytesText)) {
+               LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping invalid category table");
+               return true;
+            }
+         }
+         pFeature->m_aDisplacements = pDisplacements;
+         pFeature->m_aCategories = pCategories;
+         pFeature->m_aCategoryText = pCategoryText;
+         pDisplacements += cBins;
+         pCategories += cBins;
+         pCategoryText += cFeatureBytesText;
+         cCategoriesSeen += cBins;
+         cBytesCategoryTextSeen += cFeatureBytesText;
+      } else {
+         LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping featureType must be FeatureTypeOrdinal or FeatureTypeNominal");
+         return true;
+      }
+   }
+   if(cCuts != cCutsSeen || cCategories != cCategoriesSeen || cBytesCategoryText != cBytesCategoryTextSeen) {
+      LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping the features don't add up to the counts of the file");
+      return true;
+   }
+
+   // the multiples of each term need to be the ones that its bins give, so that every bin that we look up is within the term's tensor
+   size_t cDimensionsSeen = 0;
+   size_t cTensorItemsSeen = 0;
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const ModelFileTerm * const pFileTerm = &aFileTerms[iTerm];
+      ScoringTerm * const pTerm = &m_terms.m_aTerms[iTerm];
+      if(pFileTerm->m_cDimensions < 0 || cDimensions - cDimensionsSeen < static_cast<uint64_t>(pFileTerm->m_cDimensions)) {
+         LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping the terms have more dimensions than the file");
+         return true;
+      }
+      const size_t cTermDimensions = static_cast<size_t>(pFileTerm->m_cDimensions);
+      size_t cItemsMultiple = m_cScores;
+      for(size_t iDimension = 0; iDimension < cTermDimensions; ++iDimension) {
+         const ModelFileDimension * const pFileDimension = &aFileDimensions[cDimensionsSeen + iDimension];
+         if(pFileDimension->m_iFeature < 0 || m_cFeatures <= static_cast<uint64_t>(pFileDimension->m_iFeature) || static_cast<IntegerDataType>(cItemsMultiple) != pFileDimension->m_cItemsMultiple) {
+            LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping invalid term dimension");
+            return true;
+         }
+         ScoringDimension * const pDimension = &m_terms.m_aDimensions[cDimensionsSeen + iDimension];
+         pDimension->m_iFeature = static_cast<size_t>(pFileDimension->m_iFeature);
+         pDimension->m_cItemsMultiple = cItemsMultiple;
+         const size_t cBins = m_aFeatures[pDimension->m_iFeature].m_cBins;
+         if(IsMultiplyError(cItemsMultiple, cBins)) {
+            LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping IsMultiplyError(cItemsMultiple, cBins)");
+            return true;
+         }
+         cItemsMultiple *= cBins;
+      }
+      if(static_cast<IntegerDataType>(cItemsMultiple) != pFileTerm->m_cItems || cTensorItems - cTensorItemsSeen < cItemsMultiple) {
+         LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping invalid term tensor size");
+         return true;
+      }
+      if(0 == cBitsQuantized) {
+         pTerm->m_aModel = reinterpret_cast<const FractionalDataType *>(pTensors);
+         pTensors += sizeof(FractionalDataType) * cItemsMultiple;
+      } else {
+         const ModelFileQuantizedTerm * const pFileQuantizedTerm = &aFileQuantizedTerms[iTerm];
+         if(!std::isfinite(pFileQuantizedTerm->m_scale) || !std::isfinite(pFileQuantizedTerm->m_offset)) {
+            LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping the scale and offset of a quantized term must be finite");
+            return true;
+         }
+         pTerm->m_aModel = nullptr;
+         m_aQuantizedTerms[iTerm].m_scale = pFileQuantizedTerm->m_scale;
+         m_aQuantizedTerms[iTerm].m_offset = pFileQuantizedTerm->m_offset;
+         m_aQuantizedTerms[iTerm].m_aQuantized = pTensors;
+         pTensors += cBitsQuantized / 8 * cItemsMultiple;
+      }
+      pTerm->m_cItems = cItemsMultiple;
+      pTerm->m_iDimensionFirst = cDimensionsSeen;
+      pTerm->m_cDimensions = cTermDimensions;
+      m_terms.m_cTerms = iTerm + 1;
+      cDimensionsSeen += cTermDimensions;
+      cTensorItemsSeen += cItemsMultiple;
+   }
+   if(cDimensions != cDimensionsSeen || cTensorItems != cTensorItemsSeen) {
+      LOG_0(TraceLevelError, "ERROR EbmModel::InitializeMapping the terms don't add up to the counts of the file");
+      return true;
+   }
+
+   if(InitializeFeaturesUsed()) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::InitializeMapping InitializeFeaturesUsed");
+      return true;
+   }
+   if(0 != cBitsQuantized) {
+      if(InitializeQuantizedIntercept()) {
+         LOG_0(TraceLevelWarning, "WARNING EbmModel::InitializeMapping InitializeQuantizedIntercept");
+         return true;
+      }
+      m_cBitsQuantized = cBitsQuantized;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmModel::InitializeMapping");
+   return false;
+}
+
+// we score the rows in blocks, like ScoreBinnedInstances.  A block's bins, tensor indexes and logits stay in L1 while we walk every term over
+// them, so each term's tensor is the only memory that streams through the cache.  A chunk of blocks is what one thread scores, and it allocates
+// its own block arrays, which is cheap next to binning its thousands of rows
+constexpr size_t k_cInstancesPerRawScoreBlock = 256;
+constexpr size_t k_cInstancesPerRawScoreChunkMin = size_t { 4096 };
+constexpr size_t k_cRawScoreChunksMax = size_t { 1024 };
+
+// the offsets of the terms are already in the intercept, so each term only adds its scaled integer
+template<typename TQuantized>
+EBM_INLINE static void AddQuantizedTerm(
+   const size_t cInstancesBlock,
+   const EbmModelQuantizedTerm * const pQuantizedTerm,
+   const size_t cScores,
+   const size_t * const aiTensor,
+   FractionalDataType * const aLogits
+) {
+   const TQuantized * const aQuantized = static_cast<const TQuantized *>(pQuantizedTerm->m_aQuantized);
+   const FractionalDataType scale = pQuantizedTerm->m_scale;
+   for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+      const TQuantized * const pQuantized = &aQuantized[aiTensor[iInstance]];
+      FractionalDataType * const pLogits = &aLogits[iInstance * cScores];
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         pLogits[iScore] += scale * static_cast<FractionalDataType>(pQuantized[iScore]);
+      }
+   }
+}
+
+void EbmModel::ScoreRawBlock(
+   const size_t cInstancesBlock,
+   const FractionalDataType * const aValues,
+   const char * const * const asCategories,
+   const IntegerDataType link,
+   FractionalDataType * const aOutputs,
+   size_t * const aBins,
+   size_t * const aiTensor,
+   FractionalDataType * const aLogits
+) const {
+   const size_t cScores = m_cScores;
+   const size_t cOutputs = GetCountScoreOutputs(cScores, link);
+   // the logits go into the last cScores outputs of each row, which for binary softmax leaves the first output for the implicit zero logit
+   const size_t iLogitFirst = cOutputs - cScores;
+   const FractionalDataType * const aIntercept = 0 == m_cBitsQuantized ? m_aIntercept : m_aQuantizedIntercept;
+
+   // the input is row major, so we bin a row at a time into the columns of the features that we use
+   for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+      const FractionalDataType * const aRowValues = nullptr == aValues ? nullptr : &aValues[iInstance * m_cFeatures];
+      const char * const * const asRowCategories = nullptr == asCategories ? nullptr : &asCategories[iInstance * m_cFeatures];
+      for(size_t iFeatureUsed = 0; iFeatureUsed < m_cFeaturesUsed; ++iFeatureUsed) {
+         const size_t iFeature = m_aiFeaturesUsed[iFeatureUsed];
+         const EbmModelFeature * const pFeature = &m_aFeatures[iFeature];
+         size_t iBin;
+         if(FeatureTypeOrdinal == pFeature->m_featureType) {
+            EBM_ASSERT(nullptr != aRowValues);
+            iBin = GetCutBin(pFeature->m_aCuts, pFeature->m_cBins - 1, aRowValues[iFeature]);
+         } else {
+            EBM_ASSERT(nullptr != asRowCategories);
+            iBin = GetCategoryBin(pFeature, asRowCategories[iFeature]);
+         }
+         EBM_ASSERT(iBin < pFeature->m_cBins);
+         aBins[iFeatureUsed * cInstancesBlock + iInstance] = iBin;
+      }
+      FractionalDataType * const pLogits = &aLogits[iInstance * cScores];
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         pLogits[iScore] = aIntercept[iScore];
+      }
+   }
+
+   for(size_t iTerm = 0; iTerm < m_terms.m_cTerms; ++iTerm) {
+      const ScoringTerm * const pTerm = &m_terms.m_aTerms[iTerm];
+      const ScoringDimension * pDimension = &m_terms.m_aDimensions[pTerm->m_iDimensionFirst];
+      const ScoringDimension * const pDimensionEnd = pDimension + pTerm->m_cDimensions;
+      if(pDimensionEnd == pDimension) {
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            aiTensor[iInstance] = 0;
+         }
+      } else {
+         const size_t * pBin = &aBins[m_aiFeatureColumns[pDimension->m_iFeature] * cInstancesBlock];
+         size_t cItemsMultiple = pDimension->m_cItemsMultiple;
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            aiTensor[iInstance] = pBin[iInstance] * cItemsMultiple;
+         }
+         for(++pDimension; pDimensionEnd != pDimension; ++pDimension) {
+            pBin = &aBins[m_aiFeatureColumns[pDimension->m_iFeature] * cInstancesBlock];
+            cItemsMultiple = pDimension->m_cItemsMultiple;
+            for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+               aiTensor[iInstance] += pBin[iInstance] * cItemsMultiple;
+            }
+         }
+      }
+
+      // every instance of the block takes the same branch, so they cost nothing next to the lookups
+      if(0 != m_cBitsQuantized) {
+         if(8 == m_cBitsQuantized) {
+            AddQuantizedTerm<uint8_t>(cInstancesBlock, &m_aQuantizedTerms[iTerm], cScores, aiTensor, aLogits);
+         } else {
+            EBM_ASSERT(16 == m_cBitsQuantized);
+            AddQuantizedTerm<uint16_t>(cInstancesBlock, &m_aQuantizedTerms[iTerm], cScores, aiTensor, aLogits);
+         }
+      } else if(1 == cScores) {
+         g_pIsaKernels->m_pAddGathered(cInstancesBlock, pTerm->m_aModel, aiTensor, aLogits);
+      } else {
+         const FractionalDataType * const aModel = pTerm->m_aModel;
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            const FractionalDataType * const pModel = &aModel[aiTensor[iInstance]];
+            FractionalDataType * const pLogits = &aLogits[iInstance * cScores];
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               pLogits[iScore] += pModel[iScore];
+            }
+         }
+      }
+   }
+
+   for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+      FractionalDataType * const pOutputs = &aOutputs[iInstance * cOutputs];
+      for(size_t iOutput = 0; iOutput < iLogitFirst; ++iOutput) {
+         pOutputs[iOutput] = 0;
+      }
+      const FractionalDataType * const pLogits = &aLogits[iInstance * cScores];
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         pOutputs[iLogitFirst + iScore] = pLogits[iScore];
+      }
+   }
+   ApplyScoreLink(link, cInstancesBlock, cOutputs, aOutputs);
+}
+
+bool EbmModel::ScoreRawInstances(
+   const size_t cInstances,
+   const FractionalDataType * const aValues,
+   const char * const * const asCategories,
+   const IntegerDataType link,
+   FractionalDataType * const aScoresReturn
+) const {
+   EBM_ASSERT(1 <= cInstances);
+   const size_t cOutputs = GetCountScoreOutputs(m_cScores, link);
+   const size_t cInstancesPerBlockMax = cInstances < k_cInstancesPerRawScoreBlock ? cInstances : k_cInstancesPerRawScoreBlock;
+   // the bins of a block come first, since its tensor indexes and logits are 8 byte items too
+   const size_t cItemsScratch = (m_cFeaturesUsed + 1 + m_cScores) * cInstancesPerBlockMax;
+   if(IsMultiplyError(sizeof(size_t), cItemsScratch)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::ScoreRawInstances IsMultiplyError(sizeof(size_t), cItemsScratch)");
+      return true;
+   }
+   static_assert(sizeof(FractionalDataType) == sizeof(size_t), "our scratch space holds the logits in size_t slots");
+
+   size_t cInstancesPerChunk;
+   const size_t cChunks = GetCountChunks(cInstances, 1, k_cInstancesPerRawScoreChunkMin, k_cRawScoreChunksMax, &cInstancesPerChunk);
+   std::atomic<bool> bError(false);
+   RunChunks(m_pThreadPool, m_cThreads, cChunks, [&](const size_t iChunk) {
+      size_t * const aScratch = static_cast<size_t *>(malloc(sizeof(size_t) * cItemsScratch));
+      if(nullptr == aScratch) {
+         bError.store(true, std::memory_order_relaxed);
+         return;
+      }
+      size_t * const aBins = aScratch;
+      size_t * const aiTensor = &aBins[m_cFeaturesUsed * cInstancesPerBlockMax];
+      FractionalDataType * const aLogits = reinterpret_cast<FractionalDataType *>(&aiTensor[cInstancesPerBlockMax]);
+
+      const size_t iInstanceChunkStart = iChunk * cInstancesPerChunk;
+      const size_t cInstancesChunkRemaining = cInstances - iInstanceChunkStart;
+      const size_t iInstanceChunkEnd = iInstanceChunkStart + (cInstancesChunkRemaining < cInstancesPerChunk ? cInstancesChunkRemaining : cInstancesPerChunk);
+      for(size_t iInstanceStart = iInstanceChunkStart; iInstanceStart < iInstanceChunkEnd; iInstanceStart += cInstancesPerBlockMax) {
+         const size_t cInstancesRemaining = iInstanceChunkEnd - iInstanceStart;
+         const size_t cInstancesBlock = cInstancesRemaining < cInstancesPerBlockMax ? cInstancesRemaining : cInstancesPerBlockMax;
+         ScoreRawBlock(
+            cInstancesBlock,
+            nullptr == aValues ? nullptr : &aValues[iInstanceStart * m_cFeatures],
+            nullptr == asCategories ? nullptr : &asCategories[iInstanceStart * m_cFeatures],
+            link,
+            &aScoresReturn[iInstanceStart * cOutputs],
+            aBins,
+            aiTensor,
+            aLogits
+         );
+      }
+      free(aScratch);
+   });
+   if(bError.load()) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::ScoreRawInstances nullptr == aScratch");
+      return true;
+   }
+   return false;
+}
+
+bool EbmModel::SetCountThreads(const size_t cThreads) {
+   LOG_N(TraceLevelInfo, "Entered EbmModel::SetCountThreads: cThreads=%zu", cThreads);
+
+   EBM_ASSERT(1 <= cThreads);
+
+   // nothing scores while our caller is changing our threads, so nothing is running on the pool right now
+   ThreadPool::Free(m_pThreadPool);
+   m_pThreadPool = nullptr;
+   m_cThreads = 1;
+
+   ThreadPool * const pThreadPool = ThreadPool::Allocate(cThreads);
+   if(UNLIKELY(nullptr == pThreadPool)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmModel::SetCountThreads nullptr == pThreadPool");
+      return true;
+   }
+   m_pThreadPool = pThreadPool;
+   m_cThreads = pThreadPool->GetCountThreads();
+
+   LOG_0(TraceLevelInfo, "Exited EbmModel::SetCountThreads");
+   return false;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmModel EBMCORE_CALLING_CONVENTION CompileModel(
+   IntegerDataType countScores,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   const FractionalDataType * const * featureCuts,
+   const char * const * const * featureCategories,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * models,
+   const FractionalDataType * intercept
+) {
+   LOG_N(TraceLevelInfo, "Entered CompileModel: countScores=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, featureCuts=%p, featureCategories=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, models=%p, intercept=%p", countScores, countFeatures, static_cast<const void *>(features), static_cast<const void *>(featureCuts), static_cast<const void *>(featureCategories), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), static_cast<const void *>(models), static_cast<const void *>(intercept));
+
+   if(countScores < 1 || countFeatures < 0 || countFeatureCombinations < 0) {
+      LOG_0(TraceLevelError, "ERROR CompileModel countScores must be 1 or more, and countFeatures and countFeatureCombinations can't be negative");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countScores) || !IsNumberConvertable<size_t, IntegerDataType>(countFeatures) || !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING CompileModel !IsNumberConvertable<size_t, IntegerDataType>(count)");
+      return nullptr;
+   }
+
+   EbmModel * const pEbmModel = new (std::nothrow) EbmModel(static_cast<size_t>(countScores), static_cast<size_t>(countFeatures));
+   if(UNLIKELY(nullptr == pEbmModel)) {
+      LOG_0(TraceLevelWarning, "WARNING CompileModel nullptr == pEbmModel");
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmModel->Initialize(features, featureCuts, featureCategories, static_cast<size_t>(countFeatureCombinations), featureCombinations, featureCombinationIndexes, models, intercept))) {
+      LOG_0(TraceLevelWarning, "WARNING CompileModel pEbmModel->Initialize");
+      delete pEbmModel;
+      return nullptr;
+   }
+   LOG_N(TraceLevelInfo, "Exited CompileModel %p", static_cast<void *>(pEbmModel));
+   return reinterpret_cast<PEbmModel>(pEbmModel);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ScoreRawInstances(
+   PEbmModel ebmModel,
+   IntegerDataType countInstances,
+   const FractionalDataType * values,
+   const char * const * categories,
+   IntegerDataType link,
+   FractionalDataType * scoresReturn
+) {
+   LOG_N(TraceLevelVerbose, "Entered ScoreRawInstances: ebmModel=%p, countInstances=%" IntegerDataTypePrintf ", values=%p, categories=%p, link=%" IntegerDataTypePrintf ", scoresReturn=%p", static_cast<void *>(ebmModel), countInstances, static_cast<const void *>(values), static_cast<const void *>(categories), link, static_cast<void *>(scoresReturn));
+
+   const EbmModel * const pEbmModel = reinterpret_cast<const EbmModel *>(ebmModel);
+   EBM_ASSERT(nullptr != pEbmModel);
+
+   if(IsScoreLinkError(pEbmModel->m_cScores, link)) {
+      return 1;
+   }
+   if(countInstances < 0 || !IsNumberConvertable<size_t, IntegerDataType>(countInstances)) {
+      LOG_0(TraceLevelError, "ERROR ScoreRawInstances countInstances is not valid");
+      return 1;
+   }
+   const size_t cInstances = static_cast<size_t>(countInstances);
+   if(0 == cInstances) {
+      return 0;
+   }
+   if(IsMultiplyError(cInstances, pEbmModel->m_cFeatures) || IsMultiplyError(cInstances, GetCountScoreOutputs(pEbmModel->m_cScores, link))) {
+      LOG_0(TraceLevelWarning, "WARNING ScoreRawInstances IsMultiplyError(cInstances, count)");
+      return 1;
+   }
+   if(nullptr == scoresReturn) {
+      LOG_0(TraceLevelError, "ERROR ScoreRawInstances scoresReturn can't be null");
+      return 1;
+   }
+   for(size_t iFeatureUsed = 0; iFeatureUsed < pEbmModel->m_cFeaturesUsed; ++iFeatureUsed) {
+      const IntegerDataType featureType = pEbmModel->m_aFeatures[pEbmModel->m_aiFeaturesUsed[iFeatureUsed]].m_featureType;
+      if(FeatureTypeOrdinal == featureType ? nullptr == values : nullptr == categories) {
+         LOG_0(TraceLevelError, "ERROR ScoreRawInstances values can't be null if the model uses an ordinal feature, and categories can't be null if it uses a nominal feature");
+         return 1;
+      }
+   }
+
+   if(pEbmModel->ScoreRawInstances(cInstances, values, categories, link, scoresReturn)) {
+      LOG_0(TraceLevelWarning, "WARNING ScoreRawInstances pEbmModel->ScoreRawInstances");
+      return 1;
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited ScoreRawInstances");
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetModelThreadCount(
+   PEbmModel ebmModel,
+   IntegerDataType countThreads
+) {
+   LOG_N(TraceLevelInfo, "Entered SetModelThreadCount: ebmModel=%p, countThreads=%" IntegerDataTypePrintf, static_cast<void *>(ebmModel), countThreads);
+
+   EbmModel * const pEbmModel = reinterpret_cast<EbmModel *>(ebmModel);
+   EBM_ASSERT(nullptr != pEbmModel);
+
+   if(countThreads < 0) {
+      LOG_0(TraceLevelError, "ERROR SetModelThreadCount countThreads can't be negative");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING SetModelThreadCount !IsNumberConvertable<size_t, IntegerDataType>(countThreads)");
+      return 1;
+   }
+   // zero means use every hardware thread.  Until our caller asks for threads we score on the calling thread, since a model that scores a few
+   // rows at a time has no use for a pool
+   const size_t cThreads = 0 == countThreads ? ThreadPool::GetCountHardwareThreads() : static_cast<size_t>(countThreads);
+   if(pEbmModel->SetCountThreads(cThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING SetModelThreadCount pEbmModel->SetCountThreads(cThreads)");
+      return 1;
+   }
+
+   LOG_N(TraceLevelInfo, "Exited SetModelThreadCount %zu threads", pEbmModel->m_cThreads);
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeModel(
+   PEbmModel ebmModel
+) {
+   LOG_N(TraceLevelInfo, "Entered FreeModel: ebmModel=%p", static_cast<void *>(ebmModel));
+   EbmModel * const pEbmModel = reinterpret_cast<EbmModel *>(ebmModel);
+   // pEbmModel is allowed to be nullptr
+   delete pEbmModel;
+   LOG_0(TraceLevelInfo, "Exited FreeModel");
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION WriteModelFile(
+   PEbmModel ebmModel,
+   const char * path
+) {
+   LOG_N(TraceLevelInfo, "Entered WriteModelFile: ebmModel=%p, path=%p", static_cast<void *>(ebmModel), static_cast<const void *>(path));
+
+   const EbmModel * const pEbmModel = reinterpret_cast<const EbmModel *>(ebmModel);
+   if(nullptr == pEbmModel) {
+      LOG_0(TraceLevelError, "ERROR WriteModelFile nullptr == ebmModel");
+      return 1;
+   }
+   if(nullptr == path) {
+      LOG_0(TraceLevelError, "ERROR WriteModelFile nullptr == path");
+      return 1;
+   }
+   if(pEbmModel->WriteFile(path)) {
+      LOG_0(TraceLevelWarning, "WARNING WriteModelFile pEbmModel->WriteFile");
+      return 1;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited WriteModelFile");
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmModel EBMCORE_CALLING_CONVENTION OpenModelFile(
+   const char * path
+) {
+   LOG_N(TraceLevelInfo, "Entered OpenModelFile: path=%p", static_cast<const void *>(path));
+
+   if(nullptr == path) {
+      LOG_0(TraceLevelError, "ERROR OpenModelFile nullptr == path");
+      return nullptr;
+   }
+   if(!IsLittleEndian()) {
+      LOG_0(TraceLevelError, "ERROR OpenModelFile model files are little endian");
+      return nullptr;
+   }
+   size_t cBytesMapping = 0;
+   void * const pMapping = MapFile(path, sizeof(ModelFileHeader), &cBytesMapping);
+   if(nullptr == pMapping) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelFile MapFile");
+      return nullptr;
+   }
+
+   const ModelFileHeader * const pHeader = static_cast<const ModelFileHeader *>(pMapping);
+   if(0 != memcmp(pHeader->m_magic, k_modelFileMagic, sizeof(pHeader->m_magic))) {
+      LOG_0(TraceLevelError, "ERROR OpenModelFile the file is not an EBM model");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+   if(k_modelFileVersion != pHeader->m_version) {
+      LOG_0(TraceLevelError, "ERROR OpenModelFile unsupported file version");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+   if(pHeader->m_cScores < 1 || pHeader->m_cFeatures < 0 || !IsNumberConvertable<size_t, IntegerDataType>(pHeader->m_cScores) || !IsNumberConvertable<size_t, IntegerDataType>(pHeader->m_cFeatures) || IsMultiplyError(sizeof(FractionalDataType), static_cast<size_t>(pHeader->m_cScores)) || IsMultiplyError(sizeof(EbmModelFeature), static_cast<size_t>(pHeader->m_cFeatures))) {
+      LOG_0(TraceLevelError, "ERROR OpenModelFile invalid counts");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+
+   EbmModel * const pEbmModel = new (std::nothrow) EbmModel(static_cast<size_t>(pHeader->m_cScores), static_cast<size_t>(pHeader->m_cFeatures));
+   if(UNLIKELY(nullptr == pEbmModel)) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelFile nullptr == pEbmModel");
+      UnmapFile(pMapping, cBytesMapping);
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmModel->InitializeMapping(pMapping, cBytesMapping))) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelFile pEbmModel->InitializeMapping");
+      delete pEbmModel;
+      return nullptr;
+   }
+
+   const PEbmModel ebmModel = reinterpret_cast<PEbmModel>(pEbmModel);
+   LOG_N(TraceLevelInfo, "Exited OpenModelFile %p", static_cast<void *>(ebmModel));
+   return ebmModel;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION QuantizeModel(
+   PEbmModel ebmModel,
+   IntegerDataType countBitsQuantized,
+   FractionalDataType * maxErrorsReturn
+) {
+   LOG_N(TraceLevelInfo, "Entered QuantizeModel: ebmModel=%p, countBitsQuantized=%" IntegerDataTypePrintf ", maxErrorsReturn=%p", static_cast<void *>(ebmModel), countBitsQuantized, static_cast<void *>(maxErrorsReturn));
+
+   EbmModel * const pEbmModel = reinterpret_cast<EbmModel *>(ebmModel);
+   if(nullptr == pEbmModel) {
+      LOG_0(TraceLevelError, "ERROR QuantizeModel nullptr == ebmModel");
+      return 1;
+   }
+   if(8 != countBitsQuantized && 16 != countBitsQuantized) {
+      LOG_0(TraceLevelError, "ERROR QuantizeModel countBitsQuantized must be 8 or 16");
+      return 1;
+   }
+   if(pEbmModel->Quantize(static_cast<size_t>(countBitsQuantized), maxErrorsReturn)) {
+      LOG_0(TraceLevelWarning, "WARNING QuantizeModel pEbmModel->Quantize");
+      return 1;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited QuantizeModel");
+   return 0;
+}
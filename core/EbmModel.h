@@ -0,0 +1,155 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef EBM_MODEL_H
+#define EBM_MODEL_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "ebmcore.h"
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "Scoring.h"
+#include "ThreadPool.h"
+
+// one slot of a nominal feature's category table.  The text of the categories is kept in one buffer per feature, and isn't NUL terminated
+struct EbmModelCategory final {
+   IntegerDataType m_iTextStart;
+   IntegerDataType m_cBytesText;
+   IntegerDataType m_iBin;
+};
+
+// how a compiled model turns one raw value of a feature into a bin.  FeatureTypeOrdinal features have m_cBins - 1 ascending cut points, and a
+// value's bin is the number of cut points that are not greater than it, which is where np.digitize puts it.  NaN is not less than any cut point,
+// so it goes into the last bin, which is also where np.digitize puts it.  FeatureTypeNominal features look up their categories in a minimal
+// perfect hash (Hanov's hash and displace).  The first hash of a category picks its bucket's displacement, and the displacement either names the
+// category's slot directly or seeds the second hash that finds it.  Every category has its own slot, so a lookup costs two hashes and one
+// comparison, and missing or unknown categories go into bin 0
+struct EbmModelFeature final {
+   IntegerDataType m_featureType;
+   size_t m_cBins;
+   const FractionalDataType * m_aCuts;
+   const IntegerDataType * m_aDisplacements;
+   const EbmModelCategory * m_aCategories;
+   const char * m_aCategoryText;
+};
+
+// the quantized tensor of a term holds unsigned integers q, and each stands for the logit m_offset + m_scale * q.  m_aQuantized points to uint8_t
+// or uint16_t items in the layout of the term's FractionalDataType tensor
+struct EbmModelQuantizedTerm final {
+   FractionalDataType m_scale;
+   FractionalDataType m_offset;
+   const void * m_aQuantized;
+};
+
+// a model that scores raw instances.  It holds the binning of every feature next to the terms, and scoring bins a block of instances into a
+// column per feature that the terms use and then adds up the terms one after another over the block, so nothing the size of the batch is ever
+// allocated.  The blocks are split between our threads.  A model can also be written to a file and opened again by mapping the file, in which
+// case the cuts, category tables and tensors point into the mapped pages and only the small per feature and per term arrays are our own
+class EbmModel final {
+   // we own our arrays, so copying us would free them twice
+   EbmModel(const EbmModel &) = delete;
+   EbmModel & operator=(const EbmModel &) = delete;
+
+   void * m_pMapping;
+   size_t m_cBytesMapping;
+
+   // the quantized tensors that we allocated ourselves, rather than the ones in a mapped file
+   void * m_aQuantizedTensorsOwned;
+
+   bool InitializeFeaturesUsed();
+   bool InitializeQuantizedIntercept();
+
+   // aBins holds a column of cInstancesBlock bins per feature that we use, aiTensor holds cInstancesBlock indexes, and aLogits holds
+   // cInstancesBlock rows of m_cScores logits
+   void ScoreRawBlock(
+      const size_t cInstancesBlock,
+      const FractionalDataType * const aValues,
+      const char * const * const asCategories,
+      const IntegerDataType link,
+      FractionalDataType * const aOutputs,
+      size_t * const aBins,
+      size_t * const aiTensor,
+      FractionalDataType * const aLogits
+   ) const;
+
+public:
+   const size_t m_cScores;
+   const size_t m_cFeatures;
+   EbmModelFeature * m_aFeatures;
+   // the features that some term has a dimension for, which are the only ones that we bin
+   size_t m_cFeaturesUsed;
+   size_t * m_aiFeaturesUsed;
+   // the column of each feature's bins within a block, which is its index in m_aiFeaturesUsed
+   size_t * m_aiFeatureColumns;
+   ScoringTerms m_terms;
+   // our copy of the term tensors, one after another in the order of m_terms, which point into it
+   const FractionalDataType * m_aTensors;
+   const FractionalDataType * m_aIntercept;
+   // 0 if the terms use their FractionalDataType tensors, and otherwise 8 or 16 for the bits of the items in the quantized tensors of
+   // m_aQuantizedTerms.  m_aQuantizedIntercept is m_aIntercept plus the m_offset of every term, since each term adds its offset to every instance
+   size_t m_cBitsQuantized;
+   EbmModelQuantizedTerm * m_aQuantizedTerms;
+   FractionalDataType * m_aQuantizedIntercept;
+   // the threads that score the blocks of one call, including the calling thread.  m_pThreadPool is nullptr until SetCountThreads
+   size_t m_cThreads;
+   ThreadPool * m_pThreadPool;
+
+   EBM_INLINE EbmModel(const size_t cScores, const size_t cFeatures)
+      : m_pMapping(nullptr)
+      , m_cBytesMapping(0)
+      , m_aQuantizedTensorsOwned(nullptr)
+      , m_cScores(cScores)
+      , m_cFeatures(cFeatures)
+      , m_aFeatures(nullptr)
+      , m_cFeaturesUsed(0)
+      , m_aiFeaturesUsed(nullptr)
+      , m_aiFeatureColumns(nullptr)
+      , m_aTensors(nullptr)
+      , m_aIntercept(nullptr)
+      , m_cBitsQuantized(0)
+      , m_aQuantizedTerms(nullptr)
+      , m_aQuantizedIntercept(nullptr)
+      , m_cThreads(1)
+      , m_pThreadPool(nullptr) {
+   }
+
+   ~EbmModel();
+
+   bool Initialize(
+      const EbmCoreFeature * const aFeatures,
+      const FractionalDataType * const * const aaFeatureCuts,
+      const char * const * const * const aasFeatureCategories,
+      const size_t cFeatureCombinations,
+      const EbmCoreFeatureCombination * const aFeatureCombinations,
+      const IntegerDataType * const aFeatureCombinationIndexes,
+      const FractionalDataType * const * const apModels,
+      const FractionalDataType * const aIntercept
+   );
+
+   // takes ownership of pMapping, which holds a whole model file, even if we fail.  Returns true on error
+   bool InitializeMapping(void * const pMapping, const size_t cBytesMapping);
+
+   // replaces the FractionalDataType tensors of our terms with tensors of cBitsQuantized bit unsigned integers, each with its own scale and offset
+   // that spread the term's range of logits over every integer.  aMaxErrorsReturn receives the largest difference between a logit and its
+   // quantized value for each term, or can be nullptr.  Returns true on error, in which case we're unchanged
+   bool Quantize(const size_t cBitsQuantized, FractionalDataType * const aMaxErrorsReturn);
+
+   // returns true on error
+   bool WriteFile(const char * const sPath) const;
+
+   // replaces our pool with one for cThreads threads.  Returns true on error, in which case we score on the calling thread
+   bool SetCountThreads(const size_t cThreads);
+
+   // cInstances can't be zero.  Different threads can score with us at the same time, and they share our pool.  Returns true on error
+   bool ScoreRawInstances(
+      const size_t cInstances,
+      const FractionalDataType * const aValues,
+      const char * const * const asCategories,
+      const IntegerDataType link,
+      FractionalDataType * const aScoresReturn
+   ) const;
+};
+
+#endif // EBM_MODEL_H
@@ -10,6 +10,7 @@
 
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
+#include "IsaKernels.h"
 
 class EbmStatistics final {
    EBM_INLINE EbmStatistics() {
@@ -120,9 +121,32 @@ public:
       return std::log(1 + std::exp(UNPREDICTABLE(0 == binnedActualValue) ? validationLogOddsPrediction : -validationLogOddsPrediction)); // log & exp will return the same type that it is given, either float or double
    }
 
-   EBM_INLINE static FractionalDataType ComputeClassificationSingleInstanceLogLossMulticlass(const FractionalDataType sumExp, const FractionalDataType * const aValidationLogWeight, const StorageDataTypeCore binnedActualValue) {
+   // ComputeClassificationResidualErrorBinaryclass for cInstances consecutive instances, using the vectorized kernels of the best instruction set that
+   // the processor supports.  Each residual agrees with the scalar version to within a few ULP, and is the same on every instruction set
+   EBM_INLINE static void ComputeClassificationResidualErrorBinaryclass(const size_t cInstances, const StorageFractionalDataTypeCore * const aTrainingLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues, StorageFractionalDataTypeCore * const aResidualErrors) {
+      EBM_ASSERT(0 < cInstances);
+      EBM_ASSERT(nullptr != g_pIsaKernels);
+      (*g_pIsaKernels->m_pComputeClassificationResidualErrorBinaryclass)(cInstances, aTrainingLogOddsPredictions, aBinnedActualValues, aResidualErrors);
+   }
+
+   // the sum of ComputeClassificationSingleInstanceLogLossBinaryclass over cInstances consecutive instances, added in instance order
+   EBM_INLINE static FractionalDataType ComputeClassificationLogLossBinaryclass(const size_t cInstances, const StorageFractionalDataTypeCore * const aValidationLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues) {
+      EBM_ASSERT(0 < cInstances);
+      EBM_ASSERT(nullptr != g_pIsaKernels);
+      return (*g_pIsaKernels->m_pComputeClassificationLogLossBinaryclass)(cInstances, aValidationLogOddsPredictions, aBinnedActualValues);
+   }
+
+   // the index of the split point with the highest ComputeNodeSplittingScore of its left plus its right side, and the first such split point if several tie.
+   // The scores are the same as the scalar version on every instruction set, since we never use fused multiply-add
+   EBM_INLINE static size_t FindBestSplitPoint(const size_t cSplitPoints, const FractionalDataType cInstancesParent, const FractionalDataType * const aCountsLeft, const FractionalDataType * const aSumResidualErrorsLeft, const FractionalDataType * const aSumResidualErrorsRight, FractionalDataType * const pBestNodeSplittingScore) {
+      EBM_ASSERT(0 < cSplitPoints);
+      EBM_ASSERT(nullptr != g_pIsaKernels);
+      return (*g_pIsaKernels->m_pFindBestSplitPoint)(cSplitPoints, cInstancesParent, aCountsLeft, aSumResidualErrorsLeft, aSumResidualErrorsRight, pBestNodeSplittingScore);
+   }
+
+   EBM_INLINE static FractionalDataType ComputeClassificationSingleInstanceLogLossMulticlass(const FractionalDataType sumExp, const StorageFractionalDataTypeCore * const aValidationLogWeight, const StorageDataTypeCore binnedActualValue) {
       // TODO: is there any way to avoid doing the negation below, like changing sumExp or what we store in memory?
-      return -std::log(std::exp(aValidationLogWeight[binnedActualValue]) / sumExp);
+      return -std::log(std::exp(static_cast<FractionalDataType>(aValidationLogWeight[binnedActualValue])) / sumExp);
    }
 };
 
@@ -13,6 +13,7 @@
 #include "EbmInternal.h"
 // very independent includes
 #include "Logging.h" // EBM_ASSERT & LOG
+#include "ArenaAllocator.h"
 #include "SegmentedTensor.h"
 // this depends on TreeNode pointers, but doesn't require the full definition of TreeNode
 #include "CachedThreadResources.h"
@@ -22,8 +23,10 @@
 #include "FeatureCombinationCore.h"
 // dataset depends on features
 #include "DataSetByFeatureCombination.h"
+#include "EbmDataSet.h"
 // samples is somewhat independent from datasets, but relies on an indirect coupling with them
 #include "SamplingWithReplacement.h"
+#include "ThreadPool.h"
 
 union CachedThreadResourcesUnion {
    CachedTrainingThreadResources<false> regression;
@@ -43,6 +46,26 @@ union CachedThreadResourcesUnion {
       LOG_0(TraceLevelInfo, "Exited CachedThreadResourcesUnion");
    }
 
+   EBM_INLINE bool IsError(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) const {
+      if(IsRegression(runtimeLearningTypeOrCountTargetClasses)) {
+         return regression.IsError();
+      } else {
+         EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+         return classification.IsError();
+      }
+   }
+
+   EBM_INLINE void DestroyMember(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+      if(IsRegression(runtimeLearningTypeOrCountTargetClasses)) {
+         // member classes inside a union requre explicit call to destructor
+         regression.~CachedTrainingThreadResources();
+      } else {
+         EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+         // member classes inside a union requre explicit call to destructor
+         classification.~CachedTrainingThreadResources();
+      }
+   }
+
    EBM_INLINE ~CachedThreadResourcesUnion() {
       // TODO: figure out why this is being called, and if that is bad!
       //LOG_0(TraceLevelError, "ERROR ~CachedThreadResourcesUnion called.  It's union destructors should be called explicitly");
@@ -59,6 +82,11 @@ class EbmTrainingState {
 public:
    const ptrdiff_t m_runtimeLearningTypeOrCountTargetClasses;
 
+   // our feature combinations, models, and sampling sets are allocated once during initialization and live as long as we do, so they come from
+   // this arena instead of the heap.  Scratch memory that a boosting step needs is allocated after taking a mark and released by resetting to it
+   // before the step returns, so steady state boosting never calls the system allocator
+   ArenaAllocator m_arena;
+
    const size_t m_cFeatureCombinations;
    FeatureCombinationCore ** const m_apFeatureCombinations;
 
@@ -66,6 +94,15 @@ public:
    DataSetByFeatureCombination * m_pTrainingSet;
    DataSetByFeatureCombination * m_pValidationSet;
 
+   // when this state is one bag of an EbmEnsembleTrainingState, m_pTrainingSet holds every instance of the ensemble and shares its packed data, and
+   // m_pValidationSet is nullptr.  The instances this bag holds out for validation are never sampled, and the validation metric is computed over them
+   // directly from the residuals and predictor scores that m_pTrainingSet keeps up to date
+   size_t m_cValidationSubsetInstances;
+   size_t * m_aValidationSubsetInstanceIndexes;
+
+   // if m_pTrainingSet or m_pValidationSet use feature columns of an EbmDataSet in place, we hold a reference to it so that it outlives them
+   EbmDataSet * m_pSharedDataSet;
+
    const size_t m_cSamplingSets;
 
    SamplingMethod ** m_apSamplingSets;
@@ -83,12 +120,43 @@ public:
 
    CachedThreadResourcesUnion m_cachedThreadResourcesUnion;
 
-   EBM_INLINE EbmTrainingState(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatures, const size_t cFeatureCombinations, const size_t cSamplingSets)
+   // the total number of threads we can use, including the calling thread.  The pool threads are shared by every parallel kernel that trains this state
+   size_t m_cThreads;
+   ThreadPool * m_pThreadPool;
+
+   // worker zero is the calling thread, and it uses m_cachedThreadResourcesUnion and m_pSmallChangeToModelOverwriteSingleSamplingSet above.  Each additional
+   // worker trains sampling sets as a task on the thread pool, so it needs its own thread resources and its own tensor to write the results of a single sampling set into
+   size_t m_cWorkerThreads;
+   CachedThreadResourcesUnion ** m_apAdditionalWorkerCachedThreadResources;
+   SegmentedTensor<ActiveDataType, FractionalDataType> ** m_apAdditionalWorkerSmallChangeToModelOverwrite;
+   // the number of threads each worker can use to bin a single large sampling set in chunks, including the worker's own thread
+   size_t m_cBinningThreadsPerWorker;
+
+   // BoostCycles applies each update in a pass that also bins every sampling set for the feature combination that it boosts next, into
+   // m_aPrebinnedHistograms which it allocates from our arena for as long as it runs.  While m_pFeatureCombinationPrebinned isn't nullptr, the
+   // histogram of sampling set iSamplingSet for it starts at m_aPrebinnedHistograms + iSamplingSet * m_cBytesPrebinnedHistogram.  Any other
+   // update to the training set makes these stale, so it clears m_pFeatureCombinationPrebinned
+   const FeatureCombinationCore * m_pFeatureCombinationPrebinned;
+   unsigned char * m_aPrebinnedHistograms;
+   size_t m_cBytesPrebinnedHistogramsCapacity;
+   size_t m_cBytesPrebinnedHistogram;
+
+   EBM_INLINE static size_t GetCountWorkerThreads(const size_t cThreads, const size_t cSamplingSets) {
+      // each sampling set is trained by exactly one worker, so there is no benefit in having more workers than sampling sets
+      const size_t cSamplingSetsAfterZero = 0 == cSamplingSets ? 1 : cSamplingSets;
+      return cThreads < cSamplingSetsAfterZero ? cThreads : cSamplingSetsAfterZero;
+   }
+
+   EBM_INLINE EbmTrainingState(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatures, const size_t cFeatureCombinations, const size_t cSamplingSets, const size_t cThreads)
       : m_runtimeLearningTypeOrCountTargetClasses(runtimeLearningTypeOrCountTargetClasses)
+      , m_arena(true)
       , m_cFeatureCombinations(cFeatureCombinations)
       , m_apFeatureCombinations(0 == cFeatureCombinations ? nullptr : FeatureCombinationCore::AllocateFeatureCombinations(cFeatureCombinations))
       , m_pTrainingSet(nullptr)
       , m_pValidationSet(nullptr)
+      , m_cValidationSubsetInstances(0)
+      , m_aValidationSubsetInstanceIndexes(nullptr)
+      , m_pSharedDataSet(nullptr)
       , m_cSamplingSets(cSamplingSets)
       , m_apSamplingSets(nullptr)
       , m_apCurrentModel(nullptr)
@@ -99,7 +167,19 @@ public:
       , m_cFeatures(cFeatures)
       , m_aFeatures(0 == cFeatures || IsMultiplyError(sizeof(FeatureCore), cFeatures) ? nullptr : static_cast<FeatureCore *>(malloc(sizeof(FeatureCore) * cFeatures)))
       // we catch any errors in the constructor, so this should not be able to throw
-      , m_cachedThreadResourcesUnion(runtimeLearningTypeOrCountTargetClasses) {
+      , m_cachedThreadResourcesUnion(runtimeLearningTypeOrCountTargetClasses)
+      // SetCountThreads sets these for real once we know how many threads the pool was able to start
+      , m_cThreads(cThreads)
+      , m_pThreadPool(nullptr)
+      , m_cWorkerThreads(1)
+      , m_apAdditionalWorkerCachedThreadResources(nullptr)
+      , m_apAdditionalWorkerSmallChangeToModelOverwrite(nullptr)
+      , m_cBinningThreadsPerWorker(1)
+      , m_pFeatureCombinationPrebinned(nullptr)
+      , m_aPrebinnedHistograms(nullptr)
+      , m_cBytesPrebinnedHistogramsCapacity(0)
+      , m_cBytesPrebinnedHistogram(0) {
+      EBM_ASSERT(1 <= cThreads);
    }
 
    EBM_INLINE ~EbmTrainingState() {
@@ -116,10 +196,16 @@ public:
          m_cachedThreadResourcesUnion.classification.~CachedTrainingThreadResources();
       }
 
+      // stop the pool threads before freeing anything that a task could be using
+      ThreadPool::Free(m_pThreadPool);
+      DeleteAdditionalWorkers();
+
       SamplingWithReplacement::FreeSamplingSets(m_cSamplingSets, m_apSamplingSets);
 
       delete m_pTrainingSet;
       delete m_pValidationSet;
+      free(m_aValidationSubsetInstanceIndexes);
+      EbmDataSet::Release(m_pSharedDataSet);
 
       FeatureCombinationCore::FreeFeatureCombinations(m_cFeatureCombinations, m_apFeatureCombinations);
 
@@ -133,9 +219,21 @@ public:
       LOG_0(TraceLevelInfo, "Exited ~EbmTrainingState");
    }
 
+   void DeleteAdditionalWorkers();
+   bool InitializeAdditionalWorkers();
+   bool SetCountThreads(const size_t cThreads);
+   bool SetPrecomputedDenominators(const bool bPrecomputedDenominators);
    static void DeleteSegmentedTensors(const size_t cFeatureCombinations, SegmentedTensor<ActiveDataType, FractionalDataType> ** const apSegmentedTensors);
-   static SegmentedTensor<ActiveDataType, FractionalDataType> ** InitializeSegmentedTensors(const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations, const size_t cVectorLength);
-   bool Initialize(const IntegerDataType randomSeed, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const IntegerDataType * const aTrainingBinnedData, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const IntegerDataType * const aValidationBinnedData, const FractionalDataType * const aValidationPredictorScores);
+   static SegmentedTensor<ActiveDataType, FractionalDataType> ** InitializeSegmentedTensors(ArenaAllocator * const pArena, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations, const size_t cVectorLength);
+   bool InitializeFeatures(const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cInstances);
+   bool InitializeModels();
+   void InitializeTrainingResiduals(const size_t cTrainingInstances, const void * const aTrainingTargets, const FractionalDataType * const aTrainingPredictorScores);
+   // call InitializeFeatures first.  aValidationMask has one entry per instance of pSharedDataSet, and instances with non-zero entries are held out for validation
+   bool InitializeBagDataSets(const IntegerDataType randomSeed, const DataSetByFeatureCombination * const pSharedDataSet, const void * const aTargets, const FractionalDataType * const aPredictorScores, const IntegerDataType * const aValidationMask);
+   bool IsBoostCyclesParametersError(const IntegerDataType countFeatureCombinationsInCycle, const IntegerDataType * const featureCombinationIndexes, const IntegerDataType countEpisodes, const IntegerDataType countStepsPerFeatureCombination, const FractionalDataType learningRate, const IntegerDataType countTreeSplitsMax, const IntegerDataType countInstancesRequiredForParentSplitMin, const FractionalDataType earlyStoppingTolerance) const;
+   // the parameters need to have been checked with IsBoostCyclesParametersError.  Returns true on error
+   bool BoostCycles(const size_t cFeatureCombinationsInCycle, const IntegerDataType * const featureCombinationIndexes, const IntegerDataType countEpisodes, const IntegerDataType countStepsPerFeatureCombination, const FractionalDataType learningRate, const IntegerDataType countTreeSplitsMax, const IntegerDataType countInstancesRequiredForParentSplitMin, const IntegerDataType earlyStoppingRunLength, const FractionalDataType earlyStoppingTolerance, FractionalDataType * const pValidationMetricReturn, IntegerDataType * const pCountEpisodesReturn);
+   bool Initialize(const IntegerDataType randomSeed, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const BinnedDataView * const pTrainingBinnedData, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const BinnedDataView * const pValidationBinnedData, const FractionalDataType * const aValidationPredictorScores);
 };
 
 #endif // EBM_TRAINING_STATE_H
\ No newline at end of file
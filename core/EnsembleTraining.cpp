@@ -0,0 +1,454 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stdlib.h> // malloc, realloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // numeric_limits
+#include <cmath> // sqrt
+#include <atomic>
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "FeatureCombinationCore.h"
+#include "BinnedDataView.h"
+#include "DataSetByFeatureCombination.h"
+#include "ParallelChunks.h"
+#include "EbmTrainingState.h"
+#include "EbmEnsembleTrainingState.h"
+
+#ifndef NDEBUG
+// defined in Training.cpp
+void CheckTargets(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cInstances, const void * const aTargets);
+#endif // NDEBUG
+
+bool EbmEnsembleTrainingState::SetCountThreads(const size_t cThreads) {
+   LOG_N(TraceLevelInfo, "Entered EbmEnsembleTrainingState::SetCountThreads: cThreads=%zu", cThreads);
+
+   EBM_ASSERT(1 <= cThreads);
+
+   ThreadPool::Free(m_pThreadPool);
+   m_pThreadPool = nullptr;
+   m_cThreads = 1;
+
+   // there is no benefit in having more threads than bags, since each bag trains on a single thread
+   ThreadPool * const pThreadPool = ThreadPool::Allocate(m_cBags < cThreads ? m_cBags : cThreads);
+   if(UNLIKELY(nullptr == pThreadPool)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmEnsembleTrainingState::SetCountThreads nullptr == pThreadPool");
+      return true;
+   }
+   m_pThreadPool = pThreadPool;
+   m_cThreads = pThreadPool->GetCountThreads();
+
+   LOG_0(TraceLevelInfo, "Exited EbmEnsembleTrainingState::SetCountThreads");
+   return false;
+}
+
+bool EbmEnsembleTrainingState::SetPrecomputedDenominators(const bool bPrecomputedDenominators) {
+   LOG_N(TraceLevelInfo, "Entered EbmEnsembleTrainingState::SetPrecomputedDenominators: bPrecomputedDenominators=%d", static_cast<int>(bPrecomputedDenominators));
+
+   for(size_t iBag = 0; iBag < m_cBags; ++iBag) {
+      EBM_ASSERT(nullptr != m_apBags[iBag]);
+      if(UNLIKELY(m_apBags[iBag]->SetPrecomputedDenominators(bPrecomputedDenominators))) {
+         LOG_0(TraceLevelWarning, "WARNING EbmEnsembleTrainingState::SetPrecomputedDenominators m_apBags[iBag]->SetPrecomputedDenominators(bPrecomputedDenominators)");
+         return true;
+      }
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmEnsembleTrainingState::SetPrecomputedDenominators");
+   return false;
+}
+
+bool EbmEnsembleTrainingState::Initialize(const IntegerDataType * const aRandomSeeds, const size_t cFeatures, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cInnerBags, const size_t cInstances, const void * const aTargets, const IntegerDataType * const aBinnedData, const FractionalDataType * const aPredictorScores, const IntegerDataType * const aValidationMasks) {
+   LOG_0(TraceLevelInfo, "Entered EbmEnsembleTrainingState::Initialize");
+
+   EBM_ASSERT(0 < cInstances);
+
+   if(UNLIKELY(nullptr == m_apBags)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmEnsembleTrainingState::Initialize nullptr == m_apBags");
+      return true;
+   }
+
+   if(UNLIKELY(SetCountThreads(m_cThreads))) {
+      LOG_0(TraceLevelWarning, "WARNING EbmEnsembleTrainingState::Initialize SetCountThreads(m_cThreads)");
+      return true;
+   }
+
+   for(size_t iBag = 0; iBag < m_cBags; ++iBag) {
+      EbmTrainingState * const pBag = new (std::nothrow) EbmTrainingState(m_runtimeLearningTypeOrCountTargetClasses, cFeatures, m_cFeatureCombinations, cInnerBags, 1);
+      if(UNLIKELY(nullptr == pBag)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmEnsembleTrainingState::Initialize nullptr == pBag");
+         return true;
+      }
+      m_apBags[iBag] = pBag;
+      if(UNLIKELY(pBag->InitializeFeatures(aFeatures, aFeatureCombinations, featureCombinationIndexes, cInstances))) {
+         LOG_0(TraceLevelWarning, "WARNING EbmEnsembleTrainingState::Initialize pBag->InitializeFeatures");
+         return true;
+      }
+   }
+
+   const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
+   const bool bRegression = IsRegression(m_runtimeLearningTypeOrCountTargetClasses);
+
+   // every bag builds the same feature combinations from the same definitions, so the data packed for the first bag's combinations fits them all
+   BinnedDataView binnedDataView;
+   binnedDataView.InitializeFeatureMajor(cInstances, aBinnedData);
+   LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination for m_pSharedDataSet");
+   m_pSharedDataSet = new (std::nothrow) DataSetByFeatureCombination(false, false, !bRegression, m_cFeatureCombinations, m_apBags[0]->m_apFeatureCombinations, cInstances, &binnedDataView, aTargets, nullptr, cVectorLength);
+   if(nullptr == m_pSharedDataSet || m_pSharedDataSet->IsError()) {
+      LOG_0(TraceLevelWarning, "WARNING EbmEnsembleTrainingState::Initialize nullptr == m_pSharedDataSet || m_pSharedDataSet->IsError()");
+      return true;
+   }
+   LOG_N(TraceLevelInfo, "Exited DataSetByFeatureCombination for m_pSharedDataSet %p", static_cast<void *>(m_pSharedDataSet));
+
+   // each bag only writes to its own state, so the bags can set up their residuals and sampling sets in parallel
+   std::atomic<bool> bError(false);
+   RunChunks(m_pThreadPool, m_cThreads, m_cBags, [&](const size_t iBag) {
+      if(m_apBags[iBag]->InitializeBagDataSets(aRandomSeeds[iBag], m_pSharedDataSet, aTargets, aPredictorScores, &aValidationMasks[iBag * cInstances])) {
+         bError.store(true);
+      }
+   });
+   if(bError.load()) {
+      LOG_0(TraceLevelWarning, "WARNING EbmEnsembleTrainingState::Initialize InitializeBagDataSets");
+      return true;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmEnsembleTrainingState::Initialize");
+   return false;
+}
+
+// a*PredictorScores = logOdds for binary classification
+// a*PredictorScores = logWeights for multiclass classification
+// a*PredictorScores = predictedValue for regression
+static EbmEnsembleTrainingState * AllocateCoreEnsembleTraining(const IntegerDataType countBags, const IntegerDataType * const randomSeeds, const IntegerDataType countFeatures, const EbmCoreFeature * const features, const IntegerDataType countFeatureCombinations, const EbmCoreFeatureCombination * const featureCombinations, const IntegerDataType * const featureCombinationIndexes, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const IntegerDataType countInstances, const void * const targets, const IntegerDataType * const binnedData, const FractionalDataType * const predictorScores, const IntegerDataType * const validationMasks, const IntegerDataType countInnerBags) {
+   EBM_ASSERT(1 <= countBags);
+   EBM_ASSERT(nullptr != randomSeeds);
+   EBM_ASSERT(0 <= countFeatures);
+   EBM_ASSERT(0 == countFeatures || nullptr != features);
+   EBM_ASSERT(0 <= countFeatureCombinations);
+   EBM_ASSERT(0 == countFeatureCombinations || nullptr != featureCombinations);
+   // featureCombinationIndexes -> it's legal for featureCombinationIndexes to be nullptr if there are no features indexed by our featureCombinations
+   // countTargetClasses is checked by our caller since it's only valid for classification at this point
+   EBM_ASSERT(1 <= countInstances);
+   EBM_ASSERT(nullptr != targets);
+   EBM_ASSERT(0 == countFeatures || nullptr != binnedData);
+   // predictorScores can be null
+   EBM_ASSERT(nullptr != validationMasks);
+   EBM_ASSERT(0 <= countInnerBags);
+
+   if(countBags < 1) {
+      LOG_0(TraceLevelError, "ERROR AllocateCoreEnsembleTraining countBags must be 1 or more");
+      return nullptr;
+   }
+   if(nullptr == randomSeeds) {
+      LOG_0(TraceLevelError, "ERROR AllocateCoreEnsembleTraining randomSeeds can't be null");
+      return nullptr;
+   }
+   if(countInstances < 1) {
+      LOG_0(TraceLevelError, "ERROR AllocateCoreEnsembleTraining countInstances must be 1 or more");
+      return nullptr;
+   }
+   if(nullptr == validationMasks) {
+      LOG_0(TraceLevelError, "ERROR AllocateCoreEnsembleTraining validationMasks can't be null");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countBags)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreEnsembleTraining !IsNumberConvertable<size_t, IntegerDataType>(countBags)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreEnsembleTraining !IsNumberConvertable<size_t, IntegerDataType>(countFeatures)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreEnsembleTraining !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreEnsembleTraining !IsNumberConvertable<size_t, IntegerDataType>(countInstances)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInnerBags)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreEnsembleTraining !IsNumberConvertable<size_t, IntegerDataType>(countInnerBags)");
+      return nullptr;
+   }
+
+   const size_t cBags = static_cast<size_t>(countBags);
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cFeatureCombinations = static_cast<size_t>(countFeatureCombinations);
+   const size_t cInstances = static_cast<size_t>(countInstances);
+   const size_t cInnerBags = static_cast<size_t>(countInnerBags);
+
+   const size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+
+   if(IsMultiplyError(cVectorLength, cInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreEnsembleTraining IsMultiplyError(cVectorLength, cInstances)");
+      return nullptr;
+   }
+   if(IsMultiplyError(cBags, cInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreEnsembleTraining IsMultiplyError(cBags, cInstances)");
+      return nullptr;
+   }
+
+#ifndef NDEBUG
+   CheckTargets(runtimeLearningTypeOrCountTargetClasses, cInstances, targets);
+#endif // NDEBUG
+
+   const size_t cThreads = 1;
+
+   LOG_0(TraceLevelInfo, "Entered EbmEnsembleTrainingState");
+   EbmEnsembleTrainingState * const pEbmEnsembleTrainingState = new (std::nothrow) EbmEnsembleTrainingState(runtimeLearningTypeOrCountTargetClasses, cFeatureCombinations, cBags, cThreads);
+   LOG_N(TraceLevelInfo, "Exited EbmEnsembleTrainingState %p", static_cast<void *>(pEbmEnsembleTrainingState));
+   if(UNLIKELY(nullptr == pEbmEnsembleTrainingState)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreEnsembleTraining nullptr == pEbmEnsembleTrainingState");
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmEnsembleTrainingState->Initialize(randomSeeds, cFeatures, features, featureCombinations, featureCombinationIndexes, cInnerBags, cInstances, targets, binnedData, predictorScores, validationMasks))) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreEnsembleTraining pEbmEnsembleTrainingState->Initialize");
+      delete pEbmEnsembleTrainingState;
+      return nullptr;
+   }
+   return pEbmEnsembleTrainingState;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmEnsembleTraining EBMCORE_CALLING_CONVENTION InitializeEnsembleTrainingRegression(
+   IntegerDataType countBags,
+   const IntegerDataType * randomSeeds,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores,
+   const IntegerDataType * validationMasks,
+   IntegerDataType countInnerBags
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeEnsembleTrainingRegression: countBags=%" IntegerDataTypePrintf ", randomSeeds=%p, countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p, validationMasks=%p, countInnerBags=%" IntegerDataTypePrintf, countBags, static_cast<const void *>(randomSeeds), countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores), static_cast<const void *>(validationMasks), countInnerBags);
+   PEbmEnsembleTraining pEbmEnsembleTraining = reinterpret_cast<PEbmEnsembleTraining>(AllocateCoreEnsembleTraining(countBags, randomSeeds, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, k_Regression, countInstances, targets, binnedData, predictorScores, validationMasks, countInnerBags));
+   LOG_N(TraceLevelInfo, "Exited InitializeEnsembleTrainingRegression %p", static_cast<void *>(pEbmEnsembleTraining));
+   return pEbmEnsembleTraining;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmEnsembleTraining EBMCORE_CALLING_CONVENTION InitializeEnsembleTrainingClassification(
+   IntegerDataType countBags,
+   const IntegerDataType * randomSeeds,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores,
+   const IntegerDataType * validationMasks,
+   IntegerDataType countInnerBags
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeEnsembleTrainingClassification: countBags=%" IntegerDataTypePrintf ", randomSeeds=%p, countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTargetClasses=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p, validationMasks=%p, countInnerBags=%" IntegerDataTypePrintf, countBags, static_cast<const void *>(randomSeeds), countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTargetClasses, countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores), static_cast<const void *>(validationMasks), countInnerBags);
+   if(countTargetClasses < 0) {
+      LOG_0(TraceLevelError, "ERROR InitializeEnsembleTrainingClassification countTargetClasses can't be negative");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeEnsembleTrainingClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      return nullptr;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
+   PEbmEnsembleTraining pEbmEnsembleTraining = reinterpret_cast<PEbmEnsembleTraining>(AllocateCoreEnsembleTraining(countBags, randomSeeds, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, runtimeLearningTypeOrCountTargetClasses, countInstances, targets, binnedData, predictorScores, validationMasks, countInnerBags));
+   LOG_N(TraceLevelInfo, "Exited InitializeEnsembleTrainingClassification %p", static_cast<void *>(pEbmEnsembleTraining));
+   return pEbmEnsembleTraining;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION BoostEnsembleCycles(
+   PEbmEnsembleTraining ebmEnsembleTraining,
+   IntegerDataType countFeatureCombinationsInCycle,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countEpisodes,
+   IntegerDataType countStepsPerFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   IntegerDataType earlyStoppingRunLength,
+   FractionalDataType earlyStoppingTolerance,
+   FractionalDataType * validationMetricsReturn,
+   IntegerDataType * countEpisodesReturn
+) {
+   LOG_N(TraceLevelInfo, "Entered BoostEnsembleCycles: ebmEnsembleTraining=%p, countFeatureCombinationsInCycle=%" IntegerDataTypePrintf ", featureCombinationIndexes=%p, countEpisodes=%" IntegerDataTypePrintf ", countStepsPerFeatureCombination=%" IntegerDataTypePrintf ", learningRate=%" FractionalDataTypePrintf ", countTreeSplitsMax=%" IntegerDataTypePrintf ", countInstancesRequiredForParentSplitMin=%" IntegerDataTypePrintf ", earlyStoppingRunLength=%" IntegerDataTypePrintf ", earlyStoppingTolerance=%" FractionalDataTypePrintf ", validationMetricsReturn=%p, countEpisodesReturn=%p", static_cast<void *>(ebmEnsembleTraining), countFeatureCombinationsInCycle, static_cast<const void *>(featureCombinationIndexes), countEpisodes, countStepsPerFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, earlyStoppingRunLength, earlyStoppingTolerance, static_cast<void *>(validationMetricsReturn), static_cast<void *>(countEpisodesReturn));
+
+   EbmEnsembleTrainingState * pEbmEnsembleTrainingState = reinterpret_cast<EbmEnsembleTrainingState *>(ebmEnsembleTraining);
+   EBM_ASSERT(nullptr != pEbmEnsembleTrainingState);
+   // validationMetricsReturn can be nullptr
+   // countEpisodesReturn can be nullptr
+
+   const size_t cBags = pEbmEnsembleTrainingState->m_cBags;
+   for(size_t iBag = 0; iBag < cBags; ++iBag) {
+      if(nullptr != validationMetricsReturn) {
+         validationMetricsReturn[iBag] = std::numeric_limits<FractionalDataType>::infinity();
+      }
+      if(nullptr != countEpisodesReturn) {
+         countEpisodesReturn[iBag] = 0;
+      }
+   }
+
+   // every bag has the same feature combinations, so checking against the first one is enough
+   if(pEbmEnsembleTrainingState->m_apBags[0]->IsBoostCyclesParametersError(countFeatureCombinationsInCycle, featureCombinationIndexes, countEpisodes, countStepsPerFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, earlyStoppingTolerance)) {
+      return 1;
+   }
+   const size_t cFeatureCombinationsInCycle = static_cast<size_t>(countFeatureCombinationsInCycle);
+
+   // the bags are independent, so how the bags are spread over the threads doesn't change any of the models
+   std::atomic<bool> bError(false);
+   RunChunks(pEbmEnsembleTrainingState->m_pThreadPool, pEbmEnsembleTrainingState->m_cThreads, cBags, [&](const size_t iBag) {
+      FractionalDataType * const pValidationMetricReturn = nullptr == validationMetricsReturn ? nullptr : &validationMetricsReturn[iBag];
+      IntegerDataType * const pCountEpisodesReturn = nullptr == countEpisodesReturn ? nullptr : &countEpisodesReturn[iBag];
+      if(pEbmEnsembleTrainingState->m_apBags[iBag]->BoostCycles(cFeatureCombinationsInCycle, featureCombinationIndexes, countEpisodes, countStepsPerFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, earlyStoppingRunLength, earlyStoppingTolerance, pValidationMetricReturn, pCountEpisodesReturn)) {
+         bError.store(true);
+      }
+   });
+   if(bError.load()) {
+      LOG_0(TraceLevelWarning, "WARNING BoostEnsembleCycles BoostCycles failed on a bag");
+      return 1;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited BoostEnsembleCycles");
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetEnsembleModelFeatureCombination(
+   PEbmEnsembleTraining ebmEnsembleTraining,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType * averageModelReturn,
+   FractionalDataType * standardDeviationReturn
+) {
+   LOG_N(TraceLevelInfo, "Entered GetEnsembleModelFeatureCombination: ebmEnsembleTraining=%p, indexFeatureCombination=%" IntegerDataTypePrintf ", averageModelReturn=%p, standardDeviationReturn=%p", static_cast<void *>(ebmEnsembleTraining), indexFeatureCombination, static_cast<void *>(averageModelReturn), static_cast<void *>(standardDeviationReturn));
+
+   EbmEnsembleTrainingState * pEbmEnsembleTrainingState = reinterpret_cast<EbmEnsembleTrainingState *>(ebmEnsembleTraining);
+   EBM_ASSERT(nullptr != pEbmEnsembleTrainingState);
+   // standardDeviationReturn can be nullptr
+
+   if(indexFeatureCombination < 0 || !IsNumberConvertable<size_t, IntegerDataType>(indexFeatureCombination) || pEbmEnsembleTrainingState->m_cFeatureCombinations <= static_cast<size_t>(indexFeatureCombination)) {
+      LOG_0(TraceLevelError, "ERROR GetEnsembleModelFeatureCombination indexFeatureCombination is not a valid feature combination");
+      return 1;
+   }
+   const size_t iFeatureCombination = static_cast<size_t>(indexFeatureCombination);
+
+   const EbmTrainingState * const pFirstBag = pEbmEnsembleTrainingState->m_apBags[0];
+   if(nullptr == pFirstBag->m_apBestModel) {
+      // for classification with 1 or 0 target classes the models are empty tensors (see GetBestModelFeatureCombination), so there is nothing to write
+      LOG_0(TraceLevelInfo, "Exited GetEnsembleModelFeatureCombination no model");
+      return 0;
+   }
+   if(nullptr == averageModelReturn) {
+      LOG_0(TraceLevelError, "ERROR GetEnsembleModelFeatureCombination averageModelReturn can't be null");
+      return 1;
+   }
+
+   const FeatureCombinationCore * const pFeatureCombination = pFirstBag->m_apFeatureCombinations[iFeatureCombination];
+   size_t cValues = GetVectorLengthFlatCore(pEbmEnsembleTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   for(size_t iDimension = 0; iDimension < pFeatureCombination->m_cFeatures; ++iDimension) {
+      // we checked for overflow of the tensor size when we built the feature combination
+      cValues *= pFeatureCombination->m_FeatureCombinationEntry[iDimension].m_pFeature->m_cBins;
+   }
+
+   const size_t cBags = pEbmEnsembleTrainingState->m_cBags;
+   const FractionalDataType cBagsFractional = static_cast<FractionalDataType>(cBags);
+
+   // two passes over the bags so that the standard deviation is computed from the deviations around the mean, which is more accurate than the sum of squares
+   for(size_t iValue = 0; iValue < cValues; ++iValue) {
+      averageModelReturn[iValue] = 0;
+   }
+   for(size_t iBag = 0; iBag < cBags; ++iBag) {
+      SegmentedTensor<ActiveDataType, FractionalDataType> * const pBestModel = pEbmEnsembleTrainingState->m_apBags[iBag]->m_apBestModel[iFeatureCombination];
+      EBM_ASSERT(pBestModel->m_bExpanded); // the model should have been expanded at startup
+      const FractionalDataType * const aValues = pBestModel->GetValuePointer();
+      for(size_t iValue = 0; iValue < cValues; ++iValue) {
+         averageModelReturn[iValue] += aValues[iValue];
+      }
+   }
+   for(size_t iValue = 0; iValue < cValues; ++iValue) {
+      averageModelReturn[iValue] /= cBagsFractional;
+   }
+
+   if(nullptr != standardDeviationReturn) {
+      for(size_t iValue = 0; iValue < cValues; ++iValue) {
+         standardDeviationReturn[iValue] = 0;
+      }
+      for(size_t iBag = 0; iBag < cBags; ++iBag) {
+         const FractionalDataType * const aValues = pEbmEnsembleTrainingState->m_apBags[iBag]->m_apBestModel[iFeatureCombination]->GetValuePointer();
+         for(size_t iValue = 0; iValue < cValues; ++iValue) {
+            const FractionalDataType deviation = aValues[iValue] - averageModelReturn[iValue];
+            standardDeviationReturn[iValue] += deviation * deviation;
+         }
+      }
+      for(size_t iValue = 0; iValue < cValues; ++iValue) {
+         // the population standard deviation, which is what numpy's std computes by default
+         standardDeviationReturn[iValue] = std::sqrt(standardDeviationReturn[iValue] / cBagsFractional);
+      }
+   }
+
+   LOG_0(TraceLevelInfo, "Exited GetEnsembleModelFeatureCombination");
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetEnsembleTrainingThreadCount(
+   PEbmEnsembleTraining ebmEnsembleTraining,
+   IntegerDataType countThreads
+) {
+   LOG_N(TraceLevelInfo, "Entered SetEnsembleTrainingThreadCount: ebmEnsembleTraining=%p, countThreads=%" IntegerDataTypePrintf, static_cast<void *>(ebmEnsembleTraining), countThreads);
+
+   EbmEnsembleTrainingState * pEbmEnsembleTrainingState = reinterpret_cast<EbmEnsembleTrainingState *>(ebmEnsembleTraining);
+   EBM_ASSERT(nullptr != pEbmEnsembleTrainingState);
+
+   if(countThreads < 0) {
+      LOG_0(TraceLevelError, "ERROR SetEnsembleTrainingThreadCount countThreads can't be negative");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING SetEnsembleTrainingThreadCount !IsNumberConvertable<size_t, IntegerDataType>(countThreads)");
+      return 1;
+   }
+   // zero means use every hardware thread, which is also what we do if our caller never calls us
+   const size_t cThreads = 0 == countThreads ? ThreadPool::GetCountHardwareThreads() : static_cast<size_t>(countThreads);
+   if(pEbmEnsembleTrainingState->SetCountThreads(cThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING SetEnsembleTrainingThreadCount pEbmEnsembleTrainingState->SetCountThreads(cThreads)");
+      return 1;
+   }
+
+   LOG_N(TraceLevelInfo, "Exited SetEnsembleTrainingThreadCount %zu threads", pEbmEnsembleTrainingState->m_cThreads);
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetEnsembleTrainingPrecomputedDenominators(
+   PEbmEnsembleTraining ebmEnsembleTraining,
+   IntegerDataType precomputeDenominators
+) {
+   LOG_N(TraceLevelInfo, "Entered SetEnsembleTrainingPrecomputedDenominators: ebmEnsembleTraining=%p, precomputeDenominators=%" IntegerDataTypePrintf, static_cast<void *>(ebmEnsembleTraining), precomputeDenominators);
+
+   EbmEnsembleTrainingState * pEbmEnsembleTrainingState = reinterpret_cast<EbmEnsembleTrainingState *>(ebmEnsembleTraining);
+   EBM_ASSERT(nullptr != pEbmEnsembleTrainingState);
+
+   if(pEbmEnsembleTrainingState->SetPrecomputedDenominators(0 != precomputeDenominators)) {
+      LOG_0(TraceLevelWarning, "WARNING SetEnsembleTrainingPrecomputedDenominators pEbmEnsembleTrainingState->SetPrecomputedDenominators(0 != precomputeDenominators)");
+      return 1;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited SetEnsembleTrainingPrecomputedDenominators");
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeEnsembleTraining(
+   PEbmEnsembleTraining ebmEnsembleTraining
+) {
+   LOG_N(TraceLevelInfo, "Entered FreeEnsembleTraining: ebmEnsembleTraining=%p", static_cast<void *>(ebmEnsembleTraining));
+   EbmEnsembleTrainingState * pEbmEnsembleTrainingState = reinterpret_cast<EbmEnsembleTrainingState *>(ebmEnsembleTraining);
+   EBM_ASSERT(nullptr != pEbmEnsembleTrainingState);
+   delete pEbmEnsembleTrainingState;
+   LOG_0(TraceLevelInfo, "Exited FreeEnsembleTraining");
+}
@@ -10,6 +10,7 @@
 
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
+#include "ArenaAllocator.h"
 #include "FeatureCore.h"
 
 class FeatureCombinationCore final {
@@ -41,10 +42,11 @@ public:
       m_cLogExitApplyModelFeatureCombinationUpdateMessages = 2;
    }
 
-   EBM_INLINE static FeatureCombinationCore * Allocate(const size_t cFeatures, const size_t iFeatureCombination) {
+   // our feature combinations live in the arena of the state that owns them, so they are freed along with it
+   EBM_INLINE static FeatureCombinationCore * Allocate(ArenaAllocator * const pArena, const size_t cFeatures, const size_t iFeatureCombination) {
       const size_t cBytes = GetFeatureCombinationCountBytes(cFeatures);
       EBM_ASSERT(0 < cBytes);
-      FeatureCombinationCore * const pFeatureCombination = static_cast<FeatureCombinationCore *>(malloc(cBytes));
+      FeatureCombinationCore * const pFeatureCombination = static_cast<FeatureCombinationCore *>(pArena->Allocate(cBytes));
       if(UNLIKELY(nullptr == pFeatureCombination)) {
          return nullptr;
       }
@@ -52,10 +54,6 @@ public:
       return pFeatureCombination;
    }
 
-   EBM_INLINE static void Free(FeatureCombinationCore * const pFeatureCombination) {
-      free(pFeatureCombination);
-   }
-
    EBM_INLINE static FeatureCombinationCore ** AllocateFeatureCombinations(const size_t cFeatureCombinations) {
       LOG_0(TraceLevelInfo, "Entered FeatureCombination::AllocateFeatureCombinations");
 
@@ -74,9 +72,8 @@ public:
       LOG_0(TraceLevelInfo, "Entered FeatureCombination::FreeFeatureCombinations");
       if(nullptr != apFeatureCombinations) {
          EBM_ASSERT(0 < cFeatureCombinations);
-         for(size_t i = 0; i < cFeatureCombinations; ++i) {
-            FeatureCombinationCore::Free(apFeatureCombinations[i]);
-         }
+         UNUSED(cFeatureCombinations);
+         // the feature combinations themselves are freed with the arena that they were allocated from
          delete[] apFeatureCombinations;
       }
       LOG_0(TraceLevelInfo, "Exited FeatureCombination::FreeFeatureCombinations");
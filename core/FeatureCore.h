@@ -15,6 +15,9 @@ class FeatureCore final {
 public:
    const size_t m_cBins;
    const size_t m_iFeatureData;
+   // DataSetByFeature bit packs the bins of each feature into StorageDataTypeCore units, the same way that DataSetByFeatureCombination packs each
+   // feature combination.  A feature with 0 or 1 bins still gets 1 bit per item so that we never divide by zero bits
+   const size_t m_cItemsPerBitPackDataUnit;
    // TODO : implement feature to handle m_featureType
    const FeatureTypeCore m_featureType;
    // TODO : implement feature to handle m_bMissing
@@ -23,6 +26,7 @@ public:
    EBM_INLINE FeatureCore(const size_t cBins, const size_t iFeatureData, const FeatureTypeCore featureType, const bool bMissing)
       : m_cBins(cBins)
       , m_iFeatureData(iFeatureData)
+      , m_cItemsPerBitPackDataUnit(GetCountItemsBitPacked(CountBitsRequiredCore(cBins <= 1 ? size_t { 1 } : cBins - 1)))
       , m_featureType(featureType)
       , m_bMissing(bMissing) {
    }
@@ -0,0 +1,93 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+// the mapping calls depend on the operating system rather than the compiler, and MinGW builds for Windows (like R's Rtools) don't define _MSC_VER
+#if defined(_WIN32)
+// windows.h would otherwise define min and max macros, which break std::numeric_limits<T>::max() in the headers that we include after it
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#include <windows.h> // CreateFileMapping, MapViewOfFile
+#else // defined(_WIN32)
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#endif // defined(_WIN32)
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+
+#include "FileMapping.h"
+
+void * MapFile(const char * const sPath, const size_t cBytesMin, size_t * const pcBytes) {
+#if defined(_WIN32)
+   HANDLE hFile = CreateFileA(sPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if(INVALID_HANDLE_VALUE == hFile) {
+      LOG_0(TraceLevelWarning, "WARNING MapFile CreateFileA");
+      return nullptr;
+   }
+   LARGE_INTEGER cBytesFile;
+   if(!GetFileSizeEx(hFile, &cBytesFile) || !IsNumberConvertable<size_t, LONGLONG>(cBytesFile.QuadPart) || static_cast<size_t>(cBytesFile.QuadPart) < cBytesMin) {
+      LOG_0(TraceLevelWarning, "WARNING MapFile the file is too small or too large");
+      CloseHandle(hFile);
+      return nullptr;
+   }
+   HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   CloseHandle(hFile);
+   if(nullptr == hMapping) {
+      LOG_0(TraceLevelWarning, "WARNING MapFile CreateFileMappingA");
+      return nullptr;
+   }
+   // the view keeps the mapping alive after we close our handles to it
+   void * const pMapping = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+   CloseHandle(hMapping);
+   if(nullptr == pMapping) {
+      LOG_0(TraceLevelWarning, "WARNING MapFile MapViewOfFile");
+      return nullptr;
+   }
+   *pcBytes = static_cast<size_t>(cBytesFile.QuadPart);
+   return pMapping;
+#else // defined(_WIN32)
+   const int fd = open(sPath, O_RDONLY);
+   if(fd < 0) {
+      LOG_0(TraceLevelWarning, "WARNING MapFile open");
+      return nullptr;
+   }
+   struct stat fileStatus;
+   if(0 != fstat(fd, &fileStatus) || !IsNumberConvertable<size_t, off_t>(fileStatus.st_size) || static_cast<size_t>(fileStatus.st_size) < cBytesMin) {
+      LOG_0(TraceLevelWarning, "WARNING MapFile the file is too small or too large");
+      close(fd);
+      return nullptr;
+   }
+   const size_t cBytes = static_cast<size_t>(fileStatus.st_size);
+   // every process that maps the same file shares its pages through the page cache
+   void * const pMapping = mmap(nullptr, cBytes, PROT_READ, MAP_SHARED, fd, 0);
+   // the mapping stays valid after we close the file
+   close(fd);
+   if(MAP_FAILED == pMapping) {
+      LOG_0(TraceLevelWarning, "WARNING MapFile mmap");
+      return nullptr;
+   }
+   *pcBytes = cBytes;
+   return pMapping;
+#endif // defined(_WIN32)
+}
+
+void UnmapFile(void * const pMapping, const size_t cBytes) {
+#if defined(_WIN32)
+   UNUSED(cBytes);
+   UnmapViewOfFile(pMapping);
+#else // defined(_WIN32)
+   munmap(pMapping, cBytes);
+#endif // defined(_WIN32)
+}
@@ -0,0 +1,15 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef FILE_MAPPING_H
+#define FILE_MAPPING_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+// maps a whole file read only and shared, so every process that maps the same file shares one copy of its pages through the page cache.  Files
+// shorter than cBytesMin are refused, which lets our callers read a fixed size header without checking.  Returns nullptr on error
+void * MapFile(const char * const sPath, const size_t cBytesMin, size_t * const pcBytes);
+void UnmapFile(void * const pMapping, const size_t cBytes);
+
+#endif // FILE_MAPPING_H
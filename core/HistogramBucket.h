@@ -20,6 +20,8 @@
 #include "DataSetByFeatureCombination.h"
 #include "DataSetByFeature.h"
 #include "SamplingWithReplacement.h"
+#include "ParallelChunks.h"
+#include "IsaKernels.h"
 
 // we don't need to handle multi-dimensional inputs with more than 64 bits total
 // the rational is that we need to bin this data, and our binning memory will be N1*N1*...*N(D-1)*N(D)
@@ -36,6 +38,9 @@
 template<bool bClassification>
 class HistogramBucket;
 
+template<bool bClassification>
+class CachedTrainingThreadResources;
+
 template<bool bClassification>
 EBM_INLINE bool GetHistogramBucketSizeOverflow(const size_t cVectorLength) {
    return IsMultiplyError(sizeof(HistogramBucketVectorEntry<bClassification>), cVectorLength) ? true : IsAddError(sizeof(HistogramBucket<bClassification>) - sizeof(HistogramBucketVectorEntry<bClassification>), sizeof(HistogramBucketVectorEntry<bClassification>) * cVectorLength) ? true : false;
@@ -128,21 +133,33 @@ public:
 static_assert(std::is_pod<HistogramBucket<false>>::value, "HistogramBucket will be more efficient as a POD as we make potentially large arrays of them!");
 static_assert(std::is_pod<HistogramBucket<true>>::value, "HistogramBucket will be more efficient as a POD as we make potentially large arrays of them!");
 
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-void BinDataSetTrainingZeroDimensions(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
-   LOG_0(TraceLevelVerbose, "Entered BinDataSetTrainingZeroDimensions");
+#ifndef NDEBUG
+// the multiclass residuals of an instance sum to zero aside from the error in computing them, but each one is also rounded when we store it, which
+// matters when we build with EBM_FLOAT_RESIDUALS
+EBM_INLINE FractionalDataType GetResidualTotalToleranceDebug(const FractionalDataType toleranceComputation, const size_t cVectorLength) {
+   return toleranceComputation + static_cast<FractionalDataType>(cVectorLength) * static_cast<FractionalDataType>(std::numeric_limits<StorageFractionalDataTypeCore>::epsilon());
+}
+#endif // NDEBUG
 
+// bins the instances [iInstanceStart, iInstanceStart + cInstances) of the sampling set.  This can be called from any binning thread, so it doesn't log
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+void BinDataSetTrainingZeroDimensionsChunk(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry, const SamplingMethod * const pTrainingSet, const size_t iInstanceStart, const size_t cInstances, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
    EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
 
-   const size_t cInstances = pTrainingSet->m_pOriginDataSet->GetCountInstances();
    EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(iInstanceStart + cInstances <= pTrainingSet->m_pOriginDataSet->GetCountInstances());
 
    const SamplingWithReplacement * const pSamplingWithReplacement = static_cast<const SamplingWithReplacement *>(pTrainingSet);
-   const size_t * pCountOccurrences = pSamplingWithReplacement->m_aCountOccurrences;
-   const FractionalDataType * pResidualError = pSamplingWithReplacement->m_pOriginDataSet->GetResidualPointer();
+   const StorageCountOccurrencesCore * pCountOccurrences = pSamplingWithReplacement->m_aCountOccurrences + iInstanceStart;
+   const StorageFractionalDataTypeCore * pResidualError = pSamplingWithReplacement->m_pOriginDataSet->GetResidualPointer() + cVectorLength * iInstanceStart;
    // this shouldn't overflow since we're accessing existing memory
-   const FractionalDataType * const pResidualErrorEnd = pResidualError + cVectorLength * cInstances;
+   const StorageFractionalDataTypeCore * const pResidualErrorEnd = pResidualError + cVectorLength * cInstances;
+   // nullptr unless the denominators are kept next to the residuals, which only happens for classification
+   const StorageFractionalDataTypeCore * pDenominator = pSamplingWithReplacement->m_pOriginDataSet->GetDenominatorPointer();
+   if(nullptr != pDenominator) {
+      pDenominator += cVectorLength * iInstanceStart;
+   }
 
    HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketVectorEntry = &pHistogramBucketEntry->aHistogramBucketVectorEntry[0];
    while(pResidualErrorEnd != pResidualError) {
@@ -153,7 +170,7 @@ void BinDataSetTrainingZeroDimensions(HistogramBucket<IsClassification(compilerL
 
       // TODO : try using a sampling method with non-repeating instances, and put the count into a bit.  Then unwind that loop either at the byte level (8 times) or the uint64_t level.  This can be done without branching and doesn't require random number generators
 
-      const size_t cOccurences = *pCountOccurrences;
+      const size_t cOccurences = static_cast<size_t>(*pCountOccurrences);
       ++pCountOccurrences;
       pHistogramBucketEntry->cInstancesInBucket += cOccurences;
       const FractionalDataType cFloatOccurences = static_cast<FractionalDataType>(cOccurences);
@@ -168,15 +185,16 @@ void BinDataSetTrainingZeroDimensions(HistogramBucket<IsClassification(compilerL
 #endif // NDEBUG
       size_t iVector = 0;
       do {
-         const FractionalDataType residualError = *pResidualError;
+         const FractionalDataType residualError = static_cast<FractionalDataType>(*pResidualError);
          EBM_ASSERT(!IsClassification(compilerLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } == runtimeLearningTypeOrCountTargetClasses && !bExpandBinaryLogits || static_cast<ptrdiff_t>(iVector) != k_iZeroResidual || 0 == residualError);
 #ifndef NDEBUG
          residualTotalDebug += residualError;
 #endif // NDEBUG
          pHistogramBucketVectorEntry[iVector].sumResidualError += cFloatOccurences * residualError;
          if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
-            // TODO : this code gets executed for each SamplingWithReplacement set.  I could probably execute it once and then all the SamplingWithReplacement sets would have this value, but I would need to store the computation in a new memory place, and it might make more sense to calculate this values in the CPU rather than put more pressure on memory.  I think controlling this should be done in a MACRO and we should use a class to hold the residualError and this computation from that value and then comment out the computation if not necssary and access it through an accessor so that we can make the change entirely via macro
-            const FractionalDataType denominator = EbmStatistics::ComputeNewtonRaphsonStep(residualError);
+            // this code gets executed for each SamplingWithReplacement set, so if our caller let us keep the denominators next to the residuals we load
+            // them instead of recomputing the same values in every bag
+            const FractionalDataType denominator = nullptr == pDenominator ? EbmStatistics::ComputeNewtonRaphsonStep(residualError) : static_cast<FractionalDataType>(pDenominator[iVector]);
             pHistogramBucketVectorEntry[iVector].SetSumDenominator(pHistogramBucketVectorEntry[iVector].GetSumDenominator() + cFloatOccurences * denominator);
          }
          ++pResidualError;
@@ -185,23 +203,23 @@ void BinDataSetTrainingZeroDimensions(HistogramBucket<IsClassification(compilerL
          // if we make this (iVector != cVectorLength) then the loop is not collapsed
          // the compiler seems to not mind if we make this a for loop or do loop in terms of collapsing away the loop
       } while(iVector < cVectorLength);
+      if(nullptr != pDenominator) {
+         pDenominator += cVectorLength;
+      }
 
-      EBM_ASSERT(!IsClassification(compilerLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } == runtimeLearningTypeOrCountTargetClasses && !bExpandBinaryLogits || 0 <= k_iZeroResidual || -0.00000000001 < residualTotalDebug && residualTotalDebug < 0.00000000001);
+      EBM_ASSERT(!IsClassification(compilerLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } == runtimeLearningTypeOrCountTargetClasses && !bExpandBinaryLogits || 0 <= k_iZeroResidual || -GetResidualTotalToleranceDebug(0.00000000001, cVectorLength) < residualTotalDebug && residualTotalDebug < GetResidualTotalToleranceDebug(0.00000000001, cVectorLength));
    }
-   LOG_0(TraceLevelVerbose, "Exited BinDataSetTrainingZeroDimensions");
 }
 
-// TODO : remove cCompilerDimensions since we don't need it anymore, and replace it with a more useful number like the number of cItemsPerBitPackDataUnit
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
-void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+// bins the instances [iInstanceStart, iInstanceStart + cInstances) of the sampling set.  iInstanceStart must fall on the boundary of a bit packed data unit.
+// This can be called from any binning thread, so it doesn't log
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+void BinDataSetTrainingChunk(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const size_t iInstanceStart, const size_t cInstances, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
    , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
 ) {
-   LOG_0(TraceLevelVerbose, "Entered BinDataSetTraining");
-
-   EBM_ASSERT(cCompilerDimensions == pFeatureCombination->m_cFeatures);
-   static_assert(1 <= cCompilerDimensions, "cCompilerDimensions must be 1 or greater");
+   EBM_ASSERT(1 <= pFeatureCombination->m_cFeatures);
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
    const size_t cItemsPerBitPackDataUnit = pFeatureCombination->m_cItemsPerBitPackDataUnit;
@@ -210,15 +228,29 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
    EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
    const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
 
-   const size_t cInstances = pTrainingSet->m_pOriginDataSet->GetCountInstances();
    EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(iInstanceStart + cInstances <= pTrainingSet->m_pOriginDataSet->GetCountInstances());
+   EBM_ASSERT(0 == iInstanceStart % cItemsPerBitPackDataUnit);
 
    const SamplingWithReplacement * const pSamplingWithReplacement = static_cast<const SamplingWithReplacement *>(pTrainingSet);
-   const size_t * pCountOccurrences = pSamplingWithReplacement->m_aCountOccurrences;
-   const StorageDataTypeCore * pInputData = pSamplingWithReplacement->m_pOriginDataSet->GetDataPointer(pFeatureCombination);
-   const FractionalDataType * pResidualError = pSamplingWithReplacement->m_pOriginDataSet->GetResidualPointer();
+   const StorageCountOccurrencesCore * pCountOccurrences = pSamplingWithReplacement->m_aCountOccurrences + iInstanceStart;
+   const StorageDataTypeCore * pInputData = pSamplingWithReplacement->m_pOriginDataSet->GetDataPointer(pFeatureCombination) + iInstanceStart / cItemsPerBitPackDataUnit;
+   // nullptr unless the denominators are kept next to the residuals, which only happens for classification
+   const StorageFractionalDataTypeCore * pDenominator = pSamplingWithReplacement->m_pOriginDataSet->GetDenominatorPointer();
+   if(nullptr != pDenominator) {
+      pDenominator += cVectorLength * iInstanceStart;
+   }
+   const StorageFractionalDataTypeCore * pResidualError = pSamplingWithReplacement->m_pOriginDataSet->GetResidualPointer() + cVectorLength * iInstanceStart;
+
+   if(1 == cVectorLength) {
+      // regression and binary classification have a single score per bucket, which the kernels compiled for each instruction set handle
+      EBM_ASSERT(sizeof(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)>) == cBytesPerHistogramBucket);
+      BinInstancesSingleScore(cInstances, cItemsPerBitPackDataUnit, pInputData, pCountOccurrences, pResidualError, pDenominator, aHistogramBuckets);
+      return;
+   }
+
    // this shouldn't overflow since we're accessing existing memory
-   const FractionalDataType * const pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete = pResidualError + static_cast<ptrdiff_t>(cVectorLength) * (static_cast<ptrdiff_t>(cInstances) - static_cast<ptrdiff_t>(cItemsPerBitPackDataUnit));
+   const StorageFractionalDataTypeCore * const pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete = pResidualError + static_cast<ptrdiff_t>(cVectorLength) * (static_cast<ptrdiff_t>(cInstances) - static_cast<ptrdiff_t>(cItemsPerBitPackDataUnit));
 
    size_t cItemsRemaining;
 
@@ -243,7 +275,7 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
          HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry = GetHistogramBucketByIndex(cBytesPerHistogramBucket, aHistogramBuckets, iTensorBin);
 
          ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucketEntry, aHistogramBucketsEndDebug);
-         const size_t cOccurences = *pCountOccurrences;
+         const size_t cOccurences = static_cast<size_t>(*pCountOccurrences);
          ++pCountOccurrences;
          pHistogramBucketEntry->cInstancesInBucket += cOccurences;
          const FractionalDataType cFloatOccurences = static_cast<FractionalDataType>(cOccurences);
@@ -259,15 +291,16 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
          FractionalDataType residualTotalDebug = 0;
 #endif // NDEBUG
          do {
-            const FractionalDataType residualError = *pResidualError;
+            const FractionalDataType residualError = static_cast<FractionalDataType>(*pResidualError);
             EBM_ASSERT(!IsClassification(compilerLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } == runtimeLearningTypeOrCountTargetClasses && !bExpandBinaryLogits || static_cast<ptrdiff_t>(iVector) != k_iZeroResidual || 0 == residualError);
 #ifndef NDEBUG
             residualTotalDebug += residualError;
 #endif // NDEBUG
             pHistogramBucketVectorEntry[iVector].sumResidualError += cFloatOccurences * residualError;
             if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
-               // TODO : this code gets executed for each SamplingWithReplacement set.  I could probably execute it once and then all the SamplingWithReplacement sets would have this value, but I would need to store the computation in a new memory place, and it might make more sense to calculate this values in the CPU rather than put more pressure on memory.  I think controlling this should be done in a MACRO and we should use a class to hold the residualError and this computation from that value and then comment out the computation if not necssary and access it through an accessor so that we can make the change entirely via macro
-               const FractionalDataType denominator = EbmStatistics::ComputeNewtonRaphsonStep(residualError);
+               // this code gets executed for each SamplingWithReplacement set, so if our caller let us keep the denominators next to the residuals we load
+               // them instead of recomputing the same values in every bag
+               const FractionalDataType denominator = nullptr == pDenominator ? EbmStatistics::ComputeNewtonRaphsonStep(residualError) : static_cast<FractionalDataType>(pDenominator[iVector]);
                pHistogramBucketVectorEntry[iVector].SetSumDenominator(pHistogramBucketVectorEntry[iVector].GetSumDenominator() + cFloatOccurences * denominator);
             }
             ++pResidualError;
@@ -276,18 +309,19 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
             // if we make this (iVector != cVectorLength) then the loop is not collapsed
             // the compiler seems to not mind if we make this a for loop or do loop in terms of collapsing away the loop
          } while(iVector < cVectorLength);
+         if(nullptr != pDenominator) {
+            pDenominator += cVectorLength;
+         }
 
-         EBM_ASSERT(!IsClassification(compilerLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } == runtimeLearningTypeOrCountTargetClasses && !bExpandBinaryLogits || 0 <= k_iZeroResidual || -0.0000001 < residualTotalDebug && residualTotalDebug < 0.0000001);
+         EBM_ASSERT(!IsClassification(compilerLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } == runtimeLearningTypeOrCountTargetClasses && !bExpandBinaryLogits || 0 <= k_iZeroResidual || -GetResidualTotalToleranceDebug(0.0000001, cVectorLength) < residualTotalDebug && residualTotalDebug < GetResidualTotalToleranceDebug(0.0000001, cVectorLength));
 
          iTensorBinCombined >>= cBitsPerItemMax;
          // TODO : try replacing cItemsRemaining with a pResidualErrorInnerLoopEnd which eliminates one subtact operation, but might make it harder for the compiler to optimize the loop away
          --cItemsRemaining;
       } while(0 != cItemsRemaining);
    }
-   const FractionalDataType * const pResidualErrorEnd = pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
+   const StorageFractionalDataTypeCore * const pResidualErrorEnd = pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
    if(pResidualError < pResidualErrorEnd) {
-      LOG_0(TraceLevelVerbose, "Handling last BinDataSetTraining loop");
-
       // first time through?
       EBM_ASSERT(0 == (pResidualErrorEnd - pResidualError) % cVectorLength);
       cItemsRemaining = (pResidualErrorEnd - pResidualError) / cVectorLength;
@@ -296,15 +330,199 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
       goto one_last_loop;
    }
    EBM_ASSERT(pResidualError == pResidualErrorEnd); // after our second iteration we should have finished everything!
+}
+
+// Large sampling sets are binned in chunks.  Each chunk of instances is binned into its own private histogram, possibly on a separate thread, and the
+// private histograms are then summed together by a pairwise tree reduction.  The chunk boundaries and the shape of the reduction tree depend only on
+// the number of instances and the size of the histogram, and never on the number of threads, so the floating point additions happen in the same order
+// regardless of how many threads are available and the resulting histogram is bit for bit identical to binning the same chunks serially.
+//
+// Each binning thread streams through its chunk of the instance data while randomly updating its private histogram, so we only chunk when that
+// histogram fits comfortably within a typical per-core L2 cache.  Larger histograms (mostly pairs with many bins) would thrash the cache and also
+// make the reduction expensive, so those are binned in a single pass.
+constexpr size_t k_cBytesHistogramChunkL2Max = size_t { 256 } * size_t { 1024 };
+// chunks need to be long enough that streaming through the instance data dominates zeroing and reducing the private histograms
+constexpr size_t k_cInstancesPerHistogramChunkMin = size_t { 65536 };
+constexpr size_t k_cHistogramChunksMax = size_t { 64 };
+// bound the memory that the private histograms can use since we keep them all until the reduction
+constexpr size_t k_cBytesHistogramChunksMax = size_t { 4 } * size_t { 1024 } * size_t { 1024 };
+
+EBM_INLINE size_t GetCountHistogramChunks(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const size_t cBytesHistogram, size_t * const pcInstancesPerChunk) {
+   EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(1 <= cItemsPerBitPackDataUnit);
+   EBM_ASSERT(0 < cBytesHistogram);
+   EBM_ASSERT(nullptr != pcInstancesPerChunk);
+
+   if(k_cBytesHistogramChunkL2Max < cBytesHistogram) {
+      *pcInstancesPerChunk = cInstances;
+      return size_t { 1 };
+   }
+   const size_t cChunksMemoryMax = size_t { 1 } + k_cBytesHistogramChunksMax / cBytesHistogram;
+   return GetCountChunks(cInstances, cItemsPerBitPackDataUnit, k_cInstancesPerHistogramChunkMin, cChunksMemoryMax < k_cHistogramChunksMax ? cChunksMemoryMax : k_cHistogramChunksMax, pcInstancesPerChunk);
+}
+
+// sums the private histograms of cChunks chunks into the histogram of chunk zero with a pairwise tree reduction
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, typename TGetChunkHistogram>
+void ReduceHistogramChunks(const size_t cHistogramBuckets, const size_t cChunks, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const TGetChunkHistogram & getChunkHistogram) {
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+
+   for(size_t cStride = 1; cStride < cChunks; cStride <<= 1) {
+      for(size_t iChunk = 0; iChunk + cStride < cChunks; iChunk += cStride << 1) {
+         HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pHistogramBucketTo = getChunkHistogram(iChunk);
+         const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pHistogramBucketFrom = getChunkHistogram(iChunk + cStride);
+         for(size_t iBucket = 0; iBucket < cHistogramBuckets; ++iBucket) {
+            pHistogramBucketTo->template Add<compilerLearningTypeOrCountTargetClasses>(*pHistogramBucketFrom, runtimeLearningTypeOrCountTargetClasses);
+            pHistogramBucketTo = GetHistogramBucketByIndex(cBytesPerHistogramBucket, pHistogramBucketTo, 1);
+            pHistogramBucketFrom = GetHistogramBucketByIndex(cBytesPerHistogramBucket, pHistogramBucketFrom, 1);
+         }
+      }
+   }
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, typename TBinChunk>
+bool BinDataSetTrainingChunked(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const size_t cHistogramBuckets, const size_t cChunks, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const TBinChunk & binChunk) {
+   EBM_ASSERT(2 <= cChunks);
+   EBM_ASSERT(1 <= cHistogramBuckets);
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   // GetCountHistogramChunks limits the total size of the private histograms, so this can't overflow
+   const size_t cBytesHistogram = cHistogramBuckets * cBytesPerHistogramBucket;
+
+   // the first chunk is binned directly into aHistogramBuckets, which our caller has already zeroed, so we only need private histograms for the rest
+   char * const aChunkHistograms = static_cast<char *>(pCachedThreadResources->GetHistogramChunkBuffer((cChunks - 1) * cBytesHistogram));
+   if(UNLIKELY(nullptr == aChunkHistograms)) {
+      LOG_0(TraceLevelWarning, "WARNING BinDataSetTrainingChunked nullptr == aChunkHistograms");
+      return true;
+   }
+   auto GetChunkHistogram = [=](const size_t iChunk) -> HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * {
+      return 0 == iChunk ? aHistogramBuckets : reinterpret_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(aChunkHistograms + (iChunk - 1) * cBytesHistogram);
+   };
+
+   // each chunk has its own histogram, so the chunks can be binned in any order on any thread
+   RunChunks(pCachedThreadResources->GetBinningThreadPool(), pCachedThreadResources->GetCountBinningThreads(), cChunks, [&](const size_t iChunk) {
+      HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aChunkHistogram = GetChunkHistogram(iChunk);
+      if(0 != iChunk) {
+         // zero our private histogram on the thread that bins into it so that it's in that thread's cache
+         memset(aChunkHistogram, 0, cBytesHistogram);
+      }
+      binChunk(aChunkHistogram, iChunk);
+   });
+
+   ReduceHistogramChunks<compilerLearningTypeOrCountTargetClasses>(cHistogramBuckets, cChunks, runtimeLearningTypeOrCountTargetClasses, GetChunkHistogram);
+   return false;
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+bool BinDataSetTrainingZeroDimensions(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetTrainingZeroDimensions");
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+
+   const void * const aPrebinnedHistogram = pCachedThreadResources->GetPrebinnedHistogram();
+   if(nullptr != aPrebinnedHistogram) {
+      memcpy(pHistogramBucketEntry, aPrebinnedHistogram, cBytesPerHistogramBucket);
+      LOG_0(TraceLevelVerbose, "Exited BinDataSetTrainingZeroDimensions with a prebinned histogram");
+      return false;
+   }
+
+   const size_t cInstances = pTrainingSet->m_pOriginDataSet->GetCountInstances();
+   EBM_ASSERT(0 < cInstances);
+
+   size_t cInstancesPerChunk;
+   const size_t cChunks = GetCountHistogramChunks(cInstances, 1, cBytesPerHistogramBucket, &cInstancesPerChunk);
+   if(1 == cChunks) {
+      BinDataSetTrainingZeroDimensionsChunk<compilerLearningTypeOrCountTargetClasses>(pHistogramBucketEntry, pTrainingSet, 0, cInstances, runtimeLearningTypeOrCountTargetClasses);
+   } else {
+      LOG_N(TraceLevelVerbose, "BinDataSetTrainingZeroDimensions binning in %zu chunks", cChunks);
+      const bool bError = BinDataSetTrainingChunked<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pHistogramBucketEntry, 1, cChunks, runtimeLearningTypeOrCountTargetClasses, 
+         [=](HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pChunkHistogramBucketEntry, const size_t iChunk) {
+            const size_t iInstanceStart = iChunk * cInstancesPerChunk;
+            const size_t cInstancesRemaining = cInstances - iInstanceStart;
+            BinDataSetTrainingZeroDimensionsChunk<compilerLearningTypeOrCountTargetClasses>(pChunkHistogramBucketEntry, pTrainingSet, iInstanceStart, cInstancesRemaining < cInstancesPerChunk ? cInstancesRemaining : cInstancesPerChunk, runtimeLearningTypeOrCountTargetClasses);
+         }
+      );
+      if(UNLIKELY(bError)) {
+         LOG_0(TraceLevelWarning, "WARNING BinDataSetTrainingZeroDimensions BinDataSetTrainingChunked failed");
+         return true;
+      }
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited BinDataSetTrainingZeroDimensions");
+   return false;
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
+bool BinDataSetTraining(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetTraining");
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+
+   const size_t cInstances = pTrainingSet->m_pOriginDataSet->GetCountInstances();
+   EBM_ASSERT(0 < cInstances);
+
+   // our caller has already allocated the histogram, so none of these multiplications can overflow
+   size_t cHistogramBuckets = 1;
+   for(size_t iDimension = 0; iDimension < pFeatureCombination->m_cFeatures; ++iDimension) {
+      cHistogramBuckets *= pFeatureCombination->m_FeatureCombinationEntry[iDimension].m_pFeature->m_cBins;
+   }
+   const size_t cBytesHistogram = cHistogramBuckets * cBytesPerHistogramBucket;
+   EBM_ASSERT(reinterpret_cast<const unsigned char *>(aHistogramBuckets) + cBytesHistogram <= aHistogramBucketsEndDebug);
+
+   const void * const aPrebinnedHistogram = pCachedThreadResources->GetPrebinnedHistogram();
+   if(nullptr != aPrebinnedHistogram) {
+      memcpy(aHistogramBuckets, aPrebinnedHistogram, cBytesHistogram);
+      LOG_0(TraceLevelVerbose, "Exited BinDataSetTraining with a prebinned histogram");
+      return false;
+   }
+
+   size_t cInstancesPerChunk;
+   const size_t cChunks = GetCountHistogramChunks(cInstances, pFeatureCombination->m_cItemsPerBitPackDataUnit, cBytesHistogram, &cInstancesPerChunk);
+   if(1 == cChunks) {
+      BinDataSetTrainingChunk<compilerLearningTypeOrCountTargetClasses>(aHistogramBuckets, pFeatureCombination, pTrainingSet, 0, cInstances, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   } else {
+      LOG_N(TraceLevelVerbose, "BinDataSetTraining binning in %zu chunks", cChunks);
+      const bool bError = BinDataSetTrainingChunked<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, aHistogramBuckets, cHistogramBuckets, cChunks, runtimeLearningTypeOrCountTargetClasses,
+         [=](HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aChunkHistogramBuckets, const size_t iChunk) {
+            const size_t iInstanceStart = iChunk * cInstancesPerChunk;
+            const size_t cInstancesRemaining = cInstances - iInstanceStart;
+            BinDataSetTrainingChunk<compilerLearningTypeOrCountTargetClasses>(aChunkHistogramBuckets, pFeatureCombination, pTrainingSet, iInstanceStart, cInstancesRemaining < cInstancesPerChunk ? cInstancesRemaining : cInstancesPerChunk, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+               , reinterpret_cast<const unsigned char *>(aChunkHistogramBuckets) + cBytesHistogram
+#endif // NDEBUG
+            );
+         }
+      );
+      if(UNLIKELY(bError)) {
+         LOG_0(TraceLevelWarning, "WARNING BinDataSetTraining BinDataSetTrainingChunked failed");
+         return true;
+      }
+   }
 
    LOG_0(TraceLevelVerbose, "Exited BinDataSetTraining");
+   return false;
 }
 
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
 class RecursiveBinDataSetTraining {
    // C++ does not allow partial function specialization, so we need to use these cumbersome inline static class functions to do partial function specialization
 public:
-   EBM_INLINE static void Recursive(const size_t cRuntimeDimensions, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+   EBM_INLINE static bool Recursive(const size_t cRuntimeDimensions, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
       , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -312,13 +530,13 @@ public:
       EBM_ASSERT(cRuntimeDimensions < k_cDimensionsMax);
       static_assert(cCompilerDimensions < k_cDimensionsMax, "cCompilerDimensions must be less than or equal to k_cDimensionsMax.  This line only handles the less than part, but we handle the equals in a partial specialization template.");
       if(cCompilerDimensions == cRuntimeDimensions) {
-         BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions>(aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+         return BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions>(pCachedThreadResources, aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
             , aHistogramBucketsEndDebug
 #endif // NDEBUG
          );
       } else {
-         RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 1 + cCompilerDimensions>::Recursive(cRuntimeDimensions, aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+         return RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 1 + cCompilerDimensions>::Recursive(cRuntimeDimensions, pCachedThreadResources, aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
             , aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -331,14 +549,14 @@ template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
 class RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, k_cDimensionsMax> {
    // C++ does not allow partial function specialization, so we need to use these cumbersome inline static class functions to do partial function specialization
 public:
-   EBM_INLINE static void Recursive(const size_t cRuntimeDimensions, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+   EBM_INLINE static bool Recursive(const size_t cRuntimeDimensions, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
       , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
    ) {
       UNUSED(cRuntimeDimensions);
       EBM_ASSERT(k_cDimensionsMax == cRuntimeDimensions);
-      BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, k_cDimensionsMax>(aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+      return BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, k_cDimensionsMax>(pCachedThreadResources, aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
          , aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -359,12 +577,44 @@ void BinDataSetInteraction(HistogramBucket<IsClassification(compilerLearningType
    EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
    const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
 
-   const FractionalDataType * pResidualError = pDataSet->GetResidualPointer();
-   const FractionalDataType * const pResidualErrorEnd = pResidualError + cVectorLength * pDataSet->GetCountInstances();
-
-   size_t cFeatures = pFeatureCombination->m_cFeatures;
+   const StorageFractionalDataTypeCore * pResidualError = pDataSet->GetResidualPointer();
+   const StorageFractionalDataTypeCore * const pResidualErrorEnd = pResidualError + cVectorLength * pDataSet->GetCountInstances();
+
+   // each feature is bit packed with its own width, so we keep a separate unpacking cursor for each dimension
+   struct InputDataCursor {
+      const StorageDataTypeCore * m_pInputData;
+      size_t m_iBinCombined;
+      size_t m_cItemsRemaining;
+      size_t m_cItemsPerBitPackDataUnit;
+      size_t m_cBitsPerItemMax;
+      size_t m_maskBits;
+      size_t m_cBins;
+   };
+   InputDataCursor aInputDataCursors[k_cDimensionsMax];
+
+   const size_t cFeatures = pFeatureCombination->m_cFeatures;
    EBM_ASSERT(1 <= cFeatures); // for interactions, we just return 0 for interactions with zero features
-   for(size_t iInstance = 0; pResidualErrorEnd != pResidualError; ++iInstance) {
+   EBM_ASSERT(cFeatures <= k_cDimensionsMax);
+   for(size_t iDimension = 0; iDimension < cFeatures; ++iDimension) {
+      const FeatureCore * const pInputFeature = pFeatureCombination->m_FeatureCombinationEntry[iDimension].m_pFeature;
+      InputDataCursor * const pInputDataCursor = &aInputDataCursors[iDimension];
+      pInputDataCursor->m_pInputData = pDataSet->GetDataPointer(pInputFeature);
+      pInputDataCursor->m_iBinCombined = 0;
+      // we load the first data unit when we process the first instance
+      pInputDataCursor->m_cItemsRemaining = 0;
+      const size_t cItemsPerBitPackDataUnit = pInputFeature->m_cItemsPerBitPackDataUnit;
+      EBM_ASSERT(1 <= cItemsPerBitPackDataUnit);
+      EBM_ASSERT(cItemsPerBitPackDataUnit <= k_cCountItemsBitPackedMax);
+      pInputDataCursor->m_cItemsPerBitPackDataUnit = cItemsPerBitPackDataUnit;
+      const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
+      EBM_ASSERT(1 <= cBitsPerItemMax);
+      EBM_ASSERT(cBitsPerItemMax <= k_cBitsForStorageType);
+      pInputDataCursor->m_cBitsPerItemMax = cBitsPerItemMax;
+      pInputDataCursor->m_maskBits = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMax);
+      pInputDataCursor->m_cBins = pInputFeature->m_cBins;
+   }
+
+   while(pResidualErrorEnd != pResidualError) {
       // this loop gets about twice as slow if you add a single unpredictable branching if statement based on count, even if you still access all the memory in complete sequential order, so we'll probably want to use non-branching instructions for any solution like conditional selection or multiplication
       // this loop gets about 3 times slower if you use a bad pseudo random number generator like rand(), although it might be better if you inlined rand().
       // this loop gets about 10 times slower if you use a proper pseudo random number generator like std::default_random_engine
@@ -376,26 +626,30 @@ void BinDataSetInteraction(HistogramBucket<IsClassification(compilerLearningType
 
       size_t cBuckets = 1;
       size_t iBucket = 0;
-      size_t iDimension = 0;
+      InputDataCursor * pInputDataCursor = aInputDataCursors;
+      const InputDataCursor * const pInputDataCursorEnd = aInputDataCursors + cFeatures;
       do {
-         const FeatureCore * const pInputFeature = pFeatureCombination->m_FeatureCombinationEntry[iDimension].m_pFeature;
-         const size_t cBins = pInputFeature->m_cBins;
-         const StorageDataTypeCore * pInputData = pDataSet->GetDataPointer(pInputFeature);
-         pInputData += iInstance;
-         StorageDataTypeCore iBinOriginal = *pInputData;
-         EBM_ASSERT((IsNumberConvertable<size_t, StorageDataTypeCore>(iBinOriginal)));
-         size_t iBin = static_cast<size_t>(iBinOriginal);
+         if(0 == pInputDataCursor->m_cItemsRemaining) {
+            pInputDataCursor->m_iBinCombined = static_cast<size_t>(*pInputDataCursor->m_pInputData);
+            ++pInputDataCursor->m_pInputData;
+            pInputDataCursor->m_cItemsRemaining = pInputDataCursor->m_cItemsPerBitPackDataUnit;
+         }
+         const size_t iBin = pInputDataCursor->m_maskBits & pInputDataCursor->m_iBinCombined;
+         pInputDataCursor->m_iBinCombined >>= pInputDataCursor->m_cBitsPerItemMax;
+         --pInputDataCursor->m_cItemsRemaining;
+
+         const size_t cBins = pInputDataCursor->m_cBins;
          EBM_ASSERT(iBin < cBins);
          iBucket += cBuckets * iBin;
          cBuckets *= cBins;
-         ++iDimension;
-      } while(iDimension < cFeatures);
+         ++pInputDataCursor;
+      } while(pInputDataCursorEnd != pInputDataCursor);
  
       HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pHistogramBucketEntry = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, aHistogramBuckets, iBucket);
       ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucketEntry, aHistogramBucketsEndDebug);
       pHistogramBucketEntry->cInstancesInBucket += 1;
       for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
-         const FractionalDataType residualError = *pResidualError;
+         const FractionalDataType residualError = static_cast<FractionalDataType>(*pResidualError);
          pHistogramBucketEntry->aHistogramBucketVectorEntry[iVector].sumResidualError += residualError;
          if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
             // TODO : this code gets executed for each SamplingWithReplacement set.  I could probably execute it once and then all the SamplingWithReplacement sets would have this value, but I would need to store the computation in a new memory place, and it might make more sense to calculate this values in the CPU rather than put more pressure on memory.  I think controlling this should be done in a MACRO and we should use a class to hold the residualError and this computation from that value and then comment out the computation if not necssary and access it through an accessor so that we can make the change entirely via macro
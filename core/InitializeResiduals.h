@@ -15,7 +15,7 @@
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static void InitializeResiduals(const size_t cInstances, const void * const aTargetData, const FractionalDataType * const aPredictorScores, FractionalDataType * pResidualError, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+static void InitializeResiduals(const size_t cInstances, const void * const aTargetData, const FractionalDataType * const aPredictorScores, StorageFractionalDataTypeCore * pResidualError, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    LOG_0(TraceLevelInfo, "Entered InitializeResiduals");
 
    // TODO : review this function to see if iZeroResidual was set to a valid index, does that affect the number of items in pPredictorScores (I assume so), and does it affect any calculations below like sumExp += std::exp(predictionScore) and the equivalent.  Should we use cVectorLength or runtimeLearningTypeOrCountTargetClasses for some of the addition
@@ -29,26 +29,27 @@ static void InitializeResiduals(const size_t cInstances, const void * const aTar
    EBM_ASSERT(!IsMultiplyError(cVectorLength, cInstances)); // if we couldn't multiply these then we should not have been able to allocate pResidualError before calling this function
    const size_t cVectoredItems = cVectorLength * cInstances;
    EBM_ASSERT(!IsMultiplyError(cVectoredItems, sizeof(pResidualError[0]))); // if we couldn't multiply these then we should not have been able to allocate pResidualError before calling this function
-   const FractionalDataType * const pResidualErrorEnd = pResidualError + cVectoredItems;
+   const StorageFractionalDataTypeCore * const pResidualErrorEnd = pResidualError + cVectoredItems;
 
    if(nullptr == aPredictorScores) {
       // TODO: do we really need to handle the case where pPredictorScores is null? In the future, we'll probably initialize our data with the intercept, in which case we'll always have existing predictions
       if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
-         // calling ComputeRegressionResidualError(predictionScore, data) with predictionScore as zero gives just data, so we can memcopy these values
-         memcpy(pResidualError, aTargetData, cInstances * sizeof(pResidualError[0]));
-#ifndef NDEBUG
+         // calling ComputeRegressionResidualError(predictionScore, data) with predictionScore as zero gives just data, so we can copy these values.
+         // We can't memcpy them since our residuals might be stored in single precision
          const FractionalDataType * pTargetData = static_cast<const FractionalDataType *>(aTargetData);
          do {
             const FractionalDataType data = *pTargetData;
             EBM_ASSERT(!std::isnan(data));
             EBM_ASSERT(!std::isinf(data));
+#ifndef NDEBUG
             const FractionalDataType predictionScore = 0;
             const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(predictionScore, data);
-            EBM_ASSERT(*pResidualError == residualError);
+            EBM_ASSERT(data == residualError);
+#endif // NDEBUG
+            *pResidualError = static_cast<StorageFractionalDataTypeCore>(data);
             ++pTargetData;
             ++pResidualError;
          } while(pResidualErrorEnd != pResidualError);
-#endif // NDEBUG
       } else {
          EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
 
@@ -70,13 +71,13 @@ static void InitializeResiduals(const size_t cInstances, const void * const aTar
 
             if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
                const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorBinaryclass(target);
-               *pResidualError = residualError;
+               *pResidualError = static_cast<StorageFractionalDataTypeCore>(residualError);
                ++pResidualError;
             } else {
                for(StorageDataTypeCore iVector = 0; iVector < cVectorLengthStorage; ++iVector) {
                   const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorMulticlass(target, iVector, matchValue, nonMatchValue);
                   EBM_ASSERT(EbmStatistics::ComputeClassificationResidualErrorMulticlass(static_cast<FractionalDataType>(cVectorLength), 0, target, iVector) == residualError);
-                  *pResidualError = residualError;
+                  *pResidualError = static_cast<StorageFractionalDataTypeCore>(residualError);
                   ++pResidualError;
                }
                // TODO: this works as a way to remove one parameter, but it obviously insn't as efficient as omitting the parameter
@@ -105,7 +106,7 @@ static void InitializeResiduals(const size_t cInstances, const void * const aTar
             EBM_ASSERT(!std::isinf(data));
             const FractionalDataType predictionScore = *pPredictorScores;
             const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(predictionScore, data);
-            *pResidualError = residualError;
+            *pResidualError = static_cast<StorageFractionalDataTypeCore>(residualError);
             ++pTargetData;
             ++pPredictorScores;
             ++pResidualError;
@@ -128,7 +129,7 @@ static void InitializeResiduals(const size_t cInstances, const void * const aTar
             if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
                const FractionalDataType predictionScore = *pPredictorScores;
                const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorBinaryclass(predictionScore, target);
-               *pResidualError = residualError;
+               *pResidualError = static_cast<StorageFractionalDataTypeCore>(residualError);
                ++pPredictorScores;
                ++pResidualError;
             } else {
@@ -149,7 +150,7 @@ static void InitializeResiduals(const size_t cInstances, const void * const aTar
                   const FractionalDataType predictionScore = *pPredictorScores - subtract;
                   // TODO : we're calculating exp(predictionScore) above, and then again in ComputeClassificationResidualErrorMulticlass.  exp(..) is expensive so we should just do it once instead and store the result in a small memory array here
                   const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorMulticlass(sumExp, predictionScore, target, iVector);
-                  *pResidualError = residualError;
+                  *pResidualError = static_cast<StorageFractionalDataTypeCore>(residualError);
                   ++pPredictorScores;
                   ++pResidualError;
                }
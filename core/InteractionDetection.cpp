@@ -8,6 +8,8 @@
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // numeric_limits
+#include <algorithm> // partial_sort
+#include <atomic>
 
 #include "ebmcore.h"
 #include "EbmInternal.h"
@@ -15,16 +17,19 @@
 // feature includes
 #include "FeatureCore.h"
 // dataset depends on features
+#include "BinnedDataView.h"
 #include "DataSetByFeature.h"
+#include "EbmDataSet.h"
 // depends on the above
 #include "DimensionMultiple.h"
+#include "ParallelChunks.h"
 
 #include "EbmInteractionState.h"
 
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
-EbmInteractionState * AllocateCoreInteraction(IntegerDataType countFeatures, const EbmCoreFeature * features, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, IntegerDataType countInstances, const void * targets, const IntegerDataType * binnedData, const FractionalDataType * predictorScores) {
+EbmInteractionState * AllocateCoreInteraction(IntegerDataType countFeatures, const EbmCoreFeature * features, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, IntegerDataType countInstances, const void * targets, const EbmCoreBinnedData * binnedData, const FractionalDataType * predictorScores) {
    EBM_ASSERT(0 <= countFeatures);
    EBM_ASSERT(0 == countFeatures || nullptr != features);
    // countTargetClasses is checked by our caller since it's only valid for classification at this point
@@ -45,14 +50,22 @@ EbmInteractionState * AllocateCoreInteraction(IntegerDataType countFeatures, con
    size_t cFeatures = static_cast<size_t>(countFeatures);
    size_t cInstances = static_cast<size_t>(countInstances);
 
+   BinnedDataView binnedDataView;
+   if(binnedDataView.Initialize(cFeatures, cInstances, binnedData)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreInteraction binnedDataView.Initialize");
+      return nullptr;
+   }
+
+   const size_t cThreads = 1;
+
    LOG_0(TraceLevelInfo, "Entered EbmInteractionState");
-   EbmInteractionState * const pEbmInteractionState = new (std::nothrow) EbmInteractionState(runtimeLearningTypeOrCountTargetClasses, cFeatures);
+   EbmInteractionState * const pEbmInteractionState = new (std::nothrow) EbmInteractionState(runtimeLearningTypeOrCountTargetClasses, cFeatures, cThreads);
    LOG_N(TraceLevelInfo, "Exited EbmInteractionState %p", static_cast<void *>(pEbmInteractionState));
    if(UNLIKELY(nullptr == pEbmInteractionState)) {
       LOG_0(TraceLevelWarning, "WARNING AllocateCoreInteraction nullptr == pEbmInteractionState");
       return nullptr;
    }
-   if(UNLIKELY(pEbmInteractionState->InitializeInteraction(features, cInstances, targets, binnedData, predictorScores))) {
+   if(UNLIKELY(pEbmInteractionState->InitializeInteraction(features, cInstances, targets, &binnedDataView, predictorScores, nullptr))) {
       LOG_0(TraceLevelWarning, "WARNING AllocateCoreInteraction pEbmInteractionState->InitializeInteraction");
       delete pEbmInteractionState;
       return nullptr;
@@ -60,109 +73,177 @@ EbmInteractionState * AllocateCoreInteraction(IntegerDataType countFeatures, con
    return pEbmInteractionState;
 }
 
-EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionRegression(
+EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionRegressionStrided(
    IntegerDataType countFeatures,
    const EbmCoreFeature * features,
    IntegerDataType countInstances,
    const FractionalDataType * targets,
-   const IntegerDataType * binnedData,
+   const EbmCoreBinnedData * binnedData,
    const FractionalDataType * predictorScores
 ) {
-   LOG_N(TraceLevelInfo, "Entered InitializeInteractionRegression: countFeatures=%" IntegerDataTypePrintf ", features=%p, countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores));
+   LOG_N(TraceLevelInfo, "Entered InitializeInteractionRegressionStrided: countFeatures=%" IntegerDataTypePrintf ", features=%p, countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores));
    PEbmInteraction pEbmInteraction = reinterpret_cast<PEbmInteraction>(AllocateCoreInteraction(countFeatures, features, k_Regression, countInstances, targets, binnedData, predictorScores));
-   LOG_N(TraceLevelInfo, "Exited InitializeInteractionRegression %p", static_cast<void *>(pEbmInteraction));
+   LOG_N(TraceLevelInfo, "Exited InitializeInteractionRegressionStrided %p", static_cast<void *>(pEbmInteraction));
    return pEbmInteraction;
 }
 
-EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionClassification(
+EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionClassificationStrided(
    IntegerDataType countFeatures,
    const EbmCoreFeature * features,
    IntegerDataType countTargetClasses,
    IntegerDataType countInstances,
    const IntegerDataType * targets,
-   const IntegerDataType * binnedData,
+   const EbmCoreBinnedData * binnedData,
    const FractionalDataType * predictorScores
 ) {
-   LOG_N(TraceLevelInfo, "Entered InitializeInteractionClassification: countFeatures=%" IntegerDataTypePrintf ", features=%p, countTargetClasses=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countTargetClasses, countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores));
+   LOG_N(TraceLevelInfo, "Entered InitializeInteractionClassificationStrided: countFeatures=%" IntegerDataTypePrintf ", features=%p, countTargetClasses=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countTargetClasses, countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores));
    if(countTargetClasses < 0) {
-      LOG_0(TraceLevelError, "ERROR InitializeInteractionClassification countTargetClasses can't be negative");
+      LOG_0(TraceLevelError, "ERROR InitializeInteractionClassificationStrided countTargetClasses can't be negative");
       return nullptr;
    }
    if(0 == countTargetClasses && 0 != countInstances) {
-      LOG_0(TraceLevelError, "ERROR InitializeInteractionClassification countTargetClasses can't be zero unless there are no instances");
+      LOG_0(TraceLevelError, "ERROR InitializeInteractionClassificationStrided countTargetClasses can't be zero unless there are no instances");
       return nullptr;
    }
    if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
-      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionClassificationStrided !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
       return nullptr;
    }
    const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
    PEbmInteraction pEbmInteraction = reinterpret_cast<PEbmInteraction>(AllocateCoreInteraction(countFeatures, features, runtimeLearningTypeOrCountTargetClasses, countInstances, targets, binnedData, predictorScores));
+   LOG_N(TraceLevelInfo, "Exited InitializeInteractionClassificationStrided %p", static_cast<void *>(pEbmInteraction));
+   return pEbmInteraction;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionRegression(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeInteractionRegression: countFeatures=%" IntegerDataTypePrintf ", features=%p, countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores));
+   // our original interface takes IntegerDataType values in feature major order
+   const EbmCoreBinnedData binnedDataFeatureMajor = { BinnedDataTypeInt64, 1, countInstances, binnedData };
+   PEbmInteraction pEbmInteraction = InitializeInteractionRegressionStrided(countFeatures, features, countInstances, targets, &binnedDataFeatureMajor, predictorScores);
+   LOG_N(TraceLevelInfo, "Exited InitializeInteractionRegression %p", static_cast<void *>(pEbmInteraction));
+   return pEbmInteraction;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeInteractionClassification: countFeatures=%" IntegerDataTypePrintf ", features=%p, countTargetClasses=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countTargetClasses, countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores));
+   // our original interface takes IntegerDataType values in feature major order
+   const EbmCoreBinnedData binnedDataFeatureMajor = { BinnedDataTypeInt64, 1, countInstances, binnedData };
+   PEbmInteraction pEbmInteraction = InitializeInteractionClassificationStrided(countFeatures, features, countTargetClasses, countInstances, targets, &binnedDataFeatureMajor, predictorScores);
    LOG_N(TraceLevelInfo, "Exited InitializeInteractionClassification %p", static_cast<void *>(pEbmInteraction));
    return pEbmInteraction;
 }
 
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static IntegerDataType GetInteractionScorePerTargetClasses(EbmInteractionState * const pEbmInteractionState, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
-   // TODO : be smarter about our CachedInteractionThreadResources, otherwise why have it?
-   CachedInteractionThreadResources * const pCachedThreadResources = new (std::nothrow) CachedInteractionThreadResources();
+EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionFromDataSet(
+   PEbmDataSet ebmDataSet,
+   IntegerDataType countInstances,
+   const IntegerDataType * instanceIndexes,
+   const FractionalDataType * predictorScores
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeInteractionFromDataSet: ebmDataSet=%p, countInstances=%" IntegerDataTypePrintf ", instanceIndexes=%p, predictorScores=%p", static_cast<void *>(ebmDataSet), countInstances, static_cast<const void *>(instanceIndexes), static_cast<const void *>(predictorScores));
+
+   EbmDataSet * const pEbmDataSet = reinterpret_cast<EbmDataSet *>(ebmDataSet);
+   if(nullptr == pEbmDataSet) {
+      LOG_0(TraceLevelError, "ERROR InitializeInteractionFromDataSet nullptr == ebmDataSet");
+      return nullptr;
+   }
+   EBM_ASSERT(0 <= countInstances);
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionFromDataSet !IsNumberConvertable<size_t, IntegerDataType>(countInstances)");
+      return nullptr;
+   }
+   const size_t cInstances = static_cast<size_t>(countInstances);
+   if(pEbmDataSet->CheckInstanceIndexes(cInstances, instanceIndexes)) {
+      LOG_0(TraceLevelError, "ERROR InitializeInteractionFromDataSet instanceIndexes");
+      return nullptr;
+   }
+
+   // every instance in order can use the dataset's bit packed data as is.  A subset gets re-packed from it, which doesn't touch our caller's data
+   void * aTargetsGathered = nullptr;
+   if(nullptr != instanceIndexes && 0 != cInstances) {
+      aTargetsGathered = pEbmDataSet->GatherTargets(cInstances, instanceIndexes);
+      if(nullptr == aTargetsGathered) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeInteractionFromDataSet nullptr == aTargetsGathered");
+         return nullptr;
+      }
+   }
+   const FractionalDataType * aPredictorScores;
+   FractionalDataType * aPredictorScoresGathered;
+   if(pEbmDataSet->GetStartingPredictorScores(predictorScores, cInstances, instanceIndexes, &aPredictorScores, &aPredictorScoresGathered)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionFromDataSet GetStartingPredictorScores");
+      free(aTargetsGathered);
+      return nullptr;
+   }
+   BinnedDataView binnedDataView;
+   pEbmDataSet->InitializeBinnedDataView(&binnedDataView, instanceIndexes);
+
+   const size_t cThreads = 1;
+
+   LOG_0(TraceLevelInfo, "Entered EbmInteractionState");
+   EbmInteractionState * pEbmInteractionState = new (std::nothrow) EbmInteractionState(pEbmDataSet->m_runtimeLearningTypeOrCountTargetClasses, pEbmDataSet->m_cFeatures, cThreads);
+   LOG_N(TraceLevelInfo, "Exited EbmInteractionState %p", static_cast<void *>(pEbmInteractionState));
+   if(UNLIKELY(nullptr == pEbmInteractionState)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionFromDataSet nullptr == pEbmInteractionState");
+   } else if(UNLIKELY(pEbmInteractionState->InitializeInteraction(pEbmDataSet->m_aEbmCoreFeatures, cInstances, nullptr == aTargetsGathered ? pEbmDataSet->m_aTargets : aTargetsGathered, &binnedDataView, aPredictorScores, nullptr == instanceIndexes ? pEbmDataSet : nullptr))) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionFromDataSet pEbmInteractionState->InitializeInteraction");
+      delete pEbmInteractionState;
+      pEbmInteractionState = nullptr;
+   }
+   free(aPredictorScoresGathered);
+   free(aTargetsGathered);
+
+   const PEbmInteraction pEbmInteraction = reinterpret_cast<PEbmInteraction>(pEbmInteractionState);
+   LOG_N(TraceLevelInfo, "Exited InitializeInteractionFromDataSet %p", static_cast<void *>(pEbmInteraction));
+   return pEbmInteraction;
+}
 
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static IntegerDataType GetInteractionScorePerTargetClasses(EbmInteractionState * const pEbmInteractionState, CachedInteractionThreadResources * const pCachedThreadResources, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
    if(CalculateInteractionScore<compilerLearningTypeOrCountTargetClasses, 0>(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses, pCachedThreadResources, pEbmInteractionState->m_pDataSet, pFeatureCombination, pInteractionScoreReturn)) {
-      delete pCachedThreadResources;
       return 1;
    }
-   delete pCachedThreadResources;
    return 0;
 }
 
 template<ptrdiff_t possibleCompilerLearningTypeOrCountTargetClasses>
-EBM_INLINE IntegerDataType CompilerRecursiveGetInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmInteractionState * const pEbmInteractionState, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
+EBM_INLINE IntegerDataType CompilerRecursiveGetInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmInteractionState * const pEbmInteractionState, CachedInteractionThreadResources * const pCachedThreadResources, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
    static_assert(IsClassification(possibleCompilerLearningTypeOrCountTargetClasses), "possibleCompilerLearningTypeOrCountTargetClasses needs to be a classification");
    EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
    if(runtimeLearningTypeOrCountTargetClasses == possibleCompilerLearningTypeOrCountTargetClasses) {
       EBM_ASSERT(runtimeLearningTypeOrCountTargetClasses <= k_cCompilerOptimizedTargetClassesMax);
-      return GetInteractionScorePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmInteractionState, pFeatureCombination, pInteractionScoreReturn);
+      return GetInteractionScorePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmInteractionState, pCachedThreadResources, pFeatureCombination, pInteractionScoreReturn);
    } else {
-      return CompilerRecursiveGetInteractionScore<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmInteractionState, pFeatureCombination, pInteractionScoreReturn);
+      return CompilerRecursiveGetInteractionScore<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmInteractionState, pCachedThreadResources, pFeatureCombination, pInteractionScoreReturn);
    }
 }
 
 template<>
-EBM_INLINE IntegerDataType CompilerRecursiveGetInteractionScore<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmInteractionState * const pEbmInteractionState, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
+EBM_INLINE IntegerDataType CompilerRecursiveGetInteractionScore<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmInteractionState * const pEbmInteractionState, CachedInteractionThreadResources * const pCachedThreadResources, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
    UNUSED(runtimeLearningTypeOrCountTargetClasses);
    // it is logically possible, but uninteresting to have a classification with 1 target class, so let our runtime system handle those unlikley and uninteresting cases
    static_assert(IsClassification(k_cCompilerOptimizedTargetClassesMax), "k_cCompilerOptimizedTargetClassesMax needs to be a classification");
    EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
    EBM_ASSERT(k_cCompilerOptimizedTargetClassesMax < runtimeLearningTypeOrCountTargetClasses);
-   return GetInteractionScorePerTargetClasses<k_DynamicClassification>(pEbmInteractionState, pFeatureCombination, pInteractionScoreReturn);
+   return GetInteractionScorePerTargetClasses<k_DynamicClassification>(pEbmInteractionState, pCachedThreadResources, pFeatureCombination, pInteractionScoreReturn);
 }
 
-// we made this a global because if we had put this variable inside the EbmInteractionState object, then we would need to dereference that before getting the count.  By making this global we can send a log message incase a bad EbmInteractionState object is sent into us
-// we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more times than desired, but we can live with that
-static unsigned int g_cLogGetInteractionScoreParametersMessages = 10;
-
-EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScore(
-   PEbmInteraction ebmInteraction,
-   IntegerDataType countFeaturesInCombination,
-   const IntegerDataType * featureIndexes,
-   FractionalDataType * interactionScoreReturn
-) {
-   LOG_COUNTED_N(&g_cLogGetInteractionScoreParametersMessages, TraceLevelInfo, TraceLevelVerbose, "GetInteractionScore parameters: ebmInteraction=%p, countFeaturesInCombination=%" IntegerDataTypePrintf ", featureIndexes=%p, interactionScoreReturn=%p", static_cast<void *>(ebmInteraction), countFeaturesInCombination, static_cast<const void *>(featureIndexes), static_cast<void *>(interactionScoreReturn));
-
-   EBM_ASSERT(nullptr != ebmInteraction);
-   EbmInteractionState * pEbmInteractionState = reinterpret_cast<EbmInteractionState *>(ebmInteraction);
-
-   LOG_COUNTED_0(&pEbmInteractionState->m_cLogEnterMessages, TraceLevelInfo, TraceLevelVerbose, "Entered GetInteractionScore");
-
-   EBM_ASSERT(0 <= countFeaturesInCombination);
-   EBM_ASSERT(0 == countFeaturesInCombination || nullptr != featureIndexes);
-   // interactionScoreReturn can be nullptr
-
-   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
-      LOG_0(TraceLevelWarning, "WARNING GetInteractionScore !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
-      return 1;
-   }
-   size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
+// scores one feature combination using the histogram memory in pCachedThreadResources.  Any thread can call this at the same time as other threads
+// so long as each one passes in its own pCachedThreadResources, since nothing else that we touch here is written to
+static IntegerDataType GetInteractionScoreWithResources(EbmInteractionState * const pEbmInteractionState, CachedInteractionThreadResources * const pCachedThreadResources, const size_t cFeaturesInCombination, const IntegerDataType * const featureIndexes, FractionalDataType * const interactionScoreReturn) {
    if(0 == cFeaturesInCombination) {
       LOG_0(TraceLevelInfo, "INFO GetInteractionScore empty feature combination");
       if(nullptr != interactionScoreReturn) {
@@ -231,9 +312,8 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInterac
       ++pFeatureCombinationIndex;
    } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndex);
 
-   IntegerDataType ret;
    if(IsRegression(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses)) {
-      ret = GetInteractionScorePerTargetClasses<k_Regression>(pEbmInteractionState, pFeatureCombination, interactionScoreReturn);
+      return GetInteractionScorePerTargetClasses<k_Regression>(pEbmInteractionState, pCachedThreadResources, pFeatureCombination, interactionScoreReturn);
    } else {
       EBM_ASSERT(IsClassification(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses));
       if(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }) {
@@ -243,8 +323,37 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInterac
          }
          return 0;
       }
-      ret = CompilerRecursiveGetInteractionScore<2>(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses, pEbmInteractionState, pFeatureCombination, interactionScoreReturn);
+      return CompilerRecursiveGetInteractionScore<2>(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses, pEbmInteractionState, pCachedThreadResources, pFeatureCombination, interactionScoreReturn);
    }
+}
+
+// we made this a global because if we had put this variable inside the EbmInteractionState object, then we would need to dereference that before getting the count.  By making this global we can send a log message incase a bad EbmInteractionState object is sent into us
+// we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more times than desired, but we can live with that
+static unsigned int g_cLogGetInteractionScoreParametersMessages = 10;
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScore(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countFeaturesInCombination,
+   const IntegerDataType * featureIndexes,
+   FractionalDataType * interactionScoreReturn
+) {
+   LOG_COUNTED_N(&g_cLogGetInteractionScoreParametersMessages, TraceLevelInfo, TraceLevelVerbose, "GetInteractionScore parameters: ebmInteraction=%p, countFeaturesInCombination=%" IntegerDataTypePrintf ", featureIndexes=%p, interactionScoreReturn=%p", static_cast<void *>(ebmInteraction), countFeaturesInCombination, static_cast<const void *>(featureIndexes), static_cast<void *>(interactionScoreReturn));
+
+   EBM_ASSERT(nullptr != ebmInteraction);
+   EbmInteractionState * pEbmInteractionState = reinterpret_cast<EbmInteractionState *>(ebmInteraction);
+
+   LOG_COUNTED_0(&pEbmInteractionState->m_cLogEnterMessages, TraceLevelInfo, TraceLevelVerbose, "Entered GetInteractionScore");
+
+   EBM_ASSERT(0 <= countFeaturesInCombination);
+   EBM_ASSERT(0 == countFeaturesInCombination || nullptr != featureIndexes);
+   // interactionScoreReturn can be nullptr
+
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScore !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
+      return 1;
+   }
+   const size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
+   const IntegerDataType ret = GetInteractionScoreWithResources(pEbmInteractionState, pEbmInteractionState->m_pCachedThreadResources, cFeaturesInCombination, featureIndexes, interactionScoreReturn);
    if(0 != ret) {
       LOG_N(TraceLevelWarning, "WARNING GetInteractionScore returned %" IntegerDataTypePrintf, ret);
    }
@@ -257,6 +366,165 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInterac
    return ret;
 }
 
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScores(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countCombinations,
+   IntegerDataType countFeaturesInCombination,
+   const IntegerDataType * featureIndexes,
+   IntegerDataType countTopCombinations,
+   FractionalDataType * interactionScoresReturn,
+   IntegerDataType * topCombinationIndexesReturn
+) {
+   LOG_N(TraceLevelInfo, "Entered GetInteractionScores: ebmInteraction=%p, countCombinations=%" IntegerDataTypePrintf ", countFeaturesInCombination=%" IntegerDataTypePrintf ", featureIndexes=%p, countTopCombinations=%" IntegerDataTypePrintf ", interactionScoresReturn=%p, topCombinationIndexesReturn=%p", static_cast<void *>(ebmInteraction), countCombinations, countFeaturesInCombination, static_cast<const void *>(featureIndexes), countTopCombinations, static_cast<void *>(interactionScoresReturn), static_cast<void *>(topCombinationIndexesReturn));
+
+   EBM_ASSERT(nullptr != ebmInteraction);
+   EbmInteractionState * pEbmInteractionState = reinterpret_cast<EbmInteractionState *>(ebmInteraction);
+
+   if(countCombinations < 0) {
+      LOG_0(TraceLevelError, "ERROR GetInteractionScores countCombinations can't be negative");
+      return 1;
+   }
+   if(countFeaturesInCombination < 0) {
+      LOG_0(TraceLevelError, "ERROR GetInteractionScores countFeaturesInCombination can't be negative");
+      return 1;
+   }
+   if(countTopCombinations < 0) {
+      LOG_0(TraceLevelError, "ERROR GetInteractionScores countTopCombinations can't be negative");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScores !IsNumberConvertable<size_t, IntegerDataType>(countCombinations)");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScores !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countTopCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScores !IsNumberConvertable<size_t, IntegerDataType>(countTopCombinations)");
+      return 1;
+   }
+   const size_t cCombinations = static_cast<size_t>(countCombinations);
+   const size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
+   const size_t cTopCombinationsRequested = static_cast<size_t>(countTopCombinations);
+   if(0 == cCombinations) {
+      LOG_0(TraceLevelInfo, "Exited GetInteractionScores no combinations");
+      return 0;
+   }
+   if(IsMultiplyError(cCombinations, cFeaturesInCombination)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScores IsMultiplyError(cCombinations, cFeaturesInCombination)");
+      return 1;
+   }
+   if(0 != cFeaturesInCombination && nullptr == featureIndexes) {
+      LOG_0(TraceLevelError, "ERROR GetInteractionScores featureIndexes can't be null");
+      return 1;
+   }
+   if(nullptr == interactionScoresReturn) {
+      LOG_0(TraceLevelError, "ERROR GetInteractionScores interactionScoresReturn can't be null");
+      return 1;
+   }
+   if(0 != cTopCombinationsRequested && nullptr == topCombinationIndexesReturn) {
+      LOG_0(TraceLevelError, "ERROR GetInteractionScores topCombinationIndexesReturn can't be null when countTopCombinations is not zero");
+      return 1;
+   }
+
+   // without a top-K selection the scores go straight to our caller in the order of the combinations.  With one we need every score before we
+   // can pick the best, but our caller only has room for the best ones
+   FractionalDataType * aScores = interactionScoresReturn;
+   size_t * aCombinationIndexes = nullptr;
+   if(0 != cTopCombinationsRequested) {
+      if(IsMultiplyError(cCombinations, sizeof(*aScores)) || IsMultiplyError(cCombinations, sizeof(*aCombinationIndexes))) {
+         LOG_0(TraceLevelWarning, "WARNING GetInteractionScores IsMultiplyError(cCombinations, sizeof(*aScores))");
+         return 1;
+      }
+      aScores = static_cast<FractionalDataType *>(malloc(sizeof(*aScores) * cCombinations));
+      if(UNLIKELY(nullptr == aScores)) {
+         LOG_0(TraceLevelWarning, "WARNING GetInteractionScores nullptr == aScores");
+         return 1;
+      }
+      aCombinationIndexes = static_cast<size_t *>(malloc(sizeof(*aCombinationIndexes) * cCombinations));
+      if(UNLIKELY(nullptr == aCombinationIndexes)) {
+         LOG_0(TraceLevelWarning, "WARNING GetInteractionScores nullptr == aCombinationIndexes");
+         free(aScores);
+         return 1;
+      }
+   }
+
+   // each worker claims the next unscored combination until there are none left, which balances the load when some combinations have many more
+   // bins than others.  Every score is computed by exactly one worker into its own slot, so the scores don't depend on the number of threads
+   const size_t cWorkers = cCombinations < pEbmInteractionState->m_cThreads ? cCombinations : pEbmInteractionState->m_cThreads;
+   std::atomic<size_t> iCombinationNext(0);
+   std::atomic<bool> bError(false);
+   RunChunks(pEbmInteractionState->m_pThreadPool, cWorkers, cWorkers, [&](const size_t iWorker) {
+      CachedInteractionThreadResources * const pCachedThreadResources = pEbmInteractionState->GetCachedThreadResources(iWorker);
+      while(true) {
+         const size_t iCombination = iCombinationNext.fetch_add(1, std::memory_order_relaxed);
+         if(cCombinations <= iCombination) {
+            break;
+         }
+         if(0 != GetInteractionScoreWithResources(pEbmInteractionState, pCachedThreadResources, cFeaturesInCombination, &featureIndexes[iCombination * cFeaturesInCombination], &aScores[iCombination])) {
+            bError.store(true, std::memory_order_relaxed);
+         }
+      }
+   });
+
+   IntegerDataType ret = 0;
+   if(bError.load()) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScores GetInteractionScoreWithResources");
+      ret = 1;
+   } else if(0 != cTopCombinationsRequested) {
+      const size_t cTopCombinations = cCombinations < cTopCombinationsRequested ? cCombinations : cTopCombinationsRequested;
+      for(size_t iCombination = 0; iCombination < cCombinations; ++iCombination) {
+         aCombinationIndexes[iCombination] = iCombination;
+      }
+      // ties go to the combination that came first, so the selection is the same as a stable sort by descending score
+      std::partial_sort(aCombinationIndexes, aCombinationIndexes + cTopCombinations, aCombinationIndexes + cCombinations, [aScores](const size_t iLeft, const size_t iRight) {
+         return aScores[iRight] < aScores[iLeft] || (aScores[iRight] == aScores[iLeft] && iLeft < iRight);
+      });
+      for(size_t iTop = 0; iTop < cTopCombinations; ++iTop) {
+         const size_t iCombination = aCombinationIndexes[iTop];
+         interactionScoresReturn[iTop] = aScores[iCombination];
+         topCombinationIndexesReturn[iTop] = static_cast<IntegerDataType>(iCombination);
+      }
+   }
+
+   if(0 != cTopCombinationsRequested) {
+      free(aCombinationIndexes);
+      free(aScores);
+   }
+
+   LOG_N(TraceLevelInfo, "Exited GetInteractionScores %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetInteractionThreadCount(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countThreads
+) {
+   LOG_N(TraceLevelInfo, "Entered SetInteractionThreadCount: ebmInteraction=%p, countThreads=%" IntegerDataTypePrintf, static_cast<void *>(ebmInteraction), countThreads);
+
+   EbmInteractionState * pEbmInteractionState = reinterpret_cast<EbmInteractionState *>(ebmInteraction);
+   EBM_ASSERT(nullptr != pEbmInteractionState);
+
+   if(countThreads < 0) {
+      LOG_0(TraceLevelError, "ERROR SetInteractionThreadCount countThreads can't be negative");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING SetInteractionThreadCount !IsNumberConvertable<size_t, IntegerDataType>(countThreads)");
+      return 1;
+   }
+   // zero means use every hardware thread, which is also what we do if our caller never calls us
+   const size_t cThreads = 0 == countThreads ? ThreadPool::GetCountHardwareThreads() : static_cast<size_t>(countThreads);
+   if(pEbmInteractionState->SetCountThreads(cThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING SetInteractionThreadCount pEbmInteractionState->SetCountThreads(cThreads)");
+      return 1;
+   }
+
+   LOG_N(TraceLevelInfo, "Exited SetInteractionThreadCount %zu threads", pEbmInteractionState->m_cThreads);
+   return 0;
+}
+
 EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeInteraction(
    PEbmInteraction ebmInteraction
 ) {
@@ -0,0 +1,256 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint32_t, uint64_t
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER)
+#include <intrin.h> // __cpuidex, _xgetbv
+#else // defined(_MSC_VER)
+#include <cpuid.h> // __cpuid_count
+#endif // defined(_MSC_VER)
+#endif // defined(__x86_64__) || defined(_M_X64)
+
+#include "ebmcore.h" // FractionalDataType
+#include "ebmcore_test_hooks.h" // SetInstructionSet
+#include "EbmInternal.h" // StorageDataTypeCore
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "EbmStatistics.h"
+#include "IsaKernels.h"
+#include "VectorMath.h"
+
+static void ComputeClassificationResidualErrorBinaryclassScalar(const size_t cInstances, const StorageFractionalDataTypeCore * const aTrainingLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues, StorageFractionalDataTypeCore * const aResidualErrors) {
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      aResidualErrors[iInstance] = static_cast<StorageFractionalDataTypeCore>(EbmStatistics::ComputeClassificationResidualErrorBinaryclass(static_cast<FractionalDataType>(aTrainingLogOddsPredictions[iInstance]), aBinnedActualValues[iInstance]));
+   }
+}
+
+static FractionalDataType ComputeClassificationLogLossBinaryclassScalar(const size_t cInstances, const StorageFractionalDataTypeCore * const aValidationLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues) {
+   FractionalDataType sumLogLoss = 0;
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      sumLogLoss += EbmStatistics::ComputeClassificationSingleInstanceLogLossBinaryclass(static_cast<FractionalDataType>(aValidationLogOddsPredictions[iInstance]), aBinnedActualValues[iInstance]);
+   }
+   return sumLogLoss;
+}
+
+static size_t FindBestSplitPointScalar(const size_t cSplitPoints, const FractionalDataType cInstancesParent, const FractionalDataType * const aCountsLeft, const FractionalDataType * const aSumResidualErrorsLeft, const FractionalDataType * const aSumResidualErrorsRight, FractionalDataType * const pBestNodeSplittingScore) {
+   EBM_ASSERT(1 <= cSplitPoints);
+   size_t iBest = 0;
+   FractionalDataType bestNodeSplittingScore = 0;
+   for(size_t iSplitPoint = 0; iSplitPoint < cSplitPoints; ++iSplitPoint) {
+      const FractionalDataType sumResidualErrorLeft = aSumResidualErrorsLeft[iSplitPoint];
+      const FractionalDataType sumResidualErrorRight = aSumResidualErrorsRight[iSplitPoint];
+      const FractionalDataType nodeSplittingScore = sumResidualErrorLeft / aCountsLeft[iSplitPoint] * sumResidualErrorLeft + sumResidualErrorRight / (cInstancesParent - aCountsLeft[iSplitPoint]) * sumResidualErrorRight;
+      if(0 == iSplitPoint || bestNodeSplittingScore < nodeSplittingScore) {
+         bestNodeSplittingScore = nodeSplittingScore;
+         iBest = iSplitPoint;
+      }
+   }
+   *pBestNodeSplittingScore = bestNodeSplittingScore;
+   return iBest;
+}
+
+static void AddGatheredScalar(const size_t cInstances, const FractionalDataType * const aModel, const size_t * const aiTensor, FractionalDataType * const aLogits) {
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      aLogits[iInstance] += aModel[aiTensor[iInstance]];
+   }
+}
+
+template<bool bClassification>
+static void BinInstancesScalar(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const StorageDataTypeCore * const aInputData, const StorageCountOccurrencesCore * const aCountOccurrences, const StorageFractionalDataTypeCore * const aResidualErrors, const StorageFractionalDataTypeCore * const aDenominators, HistogramBucket<bClassification> * const aHistogramBuckets) {
+   HistogramMath::BinInstances<VectorScalar, bClassification>(cInstances, cItemsPerBitPackDataUnit, aInputData, aCountOccurrences, aResidualErrors, aDenominators, aHistogramBuckets);
+}
+
+template<bool bClassification>
+static void BuildFastTotalsScalar(HistogramBucket<bClassification> * const aHistogramBuckets, const size_t cDimensions, const size_t * const acBins, HistogramBucket<bClassification> * const aAuxiliaryBuckets) {
+   HistogramMath::BuildFastTotals<VectorScalar, bClassification>(aHistogramBuckets, cDimensions, acBins, aAuxiliaryBuckets);
+}
+
+// the portable kernels, which we use wherever we can't generate vector code, and which tests can compare the vector kernels against
+static const IsaKernels k_isaKernelsScalar = {
+   "scalar",
+   &ComputeClassificationResidualErrorBinaryclassScalar,
+   &ComputeClassificationLogLossBinaryclassScalar,
+   &FindBestSplitPointScalar,
+   &AddGatheredScalar,
+   &BinInstancesScalar<false>,
+   &BinInstancesScalar<true>,
+   &BuildFastTotalsScalar<false>,
+   &BuildFastTotalsScalar<true>
+};
+
+// the values of SetInstructionSet, in order of the instructions that they need
+constexpr IntegerDataType k_instructionSetBest = -1;
+constexpr IntegerDataType k_instructionSetScalar = 0;
+constexpr IntegerDataType k_instructionSetSse2 = 1;
+constexpr IntegerDataType k_instructionSetAvx2 = 2;
+constexpr IntegerDataType k_instructionSetAvx512 = 3;
+
+#ifdef EBM_VECTOR_SSE2
+
+static void ComputeClassificationResidualErrorBinaryclassSse2(const size_t cInstances, const StorageFractionalDataTypeCore * const aTrainingLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues, StorageFractionalDataTypeCore * const aResidualErrors) {
+   VectorMath::ComputeClassificationResidualErrorBinaryclass<VectorSse2>(cInstances, aTrainingLogOddsPredictions, aBinnedActualValues, aResidualErrors);
+}
+
+static FractionalDataType ComputeClassificationLogLossBinaryclassSse2(const size_t cInstances, const StorageFractionalDataTypeCore * const aValidationLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues) {
+   return VectorMath::ComputeClassificationLogLossBinaryclass<VectorSse2>(cInstances, aValidationLogOddsPredictions, aBinnedActualValues);
+}
+
+static size_t FindBestSplitPointSse2(const size_t cSplitPoints, const FractionalDataType cInstancesParent, const FractionalDataType * const aCountsLeft, const FractionalDataType * const aSumResidualErrorsLeft, const FractionalDataType * const aSumResidualErrorsRight, FractionalDataType * const pBestNodeSplittingScore) {
+   return VectorMath::FindBestSplitPoint<VectorSse2>(cSplitPoints, cInstancesParent, aCountsLeft, aSumResidualErrorsLeft, aSumResidualErrorsRight, pBestNodeSplittingScore);
+}
+
+static void AddGatheredSse2(const size_t cInstances, const FractionalDataType * const aModel, const size_t * const aiTensor, FractionalDataType * const aLogits) {
+   VectorMath::AddGathered<VectorSse2>(cInstances, aModel, aiTensor, aLogits);
+}
+
+template<bool bClassification>
+static void BinInstancesSse2(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const StorageDataTypeCore * const aInputData, const StorageCountOccurrencesCore * const aCountOccurrences, const StorageFractionalDataTypeCore * const aResidualErrors, const StorageFractionalDataTypeCore * const aDenominators, HistogramBucket<bClassification> * const aHistogramBuckets) {
+   HistogramMath::BinInstances<VectorSse2, bClassification>(cInstances, cItemsPerBitPackDataUnit, aInputData, aCountOccurrences, aResidualErrors, aDenominators, aHistogramBuckets);
+}
+
+template<bool bClassification>
+static void BuildFastTotalsSse2(HistogramBucket<bClassification> * const aHistogramBuckets, const size_t cDimensions, const size_t * const acBins, HistogramBucket<bClassification> * const aAuxiliaryBuckets) {
+   HistogramMath::BuildFastTotals<VectorSse2, bClassification>(aHistogramBuckets, cDimensions, acBins, aAuxiliaryBuckets);
+}
+
+static const IsaKernels k_isaKernelsSse2 = {
+   "SSE2",
+   &ComputeClassificationResidualErrorBinaryclassSse2,
+   &ComputeClassificationLogLossBinaryclassSse2,
+   &FindBestSplitPointSse2,
+   &AddGatheredSse2,
+   &BinInstancesSse2<false>,
+   &BinInstancesSse2<true>,
+   &BuildFastTotalsSse2<false>,
+   &BuildFastTotalsSse2<true>
+};
+
+const IsaKernels * GetIsaKernelsSse2() {
+   return &k_isaKernelsSse2;
+}
+
+static void Cpuid(const uint32_t leaf, uint32_t * const aRegisters) {
+#if defined(_MSC_VER)
+   int aRegistersInt[4];
+   __cpuidex(aRegistersInt, static_cast<int>(leaf), 0);
+   for(size_t iRegister = 0; iRegister < 4; ++iRegister) {
+      aRegisters[iRegister] = static_cast<uint32_t>(aRegistersInt[iRegister]);
+   }
+#else // defined(_MSC_VER)
+   unsigned int eax;
+   unsigned int ebx;
+   unsigned int ecx;
+   unsigned int edx;
+   __cpuid_count(leaf, 0, eax, ebx, ecx, edx);
+   aRegisters[0] = eax;
+   aRegisters[1] = ebx;
+   aRegisters[2] = ecx;
+   aRegisters[3] = edx;
+#endif // defined(_MSC_VER)
+}
+
+// the register state that the operating system saves on a context switch.  Only call this if cpuid reports OSXSAVE
+static uint64_t GetEnabledRegisterState() {
+#if defined(_MSC_VER)
+   return static_cast<uint64_t>(_xgetbv(0));
+#else // defined(_MSC_VER)
+   uint32_t eax;
+   uint32_t edx;
+   // the xgetbv mnemonic needs -mxsave, so we use the opcode instead
+   __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+   return (static_cast<uint64_t>(edx) << 32) | static_cast<uint64_t>(eax);
+#endif // defined(_MSC_VER)
+}
+
+static IntegerDataType GetInstructionSetBest() {
+   // the processor needs to support the instructions AND the operating system needs to save the wider registers when it switches threads
+   uint32_t aRegisters[4];
+   Cpuid(0, aRegisters);
+   const uint32_t leafMax = aRegisters[0];
+   if(7 <= leafMax) {
+      Cpuid(1, aRegisters);
+      constexpr uint32_t k_osxsaveBit = uint32_t { 1 } << 27;
+      constexpr uint32_t k_avxBit = uint32_t { 1 } << 28;
+      if(k_osxsaveBit == (k_osxsaveBit & aRegisters[2]) && k_avxBit == (k_avxBit & aRegisters[2])) {
+         const uint64_t enabledRegisterState = GetEnabledRegisterState();
+         // XMM and YMM state
+         constexpr uint64_t k_avxState = uint64_t { 0x06 };
+         // opmask, upper ZMM0-15 and ZMM16-31 state in addition to the AVX state
+         constexpr uint64_t k_avx512State = uint64_t { 0xE6 };
+
+         Cpuid(7, aRegisters);
+         constexpr uint32_t k_avx2Bit = uint32_t { 1 } << 5;
+         constexpr uint32_t k_avx512fBit = uint32_t { 1 } << 16;
+         // the compiler treats AVX-512F as a superset of AVX2, so the AVX-512 kernels can contain AVX2 instructions too
+         if(k_avx2Bit == (k_avx2Bit & aRegisters[1]) && k_avxState == (k_avxState & enabledRegisterState)) {
+            if(k_avx512fBit == (k_avx512fBit & aRegisters[1]) && k_avx512State == (k_avx512State & enabledRegisterState) && nullptr != GetIsaKernelsAvx512()) {
+               return k_instructionSetAvx512;
+            }
+            if(nullptr != GetIsaKernelsAvx2()) {
+               return k_instructionSetAvx2;
+            }
+         }
+      }
+   }
+   return k_instructionSetSse2;
+}
+
+
+#else // EBM_VECTOR_SSE2
+
+const IsaKernels * GetIsaKernelsSse2() {
+   return nullptr;
+}
+
+static IntegerDataType GetInstructionSetBest() {
+   return k_instructionSetScalar;
+}
+
+#endif // EBM_VECTOR_SSE2
+
+static const IsaKernels * GetIsaKernels(const IntegerDataType instructionSet) {
+   switch(instructionSet) {
+   case k_instructionSetScalar:
+      return &k_isaKernelsScalar;
+   case k_instructionSetSse2:
+      return GetIsaKernelsSse2();
+   case k_instructionSetAvx2:
+      return GetIsaKernelsAvx2();
+   case k_instructionSetAvx512:
+      return GetIsaKernelsAvx512();
+   default:
+      return nullptr;
+   }
+}
+
+static const IntegerDataType g_instructionSetBest = GetInstructionSetBest();
+
+// this is initialized when the library is loaded, before any of our exported functions can be called
+#ifdef EBM_TEST_HOOKS
+const IsaKernels * g_pIsaKernels = GetIsaKernels(g_instructionSetBest);
+#else // EBM_TEST_HOOKS
+const IsaKernels * const g_pIsaKernels = GetIsaKernels(g_instructionSetBest);
+#endif // EBM_TEST_HOOKS
+
+#ifdef EBM_TEST_HOOKS
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetInstructionSet(IntegerDataType instructionSet) {
+   LOG_N(TraceLevelInfo, "Entered SetInstructionSet: instructionSet=%" IntegerDataTypePrintf, instructionSet);
+   if(k_instructionSetBest == instructionSet) {
+      instructionSet = g_instructionSetBest;
+   }
+   // the processor can run every instruction set below the best one that it supports
+   const IsaKernels * const pIsaKernels = instructionSet < k_instructionSetScalar || g_instructionSetBest < instructionSet ? nullptr : GetIsaKernels(instructionSet);
+   if(nullptr == pIsaKernels) {
+      LOG_0(TraceLevelWarning, "WARNING SetInstructionSet this build or processor can't run that instruction set");
+      return 1;
+   }
+   g_pIsaKernels = pIsaKernels;
+   LOG_N(TraceLevelInfo, "Exited SetInstructionSet using the %s kernels", pIsaKernels->m_sInstructionSet);
+   return 0;
+}
+#endif // EBM_TEST_HOOKS
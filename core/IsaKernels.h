@@ -0,0 +1,60 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef ISA_KERNELS_H
+#define ISA_KERNELS_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "ebmcore.h" // FractionalDataType
+#include "EbmInternal.h" // StorageDataTypeCore
+#include "SamplingWithReplacement.h" // StorageCountOccurrencesCore
+
+template<bool bClassification>
+class HistogramBucket;
+
+// The kernels that we compile for more than one instruction set.  The library is built for a baseline processor, and each IsaKernels translation unit
+// compiles the same kernels for a wider instruction set, so a single shared library can use AVX2 or AVX-512 wherever the processor has them.  The
+// best table that the processor supports is picked once with cpuid when the library is loaded, and the hot loops call through g_pIsaKernels.
+struct IsaKernels final {
+   const char * m_sInstructionSet;
+   void (* m_pComputeClassificationResidualErrorBinaryclass)(const size_t cInstances, const StorageFractionalDataTypeCore * const aTrainingLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues, StorageFractionalDataTypeCore * const aResidualErrors);
+   FractionalDataType (* m_pComputeClassificationLogLossBinaryclass)(const size_t cInstances, const StorageFractionalDataTypeCore * const aValidationLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues);
+   size_t (* m_pFindBestSplitPoint)(const size_t cSplitPoints, const FractionalDataType cInstancesParent, const FractionalDataType * const aCountsLeft, const FractionalDataType * const aSumResidualErrorsLeft, const FractionalDataType * const aSumResidualErrorsRight, FractionalDataType * const pBestNodeSplittingScore);
+   // adds aModel[aiTensor[iInstance]] to aLogits[iInstance] for each instance, which is how a single score term is added to a block of instances
+   void (* m_pAddGathered)(const size_t cInstances, const FractionalDataType * const aModel, const size_t * const aiTensor, FractionalDataType * const aLogits);
+   // the histogram kernels only handle regression and binary classification, where each bucket has a single score.  Multiclass uses the templated versions
+   void (* m_pBinInstancesRegression)(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const StorageDataTypeCore * const aInputData, const StorageCountOccurrencesCore * const aCountOccurrences, const StorageFractionalDataTypeCore * const aResidualErrors, const StorageFractionalDataTypeCore * const aDenominators, HistogramBucket<false> * const aHistogramBuckets);
+   void (* m_pBinInstancesBinaryclass)(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const StorageDataTypeCore * const aInputData, const StorageCountOccurrencesCore * const aCountOccurrences, const StorageFractionalDataTypeCore * const aResidualErrors, const StorageFractionalDataTypeCore * const aDenominators, HistogramBucket<true> * const aHistogramBuckets);
+   void (* m_pBuildFastTotalsRegression)(HistogramBucket<false> * const aHistogramBuckets, const size_t cDimensions, const size_t * const acBins, HistogramBucket<false> * const aAuxiliaryBuckets);
+   void (* m_pBuildFastTotalsBinaryclass)(HistogramBucket<true> * const aHistogramBuckets, const size_t cDimensions, const size_t * const acBins, HistogramBucket<true> * const aAuxiliaryBuckets);
+};
+
+// each of these returns nullptr if this build can't generate code for that instruction set, for instance when we aren't compiling for x64
+extern const IsaKernels * GetIsaKernelsSse2();
+extern const IsaKernels * GetIsaKernelsAvx2();
+extern const IsaKernels * GetIsaKernelsAvx512();
+
+#ifdef EBM_TEST_HOOKS
+// this only changes when a test calls SetInstructionSet, which it does while nothing else is running
+extern const IsaKernels * g_pIsaKernels;
+#else // EBM_TEST_HOOKS
+extern const IsaKernels * const g_pIsaKernels;
+#endif // EBM_TEST_HOOKS
+
+// the bucket type picks the table entry, so the templated binning and totals code can call these for either learning type
+EBM_INLINE void BinInstancesSingleScore(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const StorageDataTypeCore * const aInputData, const StorageCountOccurrencesCore * const aCountOccurrences, const StorageFractionalDataTypeCore * const aResidualErrors, const StorageFractionalDataTypeCore * const aDenominators, HistogramBucket<false> * const aHistogramBuckets) {
+   (*g_pIsaKernels->m_pBinInstancesRegression)(cInstances, cItemsPerBitPackDataUnit, aInputData, aCountOccurrences, aResidualErrors, aDenominators, aHistogramBuckets);
+}
+EBM_INLINE void BinInstancesSingleScore(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const StorageDataTypeCore * const aInputData, const StorageCountOccurrencesCore * const aCountOccurrences, const StorageFractionalDataTypeCore * const aResidualErrors, const StorageFractionalDataTypeCore * const aDenominators, HistogramBucket<true> * const aHistogramBuckets) {
+   (*g_pIsaKernels->m_pBinInstancesBinaryclass)(cInstances, cItemsPerBitPackDataUnit, aInputData, aCountOccurrences, aResidualErrors, aDenominators, aHistogramBuckets);
+}
+EBM_INLINE void BuildFastTotalsSingleScore(HistogramBucket<false> * const aHistogramBuckets, const size_t cDimensions, const size_t * const acBins, HistogramBucket<false> * const aAuxiliaryBuckets) {
+   (*g_pIsaKernels->m_pBuildFastTotalsRegression)(aHistogramBuckets, cDimensions, acBins, aAuxiliaryBuckets);
+}
+EBM_INLINE void BuildFastTotalsSingleScore(HistogramBucket<true> * const aHistogramBuckets, const size_t cDimensions, const size_t * const acBins, HistogramBucket<true> * const aAuxiliaryBuckets) {
+   (*g_pIsaKernels->m_pBuildFastTotalsBinaryclass)(aHistogramBuckets, cDimensions, acBins, aAuxiliaryBuckets);
+}
+
+#endif // ISA_KERNELS_H
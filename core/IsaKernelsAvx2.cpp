@@ -0,0 +1,95 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+// everything that this file shares with the rest of the library needs to be included before we switch the instruction set below
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::is_same
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2
+#include <immintrin.h> // AVX2 & AVX-512
+#endif // defined(__x86_64__) || defined(_M_X64)
+
+#include "ebmcore.h" // FractionalDataType
+#include "EbmInternal.h" // StorageDataTypeCore
+#include "EbmStatistics.h"
+#include "SamplingWithReplacement.h" // StorageCountOccurrencesCore
+#include "HistogramBucket.h"
+#include "IsaKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+// Only the functions below are compiled for AVX2, and nothing calls them until cpuid has confirmed that the processor supports AVX2.  MSVC doesn't
+// need this since it will emit any intrinsic regardless of the /arch setting
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+// these targets include FMA, and g++ would otherwise fuse our separate multiplies and adds, which would make the results depend on the instruction set
+#pragma GCC optimize("fp-contract=off")
+#endif // compiler
+
+#define EBM_VECTOR_TARGET_AVX2
+#include "VectorMath.h"
+
+static void ComputeClassificationResidualErrorBinaryclassAvx2(const size_t cInstances, const StorageFractionalDataTypeCore * const aTrainingLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues, StorageFractionalDataTypeCore * const aResidualErrors) {
+   VectorMath::ComputeClassificationResidualErrorBinaryclass<VectorAvx2>(cInstances, aTrainingLogOddsPredictions, aBinnedActualValues, aResidualErrors);
+}
+
+static FractionalDataType ComputeClassificationLogLossBinaryclassAvx2(const size_t cInstances, const StorageFractionalDataTypeCore * const aValidationLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues) {
+   return VectorMath::ComputeClassificationLogLossBinaryclass<VectorAvx2>(cInstances, aValidationLogOddsPredictions, aBinnedActualValues);
+}
+
+static size_t FindBestSplitPointAvx2(const size_t cSplitPoints, const FractionalDataType cInstancesParent, const FractionalDataType * const aCountsLeft, const FractionalDataType * const aSumResidualErrorsLeft, const FractionalDataType * const aSumResidualErrorsRight, FractionalDataType * const pBestNodeSplittingScore) {
+   return VectorMath::FindBestSplitPoint<VectorAvx2>(cSplitPoints, cInstancesParent, aCountsLeft, aSumResidualErrorsLeft, aSumResidualErrorsRight, pBestNodeSplittingScore);
+}
+
+static void AddGatheredAvx2(const size_t cInstances, const FractionalDataType * const aModel, const size_t * const aiTensor, FractionalDataType * const aLogits) {
+   VectorMath::AddGathered<VectorAvx2>(cInstances, aModel, aiTensor, aLogits);
+}
+
+template<bool bClassification>
+static void BinInstancesAvx2(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const StorageDataTypeCore * const aInputData, const StorageCountOccurrencesCore * const aCountOccurrences, const StorageFractionalDataTypeCore * const aResidualErrors, const StorageFractionalDataTypeCore * const aDenominators, HistogramBucket<bClassification> * const aHistogramBuckets) {
+   HistogramMath::BinInstances<VectorAvx2, bClassification>(cInstances, cItemsPerBitPackDataUnit, aInputData, aCountOccurrences, aResidualErrors, aDenominators, aHistogramBuckets);
+}
+
+template<bool bClassification>
+static void BuildFastTotalsAvx2(HistogramBucket<bClassification> * const aHistogramBuckets, const size_t cDimensions, const size_t * const acBins, HistogramBucket<bClassification> * const aAuxiliaryBuckets) {
+   HistogramMath::BuildFastTotals<VectorAvx2, bClassification>(aHistogramBuckets, cDimensions, acBins, aAuxiliaryBuckets);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif // compiler
+
+static const IsaKernels k_isaKernelsAvx2 = {
+   "AVX2",
+   &ComputeClassificationResidualErrorBinaryclassAvx2,
+   &ComputeClassificationLogLossBinaryclassAvx2,
+   &FindBestSplitPointAvx2,
+   &AddGatheredAvx2,
+   &BinInstancesAvx2<false>,
+   &BinInstancesAvx2<true>,
+   &BuildFastTotalsAvx2<false>,
+   &BuildFastTotalsAvx2<true>
+};
+
+const IsaKernels * GetIsaKernelsAvx2() {
+   return &k_isaKernelsAvx2;
+}
+
+#else // defined(__x86_64__) || defined(_M_X64)
+
+const IsaKernels * GetIsaKernelsAvx2() {
+   return nullptr;
+}
+
+#endif // defined(__x86_64__) || defined(_M_X64)
@@ -0,0 +1,95 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+// everything that this file shares with the rest of the library needs to be included before we switch the instruction set below
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::is_same
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2
+#include <immintrin.h> // AVX2 & AVX-512
+#endif // defined(__x86_64__) || defined(_M_X64)
+
+#include "ebmcore.h" // FractionalDataType
+#include "EbmInternal.h" // StorageDataTypeCore
+#include "EbmStatistics.h"
+#include "SamplingWithReplacement.h" // StorageCountOccurrencesCore
+#include "HistogramBucket.h"
+#include "IsaKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+// Only the functions below are compiled for AVX-512, and nothing calls them until cpuid has confirmed that the processor supports AVX-512.  MSVC doesn't
+// need this since it will emit any intrinsic regardless of the /arch setting
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+// these targets include FMA, and g++ would otherwise fuse our separate multiplies and adds, which would make the results depend on the instruction set
+#pragma GCC optimize("fp-contract=off")
+#endif // compiler
+
+#define EBM_VECTOR_TARGET_AVX512
+#include "VectorMath.h"
+
+static void ComputeClassificationResidualErrorBinaryclassAvx512(const size_t cInstances, const StorageFractionalDataTypeCore * const aTrainingLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues, StorageFractionalDataTypeCore * const aResidualErrors) {
+   VectorMath::ComputeClassificationResidualErrorBinaryclass<VectorAvx512>(cInstances, aTrainingLogOddsPredictions, aBinnedActualValues, aResidualErrors);
+}
+
+static FractionalDataType ComputeClassificationLogLossBinaryclassAvx512(const size_t cInstances, const StorageFractionalDataTypeCore * const aValidationLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues) {
+   return VectorMath::ComputeClassificationLogLossBinaryclass<VectorAvx512>(cInstances, aValidationLogOddsPredictions, aBinnedActualValues);
+}
+
+static size_t FindBestSplitPointAvx512(const size_t cSplitPoints, const FractionalDataType cInstancesParent, const FractionalDataType * const aCountsLeft, const FractionalDataType * const aSumResidualErrorsLeft, const FractionalDataType * const aSumResidualErrorsRight, FractionalDataType * const pBestNodeSplittingScore) {
+   return VectorMath::FindBestSplitPoint<VectorAvx512>(cSplitPoints, cInstancesParent, aCountsLeft, aSumResidualErrorsLeft, aSumResidualErrorsRight, pBestNodeSplittingScore);
+}
+
+static void AddGatheredAvx512(const size_t cInstances, const FractionalDataType * const aModel, const size_t * const aiTensor, FractionalDataType * const aLogits) {
+   VectorMath::AddGathered<VectorAvx512>(cInstances, aModel, aiTensor, aLogits);
+}
+
+template<bool bClassification>
+static void BinInstancesAvx512(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const StorageDataTypeCore * const aInputData, const StorageCountOccurrencesCore * const aCountOccurrences, const StorageFractionalDataTypeCore * const aResidualErrors, const StorageFractionalDataTypeCore * const aDenominators, HistogramBucket<bClassification> * const aHistogramBuckets) {
+   HistogramMath::BinInstances<VectorAvx512, bClassification>(cInstances, cItemsPerBitPackDataUnit, aInputData, aCountOccurrences, aResidualErrors, aDenominators, aHistogramBuckets);
+}
+
+template<bool bClassification>
+static void BuildFastTotalsAvx512(HistogramBucket<bClassification> * const aHistogramBuckets, const size_t cDimensions, const size_t * const acBins, HistogramBucket<bClassification> * const aAuxiliaryBuckets) {
+   HistogramMath::BuildFastTotals<VectorAvx512, bClassification>(aHistogramBuckets, cDimensions, acBins, aAuxiliaryBuckets);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif // compiler
+
+static const IsaKernels k_isaKernelsAvx512 = {
+   "AVX-512",
+   &ComputeClassificationResidualErrorBinaryclassAvx512,
+   &ComputeClassificationLogLossBinaryclassAvx512,
+   &FindBestSplitPointAvx512,
+   &AddGatheredAvx512,
+   &BinInstancesAvx512<false>,
+   &BinInstancesAvx512<true>,
+   &BuildFastTotalsAvx512<false>,
+   &BuildFastTotalsAvx512<true>
+};
+
+const IsaKernels * GetIsaKernelsAvx512() {
+   return &k_isaKernelsAvx512;
+}
+
+#else // defined(__x86_64__) || defined(_M_X64)
+
+const IsaKernels * GetIsaKernelsAvx512() {
+   return nullptr;
+}
+
+#endif // defined(__x86_64__) || defined(_M_X64)
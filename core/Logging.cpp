@@ -7,8 +7,11 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <atomic>
 
 #include "ebmcore.h" // FractionalDataType
+#include "ebmcore_test_hooks.h" // GetHeapAllocationCount
 #include "EbmInternal.h" // FeatureTypeCore
 #include "Logging.h"
 
@@ -31,6 +34,23 @@ EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION SetTraceLevel(signed
    g_traceLevel = traceLevel;
 }
 
+#ifdef EBM_TEST_HOOKS
+
+#ifdef EBM_COUNT_HEAP_ALLOCATIONS
+// incremented by the allocation wrappers in wrap_func.cpp.  std::atomic<size_t> is constant initialized, so it's ready before any static constructor allocates
+std::atomic<size_t> g_cHeapAllocations(0);
+#endif // EBM_COUNT_HEAP_ALLOCATIONS
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetHeapAllocationCount() {
+#ifdef EBM_COUNT_HEAP_ALLOCATIONS
+   return static_cast<IntegerDataType>(g_cHeapAllocations.load(std::memory_order_relaxed));
+#else // EBM_COUNT_HEAP_ALLOCATIONS
+   return IntegerDataType { -1 };
+#endif // EBM_COUNT_HEAP_ALLOCATIONS
+}
+
+#endif // EBM_TEST_HOOKS
+
 WARNING_PUSH
 WARNING_DISABLE_NON_LITERAL_PRINTF_STRING
 extern void InteralLogWithArguments(signed char traceLevel, const char * const pOriginalMessage, ...) {
@@ -0,0 +1,63 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef PARALLEL_CHUNKS_H
+#define PARALLEL_CHUNKS_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "ThreadPool.h"
+
+// Splits cInstances into contiguous chunks of at least cInstancesPerChunkMin instances, and at most cChunksMax chunks.  Every chunk except the last
+// starts on a bit packed data unit boundary.  The layout depends only on the arguments, and never on the number of threads, so anything that is
+// reduced per chunk and then combined in chunk order is reproducible regardless of how many threads processed the chunks.
+EBM_INLINE size_t GetCountChunks(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const size_t cInstancesPerChunkMin, const size_t cChunksMax, size_t * const pcInstancesPerChunk) {
+   EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(1 <= cItemsPerBitPackDataUnit);
+   EBM_ASSERT(1 <= cChunksMax);
+   EBM_ASSERT(nullptr != pcInstancesPerChunk);
+   // rounding the chunk size up to a bit packed data unit boundary can only shrink the last chunk.  If the minimum chunk is long enough
+   // then the last chunk can't be emptied by the rounding
+   EBM_ASSERT(cChunksMax * cItemsPerBitPackDataUnit <= cInstancesPerChunkMin);
+
+   *pcInstancesPerChunk = cInstances;
+   size_t cChunks = cInstances / cInstancesPerChunkMin;
+   cChunks = cChunksMax < cChunks ? cChunksMax : cChunks;
+   if(cChunks <= size_t { 1 }) {
+      return size_t { 1 };
+   }
+   size_t cInstancesPerChunk = (cInstances + cChunks - 1) / cChunks;
+   cInstancesPerChunk = (cInstancesPerChunk + cItemsPerBitPackDataUnit - 1) / cItemsPerBitPackDataUnit * cItemsPerBitPackDataUnit;
+   cChunks = (cInstances + cInstancesPerChunk - 1) / cInstancesPerChunk;
+   EBM_ASSERT(2 <= cChunks);
+   EBM_ASSERT((cChunks - 1) * cInstancesPerChunk < cInstances);
+   *pcInstancesPerChunk = cInstancesPerChunk;
+   return cChunks;
+}
+
+template<typename TChunkFunction>
+static void RunChunkTrampoline(const void * pChunkData, const size_t iChunk) {
+   (*static_cast<const TChunkFunction *>(pChunkData))(iChunk);
+}
+
+// calls chunkFunction(iChunk) once for every chunk using up to cThreads threads from pThreadPool, including the calling thread.  Each chunk is processed
+// exactly once, but in no particular order and on no particular thread, so chunkFunction must only write to memory that belongs to its chunk.  chunkFunction
+// must not throw.  Failing to get help from the pool is not an error since the calling thread picks up whatever chunks the pool threads would have taken.
+template<typename TChunkFunction>
+void RunChunks(ThreadPool * const pThreadPool, const size_t cThreads, const size_t cChunks, const TChunkFunction & chunkFunction) {
+   EBM_ASSERT(1 <= cThreads);
+   EBM_ASSERT(1 <= cChunks);
+
+   if(nullptr == pThreadPool || 1 == cThreads || 1 == cChunks) {
+      for(size_t iChunk = 0; iChunk < cChunks; ++iChunk) {
+         chunkFunction(iChunk);
+      }
+      return;
+   }
+   pThreadPool->RunChunks(cThreads, cChunks, &RunChunkTrampoline<TChunkFunction>, &chunkFunction);
+}
+
+#endif // PARALLEL_CHUNKS_H
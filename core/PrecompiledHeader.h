@@ -10,6 +10,9 @@
 #include <new> // std::nothrow
 #include <assert.h>
 #include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <string.h> // memset
 #include <stdlib.h> // malloc, realloc, free
 #include <cmath> // log, exp, sqrt, etc.  Use cmath instead of math.h so that we get type overloading for these functions for seemless float/double useage
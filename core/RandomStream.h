@@ -5,26 +5,157 @@
 #ifndef RANDOM_STREAM_H
 #define RANDOM_STREAM_H
 
-#include <inttypes.h> // uint32_t seed
-#include <random>
+#include <inttypes.h> // uint32_t, uint64_t
 #include <stddef.h> // size_t, ptrdiff_t
 
 #include "ebmcore.h" // IntegerDataType
 #include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
 
+// a counter based Philox4x32-10 generator (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").  Each 128 bit block of output is a keyed
+// bijection of its 128 bit counter, so any value of any stream can be computed directly without generating the ones before it.  The key is our seed,
+// and the counter is the substream index in the upper 64 bits and the block index in the lower 64 bits, so every substream is independent of the
+// others, and work that is split between threads by substream gets exactly the same numbers on any number of threads.  Everything is done with
+// 32 and 64 bit integer arithmetic, so the numbers are also the same with every compiler and standard library.  None of this can throw
 class RandomStream final {
-   std::default_random_engine m_randomGenerator;
+   static constexpr uint32_t k_philoxMultiplier0 = 0xD2511F53;
+   static constexpr uint32_t k_philoxMultiplier1 = 0xCD9E8D57;
+   static constexpr uint32_t k_philoxWeyl0 = 0x9E3779B9;
+   static constexpr uint32_t k_philoxWeyl1 = 0xBB67AE85;
+   static constexpr int k_cPhiloxRounds = 10;
+
+   uint32_t m_key0;
+   uint32_t m_key1;
+   uint64_t m_iSubstream;
+   uint64_t m_iBlockNext;
+   uint64_t m_aBuffered[2];
+   size_t m_iBuffered;
+
+   EBM_INLINE static void GenerateBlock(const uint32_t key0, const uint32_t key1, const uint64_t iSubstream, const uint64_t iBlock, uint64_t * const aOut) {
+      uint32_t counter0 = static_cast<uint32_t>(iBlock);
+      uint32_t counter1 = static_cast<uint32_t>(iBlock >> 32);
+      uint32_t counter2 = static_cast<uint32_t>(iSubstream);
+      uint32_t counter3 = static_cast<uint32_t>(iSubstream >> 32);
+      uint32_t roundKey0 = key0;
+      uint32_t roundKey1 = key1;
+      for(int iRound = 0; iRound < k_cPhiloxRounds; ++iRound) {
+         const uint64_t product0 = static_cast<uint64_t>(k_philoxMultiplier0) * static_cast<uint64_t>(counter0);
+         const uint64_t product1 = static_cast<uint64_t>(k_philoxMultiplier1) * static_cast<uint64_t>(counter2);
+         counter0 = static_cast<uint32_t>(product1 >> 32) ^ counter1 ^ roundKey0;
+         counter1 = static_cast<uint32_t>(product1);
+         counter2 = static_cast<uint32_t>(product0 >> 32) ^ counter3 ^ roundKey1;
+         counter3 = static_cast<uint32_t>(product0);
+         roundKey0 += k_philoxWeyl0;
+         roundKey1 += k_philoxWeyl1;
+      }
+      aOut[0] = static_cast<uint64_t>(counter0) | static_cast<uint64_t>(counter1) << 32;
+      aOut[1] = static_cast<uint64_t>(counter2) | static_cast<uint64_t>(counter3) << 32;
+   }
+
+   // returns the upper 64 bits of the 128 bit product, and puts the lower 64 bits in *pLow
+   EBM_INLINE static uint64_t MultiplyFull(const uint64_t multiplicand, const uint64_t multiplier, uint64_t * const pLow) {
+      const uint64_t multiplicandLow = multiplicand & uint64_t { 0xFFFFFFFF };
+      const uint64_t multiplicandHigh = multiplicand >> 32;
+      const uint64_t multiplierLow = multiplier & uint64_t { 0xFFFFFFFF };
+      const uint64_t multiplierHigh = multiplier >> 32;
+      const uint64_t productLowLow = multiplicandLow * multiplierLow;
+      const uint64_t productLowHigh = multiplicandLow * multiplierHigh;
+      const uint64_t productHighLow = multiplicandHigh * multiplierLow;
+      const uint64_t productHighHigh = multiplicandHigh * multiplierHigh;
+      const uint64_t middle = (productLowLow >> 32) + (productHighLow & uint64_t { 0xFFFFFFFF }) + productLowHigh;
+      *pLow = (middle << 32) | (productLowLow & uint64_t { 0xFFFFFFFF });
+      return productHighHigh + (productHighLow >> 32) + (middle >> 32);
+   }
 
 public:
+
+   EBM_INLINE RandomStream(const IntegerDataType seed, const uint64_t iSubstream)
+      : m_key0(static_cast<uint32_t>(static_cast<uint64_t>(seed)))
+      , m_key1(static_cast<uint32_t>(static_cast<uint64_t>(seed) >> 32))
+      , m_iSubstream(iSubstream)
+      , m_iBlockNext(0)
+      , m_iBuffered(2) {
+      m_aBuffered[0] = 0;
+      m_aBuffered[1] = 0;
+   }
+
    EBM_INLINE RandomStream(const IntegerDataType seed)
-      : m_randomGenerator(static_cast<unsigned int>(seed)) /* initializing default_random_engine doesn't have official nothrow properties, but a random number generator should not have to throw */ {
-      // TODO : change this to use the AES instruction set, which would ensure compatibility between languages and it would only take 2-3 clock cycles (although we'd still probably need to div [can we multiply instead] which is expensive).
+      : RandomStream(seed, 0) {
+   }
+
+   // jumps to the iValue-th value of our substream.  The values we return next are the ones we would have returned after drawing iValue values
+   // from the start, as long as none of them were drawn through Next with a bound, which can draw more than one value
+   EBM_INLINE void SetPosition(const uint64_t iValue) {
+      m_iBlockNext = iValue >> 1;
+      m_iBuffered = 2;
+      if(0 != (iValue & 1)) {
+         GenerateBlock(m_key0, m_key1, m_iSubstream, m_iBlockNext, m_aBuffered);
+         ++m_iBlockNext;
+         m_iBuffered = 1;
+      }
+   }
+
+   EBM_INLINE uint64_t NextUInt64() {
+      if(UNLIKELY(2 == m_iBuffered)) {
+         GenerateBlock(m_key0, m_key1, m_iSubstream, m_iBlockNext, m_aBuffered);
+         ++m_iBlockNext;
+         m_iBuffered = 0;
+      }
+      const uint64_t ret = m_aBuffered[m_iBuffered];
+      ++m_iBuffered;
+      return ret;
+   }
+
+   // writes the next cValues values of our substream, which are the same values that cValues calls to NextUInt64 would return.  The blocks in
+   // the middle are independent of each other, so the compiler can interleave or vectorize them, unlike a generator with a sequential state
+   EBM_INLINE void Fill(const size_t cValues, uint64_t * const aValues) {
+      size_t iValue = 0;
+      while(iValue < cValues && 2 != m_iBuffered) {
+         aValues[iValue] = NextUInt64();
+         ++iValue;
+      }
+      const uint64_t iBlockStart = m_iBlockNext;
+      const size_t cBlocks = (cValues - iValue) >> 1;
+      for(size_t iBlock = 0; iBlock < cBlocks; ++iBlock) {
+         GenerateBlock(m_key0, m_key1, m_iSubstream, iBlockStart + iBlock, &aValues[iValue + (iBlock << 1)]);
+      }
+      m_iBlockNext = iBlockStart + cBlocks;
+      iValue += cBlocks << 1;
+      while(iValue < cValues) {
+         aValues[iValue] = NextUInt64();
+         ++iValue;
+      }
+   }
+
+   // maps random, which is a value from NextUInt64 or Fill, to a uniformly distributed integer in [0, cRange) using Lemire's multiply and reject
+   // method.  Returns true if random has to be rejected, which happens with probability less than cRange / 2^64, in which case our caller maps
+   // another value.  The division is only needed on the rare path where random might be rejected
+   EBM_INLINE static bool MapToRange(const uint64_t random, const uint64_t cRange, size_t * const pResult) {
+      EBM_ASSERT(0 != cRange);
+      uint64_t low;
+      const uint64_t high = MultiplyFull(random, cRange, &low);
+      if(UNLIKELY(low < cRange)) {
+         const uint64_t threshold = (uint64_t { 0 } - cRange) % cRange;
+         if(low < threshold) {
+            return true;
+         }
+      }
+      *pResult = static_cast<size_t>(high);
+      return false;
    }
 
+   // returns a uniformly distributed integer in [minValueInclusive, maxValueInclusive]
    EBM_INLINE size_t Next(const size_t minValueInclusive, const size_t maxValueInclusive) {
-      // initializing uniform_int_distribution doesn't have official nothrow properties, but a random number generator should not have to throw
-      std::uniform_int_distribution<size_t> distribution(minValueInclusive, maxValueInclusive);
-      return distribution(m_randomGenerator);
+      EBM_ASSERT(minValueInclusive <= maxValueInclusive);
+      const uint64_t cRange = static_cast<uint64_t>(maxValueInclusive - minValueInclusive) + uint64_t { 1 };
+      if(UNLIKELY(0 == cRange)) {
+         // the range covers every 64 bit value, which can only happen if size_t is 64 bits
+         return minValueInclusive + static_cast<size_t>(NextUInt64());
+      }
+      size_t result;
+      while(MapToRange(NextUInt64(), cRange, &result)) {
+      }
+      return minValueInclusive + result;
    }
 
    EBM_INLINE size_t Next(const size_t maxValueInclusive) {
@@ -32,4 +163,4 @@ public:
    }
 };
 
-#endif // RANDOM_STREAM_H
\ No newline at end of file
+#endif // RANDOM_STREAM_H
@@ -10,19 +10,21 @@
 
 #include "EbmInternal.h" // EBM_INLINE & UNLIKLEY
 #include "Logging.h" // EBM_ASSERT & LOG
-#include "RandomStream.h" // our header didn't need the full definition, but we use the RandomStream in here, so we need it
+#include "ArenaAllocator.h"
+#include "RandomStream.h"
+#include "ParallelChunks.h"
 #include "DataSetByFeatureCombination.h" // we use an iterator which requires a full definition.  TODO : in the future we'll be eliminating the iterator, so check back here to see if we can eliminate this include file
 #include "SamplingWithReplacement.h"
 
 SamplingWithReplacement::~SamplingWithReplacement() {
    LOG_0(TraceLevelInfo, "Entered ~SamplingWithReplacement");
-   free(const_cast<size_t *>(m_aCountOccurrences));
+   // m_aCountOccurrences is freed with the arena that it was allocated from
    LOG_0(TraceLevelInfo, "Exited ~SamplingWithReplacement");
 }
 
 size_t SamplingWithReplacement::GetTotalCountInstanceOccurrences() const {
-      // for SamplingWithReplacement (bootstrap sampling), we have the same number of instances as our original dataset
-   size_t cTotalCountInstanceOccurrences = m_pOriginDataSet->GetCountInstances();
+   // for SamplingWithReplacement (bootstrap sampling), we draw as many instances as we can sample from, which is the whole dataset unless some instances were excluded
+   const size_t cTotalCountInstanceOccurrences = m_cTotalCountInstanceOccurrences;
 #ifndef NDEBUG
    size_t cTotalCountInstanceOccurrencesDebug = 0;
    for(size_t i = 0; i < m_pOriginDataSet->GetCountInstances(); ++i) {
@@ -33,74 +35,78 @@ size_t SamplingWithReplacement::GetTotalCountInstanceOccurrences() const {
    return cTotalCountInstanceOccurrences;
 }
 
-SamplingWithReplacement * SamplingWithReplacement::GenerateSingleSamplingSet(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet) {
-   LOG_0(TraceLevelVerbose, "Entered SamplingWithReplacement::GenerateSingleSamplingSet");
+// we draw this many random values at a time with RandomStream::Fill
+constexpr size_t k_cRandomValuesPerFill = 256;
 
+// draws cIncludedInstances instances with replacement into aCountOccurrences, which needs to be zeroed.  This can be called from any thread, so it doesn't log
+static void FillSingleSamplingSet(RandomStream * const pRandomStream, StorageCountOccurrencesCore * const aCountOccurrences, const size_t cInstances, const size_t cIncludedInstances, const size_t * const aIncludedInstanceIndexes) {
    EBM_ASSERT(nullptr != pRandomStream);
-   EBM_ASSERT(nullptr != pOriginDataSet);
-
-   const size_t cInstances = pOriginDataSet->GetCountInstances();
-   EBM_ASSERT(0 < cInstances); // if there were no instances, we wouldn't be called
-
-   if(IsMultiplyError(sizeof(size_t), cInstances)) {
-      LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSingleSamplingSet IsMultiplyError(sizeof(size_t), cInstances)");
-      return nullptr;
-   }
-   const size_t cBytesData = sizeof(size_t) * cInstances;
-   size_t * const aCountOccurrences = static_cast<size_t *>(malloc(cBytesData));
-   if(nullptr == aCountOccurrences) {
-      LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSingleSamplingSet nullptr == aCountOccurrences");
-      return nullptr;
-   }
-
-   memset(aCountOccurrences, 0, cBytesData);
-
-   try {
-      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
-         const size_t iCountOccurrences = pRandomStream->Next(size_t { 0 }, cInstances - 1);
+   EBM_ASSERT(nullptr != aCountOccurrences);
+   EBM_ASSERT(0 < cIncludedInstances);
+   EBM_ASSERT(cIncludedInstances <= cInstances);
+   EBM_ASSERT(nullptr != aIncludedInstanceIndexes || cIncludedInstances == cInstances);
+   UNUSED(cInstances);
+
+   uint64_t aRandomValues[k_cRandomValuesPerFill];
+   size_t cDrawsRemaining = cIncludedInstances;
+   do {
+      const size_t cDraws = cDrawsRemaining < k_cRandomValuesPerFill ? cDrawsRemaining : k_cRandomValuesPerFill;
+      pRandomStream->Fill(cDraws, aRandomValues);
+      for(size_t iDraw = 0; iDraw < cDraws; ++iDraw) {
+         uint64_t randomValue = aRandomValues[iDraw];
+         size_t iCountOccurrences;
+         while(true) {
+            size_t iIncludedInstance;
+            while(UNLIKELY(RandomStream::MapToRange(randomValue, static_cast<uint64_t>(cIncludedInstances), &iIncludedInstance))) {
+               randomValue = pRandomStream->NextUInt64();
+            }
+            iCountOccurrences = nullptr == aIncludedInstanceIndexes ? iIncludedInstance : aIncludedInstanceIndexes[iIncludedInstance];
+            EBM_ASSERT(iCountOccurrences < cInstances);
+            // the chance that any instance is drawn more than k_cCountOccurrencesMax times is far too small to ever happen in practice, but if it does
+            // we draw again rather than overflow the count.  The sampling set still has cIncludedInstances draws, and there is always an instance with room left
+            if(LIKELY(k_cCountOccurrencesMax != aCountOccurrences[iCountOccurrences])) {
+               break;
+            }
+            randomValue = pRandomStream->NextUInt64();
+         }
          ++aCountOccurrences[iCountOccurrences];
       }
-   } catch(...) {
-      // Next could in theory throw an exception
-      LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSingleSamplingSet exception");
-      free(aCountOccurrences);
-      return nullptr;
-   }
-
-   SamplingWithReplacement * pRet = new (std::nothrow) SamplingWithReplacement(pOriginDataSet, aCountOccurrences);
-   if(nullptr == pRet) {
-      LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSingleSamplingSet nullptr == pRet");
-      free(aCountOccurrences);
-      return nullptr;
-   }
-
-   LOG_0(TraceLevelVerbose, "Exited SamplingWithReplacement::GenerateSingleSamplingSet");
-   return pRet;
+      cDrawsRemaining -= cDraws;
+   } while(0 != cDrawsRemaining);
 }
 
-SamplingWithReplacement * SamplingWithReplacement::GenerateFlatSamplingSet(const DataSetByFeatureCombination * const pOriginDataSet) {
+SamplingWithReplacement * SamplingWithReplacement::GenerateFlatSamplingSet(ArenaAllocator * const pArena, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cIncludedInstances, const size_t * const aIncludedInstanceIndexes) {
    LOG_0(TraceLevelInfo, "Entered SamplingWithReplacement::GenerateFlatSamplingSet");
 
    // TODO: someday eliminate the need for generating this flat set by specially handling the case of no internal bagging
+   EBM_ASSERT(nullptr != pArena);
    EBM_ASSERT(nullptr != pOriginDataSet);
    const size_t cInstances = pOriginDataSet->GetCountInstances();
    EBM_ASSERT(0 < cInstances); // if there were no instances, we wouldn't be called
+   EBM_ASSERT(0 < cIncludedInstances);
+   EBM_ASSERT(cIncludedInstances <= cInstances);
+   EBM_ASSERT(nullptr != aIncludedInstanceIndexes || cIncludedInstances == cInstances);
 
-   const size_t cBytesData = sizeof(size_t) * cInstances;
-   size_t * const aCountOccurrences = static_cast<size_t *>(malloc(cBytesData));
+   const size_t cBytesData = sizeof(StorageCountOccurrencesCore) * cInstances;
+   StorageCountOccurrencesCore * const aCountOccurrences = static_cast<StorageCountOccurrencesCore *>(pArena->Allocate(cBytesData));
    if(nullptr == aCountOccurrences) {
       LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateFlatSamplingSet nullptr == aCountOccurrences");
       return nullptr;
    }
 
-   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
-      aCountOccurrences[iInstance] = 1;
+   if(nullptr == aIncludedInstanceIndexes) {
+      memset(aCountOccurrences, 1, cBytesData);
+   } else {
+      memset(aCountOccurrences, 0, cBytesData);
+      for(size_t iIncludedInstance = 0; iIncludedInstance < cIncludedInstances; ++iIncludedInstance) {
+         EBM_ASSERT(aIncludedInstanceIndexes[iIncludedInstance] < cInstances);
+         aCountOccurrences[aIncludedInstanceIndexes[iIncludedInstance]] = 1;
+      }
    }
 
-   SamplingWithReplacement * pRet = new (std::nothrow) SamplingWithReplacement(pOriginDataSet, aCountOccurrences);
+   SamplingWithReplacement * pRet = new (std::nothrow) SamplingWithReplacement(pOriginDataSet, aCountOccurrences, cIncludedInstances);
    if(nullptr == pRet) {
       LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateFlatSamplingSet nullptr == pRet");
-      free(aCountOccurrences);
    }
 
    LOG_0(TraceLevelInfo, "Exited SamplingWithReplacement::GenerateFlatSamplingSet");
@@ -119,10 +125,11 @@ void SamplingWithReplacement::FreeSamplingSets(const size_t cSamplingSets, Sampl
    LOG_0(TraceLevelInfo, "Exited SamplingWithReplacement::FreeSamplingSets");
 }
 
-SamplingMethod ** SamplingWithReplacement::GenerateSamplingSets(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cSamplingSets) {
+SamplingMethod ** SamplingWithReplacement::GenerateSamplingSets(ArenaAllocator * const pArena, ThreadPool * const pThreadPool, const size_t cThreads, const IntegerDataType randomSeed, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cSamplingSets, const size_t cIncludedInstances, const size_t * const aIncludedInstanceIndexes) {
    LOG_0(TraceLevelInfo, "Entered SamplingWithReplacement::GenerateSamplingSets");
 
-   EBM_ASSERT(nullptr != pRandomStream);
+   EBM_ASSERT(nullptr != pArena);
+   EBM_ASSERT(1 <= cThreads);
    EBM_ASSERT(nullptr != pOriginDataSet);
 
    const size_t cSamplingSetsAfterZero = 0 == cSamplingSets ? 1 : cSamplingSets;
@@ -133,7 +140,7 @@ SamplingMethod ** SamplingWithReplacement::GenerateSamplingSets(RandomStream * c
       return nullptr;
    }
    if(0 == cSamplingSets) {
-      SamplingWithReplacement * const pSingleSamplingSet = GenerateFlatSamplingSet(pOriginDataSet);
+      SamplingWithReplacement * const pSingleSamplingSet = GenerateFlatSamplingSet(pArena, pOriginDataSet, cIncludedInstances, aIncludedInstanceIndexes);
       if(UNLIKELY(nullptr == pSingleSamplingSet)) {
          LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSamplingSets nullptr == pSingleSamplingSet");
          free(apSamplingSets);
@@ -142,8 +149,31 @@ SamplingMethod ** SamplingWithReplacement::GenerateSamplingSets(RandomStream * c
       apSamplingSets[0] = pSingleSamplingSet;
    } else {
       memset(apSamplingSets, 0, sizeof(*apSamplingSets) * cSamplingSets);
+
+      const size_t cInstances = pOriginDataSet->GetCountInstances();
+      EBM_ASSERT(0 < cInstances); // if there were no instances, we wouldn't be called
+      EBM_ASSERT(0 < cIncludedInstances);
+      EBM_ASSERT(cIncludedInstances <= cInstances);
+      EBM_ASSERT(nullptr != aIncludedInstanceIndexes || cIncludedInstances == cInstances);
+
+      // the arena isn't thread safe, so we allocate the counts of every sampling set here before handing them out to the threads
+      static_assert(1 == sizeof(StorageCountOccurrencesCore), "we need to check for overflow if our counts get bigger than a byte");
+      if(IsMultiplyError(cInstances, cSamplingSets)) {
+         LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSamplingSets IsMultiplyError(cInstances, cSamplingSets)");
+         FreeSamplingSets(cSamplingSets, apSamplingSets);
+         return nullptr;
+      }
+      const size_t cBytesData = sizeof(StorageCountOccurrencesCore) * cInstances * cSamplingSets;
+      StorageCountOccurrencesCore * const aCountOccurrencesAll = static_cast<StorageCountOccurrencesCore *>(pArena->Allocate(cBytesData));
+      if(UNLIKELY(nullptr == aCountOccurrencesAll)) {
+         LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSamplingSets nullptr == aCountOccurrencesAll");
+         FreeSamplingSets(cSamplingSets, apSamplingSets);
+         return nullptr;
+      }
+      memset(aCountOccurrencesAll, 0, cBytesData);
+
       for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSets; ++iSamplingSet) {
-         SamplingWithReplacement * const pSingleSamplingSet = GenerateSingleSamplingSet(pRandomStream, pOriginDataSet);
+         SamplingWithReplacement * const pSingleSamplingSet = new (std::nothrow) SamplingWithReplacement(pOriginDataSet, &aCountOccurrencesAll[cInstances * iSamplingSet], cIncludedInstances);
          if(UNLIKELY(nullptr == pSingleSamplingSet)) {
             LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSamplingSets nullptr == pSingleSamplingSet");
             FreeSamplingSets(cSamplingSets, apSamplingSets);
@@ -151,7 +181,12 @@ SamplingMethod ** SamplingWithReplacement::GenerateSamplingSets(RandomStream * c
          }
          apSamplingSets[iSamplingSet] = pSingleSamplingSet;
       }
+
+      RunChunks(pThreadPool, cThreads, cSamplingSets, [=](const size_t iSamplingSet) {
+         RandomStream randomStream(randomSeed, static_cast<uint64_t>(iSamplingSet));
+         FillSingleSamplingSet(&randomStream, &aCountOccurrencesAll[cInstances * iSamplingSet], cInstances, cIncludedInstances, aIncludedInstanceIndexes);
+      });
    }
    LOG_0(TraceLevelInfo, "Exited SamplingWithReplacement::GenerateSamplingSets");
    return apSamplingSets;
-}
\ No newline at end of file
+}
@@ -6,12 +6,19 @@
 #define SAMPLING_WITH_REPLACEMENT_H
 
 #include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // numeric_limits
 
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
 
-class RandomStream;
 class DataSetByFeatureCombination;
+class ArenaAllocator;
+class ThreadPool;
+
+// a bootstrap count of any instance is almost always 0, 1, 2 or 3, so we store one byte per instance per sampling set instead of a size_t, which cuts the
+// memory of our sampling sets and the memory traffic of the binning loops that read them by 8 times
+typedef unsigned char StorageCountOccurrencesCore;
+constexpr size_t k_cCountOccurrencesMax = static_cast<size_t>(std::numeric_limits<StorageCountOccurrencesCore>::max());
 
 // TODO: if/when we decide we want to keep SamplingWithReplacement, we should create a SamplingMethod.h and SamplingMethod.cpp
 class SamplingMethod {
@@ -33,23 +40,28 @@ public:
 class SamplingWithReplacement final : public SamplingMethod {
 public:
    // TODO : make this a struct of FractionalType and size_t counts and use MACROS to have either size_t or FractionalType or both, and perf how this changes things.  We don't get a benefit anywhere by storing the raw data in both formats since it is never converted anyways, but this count is!
-   const size_t * const m_aCountOccurrences;
+   const StorageCountOccurrencesCore * const m_aCountOccurrences;
+   const size_t m_cTotalCountInstanceOccurrences;
 
-   // we take owernship of the aCounts array.  We do not take ownership of the pOriginDataSet since many SamplingWithReplacement objects will refer to the original one
-   EBM_INLINE SamplingWithReplacement(const DataSetByFeatureCombination * const pOriginDataSet, const size_t * const aCountOccurrences)
+   // aCountOccurrences lives in the arena of the training state that owns us, so we don't free it.  We do not take ownership of the pOriginDataSet since many SamplingWithReplacement objects will refer to the original one
+   EBM_INLINE SamplingWithReplacement(const DataSetByFeatureCombination * const pOriginDataSet, const StorageCountOccurrencesCore * const aCountOccurrences, const size_t cTotalCountInstanceOccurrences)
       : SamplingMethod(pOriginDataSet)
-      , m_aCountOccurrences(aCountOccurrences) {
+      , m_aCountOccurrences(aCountOccurrences)
+      , m_cTotalCountInstanceOccurrences(cTotalCountInstanceOccurrences) {
       EBM_ASSERT(nullptr != aCountOccurrences);
    }
 
    virtual ~SamplingWithReplacement() final override;
    virtual size_t GetTotalCountInstanceOccurrences() const final override;
 
-   static SamplingWithReplacement * GenerateSingleSamplingSet(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet);
-   static SamplingWithReplacement * GenerateFlatSamplingSet(const DataSetByFeatureCombination * const pOriginDataSet);
+   // aIncludedInstanceIndexes can be nullptr, in which case every instance of pOriginDataSet can be sampled.  Otherwise only the cIncludedInstances
+   // instances it lists can be sampled, and every other instance has zero occurrences in every sampling set
+   static SamplingWithReplacement * GenerateFlatSamplingSet(ArenaAllocator * const pArena, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cIncludedInstances, const size_t * const aIncludedInstanceIndexes);
 
    static void FreeSamplingSets(const size_t cSamplingSets, SamplingMethod ** apSamplingSets);
-   static SamplingMethod ** GenerateSamplingSets(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cSamplingSets);
+   // each sampling set draws from its own substream of randomSeed, so the sampling sets can be generated on up to cThreads threads of pThreadPool and
+   // are the same on any number of threads.  pThreadPool can be nullptr
+   static SamplingMethod ** GenerateSamplingSets(ArenaAllocator * const pArena, ThreadPool * const pThreadPool, const size_t cThreads, const IntegerDataType randomSeed, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cSamplingSets, const size_t cIncludedInstances, const size_t * const aIncludedInstanceIndexes);
 };
 
 #endif // SAMPLING_WITH_REPLACEMENT_H
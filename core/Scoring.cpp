@@ -0,0 +1,367 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <inttypes.h> // uint8_t, uint16_t, int32_t
+#include <cmath> // exp
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "BinnedDataView.h"
+#include "IsaKernels.h"
+#include "Scoring.h"
+
+// we score the rows in blocks, and within a block we add one term after another into the block's scores.  A block's scores and tensor indexes
+// stay in L1 while we walk every term over them, so each term's tensor is the only memory that streams through the cache, and it's read from
+// where the previous block left it.  Every row still adds the intercept and then each term in order, so our scores are exactly the sums that
+// adding up the terms one at a time over the whole batch would give
+constexpr size_t k_cBytesScoresPerBlock = size_t { 16 } * 1024;
+constexpr size_t k_cInstancesPerScoreBlockMax = 512;
+constexpr size_t k_cInstancesPerScoreBlockMin = 16;
+
+ScoringTerms::~ScoringTerms() {
+   free(m_aTerms);
+   free(m_aDimensions);
+}
+
+bool ScoringTerms::Initialize(
+   const size_t cScores,
+   const size_t cFeatures,
+   const EbmCoreFeature * const aFeatures,
+   const size_t cFeatureCombinations,
+   const EbmCoreFeatureCombination * const aFeatureCombinations,
+   const IntegerDataType * const aFeatureCombinationIndexes,
+   const FractionalDataType * const * const apModels
+) {
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(nullptr == m_aTerms);
+   EBM_ASSERT(nullptr == m_aDimensions);
+
+   if(0 != cFeatures && nullptr == aFeatures) {
+      LOG_0(TraceLevelError, "ERROR ScoringTerms::Initialize features can't be null");
+      return true;
+   }
+   if(0 != cFeatureCombinations && (nullptr == aFeatureCombinations || nullptr == apModels)) {
+      LOG_0(TraceLevelError, "ERROR ScoringTerms::Initialize featureCombinations and models can't be null");
+      return true;
+   }
+
+   size_t cDimensionsTotal = 0;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      const IntegerDataType countFeaturesInCombination = aFeatureCombinations[iFeatureCombination].countFeaturesInCombination;
+      if(countFeaturesInCombination < 0 || !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination) || IsAddError(cDimensionsTotal, static_cast<size_t>(countFeaturesInCombination))) {
+         LOG_0(TraceLevelError, "ERROR ScoringTerms::Initialize countFeaturesInCombination is not valid");
+         return true;
+      }
+      cDimensionsTotal += static_cast<size_t>(countFeaturesInCombination);
+   }
+   if(0 != cDimensionsTotal && nullptr == aFeatureCombinationIndexes) {
+      LOG_0(TraceLevelError, "ERROR ScoringTerms::Initialize featureCombinationIndexes can't be null");
+      return true;
+   }
+
+   // a term with no model is left out, which lets our caller score without some of the terms without copying the others
+   size_t cTerms = 0;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      if(nullptr != apModels[iFeatureCombination]) {
+         ++cTerms;
+      }
+   }
+   if(IsMultiplyError(sizeof(ScoringTerm), cTerms) || IsMultiplyError(sizeof(ScoringDimension), cDimensionsTotal)) {
+      LOG_0(TraceLevelWarning, "WARNING ScoringTerms::Initialize IsMultiplyError(sizeof(ScoringTerm), cTerms) || IsMultiplyError(sizeof(ScoringDimension), cDimensionsTotal)");
+      return true;
+   }
+   // malloc can return nullptr for zero bytes, so we always ask for at least one item
+   m_aTerms = static_cast<ScoringTerm *>(malloc(sizeof(ScoringTerm) * (0 == cTerms ? size_t { 1 } : cTerms)));
+   m_aDimensions = static_cast<ScoringDimension *>(malloc(sizeof(ScoringDimension) * (0 == cDimensionsTotal ? size_t { 1 } : cDimensionsTotal)));
+   if(nullptr == m_aTerms || nullptr == m_aDimensions) {
+      LOG_0(TraceLevelWarning, "WARNING ScoringTerms::Initialize nullptr == m_aTerms || nullptr == m_aDimensions");
+      return true;
+   }
+
+   const IntegerDataType * pFeatureIndex = aFeatureCombinationIndexes;
+   size_t iDimension = 0;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      const size_t cFeaturesInCombination = static_cast<size_t>(aFeatureCombinations[iFeatureCombination].countFeaturesInCombination);
+      const IntegerDataType * const pFeatureIndexEnd = pFeatureIndex + cFeaturesInCombination;
+      const FractionalDataType * const aModel = apModels[iFeatureCombination];
+      if(nullptr == aModel) {
+         pFeatureIndex = pFeatureIndexEnd;
+         continue;
+      }
+      ScoringTerm * const pTerm = &m_aTerms[m_cTerms];
+      pTerm->m_aModel = aModel;
+      pTerm->m_iDimensionFirst = iDimension;
+      // the first feature of a combination varies fastest in its tensor, like the tensors of GetBestModelFeatureCombination
+      size_t cItemsMultiple = cScores;
+      for(; pFeatureIndexEnd != pFeatureIndex; ++pFeatureIndex) {
+         const IntegerDataType indexFeature = *pFeatureIndex;
+         if(indexFeature < 0 || !IsNumberConvertable<size_t, IntegerDataType>(indexFeature) || cFeatures <= static_cast<size_t>(indexFeature)) {
+            LOG_0(TraceLevelError, "ERROR ScoringTerms::Initialize featureCombinationIndexes value is not a valid feature");
+            return true;
+         }
+         const size_t iFeature = static_cast<size_t>(indexFeature);
+         const IntegerDataType countBins = aFeatures[iFeature].countBins;
+         if(countBins < 1 || !IsNumberConvertable<size_t, IntegerDataType>(countBins)) {
+            LOG_0(TraceLevelError, "ERROR ScoringTerms::Initialize countBins of a feature in a feature combination must be 1 or more");
+            return true;
+         }
+         const size_t cBins = static_cast<size_t>(countBins);
+         if(1 == cBins) {
+            // the only bin is zero, so this dimension never moves us in the tensor
+            continue;
+         }
+         if(IsMultiplyError(cItemsMultiple, cBins)) {
+            LOG_0(TraceLevelWarning, "WARNING ScoringTerms::Initialize IsMultiplyError(cItemsMultiple, cBins)");
+            return true;
+         }
+         m_aDimensions[iDimension].m_iFeature = iFeature;
+         m_aDimensions[iDimension].m_cItemsMultiple = cItemsMultiple;
+         ++iDimension;
+         cItemsMultiple *= cBins;
+      }
+      pTerm->m_cItems = cItemsMultiple;
+      pTerm->m_cDimensions = iDimension - pTerm->m_iDimensionFirst;
+      ++m_cTerms;
+   }
+   EBM_ASSERT(cTerms == m_cTerms);
+   return false;
+}
+
+bool IsScoreLinkError(const size_t cScores, const IntegerDataType link) {
+   if(ScoreLinkIdentity != link && ScoreLinkSigmoid != link && ScoreLinkSoftmax != link) {
+      LOG_0(TraceLevelError, "ERROR IsScoreLinkError unrecognized link");
+      return true;
+   }
+   if(ScoreLinkSigmoid == link && 1 != cScores) {
+      LOG_0(TraceLevelError, "ERROR IsScoreLinkError ScoreLinkSigmoid needs a single logit");
+      return true;
+   }
+   return false;
+}
+
+void ApplyScoreLink(const IntegerDataType link, const size_t cInstances, const size_t cOutputs, FractionalDataType * const aOutputs) {
+   if(ScoreLinkSigmoid == link) {
+      EBM_ASSERT(1 == cOutputs);
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         // 1 / (1 + exp(-logit)) goes to 0 and 1 at the extremes, whereas exp(logit) / (1 + exp(logit)) would become infinity / infinity
+         aOutputs[iInstance] = FractionalDataType { 1 } / (FractionalDataType { 1 } + std::exp(-aOutputs[iInstance]));
+      }
+   } else if(ScoreLinkSoftmax == link) {
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         FractionalDataType * const pOutputs = &aOutputs[iInstance * cOutputs];
+         // subtracting the largest logit keeps exp from overflowing, and leaves the probabilities unchanged
+         FractionalDataType logitMax = pOutputs[0];
+         for(size_t iOutput = 1; iOutput < cOutputs; ++iOutput) {
+            logitMax = logitMax < pOutputs[iOutput] ? pOutputs[iOutput] : logitMax;
+         }
+         FractionalDataType sum = 0;
+         for(size_t iOutput = 0; iOutput < cOutputs; ++iOutput) {
+            const FractionalDataType odds = std::exp(pOutputs[iOutput] - logitMax);
+            pOutputs[iOutput] = odds;
+            sum += odds;
+         }
+         for(size_t iOutput = 0; iOutput < cOutputs; ++iOutput) {
+            pOutputs[iOutput] /= sum;
+         }
+      }
+   } else {
+      EBM_ASSERT(ScoreLinkIdentity == link);
+   }
+}
+
+template<typename T>
+static void ScoreBlock(
+   const BinnedDataView * const pBinnedData,
+   const size_t iInstanceStart,
+   const size_t cInstancesBlock,
+   const size_t cTerms,
+   const ScoringTerm * const aTerms,
+   const ScoringDimension * const aDimensions,
+   const size_t cScores,
+   const size_t cOutputs,
+   FractionalDataType * const aLogits,
+   size_t * const aiTensor
+) {
+   const size_t cItemsStrideInstance = pBinnedData->GetCountItemsStrideInstance();
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      const ScoringTerm * const pTerm = &aTerms[iTerm];
+      const FractionalDataType * const aModel = pTerm->m_aModel;
+      if(0 == pTerm->m_cDimensions) {
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               aLogits[iInstance * cOutputs + iScore] += aModel[iScore];
+            }
+         }
+         continue;
+      }
+
+      // we build each row's tensor index one feature at a time, so that we read the binned data one column after another
+      const ScoringDimension * pDimension = &aDimensions[pTerm->m_iDimensionFirst];
+      const ScoringDimension * const pDimensionEnd = pDimension + pTerm->m_cDimensions;
+      {
+         const T * pBin = pBinnedData->GetFeatureData<T>(pDimension->m_iFeature) + iInstanceStart * cItemsStrideInstance;
+         const size_t cItemsMultiple = pDimension->m_cItemsMultiple;
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            EBM_ASSERT(0 <= *pBin);
+            aiTensor[iInstance] = static_cast<size_t>(*pBin) * cItemsMultiple;
+            pBin += cItemsStrideInstance;
+         }
+         ++pDimension;
+      }
+      for(; pDimensionEnd != pDimension; ++pDimension) {
+         const T * pBin = pBinnedData->GetFeatureData<T>(pDimension->m_iFeature) + iInstanceStart * cItemsStrideInstance;
+         const size_t cItemsMultiple = pDimension->m_cItemsMultiple;
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            EBM_ASSERT(0 <= *pBin);
+            aiTensor[iInstance] += static_cast<size_t>(*pBin) * cItemsMultiple;
+            pBin += cItemsStrideInstance;
+         }
+      }
+
+      if(1 == cOutputs) {
+         // the block's logits are contiguous, so the lookups can be vector gathers
+         g_pIsaKernels->m_pAddGathered(cInstancesBlock, aModel, aiTensor, aLogits);
+      } else if(1 == cScores) {
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            aLogits[iInstance * cOutputs] += aModel[aiTensor[iInstance]];
+         }
+      } else {
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            const FractionalDataType * const pModel = &aModel[aiTensor[iInstance]];
+            FractionalDataType * const pLogits = &aLogits[iInstance * cOutputs];
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               pLogits[iScore] += pModel[iScore];
+            }
+         }
+      }
+   }
+}
+
+template<typename T>
+static void ScoreInstances(
+   const BinnedDataView * const pBinnedData,
+   const size_t cInstances,
+   const size_t cTerms,
+   const ScoringTerm * const aTerms,
+   const ScoringDimension * const aDimensions,
+   const size_t cScores,
+   const FractionalDataType * const aIntercept,
+   const IntegerDataType link,
+   FractionalDataType * const aScoresReturn
+) {
+   const size_t cOutputs = GetCountScoreOutputs(cScores, link);
+   // the logits go into the last cScores outputs of each row, which for binary softmax leaves the first output for the implicit zero logit
+   const size_t iLogitFirst = cOutputs - cScores;
+
+   size_t cInstancesPerBlock = k_cBytesScoresPerBlock / (sizeof(FractionalDataType) * cOutputs);
+   cInstancesPerBlock = k_cInstancesPerScoreBlockMax < cInstancesPerBlock ? k_cInstancesPerScoreBlockMax : cInstancesPerBlock;
+   cInstancesPerBlock = cInstancesPerBlock < k_cInstancesPerScoreBlockMin ? k_cInstancesPerScoreBlockMin : cInstancesPerBlock;
+
+   size_t aiTensor[k_cInstancesPerScoreBlockMax];
+   for(size_t iInstanceStart = 0; iInstanceStart < cInstances; iInstanceStart += cInstancesPerBlock) {
+      const size_t cInstancesRemaining = cInstances - iInstanceStart;
+      const size_t cInstancesBlock = cInstancesRemaining < cInstancesPerBlock ? cInstancesRemaining : cInstancesPerBlock;
+      FractionalDataType * const aOutputs = &aScoresReturn[iInstanceStart * cOutputs];
+      for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+         FractionalDataType * const pOutputs = &aOutputs[iInstance * cOutputs];
+         for(size_t iOutput = 0; iOutput < iLogitFirst; ++iOutput) {
+            pOutputs[iOutput] = 0;
+         }
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            pOutputs[iLogitFirst + iScore] = nullptr == aIntercept ? FractionalDataType { 0 } : aIntercept[iScore];
+         }
+      }
+      ScoreBlock<T>(pBinnedData, iInstanceStart, cInstancesBlock, cTerms, aTerms, aDimensions, cScores, cOutputs, &aOutputs[iLogitFirst], aiTensor);
+      ApplyScoreLink(link, cInstancesBlock, cOutputs, aOutputs);
+   }
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ScoreBinnedInstances(
+   IntegerDataType countScores,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * models,
+   const FractionalDataType * intercept,
+   IntegerDataType countInstances,
+   const EbmCoreBinnedData * binnedData,
+   IntegerDataType link,
+   FractionalDataType * scoresReturn
+) {
+   LOG_N(TraceLevelInfo, "Entered ScoreBinnedInstances: countScores=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, models=%p, intercept=%p, countInstances=%" IntegerDataTypePrintf ", binnedData=%p, link=%" IntegerDataTypePrintf ", scoresReturn=%p", countScores, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), static_cast<const void *>(models), static_cast<const void *>(intercept), countInstances, static_cast<const void *>(binnedData), link, static_cast<void *>(scoresReturn));
+
+   if(countScores < 1) {
+      LOG_0(TraceLevelError, "ERROR ScoreBinnedInstances countScores must be 1 or more");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countScores)) {
+      LOG_0(TraceLevelWarning, "WARNING ScoreBinnedInstances !IsNumberConvertable<size_t, IntegerDataType>(countScores)");
+      return 1;
+   }
+   const size_t cScores = static_cast<size_t>(countScores);
+   if(IsScoreLinkError(cScores, link)) {
+      return 1;
+   }
+   if(countFeatures < 0 || countFeatureCombinations < 0 || countInstances < 0) {
+      LOG_0(TraceLevelError, "ERROR ScoreBinnedInstances countFeatures, countFeatureCombinations and countInstances can't be negative");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatures) || !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations) || !IsNumberConvertable<size_t, IntegerDataType>(countInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING ScoreBinnedInstances !IsNumberConvertable<size_t, IntegerDataType>(count)");
+      return 1;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cInstances = static_cast<size_t>(countInstances);
+   if(IsMultiplyError(cInstances, GetCountScoreOutputs(cScores, link))) {
+      LOG_0(TraceLevelWarning, "WARNING ScoreBinnedInstances IsMultiplyError(cInstances, GetCountScoreOutputs(cScores, link))");
+      return 1;
+   }
+   ScoringTerms terms;
+   if(terms.Initialize(cScores, cFeatures, features, static_cast<size_t>(countFeatureCombinations), featureCombinations, featureCombinationIndexes, models)) {
+      LOG_0(TraceLevelWarning, "WARNING ScoreBinnedInstances terms.Initialize");
+      return 1;
+   }
+   if(0 == cInstances) {
+      LOG_0(TraceLevelInfo, "Exited ScoreBinnedInstances no instances");
+      return 0;
+   }
+   if(nullptr == scoresReturn) {
+      LOG_0(TraceLevelError, "ERROR ScoreBinnedInstances scoresReturn can't be null");
+      return 1;
+   }
+   BinnedDataView binnedDataView;
+   if(binnedDataView.Initialize(cFeatures, cInstances, binnedData)) {
+      LOG_0(TraceLevelWarning, "WARNING ScoreBinnedInstances binnedDataView.Initialize");
+      return 1;
+   }
+
+   switch(binnedDataView.GetDataType()) {
+   case BinnedDataTypeUInt8:
+      ScoreInstances<uint8_t>(&binnedDataView, cInstances, terms.m_cTerms, terms.m_aTerms, terms.m_aDimensions, cScores, intercept, link, scoresReturn);
+      break;
+   case BinnedDataTypeUInt16:
+      ScoreInstances<uint16_t>(&binnedDataView, cInstances, terms.m_cTerms, terms.m_aTerms, terms.m_aDimensions, cScores, intercept, link, scoresReturn);
+      break;
+   case BinnedDataTypeInt32:
+      ScoreInstances<int32_t>(&binnedDataView, cInstances, terms.m_cTerms, terms.m_aTerms, terms.m_aDimensions, cScores, intercept, link, scoresReturn);
+      break;
+   case BinnedDataTypeFloat64:
+      ScoreInstances<double>(&binnedDataView, cInstances, terms.m_cTerms, terms.m_aTerms, terms.m_aDimensions, cScores, intercept, link, scoresReturn);
+      break;
+   default:
+      EBM_ASSERT(BinnedDataTypeInt64 == binnedDataView.GetDataType());
+      ScoreInstances<IntegerDataType>(&binnedDataView, cInstances, terms.m_cTerms, terms.m_aTerms, terms.m_aDimensions, cScores, intercept, link, scoresReturn);
+      break;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited ScoreBinnedInstances");
+   return 0;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef SCORING_H
+#define SCORING_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "ebmcore.h" // EbmCoreFeature, EbmCoreFeatureCombination
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+
+struct ScoringDimension final {
+   size_t m_iFeature;
+   // the distance between neighbouring bins of this dimension in our tensor, counted in FractionalDataType items
+   size_t m_cItemsMultiple;
+};
+
+struct ScoringTerm final {
+   const FractionalDataType * m_aModel;
+   // the number of FractionalDataType items in m_aModel
+   size_t m_cItems;
+   size_t m_iDimensionFirst;
+   size_t m_cDimensions;
+};
+
+// the terms that we add up to score an instance, which are our caller's feature combinations with a model, in order.  Each term keeps only the
+// dimensions of features with more than one bin, since the only bin of the other features is zero, so a term whose features all have a single bin
+// has no dimensions and adds the same logits to every instance
+class ScoringTerms final {
+   // we own our arrays, so copying us would free them twice
+   ScoringTerms(const ScoringTerms &) = delete;
+   ScoringTerms & operator=(const ScoringTerms &) = delete;
+
+public:
+   size_t m_cTerms;
+   ScoringTerm * m_aTerms;
+   ScoringDimension * m_aDimensions;
+
+   EBM_INLINE ScoringTerms()
+      : m_cTerms(0)
+      , m_aTerms(nullptr)
+      , m_aDimensions(nullptr) {
+   }
+
+   ~ScoringTerms();
+
+   // feature combinations whose model is nullptr are left out.  Returns true on error
+   bool Initialize(
+      const size_t cScores,
+      const size_t cFeatures,
+      const EbmCoreFeature * const aFeatures,
+      const size_t cFeatureCombinations,
+      const EbmCoreFeatureCombination * const aFeatureCombinations,
+      const IntegerDataType * const aFeatureCombinationIndexes,
+      const FractionalDataType * const * const apModels
+   );
+};
+
+EBM_INLINE size_t GetCountScoreOutputs(const size_t cScores, const IntegerDataType link) {
+   // binary softmax writes the probability of the implicit zero logit class too, so that every classifier gets one probability per class
+   return ScoreLinkSoftmax == link && 1 == cScores ? size_t { 2 } : cScores;
+}
+
+// returns true if link is not one of our ScoreLink values, or needs more or fewer logits than cScores
+bool IsScoreLinkError(const size_t cScores, const IntegerDataType link);
+
+// turns the logits of cInstances instances into the outputs of link in place.  Each instance has cOutputs values, and for binary softmax the first
+// one needs to be zero
+void ApplyScoreLink(const IntegerDataType link, const size_t cInstances, const size_t cOutputs, FractionalDataType * const aOutputs);
+
+#endif // SCORING_H
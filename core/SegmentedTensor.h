@@ -15,6 +15,7 @@
 
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
+#include "ArenaAllocator.h"
 
 // TODO : after we've optimized a lot more and fit into the python wrapper and we've completely solved the bucketing, consider making SegmentedRegion with variable types that we can switch
 // we could put make TDivisions and TValues conditioned on individual functions and tread our allocated memory as a pool of variable types.   We cache SegmentedTensors right now for different types
@@ -41,6 +42,22 @@ class SegmentedTensor final {
    static constexpr size_t k_initialDivisionCapacity = 1;
    static constexpr size_t k_initialValueCapacity = 2;
 
+   EBM_INLINE static void * AllocateMemory(ArenaAllocator * const pArena, const size_t cBytes) {
+      return nullptr == pArena ? malloc(cBytes) : pArena->Allocate(cBytes);
+   }
+
+   EBM_INLINE static void * ReallocateMemory(ArenaAllocator * const pArena, void * const pOld, const size_t cBytesOld, const size_t cBytesNew) {
+      if(nullptr == pArena) {
+         return realloc(pOld, cBytesNew);
+      }
+      // an arena can't grow an allocation in place, so we copy into a new one.  The old one is freed along with the arena
+      void * const pNew = pArena->Allocate(cBytesNew);
+      if(LIKELY(nullptr != pNew)) {
+         memcpy(pNew, pOld, cBytesOld);
+      }
+      return pNew;
+   }
+
 public:
 
    struct DimensionInfo {
@@ -55,10 +72,18 @@ public:
    size_t m_cDimensions;
    TValues * m_aValues;
    bool m_bExpanded;
+   // nullptr if we own our arrays on the heap, otherwise the arena that we and our arrays were allocated from
+   ArenaAllocator * m_pArena;
    // TODO : I lean towards leaving this alone since pointers to SegmentedTensors instead of having an array of compact objects seems fine, but i should look over and consider changing this to eliminate dynamic allocation and replace it with k_cDimensionsMax
    DimensionInfo m_aDimensions[1];
 
    EBM_INLINE static SegmentedTensor * Allocate(const size_t cDimensionsMax, const size_t cVectorLength) {
+      return Allocate(nullptr, cDimensionsMax, cVectorLength);
+   }
+
+   // if pArena is not nullptr, we and our arrays come from it, and we are freed along with it.  Tensors in an arena grow to exactly the size that
+   // they are asked for since an arena can't release the memory that they grow out of, so they should only be grown while initializing
+   EBM_INLINE static SegmentedTensor * Allocate(ArenaAllocator * const pArena, const size_t cDimensionsMax, const size_t cVectorLength) {
       EBM_ASSERT(cDimensionsMax <= k_cDimensionsMax);
       EBM_ASSERT(1 <= cVectorLength); // having 0 classes makes no sense, and having 1 class is useless
 
@@ -75,7 +100,7 @@ public:
 
       // this can't overflow since cDimensionsMax can't be bigger than k_cDimensionsMax, which is arround 64
       const size_t cBytesSegmentedRegion = sizeof(SegmentedTensor) - sizeof(DimensionInfo) + sizeof(DimensionInfo) * cDimensionsMax;
-      SegmentedTensor * const pSegmentedRegion = static_cast<SegmentedTensor *>(malloc(cBytesSegmentedRegion));
+      SegmentedTensor * const pSegmentedRegion = static_cast<SegmentedTensor *>(AllocateMemory(pArena, cBytesSegmentedRegion));
       if(UNLIKELY(nullptr == pSegmentedRegion)) {
          LOG_0(TraceLevelWarning, "WARNING Allocate nullptr == pSegmentedRegion");
          return nullptr;
@@ -86,11 +111,12 @@ public:
       pSegmentedRegion->m_cDimensionsMax = cDimensionsMax;
       pSegmentedRegion->m_cDimensions = cDimensionsMax;
       pSegmentedRegion->m_cValueCapacity = cValueCapacity;
+      pSegmentedRegion->m_pArena = pArena;
 
-      TValues * const aValues = static_cast<TValues *>(malloc(cBytesValues));
+      TValues * const aValues = static_cast<TValues *>(AllocateMemory(pArena, cBytesValues));
       if(UNLIKELY(nullptr == aValues)) {
          LOG_0(TraceLevelWarning, "WARNING Allocate nullptr == aValues");
-         free(pSegmentedRegion); // don't need to call the full Free(*) yet
+         Free(pSegmentedRegion); // our dimensions were zeroed above, so there is nothing else to free
          return nullptr;
       }
       pSegmentedRegion->m_aValues = aValues;
@@ -103,7 +129,7 @@ public:
          do {
             EBM_ASSERT(0 == pDimension->cDivisions);
             pDimension->cDivisionCapacity = k_initialDivisionCapacity;
-            TDivisions * const aDivisions = static_cast<TDivisions *>(malloc(sizeof(TDivisions) * k_initialDivisionCapacity)); // this multiply can't overflow
+            TDivisions * const aDivisions = static_cast<TDivisions *>(AllocateMemory(pArena, sizeof(TDivisions) * k_initialDivisionCapacity)); // this multiply can't overflow
             if(UNLIKELY(nullptr == aDivisions)) {
                LOG_0(TraceLevelWarning, "WARNING Allocate nullptr == aDivisions");
                Free(pSegmentedRegion); // free everything!
@@ -118,7 +144,7 @@ public:
    }
 
    EBM_INLINE static void Free(SegmentedTensor * const pSegmentedRegion) {
-      if(LIKELY(nullptr != pSegmentedRegion)) {
+      if(LIKELY(nullptr != pSegmentedRegion) && LIKELY(nullptr == pSegmentedRegion->m_pArena)) {
          free(pSegmentedRegion->m_aValues);
          if(LIKELY(0 != pSegmentedRegion->m_cDimensionsMax)) {
             DimensionInfo * pDimensionInfo = &pSegmentedRegion->m_aDimensions[0];
@@ -167,7 +193,7 @@ public:
             LOG_0(TraceLevelWarning, "WARNING SetCountDivisions IsAddError(cDivisions, cDivisions >> 1)");
             return true;
          }
-         size_t cNewDivisionCapacity = cDivisions + (cDivisions >> 1); // just increase it by 50% since we don't expect to grow our divisions often after an initial period, and realloc takes some of the cost of growing away
+         size_t cNewDivisionCapacity = nullptr == m_pArena ? cDivisions + (cDivisions >> 1) : cDivisions; // just increase it by 50% since we don't expect to grow our divisions often after an initial period, and realloc takes some of the cost of growing away
          LOG_N(TraceLevelInfo, "SetCountDivisions Growing to size %zu", cNewDivisionCapacity);
 
          if(IsMultiplyError(sizeof(TDivisions), cNewDivisionCapacity)) {
@@ -175,7 +201,7 @@ public:
             return true;
          }
          size_t cBytes = sizeof(TDivisions) * cNewDivisionCapacity;
-         TDivisions * const aNewDivisions = static_cast<TDivisions *>(realloc(pDimension->aDivisions, cBytes));
+         TDivisions * const aNewDivisions = static_cast<TDivisions *>(ReallocateMemory(m_pArena, pDimension->aDivisions, sizeof(TDivisions) * pDimension->cDivisionCapacity, cBytes));
          if(UNLIKELY(nullptr == aNewDivisions)) {
             // according to the realloc spec, if realloc fails to allocate the new memory, it returns nullptr BUT the old memory is valid.
             // we leave m_aThreadByteBuffer1 alone in this instance and will free that memory later in the destructor
@@ -197,7 +223,7 @@ public:
             LOG_0(TraceLevelWarning, "WARNING EnsureValueCapacity IsAddError(cValues, cValues >> 1)");
             return true;
          }
-         size_t cNewValueCapacity = cValues + (cValues >> 1); // just increase it by 50% since we don't expect to grow our values often after an initial period, and realloc takes some of the cost of growing away
+         size_t cNewValueCapacity = nullptr == m_pArena ? cValues + (cValues >> 1) : cValues; // just increase it by 50% since we don't expect to grow our values often after an initial period, and realloc takes some of the cost of growing away
          LOG_N(TraceLevelInfo, "EnsureValueCapacity Growing to size %zu", cNewValueCapacity);
 
          if(IsMultiplyError(sizeof(TValues), cNewValueCapacity)) {
@@ -205,7 +231,7 @@ public:
             return true;
          }
          size_t cBytes = sizeof(TValues) * cNewValueCapacity;
-         TValues * const aNewValues = static_cast<TValues *>(realloc(m_aValues, cBytes));
+         TValues * const aNewValues = static_cast<TValues *>(ReallocateMemory(m_pArena, m_aValues, sizeof(TValues) * m_cValueCapacity, cBytes));
          if(UNLIKELY(nullptr == aNewValues)) {
             // according to the realloc spec, if realloc fails to allocate the new memory, it returns nullptr BUT the old memory is valid.
             // we leave m_aThreadByteBuffer1 alone in this instance and will free that memory later in the destructor
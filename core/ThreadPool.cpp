@@ -0,0 +1,396 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <new> // std::nothrow
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "EbmInternal.h" // EBM_INLINE & UNLIKLEY
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "ThreadPool.h"
+
+// the pool and worker index of the current thread, if the current thread is a pool thread.  Tasks submitted from a pool thread go onto that thread's own queue
+static thread_local const ThreadPool * t_pThreadPoolCurrent = nullptr;
+static thread_local size_t t_iWorkerCurrent = 0;
+
+// the first time a worker queue gets a task it makes room for this many, and after that it doubles whenever it's full
+constexpr static size_t k_cTasksPerWorkerQueueInitial = 64;
+
+// ChunkJob::m_chunksState keeps the chunk index and the number of chunks in 32 bits each
+constexpr static size_t k_cChunksMax = size_t { 0xFFFFFFFF };
+
+ThreadPool * ThreadPool::Allocate(const size_t cThreads) {
+   LOG_N(TraceLevelInfo, "Entered ThreadPool::Allocate: cThreads=%zu", cThreads);
+
+   EBM_ASSERT(1 <= cThreads);
+
+   ThreadPool * const pThreadPool = new (std::nothrow) ThreadPool();
+   if(UNLIKELY(nullptr == pThreadPool)) {
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Allocate nullptr == pThreadPool");
+      return nullptr;
+   }
+   if(UNLIKELY(pThreadPool->Initialize(cThreads - 1))) {
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Allocate pThreadPool->Initialize(cThreads - 1)");
+      delete pThreadPool;
+      return nullptr;
+   }
+
+   LOG_N(TraceLevelInfo, "Exited ThreadPool::Allocate %zu threads", pThreadPool->GetCountThreads());
+   return pThreadPool;
+}
+
+void ThreadPool::Free(ThreadPool * const pThreadPool) {
+   LOG_0(TraceLevelInfo, "Entered ThreadPool::Free");
+   delete pThreadPool;
+   LOG_0(TraceLevelInfo, "Exited ThreadPool::Free");
+}
+
+bool ThreadPool::Initialize(const size_t cWorkersRequested) {
+   EBM_ASSERT(0 == m_cWorkers);
+   if(0 == cWorkersRequested) {
+      return false;
+   }
+
+   m_aWorkerQueues = new (std::nothrow) WorkerQueue[cWorkersRequested];
+   if(UNLIKELY(nullptr == m_aWorkerQueues)) {
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Initialize nullptr == m_aWorkerQueues");
+      return true;
+   }
+   // one ChunkJob for each thread, including the calling thread
+   for(size_t iChunkJob = 0; iChunkJob <= cWorkersRequested; ++iChunkJob) {
+      ChunkJob * const pChunkJob = NewChunkJob();
+      if(UNLIKELY(nullptr == pChunkJob)) {
+         LOG_0(TraceLevelWarning, "WARNING ThreadPool::Initialize nullptr == pChunkJob");
+         return true;
+      }
+      FreeChunkJob(pChunkJob);
+   }
+   m_aWorkerThreads = new (std::nothrow) std::thread[cWorkersRequested];
+   if(UNLIKELY(nullptr == m_aWorkerThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Initialize nullptr == m_aWorkerThreads");
+      return true;
+   }
+
+   try {
+      // the workers take m_sleepMutex before they look at m_cWorkers, so holding it here until m_cWorkers is final publishes it to all of them
+      std::lock_guard<std::mutex> lock(m_sleepMutex);
+      size_t cWorkersStarted = 0;
+      try {
+         while(cWorkersStarted < cWorkersRequested) {
+            m_aWorkerThreads[cWorkersStarted] = std::thread(&ThreadPool::WorkerLoop, this, cWorkersStarted);
+            ++cWorkersStarted;
+         }
+      } catch(...) {
+         // the operating system might limit the number of threads that we can have.  We work with what we got
+         LOG_N(TraceLevelWarning, "WARNING ThreadPool::Initialize exception starting thread %zu of %zu", cWorkersStarted, cWorkersRequested);
+      }
+      m_cWorkers = cWorkersStarted;
+   } catch(...) {
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Initialize exception locking m_sleepMutex");
+      return true;
+   }
+   return false;
+}
+
+ThreadPool::~ThreadPool() {
+   LOG_0(TraceLevelInfo, "Entered ~ThreadPool");
+
+   if(nullptr != m_aWorkerThreads) {
+      try {
+         {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            // workers only exit once every queued task has been taken, so anything still queued here (like RunChunks helpers that arrived after
+            // their chunks were finished) still gets to release its resources
+            m_bStop = true;
+         }
+         m_sleepConditionVariable.notify_all();
+         for(size_t iWorker = 0; iWorker < m_cWorkers; ++iWorker) {
+            m_aWorkerThreads[iWorker].join();
+         }
+      } catch(...) {
+         LOG_0(TraceLevelWarning, "WARNING ~ThreadPool exception stopping threads");
+      }
+      delete[] m_aWorkerThreads;
+   }
+   delete[] m_aWorkerQueues;
+
+   // every worker has exited, so nothing can still be looking at a ChunkJob
+   ChunkJob * pChunkJob = m_pChunkJobAll;
+   while(nullptr != pChunkJob) {
+      ChunkJob * const pChunkJobNext = pChunkJob->m_pChunkJobNextAll;
+      delete pChunkJob;
+      pChunkJob = pChunkJobNext;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited ~ThreadPool");
+}
+
+bool ThreadPool::WorkerQueue::PushBack(const Task & task) {
+   if(UNLIKELY(m_cTasksCapacity == m_cTasks)) {
+      const size_t cTasksCapacity = 0 == m_cTasksCapacity ? k_cTasksPerWorkerQueueInitial : m_cTasksCapacity << 1;
+      if(UNLIKELY(cTasksCapacity <= m_cTasksCapacity)) {
+         LOG_0(TraceLevelWarning, "WARNING ThreadPool::WorkerQueue::PushBack cTasksCapacity <= m_cTasksCapacity");
+         return true;
+      }
+      Task * const aNewTasks = new (std::nothrow) Task[cTasksCapacity];
+      if(UNLIKELY(nullptr == aNewTasks)) {
+         LOG_0(TraceLevelWarning, "WARNING ThreadPool::WorkerQueue::PushBack nullptr == aNewTasks");
+         return true;
+      }
+      // unwrap the ring so that the oldest task is first
+      for(size_t iTask = 0; iTask < m_cTasks; ++iTask) {
+         size_t iTaskOld = m_iTaskFirst + iTask;
+         iTaskOld = m_cTasksCapacity <= iTaskOld ? iTaskOld - m_cTasksCapacity : iTaskOld;
+         aNewTasks[iTask] = m_aTasks[iTaskOld];
+      }
+      delete[] m_aTasks;
+      m_aTasks = aNewTasks;
+      m_cTasksCapacity = cTasksCapacity;
+      m_iTaskFirst = 0;
+   }
+   size_t iTask = m_iTaskFirst + m_cTasks;
+   iTask = m_cTasksCapacity <= iTask ? iTask - m_cTasksCapacity : iTask;
+   m_aTasks[iTask] = task;
+   ++m_cTasks;
+   return false;
+}
+
+bool ThreadPool::WorkerQueue::PopBack(Task * const pTask) {
+   if(0 == m_cTasks) {
+      return false;
+   }
+   --m_cTasks;
+   size_t iTask = m_iTaskFirst + m_cTasks;
+   iTask = m_cTasksCapacity <= iTask ? iTask - m_cTasksCapacity : iTask;
+   *pTask = m_aTasks[iTask];
+   return true;
+}
+
+bool ThreadPool::WorkerQueue::PopFront(Task * const pTask) {
+   if(0 == m_cTasks) {
+      return false;
+   }
+   *pTask = m_aTasks[m_iTaskFirst];
+   ++m_iTaskFirst;
+   m_iTaskFirst = m_cTasksCapacity == m_iTaskFirst ? size_t { 0 } : m_iTaskFirst;
+   --m_cTasks;
+   return true;
+}
+
+bool ThreadPool::TakeTask(const size_t iWorker, Task * const pTask) {
+   EBM_ASSERT(iWorker < m_cWorkers);
+   bool bFound = false;
+   {
+      // newest first from our own queue
+      WorkerQueue * const pWorkerQueue = &m_aWorkerQueues[iWorker];
+      std::lock_guard<std::mutex> lock(pWorkerQueue->m_mutex);
+      bFound = pWorkerQueue->PopBack(pTask);
+   }
+   for(size_t iOffset = 1; !bFound && iOffset < m_cWorkers; ++iOffset) {
+      // oldest first from everyone else's queue
+      size_t iVictim = iWorker + iOffset;
+      iVictim = m_cWorkers <= iVictim ? iVictim - m_cWorkers : iVictim;
+      WorkerQueue * const pWorkerQueue = &m_aWorkerQueues[iVictim];
+      std::lock_guard<std::mutex> lock(pWorkerQueue->m_mutex);
+      bFound = pWorkerQueue->PopFront(pTask);
+   }
+   if(bFound) {
+      std::lock_guard<std::mutex> lock(m_sleepMutex);
+      EBM_ASSERT(0 < m_cTasksPending);
+      --m_cTasksPending;
+   }
+   return bFound;
+}
+
+void ThreadPool::WorkerLoop(const size_t iWorker) {
+   try {
+      t_pThreadPoolCurrent = this;
+      t_iWorkerCurrent = iWorker;
+      {
+         // wait for Initialize to finish setting m_cWorkers
+         std::lock_guard<std::mutex> lock(m_sleepMutex);
+      }
+      while(true) {
+         Task task;
+         if(TakeTask(iWorker, &task)) {
+            (*task.m_pTaskFunction)(task.m_pTaskData);
+            continue;
+         }
+         std::unique_lock<std::mutex> lock(m_sleepMutex);
+         if(0 == m_cTasksPending) {
+            if(m_bStop) {
+               return;
+            }
+            m_sleepConditionVariable.wait(lock, [this] { return m_bStop || 0 != m_cTasksPending; });
+         } else {
+            // a task was counted but either hasn't been queued yet or was just taken by another worker that hasn't decremented the count yet
+            lock.unlock();
+            std::this_thread::yield();
+         }
+      }
+   } catch(...) {
+      // we can't let an exception escape a thread function.  Any tasks left in our queue will be stolen by the other workers
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::WorkerLoop exception");
+   }
+}
+
+bool ThreadPool::Submit(const TaskFunction pTaskFunction, void * const pTaskData) {
+   EBM_ASSERT(nullptr != pTaskFunction);
+   if(0 == m_cWorkers) {
+      return true;
+   }
+
+   size_t iWorker;
+   if(this == t_pThreadPoolCurrent) {
+      iWorker = t_iWorkerCurrent;
+   } else {
+      iWorker = m_iWorkerQueueNext.fetch_add(1) % m_cWorkers;
+   }
+   EBM_ASSERT(iWorker < m_cWorkers);
+
+   Task task;
+   task.m_pTaskFunction = pTaskFunction;
+   task.m_pTaskData = pTaskData;
+
+   bool bCounted = false;
+   bool bQueued = false;
+   try {
+      {
+         std::lock_guard<std::mutex> lock(m_sleepMutex);
+         ++m_cTasksPending;
+      }
+      bCounted = true;
+      WorkerQueue * const pWorkerQueue = &m_aWorkerQueues[iWorker];
+      std::lock_guard<std::mutex> lock(pWorkerQueue->m_mutex);
+      bQueued = !pWorkerQueue->PushBack(task);
+   } catch(...) {
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Submit exception queuing task");
+   }
+   if(UNLIKELY(!bQueued)) {
+      if(bCounted) {
+         try {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            --m_cTasksPending;
+         } catch(...) {
+         }
+      }
+      return true;
+   }
+   m_sleepConditionVariable.notify_one();
+   return false;
+}
+
+ThreadPool::ChunkJob * ThreadPool::NewChunkJob() {
+   ChunkJob * const pChunkJob = new (std::nothrow) ChunkJob();
+   if(nullptr != pChunkJob) {
+      try {
+         std::lock_guard<std::mutex> lock(m_chunkJobMutex);
+         pChunkJob->m_pChunkJobNextAll = m_pChunkJobAll;
+         m_pChunkJobAll = pChunkJob;
+      } catch(...) {
+         // nobody has seen this job yet, so we can still delete it
+         delete pChunkJob;
+         return nullptr;
+      }
+   }
+   return pChunkJob;
+}
+
+ThreadPool::ChunkJob * ThreadPool::AllocateChunkJob() {
+   try {
+      std::lock_guard<std::mutex> lock(m_chunkJobMutex);
+      ChunkJob * const pChunkJob = m_pChunkJobFree;
+      if(nullptr != pChunkJob) {
+         m_pChunkJobFree = pChunkJob->m_pChunkJobNextFree;
+         return pChunkJob;
+      }
+   } catch(...) {
+      return nullptr;
+   }
+   return NewChunkJob();
+}
+
+void ThreadPool::FreeChunkJob(ChunkJob * const pChunkJob) {
+   try {
+      std::lock_guard<std::mutex> lock(m_chunkJobMutex);
+      pChunkJob->m_pChunkJobNextFree = m_pChunkJobFree;
+      m_pChunkJobFree = pChunkJob;
+   } catch(...) {
+      // late helpers can still look at this job, so we can't delete it here.  It stays on m_pChunkJobAll and gets deleted with the pool
+   }
+}
+
+void ThreadPool::ProcessChunks(ChunkJob * const pChunkJob) {
+   uint64_t chunksState = pChunkJob->m_chunksState.load();
+   while(true) {
+      const size_t iChunk = static_cast<size_t>(chunksState & uint64_t { 0xFFFFFFFF });
+      const size_t cChunks = static_cast<size_t>(chunksState >> 32);
+      if(cChunks <= iChunk) {
+         return;
+      }
+      // if this fails then chunksState now holds the current state and we try again with that
+      if(pChunkJob->m_chunksState.compare_exchange_weak(chunksState, chunksState + 1)) {
+         (*pChunkJob->m_pChunkFunction)(pChunkJob->m_pChunkData, iChunk);
+         if(cChunks == pChunkJob->m_cChunksCompleted.fetch_add(1) + 1) {
+            try {
+               std::lock_guard<std::mutex> lock(pChunkJob->m_mutex);
+            } catch(...) {
+            }
+            pChunkJob->m_conditionVariable.notify_all();
+         }
+         chunksState = pChunkJob->m_chunksState.load();
+      }
+   }
+}
+
+void ThreadPool::RunChunkJob(void * pTaskData) {
+   ProcessChunks(static_cast<ChunkJob *>(pTaskData));
+}
+
+void ThreadPool::RunChunks(const size_t cThreads, const size_t cChunks, const ChunkFunction pChunkFunction, const void * const pChunkData) {
+   EBM_ASSERT(1 <= cThreads);
+   EBM_ASSERT(1 <= cChunks);
+   EBM_ASSERT(nullptr != pChunkFunction);
+
+   size_t cThreadsUsed = cChunks < cThreads ? cChunks : cThreads;
+   cThreadsUsed = GetCountThreads() < cThreadsUsed ? GetCountThreads() : cThreadsUsed;
+   if(1 < cThreadsUsed && cChunks <= k_cChunksMax) {
+      ChunkJob * const pChunkJob = AllocateChunkJob();
+      if(nullptr != pChunkJob) {
+         // every chunk of the last call that used this job was claimed, so no helper can look at anything but m_chunksState until we store it
+         pChunkJob->m_pChunkFunction = pChunkFunction;
+         pChunkJob->m_pChunkData = pChunkData;
+         pChunkJob->m_cChunksCompleted.store(0);
+         pChunkJob->m_chunksState.store(static_cast<uint64_t>(cChunks) << 32);
+         const size_t cHelpers = cThreadsUsed - 1;
+         for(size_t iHelper = 0; iHelper < cHelpers; ++iHelper) {
+            if(Submit(&RunChunkJob, pChunkJob)) {
+               // failing to queue a helper isn't an error since we pick up whatever chunks it would have taken
+               break;
+            }
+         }
+         ProcessChunks(pChunkJob);
+         try {
+            std::unique_lock<std::mutex> lock(pChunkJob->m_mutex);
+            pChunkJob->m_conditionVariable.wait(lock, [pChunkJob, cChunks] { return pChunkJob->m_cChunksCompleted.load() == cChunks; });
+         } catch(...) {
+            while(pChunkJob->m_cChunksCompleted.load() != cChunks) {
+               std::this_thread::yield();
+            }
+         }
+         FreeChunkJob(pChunkJob);
+         return;
+      }
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::RunChunks nullptr == pChunkJob");
+   }
+   for(size_t iChunk = 0; iChunk < cChunks; ++iChunk) {
+      (*pChunkFunction)(pChunkData, iChunk);
+   }
+}
@@ -0,0 +1,161 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+
+// a persistent pool of worker threads that is owned by an EbmTrainingState or EbmInteractionState and shared by every parallel kernel that runs on
+// behalf of that state.  Each worker has its own task queue.  A worker takes its newest task first (so nested work stays hot in its cache) and when its
+// own queue is empty it steals the oldest task from another worker's queue.  Tasks submitted from outside the pool are spread round robin between the
+// workers, while tasks submitted from inside a pool thread go to that thread's own queue.
+//
+// Tasks must not throw.  A task may block waiting on another task only if the caller guarantees that there are enough pool threads to run every task
+// that it could be waiting on at the same time.  Tasks submitted through RunChunks never block on other tasks.
+class ThreadPool final {
+public:
+   typedef void (* TaskFunction)(void * pTaskData);
+   typedef void (* ChunkFunction)(const void * pChunkData, const size_t iChunk);
+
+private:
+   struct Task final {
+      TaskFunction m_pTaskFunction;
+      void * m_pTaskData;
+   };
+
+   // a ring buffer of tasks that only ever grows, so once it has been through a few training steps queuing a task doesn't allocate
+   struct WorkerQueue final {
+      std::mutex m_mutex;
+      Task * m_aTasks;
+      size_t m_cTasksCapacity;
+      size_t m_iTaskFirst;
+      size_t m_cTasks;
+
+      EBM_INLINE WorkerQueue()
+         : m_mutex()
+         , m_aTasks(nullptr)
+         , m_cTasksCapacity(0)
+         , m_iTaskFirst(0)
+         , m_cTasks(0) {
+      }
+
+      EBM_INLINE ~WorkerQueue() {
+         delete[] m_aTasks;
+      }
+
+      // PushBack returns true if we're out of memory, in which case the task wasn't queued.  The Pop functions return true if they found a task
+      bool PushBack(const Task & task);
+      bool PopBack(Task * const pTask);
+      bool PopFront(Task * const pTask);
+   };
+
+   // the chunks of a single RunChunks call.  Helper tasks can start long after the calling thread has processed every chunk and returned, or even
+   // while the job is being used by a later RunChunks call, so jobs are never freed until the pool is, and a helper claims a chunk by changing
+   // m_chunksState from (iChunkNext, cChunks) to (iChunkNext + 1, cChunks) in one compare and swap.  A helper that arrives late either finds no
+   // chunks left and leaves without touching anything else, or it helps with whatever call is using the job now, which is just as useful.  The
+   // calling thread doesn't return until every claimed chunk has completed, so m_pChunkFunction and m_pChunkData are valid whenever a chunk has
+   // been claimed, and the job can go back to the free list as soon as its chunks are done instead of when its last helper runs
+   struct ChunkJob final {
+      // the next chunk to claim in the low 32 bits and the number of chunks in the high 32 bits
+      std::atomic<uint64_t> m_chunksState;
+      std::atomic<size_t> m_cChunksCompleted;
+      ChunkFunction m_pChunkFunction;
+      const void * m_pChunkData;
+      ChunkJob * m_pChunkJobNextFree;
+      ChunkJob * m_pChunkJobNextAll;
+      std::mutex m_mutex;
+      std::condition_variable m_conditionVariable;
+
+      EBM_INLINE ChunkJob()
+         : m_chunksState(0)
+         , m_cChunksCompleted(0)
+         , m_pChunkFunction(nullptr)
+         , m_pChunkData(nullptr)
+         , m_pChunkJobNextFree(nullptr)
+         , m_pChunkJobNextAll(nullptr)
+         , m_mutex()
+         , m_conditionVariable() {
+      }
+   };
+
+   // the number of pool threads.  The thread that calls into the library is not counted here, but it always works alongside the pool threads
+   size_t m_cWorkers;
+   WorkerQueue * m_aWorkerQueues;
+   std::thread * m_aWorkerThreads;
+
+   // m_cTasksPending is incremented before a task is queued, and decremented after a task is taken off a queue, so a worker that sees zero can sleep
+   std::mutex m_sleepMutex;
+   std::condition_variable m_sleepConditionVariable;
+   size_t m_cTasksPending;
+   bool m_bStop;
+
+   std::atomic<size_t> m_iWorkerQueueNext;
+
+   // every ChunkJob that we've made, and the ones that aren't being used by a RunChunks call right now.  Initialize makes one for each thread,
+   // since a thread can only be inside one RunChunks call at a time, so we only make more if a chunk function calls RunChunks itself
+   std::mutex m_chunkJobMutex;
+   ChunkJob * m_pChunkJobAll;
+   ChunkJob * m_pChunkJobFree;
+
+   EBM_INLINE ThreadPool()
+      : m_cWorkers(0)
+      , m_aWorkerQueues(nullptr)
+      , m_aWorkerThreads(nullptr)
+      , m_sleepMutex()
+      , m_sleepConditionVariable()
+      , m_cTasksPending(0)
+      , m_bStop(false)
+      , m_iWorkerQueueNext(0)
+      , m_chunkJobMutex()
+      , m_pChunkJobAll(nullptr)
+      , m_pChunkJobFree(nullptr) {
+   }
+
+   ~ThreadPool();
+
+   bool Initialize(const size_t cWorkersRequested);
+   bool TakeTask(const size_t iWorker, Task * const pTask);
+   void WorkerLoop(const size_t iWorker);
+   ChunkJob * NewChunkJob();
+   ChunkJob * AllocateChunkJob();
+   void FreeChunkJob(ChunkJob * const pChunkJob);
+   static void RunChunkJob(void * pTaskData);
+   static void ProcessChunks(ChunkJob * const pChunkJob);
+
+public:
+
+   // cThreads includes the calling thread, so a pool for 1 thread has no pool threads and runs everything serially on the caller.  If the operating
+   // system refuses to start some of the threads we keep the ones we have, so callers should use GetCountThreads instead of the count they asked for
+   static ThreadPool * Allocate(const size_t cThreads);
+   static void Free(ThreadPool * const pThreadPool);
+
+   EBM_INLINE static size_t GetCountHardwareThreads() {
+      // hardware_concurrency is noexcept, and it returns 0 if the number of hardware threads is not computable
+      const unsigned int cHardwareThreads = std::thread::hardware_concurrency();
+      return 0 == cHardwareThreads ? size_t { 1 } : static_cast<size_t>(cHardwareThreads);
+   }
+
+   // the number of threads that can work at the same time, including the calling thread
+   EBM_INLINE size_t GetCountThreads() const {
+      return m_cWorkers + 1;
+   }
+
+   // returns true on error, in which case pTaskFunction will never be called
+   bool Submit(const TaskFunction pTaskFunction, void * const pTaskData);
+
+   // calls pChunkFunction(pChunkData, iChunk) once for each iChunk in [0, cChunks) using up to cThreads threads, including the calling thread,
+   // and returns once every chunk has completed.  Chunks are processed in no particular order and on no particular thread
+   void RunChunks(const size_t cThreads, const size_t cChunks, const ChunkFunction pChunkFunction, const void * const pChunkData);
+};
+
+#endif // THREAD_POOL_H
@@ -8,6 +8,9 @@
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // numeric_limits
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "ebmcore.h"
 
@@ -18,6 +21,7 @@
 #include "RandomStream.h"
 #include "SegmentedTensor.h"
 #include "EbmStatistics.h"
+#include "IsaKernels.h" // g_pIsaKernels
 // this depends on TreeNode pointers, but doesn't require the full definition of TreeNode
 #include "CachedThreadResources.h"
 // feature includes
@@ -25,14 +29,18 @@
 // FeatureCombination.h depends on FeatureInternal.h
 #include "FeatureCombinationCore.h"
 // dataset depends on features
+#include "BinnedDataView.h"
 #include "DataSetByFeatureCombination.h"
+#include "EbmDataSet.h"
 // samples is somewhat independent from datasets, but relies on an indirect coupling with them
 #include "SamplingWithReplacement.h"
+#include "ParallelChunks.h"
 // TreeNode depends on almost everything
 #include "DimensionSingle.h"
 #include "DimensionMultiple.h"
 
 #include "EbmTrainingState.h"
+#include "EbmModel.h"
 
 void EbmTrainingState::DeleteSegmentedTensors(const size_t cFeatureCombinations, SegmentedTensor<ActiveDataType, FractionalDataType> ** const apSegmentedTensors) {
    LOG_0(TraceLevelInfo, "Entered DeleteSegmentedTensors");
@@ -50,7 +58,7 @@ void EbmTrainingState::DeleteSegmentedTensors(const size_t cFeatureCombinations,
    LOG_0(TraceLevelInfo, "Exited DeleteSegmentedTensors");
 }
 
-SegmentedTensor<ActiveDataType, FractionalDataType> ** EbmTrainingState::InitializeSegmentedTensors(const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations, const size_t cVectorLength) {
+SegmentedTensor<ActiveDataType, FractionalDataType> ** EbmTrainingState::InitializeSegmentedTensors(ArenaAllocator * const pArena, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations, const size_t cVectorLength) {
    LOG_0(TraceLevelInfo, "Entered InitializeSegmentedTensors");
 
    EBM_ASSERT(0 < cFeatureCombinations);
@@ -67,7 +75,7 @@ SegmentedTensor<ActiveDataType, FractionalDataType> ** EbmTrainingState::Initial
    SegmentedTensor<ActiveDataType, FractionalDataType> ** ppSegmentedTensors = apSegmentedTensors;
    for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
       const FeatureCombinationCore * const pFeatureCombination = apFeatureCombinations[iFeatureCombination];
-      SegmentedTensor<ActiveDataType, FractionalDataType> * const pSegmentedTensors = SegmentedTensor<ActiveDataType, FractionalDataType>::Allocate(pFeatureCombination->m_cFeatures, cVectorLength);
+      SegmentedTensor<ActiveDataType, FractionalDataType> * const pSegmentedTensors = SegmentedTensor<ActiveDataType, FractionalDataType>::Allocate(pArena, pFeatureCombination->m_cFeatures, cVectorLength);
       if(UNLIKELY(nullptr == pSegmentedTensors)) {
          LOG_0(TraceLevelWarning, "WARNING InitializeSegmentedTensors nullptr == pSegmentedTensors");
          DeleteSegmentedTensors(cFeatureCombinations, apSegmentedTensors);
@@ -106,182 +114,374 @@ SegmentedTensor<ActiveDataType, FractionalDataType> ** EbmTrainingState::Initial
    return apSegmentedTensors;
 }
 
-bool EbmTrainingState::Initialize(const IntegerDataType randomSeed, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const IntegerDataType * const aTrainingBinnedData, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const IntegerDataType * const aValidationBinnedData, const FractionalDataType * const aValidationPredictorScores) {
-   LOG_0(TraceLevelInfo, "Entered EbmTrainingState::Initialize");
-   try {
-      if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
-         if(m_cachedThreadResourcesUnion.regression.IsError()) {
-            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize m_cachedThreadResourcesUnion.regression.IsError()");
-            return true;
-         }
-      } else {
-         EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
-         if(m_cachedThreadResourcesUnion.classification.IsError()) {
-            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize m_cachedThreadResourcesUnion.classification.IsError()");
-            return true;
+void EbmTrainingState::DeleteAdditionalWorkers() {
+   LOG_0(TraceLevelInfo, "Entered DeleteAdditionalWorkers");
+
+   EBM_ASSERT(1 <= m_cWorkerThreads);
+   const size_t cAdditionalWorkers = m_cWorkerThreads - 1;
+   if(nullptr != m_apAdditionalWorkerCachedThreadResources) {
+      EBM_ASSERT(0 < cAdditionalWorkers);
+      for(size_t iAdditionalWorker = 0; iAdditionalWorker < cAdditionalWorkers; ++iAdditionalWorker) {
+         CachedThreadResourcesUnion * const pCachedThreadResourcesUnion = m_apAdditionalWorkerCachedThreadResources[iAdditionalWorker];
+         if(nullptr != pCachedThreadResourcesUnion) {
+            pCachedThreadResourcesUnion->DestroyMember(m_runtimeLearningTypeOrCountTargetClasses);
+            delete pCachedThreadResourcesUnion;
          }
       }
+      delete[] m_apAdditionalWorkerCachedThreadResources;
+   }
+   if(nullptr != m_apAdditionalWorkerSmallChangeToModelOverwrite) {
+      EBM_ASSERT(0 < cAdditionalWorkers);
+      for(size_t iAdditionalWorker = 0; iAdditionalWorker < cAdditionalWorkers; ++iAdditionalWorker) {
+         SegmentedTensor<ActiveDataType, FractionalDataType>::Free(m_apAdditionalWorkerSmallChangeToModelOverwrite[iAdditionalWorker]);
+      }
+      delete[] m_apAdditionalWorkerSmallChangeToModelOverwrite;
+   }
+   m_apAdditionalWorkerCachedThreadResources = nullptr;
+   m_apAdditionalWorkerSmallChangeToModelOverwrite = nullptr;
+
+   LOG_0(TraceLevelInfo, "Exited DeleteAdditionalWorkers");
+}
+
+bool EbmTrainingState::InitializeAdditionalWorkers() {
+   LOG_0(TraceLevelInfo, "Entered InitializeAdditionalWorkers");
+
+   EBM_ASSERT(1 <= m_cWorkerThreads);
+   EBM_ASSERT(nullptr == m_apAdditionalWorkerCachedThreadResources);
+   EBM_ASSERT(nullptr == m_apAdditionalWorkerSmallChangeToModelOverwrite);
+   const size_t cAdditionalWorkers = m_cWorkerThreads - 1;
+   if(0 != cAdditionalWorkers) {
+      const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
 
-      if(0 != m_cFeatures && nullptr == m_aFeatures) {
-         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize 0 != m_cFeatures && nullptr == m_aFeatures");
+      m_apAdditionalWorkerCachedThreadResources = new (std::nothrow) CachedThreadResourcesUnion *[cAdditionalWorkers];
+      if(UNLIKELY(nullptr == m_apAdditionalWorkerCachedThreadResources)) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeAdditionalWorkers nullptr == m_apAdditionalWorkerCachedThreadResources");
          return true;
       }
+      memset(m_apAdditionalWorkerCachedThreadResources, 0, sizeof(*m_apAdditionalWorkerCachedThreadResources) * cAdditionalWorkers); // this needs to be done immediately after allocation otherwise we might attempt to free random garbage on an error
 
-      if(UNLIKELY(0 != m_cFeatureCombinations && nullptr == m_apFeatureCombinations)) {
-         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize 0 != m_cFeatureCombinations && nullptr == m_apFeatureCombinations");
+      m_apAdditionalWorkerSmallChangeToModelOverwrite = new (std::nothrow) SegmentedTensor<ActiveDataType, FractionalDataType> *[cAdditionalWorkers];
+      if(UNLIKELY(nullptr == m_apAdditionalWorkerSmallChangeToModelOverwrite)) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeAdditionalWorkers nullptr == m_apAdditionalWorkerSmallChangeToModelOverwrite");
          return true;
       }
+      memset(m_apAdditionalWorkerSmallChangeToModelOverwrite, 0, sizeof(*m_apAdditionalWorkerSmallChangeToModelOverwrite) * cAdditionalWorkers); // this needs to be done immediately after allocation otherwise we might attempt to free random garbage on an error
 
-      if(UNLIKELY(nullptr == m_pSmallChangeToModelOverwriteSingleSamplingSet)) {
-         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pSmallChangeToModelOverwriteSingleSamplingSet");
-         return true;
+      for(size_t iAdditionalWorker = 0; iAdditionalWorker < cAdditionalWorkers; ++iAdditionalWorker) {
+         // the CachedThreadResourcesUnion constructor catches any exceptions, so this should not be able to throw
+         CachedThreadResourcesUnion * const pCachedThreadResourcesUnion = new (std::nothrow) CachedThreadResourcesUnion(m_runtimeLearningTypeOrCountTargetClasses);
+         if(UNLIKELY(nullptr == pCachedThreadResourcesUnion)) {
+            LOG_0(TraceLevelWarning, "WARNING InitializeAdditionalWorkers nullptr == pCachedThreadResourcesUnion");
+            return true;
+         }
+         m_apAdditionalWorkerCachedThreadResources[iAdditionalWorker] = pCachedThreadResourcesUnion;
+         if(UNLIKELY(pCachedThreadResourcesUnion->IsError(m_runtimeLearningTypeOrCountTargetClasses))) {
+            LOG_0(TraceLevelWarning, "WARNING InitializeAdditionalWorkers pCachedThreadResourcesUnion->IsError(m_runtimeLearningTypeOrCountTargetClasses)");
+            return true;
+         }
+
+         SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwrite = SegmentedTensor<ActiveDataType, FractionalDataType>::Allocate(k_cDimensionsMax, cVectorLength);
+         if(UNLIKELY(nullptr == pSmallChangeToModelOverwrite)) {
+            LOG_0(TraceLevelWarning, "WARNING InitializeAdditionalWorkers nullptr == pSmallChangeToModelOverwrite");
+            return true;
+         }
+         m_apAdditionalWorkerSmallChangeToModelOverwrite[iAdditionalWorker] = pSmallChangeToModelOverwrite;
+      }
+   }
+
+   LOG_0(TraceLevelInfo, "Exited InitializeAdditionalWorkers");
+   return false;
+}
+
+bool EbmTrainingState::SetCountThreads(const size_t cThreads) {
+   LOG_N(TraceLevelInfo, "Entered EbmTrainingState::SetCountThreads: cThreads=%zu", cThreads);
+
+   EBM_ASSERT(1 <= cThreads);
+
+   // the pool threads only run tasks while we're inside a call that is waiting on them, so there is nothing running right now
+   ThreadPool::Free(m_pThreadPool);
+   m_pThreadPool = nullptr;
+   DeleteAdditionalWorkers();
+   m_cThreads = 1;
+   m_cWorkerThreads = 1;
+   m_cBinningThreadsPerWorker = 1;
+
+   ThreadPool * const pThreadPool = ThreadPool::Allocate(cThreads);
+   if(UNLIKELY(nullptr == pThreadPool)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::SetCountThreads nullptr == pThreadPool");
+      return true;
+   }
+   m_pThreadPool = pThreadPool;
+   m_cThreads = pThreadPool->GetCountThreads();
+   // a worker that trains sampling sets can block while it waits for its turn to merge, so we never have more additional workers than pool threads
+   m_cWorkerThreads = GetCountWorkerThreads(m_cThreads, m_cSamplingSets);
+   if(UNLIKELY(InitializeAdditionalWorkers())) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::SetCountThreads InitializeAdditionalWorkers()");
+      // leave ourselves in a state where we can still train on the calling thread
+      DeleteAdditionalWorkers();
+      m_cWorkerThreads = 1;
+      m_cBinningThreadsPerWorker = m_cThreads;
+      return true;
+   }
+   // any threads that aren't needed to train whole sampling sets are shared out between the workers to bin their sampling sets in chunks
+   m_cBinningThreadsPerWorker = m_cThreads / m_cWorkerThreads;
+
+   LOG_0(TraceLevelInfo, "Exited EbmTrainingState::SetCountThreads");
+   return false;
+}
+
+bool EbmTrainingState::SetPrecomputedDenominators(const bool bPrecomputedDenominators) {
+   LOG_N(TraceLevelInfo, "Entered EbmTrainingState::SetPrecomputedDenominators: bPrecomputedDenominators=%d", static_cast<int>(bPrecomputedDenominators));
+
+   // regression has no denominators, and without training instances there is nothing to bin
+   if(IsClassification(m_runtimeLearningTypeOrCountTargetClasses) && nullptr != m_pTrainingSet) {
+      if(bPrecomputedDenominators) {
+         if(UNLIKELY(m_pTrainingSet->AllocateDenominators(GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses)))) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::SetPrecomputedDenominators m_pTrainingSet->AllocateDenominators(...)");
+            return true;
+         }
+      } else {
+         m_pTrainingSet->FreeDenominators();
       }
+   }
 
-      if(UNLIKELY(nullptr == m_pSmallChangeToModelAccumulatedFromSamplingSets)) {
-         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pSmallChangeToModelAccumulatedFromSamplingSets");
+   LOG_0(TraceLevelInfo, "Exited EbmTrainingState::SetPrecomputedDenominators");
+   return false;
+}
+
+bool EbmTrainingState::InitializeFeatures(const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cInstances) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingState::InitializeFeatures");
+   // cInstances is only used to check the bin counts in debug builds
+   UNUSED(cInstances);
+
+   if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
+      if(m_cachedThreadResourcesUnion.regression.IsError()) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize m_cachedThreadResourcesUnion.regression.IsError()");
          return true;
       }
+   } else {
+      EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
+      if(m_cachedThreadResourcesUnion.classification.IsError()) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize m_cachedThreadResourcesUnion.classification.IsError()");
+         return true;
+      }
+   }
 
-      LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize starting feature processing");
-      if(0 != m_cFeatures) {
-         EBM_ASSERT(!IsMultiplyError(m_cFeatures, sizeof(*aFeatures))); // if this overflows then our caller should not have been able to allocate the array
-         const EbmCoreFeature * pFeatureInitialize = aFeatures;
-         const EbmCoreFeature * const pFeatureEnd = &aFeatures[m_cFeatures];
-         EBM_ASSERT(pFeatureInitialize < pFeatureEnd);
-         size_t iFeatureInitialize = 0;
-         do {
-            static_assert(FeatureTypeCore::OrdinalCore == static_cast<FeatureTypeCore>(FeatureTypeOrdinal), "FeatureTypeCore::OrdinalCore must have the same value as FeatureTypeOrdinal");
-            static_assert(FeatureTypeCore::NominalCore == static_cast<FeatureTypeCore>(FeatureTypeNominal), "FeatureTypeCore::NominalCore must have the same value as FeatureTypeNominal");
-            EBM_ASSERT(FeatureTypeOrdinal == pFeatureInitialize->featureType || FeatureTypeNominal == pFeatureInitialize->featureType);
-            FeatureTypeCore featureTypeCore = static_cast<FeatureTypeCore>(pFeatureInitialize->featureType);
-
-            IntegerDataType countBins = pFeatureInitialize->countBins;
-            EBM_ASSERT(0 <= countBins); // we can handle 1 == cBins or 0 == cBins even though that's a degenerate case that shouldn't be trained on (dimensions with 1 bin don't contribute anything since they always have the same value).  0 cases could only occur if there were zero training and zero validation cases since the features would require a value, even if it was 0
-            if(!IsNumberConvertable<size_t, IntegerDataType>(countBins)) {
-               LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize !IsNumberConvertable<size_t, IntegerDataType>(countBins)");
-               return true;
-            }
-            size_t cBins = static_cast<size_t>(countBins);
-            if(cBins <= 1) {
-               EBM_ASSERT(0 != cBins || 0 == cTrainingInstances && 0 == cValidationInstances);
-               LOG_0(TraceLevelInfo, "INFO EbmTrainingState::Initialize feature with 0/1 values");
-            }
+   if(0 != m_cFeatures && nullptr == m_aFeatures) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize 0 != m_cFeatures && nullptr == m_aFeatures");
+      return true;
+   }
 
-            EBM_ASSERT(0 == pFeatureInitialize->hasMissing || 1 == pFeatureInitialize->hasMissing);
-            bool bMissing = 0 != pFeatureInitialize->hasMissing;
+   if(UNLIKELY(0 != m_cFeatureCombinations && nullptr == m_apFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize 0 != m_cFeatureCombinations && nullptr == m_apFeatureCombinations");
+      return true;
+   }
 
-            // this is an in-place new, so there is no new memory allocated, and we already knew where it was going, so we don't need the resulting pointer returned
-            new (&m_aFeatures[iFeatureInitialize]) FeatureCore(cBins, iFeatureInitialize, featureTypeCore, bMissing);
-            // we don't allocate memory and our constructor doesn't have errors, so we shouldn't have an error here
+   if(UNLIKELY(nullptr == m_pSmallChangeToModelOverwriteSingleSamplingSet)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pSmallChangeToModelOverwriteSingleSamplingSet");
+      return true;
+   }
 
-            EBM_ASSERT(0 == pFeatureInitialize->hasMissing); // TODO : implement this, then remove this assert
-            EBM_ASSERT(FeatureTypeOrdinal == pFeatureInitialize->featureType); // TODO : implement this, then remove this assert
+   if(UNLIKELY(nullptr == m_pSmallChangeToModelAccumulatedFromSamplingSets)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pSmallChangeToModelAccumulatedFromSamplingSets");
+      return true;
+   }
 
-            ++iFeatureInitialize;
-            ++pFeatureInitialize;
-         } while(pFeatureEnd != pFeatureInitialize);
-      }
-      LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize done feature processing");
+   if(UNLIKELY(SetCountThreads(m_cThreads))) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize SetCountThreads(m_cThreads)");
+      return true;
+   }
 
-      LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize starting feature combination processing");
-      if(0 != m_cFeatureCombinations) {
-         const IntegerDataType * pFeatureCombinationIndex = featureCombinationIndexes;
-         size_t iFeatureCombination = 0;
-         do {
-            const EbmCoreFeatureCombination * const pFeatureCombinationInterop = &aFeatureCombinations[iFeatureCombination];
+   LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize starting feature processing");
+   if(0 != m_cFeatures) {
+      EBM_ASSERT(!IsMultiplyError(m_cFeatures, sizeof(*aFeatures))); // if this overflows then our caller should not have been able to allocate the array
+      const EbmCoreFeature * pFeatureInitialize = aFeatures;
+      const EbmCoreFeature * const pFeatureEnd = &aFeatures[m_cFeatures];
+      EBM_ASSERT(pFeatureInitialize < pFeatureEnd);
+      size_t iFeatureInitialize = 0;
+      do {
+         static_assert(FeatureTypeCore::OrdinalCore == static_cast<FeatureTypeCore>(FeatureTypeOrdinal), "FeatureTypeCore::OrdinalCore must have the same value as FeatureTypeOrdinal");
+         static_assert(FeatureTypeCore::NominalCore == static_cast<FeatureTypeCore>(FeatureTypeNominal), "FeatureTypeCore::NominalCore must have the same value as FeatureTypeNominal");
+         EBM_ASSERT(FeatureTypeOrdinal == pFeatureInitialize->featureType || FeatureTypeNominal == pFeatureInitialize->featureType);
+         FeatureTypeCore featureTypeCore = static_cast<FeatureTypeCore>(pFeatureInitialize->featureType);
+
+         IntegerDataType countBins = pFeatureInitialize->countBins;
+         EBM_ASSERT(0 <= countBins); // we can handle 1 == cBins or 0 == cBins even though that's a degenerate case that shouldn't be trained on (dimensions with 1 bin don't contribute anything since they always have the same value).  0 cases could only occur if there were zero training and zero validation cases since the features would require a value, even if it was 0
+         if(!IsNumberConvertable<size_t, IntegerDataType>(countBins)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize !IsNumberConvertable<size_t, IntegerDataType>(countBins)");
+            return true;
+         }
+         size_t cBins = static_cast<size_t>(countBins);
+         if(cBins <= 1) {
+            EBM_ASSERT(0 != cBins || 0 == cInstances);
+            LOG_0(TraceLevelInfo, "INFO EbmTrainingState::Initialize feature with 0/1 values");
+         }
 
-            IntegerDataType countFeaturesInCombination = pFeatureCombinationInterop->countFeaturesInCombination;
-            EBM_ASSERT(0 <= countFeaturesInCombination);
-            if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
-               LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
-               return true;
-            }
-            size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
-            size_t cSignificantFeaturesInCombination = 0;
-            const IntegerDataType * const pFeatureCombinationIndexEnd = pFeatureCombinationIndex + cFeaturesInCombination;
-            if(UNLIKELY(0 == cFeaturesInCombination)) {
-               LOG_0(TraceLevelInfo, "INFO EbmTrainingState::Initialize empty feature combination");
-            } else {
-               EBM_ASSERT(nullptr != featureCombinationIndexes);
-               const IntegerDataType * pFeatureCombinationIndexTemp = pFeatureCombinationIndex;
-               do {
-                  const IntegerDataType indexFeatureInterop = *pFeatureCombinationIndexTemp;
-                  EBM_ASSERT(0 <= indexFeatureInterop);
-                  if(!IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop)) {
-                     LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize !IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop)");
-                     return true;
-                  }
-                  const size_t iFeatureForCombination = static_cast<size_t>(indexFeatureInterop);
-                  EBM_ASSERT(iFeatureForCombination < m_cFeatures);
-                  FeatureCore * const pInputFeature = &m_aFeatures[iFeatureForCombination];
-                  if(LIKELY(1 < pInputFeature->m_cBins)) {
-                     // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is otherwise indistinquishable from the original data
-                     ++cSignificantFeaturesInCombination;
-                  } else {
-                     LOG_0(TraceLevelInfo, "INFO EbmTrainingState::Initialize feature combination with no useful features");
-                  }
-                  ++pFeatureCombinationIndexTemp;
-               } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndexTemp);
+         EBM_ASSERT(0 == pFeatureInitialize->hasMissing || 1 == pFeatureInitialize->hasMissing);
+         bool bMissing = 0 != pFeatureInitialize->hasMissing;
+
+         // this is an in-place new, so there is no new memory allocated, and we already knew where it was going, so we don't need the resulting pointer returned
+         new (&m_aFeatures[iFeatureInitialize]) FeatureCore(cBins, iFeatureInitialize, featureTypeCore, bMissing);
+         // we don't allocate memory and our constructor doesn't have errors, so we shouldn't have an error here
 
-               if(k_cDimensionsMax < cSignificantFeaturesInCombination) {
-                  // if we try to run with more than k_cDimensionsMax we'll exceed our memory capacity, so let's exit here instead
-                  LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize k_cDimensionsMax < cSignificantFeaturesInCombination");
+         EBM_ASSERT(0 == pFeatureInitialize->hasMissing); // TODO : implement this, then remove this assert
+         EBM_ASSERT(FeatureTypeOrdinal == pFeatureInitialize->featureType); // TODO : implement this, then remove this assert
+
+         ++iFeatureInitialize;
+         ++pFeatureInitialize;
+      } while(pFeatureEnd != pFeatureInitialize);
+   }
+   LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize done feature processing");
+
+   LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize starting feature combination processing");
+   if(0 != m_cFeatureCombinations) {
+      const IntegerDataType * pFeatureCombinationIndex = featureCombinationIndexes;
+      size_t iFeatureCombination = 0;
+      do {
+         const EbmCoreFeatureCombination * const pFeatureCombinationInterop = &aFeatureCombinations[iFeatureCombination];
+
+         IntegerDataType countFeaturesInCombination = pFeatureCombinationInterop->countFeaturesInCombination;
+         EBM_ASSERT(0 <= countFeaturesInCombination);
+         if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
+            return true;
+         }
+         size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
+         size_t cSignificantFeaturesInCombination = 0;
+         const IntegerDataType * const pFeatureCombinationIndexEnd = pFeatureCombinationIndex + cFeaturesInCombination;
+         if(UNLIKELY(0 == cFeaturesInCombination)) {
+            LOG_0(TraceLevelInfo, "INFO EbmTrainingState::Initialize empty feature combination");
+         } else {
+            EBM_ASSERT(nullptr != featureCombinationIndexes);
+            const IntegerDataType * pFeatureCombinationIndexTemp = pFeatureCombinationIndex;
+            do {
+               const IntegerDataType indexFeatureInterop = *pFeatureCombinationIndexTemp;
+               EBM_ASSERT(0 <= indexFeatureInterop);
+               if(!IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop)) {
+                  LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize !IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop)");
                   return true;
                }
-            }
+               const size_t iFeatureForCombination = static_cast<size_t>(indexFeatureInterop);
+               EBM_ASSERT(iFeatureForCombination < m_cFeatures);
+               FeatureCore * const pInputFeature = &m_aFeatures[iFeatureForCombination];
+               if(LIKELY(1 < pInputFeature->m_cBins)) {
+                  // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is otherwise indistinquishable from the original data
+                  ++cSignificantFeaturesInCombination;
+               } else {
+                  LOG_0(TraceLevelInfo, "INFO EbmTrainingState::Initialize feature combination with no useful features");
+               }
+               ++pFeatureCombinationIndexTemp;
+            } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndexTemp);
 
-            FeatureCombinationCore * pFeatureCombination = FeatureCombinationCore::Allocate(cSignificantFeaturesInCombination, iFeatureCombination);
-            if(nullptr == pFeatureCombination) {
-               LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == pFeatureCombination");
+            if(k_cDimensionsMax < cSignificantFeaturesInCombination) {
+               // if we try to run with more than k_cDimensionsMax we'll exceed our memory capacity, so let's exit here instead
+               LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize k_cDimensionsMax < cSignificantFeaturesInCombination");
                return true;
             }
-            // assign our pointer directly to our array right now so that we can't loose the memory if we decide to exit due to an error below
-            m_apFeatureCombinations[iFeatureCombination] = pFeatureCombination;
+         }
 
-            if(LIKELY(0 == cSignificantFeaturesInCombination)) {
-               // move our index forward to the next feature.  
-               // We won't be executing the loop below that would otherwise increment it by the number of features in this feature combination
-               pFeatureCombinationIndex = pFeatureCombinationIndexEnd;
-            } else {
-               EBM_ASSERT(nullptr != featureCombinationIndexes);
-               size_t cTensorBins = 1;
-               FeatureCombinationCore::FeatureCombinationEntry * pFeatureCombinationEntry = &pFeatureCombination->m_FeatureCombinationEntry[0];
-               do {
-                  const IntegerDataType indexFeatureInterop = *pFeatureCombinationIndex;
-                  EBM_ASSERT(0 <= indexFeatureInterop);
-                  EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop))); // this was checked above
-                  const size_t iFeatureForCombination = static_cast<size_t>(indexFeatureInterop);
-                  EBM_ASSERT(iFeatureForCombination < m_cFeatures);
-                  const FeatureCore * const pInputFeature = &m_aFeatures[iFeatureForCombination];
-                  const size_t cBins = pInputFeature->m_cBins;
-                  if(LIKELY(1 < cBins)) {
-                     // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is otherwise indistinquishable from the original data
-                     pFeatureCombinationEntry->m_pFeature = pInputFeature;
-                     ++pFeatureCombinationEntry;
-                     if(IsMultiplyError(cTensorBins, cBins)) {
-                        // if this overflows, we definetly won't be able to allocate it
-                        LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize IsMultiplyError(cTensorStates, cBins)");
-                        return true;
-                     }
-                     cTensorBins *= cBins;
+         FeatureCombinationCore * pFeatureCombination = FeatureCombinationCore::Allocate(&m_arena, cSignificantFeaturesInCombination, iFeatureCombination);
+         if(nullptr == pFeatureCombination) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == pFeatureCombination");
+            return true;
+         }
+         // assign our pointer directly to our array right now so that we can't loose the memory if we decide to exit due to an error below
+         m_apFeatureCombinations[iFeatureCombination] = pFeatureCombination;
+
+         if(LIKELY(0 == cSignificantFeaturesInCombination)) {
+            // move our index forward to the next feature.  
+            // We won't be executing the loop below that would otherwise increment it by the number of features in this feature combination
+            pFeatureCombinationIndex = pFeatureCombinationIndexEnd;
+         } else {
+            EBM_ASSERT(nullptr != featureCombinationIndexes);
+            size_t cTensorBins = 1;
+            FeatureCombinationCore::FeatureCombinationEntry * pFeatureCombinationEntry = &pFeatureCombination->m_FeatureCombinationEntry[0];
+            do {
+               const IntegerDataType indexFeatureInterop = *pFeatureCombinationIndex;
+               EBM_ASSERT(0 <= indexFeatureInterop);
+               EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop))); // this was checked above
+               const size_t iFeatureForCombination = static_cast<size_t>(indexFeatureInterop);
+               EBM_ASSERT(iFeatureForCombination < m_cFeatures);
+               const FeatureCore * const pInputFeature = &m_aFeatures[iFeatureForCombination];
+               const size_t cBins = pInputFeature->m_cBins;
+               if(LIKELY(1 < cBins)) {
+                  // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is otherwise indistinquishable from the original data
+                  pFeatureCombinationEntry->m_pFeature = pInputFeature;
+                  ++pFeatureCombinationEntry;
+                  if(IsMultiplyError(cTensorBins, cBins)) {
+                     // if this overflows, we definetly won't be able to allocate it
+                     LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize IsMultiplyError(cTensorStates, cBins)");
+                     return true;
                   }
-                  ++pFeatureCombinationIndex;
-               } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndex);
-               // if cSignificantFeaturesInCombination is zero, don't both initializing pFeatureCombination->m_cItemsPerBitPackDataUnit
-               const size_t cBitsRequiredMin = CountBitsRequiredCore(cTensorBins - 1);
-               pFeatureCombination->m_cItemsPerBitPackDataUnit = GetCountItemsBitPacked(cBitsRequiredMin);
-            }
-            ++iFeatureCombination;
-         } while(iFeatureCombination < m_cFeatureCombinations);
+                  cTensorBins *= cBins;
+               }
+               ++pFeatureCombinationIndex;
+            } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndex);
+            // if cSignificantFeaturesInCombination is zero, don't both initializing pFeatureCombination->m_cItemsPerBitPackDataUnit
+            const size_t cBitsRequiredMin = CountBitsRequiredCore(cTensorBins - 1);
+            pFeatureCombination->m_cItemsPerBitPackDataUnit = GetCountItemsBitPacked(cBitsRequiredMin);
+         }
+         ++iFeatureCombination;
+      } while(iFeatureCombination < m_cFeatureCombinations);
+   }
+   LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize finished feature combination processing");
+
+   LOG_0(TraceLevelInfo, "Exited EbmTrainingState::InitializeFeatures");
+   return false;
+}
+
+bool EbmTrainingState::InitializeModels() {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingState::InitializeModels");
+
+   EBM_ASSERT(nullptr == m_apCurrentModel);
+   EBM_ASSERT(nullptr == m_apBestModel);
+   if(0 != m_cFeatureCombinations && (IsRegression(m_runtimeLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } <= m_runtimeLearningTypeOrCountTargetClasses)) {
+      const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
+      m_apCurrentModel = InitializeSegmentedTensors(&m_arena, m_cFeatureCombinations, m_apFeatureCombinations, cVectorLength);
+      if(nullptr == m_apCurrentModel) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeModels nullptr == m_apCurrentModel");
+         return true;
+      }
+      m_apBestModel = InitializeSegmentedTensors(&m_arena, m_cFeatureCombinations, m_apFeatureCombinations, cVectorLength);
+      if(nullptr == m_apBestModel) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeModels nullptr == m_apBestModel");
+         return true;
+      }
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmTrainingState::InitializeModels");
+   return false;
+}
+
+void EbmTrainingState::InitializeTrainingResiduals(const size_t cTrainingInstances, const void * const aTrainingTargets, const FractionalDataType * const aTrainingPredictorScores) {
+   EBM_ASSERT(0 < cTrainingInstances);
+   EBM_ASSERT(nullptr != m_pTrainingSet);
+   if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
+      InitializeResiduals<k_Regression>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), k_Regression);
+   } else {
+      EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
+      if(size_t { 2 } == static_cast<size_t>(m_runtimeLearningTypeOrCountTargetClasses)) {
+         InitializeResiduals<2>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), 2);
+      } else {
+         InitializeResiduals<k_DynamicClassification>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), m_runtimeLearningTypeOrCountTargetClasses);
+      }
+   }
+}
+
+bool EbmTrainingState::Initialize(const IntegerDataType randomSeed, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const BinnedDataView * const pTrainingBinnedData, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const BinnedDataView * const pValidationBinnedData, const FractionalDataType * const aValidationPredictorScores) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingState::Initialize");
+   try {
+      if(InitializeFeatures(aFeatures, aFeatureCombinations, featureCombinationIndexes, cTrainingInstances + cValidationInstances)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize InitializeFeatures");
+         return true;
       }
-      LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize finished feature combination processing");
 
       const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
       const bool bRegression = IsRegression(m_runtimeLearningTypeOrCountTargetClasses);
 
       LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination for m_pTrainingSet");
       if(0 != cTrainingInstances) {
-         m_pTrainingSet = new (std::nothrow) DataSetByFeatureCombination(true, !bRegression, !bRegression, m_cFeatureCombinations, m_apFeatureCombinations, cTrainingInstances, aTrainingBinnedData, aTrainingTargets, aTrainingPredictorScores, cVectorLength);
+         m_pTrainingSet = new (std::nothrow) DataSetByFeatureCombination(true, !bRegression, !bRegression, m_cFeatureCombinations, m_apFeatureCombinations, cTrainingInstances, pTrainingBinnedData, aTrainingTargets, aTrainingPredictorScores, cVectorLength);
          if(nullptr == m_pTrainingSet || m_pTrainingSet->IsError()) {
             LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pTrainingSet || m_pTrainingSet->IsError()");
             return true;
@@ -291,7 +491,7 @@ bool EbmTrainingState::Initialize(const IntegerDataType randomSeed, const EbmCor
 
       LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination for m_pValidationSet");
       if(0 != cValidationInstances) {
-         m_pValidationSet = new (std::nothrow) DataSetByFeatureCombination(bRegression, !bRegression, !bRegression, m_cFeatureCombinations, m_apFeatureCombinations, cValidationInstances, aValidationBinnedData, aValidationTargets, aValidationPredictorScores, cVectorLength);
+         m_pValidationSet = new (std::nothrow) DataSetByFeatureCombination(bRegression, !bRegression, !bRegression, m_cFeatureCombinations, m_apFeatureCombinations, cValidationInstances, pValidationBinnedData, aValidationTargets, aValidationPredictorScores, cVectorLength);
          if(nullptr == m_pValidationSet || m_pValidationSet->IsError()) {
             LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pValidationSet || m_pValidationSet->IsError()");
             return true;
@@ -299,101 +499,194 @@ bool EbmTrainingState::Initialize(const IntegerDataType randomSeed, const EbmCor
       }
       LOG_N(TraceLevelInfo, "Exited DataSetByFeatureCombination for m_pValidationSet %p", static_cast<void *>(m_pValidationSet));
 
-      RandomStream randomStream(randomSeed);
-
       EBM_ASSERT(nullptr == m_apSamplingSets);
       if(0 != cTrainingInstances) {
-         m_apSamplingSets = SamplingWithReplacement::GenerateSamplingSets(&randomStream, m_pTrainingSet, m_cSamplingSets);
+         m_apSamplingSets = SamplingWithReplacement::GenerateSamplingSets(&m_arena, m_pThreadPool, m_cThreads, randomSeed, m_pTrainingSet, m_cSamplingSets, cTrainingInstances, nullptr);
          if(UNLIKELY(nullptr == m_apSamplingSets)) {
             LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_apSamplingSets");
             return true;
          }
       }
 
-      EBM_ASSERT(nullptr == m_apCurrentModel);
-      EBM_ASSERT(nullptr == m_apBestModel);
-      if(0 != m_cFeatureCombinations && (IsRegression(m_runtimeLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } <= m_runtimeLearningTypeOrCountTargetClasses)) {
-         m_apCurrentModel = InitializeSegmentedTensors(m_cFeatureCombinations, m_apFeatureCombinations, cVectorLength);
-         if(nullptr == m_apCurrentModel) {
-            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_apCurrentModel");
-            return true;
-         }
-         m_apBestModel = InitializeSegmentedTensors(m_cFeatureCombinations, m_apFeatureCombinations, cVectorLength);
-         if(nullptr == m_apBestModel) {
-            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_apBestModel");
-            return true;
-         }
+      if(InitializeModels()) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize InitializeModels");
+         return true;
       }
 
-      if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
-         if(0 != cTrainingInstances) {
-            InitializeResiduals<k_Regression>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), k_Regression);
-         }
-         if(0 != cValidationInstances) {
-            InitializeResiduals<k_Regression>(cValidationInstances, aValidationTargets, aValidationPredictorScores, m_pValidationSet->GetResidualPointer(), k_Regression);
-         }
-      } else {
-         EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
-         if(size_t { 2 } == static_cast<size_t>(m_runtimeLearningTypeOrCountTargetClasses)) {
-            if(0 != cTrainingInstances) {
-               InitializeResiduals<2>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), 2);
-            }
-         } else {
-            if(0 != cTrainingInstances) {
-               InitializeResiduals<k_DynamicClassification>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), m_runtimeLearningTypeOrCountTargetClasses);
-            }
-         }
+      if(0 != cTrainingInstances) {
+         InitializeTrainingResiduals(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores);
+      }
+      if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses) && 0 != cValidationInstances) {
+         InitializeResiduals<k_Regression>(cValidationInstances, aValidationTargets, aValidationPredictorScores, m_pValidationSet->GetResidualPointer(), k_Regression);
       }
 
       LOG_0(TraceLevelInfo, "Exited EbmTrainingState::Initialize");
       return false;
    } catch(...) {
-      // this is here to catch exceptions from RandomStream randomStream(randomSeed), but it could also catch errors if we put any other C++ types in here later
+      // nothing in here should throw, but this will catch errors if we put any C++ types in here later that can
       LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize exception");
       return true;
    }
 }
 
+bool EbmTrainingState::InitializeBagDataSets(const IntegerDataType randomSeed, const DataSetByFeatureCombination * const pSharedDataSet, const void * const aTargets, const FractionalDataType * const aPredictorScores, const IntegerDataType * const aValidationMask) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingState::InitializeBagDataSets");
+
+   EBM_ASSERT(nullptr != pSharedDataSet);
+   EBM_ASSERT(nullptr != aTargets);
+   EBM_ASSERT(nullptr != aValidationMask);
+   EBM_ASSERT(nullptr == m_pTrainingSet);
+   EBM_ASSERT(nullptr == m_pValidationSet);
+   EBM_ASSERT(nullptr == m_aValidationSubsetInstanceIndexes);
+
+   const size_t cInstances = pSharedDataSet->GetCountInstances();
+   EBM_ASSERT(0 < cInstances);
+
+   size_t cValidationInstances = 0;
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      if(0 != aValidationMask[iInstance]) {
+         ++cValidationInstances;
+      }
+   }
+   const size_t cTrainingInstances = cInstances - cValidationInstances;
+   if(0 == cTrainingInstances) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeBagDataSets 0 == cTrainingInstances");
+      return true;
+   }
+
+   // cInstances was checked against the size of the shared dataset, so this can't overflow
+   size_t * aTrainingInstanceIndexes = static_cast<size_t *>(malloc(sizeof(size_t) * cTrainingInstances));
+   if(nullptr == aTrainingInstanceIndexes) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeBagDataSets nullptr == aTrainingInstanceIndexes");
+      return true;
+   }
+   if(0 != cValidationInstances) {
+      m_aValidationSubsetInstanceIndexes = static_cast<size_t *>(malloc(sizeof(size_t) * cValidationInstances));
+      if(nullptr == m_aValidationSubsetInstanceIndexes) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeBagDataSets nullptr == m_aValidationSubsetInstanceIndexes");
+         free(aTrainingInstanceIndexes);
+         return true;
+      }
+      m_cValidationSubsetInstances = cValidationInstances;
+   }
+   size_t * pTrainingInstanceIndex = aTrainingInstanceIndexes;
+   size_t * pValidationInstanceIndex = m_aValidationSubsetInstanceIndexes;
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      if(0 != aValidationMask[iInstance]) {
+         *pValidationInstanceIndex = iInstance;
+         ++pValidationInstanceIndex;
+      } else {
+         *pTrainingInstanceIndex = iInstance;
+         ++pTrainingInstanceIndex;
+      }
+   }
+
+   try {
+      const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
+      const bool bRegression = IsRegression(m_runtimeLearningTypeOrCountTargetClasses);
+
+      // the validation instances stay in the training set so that their residuals and scores are updated with everyone else's, but they are never sampled
+      m_pTrainingSet = new (std::nothrow) DataSetByFeatureCombination(pSharedDataSet, true, !bRegression, aPredictorScores, cVectorLength);
+      if(nullptr == m_pTrainingSet || m_pTrainingSet->IsError()) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeBagDataSets nullptr == m_pTrainingSet || m_pTrainingSet->IsError()");
+         free(aTrainingInstanceIndexes);
+         return true;
+      }
+
+      EBM_ASSERT(nullptr == m_apSamplingSets);
+      m_apSamplingSets = SamplingWithReplacement::GenerateSamplingSets(&m_arena, m_pThreadPool, m_cThreads, randomSeed, m_pTrainingSet, m_cSamplingSets, cTrainingInstances, aTrainingInstanceIndexes);
+      free(aTrainingInstanceIndexes);
+      aTrainingInstanceIndexes = nullptr;
+      if(UNLIKELY(nullptr == m_apSamplingSets)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeBagDataSets nullptr == m_apSamplingSets");
+         return true;
+      }
+
+      if(InitializeModels()) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeBagDataSets InitializeModels");
+         return true;
+      }
+
+      InitializeTrainingResiduals(cInstances, aTargets, aPredictorScores);
+
+      LOG_0(TraceLevelInfo, "Exited EbmTrainingState::InitializeBagDataSets");
+      return false;
+   } catch(...) {
+      // nothing in here should throw, but this will catch errors if we put any C++ types in here later that can
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeBagDataSets exception");
+      free(aTrainingInstanceIndexes);
+      return true;
+   }
+}
+
+// binary classification first applies the model update to a block of instances and then computes the residuals or log losses of the whole block with
+// the vectorized kernels in EbmStatistics.  The block is small enough that its predictor scores are still in L1 when the kernel reads them back
+constexpr size_t k_cInstancesPerVectorBlock = size_t { 256 };
+
+// every block except the last one holds a whole number of bit pack units, so that each block starts at the first item of a unit
+EBM_INLINE static size_t GetCountInstancesVectorBlock(const size_t cInstancesRemaining, const size_t cItemsPerBitPackDataUnit) {
+   static_assert(k_cBitsForStorageType <= k_cInstancesPerVectorBlock, "a block needs to hold at least one bit pack unit");
+   EBM_ASSERT(cItemsPerBitPackDataUnit <= k_cInstancesPerVectorBlock);
+   return cInstancesRemaining <= k_cInstancesPerVectorBlock ? cInstancesRemaining : k_cInstancesPerVectorBlock - k_cInstancesPerVectorBlock % cItemsPerBitPackDataUnit;
+}
+
+// rewrites the Newton-Raphson denominators of residuals that we just rewrote, while they're still in cache
+EBM_INLINE static void ComputeDenominators(const size_t cValues, const StorageFractionalDataTypeCore * const aResidualErrors, StorageFractionalDataTypeCore * const aDenominators) {
+   for(size_t iValue = 0; iValue < cValues; ++iValue) {
+      aDenominators[iValue] = static_cast<StorageFractionalDataTypeCore>(EbmStatistics::ComputeNewtonRaphsonStep(static_cast<FractionalDataType>(aResidualErrors[iValue])));
+   }
+}
+
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
 template<unsigned int cInputBits, unsigned int cTargetBits, ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pTrainingSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
-   LOG_0(TraceLevelVerbose, "Entered TrainingSetTargetFeatureLoop");
-
+static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pTrainingSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const size_t iInstanceStart, const size_t cInstances, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   const size_t cInstances = pTrainingSet->GetCountInstances();
    EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(iInstanceStart + cInstances <= pTrainingSet->GetCountInstances());
 
    if(0 == pFeatureCombination->m_cFeatures) {
-      FractionalDataType * pResidualError = pTrainingSet->GetResidualPointer();
-      const FractionalDataType * const pResidualErrorEnd = pResidualError + cVectorLength * cInstances;
+      StorageFractionalDataTypeCore * pResidualError = pTrainingSet->GetResidualPointer() + cVectorLength * iInstanceStart;
+      const StorageFractionalDataTypeCore * const pResidualErrorEnd = pResidualError + cVectorLength * cInstances;
       if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
          const FractionalDataType smallChangeToPrediction = aModelFeatureCombinationUpdateTensor[0];
          while(pResidualErrorEnd != pResidualError) {
             // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
-            const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(*pResidualError - smallChangeToPrediction);
-            *pResidualError = residualError;
+            const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(static_cast<FractionalDataType>(*pResidualError) - smallChangeToPrediction);
+            *pResidualError = static_cast<StorageFractionalDataTypeCore>(residualError);
             ++pResidualError;
          }
       } else {
          EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
-         FractionalDataType * pTrainingPredictorScores = pTrainingSet->GetPredictorScores();
-         const StorageDataTypeCore * pTargetData = pTrainingSet->GetTargetDataPointer();
+         StorageFractionalDataTypeCore * pTrainingPredictorScores = pTrainingSet->GetPredictorScores() + cVectorLength * iInstanceStart;
+         const StorageDataTypeCore * pTargetData = pTrainingSet->GetTargetDataPointer() + iInstanceStart;
+         StorageFractionalDataTypeCore * pDenominator = pTrainingSet->GetDenominatorPointer();
+         if(nullptr != pDenominator) {
+            pDenominator += cVectorLength * iInstanceStart;
+         }
          if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
             const FractionalDataType smallChangeToPredictorScores = aModelFeatureCombinationUpdateTensor[0];
-            while(pResidualErrorEnd != pResidualError) {
-               StorageDataTypeCore targetData = *pTargetData;
-               // TODO : because there is only one bin for a zero feature feature combination, we can move the fetch of smallChangeToPredictorScores outside of our loop so that the code doesn't have this dereference each loop
-               // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
-               const FractionalDataType trainingPredictorScore = *pTrainingPredictorScores + smallChangeToPredictorScores;
-               *pTrainingPredictorScores = trainingPredictorScore;
-               const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorBinaryclass(trainingPredictorScore, targetData);
-               *pResidualError = residualError;
-               ++pResidualError;
-               ++pTrainingPredictorScores;
-               ++pTargetData;
-            }
+            size_t cInstancesRemaining = cInstances;
+            do {
+               const size_t cInstancesBlock = cInstancesRemaining < k_cInstancesPerVectorBlock ? cInstancesRemaining : k_cInstancesPerVectorBlock;
+               const StorageFractionalDataTypeCore * const pTrainingPredictorScoresBlockEnd = pTrainingPredictorScores + cInstancesBlock;
+               StorageFractionalDataTypeCore * pTrainingPredictorScore = pTrainingPredictorScores;
+               do {
+                  // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
+                  *pTrainingPredictorScore = static_cast<StorageFractionalDataTypeCore>(static_cast<FractionalDataType>(*pTrainingPredictorScore) + smallChangeToPredictorScores);
+                  ++pTrainingPredictorScore;
+               } while(pTrainingPredictorScoresBlockEnd != pTrainingPredictorScore);
+               EbmStatistics::ComputeClassificationResidualErrorBinaryclass(cInstancesBlock, pTrainingPredictorScores, pTargetData, pResidualError);
+               if(nullptr != pDenominator) {
+                  ComputeDenominators(cInstancesBlock, pResidualError, pDenominator);
+                  pDenominator += cInstancesBlock;
+               }
+               pTrainingPredictorScores += cInstancesBlock;
+               pTargetData += cInstancesBlock;
+               pResidualError += cInstancesBlock;
+               cInstancesRemaining -= cInstancesBlock;
+            } while(0 != cInstancesRemaining);
          } else {
             const FractionalDataType * pValues = aModelFeatureCombinationUpdateTensor;
             while(pResidualErrorEnd != pResidualError) {
@@ -404,9 +697,10 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
                   // TODO : because there is only one bin for a zero feature feature combination, we could move these values to the stack where the copmiler could reason about their visibility and optimize small arrays into registers
                   const FractionalDataType smallChangeToPredictorScores = pValues[iVector1];
                   // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
-                  const FractionalDataType trainingPredictorScores = pTrainingPredictorScores[iVector1] + smallChangeToPredictorScores;
+                  const StorageFractionalDataTypeCore trainingPredictorScores = static_cast<StorageFractionalDataTypeCore>(static_cast<FractionalDataType>(pTrainingPredictorScores[iVector1]) + smallChangeToPredictorScores);
                   pTrainingPredictorScores[iVector1] = trainingPredictorScores;
-                  sumExp += std::exp(trainingPredictorScores);
+                  // take the exp of the score that we stored, so that sumExp agrees with the scores that we compute the residuals from
+                  sumExp += std::exp(static_cast<FractionalDataType>(trainingPredictorScores));
                   ++iVector1;
                } while(iVector1 < cVectorLength);
 
@@ -415,8 +709,8 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
                StorageDataTypeCore iVector2 = 0;
                do {
                   // TODO : we're calculating exp(predictionScore) above, and then again in ComputeClassificationResidualErrorMulticlass.  exp(..) is expensive so we should just do it once instead and store the result in a small memory array here
-                  const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorMulticlass(sumExp, pTrainingPredictorScores[iVector2], targetData, iVector2);
-                  *pResidualError = residualError;
+                  const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorMulticlass(sumExp, static_cast<FractionalDataType>(pTrainingPredictorScores[iVector2]), targetData, iVector2);
+                  *pResidualError = static_cast<StorageFractionalDataTypeCore>(residualError);
                   ++pResidualError;
                   ++iVector2;
                } while(iVector2 < cVectorLengthStorage);
@@ -432,12 +726,15 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
                if(bZeroingResiduals) {
                   pResidualError[k_iZeroResidual - static_cast<ptrdiff_t>(cVectorLength)] = 0;
                }
+               if(nullptr != pDenominator) {
+                  ComputeDenominators(cVectorLength, pResidualError - cVectorLength, pDenominator);
+                  pDenominator += cVectorLength;
+               }
                pTrainingPredictorScores += cVectorLength;
                ++pTargetData;
             }
          }
       }
-      LOG_0(TraceLevelVerbose, "Exited TrainingSetTargetFeatureLoop - Zero dimensions");
       return;
    }
 
@@ -445,9 +742,11 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
    const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
    const size_t maskBits = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMax);
 
-   const StorageDataTypeCore * pInputData = pTrainingSet->GetDataPointer(pFeatureCombination);
-   FractionalDataType * pResidualError = pTrainingSet->GetResidualPointer();
-   const FractionalDataType * const pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete = pResidualError + cVectorLength * (static_cast<ptrdiff_t>(cInstances) - cItemsPerBitPackDataUnit);
+   EBM_ASSERT(0 == iInstanceStart % cItemsPerBitPackDataUnit);
+
+   const StorageDataTypeCore * pInputData = pTrainingSet->GetDataPointer(pFeatureCombination) + iInstanceStart / cItemsPerBitPackDataUnit;
+   StorageFractionalDataTypeCore * pResidualError = pTrainingSet->GetResidualPointer() + cVectorLength * iInstanceStart;
+   const StorageFractionalDataTypeCore * const pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete = pResidualError + cVectorLength * (static_cast<ptrdiff_t>(cInstances) - cItemsPerBitPackDataUnit);
 
    if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
       size_t cItemsRemaining;
@@ -463,8 +762,8 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
             const size_t iTensorBin = maskBits & iTensorBinCombined;
             const FractionalDataType smallChangeToPrediction = aModelFeatureCombinationUpdateTensor[iTensorBin * cVectorLength];
             // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
-            const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(*pResidualError - smallChangeToPrediction);
-            *pResidualError = residualError;
+            const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(static_cast<FractionalDataType>(*pResidualError) - smallChangeToPrediction);
+            *pResidualError = static_cast<StorageFractionalDataTypeCore>(residualError);
             ++pResidualError;
 
             iTensorBinCombined >>= cBitsPerItemMax;
@@ -472,7 +771,7 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
             --cItemsRemaining;
          } while(0 != cItemsRemaining);
       }
-      const FractionalDataType * const pResidualErrorEnd = pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
+      const StorageFractionalDataTypeCore * const pResidualErrorEnd = pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
       if(pResidualError < pResidualErrorEnd) {
          // first time through?
          EBM_ASSERT(0 == (pResidualErrorEnd - pResidualError) % cVectorLength);
@@ -482,10 +781,52 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
          goto one_last_loop_regression;
       }
       EBM_ASSERT(pResidualError == pResidualErrorEnd); // after our second iteration we should have finished everything!
+   } else if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
+      StorageFractionalDataTypeCore * pTrainingPredictorScores = pTrainingSet->GetPredictorScores() + iInstanceStart;
+      const StorageDataTypeCore * pTargetData = pTrainingSet->GetTargetDataPointer() + iInstanceStart;
+      StorageFractionalDataTypeCore * pDenominator = pTrainingSet->GetDenominatorPointer();
+      if(nullptr != pDenominator) {
+         pDenominator += iInstanceStart;
+      }
+      size_t cInstancesRemaining = cInstances;
+      do {
+         const size_t cInstancesBlock = GetCountInstancesVectorBlock(cInstancesRemaining, cItemsPerBitPackDataUnit);
+         const StorageFractionalDataTypeCore * const pTrainingPredictorScoresBlockEnd = pTrainingPredictorScores + cInstancesBlock;
+         StorageFractionalDataTypeCore * pTrainingPredictorScore = pTrainingPredictorScores;
+         do {
+            // we store the already multiplied dimensional value in *pInputData
+            size_t iTensorBinCombined = static_cast<size_t>(*pInputData);
+            ++pInputData;
+            const size_t cInstancesBlockRemaining = static_cast<size_t>(pTrainingPredictorScoresBlockEnd - pTrainingPredictorScore);
+            size_t cItemsRemaining = cInstancesBlockRemaining < cItemsPerBitPackDataUnit ? cInstancesBlockRemaining : cItemsPerBitPackDataUnit;
+            do {
+               const size_t iTensorBin = maskBits & iTensorBinCombined;
+               // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
+               *pTrainingPredictorScore = static_cast<StorageFractionalDataTypeCore>(static_cast<FractionalDataType>(*pTrainingPredictorScore) + aModelFeatureCombinationUpdateTensor[iTensorBin]);
+               ++pTrainingPredictorScore;
+
+               iTensorBinCombined >>= cBitsPerItemMax;
+               --cItemsRemaining;
+            } while(0 != cItemsRemaining);
+         } while(pTrainingPredictorScoresBlockEnd != pTrainingPredictorScore);
+         EbmStatistics::ComputeClassificationResidualErrorBinaryclass(cInstancesBlock, pTrainingPredictorScores, pTargetData, pResidualError);
+         if(nullptr != pDenominator) {
+            ComputeDenominators(cInstancesBlock, pResidualError, pDenominator);
+            pDenominator += cInstancesBlock;
+         }
+         pTrainingPredictorScores += cInstancesBlock;
+         pTargetData += cInstancesBlock;
+         pResidualError += cInstancesBlock;
+         cInstancesRemaining -= cInstancesBlock;
+      } while(0 != cInstancesRemaining);
    } else {
       EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
-      FractionalDataType * pTrainingPredictorScores = pTrainingSet->GetPredictorScores();
-      const StorageDataTypeCore * pTargetData = pTrainingSet->GetTargetDataPointer();
+      StorageFractionalDataTypeCore * pTrainingPredictorScores = pTrainingSet->GetPredictorScores() + cVectorLength * iInstanceStart;
+      const StorageDataTypeCore * pTargetData = pTrainingSet->GetTargetDataPointer() + iInstanceStart;
+      StorageFractionalDataTypeCore * pDenominator = pTrainingSet->GetDenominatorPointer();
+      if(nullptr != pDenominator) {
+         pDenominator += cVectorLength * iInstanceStart;
+      }
 
       size_t cItemsRemaining;
 
@@ -503,48 +844,43 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
             const size_t iTensorBin = maskBits & iTensorBinCombined;
             const FractionalDataType * pValues = &aModelFeatureCombinationUpdateTensor[iTensorBin * cVectorLength];
 
-            if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
-               const FractionalDataType smallChangeToPredictorScores = pValues[0];
+            FractionalDataType sumExp = 0;
+            size_t iVector1 = 0;
+            do {
+               const FractionalDataType smallChangeToPredictorScores = pValues[iVector1];
                // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
-               const FractionalDataType trainingPredictorScore = *pTrainingPredictorScores + smallChangeToPredictorScores;
-               *pTrainingPredictorScores = trainingPredictorScore;
-               const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorBinaryclass(trainingPredictorScore, targetData);
-               *pResidualError = residualError;
+               const StorageFractionalDataTypeCore trainingPredictorScores = static_cast<StorageFractionalDataTypeCore>(static_cast<FractionalDataType>(pTrainingPredictorScores[iVector1]) + smallChangeToPredictorScores);
+               pTrainingPredictorScores[iVector1] = trainingPredictorScores;
+               // take the exp of the score that we stored, so that sumExp agrees with the scores that we compute the residuals from
+               sumExp += std::exp(static_cast<FractionalDataType>(trainingPredictorScores));
+               ++iVector1;
+            } while(iVector1 < cVectorLength);
+
+            EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(cVectorLength)));
+            const StorageDataTypeCore cVectorLengthStorage = static_cast<StorageDataTypeCore>(cVectorLength);
+            StorageDataTypeCore iVector2 = 0;
+            do {
+               // TODO : we're calculating exp(predictionScore) above, and then again in ComputeClassificationResidualErrorMulticlass.  exp(..) is expensive so we should just do it once instead and store the result in a small memory array here
+               const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorMulticlass(sumExp, static_cast<FractionalDataType>(pTrainingPredictorScores[iVector2]), targetData, iVector2);
+               *pResidualError = static_cast<StorageFractionalDataTypeCore>(residualError);
                ++pResidualError;
-            } else {
-               FractionalDataType sumExp = 0;
-               size_t iVector1 = 0;
-               do {
-                  const FractionalDataType smallChangeToPredictorScores = pValues[iVector1];
-                  // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
-                  const FractionalDataType trainingPredictorScores = pTrainingPredictorScores[iVector1] + smallChangeToPredictorScores;
-                  pTrainingPredictorScores[iVector1] = trainingPredictorScores;
-                  sumExp += std::exp(trainingPredictorScores);
-                  ++iVector1;
-               } while(iVector1 < cVectorLength);
-
-               EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(cVectorLength)));
-               const StorageDataTypeCore cVectorLengthStorage = static_cast<StorageDataTypeCore>(cVectorLength);
-               StorageDataTypeCore iVector2 = 0;
-               do {
-                  // TODO : we're calculating exp(predictionScore) above, and then again in ComputeClassificationResidualErrorMulticlass.  exp(..) is expensive so we should just do it once instead and store the result in a small memory array here
-                  const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorMulticlass(sumExp, pTrainingPredictorScores[iVector2], targetData, iVector2);
-                  *pResidualError = residualError;
-                  ++pResidualError;
-                  ++iVector2;
-               } while(iVector2 < cVectorLengthStorage);
-               // TODO: this works as a way to remove one parameter, but it obviously insn't as efficient as omitting the parameter
-               // 
-               // this works out in the math as making the first model vector parameter equal to zero, which in turn removes one degree of freedom
-               // from the model vector parameters.  Since the model vector weights need to be normalized to sum to a probabilty of 100%, we can set the first
-               // one to the constant 1 (0 in log space) and force the other parameters to adjust to that scale which fixes them to a single valid set of values
-               // insted of allowing them to be scaled.  
-               // Probability = exp(T1 + I1) / [exp(T1 + I1) + exp(T2 + I2) + exp(T3 + I3)] => we can add a constant inside each exp(..) term, which will be multiplication outside the exp(..), which
-               // means the numerator and denominator are multiplied by the same constant, which cancels eachother out.  We can thus set exp(T2 + I2) to exp(0) and adjust the other terms
-               constexpr bool bZeroingResiduals = 0 <= k_iZeroResidual;
-               if(bZeroingResiduals) {
-                  pResidualError[k_iZeroResidual - static_cast<ptrdiff_t>(cVectorLength)] = 0;
-               }
+               ++iVector2;
+            } while(iVector2 < cVectorLengthStorage);
+            // TODO: this works as a way to remove one parameter, but it obviously insn't as efficient as omitting the parameter
+            // 
+            // this works out in the math as making the first model vector parameter equal to zero, which in turn removes one degree of freedom
+            // from the model vector parameters.  Since the model vector weights need to be normalized to sum to a probabilty of 100%, we can set the first
+            // one to the constant 1 (0 in log space) and force the other parameters to adjust to that scale which fixes them to a single valid set of values
+            // insted of allowing them to be scaled.  
+            // Probability = exp(T1 + I1) / [exp(T1 + I1) + exp(T2 + I2) + exp(T3 + I3)] => we can add a constant inside each exp(..) term, which will be multiplication outside the exp(..), which
+            // means the numerator and denominator are multiplied by the same constant, which cancels eachother out.  We can thus set exp(T2 + I2) to exp(0) and adjust the other terms
+            constexpr bool bZeroingResiduals = 0 <= k_iZeroResidual;
+            if(bZeroingResiduals) {
+               pResidualError[k_iZeroResidual - static_cast<ptrdiff_t>(cVectorLength)] = 0;
+            }
+            if(nullptr != pDenominator) {
+               ComputeDenominators(cVectorLength, pResidualError - cVectorLength, pDenominator);
+               pDenominator += cVectorLength;
             }
             pTrainingPredictorScores += cVectorLength;
             ++pTargetData;
@@ -554,7 +890,7 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
             --cItemsRemaining;
          } while(0 != cItemsRemaining);
       }
-      const FractionalDataType * const pResidualErrorEnd = pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
+      const StorageFractionalDataTypeCore * const pResidualErrorEnd = pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
       if(pResidualError < pResidualErrorEnd) {
          // first time through?
          EBM_ASSERT(0 == (pResidualErrorEnd - pResidualError) % cVectorLength);
@@ -565,86 +901,87 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
       }
       EBM_ASSERT(pResidualError == pResidualErrorEnd); // after our second iteration we should have finished everything!
    }
-   LOG_0(TraceLevelVerbose, "Exited TrainingSetTargetFeatureLoop");
 }
 
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
 template<unsigned int cInputBits, ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static void TrainingSetInputFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pTrainingSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+static void TrainingSetInputFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pTrainingSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const size_t iInstanceStart, const size_t cInstances, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 1) {
-      TrainingSetTargetFeatureLoop<cInputBits, 1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      TrainingSetTargetFeatureLoop<cInputBits, 1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 2) {
-      TrainingSetTargetFeatureLoop<cInputBits, 2, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      TrainingSetTargetFeatureLoop<cInputBits, 2, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 4) {
-      TrainingSetTargetFeatureLoop<cInputBits, 4, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      TrainingSetTargetFeatureLoop<cInputBits, 4, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 8) {
-      TrainingSetTargetFeatureLoop<cInputBits, 8, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      TrainingSetTargetFeatureLoop<cInputBits, 8, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 16) {
-      TrainingSetTargetFeatureLoop<cInputBits, 16, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      TrainingSetTargetFeatureLoop<cInputBits, 16, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<uint64_t>(runtimeLearningTypeOrCountTargetClasses) <= uint64_t { 1 } << 32) {
       // if this is a 32 bit system, then m_cBins can't be 0x100000000 or above, because we would have checked that when converting the 64 bit numbers into size_t, and m_cBins will be promoted to a 64 bit number for the above comparison
       // if this is a 64 bit system, then this comparison is fine
 
       // TODO : perhaps we should change m_cBins into m_iBinMax so that we don't need to do the above promotion to 64 bits.. we can make it <= 0xFFFFFFFF.  Write a function to fill the lowest bits with ones for any number of bits
 
-      TrainingSetTargetFeatureLoop<cInputBits, 32, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      TrainingSetTargetFeatureLoop<cInputBits, 32, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else {
       // our interface doesn't allow more than 64 bits, so even if size_t was bigger then we don't need to examine higher
       static_assert(63 == CountBitsRequiredPositiveMax<IntegerDataType>(), "");
-      TrainingSetTargetFeatureLoop<cInputBits, 64, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      TrainingSetTargetFeatureLoop<cInputBits, 64, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    }
 }
 
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
+// returns the sum of the squared errors for regression or the sum of the log losses for classification over the instances it processes
 template<unsigned int cInputBits, unsigned int cTargetBits, ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
-   LOG_0(TraceLevelVerbose, "Entering ValidationSetTargetFeatureLoop");
-
+static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const size_t iInstanceStart, const size_t cInstances, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   const size_t cInstances = pValidationSet->GetCountInstances();
    EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(iInstanceStart + cInstances <= pValidationSet->GetCountInstances());
 
    if(0 == pFeatureCombination->m_cFeatures) {
       if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
-         FractionalDataType * pResidualError = pValidationSet->GetResidualPointer();
-         const FractionalDataType * const pResidualErrorEnd = pResidualError + cInstances;
+         StorageFractionalDataTypeCore * pResidualError = pValidationSet->GetResidualPointer() + iInstanceStart;
+         const StorageFractionalDataTypeCore * const pResidualErrorEnd = pResidualError + cInstances;
 
          const FractionalDataType smallChangeToPrediction = aModelFeatureCombinationUpdateTensor[0];
 
-         FractionalDataType rootMeanSquareError = 0;
+         FractionalDataType sumSquareError = 0;
          while(pResidualErrorEnd != pResidualError) {
             // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
-            const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(*pResidualError - smallChangeToPrediction);
-            rootMeanSquareError += residualError * residualError;
+            // round the residual before we add it to the metric, so that the metric agrees with the residuals that we keep
+            const StorageFractionalDataTypeCore residualError = static_cast<StorageFractionalDataTypeCore>(EbmStatistics::ComputeRegressionResidualError(static_cast<FractionalDataType>(*pResidualError) - smallChangeToPrediction));
+            sumSquareError += static_cast<FractionalDataType>(residualError) * static_cast<FractionalDataType>(residualError);
             *pResidualError = residualError;
             ++pResidualError;
          }
-
-         rootMeanSquareError /= pValidationSet->GetCountInstances();
-         LOG_0(TraceLevelVerbose, "Exited ValidationSetTargetFeatureLoop - Zero dimensions");
-         return sqrt(rootMeanSquareError);
+         return sumSquareError;
       } else {
          EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
-         FractionalDataType * pValidationPredictorScores = pValidationSet->GetPredictorScores();
-         const StorageDataTypeCore * pTargetData = pValidationSet->GetTargetDataPointer();
+         StorageFractionalDataTypeCore * pValidationPredictorScores = pValidationSet->GetPredictorScores() + cVectorLength * iInstanceStart;
+         const StorageDataTypeCore * pTargetData = pValidationSet->GetTargetDataPointer() + iInstanceStart;
 
-         const FractionalDataType * const pValidationPredictionEnd = pValidationPredictorScores + cVectorLength * cInstances;
+         const StorageFractionalDataTypeCore * const pValidationPredictionEnd = pValidationPredictorScores + cVectorLength * cInstances;
 
          FractionalDataType sumLogLoss = 0;
          if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
             const FractionalDataType smallChangeToPredictorScores = aModelFeatureCombinationUpdateTensor[0];
             while(pValidationPredictionEnd != pValidationPredictorScores) {
-               StorageDataTypeCore targetData = *pTargetData;
-               // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
-               const FractionalDataType validationPredictorScores = *pValidationPredictorScores + smallChangeToPredictorScores;
-               *pValidationPredictorScores = validationPredictorScores;
-               sumLogLoss += EbmStatistics::ComputeClassificationSingleInstanceLogLossBinaryclass(validationPredictorScores, targetData);
-               ++pValidationPredictorScores;
-               ++pTargetData;
+               const size_t cInstancesRemaining = static_cast<size_t>(pValidationPredictionEnd - pValidationPredictorScores);
+               const size_t cInstancesBlock = cInstancesRemaining < k_cInstancesPerVectorBlock ? cInstancesRemaining : k_cInstancesPerVectorBlock;
+               const StorageFractionalDataTypeCore * const pValidationPredictorScoresBlockEnd = pValidationPredictorScores + cInstancesBlock;
+               StorageFractionalDataTypeCore * pValidationPredictorScore = pValidationPredictorScores;
+               do {
+                  // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
+                  *pValidationPredictorScore = static_cast<StorageFractionalDataTypeCore>(static_cast<FractionalDataType>(*pValidationPredictorScore) + smallChangeToPredictorScores);
+                  ++pValidationPredictorScore;
+               } while(pValidationPredictorScoresBlockEnd != pValidationPredictorScore);
+               sumLogLoss += EbmStatistics::ComputeClassificationLogLossBinaryclass(cInstancesBlock, pValidationPredictorScores, pTargetData);
+               pValidationPredictorScores += cInstancesBlock;
+               pTargetData += cInstancesBlock;
             }
          } else {
             const FractionalDataType * pValues = aModelFeatureCombinationUpdateTensor;
@@ -657,9 +994,10 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
                   // this will apply a small fix to our existing validationPredictorScores, either positive or negative, whichever is needed
 
                   // TODO : this is no longer a prediction for multiclass.  It is a weight.  Change all instances of this naming. -> validationLogWeight
-                  const FractionalDataType validationPredictorScores = *pValidationPredictorScores + smallChangeToPredictorScores;
+                  const StorageFractionalDataTypeCore validationPredictorScores = static_cast<StorageFractionalDataTypeCore>(static_cast<FractionalDataType>(*pValidationPredictorScores) + smallChangeToPredictorScores);
                   *pValidationPredictorScores = validationPredictorScores;
-                  sumExp += std::exp(validationPredictorScores);
+                  // take the exp of the score that we stored, so that sumExp agrees with the score that we compute the log loss from
+                  sumExp += std::exp(static_cast<FractionalDataType>(validationPredictorScores));
                   ++pValidationPredictorScores;
 
                   // TODO : consider replacing iVector with pValidationPredictorScoresInnerEnd
@@ -670,7 +1008,6 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
                ++pTargetData;
             }
          }
-         LOG_0(TraceLevelVerbose, "Exited ValidationSetTargetFeatureLoop - Zero dimensions");
          return sumLogLoss;
       }
       EBM_ASSERT(false);
@@ -679,13 +1016,14 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
    const size_t cItemsPerBitPackDataUnit = pFeatureCombination->m_cItemsPerBitPackDataUnit;
    const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
    const size_t maskBits = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMax);
-   const StorageDataTypeCore * pInputData = pValidationSet->GetDataPointer(pFeatureCombination);
+   EBM_ASSERT(0 == iInstanceStart % cItemsPerBitPackDataUnit);
+   const StorageDataTypeCore * pInputData = pValidationSet->GetDataPointer(pFeatureCombination) + iInstanceStart / cItemsPerBitPackDataUnit;
 
    if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
-      FractionalDataType * pResidualError = pValidationSet->GetResidualPointer();
-      const FractionalDataType * const pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete = pResidualError + (static_cast<ptrdiff_t>(cInstances) - static_cast<ptrdiff_t>(cItemsPerBitPackDataUnit));
+      StorageFractionalDataTypeCore * pResidualError = pValidationSet->GetResidualPointer() + iInstanceStart;
+      const StorageFractionalDataTypeCore * const pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete = pResidualError + (static_cast<ptrdiff_t>(cInstances) - static_cast<ptrdiff_t>(cItemsPerBitPackDataUnit));
 
-      FractionalDataType rootMeanSquareError = 0;
+      FractionalDataType sumSquareError = 0;
       size_t cItemsRemaining;
       while(pResidualError < pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete) {
          cItemsRemaining = cItemsPerBitPackDataUnit;
@@ -699,8 +1037,9 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
             const size_t iTensorBin = maskBits & iTensorBinCombined;
             const FractionalDataType smallChangeToPrediction = aModelFeatureCombinationUpdateTensor[iTensorBin * cVectorLength];
             // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
-            const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(*pResidualError - smallChangeToPrediction);
-            rootMeanSquareError += residualError * residualError;
+            // round the residual before we add it to the metric, so that the metric agrees with the residuals that we keep
+            const StorageFractionalDataTypeCore residualError = static_cast<StorageFractionalDataTypeCore>(EbmStatistics::ComputeRegressionResidualError(static_cast<FractionalDataType>(*pResidualError) - smallChangeToPrediction));
+            sumSquareError += static_cast<FractionalDataType>(residualError) * static_cast<FractionalDataType>(residualError);
             *pResidualError = residualError;
             ++pResidualError;
 
@@ -709,7 +1048,7 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
             --cItemsRemaining;
          } while(0 != cItemsRemaining);
       }
-      const FractionalDataType * const pResidualErrorEnd = pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
+      const StorageFractionalDataTypeCore * const pResidualErrorEnd = pResidualErrorLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
       if(pResidualError < pResidualErrorEnd) {
          // first time through?
          EBM_ASSERT(0 == (pResidualErrorEnd - pResidualError) % cVectorLength);
@@ -719,18 +1058,46 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
          goto one_last_loop_regression;
       }
       EBM_ASSERT(pResidualError == pResidualErrorEnd); // after our second iteration we should have finished everything!
-
-      rootMeanSquareError /= pValidationSet->GetCountInstances();
-      LOG_0(TraceLevelVerbose, "Exited ValidationSetTargetFeatureLoop");
-      return sqrt(rootMeanSquareError);
+      return sumSquareError;
+   } else if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
+      StorageFractionalDataTypeCore * pValidationPredictorScores = pValidationSet->GetPredictorScores() + iInstanceStart;
+      const StorageDataTypeCore * pTargetData = pValidationSet->GetTargetDataPointer() + iInstanceStart;
+      FractionalDataType sumLogLoss = 0;
+      size_t cInstancesRemaining = cInstances;
+      do {
+         const size_t cInstancesBlock = GetCountInstancesVectorBlock(cInstancesRemaining, cItemsPerBitPackDataUnit);
+         const StorageFractionalDataTypeCore * const pValidationPredictorScoresBlockEnd = pValidationPredictorScores + cInstancesBlock;
+         StorageFractionalDataTypeCore * pValidationPredictorScore = pValidationPredictorScores;
+         do {
+            // we store the already multiplied dimensional value in *pInputData
+            size_t iTensorBinCombined = static_cast<size_t>(*pInputData);
+            ++pInputData;
+            const size_t cInstancesBlockRemaining = static_cast<size_t>(pValidationPredictorScoresBlockEnd - pValidationPredictorScore);
+            size_t cItemsRemaining = cInstancesBlockRemaining < cItemsPerBitPackDataUnit ? cInstancesBlockRemaining : cItemsPerBitPackDataUnit;
+            do {
+               const size_t iTensorBin = maskBits & iTensorBinCombined;
+               // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
+               *pValidationPredictorScore = static_cast<StorageFractionalDataTypeCore>(static_cast<FractionalDataType>(*pValidationPredictorScore) + aModelFeatureCombinationUpdateTensor[iTensorBin]);
+               ++pValidationPredictorScore;
+
+               iTensorBinCombined >>= cBitsPerItemMax;
+               --cItemsRemaining;
+            } while(0 != cItemsRemaining);
+         } while(pValidationPredictorScoresBlockEnd != pValidationPredictorScore);
+         sumLogLoss += EbmStatistics::ComputeClassificationLogLossBinaryclass(cInstancesBlock, pValidationPredictorScores, pTargetData);
+         pValidationPredictorScores += cInstancesBlock;
+         pTargetData += cInstancesBlock;
+         cInstancesRemaining -= cInstancesBlock;
+      } while(0 != cInstancesRemaining);
+      return sumLogLoss;
    } else {
       EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
-      FractionalDataType * pValidationPredictorScores = pValidationSet->GetPredictorScores();
-      const StorageDataTypeCore * pTargetData = pValidationSet->GetTargetDataPointer();
+      StorageFractionalDataTypeCore * pValidationPredictorScores = pValidationSet->GetPredictorScores() + cVectorLength * iInstanceStart;
+      const StorageDataTypeCore * pTargetData = pValidationSet->GetTargetDataPointer() + iInstanceStart;
 
       size_t cItemsRemaining;
 
-      const FractionalDataType * const pValidationPredictorScoresLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete = pValidationPredictorScores + cVectorLength * (static_cast<ptrdiff_t>(cInstances) - cItemsPerBitPackDataUnit);
+      const StorageFractionalDataTypeCore * const pValidationPredictorScoresLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete = pValidationPredictorScores + cVectorLength * (static_cast<ptrdiff_t>(cInstances) - cItemsPerBitPackDataUnit);
 
       FractionalDataType sumLogLoss = 0;
       while(pValidationPredictorScores < pValidationPredictorScoresLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete) {
@@ -747,32 +1114,24 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
             const size_t iTensorBin = maskBits & iTensorBinCombined;
             const FractionalDataType * pValues = &aModelFeatureCombinationUpdateTensor[iTensorBin * cVectorLength];
 
-            if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
-               const FractionalDataType smallChangeToPredictorScores = pValues[0];
-               // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
-               const FractionalDataType validationPredictorScores = *pValidationPredictorScores + smallChangeToPredictorScores;
+            FractionalDataType sumExp = 0;
+            size_t iVector = 0;
+            do {
+               const FractionalDataType smallChangeToPredictorScores = pValues[iVector];
+               // this will apply a small fix to our existing validationPredictorScores, either positive or negative, whichever is needed
+
+               // TODO : this is no longer a prediction for multiclass.  It is a weight.  Change all instances of this naming. -> validationLogWeight
+               const StorageFractionalDataTypeCore validationPredictorScores = static_cast<StorageFractionalDataTypeCore>(static_cast<FractionalDataType>(*pValidationPredictorScores) + smallChangeToPredictorScores);
                *pValidationPredictorScores = validationPredictorScores;
-               sumLogLoss += EbmStatistics::ComputeClassificationSingleInstanceLogLossBinaryclass(validationPredictorScores, targetData);
+               // take the exp of the score that we stored, so that sumExp agrees with the score that we compute the log loss from
+               sumExp += std::exp(static_cast<FractionalDataType>(validationPredictorScores));
                ++pValidationPredictorScores;
-            } else {
-               FractionalDataType sumExp = 0;
-               size_t iVector = 0;
-               do {
-                  const FractionalDataType smallChangeToPredictorScores = pValues[iVector];
-                  // this will apply a small fix to our existing validationPredictorScores, either positive or negative, whichever is needed
 
-                  // TODO : this is no longer a prediction for multiclass.  It is a weight.  Change all instances of this naming. -> validationLogWeight
-                  const FractionalDataType validationPredictorScores = *pValidationPredictorScores + smallChangeToPredictorScores;
-                  *pValidationPredictorScores = validationPredictorScores;
-                  sumExp += std::exp(validationPredictorScores);
-                  ++pValidationPredictorScores;
-
-                  // TODO : consider replacing iVector with pValidationPredictorScoresInnerEnd
-                  ++iVector;
-               } while(iVector < cVectorLength);
-               // TODO: store the result of std::exp above for the index that we care about above since exp(..) is going to be expensive and probably even more expensive than an unconditional branch
-               sumLogLoss += EbmStatistics::ComputeClassificationSingleInstanceLogLossMulticlass(sumExp, pValidationPredictorScores - cVectorLength, targetData);
-            }
+               // TODO : consider replacing iVector with pValidationPredictorScoresInnerEnd
+               ++iVector;
+            } while(iVector < cVectorLength);
+            // TODO: store the result of std::exp above for the index that we care about above since exp(..) is going to be expensive and probably even more expensive than an unconditional branch
+            sumLogLoss += EbmStatistics::ComputeClassificationSingleInstanceLogLossMulticlass(sumExp, pValidationPredictorScores - cVectorLength, targetData);
             ++pTargetData;
 
             iTensorBinCombined >>= cBitsPerItemMax;
@@ -781,7 +1140,7 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
          } while(0 != cItemsRemaining);
       }
 
-      const FractionalDataType * const pValidationPredictorScoresEnd = pValidationPredictorScoresLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
+      const StorageFractionalDataTypeCore * const pValidationPredictorScoresEnd = pValidationPredictorScoresLastItemWhereNextLoopCouldDoFullLoopOrLessAndComplete + cVectorLength * cItemsPerBitPackDataUnit;
       if(pValidationPredictorScores < pValidationPredictorScoresEnd) {
          // first time through?
          EBM_ASSERT(0 == (pValidationPredictorScoresEnd - pValidationPredictorScores) % cVectorLength);
@@ -791,8 +1150,6 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
          goto one_last_loop_classification;
       }
       EBM_ASSERT(pValidationPredictorScores == pValidationPredictorScoresEnd); // after our second iteration we should have finished everything!
-
-      LOG_0(TraceLevelVerbose, "Exited ValidationSetTargetFeatureLoop");
       return sumLogLoss;
    }
 }
@@ -801,28 +1158,28 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
 template<unsigned int cInputBits, ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static FractionalDataType ValidationSetInputFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+static FractionalDataType ValidationSetInputFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const size_t iInstanceStart, const size_t cInstances, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 1) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 2) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 2, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 2, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 4) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 4, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 4, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 8) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 8, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 8, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 16) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 16, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 16, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else if(static_cast<uint64_t>(runtimeLearningTypeOrCountTargetClasses) <= uint64_t { 1 } << 32) {
       // if this is a 32 bit system, then m_cBins can't be 0x100000000 or above, because we would have checked that when converting the 64 bit numbers into size_t, and m_cBins will be promoted to a 64 bit number for the above comparison
       // if this is a 64 bit system, then this comparison is fine
 
       // TODO : perhaps we should change m_cBins into m_iBinMax so that we don't need to do the above promotion to 64 bits.. we can make it <= 0xFFFFFFFF.  Write a function to fill the lowest bits with ones for any number of bits
 
-      return ValidationSetTargetFeatureLoop<cInputBits, 32, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 32, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    } else {
       // our interface doesn't allow more than 64 bits, so even if size_t was bigger then we don't need to examine higher
       static_assert(63 == CountBitsRequiredPositiveMax<IntegerDataType>(), "");
-      return ValidationSetTargetFeatureLoop<cInputBits, 64, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 64, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses);
    }
 }
 
@@ -854,10 +1211,48 @@ void CheckTargets(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const
 }
 #endif // NDEBUG
 
+static EbmTrainingState * AllocateCoreTrainingState(const IntegerDataType randomSeed, const size_t cFeatures, const EbmCoreFeature * const features, const size_t cFeatureCombinations, const EbmCoreFeatureCombination * const featureCombinations, const IntegerDataType * const featureCombinationIndexes, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cTrainingInstances, const void * const trainingTargets, const BinnedDataView * const pTrainingBinnedData, const FractionalDataType * const trainingPredictorScores, const size_t cValidationInstances, const void * const validationTargets, const BinnedDataView * const pValidationBinnedData, const FractionalDataType * const validationPredictorScores, const size_t cInnerBags) {
+   LOG_N(TraceLevelInfo, "AllocateCoreTraining using the %s kernels", g_pIsaKernels->m_sInstructionSet);
+
+   size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+
+   if(IsMultiplyError(cVectorLength, cTrainingInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCore IsMultiplyError(cVectorLength, cTrainingInstances)");
+      return nullptr;
+   }
+   if(IsMultiplyError(cVectorLength, cValidationInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCore IsMultiplyError(cVectorLength, cValidationInstances)");
+      return nullptr;
+   }
+
+#ifndef NDEBUG
+   CheckTargets(runtimeLearningTypeOrCountTargetClasses, cTrainingInstances, trainingTargets);
+   CheckTargets(runtimeLearningTypeOrCountTargetClasses, cValidationInstances, validationTargets);
+#endif // NDEBUG
+
+   // callers like joblib often train several models side by side, so we start on the calling thread alone and let them opt into more threads
+   const size_t cThreads = 1;
+
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingState");
+   EbmTrainingState * const pEbmTrainingState = new (std::nothrow) EbmTrainingState(runtimeLearningTypeOrCountTargetClasses, cFeatures, cFeatureCombinations, cInnerBags, cThreads);
+   LOG_N(TraceLevelInfo, "Exited EbmTrainingState %p", static_cast<void *>(pEbmTrainingState));
+   if(UNLIKELY(nullptr == pEbmTrainingState)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCore nullptr == pEbmTrainingState");
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmTrainingState->Initialize(randomSeed, features, featureCombinations, featureCombinationIndexes, cTrainingInstances, trainingTargets, pTrainingBinnedData, trainingPredictorScores, cValidationInstances, validationTargets, pValidationBinnedData, validationPredictorScores))) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCore pEbmTrainingState->Initialize");
+      delete pEbmTrainingState;
+      return nullptr;
+   }
+   return pEbmTrainingState;
+}
+
+
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
-EbmTrainingState * AllocateCoreTraining(const IntegerDataType randomSeed, const IntegerDataType countFeatures, const EbmCoreFeature * const features, const IntegerDataType countFeatureCombinations, const EbmCoreFeatureCombination * const featureCombinations, const IntegerDataType * const featureCombinationIndexes, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const IntegerDataType countTrainingInstances, const void * const trainingTargets, const IntegerDataType * const trainingBinnedData, const FractionalDataType * const trainingPredictorScores, const IntegerDataType countValidationInstances, const void * const validationTargets, const IntegerDataType * const validationBinnedData, const FractionalDataType * const validationPredictorScores, const IntegerDataType countInnerBags) {
+EbmTrainingState * AllocateCoreTraining(const IntegerDataType randomSeed, const IntegerDataType countFeatures, const EbmCoreFeature * const features, const IntegerDataType countFeatureCombinations, const EbmCoreFeatureCombination * const featureCombinations, const IntegerDataType * const featureCombinationIndexes, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const IntegerDataType countTrainingInstances, const void * const trainingTargets, const EbmCoreBinnedData * const trainingBinnedData, const FractionalDataType * const trainingPredictorScores, const IntegerDataType countValidationInstances, const void * const validationTargets, const EbmCoreBinnedData * const validationBinnedData, const FractionalDataType * const validationPredictorScores, const IntegerDataType countInnerBags) {
    // TODO: turn these EBM_ASSERTS into log errors!!  Small checks like this of our wrapper's inputs hardly cost anything, and catch issues faster
 
    // randomSeed can be any value
@@ -904,35 +1299,78 @@ EbmTrainingState * AllocateCoreTraining(const IntegerDataType randomSeed, const
    size_t cValidationInstances = static_cast<size_t>(countValidationInstances);
    size_t cInnerBags = static_cast<size_t>(countInnerBags);
 
-   size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
-
-   if(IsMultiplyError(cVectorLength, cTrainingInstances)) {
-      LOG_0(TraceLevelWarning, "WARNING AllocateCore IsMultiplyError(cVectorLength, cTrainingInstances)");
+   BinnedDataView trainingBinnedDataView;
+   if(trainingBinnedDataView.Initialize(cFeatures, cTrainingInstances, trainingBinnedData)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCore trainingBinnedDataView.Initialize");
       return nullptr;
    }
-   if(IsMultiplyError(cVectorLength, cValidationInstances)) {
-      LOG_0(TraceLevelWarning, "WARNING AllocateCore IsMultiplyError(cVectorLength, cValidationInstances)");
+   BinnedDataView validationBinnedDataView;
+   if(validationBinnedDataView.Initialize(cFeatures, cValidationInstances, validationBinnedData)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCore validationBinnedDataView.Initialize");
       return nullptr;
    }
 
-#ifndef NDEBUG
-   CheckTargets(runtimeLearningTypeOrCountTargetClasses, cTrainingInstances, trainingTargets);
-   CheckTargets(runtimeLearningTypeOrCountTargetClasses, cValidationInstances, validationTargets);
-#endif // NDEBUG
+   return AllocateCoreTrainingState(randomSeed, cFeatures, features, cFeatureCombinations, featureCombinations, featureCombinationIndexes, runtimeLearningTypeOrCountTargetClasses, cTrainingInstances, trainingTargets, &trainingBinnedDataView, trainingPredictorScores, cValidationInstances, validationTargets, &validationBinnedDataView, validationPredictorScores, cInnerBags);
+}
 
-   LOG_0(TraceLevelInfo, "Entered EbmTrainingState");
-   EbmTrainingState * const pEbmTrainingState = new (std::nothrow) EbmTrainingState(runtimeLearningTypeOrCountTargetClasses, cFeatures, cFeatureCombinations, cInnerBags);
-   LOG_N(TraceLevelInfo, "Exited EbmTrainingState %p", static_cast<void *>(pEbmTrainingState));
-   if(UNLIKELY(nullptr == pEbmTrainingState)) {
-      LOG_0(TraceLevelWarning, "WARNING AllocateCore nullptr == pEbmTrainingState");
+EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingRegressionStrided(
+   IntegerDataType randomSeed,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTrainingInstances,
+   const FractionalDataType * trainingTargets,
+   const EbmCoreBinnedData * trainingBinnedData,
+   const FractionalDataType * trainingPredictorScores,
+   IntegerDataType countValidationInstances,
+   const FractionalDataType * validationTargets,
+   const EbmCoreBinnedData * validationBinnedData,
+   const FractionalDataType * validationPredictorScores,
+   IntegerDataType countInnerBags
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeTrainingRegressionStrided: randomSeed=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, trainingPredictorScores=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf, randomSeed, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), static_cast<const void *>(trainingPredictorScores), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData), static_cast<const void *>(validationPredictorScores), countInnerBags);
+   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(AllocateCoreTraining(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, k_Regression, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags));
+   LOG_N(TraceLevelInfo, "Exited InitializeTrainingRegressionStrided %p", static_cast<void *>(pEbmTraining));
+   return pEbmTraining;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingClassificationStrided(
+   IntegerDataType randomSeed,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countTrainingInstances,
+   const IntegerDataType * trainingTargets,
+   const EbmCoreBinnedData * trainingBinnedData,
+   const FractionalDataType * trainingPredictorScores,
+   IntegerDataType countValidationInstances,
+   const IntegerDataType * validationTargets,
+   const EbmCoreBinnedData * validationBinnedData,
+   const FractionalDataType * validationPredictorScores,
+   IntegerDataType countInnerBags
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeTrainingClassificationStrided: randomSeed=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTargetClasses=%" IntegerDataTypePrintf ", countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, trainingPredictorScores=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf, randomSeed, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTargetClasses, countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), static_cast<const void *>(trainingPredictorScores), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData), static_cast<const void *>(validationPredictorScores), countInnerBags);
+   if(countTargetClasses < 0) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingClassificationStrided countTargetClasses can't be negative");
       return nullptr;
    }
-   if(UNLIKELY(pEbmTrainingState->Initialize(randomSeed, features, featureCombinations, featureCombinationIndexes, cTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, cValidationInstances, validationTargets, validationBinnedData, validationPredictorScores))) {
-      LOG_0(TraceLevelWarning, "WARNING AllocateCore pEbmTrainingState->Initialize");
-      delete pEbmTrainingState;
+   if(0 == countTargetClasses && (0 != countTrainingInstances || 0 != countValidationInstances)) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingClassificationStrided countTargetClasses can't be zero unless there are no training and no validation cases");
       return nullptr;
    }
-   return pEbmTrainingState;
+   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingClassificationStrided !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      return nullptr;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
+   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(AllocateCoreTraining(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, runtimeLearningTypeOrCountTargetClasses, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags));
+   LOG_N(TraceLevelInfo, "Exited InitializeTrainingClassificationStrided %p", static_cast<void *>(pEbmTraining));
+   return pEbmTraining;
 }
 
 EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingRegression(
@@ -953,7 +1391,10 @@ EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTra
    IntegerDataType countInnerBags
 ) {
    LOG_N(TraceLevelInfo, "Entered InitializeTrainingRegression: randomSeed=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, trainingPredictorScores=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf, randomSeed, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), static_cast<const void *>(trainingPredictorScores), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData), static_cast<const void *>(validationPredictorScores), countInnerBags);
-   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(AllocateCoreTraining(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, k_Regression, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags));
+   // our original interface takes IntegerDataType values in feature major order
+   const EbmCoreBinnedData trainingBinnedDataFeatureMajor = { BinnedDataTypeInt64, 1, countTrainingInstances, trainingBinnedData };
+   const EbmCoreBinnedData validationBinnedDataFeatureMajor = { BinnedDataTypeInt64, 1, countValidationInstances, validationBinnedData };
+   const PEbmTraining pEbmTraining = InitializeTrainingRegressionStrided(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, countTrainingInstances, trainingTargets, &trainingBinnedDataFeatureMajor, trainingPredictorScores, countValidationInstances, validationTargets, &validationBinnedDataFeatureMajor, validationPredictorScores, countInnerBags);
    LOG_N(TraceLevelInfo, "Exited InitializeTrainingRegression %p", static_cast<void *>(pEbmTraining));
    return pEbmTraining;
 }
@@ -977,34 +1418,258 @@ EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTra
    IntegerDataType countInnerBags
 ) {
    LOG_N(TraceLevelInfo, "Entered InitializeTrainingClassification: randomSeed=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTargetClasses=%" IntegerDataTypePrintf ", countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, trainingPredictorScores=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf, randomSeed, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTargetClasses, countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), static_cast<const void *>(trainingPredictorScores), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData), static_cast<const void *>(validationPredictorScores), countInnerBags);
-   if(countTargetClasses < 0) {
-      LOG_0(TraceLevelError, "ERROR InitializeTrainingClassification countTargetClasses can't be negative");
+   // our original interface takes IntegerDataType values in feature major order
+   const EbmCoreBinnedData trainingBinnedDataFeatureMajor = { BinnedDataTypeInt64, 1, countTrainingInstances, trainingBinnedData };
+   const EbmCoreBinnedData validationBinnedDataFeatureMajor = { BinnedDataTypeInt64, 1, countValidationInstances, validationBinnedData };
+   const PEbmTraining pEbmTraining = InitializeTrainingClassificationStrided(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, countTargetClasses, countTrainingInstances, trainingTargets, &trainingBinnedDataFeatureMajor, trainingPredictorScores, countValidationInstances, validationTargets, &validationBinnedDataFeatureMajor, validationPredictorScores, countInnerBags);
+   LOG_N(TraceLevelInfo, "Exited InitializeTrainingClassification %p", static_cast<void *>(pEbmTraining));
+   return pEbmTraining;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingFromDataSet(
+   IntegerDataType randomSeed,
+   PEbmDataSet ebmDataSet,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTrainingInstances,
+   const IntegerDataType * trainingInstanceIndexes,
+   const FractionalDataType * trainingPredictorScores,
+   IntegerDataType countValidationInstances,
+   const IntegerDataType * validationInstanceIndexes,
+   const FractionalDataType * validationPredictorScores,
+   IntegerDataType countInnerBags
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeTrainingFromDataSet: randomSeed=%" IntegerDataTypePrintf ", ebmDataSet=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTrainingInstances=%" IntegerDataTypePrintf ", trainingInstanceIndexes=%p, trainingPredictorScores=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationInstanceIndexes=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf, randomSeed, static_cast<void *>(ebmDataSet), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTrainingInstances, static_cast<const void *>(trainingInstanceIndexes), static_cast<const void *>(trainingPredictorScores), countValidationInstances, static_cast<const void *>(validationInstanceIndexes), static_cast<const void *>(validationPredictorScores), countInnerBags);
+
+   EbmDataSet * const pEbmDataSet = reinterpret_cast<EbmDataSet *>(ebmDataSet);
+   if(nullptr == pEbmDataSet) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingFromDataSet nullptr == ebmDataSet");
       return nullptr;
    }
-   if(0 == countTargetClasses && (0 != countTrainingInstances || 0 != countValidationInstances)) {
-      LOG_0(TraceLevelError, "ERROR InitializeTrainingClassification countTargetClasses can't be zero unless there are no training and no validation cases");
+   EBM_ASSERT(0 <= countFeatureCombinations);
+   EBM_ASSERT(0 == countFeatureCombinations || nullptr != featureCombinations);
+   EBM_ASSERT(0 <= countTrainingInstances);
+   EBM_ASSERT(0 <= countValidationInstances);
+   EBM_ASSERT(0 <= countInnerBags);
+
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)");
       return nullptr;
    }
-   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
-      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countTrainingInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet !IsNumberConvertable<size_t, IntegerDataType>(countTrainingInstances)");
       return nullptr;
    }
-   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
-   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(AllocateCoreTraining(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, runtimeLearningTypeOrCountTargetClasses, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags));
-   LOG_N(TraceLevelInfo, "Exited InitializeTrainingClassification %p", static_cast<void *>(pEbmTraining));
-   return pEbmTraining;
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countValidationInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet !IsNumberConvertable<size_t, IntegerDataType>(countValidationInstances)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInnerBags)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet !IsNumberConvertable<size_t, IntegerDataType>(countInnerBags)");
+      return nullptr;
+   }
+
+   const size_t cFeatureCombinations = static_cast<size_t>(countFeatureCombinations);
+   const size_t cTrainingInstances = static_cast<size_t>(countTrainingInstances);
+   const size_t cValidationInstances = static_cast<size_t>(countValidationInstances);
+   const size_t cInnerBags = static_cast<size_t>(countInnerBags);
+
+   if(pEbmDataSet->CheckInstanceIndexes(cTrainingInstances, trainingInstanceIndexes)) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingFromDataSet trainingInstanceIndexes");
+      return nullptr;
+   }
+   if(pEbmDataSet->CheckInstanceIndexes(cValidationInstances, validationInstanceIndexes)) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingFromDataSet validationInstanceIndexes");
+      return nullptr;
+   }
+
+   // DataSetByFeatureCombination copies the targets it needs, so a subset only needs a temporary buffer of targets in the order of its indexes
+   void * aTrainingTargetsGathered = nullptr;
+   if(nullptr != trainingInstanceIndexes && 0 != cTrainingInstances) {
+      aTrainingTargetsGathered = pEbmDataSet->GatherTargets(cTrainingInstances, trainingInstanceIndexes);
+      if(nullptr == aTrainingTargetsGathered) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet nullptr == aTrainingTargetsGathered");
+         return nullptr;
+      }
+   }
+   void * aValidationTargetsGathered = nullptr;
+   if(nullptr != validationInstanceIndexes && 0 != cValidationInstances) {
+      aValidationTargetsGathered = pEbmDataSet->GatherTargets(cValidationInstances, validationInstanceIndexes);
+      if(nullptr == aValidationTargetsGathered) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet nullptr == aValidationTargetsGathered");
+         free(aTrainingTargetsGathered);
+         return nullptr;
+      }
+   }
+
+   // a dataset opened from a file can carry the initial predictor scores, which we use unless our caller gives us their own
+   const FractionalDataType * aTrainingPredictorScores = nullptr;
+   FractionalDataType * aTrainingPredictorScoresGathered = nullptr;
+   const FractionalDataType * aValidationPredictorScores = nullptr;
+   FractionalDataType * aValidationPredictorScoresGathered = nullptr;
+   EbmTrainingState * pEbmTrainingState = nullptr;
+   if(pEbmDataSet->GetStartingPredictorScores(trainingPredictorScores, cTrainingInstances, trainingInstanceIndexes, &aTrainingPredictorScores, &aTrainingPredictorScoresGathered)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet GetStartingPredictorScores training");
+   } else if(pEbmDataSet->GetStartingPredictorScores(validationPredictorScores, cValidationInstances, validationInstanceIndexes, &aValidationPredictorScores, &aValidationPredictorScoresGathered)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet GetStartingPredictorScores validation");
+   } else {
+      BinnedDataView trainingBinnedDataView;
+      pEbmDataSet->InitializeBinnedDataView(&trainingBinnedDataView, trainingInstanceIndexes);
+      BinnedDataView validationBinnedDataView;
+      pEbmDataSet->InitializeBinnedDataView(&validationBinnedDataView, validationInstanceIndexes);
+
+      pEbmTrainingState = AllocateCoreTrainingState(randomSeed, pEbmDataSet->m_cFeatures, pEbmDataSet->m_aEbmCoreFeatures, cFeatureCombinations, featureCombinations, featureCombinationIndexes, pEbmDataSet->m_runtimeLearningTypeOrCountTargetClasses, cTrainingInstances, nullptr == aTrainingTargetsGathered ? pEbmDataSet->m_aTargets : aTrainingTargetsGathered, &trainingBinnedDataView, aTrainingPredictorScores, cValidationInstances, nullptr == aValidationTargetsGathered ? pEbmDataSet->m_aTargets : aValidationTargetsGathered, &validationBinnedDataView, aValidationPredictorScores, cInnerBags);
+      if(nullptr != pEbmTrainingState) {
+         // single feature combinations over every instance read the dataset's bit packed columns in place, so we keep the dataset alive
+         pEbmDataSet->AddReference();
+         pEbmTrainingState->m_pSharedDataSet = pEbmDataSet;
+      }
+   }
+
+   free(aValidationPredictorScoresGathered);
+   free(aTrainingPredictorScoresGathered);
+   free(aValidationTargetsGathered);
+   free(aTrainingTargetsGathered);
+
+   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(pEbmTrainingState);
+
+   LOG_N(TraceLevelInfo, "Exited InitializeTrainingFromDataSet %p", static_cast<void *>(pEbmTraining));
+   return pEbmTraining;
+}
+
+template<bool bClassification>
+EBM_INLINE CachedTrainingThreadResources<bClassification> * GetCachedThreadResources(EbmTrainingState * pEbmTrainingState, const size_t iWorker);
+template<>
+EBM_INLINE CachedTrainingThreadResources<true> * GetCachedThreadResources<true>(EbmTrainingState * pEbmTrainingState, const size_t iWorker) {
+   EBM_ASSERT(iWorker < pEbmTrainingState->m_cWorkerThreads);
+   return 0 == iWorker ? &pEbmTrainingState->m_cachedThreadResourcesUnion.classification : &pEbmTrainingState->m_apAdditionalWorkerCachedThreadResources[iWorker - 1]->classification;
+}
+template<>
+EBM_INLINE CachedTrainingThreadResources<false> * GetCachedThreadResources<false>(EbmTrainingState * pEbmTrainingState, const size_t iWorker) {
+   EBM_ASSERT(iWorker < pEbmTrainingState->m_cWorkerThreads);
+   return 0 == iWorker ? &pEbmTrainingState->m_cachedThreadResourcesUnion.regression : &pEbmTrainingState->m_apAdditionalWorkerCachedThreadResources[iWorker - 1]->regression;
+}
+
+EBM_INLINE static SegmentedTensor<ActiveDataType, FractionalDataType> * GetSmallChangeToModelOverwrite(EbmTrainingState * pEbmTrainingState, const size_t iWorker) {
+   EBM_ASSERT(iWorker < pEbmTrainingState->m_cWorkerThreads);
+   return 0 == iWorker ? pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet : pEbmTrainingState->m_apAdditionalWorkerSmallChangeToModelOverwrite[iWorker - 1];
+}
+
+// the sampling sets are trained concurrently, but they are merged into m_pSmallChangeToModelAccumulatedFromSamplingSets strictly in sampling set order.
+// Floating point addition isn't associative, so merging in a fixed order gives us the exact same model as the single threaded loop regardless of the number of workers
+struct SamplingSetMerge final {
+   std::mutex m_mutex;
+   std::condition_variable m_conditionVariable;
+   size_t m_iSamplingSetNextMerge;
+   bool m_bError;
+   FractionalDataType m_totalGain;
+   size_t m_cAdditionalWorkersFinished;
+
+   EBM_INLINE SamplingSetMerge()
+      : m_mutex()
+      , m_conditionVariable()
+      , m_iSamplingSetNextMerge(0)
+      , m_bError(false)
+      , m_totalGain(0)
+      , m_cAdditionalWorkersFinished(0) {
+   }
+
+   EBM_INLINE void SetError() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_bError = true;
+      m_conditionVariable.notify_all();
+   }
+
+   // after this, an additional worker must not touch this object since the calling thread is free to destroy it
+   EBM_INLINE void FinishAdditionalWorker() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      ++m_cAdditionalWorkersFinished;
+      m_conditionVariable.notify_all();
+   }
+
+   EBM_INLINE void WaitForAdditionalWorkers(const size_t cAdditionalWorkers) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_conditionVariable.wait(lock, [this, cAdditionalWorkers] { return cAdditionalWorkers == m_cAdditionalWorkersFinished; });
+   }
+};
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static bool TrainSamplingSet(EbmTrainingState * const pEbmTrainingState, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, const SamplingMethod * const pSamplingSet, const FeatureCombinationCore * const pFeatureCombination, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, FractionalDataType * const pGain) {
+   if(0 == pFeatureCombination->m_cFeatures) {
+      return TrainZeroDimensional<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pSamplingSet, pSmallChangeToModelOverwriteSingleSamplingSet, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   } else if(1 == pFeatureCombination->m_cFeatures) {
+      return TrainSingleDimensional<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pSamplingSet, pFeatureCombination, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, pSmallChangeToModelOverwriteSingleSamplingSet, pGain, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   } else {
+      return TrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, 0>(pCachedThreadResources, pSamplingSet, pFeatureCombination, pSmallChangeToModelOverwriteSingleSamplingSet, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   }
+}
+
+// worker iWorker trains sampling sets iWorker, iWorker + cWorkers, iWorker + 2 * cWorkers, etc.  Each sampling set is merged as soon as it is ready and all the sampling sets before it
+// have been merged, so merging overlaps with the other workers' training instead of being done by the main thread at the end
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static void TrainSamplingSetsWorker(EbmTrainingState * const pEbmTrainingState, const size_t iWorker, const size_t cWorkers, const FeatureCombinationCore * const pFeatureCombination, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, SamplingSetMerge * const pSamplingSetMerge) {
+   try {
+      CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources = GetCachedThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pEbmTrainingState, iWorker);
+      pCachedThreadResources->SetBinningThreads(pEbmTrainingState->m_pThreadPool, pEbmTrainingState->m_cBinningThreadsPerWorker);
+      SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet = GetSmallChangeToModelOverwrite(pEbmTrainingState, iWorker);
+      pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDimensions(pFeatureCombination->m_cFeatures);
+      // if the last update already binned the training set for this feature combination, then binning each sampling set is just a copy
+      const unsigned char * const aPrebinnedHistograms = pFeatureCombination == pEbmTrainingState->m_pFeatureCombinationPrebinned ? pEbmTrainingState->m_aPrebinnedHistograms : nullptr;
+
+      const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+      for(size_t iSamplingSet = iWorker; iSamplingSet < cSamplingSetsAfterZero; iSamplingSet += cWorkers) {
+         pCachedThreadResources->SetPrebinnedHistogram(nullptr == aPrebinnedHistograms ? nullptr : aPrebinnedHistograms + iSamplingSet * pEbmTrainingState->m_cBytesPrebinnedHistogram);
+         FractionalDataType gain = 0;
+         const bool bError = TrainSamplingSet<compilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, pCachedThreadResources, pEbmTrainingState->m_apSamplingSets[iSamplingSet], pFeatureCombination, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, pSmallChangeToModelOverwriteSingleSamplingSet, &gain);
+
+         std::unique_lock<std::mutex> lock(pSamplingSetMerge->m_mutex);
+         pSamplingSetMerge->m_conditionVariable.wait(lock, [pSamplingSetMerge, iSamplingSet] { return pSamplingSetMerge->m_bError || iSamplingSet == pSamplingSetMerge->m_iSamplingSetNextMerge; });
+         if(pSamplingSetMerge->m_bError) {
+            // another worker failed, so our result won't be used
+            return;
+         }
+         if(bError || pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Add(*pSmallChangeToModelOverwriteSingleSamplingSet)) {
+            pSamplingSetMerge->m_bError = true;
+         } else {
+            pSamplingSetMerge->m_totalGain += gain;
+            ++pSamplingSetMerge->m_iSamplingSetNextMerge;
+         }
+         pSamplingSetMerge->m_conditionVariable.notify_all();
+         if(pSamplingSetMerge->m_bError) {
+            return;
+         }
+      }
+   } catch(...) {
+      // std::mutex and std::condition_variable can in theory throw system_error exceptions, and we can't let an exception escape a thread pool task
+      LOG_0(TraceLevelWarning, "WARNING TrainSamplingSetsWorker exception");
+      pSamplingSetMerge->SetError();
+   }
 }
 
-template<bool bClassification>
-EBM_INLINE CachedTrainingThreadResources<bClassification> * GetCachedThreadResources(EbmTrainingState * pEbmTrainingState);
-template<>
-EBM_INLINE CachedTrainingThreadResources<true> * GetCachedThreadResources<true>(EbmTrainingState * pEbmTrainingState) {
-   return &pEbmTrainingState->m_cachedThreadResourcesUnion.classification;
-}
-template<>
-EBM_INLINE CachedTrainingThreadResources<false> * GetCachedThreadResources<false>(EbmTrainingState * pEbmTrainingState) {
-   return &pEbmTrainingState->m_cachedThreadResourcesUnion.regression;
-}
+// the arguments for an additional worker that runs TrainSamplingSetsWorker as a task on the thread pool
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+struct SamplingSetsWorkerTask final {
+   EbmTrainingState * m_pEbmTrainingState;
+   size_t m_iWorker;
+   size_t m_cWorkers;
+   const FeatureCombinationCore * m_pFeatureCombination;
+   size_t m_cTreeSplitsMax;
+   size_t m_cInstancesRequiredForParentSplitMin;
+   SamplingSetMerge * m_pSamplingSetMerge;
+
+   static void Run(void * pTaskData) {
+      const SamplingSetsWorkerTask * const pTask = static_cast<const SamplingSetsWorkerTask *>(pTaskData);
+      SamplingSetMerge * const pSamplingSetMerge = pTask->m_pSamplingSetMerge;
+      TrainSamplingSetsWorker<compilerLearningTypeOrCountTargetClasses>(pTask->m_pEbmTrainingState, pTask->m_iWorker, pTask->m_cWorkers, pTask->m_pFeatureCombination, pTask->m_cTreeSplitsMax, pTask->m_cInstancesRequiredForParentSplitMin, pSamplingSetMerge);
+      try {
+         pSamplingSetMerge->FinishAdditionalWorker();
+      } catch(...) {
+         // the calling thread would wait forever for us, but std::mutex only throws if the operating system is in serious trouble
+         LOG_0(TraceLevelError, "ERROR SamplingSetsWorkerTask::Run exception");
+      }
+   }
+};
 
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
@@ -1022,7 +1687,6 @@ static FractionalDataType * GenerateModelFeatureCombinationUpdatePerTargetClasse
    }
 
    const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
-   CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources = GetCachedThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pEbmTrainingState);
    const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination];
    const size_t cDimensions = pFeatureCombination->m_cFeatures;
 
@@ -1034,29 +1698,54 @@ static FractionalDataType * GenerateModelFeatureCombinationUpdatePerTargetClasse
    EBM_ASSERT(!pEbmTrainingState->m_apSamplingSets == !pEbmTrainingState->m_pTrainingSet); // m_pTrainingSet and m_apSamplingSets should be the same null-ness in that they should either both be null or both be non-null (although different non-null values)
    FractionalDataType totalGain = 0;
    if(nullptr != pEbmTrainingState->m_apSamplingSets) {
-      pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDimensions(cDimensions);
-
-      for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
-         FractionalDataType gain = 0;
-         if(0 == pFeatureCombination->m_cFeatures) {
-            if(TrainZeroDimensional<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pEbmTrainingState->m_apSamplingSets[iSamplingSet], pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
-               return nullptr;
-            }
-         } else if(1 == pFeatureCombination->m_cFeatures) {
-            if(TrainSingleDimensional<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pEbmTrainingState->m_apSamplingSets[iSamplingSet], pFeatureCombination, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet, &gain, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
-               return nullptr;
-            }
-         } else {
-            if(TrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, 0>(pCachedThreadResources, pEbmTrainingState->m_apSamplingSets[iSamplingSet], pFeatureCombination, pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
-               return nullptr;
+      const size_t cWorkers = pEbmTrainingState->m_cWorkerThreads < cSamplingSetsAfterZero ? pEbmTrainingState->m_cWorkerThreads : cSamplingSetsAfterZero;
+      SamplingSetMerge samplingSetMerge;
+      if(1 == cWorkers) {
+         TrainSamplingSetsWorker<compilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, 0, 1, pFeatureCombination, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, &samplingSetMerge);
+      } else {
+         EBM_ASSERT(cWorkers <= pEbmTrainingState->m_cWorkerThreads);
+         const size_t cAdditionalWorkers = cWorkers - 1;
+         // the tasks are scratch that we release before returning.  Every step asks for the same amount, so after the first step this reuses arena memory
+         const ArenaAllocator::Mark markScratch = pEbmTrainingState->m_arena.GetMark();
+         SamplingSetsWorkerTask<compilerLearningTypeOrCountTargetClasses> * const aTasks = pEbmTrainingState->m_arena.AllocateArray<SamplingSetsWorkerTask<compilerLearningTypeOrCountTargetClasses>>(cAdditionalWorkers);
+         if(UNLIKELY(nullptr == aTasks)) {
+            LOG_0(TraceLevelWarning, "WARNING GenerateModelFeatureCombinationUpdatePerTargetClasses nullptr == aTasks");
+            pEbmTrainingState->m_arena.ResetToMark(markScratch);
+            return nullptr;
+         }
+         size_t iAdditionalWorker = 0;
+         for(; iAdditionalWorker < cAdditionalWorkers; ++iAdditionalWorker) {
+            SamplingSetsWorkerTask<compilerLearningTypeOrCountTargetClasses> * const pTask = &aTasks[iAdditionalWorker];
+            pTask->m_pEbmTrainingState = pEbmTrainingState;
+            pTask->m_iWorker = iAdditionalWorker + 1;
+            pTask->m_cWorkers = cWorkers;
+            pTask->m_pFeatureCombination = pFeatureCombination;
+            pTask->m_cTreeSplitsMax = cTreeSplitsMax;
+            pTask->m_cInstancesRequiredForParentSplitMin = cInstancesRequiredForParentSplitMin;
+            pTask->m_pSamplingSetMerge = &samplingSetMerge;
+            // there are at least as many pool threads as additional workers, so every one of these tasks can be running at the same time, which
+            // matters since they block waiting for their turn to merge
+            if(pEbmTrainingState->m_pThreadPool->Submit(&SamplingSetsWorkerTask<compilerLearningTypeOrCountTargetClasses>::Run, pTask)) {
+               break;
             }
          }
-         totalGain += gain;
-         // TODO : when we thread this code, let's have each thread take a lock and update the combined line segment.  They'll each do it while the others are working, so there should be no blocking and our final result won't require adding by the main thread
-         if(pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Add(*pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet)) {
-            return nullptr;
+         if(cAdditionalWorkers != iAdditionalWorker) {
+            // the sampling sets assigned to any worker that didn't start will never be merged, so release the workers that did start
+            LOG_0(TraceLevelWarning, "WARNING GenerateModelFeatureCombinationUpdatePerTargetClasses failed to submit worker task");
+            samplingSetMerge.SetError();
+         } else {
+            // the calling thread is worker zero
+            TrainSamplingSetsWorker<compilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, 0, cWorkers, pFeatureCombination, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, &samplingSetMerge);
          }
+         // the tasks reference aTasks and samplingSetMerge, so we can't leave until they have all finished
+         samplingSetMerge.WaitForAdditionalWorkers(iAdditionalWorker);
+         pEbmTrainingState->m_arena.ResetToMark(markScratch);
       }
+      if(samplingSetMerge.m_bError) {
+         return nullptr;
+      }
+      EBM_ASSERT(cSamplingSetsAfterZero == samplingSetMerge.m_iSamplingSetNextMerge);
+      totalGain = samplingSetMerge.m_totalGain;
       totalGain /= static_cast<FractionalDataType>(cSamplingSetsAfterZero);
 
       LOG_0(TraceLevelVerbose, "GenerateModelFeatureCombinationUpdatePerTargetClasses done sampling set loop");
@@ -1211,11 +1900,260 @@ EBMCORE_IMPORT_EXPORT_BODY FractionalDataType * EBMCORE_CALLING_CONVENTION Gener
    return aModelFeatureCombinationUpdateTensor;
 }
 
+// Updating the scores and residuals is independent per instance, so large datasets are split into chunks that are processed in parallel.  The chunk
+// layout depends only on the number of instances, and the validation metric is summed per chunk and then combined in chunk order, so the metric is
+// reproducible regardless of the number of threads
+constexpr size_t k_cInstancesPerUpdateChunkMin = size_t { 32768 };
+constexpr size_t k_cUpdateChunksMax = size_t { 64 };
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static void TrainingSetUpdate(const EbmTrainingState * const pEbmTrainingState, const FeatureCombinationCore * const pFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor) {
+   LOG_0(TraceLevelVerbose, "Entered TrainingSetUpdate");
+
+   DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   const size_t cInstances = pTrainingSet->GetCountInstances();
+   const size_t cItemsPerBitPackDataUnit = 0 == pFeatureCombination->m_cFeatures ? size_t { 1 } : pFeatureCombination->m_cItemsPerBitPackDataUnit;
+   size_t cInstancesPerChunk;
+   const size_t cChunks = GetCountChunks(cInstances, cItemsPerBitPackDataUnit, k_cInstancesPerUpdateChunkMin, k_cUpdateChunksMax, &cInstancesPerChunk);
+   RunChunks(pEbmTrainingState->m_pThreadPool, pEbmTrainingState->m_cThreads, cChunks, [=](const size_t iChunk) {
+      const size_t iInstanceStart = iChunk * cInstancesPerChunk;
+      const size_t cInstancesRemaining = cInstances - iInstanceStart;
+      // TODO : move the target bits branch inside TrainingSetInputFeatureLoop to here outside instead of the feature combination.  The target # of bits is extremely predictable and so we get to only process one sub branch of code below that.  If we do feature combinations here then we have to keep in instruction cache a whole bunch of options
+      TrainingSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstancesRemaining < cInstancesPerChunk ? cInstancesRemaining : cInstancesPerChunk, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   });
+
+   LOG_0(TraceLevelVerbose, "Exited TrainingSetUpdate");
+}
+
+// BoostCycles bins the training set for the next feature combination right after it applies each update, so it fuses the two into a single sweep
+// over the residuals.  Each chunk of instances is updated one small block at a time, and each block is binned into the histogram of every sampling
+// set while its residuals are still in L1, so the residuals are only streamed from memory once instead of twice.  The chunks are the ones that
+// BinDataSetTraining would bin the next feature combination in, each chunk is binned in instance order, and the chunks are reduced in the same tree,
+// so the histograms are bit for bit the ones that updating and binning separately would give us
+constexpr size_t k_cBytesResidualsPerBinNextBlock = size_t { 8192 };
+
+struct BinNextLayout final {
+   size_t m_cHistogramBuckets;
+   size_t m_cBytesHistogram;
+   size_t m_cChunks;
+   size_t m_cInstancesPerChunk;
+   // the histograms of every chunk for every sampling set
+   size_t m_cBytesHistograms;
+};
+
+EBM_INLINE static size_t GetGreatestCommonDivisor(size_t a, size_t b) {
+   while(0 != b) {
+      const size_t remainder = a % b;
+      a = b;
+      b = remainder;
+   }
+   return a;
+}
+
+// returns true if applying an update to pFeatureCombination can't be fused with binning for pFeatureCombinationNext, in which case we do them separately
+static bool GetBinNextLayout(const EbmTrainingState * const pEbmTrainingState, const FeatureCombinationCore * const pFeatureCombination, const FeatureCombinationCore * const pFeatureCombinationNext, BinNextLayout * const pLayout) {
+   const DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   if(nullptr == pTrainingSet) {
+      return true;
+   }
+   const size_t cVectorLength = GetVectorLengthFlatCore(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   const bool bClassification = IsClassification(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   if(bClassification ? GetHistogramBucketSizeOverflow<true>(cVectorLength) : GetHistogramBucketSizeOverflow<false>(cVectorLength)) {
+      return true;
+   }
+   const size_t cBytesPerHistogramBucket = bClassification ? GetHistogramBucketSize<true>(cVectorLength) : GetHistogramBucketSize<false>(cVectorLength);
+   size_t cHistogramBuckets = 1;
+   for(size_t iDimension = 0; iDimension < pFeatureCombinationNext->m_cFeatures; ++iDimension) {
+      const size_t cBins = pFeatureCombinationNext->m_FeatureCombinationEntry[iDimension].m_pFeature->m_cBins;
+      if(IsMultiplyError(cHistogramBuckets, cBins)) {
+         return true;
+      }
+      cHistogramBuckets *= cBins;
+   }
+   if(IsMultiplyError(cHistogramBuckets, cBytesPerHistogramBucket)) {
+      return true;
+   }
+   const size_t cBytesHistogram = cHistogramBuckets * cBytesPerHistogramBucket;
+   // the histograms of every sampling set are updated at random while we sweep a chunk, so together they need to fit in L2
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   if(IsMultiplyError(cSamplingSetsAfterZero, cBytesHistogram) || k_cBytesHistogramChunkL2Max < cSamplingSetsAfterZero * cBytesHistogram) {
+      return true;
+   }
+
+   const size_t cInstances = pTrainingSet->GetCountInstances();
+   const size_t cItemsPerBitPackDataUnit = 0 == pFeatureCombination->m_cFeatures ? size_t { 1 } : pFeatureCombination->m_cItemsPerBitPackDataUnit;
+   const size_t cItemsPerBitPackDataUnitNext = 0 == pFeatureCombinationNext->m_cFeatures ? size_t { 1 } : pFeatureCombinationNext->m_cItemsPerBitPackDataUnit;
+   size_t cInstancesPerChunk;
+   const size_t cChunks = GetCountHistogramChunks(cInstances, cItemsPerBitPackDataUnitNext, cBytesHistogram, &cInstancesPerChunk);
+   if(1 < cChunks && 0 != cInstancesPerChunk % cItemsPerBitPackDataUnit) {
+      // the update needs each chunk to start on a bit packed data unit of the feature combination that it applies to
+      return true;
+   }
+   if(cChunks < pEbmTrainingState->m_cThreads) {
+      // don't give up threads that the separate update would have used
+      size_t cInstancesPerUpdateChunk;
+      if(cChunks < GetCountChunks(cInstances, cItemsPerBitPackDataUnit, k_cInstancesPerUpdateChunkMin, k_cUpdateChunksMax, &cInstancesPerUpdateChunk)) {
+         return true;
+      }
+   }
+
+   // GetCountHistogramChunks makes at most k_cHistogramChunksMax chunks, and the histograms of a chunk fit in L2, so this can't overflow
+   pLayout->m_cHistogramBuckets = cHistogramBuckets;
+   pLayout->m_cBytesHistogram = cBytesHistogram;
+   pLayout->m_cChunks = cChunks;
+   pLayout->m_cInstancesPerChunk = cInstancesPerChunk;
+   pLayout->m_cBytesHistograms = cChunks * cSamplingSetsAfterZero * cBytesHistogram;
+   return false;
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static void TrainingSetUpdateBinNext(const EbmTrainingState * const pEbmTrainingState, const FeatureCombinationCore * const pFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const FeatureCombinationCore * const pFeatureCombinationNext, const BinNextLayout * const pLayout) {
+   LOG_0(TraceLevelVerbose, "Entered TrainingSetUpdateBinNext");
+
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses;
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   const size_t cInstances = pTrainingSet->GetCountInstances();
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   const SamplingMethod * const * const apSamplingSets = pEbmTrainingState->m_apSamplingSets;
+   unsigned char * const aHistograms = pEbmTrainingState->m_aPrebinnedHistograms;
+   EBM_ASSERT(nullptr != aHistograms);
+   EBM_ASSERT(pLayout->m_cBytesHistograms <= pEbmTrainingState->m_cBytesPrebinnedHistogramsCapacity);
+   const size_t cBytesHistogram = pLayout->m_cBytesHistogram;
+   const size_t cInstancesPerChunk = pLayout->m_cInstancesPerChunk;
+
+   // every block starts on a bit packed data unit of both feature combinations
+   const size_t cItemsPerBitPackDataUnit = 0 == pFeatureCombination->m_cFeatures ? size_t { 1 } : pFeatureCombination->m_cItemsPerBitPackDataUnit;
+   const size_t cItemsPerBitPackDataUnitNext = 0 == pFeatureCombinationNext->m_cFeatures ? size_t { 1 } : pFeatureCombinationNext->m_cItemsPerBitPackDataUnit;
+   const size_t cItemsPerBlockUnit = cItemsPerBitPackDataUnit / GetGreatestCommonDivisor(cItemsPerBitPackDataUnit, cItemsPerBitPackDataUnitNext) * cItemsPerBitPackDataUnitNext;
+   const size_t cInstancesPerBlockTarget = k_cBytesResidualsPerBinNextBlock / (sizeof(StorageFractionalDataTypeCore) * cVectorLength);
+   const size_t cInstancesPerBlock = cInstancesPerBlockTarget <= cItemsPerBlockUnit ? cItemsPerBlockUnit : cInstancesPerBlockTarget - cInstancesPerBlockTarget % cItemsPerBlockUnit;
+
+   // the histograms of a chunk are next to each other, so the histograms of chunk zero are the ones in the layout that TrainSamplingSetsWorker expects
+   auto GetHistogram = [=](const size_t iChunk, const size_t iSamplingSet) -> HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * {
+      return reinterpret_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(aHistograms + (iChunk * cSamplingSetsAfterZero + iSamplingSet) * cBytesHistogram);
+   };
+
+   RunChunks(pEbmTrainingState->m_pThreadPool, pEbmTrainingState->m_cThreads, pLayout->m_cChunks, [=](const size_t iChunk) {
+      // zero the histograms of our chunk on the thread that bins into them so that they're in that thread's cache
+      memset(GetHistogram(iChunk, 0), 0, cSamplingSetsAfterZero * cBytesHistogram);
+      const size_t iInstanceChunkStart = iChunk * cInstancesPerChunk;
+      const size_t cInstancesChunkRemaining = cInstances - iInstanceChunkStart;
+      const size_t iInstanceChunkEnd = iInstanceChunkStart + (cInstancesChunkRemaining < cInstancesPerChunk ? cInstancesChunkRemaining : cInstancesPerChunk);
+      for(size_t iInstanceStart = iInstanceChunkStart; iInstanceStart < iInstanceChunkEnd; iInstanceStart += cInstancesPerBlock) {
+         const size_t cInstancesRemaining = iInstanceChunkEnd - iInstanceStart;
+         const size_t cInstancesBlock = cInstancesRemaining < cInstancesPerBlock ? cInstancesRemaining : cInstancesPerBlock;
+         TrainingSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pTrainingSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstancesBlock, runtimeLearningTypeOrCountTargetClasses);
+         for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+            HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets = GetHistogram(iChunk, iSamplingSet);
+            if(0 == pFeatureCombinationNext->m_cFeatures) {
+               BinDataSetTrainingZeroDimensionsChunk<compilerLearningTypeOrCountTargetClasses>(aHistogramBuckets, apSamplingSets[iSamplingSet], iInstanceStart, cInstancesBlock, runtimeLearningTypeOrCountTargetClasses);
+            } else {
+               BinDataSetTrainingChunk<compilerLearningTypeOrCountTargetClasses>(aHistogramBuckets, pFeatureCombinationNext, apSamplingSets[iSamplingSet], iInstanceStart, cInstancesBlock, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+                  , reinterpret_cast<const unsigned char *>(aHistogramBuckets) + cBytesHistogram
+#endif // NDEBUG
+               );
+            }
+         }
+      }
+   });
+
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      ReduceHistogramChunks<compilerLearningTypeOrCountTargetClasses>(pLayout->m_cHistogramBuckets, pLayout->m_cChunks, runtimeLearningTypeOrCountTargetClasses, [=](const size_t iChunk) {
+         return GetHistogram(iChunk, iSamplingSet);
+      });
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited TrainingSetUpdateBinNext");
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static FractionalDataType ValidationSetUpdate(const EbmTrainingState * const pEbmTrainingState, const FeatureCombinationCore * const pFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor) {
+   LOG_0(TraceLevelVerbose, "Entered ValidationSetUpdate");
+
+   DataSetByFeatureCombination * const pValidationSet = pEbmTrainingState->m_pValidationSet;
+   const size_t cInstances = pValidationSet->GetCountInstances();
+   const size_t cItemsPerBitPackDataUnit = 0 == pFeatureCombination->m_cFeatures ? size_t { 1 } : pFeatureCombination->m_cItemsPerBitPackDataUnit;
+   size_t cInstancesPerChunk;
+   const size_t cChunks = GetCountChunks(cInstances, cItemsPerBitPackDataUnit, k_cInstancesPerUpdateChunkMin, k_cUpdateChunksMax, &cInstancesPerChunk);
+   FractionalDataType aChunkMetrics[k_cUpdateChunksMax];
+   RunChunks(pEbmTrainingState->m_pThreadPool, pEbmTrainingState->m_cThreads, cChunks, [=, &aChunkMetrics](const size_t iChunk) {
+      const size_t iInstanceStart = iChunk * cInstancesPerChunk;
+      const size_t cInstancesRemaining = cInstances - iInstanceStart;
+      // TODO : move the target bits branch inside TrainingSetInputFeatureLoop to here outside instead of the feature combination.  The target # of bits is extremely predictable and so we get to only process one sub branch of code below that.  If we do feature combinations here then we have to keep in instruction cache a whole bunch of options
+      aChunkMetrics[iChunk] = ValidationSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, iInstanceStart, cInstancesRemaining < cInstancesPerChunk ? cInstancesRemaining : cInstancesPerChunk, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   });
+   FractionalDataType metric = 0;
+   for(size_t iChunk = 0; iChunk < cChunks; ++iChunk) {
+      metric += aChunkMetrics[iChunk];
+   }
+   if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
+      // for regression we return the root mean square error
+      metric = sqrt(metric / cInstances);
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited ValidationSetUpdate");
+   return metric;
+}
+
+// the validation metric of a bag in an ensemble.  The training set update has already applied the model update to every instance, including the ones that
+// this bag holds out, so all we need to do is read back the residuals or scores of the held out instances
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static FractionalDataType ValidationSubsetMetric(const EbmTrainingState * const pEbmTrainingState) {
+   LOG_0(TraceLevelVerbose, "Entered ValidationSubsetMetric");
+
+   const DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   EBM_ASSERT(nullptr != pTrainingSet);
+   const size_t cInstances = pEbmTrainingState->m_cValidationSubsetInstances;
+   EBM_ASSERT(0 < cInstances);
+   const size_t * pInstanceIndex = pEbmTrainingState->m_aValidationSubsetInstanceIndexes;
+   const size_t * const pInstanceIndexEnd = pInstanceIndex + cInstances;
+
+   FractionalDataType metric = 0;
+   if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
+      const StorageFractionalDataTypeCore * const aResidualErrors = pTrainingSet->GetResidualPointer();
+      do {
+         const FractionalDataType residualError = static_cast<FractionalDataType>(aResidualErrors[*pInstanceIndex]);
+         metric += residualError * residualError;
+         ++pInstanceIndex;
+      } while(pInstanceIndexEnd != pInstanceIndex);
+      // for regression we return the root mean square error
+      metric = sqrt(metric / cInstances);
+   } else {
+      EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
+      const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+      const StorageFractionalDataTypeCore * const aPredictorScores = pTrainingSet->GetPredictorScores();
+      const StorageDataTypeCore * const aTargetData = pTrainingSet->GetTargetDataPointer();
+      do {
+         const size_t iInstance = *pInstanceIndex;
+         const StorageDataTypeCore targetData = aTargetData[iInstance];
+         const StorageFractionalDataTypeCore * const pPredictorScores = &aPredictorScores[cVectorLength * iInstance];
+         if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
+            metric += EbmStatistics::ComputeClassificationSingleInstanceLogLossBinaryclass(static_cast<FractionalDataType>(*pPredictorScores), targetData);
+         } else {
+            FractionalDataType sumExp = 0;
+            size_t iVector = 0;
+            do {
+               sumExp += std::exp(static_cast<FractionalDataType>(pPredictorScores[iVector]));
+               ++iVector;
+            } while(iVector < cVectorLength);
+            metric += EbmStatistics::ComputeClassificationSingleInstanceLogLossMulticlass(sumExp, pPredictorScores, targetData);
+         }
+         ++pInstanceIndex;
+      } while(pInstanceIndexEnd != pInstanceIndex);
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited ValidationSubsetMetric");
+   return metric;
+}
+
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
+// if pFeatureCombinationBinNext isn't nullptr, we also bin the training set for it in the same pass if we can
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, FractionalDataType * const pValidationMetricReturn) {
+static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FeatureCombinationCore * const pFeatureCombinationBinNext, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, FractionalDataType * const pValidationMetricReturn) {
    LOG_0(TraceLevelVerbose, "Entered ApplyModelFeatureCombinationUpdatePerTargetClasses");
 
    EBM_ASSERT(nullptr != pEbmTrainingState->m_apCurrentModel); // m_apCurrentModel can be null if there are no featureCombinations (but we have an feature combination index), or if the target has 1 or 0 classes (which we check before calling this function), so it shouldn't be possible to be null
@@ -1226,14 +2164,22 @@ static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTra
 
    const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination];
 
+   // the residuals are about to change, so anything binned from them is stale
+   pEbmTrainingState->m_pFeatureCombinationPrebinned = nullptr;
    // if the count of training instances is zero, then pEbmTrainingState->m_pTrainingSet will be nullptr
    if(nullptr != pEbmTrainingState->m_pTrainingSet) {
-      // TODO : move the target bits branch inside TrainingSetInputFeatureLoop to here outside instead of the feature combination.  The target # of bits is extremely predictable and so we get to only process one sub branch of code below that.  If we do feature combinations here then we have to keep in instruction cache a whole bunch of options
-      TrainingSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pEbmTrainingState->m_pTrainingSet, aModelFeatureCombinationUpdateTensor, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+      BinNextLayout binNextLayout;
+      if(nullptr != pFeatureCombinationBinNext && !GetBinNextLayout(pEbmTrainingState, pFeatureCombination, pFeatureCombinationBinNext, &binNextLayout) && binNextLayout.m_cBytesHistograms <= pEbmTrainingState->m_cBytesPrebinnedHistogramsCapacity) {
+         TrainingSetUpdateBinNext<compilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, pFeatureCombination, aModelFeatureCombinationUpdateTensor, pFeatureCombinationBinNext, &binNextLayout);
+         pEbmTrainingState->m_pFeatureCombinationPrebinned = pFeatureCombinationBinNext;
+         pEbmTrainingState->m_cBytesPrebinnedHistogram = binNextLayout.m_cBytesHistogram;
+      } else {
+         TrainingSetUpdate<compilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, pFeatureCombination, aModelFeatureCombinationUpdateTensor);
+      }
    }
 
    FractionalDataType modelMetric = 0;
-   if(nullptr != pEbmTrainingState->m_pValidationSet) {
+   if(nullptr != pEbmTrainingState->m_pValidationSet || 0 != pEbmTrainingState->m_cValidationSubsetInstances) {
       // if there is no validation set, it's pretty hard to know what the metric we'll get for our validation set
       // we could in theory return anything from zero to infinity or possibly, NaN (probably legally the best), but we return 0 here
       // because we want to kick our caller out of any loop it might be calling us in.  Infinity and NaN are odd values that might cause problems in
@@ -1244,9 +2190,11 @@ static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTra
       // if the count of training instances is zero, don't update the best model (it will stay as all zeros), and we don't need to update our non-existant training set either
       // C++ doesn't define what happens when you compare NaN to annother number.  It probably follows IEEE 754, but it isn't guaranteed, so let's check for zero instances in the validation set this better way   https://stackoverflow.com/questions/31225264/what-is-the-result-of-comparing-a-number-with-nan
 
-      // TODO : move the target bits branch inside TrainingSetInputFeatureLoop to here outside instead of the feature combination.  The target # of bits is extremely predictable and so we get to only process one sub branch of code below that.  If we do feature combinations here then we have to keep in instruction cache a whole bunch of options
-
-      modelMetric = ValidationSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pEbmTrainingState->m_pValidationSet, aModelFeatureCombinationUpdateTensor, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+      if(nullptr != pEbmTrainingState->m_pValidationSet) {
+         modelMetric = ValidationSetUpdate<compilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, pFeatureCombination, aModelFeatureCombinationUpdateTensor);
+      } else {
+         modelMetric = ValidationSubsetMetric<compilerLearningTypeOrCountTargetClasses>(pEbmTrainingState);
+      }
 
       // modelMetric is either logloss (classification) or rmse (regression).  In either case we want to minimize it.
       if(LIKELY(modelMetric < pEbmTrainingState->m_bestModelMetric)) {
@@ -1277,34 +2225,36 @@ static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTra
 }
 
 template<ptrdiff_t possibleCompilerLearningTypeOrCountTargetClasses>
-EBM_INLINE IntegerDataType CompilerRecursiveApplyModelFeatureCombinationUpdate(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, FractionalDataType * const pValidationMetricReturn) {
+EBM_INLINE IntegerDataType CompilerRecursiveApplyModelFeatureCombinationUpdate(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FeatureCombinationCore * const pFeatureCombinationBinNext, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, FractionalDataType * const pValidationMetricReturn) {
    static_assert(IsClassification(possibleCompilerLearningTypeOrCountTargetClasses), "possibleCompilerLearningTypeOrCountTargetClasses needs to be a classification");
    EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
    if(possibleCompilerLearningTypeOrCountTargetClasses == runtimeLearningTypeOrCountTargetClasses) {
       EBM_ASSERT(runtimeLearningTypeOrCountTargetClasses <= k_cCompilerOptimizedTargetClassesMax);
-      return ApplyModelFeatureCombinationUpdatePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, iFeatureCombination, aModelFeatureCombinationUpdateTensor, pValidationMetricReturn);
+      return ApplyModelFeatureCombinationUpdatePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, iFeatureCombination, pFeatureCombinationBinNext, aModelFeatureCombinationUpdateTensor, pValidationMetricReturn);
    } else {
-      return CompilerRecursiveApplyModelFeatureCombinationUpdate<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, aModelFeatureCombinationUpdateTensor, pValidationMetricReturn);
+      return CompilerRecursiveApplyModelFeatureCombinationUpdate<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, pFeatureCombinationBinNext, aModelFeatureCombinationUpdateTensor, pValidationMetricReturn);
    }
 }
 
 template<>
-EBM_INLINE IntegerDataType CompilerRecursiveApplyModelFeatureCombinationUpdate<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, FractionalDataType * const pValidationMetricReturn) {
+EBM_INLINE IntegerDataType CompilerRecursiveApplyModelFeatureCombinationUpdate<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FeatureCombinationCore * const pFeatureCombinationBinNext, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, FractionalDataType * const pValidationMetricReturn) {
    UNUSED(runtimeLearningTypeOrCountTargetClasses);
    // it is logically possible, but uninteresting to have a classification with 1 target class, so let our runtime system handle those unlikley and uninteresting cases
    static_assert(IsClassification(k_cCompilerOptimizedTargetClassesMax), "k_cCompilerOptimizedTargetClassesMax needs to be a classification");
    EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
    EBM_ASSERT(k_cCompilerOptimizedTargetClassesMax < runtimeLearningTypeOrCountTargetClasses);
-   return ApplyModelFeatureCombinationUpdatePerTargetClasses<k_DynamicClassification>(pEbmTrainingState, iFeatureCombination, aModelFeatureCombinationUpdateTensor, pValidationMetricReturn);
+   return ApplyModelFeatureCombinationUpdatePerTargetClasses<k_DynamicClassification>(pEbmTrainingState, iFeatureCombination, pFeatureCombinationBinNext, aModelFeatureCombinationUpdateTensor, pValidationMetricReturn);
 }
 
 // we made this a global because if we had put this variable inside the EbmTrainingState object, then we would need to dereference that before getting the count.  By making this global we can send a log message incase a bad EbmTrainingState object is sent into us
 // we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more times than desired, but we can live with that
 static unsigned int g_cLogApplyModelFeatureCombinationUpdateParametersMessages = 10;
 
-EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModelFeatureCombinationUpdate(
+// if pFeatureCombinationBinNext isn't nullptr, the update pass also bins the training set for it when it can
+static IntegerDataType ApplyModelFeatureCombinationUpdateBinNext(
    PEbmTraining ebmTraining,
    IntegerDataType indexFeatureCombination,
+   const FeatureCombinationCore * pFeatureCombinationBinNext,
    const FractionalDataType * modelFeatureCombinationUpdateTensor,
    FractionalDataType * validationMetricReturn
 ) {
@@ -1334,7 +2284,7 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModel
 
    IntegerDataType ret;
    if(IsRegression(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
-      ret = ApplyModelFeatureCombinationUpdatePerTargetClasses<k_Regression>(pEbmTrainingState, iFeatureCombination, modelFeatureCombinationUpdateTensor, validationMetricReturn);
+      ret = ApplyModelFeatureCombinationUpdatePerTargetClasses<k_Regression>(pEbmTrainingState, iFeatureCombination, pFeatureCombinationBinNext, modelFeatureCombinationUpdateTensor, validationMetricReturn);
    } else {
       EBM_ASSERT(IsClassification(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses));
       if(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }) {
@@ -1346,7 +2296,7 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModel
          LOG_COUNTED_0(&pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination]->m_cLogExitApplyModelFeatureCombinationUpdateMessages, TraceLevelInfo, TraceLevelVerbose, "Exited ApplyModelFeatureCombinationUpdate from runtimeLearningTypeOrCountTargetClasses <= 1");
          return 0;
       }
-      ret = CompilerRecursiveApplyModelFeatureCombinationUpdate<2>(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, modelFeatureCombinationUpdateTensor, validationMetricReturn);
+      ret = CompilerRecursiveApplyModelFeatureCombinationUpdate<2>(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, pFeatureCombinationBinNext, modelFeatureCombinationUpdateTensor, validationMetricReturn);
    }
    if(0 != ret) {
       LOG_N(TraceLevelWarning, "WARNING ApplyModelFeatureCombinationUpdate returned %" IntegerDataTypePrintf, ret);
@@ -1360,9 +2310,20 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModel
    return ret;
 }
 
-EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION TrainingStep(
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModelFeatureCombinationUpdate(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   const FractionalDataType * modelFeatureCombinationUpdateTensor,
+   FractionalDataType * validationMetricReturn
+) {
+   return ApplyModelFeatureCombinationUpdateBinNext(ebmTraining, indexFeatureCombination, nullptr, modelFeatureCombinationUpdateTensor, validationMetricReturn);
+}
+
+// a TrainingStep that also bins the training set for pFeatureCombinationBinNext while it applies the update, if pFeatureCombinationBinNext isn't nullptr
+static IntegerDataType TrainingStepBinNext(
    PEbmTraining ebmTraining,
    IntegerDataType indexFeatureCombination,
+   const FeatureCombinationCore * pFeatureCombinationBinNext,
    FractionalDataType learningRate,
    IntegerDataType countTreeSplitsMax,
    IntegerDataType countInstancesRequiredForParentSplitMin,
@@ -1392,7 +2353,209 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION TrainingSt
       EBM_ASSERT(nullptr == validationMetricReturn || 0 == *validationMetricReturn); // rely on GenerateModelUpdate to set the validationMetricReturn to zero on error
       return 1;
    }
-   return ApplyModelFeatureCombinationUpdate(ebmTraining, indexFeatureCombination, pModelFeatureCombinationUpdateTensor, validationMetricReturn);
+   return ApplyModelFeatureCombinationUpdateBinNext(ebmTraining, indexFeatureCombination, pFeatureCombinationBinNext, pModelFeatureCombinationUpdateTensor, validationMetricReturn);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION TrainingStep(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   const FractionalDataType * trainingWeights,
+   const FractionalDataType * validationWeights,
+   FractionalDataType * validationMetricReturn
+) {
+   return TrainingStepBinNext(ebmTraining, indexFeatureCombination, nullptr, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, trainingWeights, validationWeights, validationMetricReturn);
+}
+
+bool EbmTrainingState::IsBoostCyclesParametersError(const IntegerDataType countFeatureCombinationsInCycle, const IntegerDataType * const featureCombinationIndexes, const IntegerDataType countEpisodes, const IntegerDataType countStepsPerFeatureCombination, const FractionalDataType learningRate, const IntegerDataType countTreeSplitsMax, const IntegerDataType countInstancesRequiredForParentSplitMin, const FractionalDataType earlyStoppingTolerance) const {
+   if(countFeatureCombinationsInCycle < 0) {
+      LOG_0(TraceLevelError, "ERROR BoostCycles countFeatureCombinationsInCycle can't be negative");
+      return true;
+   }
+   if(0 != countFeatureCombinationsInCycle && nullptr == featureCombinationIndexes) {
+      LOG_0(TraceLevelError, "ERROR BoostCycles featureCombinationIndexes can't be null unless countFeatureCombinationsInCycle is zero");
+      return true;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinationsInCycle)) {
+      LOG_0(TraceLevelWarning, "WARNING BoostCycles !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinationsInCycle)");
+      return true;
+   }
+   const size_t cFeatureCombinationsInCycle = static_cast<size_t>(countFeatureCombinationsInCycle);
+   for(size_t iCycle = 0; iCycle < cFeatureCombinationsInCycle; ++iCycle) {
+      const IntegerDataType indexFeatureCombination = featureCombinationIndexes[iCycle];
+      if(indexFeatureCombination < 0 || !IsNumberConvertable<size_t, IntegerDataType>(indexFeatureCombination) || m_cFeatureCombinations <= static_cast<size_t>(indexFeatureCombination)) {
+         LOG_0(TraceLevelError, "ERROR BoostCycles featureCombinationIndexes contains an index that is not a valid feature combination");
+         return true;
+      }
+   }
+   if(countEpisodes < 0) {
+      LOG_0(TraceLevelError, "ERROR BoostCycles countEpisodes can't be negative");
+      return true;
+   }
+   if(countStepsPerFeatureCombination < 0) {
+      LOG_0(TraceLevelError, "ERROR BoostCycles countStepsPerFeatureCombination can't be negative");
+      return true;
+   }
+   if(std::isnan(learningRate) || std::isinf(learningRate)) {
+      LOG_0(TraceLevelError, "ERROR BoostCycles learningRate must be a finite number");
+      return true;
+   }
+   if(countTreeSplitsMax < 0) {
+      LOG_0(TraceLevelError, "ERROR BoostCycles countTreeSplitsMax can't be negative");
+      return true;
+   }
+   if(countInstancesRequiredForParentSplitMin < 0) {
+      LOG_0(TraceLevelError, "ERROR BoostCycles countInstancesRequiredForParentSplitMin can't be negative");
+      return true;
+   }
+   if(std::isnan(earlyStoppingTolerance)) {
+      LOG_0(TraceLevelError, "ERROR BoostCycles earlyStoppingTolerance can't be NaN");
+      return true;
+   }
+
+   return false;
+}
+
+bool EbmTrainingState::BoostCycles(const size_t cFeatureCombinationsInCycle, const IntegerDataType * const featureCombinationIndexes, const IntegerDataType countEpisodes, const IntegerDataType countStepsPerFeatureCombination, const FractionalDataType learningRate, const IntegerDataType countTreeSplitsMax, const IntegerDataType countInstancesRequiredForParentSplitMin, const IntegerDataType earlyStoppingRunLength, const FractionalDataType earlyStoppingTolerance, FractionalDataType * const pValidationMetricReturn, IntegerDataType * const pCountEpisodesReturn) {
+   // pValidationMetricReturn can be nullptr
+   // pCountEpisodesReturn can be nullptr
+
+   // always set these, even on errors, so that our caller sees the same values as if no episodes had completed
+   FractionalDataType validationMetric = std::numeric_limits<FractionalDataType>::infinity();
+   size_t cEpisodesCompleted = 0;
+   if(nullptr != pValidationMetricReturn) {
+      *pValidationMetricReturn = validationMetric;
+   }
+   if(nullptr != pCountEpisodesReturn) {
+      *pCountEpisodesReturn = 0;
+   }
+
+   // an episode boosts every feature combination in the cycle once, in the order given.  After each episode we check whether the validation metric
+   // has improved by more than earlyStoppingTolerance on the best metric we had when the current run of non-improving episodes started, and we stop once
+   // that run reaches earlyStoppingRunLength episodes.  A negative earlyStoppingRunLength turns early stopping off
+   FractionalDataType validationMetricMin = std::numeric_limits<FractionalDataType>::infinity();
+   FractionalDataType validationMetricBreakpoint = std::numeric_limits<FractionalDataType>::infinity();
+   IntegerDataType cNoChangeRunLength = 0;
+
+   // we know which feature combination each step boosts next, so each update can bin the training set for it in the same pass.  The histograms
+   // are scratch memory that lives until we return, so we allocate room for the largest ones that any step in the cycle can fuse
+   const ArenaAllocator::Mark markScratch = m_arena.GetMark();
+   EBM_ASSERT(nullptr == m_aPrebinnedHistograms);
+   if(!IsClassification(m_runtimeLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } <= m_runtimeLearningTypeOrCountTargetClasses) {
+      size_t cBytesPrebinnedHistogramsMax = 0;
+      for(size_t iCycle = 0; iCycle < cFeatureCombinationsInCycle; ++iCycle) {
+         const FeatureCombinationCore * const pFeatureCombination = m_apFeatureCombinations[featureCombinationIndexes[iCycle]];
+         const FeatureCombinationCore * const pFeatureCombinationNext = m_apFeatureCombinations[featureCombinationIndexes[iCycle + 1 == cFeatureCombinationsInCycle ? 0 : iCycle + 1]];
+         BinNextLayout binNextLayout;
+         if(!GetBinNextLayout(this, pFeatureCombination, pFeatureCombinationNext, &binNextLayout)) {
+            cBytesPrebinnedHistogramsMax = cBytesPrebinnedHistogramsMax < binNextLayout.m_cBytesHistograms ? binNextLayout.m_cBytesHistograms : cBytesPrebinnedHistogramsMax;
+         }
+         if(1 < countStepsPerFeatureCombination && !GetBinNextLayout(this, pFeatureCombination, pFeatureCombination, &binNextLayout)) {
+            cBytesPrebinnedHistogramsMax = cBytesPrebinnedHistogramsMax < binNextLayout.m_cBytesHistograms ? binNextLayout.m_cBytesHistograms : cBytesPrebinnedHistogramsMax;
+         }
+      }
+      if(0 != cBytesPrebinnedHistogramsMax) {
+         // if we can't get the memory, every step updates and bins separately, which trains the same model
+         m_aPrebinnedHistograms = m_arena.AllocateArray<unsigned char>(cBytesPrebinnedHistogramsMax);
+         m_cBytesPrebinnedHistogramsCapacity = nullptr == m_aPrebinnedHistograms ? size_t { 0 } : cBytesPrebinnedHistogramsMax;
+      }
+   }
+   auto ReleasePrebinnedHistograms = [this, markScratch]() {
+      m_pFeatureCombinationPrebinned = nullptr;
+      m_aPrebinnedHistograms = nullptr;
+      m_cBytesPrebinnedHistogramsCapacity = 0;
+      m_arena.ResetToMark(markScratch);
+   };
+
+   for(IntegerDataType iEpisode = 0; iEpisode < countEpisodes; ++iEpisode) {
+      for(size_t iCycle = 0; iCycle < cFeatureCombinationsInCycle; ++iCycle) {
+         for(IntegerDataType iStep = 0; iStep < countStepsPerFeatureCombination; ++iStep) {
+            // if this is the last step of an episode, we might stop early after it, in which case binning for the next episode is wasted
+            const FeatureCombinationCore * pFeatureCombinationBinNext = nullptr;
+            if(nullptr != m_aPrebinnedHistograms) {
+               if(iStep + 1 < countStepsPerFeatureCombination) {
+                  pFeatureCombinationBinNext = m_apFeatureCombinations[featureCombinationIndexes[iCycle]];
+               } else if(iCycle + 1 < cFeatureCombinationsInCycle) {
+                  pFeatureCombinationBinNext = m_apFeatureCombinations[featureCombinationIndexes[iCycle + 1]];
+               } else if(iEpisode + 1 < countEpisodes) {
+                  pFeatureCombinationBinNext = m_apFeatureCombinations[featureCombinationIndexes[0]];
+               }
+            }
+            if(0 != TrainingStepBinNext(reinterpret_cast<PEbmTraining>(this), featureCombinationIndexes[iCycle], pFeatureCombinationBinNext, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, nullptr, nullptr, &validationMetric)) {
+               LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::BoostCycles TrainingStep failed");
+               ReleasePrebinnedHistograms();
+               return true;
+            }
+         }
+      }
+      ++cEpisodesCompleted;
+      if(nullptr != pValidationMetricReturn) {
+         *pValidationMetricReturn = validationMetric;
+      }
+      if(nullptr != pCountEpisodesReturn) {
+         *pCountEpisodesReturn = static_cast<IntegerDataType>(cEpisodesCompleted);
+      }
+      LOG_N(TraceLevelVerbose, "EbmTrainingState::BoostCycles episode %zu validationMetric=%" FractionalDataTypePrintf, cEpisodesCompleted, validationMetric);
+
+      validationMetricMin = validationMetric < validationMetricMin ? validationMetric : validationMetricMin;
+      if(0 == cNoChangeRunLength) {
+         validationMetricBreakpoint = validationMetricMin;
+      }
+      if(validationMetric + earlyStoppingTolerance < validationMetricBreakpoint) {
+         cNoChangeRunLength = 0;
+      } else {
+         ++cNoChangeRunLength;
+      }
+      if(0 <= earlyStoppingRunLength && earlyStoppingRunLength <= cNoChangeRunLength) {
+         LOG_N(TraceLevelInfo, "EbmTrainingState::BoostCycles stopping early after %zu episodes", cEpisodesCompleted);
+         break;
+      }
+   }
+
+   ReleasePrebinnedHistograms();
+   LOG_N(TraceLevelVerbose, "EbmTrainingState::BoostCycles finished %zu episodes %" FractionalDataTypePrintf, cEpisodesCompleted, validationMetric);
+   return false;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION BoostCycles(
+   PEbmTraining ebmTraining,
+   IntegerDataType countFeatureCombinationsInCycle,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countEpisodes,
+   IntegerDataType countStepsPerFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   IntegerDataType earlyStoppingRunLength,
+   FractionalDataType earlyStoppingTolerance,
+   FractionalDataType * validationMetricReturn,
+   IntegerDataType * countEpisodesReturn
+) {
+   LOG_N(TraceLevelInfo, "Entered BoostCycles: ebmTraining=%p, countFeatureCombinationsInCycle=%" IntegerDataTypePrintf ", featureCombinationIndexes=%p, countEpisodes=%" IntegerDataTypePrintf ", countStepsPerFeatureCombination=%" IntegerDataTypePrintf ", learningRate=%" FractionalDataTypePrintf ", countTreeSplitsMax=%" IntegerDataTypePrintf ", countInstancesRequiredForParentSplitMin=%" IntegerDataTypePrintf ", earlyStoppingRunLength=%" IntegerDataTypePrintf ", earlyStoppingTolerance=%" FractionalDataTypePrintf ", validationMetricReturn=%p, countEpisodesReturn=%p", static_cast<void *>(ebmTraining), countFeatureCombinationsInCycle, static_cast<const void *>(featureCombinationIndexes), countEpisodes, countStepsPerFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, earlyStoppingRunLength, earlyStoppingTolerance, static_cast<void *>(validationMetricReturn), static_cast<void *>(countEpisodesReturn));
+
+   EbmTrainingState * pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+   // validationMetricReturn can be nullptr
+   // countEpisodesReturn can be nullptr
+
+   if(nullptr != validationMetricReturn) {
+      *validationMetricReturn = std::numeric_limits<FractionalDataType>::infinity();
+   }
+   if(nullptr != countEpisodesReturn) {
+      *countEpisodesReturn = 0;
+   }
+
+   if(pEbmTrainingState->IsBoostCyclesParametersError(countFeatureCombinationsInCycle, featureCombinationIndexes, countEpisodes, countStepsPerFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, earlyStoppingTolerance)) {
+      return 1;
+   }
+   if(pEbmTrainingState->BoostCycles(static_cast<size_t>(countFeatureCombinationsInCycle), featureCombinationIndexes, countEpisodes, countStepsPerFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, earlyStoppingRunLength, earlyStoppingTolerance, validationMetricReturn, countEpisodesReturn)) {
+      return 1;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited BoostCycles");
+   return 0;
 }
 
 EBMCORE_IMPORT_EXPORT_BODY FractionalDataType * EBMCORE_CALLING_CONVENTION GetCurrentModelFeatureCombination(
@@ -1461,6 +2624,130 @@ EBMCORE_IMPORT_EXPORT_BODY FractionalDataType * EBMCORE_CALLING_CONVENTION GetBe
    return pRet;
 }
 
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION WriteTrainingModelFile(
+   PEbmTraining ebmTraining,
+   const FractionalDataType * const * featureCuts,
+   const char * const * const * featureCategories,
+   const FractionalDataType * intercept,
+   const char * path
+) {
+   LOG_N(TraceLevelInfo, "Entered WriteTrainingModelFile: ebmTraining=%p, featureCuts=%p, featureCategories=%p, intercept=%p, path=%p", static_cast<void *>(ebmTraining), static_cast<const void *>(featureCuts), static_cast<const void *>(featureCategories), static_cast<const void *>(intercept), static_cast<const void *>(path));
+
+   const EbmTrainingState * const pEbmTrainingState = reinterpret_cast<const EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   if(nullptr == path) {
+      LOG_0(TraceLevelError, "ERROR WriteTrainingModelFile nullptr == path");
+      return 1;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses;
+   if(IsClassification(runtimeLearningTypeOrCountTargetClasses) && runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }) {
+      LOG_0(TraceLevelError, "ERROR WriteTrainingModelFile a classifier with fewer than 2 target classes has no logits to write");
+      return 1;
+   }
+   const size_t cScores = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+   const size_t cFeatures = pEbmTrainingState->m_cFeatures;
+   const size_t cFeatureCombinations = pEbmTrainingState->m_cFeatureCombinations;
+   EBM_ASSERT(0 == cFeatureCombinations || nullptr != pEbmTrainingState->m_apBestModel);
+
+   size_t cFeatureCombinationIndexes = 0;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      cFeatureCombinationIndexes += pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination]->m_cFeatures;
+   }
+   // the model keeps its own copy of everything, so we describe our features, feature combinations and best models to it the same way that our
+   // caller would, and these arrays only need to live until it has been built.  Our feature arrays already fit in memory, so these can't overflow
+   EbmCoreFeature * const aFeatures = static_cast<EbmCoreFeature *>(malloc(sizeof(EbmCoreFeature) * (0 == cFeatures ? size_t { 1 } : cFeatures)));
+   EbmCoreFeatureCombination * const aFeatureCombinations = static_cast<EbmCoreFeatureCombination *>(malloc(sizeof(EbmCoreFeatureCombination) * (0 == cFeatureCombinations ? size_t { 1 } : cFeatureCombinations)));
+   IntegerDataType * const aFeatureCombinationIndexes = static_cast<IntegerDataType *>(malloc(sizeof(IntegerDataType) * (0 == cFeatureCombinationIndexes ? size_t { 1 } : cFeatureCombinationIndexes)));
+   const FractionalDataType ** const apModels = static_cast<const FractionalDataType **>(malloc(sizeof(const FractionalDataType *) * (0 == cFeatureCombinations ? size_t { 1 } : cFeatureCombinations)));
+
+   IntegerDataType ret = 1;
+   if(nullptr == aFeatures || nullptr == aFeatureCombinations || nullptr == aFeatureCombinationIndexes || nullptr == apModels) {
+      LOG_0(TraceLevelWarning, "WARNING WriteTrainingModelFile nullptr == allocation");
+   } else {
+      for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+         const FeatureCore * const pFeature = &pEbmTrainingState->m_aFeatures[iFeature];
+         aFeatures[iFeature].featureType = FeatureTypeCore::NominalCore == pFeature->m_featureType ? FeatureTypeNominal : FeatureTypeOrdinal;
+         aFeatures[iFeature].hasMissing = pFeature->m_bMissing ? 1 : 0;
+         aFeatures[iFeature].countBins = static_cast<IntegerDataType>(pFeature->m_cBins);
+      }
+      IntegerDataType * pFeatureCombinationIndex = aFeatureCombinationIndexes;
+      for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+         const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination];
+         aFeatureCombinations[iFeatureCombination].countFeaturesInCombination = static_cast<IntegerDataType>(pFeatureCombination->m_cFeatures);
+         for(size_t iEntry = 0; iEntry < pFeatureCombination->m_cFeatures; ++iEntry) {
+            *pFeatureCombinationIndex = static_cast<IntegerDataType>(pFeatureCombination->m_FeatureCombinationEntry[iEntry].m_pFeature - pEbmTrainingState->m_aFeatures);
+            ++pFeatureCombinationIndex;
+         }
+         // our best models were expanded when we allocated them, so they're already in the layout of GetBestModelFeatureCombination
+         EBM_ASSERT(pEbmTrainingState->m_apBestModel[iFeatureCombination]->m_bExpanded);
+         apModels[iFeatureCombination] = pEbmTrainingState->m_apBestModel[iFeatureCombination]->GetValuePointer();
+      }
+
+      EbmModel ebmModel(cScores, cFeatures);
+      if(ebmModel.Initialize(aFeatures, featureCuts, featureCategories, cFeatureCombinations, aFeatureCombinations, aFeatureCombinationIndexes, apModels, intercept)) {
+         LOG_0(TraceLevelWarning, "WARNING WriteTrainingModelFile ebmModel.Initialize");
+      } else if(ebmModel.WriteFile(path)) {
+         LOG_0(TraceLevelWarning, "WARNING WriteTrainingModelFile ebmModel.WriteFile");
+      } else {
+         ret = 0;
+      }
+   }
+   free(aFeatures);
+   free(aFeatureCombinations);
+   free(aFeatureCombinationIndexes);
+   free(apModels);
+
+   LOG_N(TraceLevelInfo, "Exited WriteTrainingModelFile %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetTrainingThreadCount(
+   PEbmTraining ebmTraining,
+   IntegerDataType countThreads
+) {
+   LOG_N(TraceLevelInfo, "Entered SetTrainingThreadCount: ebmTraining=%p, countThreads=%" IntegerDataTypePrintf, static_cast<void *>(ebmTraining), countThreads);
+
+   EbmTrainingState * pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   if(countThreads < 0) {
+      LOG_0(TraceLevelError, "ERROR SetTrainingThreadCount countThreads can't be negative");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING SetTrainingThreadCount !IsNumberConvertable<size_t, IntegerDataType>(countThreads)");
+      return 1;
+   }
+   // zero means use every hardware thread, which is also what we do if our caller never calls us
+   const size_t cThreads = 0 == countThreads ? ThreadPool::GetCountHardwareThreads() : static_cast<size_t>(countThreads);
+   if(pEbmTrainingState->SetCountThreads(cThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING SetTrainingThreadCount pEbmTrainingState->SetCountThreads(cThreads)");
+      return 1;
+   }
+
+   LOG_N(TraceLevelInfo, "Exited SetTrainingThreadCount %zu threads", pEbmTrainingState->m_cThreads);
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetTrainingPrecomputedDenominators(
+   PEbmTraining ebmTraining,
+   IntegerDataType precomputeDenominators
+) {
+   LOG_N(TraceLevelInfo, "Entered SetTrainingPrecomputedDenominators: ebmTraining=%p, precomputeDenominators=%" IntegerDataTypePrintf, static_cast<void *>(ebmTraining), precomputeDenominators);
+
+   EbmTrainingState * pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   if(pEbmTrainingState->SetPrecomputedDenominators(0 != precomputeDenominators)) {
+      LOG_0(TraceLevelWarning, "WARNING SetTrainingPrecomputedDenominators pEbmTrainingState->SetPrecomputedDenominators(0 != precomputeDenominators)");
+      return 1;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited SetTrainingPrecomputedDenominators");
+   return 0;
+}
+
 EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeTraining(
    PEbmTraining ebmTraining
 ) {
@@ -0,0 +1,701 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef VECTOR_MATH_H
+#define VECTOR_MATH_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::is_same
+
+#include "ebmcore.h" // FractionalDataType
+#include "EbmInternal.h" // EBM_INLINE, StorageDataTypeCore
+#include "EbmStatistics.h"
+#include "SamplingWithReplacement.h" // StorageCountOccurrencesCore
+#include "HistogramBucket.h"
+
+// Vectorized exp and log for the binary classification loops.  Every x64 processor has SSE2, so that is our baseline.  The AVX2 and AVX-512 versions
+// are compiled when the compiler is allowed to emit those instructions for the whole library, or when one of the IsaKernels translation units turns
+// them on for itself with EBM_VECTOR_TARGET_AVX2 or EBM_VECTOR_TARGET_AVX512.  On x64 StorageDataTypeCore and FractionalDataType are both 64 bits
+// wide, so the targets line up one to one with the lanes of the predictor scores.  If the predictor scores and residuals are stored in single
+// precision, we widen them to double when we load them and round them when we store them, so the math is the same in both builds.
+//
+// The algorithm is written once in terms of a small set of per instruction set operations, and it never uses fused multiply-add, so every lane of every
+// instruction set computes exactly the same value for the same input.  Changing the vector width only changes how many instances we process at once.
+//
+// Only include this header from the IsaKernels translation units, and include the library headers that it includes before switching the instruction
+// set, so that only the kernels below get compiled for it.  The rest of the library reaches these kernels through g_pIsaKernels
+#if defined(__x86_64__) || defined(_M_X64)
+#define EBM_VECTOR_SSE2
+#include <emmintrin.h> // SSE2
+#if defined(__AVX2__) || defined(__AVX512F__) || defined(EBM_VECTOR_TARGET_AVX2) || defined(EBM_VECTOR_TARGET_AVX512)
+#include <immintrin.h> // AVX2 & AVX-512
+#endif // defined(__AVX2__) || defined(__AVX512F__) || defined(EBM_VECTOR_TARGET_AVX2) || defined(EBM_VECTOR_TARGET_AVX512)
+#if defined(__AVX2__) || defined(EBM_VECTOR_TARGET_AVX2)
+#define EBM_VECTOR_AVX2
+#endif // defined(__AVX2__) || defined(EBM_VECTOR_TARGET_AVX2)
+#if defined(__AVX512F__) || defined(EBM_VECTOR_TARGET_AVX512)
+#define EBM_VECTOR_AVX512
+#endif // defined(__AVX512F__) || defined(EBM_VECTOR_TARGET_AVX512)
+#endif // defined(__x86_64__) || defined(_M_X64)
+
+#ifdef EBM_VECTOR_SSE2
+
+static_assert(std::is_same<double, FractionalDataType>::value, "the vectorized kernels operate on doubles");
+static_assert(sizeof(uint64_t) == sizeof(StorageDataTypeCore), "the vectorized kernels load the targets into 64 bit lanes");
+static_assert(sizeof(uint64_t) == sizeof(size_t), "the vectorized kernels load tensor indexes into 64 bit lanes");
+
+struct VectorSse2 final {
+   typedef __m128d Value;
+   typedef __m128i Integer;
+   typedef __m128d Mask;
+   static constexpr size_t k_cLanes = 2;
+
+   EBM_INLINE static Value Set(const double value) {
+      return _mm_set1_pd(value);
+   }
+   EBM_INLINE static Integer SetInteger(const uint64_t value) {
+      return _mm_set1_epi64x(static_cast<long long>(value));
+   }
+   EBM_INLINE static Value Load(const double * const a) {
+      return _mm_loadu_pd(a);
+   }
+   EBM_INLINE static Value Load(const float * const a) {
+      return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(a))));
+   }
+   EBM_INLINE static Integer LoadTargets(const StorageDataTypeCore * const a) {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+   }
+   EBM_INLINE static void Store(double * const a, const Value value) {
+      _mm_storeu_pd(a, value);
+   }
+   // SSE2 has no gather, so the lanes are loaded one at a time
+   EBM_INLINE static Value Gather(const double * const a, const size_t * const ai) {
+      return _mm_set_pd(a[ai[1]], a[ai[0]]);
+   }
+   EBM_INLINE static void Store(float * const a, const Value value) {
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(a), _mm_castps_si128(_mm_cvtpd_ps(value)));
+   }
+   EBM_INLINE static Value Add(const Value a, const Value b) {
+      return _mm_add_pd(a, b);
+   }
+   EBM_INLINE static Value Subtract(const Value a, const Value b) {
+      return _mm_sub_pd(a, b);
+   }
+   EBM_INLINE static Value Multiply(const Value a, const Value b) {
+      return _mm_mul_pd(a, b);
+   }
+   EBM_INLINE static Value Divide(const Value a, const Value b) {
+      return _mm_div_pd(a, b);
+   }
+   // returns b if either value is a NaN
+   EBM_INLINE static Value Min(const Value a, const Value b) {
+      return _mm_min_pd(a, b);
+   }
+   // returns b if either value is a NaN
+   EBM_INLINE static Value Max(const Value a, const Value b) {
+      return _mm_max_pd(a, b);
+   }
+   EBM_INLINE static Mask LessThan(const Value a, const Value b) {
+      return _mm_cmplt_pd(a, b);
+   }
+   EBM_INLINE static Mask GreaterThan(const Value a, const Value b) {
+      return _mm_cmpgt_pd(a, b);
+   }
+   // true if a is greater than b or if either value is a NaN
+   EBM_INLINE static Mask NotLessEqual(const Value a, const Value b) {
+      return _mm_cmpnle_pd(a, b);
+   }
+   EBM_INLINE static Value Select(const Mask mask, const Value ifTrue, const Value ifFalse) {
+      return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse));
+   }
+   EBM_INLINE static Integer AsInteger(const Value value) {
+      return _mm_castpd_si128(value);
+   }
+   EBM_INLINE static Value AsValue(const Integer value) {
+      return _mm_castsi128_pd(value);
+   }
+   EBM_INLINE static Integer And(const Integer a, const Integer b) {
+      return _mm_and_si128(a, b);
+   }
+   EBM_INLINE static Integer Or(const Integer a, const Integer b) {
+      return _mm_or_si128(a, b);
+   }
+   EBM_INLINE static Integer Xor(const Integer a, const Integer b) {
+      return _mm_xor_si128(a, b);
+   }
+   template<int cBits>
+   EBM_INLINE static Integer ShiftLeft(const Integer value) {
+      return _mm_slli_epi64(value, cBits);
+   }
+   template<int cBits>
+   EBM_INLINE static Integer ShiftRight(const Integer value) {
+      return _mm_srli_epi64(value, cBits);
+   }
+};
+
+#ifdef EBM_VECTOR_AVX2
+struct VectorAvx2 final {
+   typedef __m256d Value;
+   typedef __m256i Integer;
+   typedef __m256d Mask;
+   static constexpr size_t k_cLanes = 4;
+
+   EBM_INLINE static Value Set(const double value) {
+      return _mm256_set1_pd(value);
+   }
+   EBM_INLINE static Integer SetInteger(const uint64_t value) {
+      return _mm256_set1_epi64x(static_cast<long long>(value));
+   }
+   EBM_INLINE static Value Load(const double * const a) {
+      return _mm256_loadu_pd(a);
+   }
+   EBM_INLINE static Value Load(const float * const a) {
+      return _mm256_cvtps_pd(_mm_loadu_ps(a));
+   }
+   EBM_INLINE static Integer LoadTargets(const StorageDataTypeCore * const a) {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+   }
+   EBM_INLINE static void Store(double * const a, const Value value) {
+      _mm256_storeu_pd(a, value);
+   }
+   EBM_INLINE static Value Gather(const double * const a, const size_t * const ai) {
+      return _mm256_i64gather_pd(a, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ai)), 8);
+   }
+   EBM_INLINE static void Store(float * const a, const Value value) {
+      _mm_storeu_ps(a, _mm256_cvtpd_ps(value));
+   }
+   EBM_INLINE static Value Add(const Value a, const Value b) {
+      return _mm256_add_pd(a, b);
+   }
+   EBM_INLINE static Value Subtract(const Value a, const Value b) {
+      return _mm256_sub_pd(a, b);
+   }
+   EBM_INLINE static Value Multiply(const Value a, const Value b) {
+      return _mm256_mul_pd(a, b);
+   }
+   EBM_INLINE static Value Divide(const Value a, const Value b) {
+      return _mm256_div_pd(a, b);
+   }
+   // returns b if either value is a NaN
+   EBM_INLINE static Value Min(const Value a, const Value b) {
+      return _mm256_min_pd(a, b);
+   }
+   // returns b if either value is a NaN
+   EBM_INLINE static Value Max(const Value a, const Value b) {
+      return _mm256_max_pd(a, b);
+   }
+   EBM_INLINE static Mask LessThan(const Value a, const Value b) {
+      return _mm256_cmp_pd(a, b, _CMP_LT_OQ);
+   }
+   EBM_INLINE static Mask GreaterThan(const Value a, const Value b) {
+      return _mm256_cmp_pd(a, b, _CMP_GT_OQ);
+   }
+   // true if a is greater than b or if either value is a NaN
+   EBM_INLINE static Mask NotLessEqual(const Value a, const Value b) {
+      return _mm256_cmp_pd(a, b, _CMP_NLE_UQ);
+   }
+   EBM_INLINE static Value Select(const Mask mask, const Value ifTrue, const Value ifFalse) {
+      return _mm256_blendv_pd(ifFalse, ifTrue, mask);
+   }
+   EBM_INLINE static Integer AsInteger(const Value value) {
+      return _mm256_castpd_si256(value);
+   }
+   EBM_INLINE static Value AsValue(const Integer value) {
+      return _mm256_castsi256_pd(value);
+   }
+   EBM_INLINE static Integer And(const Integer a, const Integer b) {
+      return _mm256_and_si256(a, b);
+   }
+   EBM_INLINE static Integer Or(const Integer a, const Integer b) {
+      return _mm256_or_si256(a, b);
+   }
+   EBM_INLINE static Integer Xor(const Integer a, const Integer b) {
+      return _mm256_xor_si256(a, b);
+   }
+   template<int cBits>
+   EBM_INLINE static Integer ShiftLeft(const Integer value) {
+      return _mm256_slli_epi64(value, cBits);
+   }
+   template<int cBits>
+   EBM_INLINE static Integer ShiftRight(const Integer value) {
+      return _mm256_srli_epi64(value, cBits);
+   }
+};
+#endif // EBM_VECTOR_AVX2
+
+#ifdef EBM_VECTOR_AVX512
+struct VectorAvx512 final {
+   typedef __m512d Value;
+   typedef __m512i Integer;
+   typedef __mmask8 Mask;
+   static constexpr size_t k_cLanes = 8;
+
+   // some of the unmasked AVX-512 intrinsics pass an undefined register to the masked builtins, which makes g++ 12 warn about uninitialized values,
+   // so for those we use the masked forms with every lane enabled
+   static constexpr Mask k_maskAll = static_cast<Mask>(0xFF);
+
+   EBM_INLINE static Value Set(const double value) {
+      return _mm512_set1_pd(value);
+   }
+   EBM_INLINE static Integer SetInteger(const uint64_t value) {
+      return _mm512_set1_epi64(static_cast<long long>(value));
+   }
+   EBM_INLINE static Value Load(const double * const a) {
+      return _mm512_loadu_pd(a);
+   }
+   EBM_INLINE static Value Load(const float * const a) {
+      return _mm512_maskz_cvtps_pd(k_maskAll, _mm256_loadu_ps(a));
+   }
+   EBM_INLINE static Integer LoadTargets(const StorageDataTypeCore * const a) {
+      return _mm512_loadu_si512(a);
+   }
+   EBM_INLINE static void Store(double * const a, const Value value) {
+      _mm512_storeu_pd(a, value);
+   }
+   EBM_INLINE static Value Gather(const double * const a, const size_t * const ai) {
+      return _mm512_mask_i64gather_pd(_mm512_setzero_pd(), k_maskAll, _mm512_loadu_si512(ai), a, 8);
+   }
+   EBM_INLINE static void Store(float * const a, const Value value) {
+      _mm256_storeu_ps(a, _mm512_maskz_cvtpd_ps(k_maskAll, value));
+   }
+   EBM_INLINE static Value Add(const Value a, const Value b) {
+      return _mm512_add_pd(a, b);
+   }
+   EBM_INLINE static Value Subtract(const Value a, const Value b) {
+      return _mm512_sub_pd(a, b);
+   }
+   EBM_INLINE static Value Multiply(const Value a, const Value b) {
+      return _mm512_mul_pd(a, b);
+   }
+   EBM_INLINE static Value Divide(const Value a, const Value b) {
+      return _mm512_div_pd(a, b);
+   }
+   // returns b if either value is a NaN
+   EBM_INLINE static Value Min(const Value a, const Value b) {
+      return _mm512_mask_min_pd(a, k_maskAll, a, b);
+   }
+   // returns b if either value is a NaN
+   EBM_INLINE static Value Max(const Value a, const Value b) {
+      return _mm512_mask_max_pd(a, k_maskAll, a, b);
+   }
+   EBM_INLINE static Mask LessThan(const Value a, const Value b) {
+      return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ);
+   }
+   EBM_INLINE static Mask GreaterThan(const Value a, const Value b) {
+      return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ);
+   }
+   // true if a is greater than b or if either value is a NaN
+   EBM_INLINE static Mask NotLessEqual(const Value a, const Value b) {
+      return _mm512_cmp_pd_mask(a, b, _CMP_NLE_UQ);
+   }
+   EBM_INLINE static Value Select(const Mask mask, const Value ifTrue, const Value ifFalse) {
+      return _mm512_mask_blend_pd(mask, ifFalse, ifTrue);
+   }
+   EBM_INLINE static Integer AsInteger(const Value value) {
+      return _mm512_castpd_si512(value);
+   }
+   EBM_INLINE static Value AsValue(const Integer value) {
+      return _mm512_castsi512_pd(value);
+   }
+   EBM_INLINE static Integer And(const Integer a, const Integer b) {
+      return _mm512_and_si512(a, b);
+   }
+   EBM_INLINE static Integer Or(const Integer a, const Integer b) {
+      return _mm512_or_si512(a, b);
+   }
+   EBM_INLINE static Integer Xor(const Integer a, const Integer b) {
+      return _mm512_xor_si512(a, b);
+   }
+   template<int cBits>
+   EBM_INLINE static Integer ShiftLeft(const Integer value) {
+      return _mm512_mask_slli_epi64(value, k_maskAll, value, cBits);
+   }
+   template<int cBits>
+   EBM_INLINE static Integer ShiftRight(const Integer value) {
+      return _mm512_mask_srli_epi64(value, k_maskAll, value, cBits);
+   }
+};
+#endif // EBM_VECTOR_AVX512
+
+class VectorMath final {
+   EBM_INLINE VectorMath() {
+      // DON'T allow anyone to make this static class
+   }
+
+   // adding and then subtracting 1.5 * 2^52 rounds any double with a magnitude below 2^51 to the nearest integer in the default rounding mode
+   static constexpr double k_roundMagic = 6755399441055744.0;
+   // 2^52 + 1023.  After adding a small integer n to this, the low 11 bits of the mantissa hold the biased exponent of 2^n
+   static constexpr double k_exponentMagic = 4503599627371519.0;
+   // 2^52.  ORing a small integer into the mantissa of 2^52 and then subtracting 2^52 converts the integer to a double
+   static constexpr double k_integerMagic = 4503599627370496.0;
+   static constexpr uint64_t k_integerMagicBits = uint64_t { 0x4330000000000000 };
+
+   template<typename TVector>
+   EBM_INLINE static typename TVector::Value Round(const typename TVector::Value value) {
+      const typename TVector::Value magic = TVector::Set(k_roundMagic);
+      return TVector::Subtract(TVector::Add(value, magic), magic);
+   }
+
+   // 2^n for integral n in [-1022, 1023]
+   template<typename TVector>
+   EBM_INLINE static typename TVector::Value PowerOfTwo(const typename TVector::Value n) {
+      return TVector::AsValue(TVector::template ShiftLeft<52>(TVector::AsInteger(TVector::Add(n, TVector::Set(k_exponentMagic)))));
+   }
+
+public:
+
+   // exp with the range reduction and rational approximation from Cephes.  The result is within 2 ULP of std::exp.  Results that would
+   // be subnormal are flushed to zero, which doesn't change anything for the 1 + exp(x) that we use it for
+   template<typename TVector>
+   EBM_INLINE static typename TVector::Value Exp(const typename TVector::Value x) {
+      typedef typename TVector::Value Value;
+
+      constexpr double k_expArgumentMax = 7.09782712893383996843E2;
+      constexpr double k_expArgumentMin = -7.08396418532264106224E2;
+
+      // the Max/Min operand order passes a NaN in x through
+      const Value xClamped = TVector::Min(TVector::Set(k_expArgumentMax), TVector::Max(TVector::Set(k_expArgumentMin), x));
+
+      // x = n * ln(2) + r, with |r| <= ln(2) / 2.  ln(2) is split into a high part with few enough bits that n * high is exact, and a low part
+      const Value n = Round<TVector>(TVector::Multiply(xClamped, TVector::Set(1.4426950408889634073599)));
+      Value r = TVector::Subtract(xClamped, TVector::Multiply(n, TVector::Set(6.93145751953125E-1)));
+      r = TVector::Subtract(r, TVector::Multiply(n, TVector::Set(1.42860682030941723212E-6)));
+
+      // exp(r) = 1 + 2 * r * P(r^2) / (Q(r^2) - r * P(r^2))
+      const Value rr = TVector::Multiply(r, r);
+      Value p = TVector::Set(1.26177193074810590878E-4);
+      p = TVector::Add(TVector::Multiply(p, rr), TVector::Set(3.02994407707441961300E-2));
+      p = TVector::Add(TVector::Multiply(p, rr), TVector::Set(9.99999999999999999910E-1));
+      p = TVector::Multiply(p, r);
+      Value q = TVector::Set(3.00198505138664455042E-6);
+      q = TVector::Add(TVector::Multiply(q, rr), TVector::Set(2.52448340349684104192E-3));
+      q = TVector::Add(TVector::Multiply(q, rr), TVector::Set(2.27265548208155028766E-1));
+      q = TVector::Add(TVector::Multiply(q, rr), TVector::Set(2.00000000000000000009E0));
+      const Value ratio = TVector::Divide(p, TVector::Subtract(q, p));
+      Value result = TVector::Add(TVector::Set(1.0), TVector::Add(ratio, ratio));
+
+      // n can be 1024 at the top of the range, which doesn't fit in the exponent of a double, so we scale by 2^(n/2) twice
+      const Value nHalf = Round<TVector>(TVector::Multiply(n, TVector::Set(0.5)));
+      result = TVector::Multiply(TVector::Multiply(result, PowerOfTwo<TVector>(nHalf)), PowerOfTwo<TVector>(TVector::Subtract(n, nHalf)));
+
+      result = TVector::Select(TVector::GreaterThan(x, TVector::Set(k_expArgumentMax)), TVector::Set(std::numeric_limits<double>::infinity()), result);
+      result = TVector::Select(TVector::LessThan(x, TVector::Set(k_expArgumentMin)), TVector::Set(0.0), result);
+      return result;
+   }
+
+   // natural log with the rational approximation from Cephes.  The result is within 1 ULP of std::log.  We only call this on 1 + exp(x),
+   // so x must be a normal positive number, positive infinity, or a NaN
+   template<typename TVector>
+   EBM_INLINE static typename TVector::Value LogPositive(const typename TVector::Value x) {
+      typedef typename TVector::Value Value;
+      typedef typename TVector::Integer Integer;
+
+      // x = m * 2^e with m in [0.5, 1).  x is positive, so the biased exponent is the top 12 bits of x
+      const Integer bits = TVector::AsInteger(x);
+      Value e = TVector::Subtract(TVector::AsValue(TVector::Or(TVector::template ShiftRight<52>(bits), TVector::SetInteger(k_integerMagicBits))), TVector::Set(k_integerMagic + 1022.0));
+      Value m = TVector::AsValue(TVector::Or(TVector::And(bits, TVector::SetInteger(uint64_t { 0x000FFFFFFFFFFFFF })), TVector::SetInteger(uint64_t { 0x3FE0000000000000 })));
+
+      // move m into [sqrt(0.5), sqrt(2)) and then approximate log(1 + f) with f = m - 1
+      const typename TVector::Mask isSmall = TVector::LessThan(m, TVector::Set(7.07106781186547524401E-1));
+      e = TVector::Subtract(e, TVector::Select(isSmall, TVector::Set(1.0), TVector::Set(0.0)));
+      const Value f = TVector::Subtract(TVector::Select(isSmall, TVector::Add(m, m), m), TVector::Set(1.0));
+
+      const Value ff = TVector::Multiply(f, f);
+      Value p = TVector::Set(1.01875663804580931796E-4);
+      p = TVector::Add(TVector::Multiply(p, f), TVector::Set(4.97494994976747001425E-1));
+      p = TVector::Add(TVector::Multiply(p, f), TVector::Set(4.70579119878881725854E0));
+      p = TVector::Add(TVector::Multiply(p, f), TVector::Set(1.44989225341610930846E1));
+      p = TVector::Add(TVector::Multiply(p, f), TVector::Set(1.79368678507819816313E1));
+      p = TVector::Add(TVector::Multiply(p, f), TVector::Set(7.70838733755885391666E0));
+      Value q = TVector::Add(f, TVector::Set(1.12873587189167450590E1));
+      q = TVector::Add(TVector::Multiply(q, f), TVector::Set(4.52279145837532221105E1));
+      q = TVector::Add(TVector::Multiply(q, f), TVector::Set(8.29875266912776603211E1));
+      q = TVector::Add(TVector::Multiply(q, f), TVector::Set(7.11544750618563894466E1));
+      q = TVector::Add(TVector::Multiply(q, f), TVector::Set(2.31251620126765340583E1));
+
+      // log(x) = f - f^2 / 2 + f^3 * P(f) / Q(f) + e * ln(2), with ln(2) split into a high and low part like in Exp
+      Value y = TVector::Multiply(f, TVector::Divide(TVector::Multiply(ff, p), q));
+      y = TVector::Subtract(y, TVector::Multiply(e, TVector::Set(2.121944400546905827679E-4)));
+      y = TVector::Subtract(y, TVector::Multiply(ff, TVector::Set(0.5)));
+      Value result = TVector::Add(f, y);
+      result = TVector::Add(result, TVector::Multiply(e, TVector::Set(0.693359375)));
+
+      // log(infinity) is infinity, and a NaN stays a NaN
+      return TVector::Select(TVector::NotLessEqual(x, TVector::Set(std::numeric_limits<double>::max())), x, result);
+   }
+
+   // the same expression as EbmStatistics::ComputeClassificationResidualErrorBinaryclass, except that exp is our vectorized approximation
+   template<typename TVector>
+   EBM_INLINE static void ComputeClassificationResidualErrorBinaryclass(const StorageFractionalDataTypeCore * const aTrainingLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues, StorageFractionalDataTypeCore * const aResidualErrors) {
+      typedef typename TVector::Value Value;
+      typedef typename TVector::Integer Integer;
+
+      // the targets are 0 or 1, so (target ^ 1) << 63 is the sign bit exactly when the target is 0.  XORing it in negates both the log odds and the numerator
+      const Integer signBits = TVector::template ShiftLeft<63>(TVector::Xor(TVector::LoadTargets(aBinnedActualValues), TVector::SetInteger(1)));
+      const Value logOdds = TVector::AsValue(TVector::Xor(TVector::AsInteger(TVector::Load(aTrainingLogOddsPredictions)), signBits));
+      const Value numerator = TVector::AsValue(TVector::Xor(TVector::AsInteger(TVector::Set(1.0)), signBits));
+      const Value denominator = TVector::Add(TVector::Set(1.0), Exp<TVector>(logOdds));
+      TVector::Store(aResidualErrors, TVector::Divide(numerator, denominator));
+   }
+
+   // the same expression as EbmStatistics::ComputeClassificationSingleInstanceLogLossBinaryclass, except that exp and log are our vectorized approximations
+   template<typename TVector>
+   EBM_INLINE static void ComputeClassificationLogLossBinaryclass(const StorageFractionalDataTypeCore * const aValidationLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues, FractionalDataType * const aLogLosses) {
+      typedef typename TVector::Value Value;
+      typedef typename TVector::Integer Integer;
+
+      // target << 63 is the sign bit exactly when the target is 1, which is when the scalar version negates the log odds
+      const Integer signBits = TVector::template ShiftLeft<63>(TVector::LoadTargets(aBinnedActualValues));
+      const Value logOdds = TVector::AsValue(TVector::Xor(TVector::AsInteger(TVector::Load(aValidationLogOddsPredictions)), signBits));
+      const Value onePlusExp = TVector::Add(TVector::Set(1.0), Exp<TVector>(logOdds));
+      TVector::Store(aLogLosses, LogPositive<TVector>(onePlusExp));
+   }
+
+   template<typename TVector>
+   EBM_INLINE static void ComputeClassificationResidualErrorBinaryclass(const size_t cInstances, const StorageFractionalDataTypeCore * const aTrainingLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues, StorageFractionalDataTypeCore * const aResidualErrors) {
+      constexpr size_t cLanes = TVector::k_cLanes;
+
+      const size_t cInstancesVectorized = cInstances - cInstances % cLanes;
+      size_t iInstance = 0;
+      for(; iInstance < cInstancesVectorized; iInstance += cLanes) {
+         ComputeClassificationResidualErrorBinaryclass<TVector>(&aTrainingLogOddsPredictions[iInstance], &aBinnedActualValues[iInstance], &aResidualErrors[iInstance]);
+      }
+      if(iInstance != cInstances) {
+         // run the leftovers through the vector code too, so that an instance gets the same residual no matter where it falls in the block
+         StorageFractionalDataTypeCore aPredictions[cLanes] = {};
+         StorageDataTypeCore aTargets[cLanes] = {};
+         StorageFractionalDataTypeCore aResults[cLanes];
+         const size_t cInstancesRemaining = cInstances - iInstance;
+         for(size_t iLane = 0; iLane < cInstancesRemaining; ++iLane) {
+            aPredictions[iLane] = aTrainingLogOddsPredictions[iInstance + iLane];
+            aTargets[iLane] = aBinnedActualValues[iInstance + iLane];
+         }
+         ComputeClassificationResidualErrorBinaryclass<TVector>(aPredictions, aTargets, aResults);
+         for(size_t iLane = 0; iLane < cInstancesRemaining; ++iLane) {
+            aResidualErrors[iInstance + iLane] = aResults[iLane];
+         }
+      }
+   }
+
+   // the losses are added in instance order regardless of the vector width
+   template<typename TVector>
+   EBM_INLINE static FractionalDataType ComputeClassificationLogLossBinaryclass(const size_t cInstances, const StorageFractionalDataTypeCore * const aValidationLogOddsPredictions, const StorageDataTypeCore * const aBinnedActualValues) {
+      constexpr size_t cLanes = TVector::k_cLanes;
+
+      FractionalDataType sumLogLoss = 0;
+      FractionalDataType aResults[cLanes];
+      const size_t cInstancesVectorized = cInstances - cInstances % cLanes;
+      size_t iInstance = 0;
+      for(; iInstance < cInstancesVectorized; iInstance += cLanes) {
+         ComputeClassificationLogLossBinaryclass<TVector>(&aValidationLogOddsPredictions[iInstance], &aBinnedActualValues[iInstance], aResults);
+         for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+            sumLogLoss += aResults[iLane];
+         }
+      }
+      if(iInstance != cInstances) {
+         StorageFractionalDataTypeCore aPredictions[cLanes] = {};
+         StorageDataTypeCore aTargets[cLanes] = {};
+         const size_t cInstancesRemaining = cInstances - iInstance;
+         for(size_t iLane = 0; iLane < cInstancesRemaining; ++iLane) {
+            aPredictions[iLane] = aValidationLogOddsPredictions[iInstance + iLane];
+            aTargets[iLane] = aBinnedActualValues[iInstance + iLane];
+         }
+         ComputeClassificationLogLossBinaryclass<TVector>(aPredictions, aTargets, aResults);
+         for(size_t iLane = 0; iLane < cInstancesRemaining; ++iLane) {
+            sumLogLoss += aResults[iLane];
+         }
+      }
+      return sumLogLoss;
+   }
+
+   // the split point with the highest EbmStatistics::ComputeNodeSplittingScore of its left and right sides, evaluated for TVector::k_cLanes
+   // split points at once.  Each lane keeps the first split point where it saw its best score, and we then take the best of the lanes, preferring
+   // the earliest split point on ties, so the result is the same split point that a sequential sweep with a strict comparison picks.  The counts
+   // are whole numbers held in doubles, which are exact, so cInstancesParent - aCountsLeft[i] is the same count that the sequential sweep has
+   template<typename TVector>
+   EBM_INLINE static size_t FindBestSplitPoint(const size_t cSplitPoints, const FractionalDataType cInstancesParent, const FractionalDataType * const aCountsLeft, const FractionalDataType * const aSumResidualErrorsLeft, const FractionalDataType * const aSumResidualErrorsRight, FractionalDataType * const pBestNodeSplittingScore) {
+      typedef typename TVector::Value Value;
+      constexpr size_t cLanes = TVector::k_cLanes;
+      static constexpr double k_aLaneIndexes[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+      static_assert(cLanes <= sizeof(k_aLaneIndexes) / sizeof(k_aLaneIndexes[0]), "we need an index for every lane");
+
+      // the split point at index 0 is every lane's starting best, which like the sequential sweep means that a NaN there is never replaced
+      const FractionalDataType nodeSplittingScoreFirst = aSumResidualErrorsLeft[0] / aCountsLeft[0] * aSumResidualErrorsLeft[0] + aSumResidualErrorsRight[0] / (cInstancesParent - aCountsLeft[0]) * aSumResidualErrorsRight[0];
+
+      Value bestNodeSplittingScores = TVector::Set(nodeSplittingScoreFirst);
+      Value bestIndexes = TVector::Set(0.0);
+      Value indexes = TVector::Load(k_aLaneIndexes);
+      const Value indexesIncrement = TVector::Set(static_cast<double>(cLanes));
+      const Value instancesParent = TVector::Set(cInstancesParent);
+      const size_t cSplitPointsVectorized = cSplitPoints - cSplitPoints % cLanes;
+      for(size_t iSplitPoint = 0; iSplitPoint < cSplitPointsVectorized; iSplitPoint += cLanes) {
+         const Value countsLeft = TVector::Load(&aCountsLeft[iSplitPoint]);
+         const Value sumResidualErrorsLeft = TVector::Load(&aSumResidualErrorsLeft[iSplitPoint]);
+         const Value sumResidualErrorsRight = TVector::Load(&aSumResidualErrorsRight[iSplitPoint]);
+         const Value scoresLeft = TVector::Multiply(TVector::Divide(sumResidualErrorsLeft, countsLeft), sumResidualErrorsLeft);
+         const Value scoresRight = TVector::Multiply(TVector::Divide(sumResidualErrorsRight, TVector::Subtract(instancesParent, countsLeft)), sumResidualErrorsRight);
+         const Value nodeSplittingScores = TVector::Add(scoresLeft, scoresRight);
+         const typename TVector::Mask isBetter = TVector::GreaterThan(nodeSplittingScores, bestNodeSplittingScores);
+         bestNodeSplittingScores = TVector::Select(isBetter, nodeSplittingScores, bestNodeSplittingScores);
+         bestIndexes = TVector::Select(isBetter, indexes, bestIndexes);
+         indexes = TVector::Add(indexes, indexesIncrement);
+      }
+
+      double aBestNodeSplittingScores[cLanes];
+      double aBestIndexes[cLanes];
+      TVector::Store(aBestNodeSplittingScores, bestNodeSplittingScores);
+      TVector::Store(aBestIndexes, bestIndexes);
+      FractionalDataType bestNodeSplittingScore = nodeSplittingScoreFirst;
+      size_t iBest = 0;
+      for(size_t iLane = 0; iLane < cLanes; ++iLane) {
+         const size_t iLaneBest = static_cast<size_t>(aBestIndexes[iLane]);
+         if(bestNodeSplittingScore < aBestNodeSplittingScores[iLane] || (bestNodeSplittingScore == aBestNodeSplittingScores[iLane] && iLaneBest < iBest)) {
+            bestNodeSplittingScore = aBestNodeSplittingScores[iLane];
+            iBest = iLaneBest;
+         }
+      }
+      // the leftovers come after every split point that the lanes looked at, so a sequential sweep over them finishes the job
+      for(size_t iSplitPoint = cSplitPointsVectorized; iSplitPoint < cSplitPoints; ++iSplitPoint) {
+         const FractionalDataType sumResidualErrorLeft = aSumResidualErrorsLeft[iSplitPoint];
+         const FractionalDataType sumResidualErrorRight = aSumResidualErrorsRight[iSplitPoint];
+         const FractionalDataType nodeSplittingScore = sumResidualErrorLeft / aCountsLeft[iSplitPoint] * sumResidualErrorLeft + sumResidualErrorRight / (cInstancesParent - aCountsLeft[iSplitPoint]) * sumResidualErrorRight;
+         if(bestNodeSplittingScore < nodeSplittingScore) {
+            bestNodeSplittingScore = nodeSplittingScore;
+            iBest = iSplitPoint;
+         }
+      }
+      *pBestNodeSplittingScore = bestNodeSplittingScore;
+      return iBest;
+   }
+
+   // aLogits[iInstance] += aModel[aiTensor[iInstance]].  Each lane does the same single addition as the scalar loop, so the vector width can't
+   // change any score
+   template<typename TVector>
+   EBM_INLINE static void AddGathered(const size_t cInstances, const FractionalDataType * const aModel, const size_t * const aiTensor, FractionalDataType * const aLogits) {
+      constexpr size_t cLanes = TVector::k_cLanes;
+
+      const size_t cInstancesVectorized = cInstances - cInstances % cLanes;
+      size_t iInstance = 0;
+      for(; iInstance < cInstancesVectorized; iInstance += cLanes) {
+         TVector::Store(&aLogits[iInstance], TVector::Add(TVector::Load(&aLogits[iInstance]), TVector::Gather(aModel, &aiTensor[iInstance])));
+      }
+      for(; iInstance < cInstances; ++iInstance) {
+         aLogits[iInstance] += aModel[aiTensor[iInstance]];
+      }
+   }
+};
+
+#endif // EBM_VECTOR_SSE2
+
+// the instruction set of the kernels that we compile without any vector instructions
+struct VectorScalar final {
+};
+
+// The histogram kernels don't use the vector operations above.  They are scatters into the histogram and walks through it, so we compile them in each
+// IsaKernels translation unit for that instruction set's scheduling and addressing, and TIsa is only there to give each instruction set its own
+// instantiations.  They handle regression and binary classification, where each bucket holds a single score, and they add the same values in the same
+// order as BinDataSetTrainingChunk and BuildFastTotals do, so every instruction set produces exactly the same histograms and totals
+class HistogramMath final {
+public:
+
+   HistogramMath() = delete; // this is a static class.  Do not construct
+
+   // bins cInstances instances whose bit packed bins start at the beginning of aInputData into aHistogramBuckets, which has one bucket per tensor bin
+   template<typename TIsa, bool bClassification>
+   EBM_INLINE static void BinInstances(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const StorageDataTypeCore * const aInputData, const StorageCountOccurrencesCore * const aCountOccurrences, const StorageFractionalDataTypeCore * const aResidualErrors, const StorageFractionalDataTypeCore * const aDenominators, HistogramBucket<bClassification> * const aHistogramBuckets) {
+      EBM_ASSERT(0 < cInstances);
+      const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
+      const size_t maskBits = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMax);
+
+      const StorageDataTypeCore * pInputData = aInputData;
+      size_t iInstance = 0;
+      do {
+         size_t iTensorBinCombined = static_cast<size_t>(*pInputData);
+         ++pInputData;
+         const size_t cInstancesRemaining = cInstances - iInstance;
+         const size_t iInstanceEnd = iInstance + (cInstancesRemaining < cItemsPerBitPackDataUnit ? cInstancesRemaining : cItemsPerBitPackDataUnit);
+         do {
+            HistogramBucket<bClassification> * const pHistogramBucketEntry = &aHistogramBuckets[maskBits & iTensorBinCombined];
+            const size_t cOccurences = static_cast<size_t>(aCountOccurrences[iInstance]);
+            pHistogramBucketEntry->cInstancesInBucket += cOccurences;
+            const FractionalDataType cFloatOccurences = static_cast<FractionalDataType>(cOccurences);
+            const FractionalDataType residualError = static_cast<FractionalDataType>(aResidualErrors[iInstance]);
+            HistogramBucketVectorEntry<bClassification> * const pHistogramBucketVectorEntry = &pHistogramBucketEntry->aHistogramBucketVectorEntry[0];
+            pHistogramBucketVectorEntry->sumResidualError += cFloatOccurences * residualError;
+            if(bClassification) {
+               const FractionalDataType denominator = nullptr == aDenominators ? EbmStatistics::ComputeNewtonRaphsonStep(residualError) : static_cast<FractionalDataType>(aDenominators[iInstance]);
+               pHistogramBucketVectorEntry->SetSumDenominator(pHistogramBucketVectorEntry->GetSumDenominator() + cFloatOccurences * denominator);
+            }
+            iTensorBinCombined >>= cBitsPerItemMax;
+            ++iInstance;
+         } while(iInstanceEnd != iInstance);
+      } while(cInstances != iInstance);
+   }
+
+   // turns each bucket of aHistogramBuckets into the total of all the buckets from the (0, 0, ..., 0, 0) corner up to and including it.  aAuxiliaryBuckets
+   // must be zeroed and hold at least 1 + acBins[0] + acBins[0] * acBins[1] + ... buckets, and we leave it zeroed
+   template<typename TIsa, bool bClassification>
+   EBM_INLINE static void BuildFastTotals(HistogramBucket<bClassification> * const aHistogramBuckets, const size_t cDimensions, const size_t * const acBins, HistogramBucket<bClassification> * const aAuxiliaryBuckets) {
+      struct FastTotalState {
+         HistogramBucket<bClassification> * pDimensionalCur;
+         HistogramBucket<bClassification> * pDimensionalWrap;
+         HistogramBucket<bClassification> * pDimensionalFirst;
+         size_t iCur;
+         size_t cBins;
+      };
+
+      EBM_ASSERT(1 <= cDimensions);
+      EBM_ASSERT(cDimensions <= k_cDimensionsMax);
+      FastTotalState fastTotalState[k_cDimensionsMax];
+      const FastTotalState * const pFastTotalStateEnd = &fastTotalState[cDimensions];
+      HistogramBucket<bClassification> * pBucketAuxiliaryBuildZone = aAuxiliaryBuckets;
+      size_t multiply = 1;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         fastTotalState[iDimension].iCur = 0;
+         fastTotalState[iDimension].cBins = acBins[iDimension];
+         fastTotalState[iDimension].pDimensionalFirst = pBucketAuxiliaryBuildZone;
+         fastTotalState[iDimension].pDimensionalCur = pBucketAuxiliaryBuildZone;
+         pBucketAuxiliaryBuildZone += multiply;
+         fastTotalState[iDimension].pDimensionalWrap = pBucketAuxiliaryBuildZone;
+         multiply *= acBins[iDimension];
+      }
+
+      HistogramBucket<bClassification> * pHistogramBucket = aHistogramBuckets;
+      while(true) {
+         const HistogramBucket<bClassification> * pAddPrev = pHistogramBucket;
+         for(ptrdiff_t iDimension = cDimensions - 1; 0 <= iDimension; --iDimension) {
+            HistogramBucket<bClassification> * pAddTo = fastTotalState[iDimension].pDimensionalCur;
+            pAddTo->cInstancesInBucket += pAddPrev->cInstancesInBucket;
+            pAddTo->aHistogramBucketVectorEntry[0].Add(pAddPrev->aHistogramBucketVectorEntry[0]);
+            pAddPrev = pAddTo;
+            ++pAddTo;
+            if(pAddTo == fastTotalState[iDimension].pDimensionalWrap) {
+               pAddTo = fastTotalState[iDimension].pDimensionalFirst;
+            }
+            fastTotalState[iDimension].pDimensionalCur = pAddTo;
+         }
+         *pHistogramBucket = *pAddPrev;
+         ++pHistogramBucket;
+
+         FastTotalState * pFastTotalState = &fastTotalState[0];
+         while(true) {
+            ++pFastTotalState->iCur;
+            if(LIKELY(pFastTotalState->cBins != pFastTotalState->iCur)) {
+               break;
+            }
+            pFastTotalState->iCur = 0;
+            EBM_ASSERT(pFastTotalState->pDimensionalFirst == pFastTotalState->pDimensionalCur);
+            memset(pFastTotalState->pDimensionalFirst, 0, reinterpret_cast<char *>(pFastTotalState->pDimensionalWrap) - reinterpret_cast<char *>(pFastTotalState->pDimensionalFirst));
+            ++pFastTotalState;
+            if(UNLIKELY(pFastTotalStateEnd == pFastTotalState)) {
+               return;
+            }
+         }
+      }
+   }
+};
+
+#endif // VECTOR_MATH_H
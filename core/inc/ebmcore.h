@@ -70,6 +70,18 @@ typedef struct {
    // this struct is to enforce that our caller doesn't mix EbmTraining and EbmInteraction pointers.  In C/C++ languages the caller will get an error if they try to mix these pointer types.
    char unused;
 } *PEbmInteraction;
+typedef struct {
+   // this struct is to enforce that our caller doesn't mix EbmEnsembleTraining and EbmTraining pointers.  In C/C++ languages the caller will get an error if they try to mix these pointer types.
+   char unused;
+} *PEbmEnsembleTraining;
+typedef struct {
+   // this struct is to enforce that our caller doesn't mix EbmDataSet and EbmTraining pointers.  In C/C++ languages the caller will get an error if they try to mix these pointer types.
+   char unused;
+} *PEbmDataSet;
+typedef struct {
+   // this struct is to enforce that our caller doesn't mix EbmModel and EbmTraining pointers.  In C/C++ languages the caller will get an error if they try to mix these pointer types.
+   char unused;
+} *PEbmModel;
 
 #ifndef PRId64
 // this should really be defined, but some compilers aren't compliant
@@ -95,6 +107,23 @@ typedef struct {
    IntegerDataType countFeaturesInCombination;
 } EbmCoreFeatureCombination;
 
+const IntegerDataType BinnedDataTypeUInt8 = 0;
+const IntegerDataType BinnedDataTypeUInt16 = 1;
+const IntegerDataType BinnedDataTypeInt32 = 2;
+const IntegerDataType BinnedDataTypeInt64 = 3;
+// bins held as whole numbers in doubles, which is how R stores its numeric matrices.  Fractions are truncated toward zero
+const IntegerDataType BinnedDataTypeFloat64 = 4;
+
+// describes binned data that we read in place, so that our caller doesn't need to convert it to IntegerDataType or to feature major order first.
+// The strides are counted in items of dataType, not bytes.  Feature major data has strideInstance == 1 and strideFeature == countInstances, and
+// instance major data has strideInstance == countFeatures and strideFeature == 1
+typedef struct {
+   IntegerDataType dataType; // enums aren't standardized accross languages, so use IntegerDataType values
+   IntegerDataType strideInstance;
+   IntegerDataType strideFeature;
+   const void * data;
+} EbmCoreBinnedData;
+
 const signed char TraceLevelOff = 0; // no messages will be output.  SetLogMessageFunction doesn't need to be called if the level is left at this value
 const signed char TraceLevelError = 1;
 const signed char TraceLevelWarning = 2;
@@ -182,6 +211,42 @@ EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION SetTraceLevel(sign
 //       - we'll probably want to have special categorical processing since each slice in a tensoor can be considered completely independently.  I don't see any reason to have intermediate versions where we have 3 missing / categorical values and 4 ordinal values
 //       - if missing is in the 0th bin, we can do any cuts at the beginning of processing a range, and that means any cut in the model would be the first, so we can initialze it by writing the cut model directly without bothering to handle inserting into the tree at the end
 
+// a binned dataset and its targets that we bit pack once, and which any number of training and interaction states can then use.  The dataset
+// is reference counted, so FreeDataSet can be called as soon as the last state that needs it has been initialized
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmDataSet EBMCORE_CALLING_CONVENTION CreateDataSetRegression(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const EbmCoreBinnedData * binnedData
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmDataSet EBMCORE_CALLING_CONVENTION CreateDataSetClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const EbmCoreBinnedData * binnedData
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeDataSet(
+   PEbmDataSet ebmDataSet
+);
+// writes ebmDataSet to a file that OpenDataSetFile can map back in, along with the initial predictor scores of every instance.  If predictorScores
+// is nullptr we write the predictor scores of ebmDataSet, if it has any.  The file is only readable by builds with the same byte order and
+// storage type.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION WriteDataSetFile(
+   PEbmDataSet ebmDataSet,
+   const FractionalDataType * predictorScores,
+   const char * path
+);
+// maps a file that WriteDataSetFile wrote.  The bit packed columns are read from the mapped pages instead of being loaded into memory, so the
+// operating system can page them in and out as training needs them, and processes that open the same file share those pages.  The file isn't trusted,
+// so opening it checks every target, and reads through each column whose items could hold a bin past the feature's count of bins.  Training and
+// interaction states that are given no predictor scores start from the predictor scores in the file.  Free the result with FreeDataSet
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmDataSet EBMCORE_CALLING_CONVENTION OpenDataSetFile(
+   const char * path
+);
+
 EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingRegression(
    IntegerDataType randomSeed, 
    IntegerDataType countFeatures, 
@@ -217,6 +282,59 @@ EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTraining EBMCORE_CALLING_CONVENTION Initialize
    const FractionalDataType * validationPredictorScores, 
    IntegerDataType countInnerBags
 );
+// the same as InitializeTrainingRegression and InitializeTrainingClassification, but the binned data is described by EbmCoreBinnedData
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingRegressionStrided(
+   IntegerDataType randomSeed,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTrainingInstances,
+   const FractionalDataType * trainingTargets,
+   const EbmCoreBinnedData * trainingBinnedData,
+   const FractionalDataType * trainingPredictorScores,
+   IntegerDataType countValidationInstances,
+   const FractionalDataType * validationTargets,
+   const EbmCoreBinnedData * validationBinnedData,
+   const FractionalDataType * validationPredictorScores,
+   IntegerDataType countInnerBags
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingClassificationStrided(
+   IntegerDataType randomSeed,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countTrainingInstances,
+   const IntegerDataType * trainingTargets,
+   const EbmCoreBinnedData * trainingBinnedData,
+   const FractionalDataType * trainingPredictorScores,
+   IntegerDataType countValidationInstances,
+   const IntegerDataType * validationTargets,
+   const EbmCoreBinnedData * validationBinnedData,
+   const FractionalDataType * validationPredictorScores,
+   IntegerDataType countInnerBags
+);
+// the same as the functions above, but the features, targets and binned data come from ebmDataSet.  trainingInstanceIndexes and
+// validationInstanceIndexes select the instances of ebmDataSet that go into each set, in order, and an instance can appear in both.  If an index
+// array is nullptr then the set is every instance of ebmDataSet in order
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingFromDataSet(
+   IntegerDataType randomSeed,
+   PEbmDataSet ebmDataSet,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTrainingInstances,
+   const IntegerDataType * trainingInstanceIndexes,
+   const FractionalDataType * trainingPredictorScores,
+   IntegerDataType countValidationInstances,
+   const IntegerDataType * validationInstanceIndexes,
+   const FractionalDataType * validationPredictorScores,
+   IntegerDataType countInnerBags
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE FractionalDataType * EBMCORE_CALLING_CONVENTION GenerateModelFeatureCombinationUpdate(
    PEbmTraining ebmTraining, 
    IntegerDataType indexFeatureCombination, 
@@ -243,6 +361,24 @@ EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION Trainin
    const FractionalDataType * validationWeights,
    FractionalDataType * validationMetricReturn
 );
+// runs countEpisodes round robin episodes over featureCombinationIndexes, taking countStepsPerFeatureCombination training steps on each feature combination
+// per episode, and stops early once the validation metric has gone earlyStoppingRunLength episodes without improving by more than earlyStoppingTolerance.
+// A negative earlyStoppingRunLength disables early stopping.  validationMetricReturn receives the metric after the last episode, and countEpisodesReturn
+// receives the number of episodes that ran.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION BoostCycles(
+   PEbmTraining ebmTraining,
+   IntegerDataType countFeatureCombinationsInCycle,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countEpisodes,
+   IntegerDataType countStepsPerFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   IntegerDataType earlyStoppingRunLength,
+   FractionalDataType earlyStoppingTolerance,
+   FractionalDataType * validationMetricReturn,
+   IntegerDataType * countEpisodesReturn
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE FractionalDataType * EBMCORE_CALLING_CONVENTION GetCurrentModelFeatureCombination(
    PEbmTraining ebmTraining, 
    IntegerDataType indexFeatureCombination
@@ -251,10 +387,93 @@ EBMCORE_IMPORT_EXPORT_INCLUDE FractionalDataType * EBMCORE_CALLING_CONVENTION Ge
    PEbmTraining ebmTraining, 
    IntegerDataType indexFeatureCombination
 );
+// countThreads includes the calling thread.  0 means one thread per hardware thread.  Work runs on the calling thread until this is called.
+// Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetTrainingThreadCount(
+   PEbmTraining ebmTraining,
+   IntegerDataType countThreads
+);
+// a non-zero precomputeDenominators keeps the Newton-Raphson denominator of each classification residual in memory next to the residuals, so that each
+// inner bag reads it instead of recomputing it.  This costs as much memory again as the residuals.  It's off by default and has no effect on
+// regression.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetTrainingPrecomputedDenominators(
+   PEbmTraining ebmTraining,
+   IntegerDataType precomputeDenominators
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeTraining(
    PEbmTraining ebmTraining
 );
 
+// trains countBags outer bags over one shared copy of the binned data.  validationMasks holds countBags rows of countInstances values, and instances
+// with a non-zero mask value are held out of that bag's training and are used for its early stopping metric instead.  randomSeeds has one seed per bag
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmEnsembleTraining EBMCORE_CALLING_CONVENTION InitializeEnsembleTrainingRegression(
+   IntegerDataType countBags,
+   const IntegerDataType * randomSeeds,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores,
+   const IntegerDataType * validationMasks,
+   IntegerDataType countInnerBags
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmEnsembleTraining EBMCORE_CALLING_CONVENTION InitializeEnsembleTrainingClassification(
+   IntegerDataType countBags,
+   const IntegerDataType * randomSeeds,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores,
+   const IntegerDataType * validationMasks,
+   IntegerDataType countInnerBags
+);
+// runs BoostCycles on every bag.  validationMetricsReturn and countEpisodesReturn each receive one value per bag
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION BoostEnsembleCycles(
+   PEbmEnsembleTraining ebmEnsembleTraining,
+   IntegerDataType countFeatureCombinationsInCycle,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countEpisodes,
+   IntegerDataType countStepsPerFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   IntegerDataType earlyStoppingRunLength,
+   FractionalDataType earlyStoppingTolerance,
+   FractionalDataType * validationMetricsReturn,
+   IntegerDataType * countEpisodesReturn
+);
+// writes the average of the bags' best models, and optionally their population standard deviation, in the layout of GetBestModelFeatureCombination
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetEnsembleModelFeatureCombination(
+   PEbmEnsembleTraining ebmEnsembleTraining,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType * averageModelReturn,
+   FractionalDataType * standardDeviationReturn
+);
+// countThreads includes the calling thread.  0 means one thread per hardware thread.  Work runs on the calling thread until this is called.
+// Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetEnsembleTrainingThreadCount(
+   PEbmEnsembleTraining ebmEnsembleTraining,
+   IntegerDataType countThreads
+);
+// see SetTrainingPrecomputedDenominators.  Applies to every bag.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetEnsembleTrainingPrecomputedDenominators(
+   PEbmEnsembleTraining ebmEnsembleTraining,
+   IntegerDataType precomputeDenominators
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeEnsembleTraining(
+   PEbmEnsembleTraining ebmEnsembleTraining
+);
+
 
 EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionRegression(
    IntegerDataType countFeatures, 
@@ -273,16 +492,158 @@ EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION Initial
    const IntegerDataType * binnedData, 
    const FractionalDataType * predictorScores
 );
+// the same as InitializeInteractionRegression and InitializeInteractionClassification, but the binned data is described by EbmCoreBinnedData
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionRegressionStrided(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const EbmCoreBinnedData * binnedData,
+   const FractionalDataType * predictorScores
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionClassificationStrided(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const EbmCoreBinnedData * binnedData,
+   const FractionalDataType * predictorScores
+);
+// the same as the functions above, but the features, targets and binned data come from ebmDataSet.  instanceIndexes selects the instances in
+// order, and if it is nullptr then we use every instance of ebmDataSet in order, which shares the bit packed data instead of copying it
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionFromDataSet(
+   PEbmDataSet ebmDataSet,
+   IntegerDataType countInstances,
+   const IntegerDataType * instanceIndexes,
+   const FractionalDataType * predictorScores
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScore(
    PEbmInteraction ebmInteraction, 
    IntegerDataType countFeaturesInCombination, 
    const IntegerDataType * featureIndexes, 
    FractionalDataType * interactionScoreReturn
 );
+// scores countCombinations feature combinations at once on the interaction thread pool.  featureIndexes holds countFeaturesInCombination indexes for each
+// combination, one combination after another.  If countTopCombinations is zero, interactionScoresReturn receives one score per combination in the
+// order given.  Otherwise interactionScoresReturn and topCombinationIndexesReturn receive the scores and the indexes of the min(countTopCombinations,
+// countCombinations) highest scoring combinations, best first, with ties going to the combination that came first
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScores(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countCombinations,
+   IntegerDataType countFeaturesInCombination,
+   const IntegerDataType * featureIndexes,
+   IntegerDataType countTopCombinations,
+   FractionalDataType * interactionScoresReturn,
+   IntegerDataType * topCombinationIndexesReturn
+);
+// countThreads includes the calling thread.  0 means one thread per hardware thread.  Work runs on the calling thread until this is called.
+// Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetInteractionThreadCount(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countThreads
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeInteraction(
    PEbmInteraction ebmInteraction
 );
 
+const IntegerDataType ScoreLinkIdentity = 0;
+const IntegerDataType ScoreLinkSigmoid = 1;
+const IntegerDataType ScoreLinkSoftmax = 2;
+
+// adds up intercept and the models of the feature combinations for each of countInstances binned instances in one pass over the instances.
+// countScores is the number of logits in each model cell, which is 1 for regression and binary classification and countTargetClasses for
+// multiclass.  models holds one tensor per feature combination in the layout of GetBestModelFeatureCombination, and feature combinations whose
+// model is nullptr are skipped.  intercept holds countScores values, or is nullptr for a zero intercept.  Every bin in binnedData for a feature
+// that is in a feature combination must be less than the feature's countBins.  scoresReturn receives countScores values per instance for
+// ScoreLinkIdentity, which are the logits, and 1 value per instance for ScoreLinkSigmoid, which needs countScores to be 1.  ScoreLinkSoftmax
+// writes one probability per class, which for countScores of 1 is 2 values per instance with the first for the class whose logit is implicitly
+// zero.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION ScoreBinnedInstances(
+   IntegerDataType countScores,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * models,
+   const FractionalDataType * intercept,
+   IntegerDataType countInstances,
+   const EbmCoreBinnedData * binnedData,
+   IntegerDataType link,
+   FractionalDataType * scoresReturn
+);
+
+// compiles a model that scores raw instances, which it bins itself.  features, countFeatureCombinations, featureCombinations,
+// featureCombinationIndexes, models and intercept are the same as for ScoreBinnedInstances, and the model keeps its own copy of all of them.
+// featureCuts has one entry per feature, and a FeatureTypeOrdinal feature's entry holds countBins - 1 ascending cut points.  An ordinal value goes
+// into the bin that is the count of cut points that are not greater than it, so NaN goes into the last bin.  featureCategories has one entry per
+// feature too, and a FeatureTypeNominal feature's entry holds countBins unique NUL terminated strings where the string at index i is the category
+// of bin i.  Either array can be nullptr if no feature needs it.  Returns nullptr on error
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmModel EBMCORE_CALLING_CONVENTION CompileModel(
+   IntegerDataType countScores,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   const FractionalDataType * const * featureCuts,
+   const char * const * const * featureCategories,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * models,
+   const FractionalDataType * intercept
+);
+// scores countInstances raw instances.  values and categories each hold countFeatures entries per instance in instance major order.  Ordinal
+// features read values and nominal features read categories, and the entries of the other kind of feature are ignored.  A category that is
+// nullptr or that the model hasn't seen goes into bin 0.  link and scoresReturn are the same as for ScoreBinnedInstances.  Large batches are split
+// into chunks of rows that the model's threads score at the same time, and several threads can call this on the same model.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION ScoreRawInstances(
+   PEbmModel ebmModel,
+   IntegerDataType countInstances,
+   const FractionalDataType * values,
+   const char * const * categories,
+   IntegerDataType link,
+   FractionalDataType * scoresReturn
+);
+// countThreads includes the calling thread.  0 means one thread per hardware thread.  A model scores on the calling thread until this is called.
+// Don't call this while the model is scoring.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetModelThreadCount(
+   PEbmModel ebmModel,
+   IntegerDataType countThreads
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeModel(
+   PEbmModel ebmModel
+);
+// writes a compiled model to a file that OpenModelFile can map.  The file is versioned and little endian, and every array in it is 8 byte aligned.
+// Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION WriteModelFile(
+   PEbmModel ebmModel,
+   const char * path
+);
+// writes the best models of a training state to a model file.  The features and feature combinations are the ones of the training state, and
+// featureCuts, featureCategories and intercept are the same as for CompileModel.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION WriteTrainingModelFile(
+   PEbmTraining ebmTraining,
+   const FractionalDataType * const * featureCuts,
+   const char * const * const * featureCategories,
+   const FractionalDataType * intercept,
+   const char * path
+);
+// opens a model file by mapping it read only, so every process that opens the same file shares one copy of its pages.  The cuts, category tables
+// and tensors are used in place, and only the pages that scoring reads are ever loaded.  The file needs to stay unchanged until FreeModel.
+// Returns nullptr on error
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmModel EBMCORE_CALLING_CONVENTION OpenModelFile(
+   const char * path
+);
+// replaces the tensors of a compiled model with countBitsQuantized bit (8 or 16) integer tensors, which are 8 or 4 times smaller, so more of them
+// stay in cache while scoring.  Every term keeps its own scale and offset, and spreads its range of logits over every integer, so each quantized
+// logit is within half a step of the original.  maxErrorsReturn receives the largest error of each term, in the order of the feature combinations
+// that had a model, or can be nullptr.  A model is quantized at most once, and WriteModelFile writes the quantized tensors.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION QuantizeModel(
+   PEbmModel ebmModel,
+   IntegerDataType countBitsQuantized,
+   FractionalDataType * maxErrorsReturn
+);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -0,0 +1,33 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef EBMCORE_TEST_HOOKS_H
+#define EBMCORE_TEST_HOOKS_H
+
+// diagnostic functions for our own tests.  They only exist in libraries built with build.sh -test_hooks, which defines EBM_TEST_HOOKS and gives
+// the library its own file name, so the libraries that we ship don't export them
+
+#include "ebmcore.h"
+
+#ifdef EBM_TEST_HOOKS
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// the number of times this library has asked the system for memory since it was loaded, or -1 if this build doesn't count them.  Only our Linux
+// build counts them.  Comparing the count before and after a call tells you whether the call allocated
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetHeapAllocationCount();
+// makes the library use the kernels that it compiled for instructionSet instead of the best ones that the processor supports.  0 is the portable
+// scalar code, 1 is SSE2, 2 is AVX2, 3 is AVX-512, and -1 goes back to the best.  Returns 1 if this build or processor can't run that instruction set,
+// otherwise 0.  The kernels are read without synchronization, so only call this while no training, interaction or model object is running
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetInstructionSet(IntegerDataType instructionSet);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // EBM_TEST_HOOKS
+
+#endif // EBMCORE_TEST_HOOKS_H
@@ -26,10 +26,51 @@
 // https://stackoverflow.com/questions/36461555/is-it-possible-to-statically-link-libstdc-and-wrap-memcpy
 //
 
+// our tests also build the library with build.sh -test_hooks, which adds: -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -Wl,--wrap=mmap
+// and -DEBM_COUNT_HEAP_ALLOCATIONS.  The wrappers pass straight through to the real functions, so the process keeps a single allocator
+// (and sanitizers still see every call), but they count how many times the library asked for memory.  Since we link libstdc++ statically,
+// operator new inside the library comes through malloc and gets counted too, while allocations made by the program that loads us do not.
+// GetHeapAllocationCount returns the count so that tests can check that steady state training doesn't allocate.  The libraries that we ship
+// don't wrap these, so they don't pay for the shared counter on every allocation
+
 #include <string.h>
+#include <stddef.h>
+#include <atomic>
+#include <sys/types.h>
+
+#ifdef EBM_COUNT_HEAP_ALLOCATIONS
+extern std::atomic<size_t> g_cHeapAllocations;
+#endif // EBM_COUNT_HEAP_ALLOCATIONS
 
 extern "C" {
    void * __wrap_memcpy(void * dest, const void * src, size_t n) {
       return memmove(dest, src, n);
    }
+
+#ifdef EBM_COUNT_HEAP_ALLOCATIONS
+   void * __real_malloc(size_t size);
+   void * __real_calloc(size_t num, size_t size);
+   void * __real_realloc(void * ptr, size_t size);
+   void * __real_mmap(void * addr, size_t length, int prot, int flags, int fd, off_t offset);
+
+   void * __wrap_malloc(size_t size) {
+      g_cHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+      return __real_malloc(size);
+   }
+
+   void * __wrap_calloc(size_t num, size_t size) {
+      g_cHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+      return __real_calloc(num, size);
+   }
+
+   void * __wrap_realloc(void * ptr, size_t size) {
+      g_cHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+      return __real_realloc(ptr, size);
+   }
+
+   void * __wrap_mmap(void * addr, size_t length, int prot, int flags, int fd, off_t offset) {
+      g_cHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+      return __real_mmap(addr, length, prot, flags, fd, offset);
+   }
+#endif // EBM_COUNT_HEAP_ALLOCATIONS
 }
@@ -4,7 +4,7 @@
 
 from ...utils import perf_dict
 from .utils import EBMUtils
-from .internal import NativeEBM
+from .internal import NativeEBM, NativeEBMDataSet, NativeEBMEnsemble
 from .postprocessing import multiclass_postprocess
 from ...utils import unify_data, autogen_schema
 from ...api.base import ExplainerMixin
@@ -27,6 +27,7 @@ from sklearn.base import (
     RegressorMixin,
 )
 from sklearn.model_selection import train_test_split
+from joblib import effective_n_jobs
 from contextlib import closing
 from itertools import combinations
 
@@ -377,22 +378,7 @@ class BaseCoreEBM(BaseEstimator):
             self.n_classes_ = -1
 
         # Split data into train/val
-
-        if self.holdout_split > 0:
-            X_train, X_val, y_train, y_val = train_test_split(
-                X,
-                y,
-                test_size=self.holdout_split,
-                random_state=self.random_state,
-                stratify=y if is_classifier(self) else None,
-            )
-        elif self.holdout_split == 0:
-            X_train = X
-            y_train = y
-            X_val = np.empty(shape=(0, 0)).astype(np.int64)
-            y_val = np.empty(shape=(0,)).astype(np.int64)
-        else:  # pragma: no cover
-            raise Exception("Holdout_split must be between 0 and 1.")
+        train_indexes, val_indexes = self._split_indexes(X, y)
         # Define attributes
         self.attributes_ = EBMUtils.gen_attributes(self.col_types, self.col_n_bins)
         # Build EBM allocation code
@@ -419,49 +405,77 @@ class BaseCoreEBM(BaseEstimator):
         else:
             raise RuntimeError("Argument 'main_attr' has invalid value")
         main_attr_sets = EBMUtils.gen_attribute_sets(main_attr_indices)
+
+        # Pack the binned data once for the mains, the interaction detection
+        # and the pairs, which each pick their rows by index.
         with closing(
-            NativeEBM(
+            NativeEBMDataSet(
                 self.attributes_,
-                main_attr_sets,
-                X_train,
-                y_train,
-                X_val,
-                y_val,
-                num_inner_bags=self.feature_step_n_inner_bags,
-                num_classification_states=self.n_classes_,
+                X,
+                y,
                 model_type=model_type,
-                training_scores=None,
-                validation_scores=None,
+                num_classification_states=self.n_classes_,
             )
-        ) as native_ebm:
-            # Train main effects
-            self._fit_main(native_ebm, main_attr_sets)
+        ) as data_set:
+            with closing(
+                NativeEBM(
+                    self.attributes_,
+                    main_attr_sets,
+                    None,
+                    None,
+                    None,
+                    None,
+                    num_inner_bags=self.feature_step_n_inner_bags,
+                    num_classification_states=self.n_classes_,
+                    model_type=model_type,
+                    training_scores=None,
+                    validation_scores=None,
+                    data_set=data_set,
+                    train_indexes=train_indexes,
+                    val_indexes=val_indexes,
+                )
+            ) as native_ebm:
+                # Train main effects
+                self._fit_main(native_ebm, main_attr_sets)
 
-            # Build interaction terms
-            self.inter_indices_, self.inter_scores_ = self._build_interactions(
-                native_ebm
-            )
+                # Build interaction terms
+                self.inter_indices_, self.inter_scores_ = self._build_interactions(
+                    native_ebm
+                )
 
-        self.staged_fit_interactions(X, y, self.inter_indices_)
+            self._staged_fit_interactions(
+                X, self.inter_indices_, data_set, train_indexes, val_indexes
+            )
 
         return self
 
+    def _split_indexes(self, X, y):
+        # The same rows that train_test_split(X, y, ...) would pick.
+        indexes = np.arange(X.shape[0], dtype=np.int64)
+        if self.holdout_split > 0:
+            train_indexes, val_indexes = train_test_split(
+                indexes,
+                test_size=self.holdout_split,
+                random_state=self.random_state,
+                stratify=y if is_classifier(self) else None,
+            )
+        elif self.holdout_split == 0:
+            train_indexes = indexes
+            val_indexes = np.empty(shape=(0,), dtype=np.int64)
+        else:  # pragma: no cover
+            raise Exception("Holdout_split must be between 0 and 1.")
+        return train_indexes, val_indexes
+
     def _build_interactions(self, native_ebm):
         if isinstance(self.interactions, int) and self.interactions != 0:
             log.info("Estimating with FAST")
-            interaction_scores = []
             interaction_indices = [
                 x for x in combinations(range(len(self.col_types)), 2)
             ]
-            for pair in interaction_indices:
-                score = native_ebm.fast_interaction_score(pair)
-                interaction_scores.append((pair, score))
-
-            ranked_scores = list(
-                sorted(interaction_scores, key=lambda x: x[1], reverse=True)
+            # Ranked natively, with ties kept in pair order like a stable sort.
+            final_ranked_scores = native_ebm.fast_interaction_scores(
+                interaction_indices, top_k=self.interactions
             )
-            n_interactions = min(len(ranked_scores), self.interactions)
-            final_ranked_scores = ranked_scores[0:n_interactions]
 
             final_indices = [x[0] for x in final_ranked_scores]
             final_scores = [x[1] for x in final_ranked_scores]
@@ -501,14 +515,36 @@ class BaseCoreEBM(BaseEstimator):
 
         log.info("Training interactions")
 
+        if is_classifier(self):
+            model_type = "classification"
+        else:
+            model_type = "regression"
+
         # Split data into train/val
-        X_train, X_val, y_train, y_val = train_test_split(
-            X,
-            y,
-            test_size=self.holdout_split,
-            random_state=self.random_state,
-            stratify=y if is_classifier(self) else None,
-        )
+        train_indexes, val_indexes = self._split_indexes(X, y)
+        with closing(
+            NativeEBMDataSet(
+                self.attributes_,
+                X,
+                y,
+                model_type=model_type,
+                num_classification_states=self.n_classes_,
+            )
+        ) as data_set:
+            self._staged_fit_interactions(
+                X, inter_indices, data_set, train_indexes, val_indexes
+            )
+
+        return self
+
+    def _staged_fit_interactions(
+        self, X, inter_indices, data_set, train_indexes, val_indexes
+    ):
+        self.inter_episode_idx_ = 0
+        if len(inter_indices) == 0:
+            log.info("No interactions to train")
+            return self
+
         if is_classifier(self):
             model_type = "classification"
         else:
@@ -526,23 +562,26 @@ class BaseCoreEBM(BaseEstimator):
         self.attribute_sets_ = new_attribute_sets
 
         # Fix main, train interactions
-        training_scores = self.decision_function(X_train)
-        validation_scores = self.decision_function(X_val)
+        training_scores = self.decision_function(X[train_indexes])
+        validation_scores = self.decision_function(X[val_indexes])
         inter_attr_sets = EBMUtils.gen_attribute_sets(inter_indices)
         with closing(
             NativeEBM(
                 self.attributes_,
                 inter_attr_sets,
-                X_train,
-                y_train,
-                X_val,
-                y_val,
+                None,
+                None,
+                None,
+                None,
                 num_inner_bags=self.feature_step_n_inner_bags,
                 num_classification_states=self.n_classes_,
                 model_type=model_type,
                 training_scores=training_scores,
                 validation_scores=validation_scores,
                 random_state=self.random_state,
+                data_set=data_set,
+                train_indexes=train_indexes,
+                val_indexes=val_indexes,
             )
         ) as native_ebm:
             log.info("Train interactions")
@@ -566,49 +605,24 @@ class BaseCoreEBM(BaseEstimator):
 
     def _cyclic_gradient_boost(self, native_ebm, attribute_sets, name=None):
 
-        no_change_run_length = 0
-        curr_metric = np.inf
-        min_metric = np.inf
-        bp_metric = np.inf
         log.info("Start boosting {0}".format(name))
-        curr_episode_index = 0
-        for data_episode_index in range(self.data_n_episodes):
-            curr_episode_index = data_episode_index
-
-            if data_episode_index % 10 == 0:
-                log.debug("Sweep Index for {0}: {1}".format(name, data_episode_index))
-                log.debug("Metric: {0}".format(curr_metric))
-
-            if len(attribute_sets) == 0:
-                log.debug("No sets to boost for {0}".format(name))
-
-            for index, attribute_set in enumerate(attribute_sets):
-                curr_metric = native_ebm.training_step(
-                    index,
-                    training_step_episodes=self.training_step_episodes,
-                    learning_rate=self.learning_rate,
-                    max_tree_splits=self.max_tree_splits,
-                    min_cases_for_split=self.min_cases_for_splits,
-                    training_weights=0,
-                    validation_weights=0,
-                )
-
-            # NOTE: Out of per-feature boosting on purpose.
-            min_metric = min(curr_metric, min_metric)
-
-            if no_change_run_length == 0:
-                bp_metric = min_metric
-            if curr_metric + self.early_stopping_tolerance < bp_metric:
-                no_change_run_length = 0
-            else:
-                no_change_run_length += 1
-
-            if (
-                self.early_stopping_run_length >= 0
-                and no_change_run_length >= self.early_stopping_run_length
-            ):
-                log.info("Early break {0}: {1}".format(name, data_episode_index))
-                break
+        if len(attribute_sets) == 0:
+            log.debug("No sets to boost for {0}".format(name))
+
+        # The round robin loop and early stopping run natively.
+        curr_metric, n_episodes = native_ebm.boost_cycles(
+            list(range(len(attribute_sets))),
+            self.data_n_episodes,
+            training_step_episodes=self.training_step_episodes,
+            learning_rate=self.learning_rate,
+            max_tree_splits=self.max_tree_splits,
+            min_cases_for_split=self.min_cases_for_splits,
+            early_stopping_run_length=self.early_stopping_run_length,
+            early_stopping_tolerance=self.early_stopping_tolerance,
+        )
+        curr_episode_index = max(n_episodes - 1, 0)
+        if n_episodes < self.data_n_episodes:
+            log.info("Early break {0}: {1}".format(name, curr_episode_index))
         log.info("End boosting {0}".format(name))
 
         return curr_metric, curr_episode_index
@@ -863,48 +877,7 @@ class BaseEBM(BaseEstimator):
             self.intercept_ = 0
         X_orig = X
         X = self.preprocessor_.transform(X)
-        estimators = []
-        for i in range(self.n_estimators):
-            estimator = clone(proto_estimator)
-            # Yulong: why is random state + i?? ohh to make it random in different ways
-            estimator.set_params(random_state=self.random_state + i)
-            estimators.append(estimator)
-
-        provider = JobLibProvider(n_jobs=self.n_jobs)
-
-        def train_model(estimator, X, y):
-            return estimator.fit(X, y)
-
-        train_model_args_iter = (
-            (estimators[i], X, y) for i in range(self.n_estimators)
-        )
-
-        # Yulong: so each estimator is just part of the bagged ensemble, but there isn't boosting in between?
-        estimators = provider.parallel(train_model, train_model_args_iter)
-
-        if isinstance(self.interactions, int) and self.interactions > 0:
-            # Select merged pairs
-            pair_indices = self._select_merged_pairs(estimators, X, y)
-
-            # Retrain interactions for base models
-            def staged_fit_fn(estimator, X, y, inter_indices=[]):
-                return estimator.staged_fit_interactions(X, y, inter_indices)
-
-            staged_fit_args_iter = (
-                (estimators[i], X, y, pair_indices) for i in range(self.n_estimators)
-            )
-
-            estimators = provider.parallel(staged_fit_fn, staged_fit_args_iter)
-        elif isinstance(self.interactions, int) and self.interactions == 0:
-            pair_indices = []
-        elif isinstance(self.interactions, list):
-            pair_indices = self.interactions
-        else:  # pragma: no cover
-            raise RuntimeError("Argument 'interaction' has invalid value")
 
-        self.inter_indices_ = pair_indices
-
-        # Average base models into one.
         self.attributes_ = EBMUtils.gen_attributes(
             self.preprocessor_.col_types_, self.preprocessor_.col_n_bins_
         )
@@ -920,29 +893,21 @@ class BaseEBM(BaseEstimator):
             )
             raise RuntimeError(msg)
 
-        self.attribute_sets_ = EBMUtils.gen_attribute_sets(main_indices)
-        self.attribute_sets_.extend(EBMUtils.gen_attribute_sets(pair_indices))
-
-        # Merge estimators into one.
-        self.attribute_set_models_ = []
-        self.model_errors_ = []
-        for index, _ in enumerate(self.attribute_sets_):
-            log_odds_tensors = []
-            for estimator in estimators:
-                log_odds_tensors.append(estimator.attribute_set_models_[index])
-
-            averaged_model = np.average(np.array(log_odds_tensors), axis=0)
-            model_errors = np.std(np.array(log_odds_tensors), axis=0)
-
-            self.attribute_set_models_.append(averaged_model)
-            self.model_errors_.append(model_errors)
-
-        # Get episode indexes for base estimators.
-        self.main_episode_idxs_ = []
-        self.inter_episode_idxs_ = []
-        for estimator in estimators:
-            self.main_episode_idxs_.append(estimator.main_episode_idx_)
-            self.inter_episode_idxs_.append(estimator.inter_episode_idx_)
+        if (
+            isinstance(self.interactions, int)
+            and self.interactions == 0
+            and 0 < self.holdout_split < 1
+            and self.feature_step_n_inner_bags == 0
+        ):
+            # Without pairs the base models only train main effects, so all
+            # of them are trained together natively over one copy of X.
+            # Inner bags would sample rows in the order of X instead of the
+            # shuffled order that each base estimator trains on.
+            self.inter_indices_ = []
+            self.attribute_sets_ = EBMUtils.gen_attribute_sets(main_indices)
+            self._fit_main_ensemble(X, y)
+        else:
+            self._fit_estimators(proto_estimator, X, y, main_indices)
 
         # Extract feature names and feature types.
         self.feature_names = []
@@ -1003,6 +968,124 @@ class BaseEBM(BaseEstimator):
         self.has_fitted_ = True
         return self
 
+    def _fit_estimators(self, proto_estimator, X, y, main_indices):
+        estimators = []
+        for i in range(self.n_estimators):
+            estimator = clone(proto_estimator)
+            # Yulong: why is random state + i?? ohh to make it random in different ways
+            estimator.set_params(random_state=self.random_state + i)
+            estimators.append(estimator)
+
+        provider = JobLibProvider(n_jobs=self.n_jobs)
+
+        def train_model(estimator, X, y):
+            return estimator.fit(X, y)
+
+        train_model_args_iter = (
+            (estimators[i], X, y) for i in range(self.n_estimators)
+        )
+
+        # Yulong: so each estimator is just part of the bagged ensemble, but there isn't boosting in between?
+        estimators = provider.parallel(train_model, train_model_args_iter)
+
+        if isinstance(self.interactions, int) and self.interactions > 0:
+            # Select merged pairs
+            pair_indices = self._select_merged_pairs(estimators, X, y)
+
+            # Retrain interactions for base models
+            def staged_fit_fn(estimator, X, y, inter_indices=[]):
+                return estimator.staged_fit_interactions(X, y, inter_indices)
+
+            staged_fit_args_iter = (
+                (estimators[i], X, y, pair_indices) for i in range(self.n_estimators)
+            )
+
+            estimators = provider.parallel(staged_fit_fn, staged_fit_args_iter)
+        elif isinstance(self.interactions, int) and self.interactions == 0:
+            pair_indices = []
+        elif isinstance(self.interactions, list):
+            pair_indices = self.interactions
+        else:  # pragma: no cover
+            raise RuntimeError("Argument 'interaction' has invalid value")
+
+        self.inter_indices_ = pair_indices
+
+        # Average base models into one.
+        self.attribute_sets_ = EBMUtils.gen_attribute_sets(main_indices)
+        self.attribute_sets_.extend(EBMUtils.gen_attribute_sets(pair_indices))
+
+        # Merge estimators into one.
+        self.attribute_set_models_ = []
+        self.model_errors_ = []
+        for index, _ in enumerate(self.attribute_sets_):
+            log_odds_tensors = []
+            for estimator in estimators:
+                log_odds_tensors.append(estimator.attribute_set_models_[index])
+
+            averaged_model = np.average(np.array(log_odds_tensors), axis=0)
+            model_errors = np.std(np.array(log_odds_tensors), axis=0)
+
+            self.attribute_set_models_.append(averaged_model)
+            self.model_errors_.append(model_errors)
+
+        # Get episode indexes for base estimators.
+        self.main_episode_idxs_ = []
+        self.inter_episode_idxs_ = []
+        for estimator in estimators:
+            self.main_episode_idxs_.append(estimator.main_episode_idx_)
+            self.inter_episode_idxs_.append(estimator.inter_episode_idx_)
+
+    def _fit_main_ensemble(self, X, y):
+        n_instances = X.shape[0]
+        validation_masks = np.zeros((self.n_estimators, n_instances), dtype=np.int64)
+        for i in range(self.n_estimators):
+            # The same holdout split that each base estimator would draw.
+            _, val_indices = train_test_split(
+                np.arange(n_instances),
+                test_size=self.holdout_split,
+                random_state=self.random_state + i,
+                stratify=y if is_classifier(self) else None,
+            )
+            validation_masks[i, val_indices] = 1
+
+        model_type = "classification" if is_classifier(self) else "regression"
+        with closing(
+            NativeEBMEnsemble(
+                self.attributes_,
+                self.attribute_sets_,
+                X,
+                y,
+                validation_masks,
+                model_type=model_type,
+                num_inner_bags=self.feature_step_n_inner_bags,
+                num_classification_states=self.n_classes_,
+                n_threads=effective_n_jobs(self.n_jobs),
+            )
+        ) as native_ensemble:
+            log.info("Train main effects for {0} bags".format(self.n_estimators))
+            _, n_episodes = native_ensemble.boost_cycles(
+                list(range(len(self.attribute_sets_))),
+                self.data_n_episodes,
+                training_step_episodes=self.training_step_episodes,
+                learning_rate=self.learning_rate,
+                max_tree_splits=self.max_tree_splits,
+                min_cases_for_split=self.min_cases_for_splits,
+                early_stopping_run_length=self.early_stopping_run_length,
+                early_stopping_tolerance=self.early_stopping_tolerance,
+            )
+
+            self.attribute_set_models_ = []
+            self.model_errors_ = []
+            for index, _ in enumerate(self.attribute_sets_):
+                averaged_model, model_errors = native_ensemble.get_averaged_model(
+                    index
+                )
+                self.attribute_set_models_.append(averaged_model)
+                self.model_errors_.append(model_errors)
+
+        self.main_episode_idxs_ = [max(int(x) - 1, 0) for x in n_episodes]
+        self.inter_episode_idxs_ = [0] * self.n_estimators
+
     def _select_merged_pairs(self, estimators, X, y):
         # Select pairs from base models
         def score_fn(est, X, y, drop_indices):
@@ -1019,13 +1102,13 @@ class BaseEBM(BaseEstimator):
             backward_impacts = []
             forward_impacts = []
 
-            X_train, X_val, y_train, y_val = train_test_split(
-                X,
-                y,
-                test_size=self.holdout_split,
-                random_state=estimator.random_state,
-                stratify=y if is_classifier(self) else None,
-            )
+            # Score on the rows that the estimator held out, or on every row
+            # when it trained without a holdout set.
+            _, val_indexes = estimator._split_indexes(X, y)
+            if len(val_indexes) == 0:
+                X_val, y_val = X, y
+            else:
+                X_val, y_val = X[val_indexes], y[val_indexes]
             base_forward_score = score_fn(
                 estimator, X_val, y_val, estimator.inter_indices_
             )
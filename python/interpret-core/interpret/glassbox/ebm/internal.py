@@ -9,6 +9,7 @@ from numpy.ctypeslib import ndpointer
 import numpy as np
 import os
 import struct
+import numbers
 import logging
 
 log = logging.getLogger(__name__)
@@ -42,6 +43,36 @@ class Native:
             ("countFeaturesInCombination", ct.c_longlong)
         ]
 
+    # const int64_t BinnedDataTypeUInt8 = 0;
+    BinnedDataTypeUInt8 = 0
+    # const int64_t BinnedDataTypeUInt16 = 1;
+    BinnedDataTypeUInt16 = 1
+    # const int64_t BinnedDataTypeInt32 = 2;
+    BinnedDataTypeInt32 = 2
+    # const int64_t BinnedDataTypeInt64 = 3;
+    BinnedDataTypeInt64 = 3
+    # const int64_t BinnedDataTypeFloat64 = 4;
+    BinnedDataTypeFloat64 = 4
+
+    class EbmCoreBinnedData(ct.Structure):
+        _fields_ = [
+            # int64_t dataType;
+            ("dataType", ct.c_longlong),
+            # int64_t strideInstance;
+            ("strideInstance", ct.c_longlong),
+            # int64_t strideFeature;
+            ("strideFeature", ct.c_longlong),
+            # void * data;
+            ("data", ct.c_void_p),
+        ]
+
+    # const int64_t ScoreLinkIdentity = 0;
+    ScoreLinkIdentity = 0
+    # const int64_t ScoreLinkSigmoid = 1;
+    ScoreLinkSigmoid = 1
+    # const int64_t ScoreLinkSoftmax = 2;
+    ScoreLinkSoftmax = 2
+
     LogFuncType = ct.CFUNCTYPE(None, ct.c_char, ct.c_char_p)
 
     # const signed char TraceLevelOff = 0;
@@ -73,6 +104,57 @@ class Native:
             # signed char traceLevel
             ct.c_char
         ]
+        self.lib.CreateDataSetRegression.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countInstances
+            ct.c_longlong,
+            # double * targets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # EbmCoreBinnedData * binnedData
+            ct.POINTER(self.EbmCoreBinnedData),
+        ]
+        self.lib.CreateDataSetRegression.restype = ct.c_void_p
+
+        self.lib.CreateDataSetClassification.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countInstances
+            ct.c_longlong,
+            # int64_t * targets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # EbmCoreBinnedData * binnedData
+            ct.POINTER(self.EbmCoreBinnedData),
+        ]
+        self.lib.CreateDataSetClassification.restype = ct.c_void_p
+
+        self.lib.FreeDataSet.argtypes = [
+            # void * ebmDataSet
+            ct.c_void_p
+        ]
+
+        self.lib.WriteDataSetFile.argtypes = [
+            # void * ebmDataSet
+            ct.c_void_p,
+            # double * predictorScores, or nullptr
+            ct.c_void_p,
+            # const char * path
+            ct.c_char_p,
+        ]
+        self.lib.WriteDataSetFile.restype = ct.c_longlong
+
+        self.lib.OpenDataSetFile.argtypes = [
+            # const char * path
+            ct.c_char_p
+        ]
+        self.lib.OpenDataSetFile.restype = ct.c_void_p
+
         self.lib.InitializeTrainingRegression.argtypes = [
             # int64_t randomSeed
             ct.c_longlong,
@@ -143,6 +225,104 @@ class Native:
         ]
         self.lib.InitializeTrainingClassification.restype = ct.c_void_p
 
+        self.lib.InitializeTrainingRegressionStrided.argtypes = [
+            # int64_t randomSeed
+            ct.c_longlong,
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # double * trainingTargets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # EbmCoreBinnedData * trainingBinnedData
+            ct.POINTER(self.EbmCoreBinnedData),
+            # double * trainingPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countValidationInstances
+            ct.c_longlong,
+            # double * validationTargets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # EbmCoreBinnedData * validationBinnedData
+            ct.POINTER(self.EbmCoreBinnedData),
+            # double * validationPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countInnerBags
+            ct.c_longlong,
+        ]
+        self.lib.InitializeTrainingRegressionStrided.restype = ct.c_void_p
+
+        self.lib.InitializeTrainingClassificationStrided.argtypes = [
+            # int64_t randomSeed
+            ct.c_longlong,
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # int64_t * trainingTargets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # EbmCoreBinnedData * trainingBinnedData
+            ct.POINTER(self.EbmCoreBinnedData),
+            # double * trainingPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countValidationInstances
+            ct.c_longlong,
+            # int64_t * validationTargets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # EbmCoreBinnedData * validationBinnedData
+            ct.POINTER(self.EbmCoreBinnedData),
+            # double * validationPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countInnerBags
+            ct.c_longlong,
+        ]
+        self.lib.InitializeTrainingClassificationStrided.restype = ct.c_void_p
+
+        self.lib.InitializeTrainingFromDataSet.argtypes = [
+            # int64_t randomSeed
+            ct.c_longlong,
+            # void * ebmDataSet
+            ct.c_void_p,
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # int64_t * trainingInstanceIndexes
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # double * trainingPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countValidationInstances
+            ct.c_longlong,
+            # int64_t * validationInstanceIndexes
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # double * validationPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countInnerBags
+            ct.c_longlong,
+        ]
+        self.lib.InitializeTrainingFromDataSet.restype = ct.c_void_p
+
         self.lib.GenerateModelFeatureCombinationUpdate.argtypes = [
             # void * ebmTraining
             ct.c_void_p,
@@ -177,6 +357,34 @@ class Native:
         ]
         self.lib.ApplyModelFeatureCombinationUpdate.restype = ct.c_longlong
 
+        self.lib.BoostCycles.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t countFeatureCombinationsInCycle
+            ct.c_longlong,
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # int64_t countEpisodes
+            ct.c_longlong,
+            # int64_t countStepsPerFeatureCombination
+            ct.c_longlong,
+            # double learningRate
+            ct.c_double,
+            # int64_t countTreeSplitsMax
+            ct.c_longlong,
+            # int64_t countInstancesRequiredForParentSplitMin
+            ct.c_longlong,
+            # int64_t earlyStoppingRunLength
+            ct.c_longlong,
+            # double earlyStoppingTolerance
+            ct.c_double,
+            # double * validationMetricReturn
+            ct.POINTER(ct.c_double),
+            # int64_t * countEpisodesReturn
+            ct.POINTER(ct.c_longlong),
+        ]
+        self.lib.BoostCycles.restype = ct.c_longlong
+
         self.lib.GetCurrentModelFeatureCombination.argtypes = [
             # void * ebmTraining
             ct.c_void_p,
@@ -193,11 +401,150 @@ class Native:
         ]
         self.lib.GetBestModelFeatureCombination.restype = ct.POINTER(ct.c_double)
 
+        self.lib.SetTrainingThreadCount.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t countThreads
+            ct.c_longlong,
+        ]
+        self.lib.SetTrainingThreadCount.restype = ct.c_longlong
+
+        self.lib.SetTrainingPrecomputedDenominators.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t precomputeDenominators
+            ct.c_longlong,
+        ]
+        self.lib.SetTrainingPrecomputedDenominators.restype = ct.c_longlong
+
         self.lib.FreeTraining.argtypes = [
             # void * ebmTraining
             ct.c_void_p
         ]
 
+        self.lib.InitializeEnsembleTrainingRegression.argtypes = [
+            # int64_t countBags
+            ct.c_longlong,
+            # int64_t * randomSeeds
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countInstances
+            ct.c_longlong,
+            # double * targets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * binnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * validationMasks
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=2),
+            # int64_t countInnerBags
+            ct.c_longlong,
+        ]
+        self.lib.InitializeEnsembleTrainingRegression.restype = ct.c_void_p
+
+        self.lib.InitializeEnsembleTrainingClassification.argtypes = [
+            # int64_t countBags
+            ct.c_longlong,
+            # int64_t * randomSeeds
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countInstances
+            ct.c_longlong,
+            # int64_t * targets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * binnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * validationMasks
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=2),
+            # int64_t countInnerBags
+            ct.c_longlong,
+        ]
+        self.lib.InitializeEnsembleTrainingClassification.restype = ct.c_void_p
+
+        self.lib.BoostEnsembleCycles.argtypes = [
+            # void * ebmEnsembleTraining
+            ct.c_void_p,
+            # int64_t countFeatureCombinationsInCycle
+            ct.c_longlong,
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # int64_t countEpisodes
+            ct.c_longlong,
+            # int64_t countStepsPerFeatureCombination
+            ct.c_longlong,
+            # double learningRate
+            ct.c_double,
+            # int64_t countTreeSplitsMax
+            ct.c_longlong,
+            # int64_t countInstancesRequiredForParentSplitMin
+            ct.c_longlong,
+            # int64_t earlyStoppingRunLength
+            ct.c_longlong,
+            # double earlyStoppingTolerance
+            ct.c_double,
+            # double * validationMetricsReturn
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # int64_t * countEpisodesReturn
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+        ]
+        self.lib.BoostEnsembleCycles.restype = ct.c_longlong
+
+        self.lib.GetEnsembleModelFeatureCombination.argtypes = [
+            # void * ebmEnsembleTraining
+            ct.c_void_p,
+            # int64_t indexFeatureCombination
+            ct.c_longlong,
+            # double * averageModelReturn
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS"),
+            # double * standardDeviationReturn
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS"),
+        ]
+        self.lib.GetEnsembleModelFeatureCombination.restype = ct.c_longlong
+
+        self.lib.SetEnsembleTrainingThreadCount.argtypes = [
+            # void * ebmEnsembleTraining
+            ct.c_void_p,
+            # int64_t countThreads
+            ct.c_longlong,
+        ]
+        self.lib.SetEnsembleTrainingThreadCount.restype = ct.c_longlong
+
+        self.lib.SetEnsembleTrainingPrecomputedDenominators.argtypes = [
+            # void * ebmEnsembleTraining
+            ct.c_void_p,
+            # int64_t precomputeDenominators
+            ct.c_longlong,
+        ]
+        self.lib.SetEnsembleTrainingPrecomputedDenominators.restype = ct.c_longlong
+
+        self.lib.FreeEnsembleTraining.argtypes = [
+            # void * ebmEnsembleTraining
+            ct.c_void_p
+        ]
+
         self.lib.InitializeInteractionClassification.argtypes = [
             # int64_t countFeatures
             ct.c_longlong,
@@ -232,6 +579,52 @@ class Native:
         ]
         self.lib.InitializeInteractionRegression.restype = ct.c_void_p
 
+        self.lib.InitializeInteractionClassificationStrided.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countInstances
+            ct.c_longlong,
+            # int64_t * targets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # EbmCoreBinnedData * binnedData
+            ct.POINTER(self.EbmCoreBinnedData),
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+        ]
+        self.lib.InitializeInteractionClassificationStrided.restype = ct.c_void_p
+
+        self.lib.InitializeInteractionRegressionStrided.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countInstances
+            ct.c_longlong,
+            # double * targets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # EbmCoreBinnedData * binnedData
+            ct.POINTER(self.EbmCoreBinnedData),
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+        ]
+        self.lib.InitializeInteractionRegressionStrided.restype = ct.c_void_p
+
+        self.lib.InitializeInteractionFromDataSet.argtypes = [
+            # void * ebmDataSet
+            ct.c_void_p,
+            # int64_t countInstances
+            ct.c_longlong,
+            # int64_t * instanceIndexes
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+        ]
+        self.lib.InitializeInteractionFromDataSet.restype = ct.c_void_p
+
         self.lib.GetInteractionScore.argtypes = [
             # void * ebmInteraction
             ct.c_void_p,
@@ -244,10 +637,185 @@ class Native:
         ]
         self.lib.GetInteractionScore.restype = ct.c_longlong
 
-        self.lib.FreeInteraction.argtypes = [
+        self.lib.GetInteractionScores.argtypes = [
             # void * ebmInteraction
-            ct.c_void_p
+            ct.c_void_p,
+            # int64_t countCombinations
+            ct.c_longlong,
+            # int64_t countFeaturesInCombination
+            ct.c_longlong,
+            # int64_t * featureIndexes
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=2),
+            # int64_t countTopCombinations
+            ct.c_longlong,
+            # double * interactionScoresReturn
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # int64_t * topCombinationIndexesReturn
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
         ]
+        self.lib.GetInteractionScores.restype = ct.c_longlong
+
+        self.lib.SetInteractionThreadCount.argtypes = [
+            # void * ebmInteraction
+            ct.c_void_p,
+            # int64_t countThreads
+            ct.c_longlong,
+        ]
+        self.lib.SetInteractionThreadCount.restype = ct.c_longlong
+
+        self.lib.FreeInteraction.argtypes = [
+            # void * ebmInteraction
+            ct.c_void_p
+        ]
+
+        self.lib.ScoreBinnedInstances.argtypes = [
+            # int64_t countScores
+            ct.c_longlong,
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # double ** models
+            ct.POINTER(ct.c_void_p),
+            # double * intercept
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # int64_t countInstances
+            ct.c_longlong,
+            # EbmCoreBinnedData * binnedData
+            ct.POINTER(self.EbmCoreBinnedData),
+            # int64_t link
+            ct.c_longlong,
+            # double * scoresReturn
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS"),
+        ]
+        self.lib.ScoreBinnedInstances.restype = ct.c_longlong
+
+        self.lib.CompileModel.argtypes = [
+            # int64_t countScores
+            ct.c_longlong,
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # double ** featureCuts
+            ct.POINTER(ct.c_void_p),
+            # char *** featureCategories
+            ct.POINTER(ct.c_void_p),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # double ** models
+            ct.POINTER(ct.c_void_p),
+            # double * intercept
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+        ]
+        self.lib.CompileModel.restype = ct.c_void_p
+
+        self.lib.ScoreRawInstances.argtypes = [
+            # void * ebmModel
+            ct.c_void_p,
+            # int64_t countInstances
+            ct.c_longlong,
+            # double * values
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=2),
+            # char ** categories
+            ct.POINTER(ct.c_char_p),
+            # int64_t link
+            ct.c_longlong,
+            # double * scoresReturn
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS"),
+        ]
+        self.lib.ScoreRawInstances.restype = ct.c_longlong
+
+        self.lib.FreeModel.argtypes = [
+            # void * ebmModel
+            ct.c_void_p
+        ]
+
+        self.lib.WriteModelFile.argtypes = [
+            # void * ebmModel
+            ct.c_void_p,
+            # const char * path
+            ct.c_char_p,
+        ]
+        self.lib.WriteModelFile.restype = ct.c_longlong
+
+        self.lib.WriteTrainingModelFile.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # double ** featureCuts
+            ct.POINTER(ct.c_void_p),
+            # char *** featureCategories
+            ct.POINTER(ct.c_void_p),
+            # double * intercept
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # const char * path
+            ct.c_char_p,
+        ]
+        self.lib.WriteTrainingModelFile.restype = ct.c_longlong
+
+        self.lib.OpenModelFile.argtypes = [
+            # const char * path
+            ct.c_char_p
+        ]
+        self.lib.OpenModelFile.restype = ct.c_void_p
+
+        self.lib.QuantizeModel.argtypes = [
+            # void * ebmModel
+            ct.c_void_p,
+            # int64_t countBitsQuantized
+            ct.c_longlong,
+            # double * maxErrorsReturn
+            ct.c_void_p,
+        ]
+        self.lib.QuantizeModel.restype = ct.c_longlong
+
+        self.lib.SetModelThreadCount.argtypes = [
+            # void * ebmModel
+            ct.c_void_p,
+            # int64_t countThreads
+            ct.c_longlong,
+        ]
+        self.lib.SetModelThreadCount.restype = ct.c_longlong
+
+    def make_binned_data(self, X):
+        """ Describes a 2-D binned design matrix to the native code without copying it.
+
+        Args:
+            X: Binned design matrix as 2-D ndarray with one row per instance.
+
+        Returns:
+            A tuple of the EbmCoreBinnedData and the array it points into,
+            which needs to stay alive until the native call returns.
+        """
+        data_types = {
+            np.dtype(np.uint8): self.BinnedDataTypeUInt8,
+            np.dtype(np.uint16): self.BinnedDataTypeUInt16,
+            np.dtype(np.int32): self.BinnedDataTypeInt32,
+            np.dtype(np.int64): self.BinnedDataTypeInt64,
+        }
+        X = np.asarray(X)
+        if X.dtype not in data_types:
+            X = X.astype(np.int64)
+        itemsize = X.dtype.itemsize
+        if any(stride < 0 or stride % itemsize != 0 for stride in X.strides):
+            X = np.ascontiguousarray(X)
+
+        binned_data = self.EbmCoreBinnedData()
+        binned_data.dataType = data_types[X.dtype]
+        binned_data.strideInstance = X.strides[0] // itemsize
+        binned_data.strideFeature = X.strides[1] // itemsize
+        binned_data.data = X.ctypes.data
+        return binned_data, X
 
     def set_logging(self, level=None):
         def native_log(trace_level, message):
@@ -338,6 +906,9 @@ class NativeEBM:
         training_scores=None,
         validation_scores=None,
         random_state=1337,
+        data_set=None,
+        train_indexes=None,
+        val_indexes=None,
     ):
 
         # TODO: Update documentation for training/val scores args.
@@ -359,6 +930,10 @@ class NativeEBM:
             training_scores: Undocumented.
             validation_scores: Undocumented.
             random_state: Random seed as integer.
+            data_set: A NativeEBMDataSet to train on instead of X_train,
+                y_train, X_val and y_val, which can then be None.
+            train_indexes: Rows of data_set used for training.
+            val_indexes: Rows of data_set used for validation.
         """
         log.debug("Check if EBM lib is loaded")
         if this.native is None:
@@ -383,6 +958,15 @@ class NativeEBM:
         self.model_type = model_type
         self.num_inner_bags = num_inner_bags
         self.num_classification_states = num_classification_states
+        self.data_set = data_set
+        if self.data_set is not None:
+            self.train_indexes = np.ascontiguousarray(train_indexes, dtype=np.int64)
+            self.val_indexes = np.ascontiguousarray(val_indexes, dtype=np.int64)
+            n_train = self.train_indexes.shape[0]
+            n_val = self.val_indexes.shape[0]
+        else:
+            n_train = X_train.shape[0]
+            n_val = X_val.shape[0]
 
         # # Set train/val scores to zeros if not passed.
         # if isinstance(intercept, numbers.Number) or len(intercept) == 1:
@@ -395,28 +979,37 @@ class NativeEBM:
         if self.training_scores is None:
             if self.num_classification_states > 2:
                 self.training_scores = np.zeros(
-                    (X_train.shape[0], self.num_classification_states)
+                    (n_train, self.num_classification_states)
                 ).reshape(-1)
             else:
-                self.training_scores = np.zeros(X_train.shape[0])
+                self.training_scores = np.zeros(n_train)
         if self.validation_scores is None:
             if self.num_classification_states > 2:
                 self.validation_scores = np.zeros(
-                    (X_train.shape[0], self.num_classification_states)
+                    (n_train, self.num_classification_states)
                 ).reshape(-1)
             else:
-                self.validation_scores = np.zeros(X_train.shape[0])
+                self.validation_scores = np.zeros(n_train)
         self.random_state = random_state
 
-        # Convert n-dim arrays ready for C.
-        self.X_train_f = np.asfortranarray(self.X_train)
-        self.X_val_f = np.asfortranarray(self.X_val)
-
         # Define extra properties
         self.model_pointer = None
         self.interaction_pointer = None
 
         # Allocate external resources
+        if self.data_set is not None:
+            # The data set is already packed natively, so only the indexes go across.
+            self._initialize_training_data_set()
+            self._initialize_interaction_data_set()
+            log.info("Allocation end")
+            return
+
+        # Describe the n-dim arrays to C, which reads them in place.
+        self.X_train_binned, self.X_train_c = this.native.make_binned_data(
+            self.X_train
+        )
+        self.X_val_binned, self.X_val_c = this.native.make_binned_data(self.X_val)
+
         if self.model_type == "regression":
             self.y_train = self.y_train.astype("float64")
             self.y_val = self.y_val.astype("float64")
@@ -458,29 +1051,53 @@ class NativeEBM:
 
         return attribute_ar, attribute_sets_ar, attribute_set_indexes
 
+    def _initialize_interaction_data_set(self):
+        self.interaction_pointer = this.native.lib.InitializeInteractionFromDataSet(
+            self.data_set.data_set_pointer,
+            self.train_indexes.shape[0],
+            self.train_indexes,
+            self.training_scores,
+        )
+
+    def _initialize_training_data_set(self):
+        self.model_pointer = this.native.lib.InitializeTrainingFromDataSet(
+            self.random_state,
+            self.data_set.data_set_pointer,
+            len(self.attribute_sets_array),
+            self.attribute_sets_array,
+            self.attribute_set_indexes,
+            self.train_indexes.shape[0],
+            self.train_indexes,
+            self.training_scores,
+            self.val_indexes.shape[0],
+            self.val_indexes,
+            self.validation_scores,
+            self.num_inner_bags,
+        )
+
     def _initialize_interaction_regression(self):
-        self.interaction_pointer = this.native.lib.InitializeInteractionRegression(
+        self.interaction_pointer = this.native.lib.InitializeInteractionRegressionStrided(
             len(self.attribute_array),
             self.attribute_array,
             self.X_train.shape[0],
             self.y_train,
-            self.X_train_f,
+            ct.byref(self.X_train_binned),
             self.training_scores,
         )
 
     def _initialize_interaction_classification(self):
-        self.interaction_pointer = this.native.lib.InitializeInteractionClassification(
+        self.interaction_pointer = this.native.lib.InitializeInteractionClassificationStrided(
             len(self.attribute_array),
             self.attribute_array,
             self.num_classification_states,
             self.X_train.shape[0],
             self.y_train,
-            self.X_train_f,
+            ct.byref(self.X_train_binned),
             self.training_scores,
         )
 
     def _initialize_training_regression(self):
-        self.model_pointer = this.native.lib.InitializeTrainingRegression(
+        self.model_pointer = this.native.lib.InitializeTrainingRegressionStrided(
             self.random_state,
             len(self.attribute_array),
             self.attribute_array,
@@ -489,17 +1106,17 @@ class NativeEBM:
             self.attribute_set_indexes,
             self.X_train.shape[0],
             self.y_train,
-            self.X_train_f,
+            ct.byref(self.X_train_binned),
             self.training_scores,
             self.X_val.shape[0],
             self.y_val,
-            self.X_val_f,
+            ct.byref(self.X_val_binned),
             self.validation_scores,
             self.num_inner_bags,
         )
 
     def _initialize_training_classification(self):
-        self.model_pointer = this.native.lib.InitializeTrainingClassification(
+        self.model_pointer = this.native.lib.InitializeTrainingClassificationStrided(
             self.random_state,
             len(self.attribute_array),
             self.attribute_array,
@@ -509,11 +1126,11 @@ class NativeEBM:
             self.num_classification_states,
             self.X_train.shape[0],
             self.y_train,
-            self.X_train_f,
+            ct.byref(self.X_train_binned),
             self.training_scores,
             self.X_val.shape[0],
             self.y_val,
-            self.X_val_f,
+            ct.byref(self.X_val_binned),
             self.validation_scores,
             self.num_inner_bags,
         )
@@ -525,6 +1142,26 @@ class NativeEBM:
         this.native.lib.FreeInteraction(self.interaction_pointer)
         log.info("Deallocation end")
 
+    def write_model_file(self, path, preprocessor, intercept):
+        """ Writes the best models to a model file that
+        NativeEBMModel.from_file can map.
+
+        Args:
+            path: Path of the model file.
+            preprocessor: Fitted EBMPreprocessor whose binning the file holds.
+            intercept: Number or 1-D ndarray with one logit per class.
+        """
+        _, cut_ar, category_ar, keep_alive = _convert_binning_to_c(preprocessor)
+        return_code = this.native.lib.WriteTrainingModelFile(
+            self.model_pointer,
+            cut_ar,
+            category_ar,
+            _convert_intercept(intercept),
+            os.fsencode(path),
+        )
+        if return_code != 0:
+            raise Exception("WriteTrainingModelFile Exception")
+
     def fast_interaction_score(self, attribute_index_tuple):
         """ Provides score for an attribute interaction. Higher is better."""
         log.info("Fast interaction score start")
@@ -538,6 +1175,46 @@ class NativeEBM:
         log.info("Fast interaction score end")
         return score.value
 
+    def fast_interaction_scores(self, attribute_index_tuples, top_k=0):
+        """ Provides scores for many attribute interactions of the same size
+            in one native call that spreads them over the native threads.
+
+        Args:
+            attribute_index_tuples: List of attribute index tuples.
+            top_k: If non-zero, only the top_k highest scoring tuples are
+                returned, best first, with ties going to the earlier tuple.
+
+        Returns:
+            A list of (attribute_index_tuple, score) pairs, in the order
+            given when top_k is zero.
+        """
+        log.info("Fast interaction scores start")
+        n_combinations = len(attribute_index_tuples)
+        if n_combinations == 0:
+            return []
+        indexes = np.ascontiguousarray(attribute_index_tuples, dtype=np.int64)
+        n_returned = n_combinations if top_k == 0 else min(top_k, n_combinations)
+        scores = np.zeros(n_returned, dtype=np.float64)
+        top_indexes = np.zeros(n_returned, dtype=np.int64)
+        return_code = this.native.lib.GetInteractionScores(
+            self.interaction_pointer,
+            n_combinations,
+            indexes.shape[1],
+            indexes,
+            top_k,
+            scores,
+            top_indexes,
+        )
+        if return_code != 0:  # pragma: no cover
+            raise Exception("GetInteractionScores Exception")
+        if top_k == 0:
+            top_indexes = range(n_combinations)
+        log.info("Fast interaction scores end")
+        return [
+            (attribute_index_tuples[index], score)
+            for index, score in zip(top_indexes, scores)
+        ]
+
     def training_step(
         self,
         attribute_set_index,
@@ -595,6 +1272,66 @@ class NativeEBM:
         # log.debug("Training step end")
         return metric_output.value
 
+    def boost_cycles(
+        self,
+        attribute_set_indexes,
+        n_episodes,
+        training_step_episodes=1,
+        learning_rate=0.01,
+        max_tree_splits=2,
+        min_cases_for_split=2,
+        early_stopping_run_length=50,
+        early_stopping_tolerance=1e-5,
+    ):
+
+        """ Boosts the attribute sets round robin for up to n_episodes
+            episodes inside the native library, stopping early once the
+            validation loss stops improving.
+
+        Args:
+            attribute_set_indexes: The attribute set indexes to cycle through.
+            n_episodes: Maximum number of episodes over all attribute sets.
+            training_step_episodes: Number of episodes to train feature step.
+            learning_rate: Learning rate as a float.
+            max_tree_splits: Max tree splits on feature step.
+            min_cases_for_split: Min observations required to split.
+            early_stopping_run_length: Episodes without improvement before
+                stopping. Negative disables early stopping.
+            early_stopping_tolerance: Minimum improvement in validation loss.
+
+        Returns:
+            Validation loss after the last episode, and the number of
+            episodes run.
+        """
+        indexes = np.ascontiguousarray(attribute_set_indexes, dtype=np.int64)
+        if indexes.shape[0] == 0:
+            # ndpointer does not accept empty arrays with a null data pointer
+            indexes = np.zeros(1, dtype=np.int64)
+            n_sets = 0
+        else:
+            n_sets = indexes.shape[0]
+
+        metric_output = ct.c_double(0.0)
+        episodes_output = ct.c_longlong(0)
+        return_code = this.native.lib.BoostCycles(
+            self.model_pointer,
+            n_sets,
+            indexes,
+            n_episodes,
+            training_step_episodes,
+            learning_rate,
+            max_tree_splits,
+            min_cases_for_split,
+            early_stopping_run_length,
+            early_stopping_tolerance,
+            ct.byref(metric_output),
+            ct.byref(episodes_output),
+        )
+        if return_code != 0:  # pragma: no cover
+            raise Exception("BoostCycles Exception")
+
+        return metric_output.value, episodes_output.value
+
     def _get_attribute_set_shape(self, attribute_set_index):
         # Retrieve dimensions of log odds tensor
         dimensions = []
@@ -659,6 +1396,699 @@ class NativeEBM:
         return array.copy()
 
 
+class NativeEBMDataSet:
+    """Lightweight wrapper for a binned data set that the EBM C code packs
+    once and then shares between the NativeEBM objects built from it.
+    """
+
+    def __init__(
+        self,
+        attributes,
+        X,
+        y,
+        model_type="regression",
+        num_classification_states=2,
+    ):
+
+        """ Packs a binned data set for EBM C code.
+
+        Args:
+            attributes: List of attributes represented individually as
+                dictionary of keys ('type', 'has_missing', 'n_bins').
+            X: Binned design matrix as 2-D ndarray.
+            y: Response as 1-D ndarray.
+            model_type: 'regression'/'classification'.
+            num_classification_states: Specific to classification,
+                number of unique classes.
+        """
+        log.debug("Check if EBM lib is loaded")
+        if this.native is None:
+            log.info("EBM lib loading.")
+            this.native = Native()
+        else:
+            log.debug("EBM lib already loaded")
+
+        log.info("Allocation start")
+
+        self.attribute_array, _, _ = NativeEBM._convert_attribute_info_to_c(
+            self, attributes, []
+        )
+        self.n_instances = X.shape[0]
+
+        # C copies what it needs, so nothing here has to outlive the call.
+        X_binned, X_c = this.native.make_binned_data(X)
+        if model_type == "regression":
+            self.data_set_pointer = this.native.lib.CreateDataSetRegression(
+                len(self.attribute_array),
+                self.attribute_array,
+                self.n_instances,
+                np.ascontiguousarray(y, dtype=np.float64),
+                ct.byref(X_binned),
+            )
+        elif model_type == "classification":
+            self.data_set_pointer = this.native.lib.CreateDataSetClassification(
+                len(self.attribute_array),
+                self.attribute_array,
+                num_classification_states,
+                self.n_instances,
+                np.ascontiguousarray(y, dtype=np.int64),
+                ct.byref(X_binned),
+            )
+        if not self.data_set_pointer:  # pragma: no cover
+            raise Exception("CreateDataSet Exception")
+
+        log.info("Allocation end")
+
+    @classmethod
+    def from_file(cls, path):
+        """ Maps a data set file that write_file wrote. The binned columns
+        stay on disk and are paged in as training reads them.
+
+        Args:
+            path: Path of the data set file.
+
+        Returns:
+            A NativeEBMDataSet over the mapped file.
+        """
+        if this.native is None:
+            log.info("EBM lib loading.")
+            this.native = Native()
+
+        self = cls.__new__(cls)
+        self.data_set_pointer = this.native.lib.OpenDataSetFile(
+            os.fsencode(path)
+        )
+        if not self.data_set_pointer:
+            raise Exception("OpenDataSetFile Exception")
+        return self
+
+    def write_file(self, path, scores=None):
+        """ Writes the data set to a file that from_file can map.
+
+        Args:
+            path: Path of the data set file.
+            scores: Initial predictor scores of every instance, which
+                NativeEBM objects built without scores start from.
+        """
+        if scores is not None:
+            scores = np.ascontiguousarray(scores, dtype=np.float64)
+            scores_pointer = scores.ctypes.data_as(ct.c_void_p)
+        else:
+            scores_pointer = None
+        return_code = this.native.lib.WriteDataSetFile(
+            self.data_set_pointer, scores_pointer, os.fsencode(path)
+        )
+        if return_code != 0:
+            raise Exception("WriteDataSetFile Exception")
+
+    def close(self):
+        """ Releases our reference to the C data set. NativeEBM objects
+        built from it keep what they still need. """
+        log.info("Deallocation start")
+        this.native.lib.FreeDataSet(self.data_set_pointer)
+        log.info("Deallocation end")
+
+
+class NativeEBMEnsemble:
+    """Lightweight wrapper for the EBM C code that trains every outer bag
+    inside one native object over a single copy of the binned data.
+    """
+
+    def __init__(
+        self,
+        attributes,
+        attribute_sets,
+        X,
+        y,
+        validation_masks,
+        model_type="regression",
+        num_inner_bags=0,
+        num_classification_states=2,
+        random_states=None,
+        n_threads=1,
+    ):
+
+        """ Initializes internal wrapper for the ensemble EBM C code.
+
+        Args:
+            attributes: List of attributes represented individually as
+                dictionary of keys ('type', 'has_missing', 'n_bins').
+            attribute_sets: List of attribute sets represented as
+                a dictionary of keys ('n_attributes', 'attributes')
+            X: Design matrix shared by every bag as 2-D ndarray.
+            y: Response as 1-D ndarray.
+            validation_masks: 2-D ndarray with one row per bag. Non-zero
+                entries are held out of that bag's training and used for
+                its early stopping.
+            model_type: 'regression'/'classification'.
+            num_inner_bags: Per feature training step, number of inner bags.
+            num_classification_states: Specific to classification,
+                number of unique classes.
+            random_states: Random seed per bag as a list of integers.
+            n_threads: Number of threads to train the bags on, including the
+                calling thread. Zero uses every hardware thread.
+        """
+        log.debug("Check if EBM lib is loaded")
+        if this.native is None:
+            log.info("EBM lib loading.")
+            this.native = Native()
+        else:
+            log.debug("EBM lib already loaded")
+
+        log.info("Allocation start")
+
+        self.attributes = attributes
+        self.attribute_sets = attribute_sets
+        self.attribute_array, self.attribute_sets_array, self.attribute_set_indexes = NativeEBM._convert_attribute_info_to_c(
+            self, attributes, attribute_sets
+        )
+        self.model_type = model_type
+        self.num_inner_bags = num_inner_bags
+        self.num_classification_states = num_classification_states
+
+        self.validation_masks = np.ascontiguousarray(validation_masks, dtype=np.int64)
+        self.n_bags = self.validation_masks.shape[0]
+        if random_states is None:
+            random_states = [1337] * self.n_bags
+        self.random_states = np.ascontiguousarray(random_states, dtype=np.int64)
+
+        if self.num_classification_states > 2:
+            self.scores = np.zeros(X.shape[0] * self.num_classification_states)
+        else:
+            self.scores = np.zeros(X.shape[0])
+
+        self.X_f = np.asfortranarray(X)
+
+        if self.model_type == "regression":
+            self.y = y.astype("float64")
+            self.model_pointer = this.native.lib.InitializeEnsembleTrainingRegression(
+                self.n_bags,
+                self.random_states,
+                len(self.attribute_array),
+                self.attribute_array,
+                len(self.attribute_sets_array),
+                self.attribute_sets_array,
+                self.attribute_set_indexes,
+                X.shape[0],
+                self.y,
+                self.X_f,
+                self.scores,
+                self.validation_masks,
+                self.num_inner_bags,
+            )
+        elif self.model_type == "classification":
+            self.y = y.astype("int64")
+            self.model_pointer = this.native.lib.InitializeEnsembleTrainingClassification(
+                self.n_bags,
+                self.random_states,
+                len(self.attribute_array),
+                self.attribute_array,
+                len(self.attribute_sets_array),
+                self.attribute_sets_array,
+                self.attribute_set_indexes,
+                self.num_classification_states,
+                X.shape[0],
+                self.y,
+                self.X_f,
+                self.scores,
+                self.validation_masks,
+                self.num_inner_bags,
+            )
+        if not self.model_pointer:  # pragma: no cover
+            raise Exception("InitializeEnsembleTraining Exception")
+
+        if n_threads != 1:
+            return_code = this.native.lib.SetEnsembleTrainingThreadCount(
+                self.model_pointer, n_threads
+            )
+            if return_code != 0:  # pragma: no cover
+                raise Exception("SetEnsembleTrainingThreadCount Exception")
+
+        log.info("Allocation end")
+
+    def close(self):
+        """ Deallocates C objects used to train the EBM ensemble. """
+        log.info("Deallocation start")
+        this.native.lib.FreeEnsembleTraining(self.model_pointer)
+        log.info("Deallocation end")
+
+    def boost_cycles(
+        self,
+        attribute_set_indexes,
+        n_episodes,
+        training_step_episodes=1,
+        learning_rate=0.01,
+        max_tree_splits=2,
+        min_cases_for_split=2,
+        early_stopping_run_length=50,
+        early_stopping_tolerance=1e-5,
+    ):
+
+        """ Boosts every bag as NativeEBM.boost_cycles does, with the bags
+            trained in parallel natively.
+
+        Returns:
+            Validation loss per bag after its last episode, and the number
+            of episodes run per bag.
+        """
+        indexes = np.ascontiguousarray(attribute_set_indexes, dtype=np.int64)
+        if indexes.shape[0] == 0:
+            # ndpointer does not accept empty arrays with a null data pointer
+            indexes = np.zeros(1, dtype=np.int64)
+            n_sets = 0
+        else:
+            n_sets = indexes.shape[0]
+
+        metrics_output = np.zeros(self.n_bags, dtype=np.float64)
+        episodes_output = np.zeros(self.n_bags, dtype=np.int64)
+        return_code = this.native.lib.BoostEnsembleCycles(
+            self.model_pointer,
+            n_sets,
+            indexes,
+            n_episodes,
+            training_step_episodes,
+            learning_rate,
+            max_tree_splits,
+            min_cases_for_split,
+            early_stopping_run_length,
+            early_stopping_tolerance,
+            metrics_output,
+            episodes_output,
+        )
+        if return_code != 0:  # pragma: no cover
+            raise Exception("BoostEnsembleCycles Exception")
+
+        return metrics_output, episodes_output
+
+    def get_averaged_model(self, attribute_set_index):
+        """ Returns the average of the bags' best models for a given
+            attribute set, and the standard deviation between them.
+
+        Args:
+            attribute_set_index: The index for the attribute set.
+
+        Returns:
+            An ndarray that represents the averaged model, and an ndarray
+            of the same shape with the standard deviations.
+        """
+        shape = NativeEBM._get_attribute_set_shape(self, attribute_set_index)
+        averaged_model = np.zeros(shape, dtype=np.float64)
+        model_errors = np.zeros(shape, dtype=np.float64)
+        return_code = this.native.lib.GetEnsembleModelFeatureCombination(
+            self.model_pointer, attribute_set_index, averaged_model, model_errors
+        )
+        if return_code != 0:  # pragma: no cover
+            raise Exception("GetEnsembleModelFeatureCombination Exception")
+        return averaged_model, model_errors
+
+
+def _convert_intercept(intercept):
+    if isinstance(intercept, numbers.Number) or len(intercept) == 1:
+        return np.full(1, intercept, dtype=np.float64).reshape(-1)
+    return np.ascontiguousarray(intercept, dtype=np.float64)
+
+
+def _convert_binning_to_c(preprocessor):
+    """ Describes the binning of a fitted EBMPreprocessor to the EBM C code.
+
+    Args:
+        preprocessor: Fitted EBMPreprocessor.
+
+    Returns:
+        A tuple of the attributes, the cut and category arrays, and the
+        buffers they point into, which need to stay alive until the native
+        call returns.
+    """
+    # C puts missing and unknown categories into bin 0.
+    if preprocessor.missing_constant != 0 or preprocessor.unknown_constant != 0:
+        raise ValueError(
+            "Native models need missing_constant and unknown_constant to be 0."
+        )
+
+    col_types = preprocessor.col_types_
+    attributes = []
+    keep_alive = []
+    cut_ar = (ct.c_void_p * max(len(col_types), 1))()
+    category_ar = (ct.c_void_p * max(len(col_types), 1))()
+    for col_idx, col_type in enumerate(col_types):
+        n_bins = int(preprocessor.col_n_bins_[col_idx])
+        if col_type == "continuous":
+            # np.digitize against every edge and then shifting down by one
+            # gives the same bins as the count of the later edges.
+            cuts = np.ascontiguousarray(
+                preprocessor.col_bin_edges_[col_idx][1:], dtype=np.float64
+            )
+            keep_alive.append(cuts)
+            cut_ar[col_idx] = cuts.ctypes.data
+            attributes.append(
+                {"type": "continuous", "has_missing": False, "n_bins": n_bins}
+            )
+        else:
+            names = [None] * n_bins
+            for val, idx in preprocessor.col_mapping_[col_idx].items():
+                # transform adds NaN to the mapping for missing values.
+                if isinstance(val, float) and np.isnan(val):
+                    continue
+                if not isinstance(val, str):
+                    raise ValueError("Native models only support string categories.")
+                names[idx] = val.encode("utf-8")
+            if any(name is None for name in names):
+                raise ValueError("Every bin needs a category.")
+            names_ar = (ct.c_char_p * max(n_bins, 1))(*names)
+            keep_alive.append(names_ar)
+            category_ar[col_idx] = ct.cast(names_ar, ct.c_void_p)
+            attributes.append(
+                {"type": "categorical", "has_missing": False, "n_bins": n_bins}
+            )
+    return attributes, cut_ar, category_ar, keep_alive
+
+
+class NativeEBMModel:
+    """Lightweight wrapper for a compiled EBM that the EBM C code scores
+    from raw feature values, which it bins the way
+    EBMPreprocessor.transform does.
+    """
+
+    def __init__(self, preprocessor, attribute_sets, attribute_set_models, intercept):
+        """ Compiles a model for EBM C code, which keeps its own copy of
+        the binning and the models.
+
+        Args:
+            preprocessor: Fitted EBMPreprocessor whose binning the model uses.
+            attribute_sets: List of attribute sets represented as
+                a dictionary of keys ('n_attributes', 'attributes')
+            attribute_set_models: Model tensor per attribute set.
+            intercept: Number or 1-D ndarray with one logit per class.
+        """
+        if this.native is None:
+            log.info("EBM lib loading.")
+            this.native = Native()
+
+        intercept = _convert_intercept(intercept)
+        self.n_scores = intercept.shape[0]
+        self.n_terms = len(attribute_sets)
+
+        log.info("Allocation start")
+
+        # C copies everything, so these only have to outlive CompileModel.
+        attributes, cut_ar, category_ar, keep_alive = _convert_binning_to_c(
+            preprocessor
+        )
+        model_ar = (ct.c_void_p * max(len(attribute_sets), 1))()
+        for set_idx, attribute_set in enumerate(attribute_sets):
+            tensor = np.ascontiguousarray(
+                attribute_set_models[set_idx], dtype=np.float64
+            )
+            shape = tensor.shape[:-1] if self.n_scores > 1 else tensor.shape
+            expected = tuple(
+                attributes[attr_idx]["n_bins"]
+                for attr_idx in reversed(attribute_set["attributes"])
+            )
+            if shape != expected:
+                raise ValueError(
+                    "Model tensor {0} does not match its bins.".format(set_idx)
+                )
+            keep_alive.append(tensor)
+            model_ar[set_idx] = tensor.ctypes.data
+
+        attribute_ar, attribute_sets_ar, attribute_set_indexes = NativeEBM._convert_attribute_info_to_c(
+            self, attributes, attribute_sets
+        )
+        self.model_pointer = this.native.lib.CompileModel(
+            self.n_scores,
+            len(attribute_ar),
+            attribute_ar,
+            cut_ar,
+            category_ar,
+            len(attribute_sets_ar),
+            attribute_sets_ar,
+            np.ascontiguousarray(attribute_set_indexes, dtype=np.int64),
+            model_ar,
+            intercept,
+        )
+        if not self.model_pointer:  # pragma: no cover
+            raise Exception("CompileModel Exception")
+
+        log.info("Allocation end")
+
+    @classmethod
+    def from_file(cls, path, n_scores):
+        """ Maps a model file. The tensors stay on disk and are paged in as
+        scoring reads them, and every process that maps the same file
+        shares them.
+
+        Args:
+            path: Path of the model file.
+            n_scores: Number of logits per instance, which is 1 for
+                regression and binary classification.
+
+        Returns:
+            A NativeEBMModel over the mapped file.
+        """
+        if this.native is None:
+            log.info("EBM lib loading.")
+            this.native = Native()
+
+        self = cls.__new__(cls)
+        self.n_scores = n_scores
+        # the file doesn't tell us how many terms it has
+        self.n_terms = None
+        self.model_pointer = this.native.lib.OpenModelFile(os.fsencode(path))
+        if not self.model_pointer:
+            raise Exception("OpenModelFile Exception")
+        return self
+
+    def write_file(self, path):
+        """ Writes the model to a file that from_file can map.
+
+        Args:
+            path: Path of the model file.
+        """
+        return_code = this.native.lib.WriteModelFile(
+            self.model_pointer, os.fsencode(path)
+        )
+        if return_code != 0:
+            raise Exception("WriteModelFile Exception")
+
+    def quantize(self, n_bits):
+        """ Replaces the model tensors with 8 or 16 bit integers, each
+        attribute set with its own scale and offset. A model can only be
+        quantized once, and write_file writes the quantized tensors.
+
+        Args:
+            n_bits: 8 or 16.
+
+        Returns:
+            An ndarray with the largest error of each attribute set, or None
+            for a model from from_file, which doesn't know its attribute sets.
+        """
+        max_errors = None
+        max_errors_pointer = None
+        if self.n_terms is not None:
+            max_errors = np.zeros(max(self.n_terms, 1), dtype=np.float64)
+            max_errors_pointer = max_errors.ctypes.data
+        return_code = this.native.lib.QuantizeModel(
+            self.model_pointer, n_bits, max_errors_pointer
+        )
+        if return_code != 0:
+            raise Exception("QuantizeModel Exception")
+        return None if max_errors is None else max_errors[: self.n_terms]
+
+    def set_thread_count(self, n_threads):
+        """ Sets how many threads score the chunks of a large batch. A model
+        scores on the calling thread until this is called.
+
+        Args:
+            n_threads: Threads including the calling thread, or 0 for one
+                per hardware thread.
+        """
+        return_code = this.native.lib.SetModelThreadCount(
+            self.model_pointer, n_threads
+        )
+        if return_code != 0:
+            raise Exception("SetModelThreadCount Exception")
+
+    def score(self, X, link="identity"):
+        """ Bins and scores raw instances.
+
+        Args:
+            X: Raw design matrix as 2-D ndarray, in the column order of the
+                preprocessor. Categories that are not strings score as missing.
+            link: 'identity' for logits, 'sigmoid' or 'softmax'.
+
+        Returns:
+            An ndarray of scores in the layout of score_binned.
+        """
+        X = np.asarray(X)
+        n_instances, n_cols = X.shape
+        # C reads values for continuous columns and categories for the rest,
+        # so we pass each cell both ways when it can be read both ways.
+        values = np.full((n_instances, n_cols), np.nan, dtype=np.float64)
+        categories = (ct.c_char_p * max(n_instances * n_cols, 1))()
+        for col_idx in range(n_cols):
+            try:
+                values[:, col_idx] = X[:, col_idx].astype(float)
+            except (TypeError, ValueError):
+                pass
+        if X.dtype.kind in "OSU":
+            for row_idx in range(n_instances):
+                for col_idx in range(n_cols):
+                    val = X[row_idx, col_idx]
+                    if isinstance(val, str):
+                        categories[row_idx * n_cols + col_idx] = val.encode("utf-8")
+
+        links = {
+            "identity": this.native.ScoreLinkIdentity,
+            "sigmoid": this.native.ScoreLinkSigmoid,
+            "softmax": this.native.ScoreLinkSoftmax,
+        }
+        if link == "softmax":
+            n_outputs = max(self.n_scores, 2)
+        else:
+            n_outputs = self.n_scores
+        if n_outputs == 1:
+            scores = np.empty(n_instances, dtype=np.float64)
+        else:
+            scores = np.empty((n_instances, n_outputs), dtype=np.float64)
+
+        return_code = this.native.lib.ScoreRawInstances(
+            self.model_pointer, n_instances, values, categories, links[link], scores
+        )
+        if return_code != 0:  # pragma: no cover
+            raise Exception("ScoreRawInstances Exception")
+        return scores
+
+    def close(self):
+        """ Deallocates C objects used to score. """
+        log.info("Deallocation start")
+        this.native.lib.FreeModel(self.model_pointer)
+        log.info("Deallocation end")
+
+
+def score_binned(
+    X,
+    attribute_sets,
+    attribute_set_models,
+    intercept,
+    skip_attr_set_idxs=[],
+    link="identity",
+):
+    """ Scores a binned design matrix with the EBM C code, which adds the
+    intercept and every attribute set model for a block of rows at a time
+    instead of building an index per attribute set over the whole matrix.
+
+    Args:
+        X: Binned design matrix as 2-D ndarray.
+        attribute_sets: List of attribute sets represented as
+            a dictionary of keys ('n_attributes', 'attributes')
+        attribute_set_models: Model tensor per attribute set.
+        intercept: Number or 1-D ndarray with one logit per class.
+        skip_attr_set_idxs: Attribute sets to leave out of the scores.
+        link: 'identity' for logits, 'sigmoid' or 'softmax'.
+
+    Returns:
+        An ndarray of scores, or None if X is not binned data that the
+        native code can read, in which case the caller scores in Python.
+    """
+    if isinstance(intercept, numbers.Number) or len(intercept) == 1:
+        intercept = np.full(1, intercept, dtype=np.float64).reshape(-1)
+    else:
+        intercept = np.ascontiguousarray(intercept, dtype=np.float64)
+    n_scores = intercept.shape[0]
+
+    X = np.asarray(X)
+    if X.ndim != 2:
+        return None
+    if X.dtype.kind not in "iu":
+        try:
+            X_int = X.astype(np.int64)
+        except (TypeError, ValueError, OverflowError):
+            return None
+        if not np.array_equal(X_int, X):
+            return None
+        X = X_int
+
+    # The bin counts come from the tensor shapes, which list the attributes
+    # of a set in reverse with the classes last for multiclass.
+    n_bins = np.ones(X.shape[1], dtype=np.int64)
+    models = []
+    for set_idx, attribute_set in enumerate(attribute_sets):
+        if set_idx in skip_attr_set_idxs:
+            models.append(None)
+            continue
+        tensor = np.ascontiguousarray(attribute_set_models[set_idx], dtype=np.float64)
+        shape = tensor.shape[:-1] if n_scores > 1 else tensor.shape
+        attr_idxs = attribute_set["attributes"]
+        if len(shape) != len(attr_idxs):
+            return None
+        for attr_idx, bins in zip(attr_idxs, reversed(shape)):
+            if n_bins[attr_idx] != 1 and n_bins[attr_idx] != bins:
+                return None
+            n_bins[attr_idx] = bins
+        models.append(tensor)
+
+    # Python indexing would wrap or raise on bins that are out of range,
+    # so we leave those to it.
+    if X.shape[0] != 0:
+        for attr_idx in np.nonzero(n_bins != 1)[0]:
+            col = X[:, attr_idx]
+            if col.min() < 0 or n_bins[attr_idx] <= col.max():
+                return None
+
+    try:
+        if this.native is None:
+            log.info("EBM lib loading.")
+            this.native = Native()
+    except Exception as e:  # pragma: no cover
+        log.debug("EBM lib not available for scoring: {0}".format(e))
+        return None
+
+    attributes = [
+        {"type": "continuous", "has_missing": False, "n_bins": int(bins)}
+        for bins in n_bins
+    ]
+    attribute_ar, attribute_sets_ar, attribute_set_indexes = NativeEBM._convert_attribute_info_to_c(
+        None, attributes, attribute_sets
+    )
+    attribute_set_indexes = np.ascontiguousarray(attribute_set_indexes, dtype=np.int64)
+    model_ar = (ct.c_void_p * max(len(models), 1))()
+    for set_idx, tensor in enumerate(models):
+        model_ar[set_idx] = None if tensor is None else tensor.ctypes.data
+
+    links = {
+        "identity": this.native.ScoreLinkIdentity,
+        "sigmoid": this.native.ScoreLinkSigmoid,
+        "softmax": this.native.ScoreLinkSoftmax,
+    }
+    if link == "softmax":
+        n_outputs = max(n_scores, 2)
+    else:
+        n_outputs = n_scores
+    if n_outputs == 1:
+        scores = np.empty(X.shape[0], dtype=np.float64)
+    else:
+        scores = np.empty((X.shape[0], n_outputs), dtype=np.float64)
+
+    X_binned, X_c = this.native.make_binned_data(X)
+    return_code = this.native.lib.ScoreBinnedInstances(
+        n_scores,
+        len(attribute_ar),
+        attribute_ar,
+        len(attribute_sets_ar),
+        attribute_sets_ar,
+        attribute_set_indexes,
+        model_ar,
+        intercept,
+        X.shape[0],
+        ct.byref(X_binned),
+        links[link],
+        scores,
+    )
+    if return_code != 0:  # pragma: no cover
+        raise Exception("ScoreBinnedInstances Exception")
+    return scores
+
+
 def make_nd_array(c_pointer, shape, dtype=np.float64, order="C", own_data=True):
     """ Returns an ndarray based from a C array.
 
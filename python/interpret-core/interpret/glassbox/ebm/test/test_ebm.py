@@ -99,6 +99,66 @@ def test_prefit_ebm():
         assert not has_non_zero
 
 
+@pytest.mark.parametrize("holdout_split", [0, 0.15])
+def test_ebm_holdout_split_with_interactions(holdout_split):
+    for ebm_class, data in [
+        (ExplainableBoostingClassifier, synthetic_classification()),
+        (ExplainableBoostingRegressor, synthetic_regression()),
+    ]:
+        X = data["full"]["X"]
+        y = data["full"]["y"]
+
+        ebm = ebm_class(
+            n_jobs=1,
+            n_estimators=2,
+            interactions=2,
+            holdout_split=holdout_split,
+            data_n_episodes=50,
+        )
+        ebm.fit(X, y)
+
+        assert len(ebm.inter_indices_) == 2
+        assert len(ebm.attribute_set_models_) == X.shape[1] + 2
+        assert np.all(np.isfinite(ebm.predict(X)))
+        valid_ebm(ebm)
+
+
+@pytest.mark.parametrize("n_inner_bags", [0, 2])
+def test_ebm_main_ensemble_matches_base_estimators(n_inner_bags):
+    # interactions=0 trains the bags together natively, while an empty list of
+    # pairs takes the path that fits one base estimator per bag.
+    for ebm_class, data in [
+        (ExplainableBoostingClassifier, synthetic_classification()),
+        (ExplainableBoostingRegressor, synthetic_regression()),
+    ]:
+        X = data["full"]["X"]
+        y = data["full"]["y"]
+
+        ebms = []
+        for interactions in [0, []]:
+            ebm = ebm_class(
+                n_jobs=1,
+                n_estimators=3,
+                interactions=interactions,
+                data_n_episodes=100,
+                early_stopping_run_length=10,
+                feature_step_n_inner_bags=n_inner_bags,
+                random_state=5,
+            )
+            ebm.fit(X, y)
+            ebms.append(ebm)
+        ensemble, estimators = ebms
+
+        assert ensemble.main_episode_idxs_ == estimators.main_episode_idxs_
+        assert ensemble.inter_episode_idxs_ == estimators.inter_episode_idxs_
+        for model, expected in zip(
+            ensemble.attribute_set_models_, estimators.attribute_set_models_
+        ):
+            assert np.allclose(model, expected, rtol=0, atol=1e-12)
+        for errors, expected in zip(ensemble.model_errors_, estimators.model_errors_):
+            assert np.allclose(errors, expected, rtol=0, atol=1e-12)
+
+
 @pytest.mark.slow
 def test_ebm_synthetic_regression():
     data = synthetic_regression()
@@ -0,0 +1,270 @@
+# Copyright (c) 2019 Microsoft Corporation
+# Distributed under the MIT software license
+
+from ..internal import NativeEBM, NativeEBMModel, score_binned
+from ..utils import EBMUtils
+from ..ebm import ExplainableBoostingClassifier, ExplainableBoostingRegressor
+
+from contextlib import closing
+import numpy as np
+import pandas as pd
+import pytest
+
+
+def _binned_data(n_bins, model_type, n_instances=200, seed=0):
+    random_state = np.random.RandomState(seed)
+    X = np.column_stack(
+        [random_state.randint(bins, size=n_instances) for bins in n_bins]
+    ).astype(np.int64)
+    if model_type == "classification":
+        y = X[:, 0] + random_state.randint(2, size=n_instances) > n_bins[0] // 2
+        y = y.astype(np.int64)
+    else:
+        y = X[:, 0] - 0.5 * X[:, 1] + random_state.randn(n_instances)
+    attributes = EBMUtils.gen_attributes(["continuous"] * len(n_bins), n_bins)
+    return X, y, attributes
+
+
+def _native_ebm(X, y, attributes, attribute_sets, model_type):
+    n_train = X.shape[0] * 3 // 4
+    return NativeEBM(
+        attributes,
+        attribute_sets,
+        X[:n_train],
+        y[:n_train],
+        X[n_train:],
+        y[n_train:],
+        model_type=model_type,
+    )
+
+
+@pytest.mark.parametrize("model_type", ["classification", "regression"])
+def test_boost_cycles_matches_training_steps(model_type):
+    X, y, attributes = _binned_data([4, 5, 3], model_type)
+    attribute_sets = EBMUtils.gen_attribute_sets([[0], [1], [2], [0, 1]])
+    set_indexes = list(range(len(attribute_sets)))
+
+    with closing(
+        _native_ebm(X, y, attributes, attribute_sets, model_type)
+    ) as native_ebm, closing(
+        _native_ebm(X, y, attributes, attribute_sets, model_type)
+    ) as expected_ebm:
+        metric, n_episodes = native_ebm.boost_cycles(
+            set_indexes, 20, early_stopping_run_length=-1
+        )
+        for _ in range(20):
+            for index in set_indexes:
+                expected_metric = expected_ebm.training_step(index)
+
+        assert n_episodes == 20
+        assert metric == expected_metric
+        for index in set_indexes:
+            assert np.array_equal(
+                native_ebm.get_current_model(index),
+                expected_ebm.get_current_model(index),
+            )
+
+        # without sets to boost there is no metric, like the Python loop that
+        # started from an infinite metric
+        metric, n_episodes = native_ebm.boost_cycles([], 5)
+        assert n_episodes == 5
+        assert metric == np.inf
+
+
+def test_boost_cycles_stops_early():
+    X, y, attributes = _binned_data([4, 5, 3], "regression")
+    attribute_sets = EBMUtils.gen_attribute_sets([[0], [1], [2]])
+
+    with closing(
+        _native_ebm(X, y, attributes, attribute_sets, "regression")
+    ) as native_ebm:
+        metric, n_episodes = native_ebm.boost_cycles(
+            [0, 1, 2],
+            10000,
+            learning_rate=0.5,
+            early_stopping_run_length=3,
+            early_stopping_tolerance=1e-3,
+        )
+    assert 0 < n_episodes < 10000
+    assert np.isfinite(metric)
+
+
+def test_fast_interaction_scores_match_single_scores():
+    X, y, attributes = _binned_data([4, 5, 3, 6], "classification")
+    attribute_sets = EBMUtils.gen_attribute_sets([[0], [1], [2], [3]])
+    pairs = [(0, 1), (0, 2), (0, 3), (1, 2), (1, 3), (2, 3)]
+
+    with closing(
+        _native_ebm(X, y, attributes, attribute_sets, "classification")
+    ) as native_ebm:
+        expected = [(pair, native_ebm.fast_interaction_score(pair)) for pair in pairs]
+        scores = native_ebm.fast_interaction_scores(pairs)
+        top = native_ebm.fast_interaction_scores(pairs, top_k=3)
+        assert native_ebm.fast_interaction_scores([]) == []
+
+    assert scores == expected
+    ranked = sorted(expected, key=lambda x: x[1], reverse=True)
+    assert top == ranked[:3]
+
+
+def _score_in_python(X, attribute_sets, attribute_set_models, intercept):
+    scores = np.full(X.shape[0], intercept, dtype=np.float64)
+    for attribute_set, model in zip(attribute_sets, attribute_set_models):
+        # tensors list the attributes of a set in reverse
+        index = tuple(
+            X[:, attr_idx] for attr_idx in reversed(attribute_set["attributes"])
+        )
+        scores += model[index]
+    return scores
+
+
+def test_score_binned_matches_python():
+    n_bins = [4, 5, 3]
+    X, _, _ = _binned_data(n_bins, "regression", n_instances=1000)
+    attribute_sets = EBMUtils.gen_attribute_sets([[0], [1], [2], [0, 2]])
+    random_state = np.random.RandomState(1)
+    attribute_set_models = [
+        random_state.randn(n_bins[0]),
+        random_state.randn(n_bins[1]),
+        random_state.randn(n_bins[2]),
+        random_state.randn(n_bins[2], n_bins[0]),
+    ]
+    intercept = 0.25
+
+    expected = _score_in_python(X, attribute_sets, attribute_set_models, intercept)
+    scores = score_binned(X, attribute_sets, attribute_set_models, intercept)
+    assert np.allclose(scores, expected, rtol=0, atol=1e-12)
+
+    probabilities = score_binned(
+        X, attribute_sets, attribute_set_models, intercept, link="sigmoid"
+    )
+    assert np.allclose(probabilities, 1 / (1 + np.exp(-expected)), rtol=0, atol=1e-12)
+
+    skipped = score_binned(
+        X, attribute_sets, attribute_set_models, intercept, skip_attr_set_idxs=[3]
+    )
+    expected_skipped = _score_in_python(
+        X, attribute_sets[:3], attribute_set_models[:3], intercept
+    )
+    assert np.allclose(skipped, expected_skipped, rtol=0, atol=1e-12)
+
+    # bins past the tensors and values that aren't bins are left to Python
+    X_out_of_range = X.copy()
+    X_out_of_range[0, 1] = n_bins[1]
+    assert score_binned(X_out_of_range, attribute_sets, attribute_set_models, 0) is None
+    assert score_binned(X + 0.5, attribute_sets, attribute_set_models, 0) is None
+
+
+def _fit_ebm(ebm_class, interactions=1):
+    random_state = np.random.RandomState(2)
+    n_instances = 300
+    X = pd.DataFrame(
+        {
+            "a": random_state.randn(n_instances),
+            "b": random_state.randn(n_instances),
+            "c": random_state.choice(["x", "y", "z"], size=n_instances),
+        }
+    )
+    y = X["a"] + (X["c"] == "y") + 0.5 * random_state.randn(n_instances)
+    if ebm_class is ExplainableBoostingClassifier:
+        y = (y > 0.5).astype(np.int64)
+    ebm = ebm_class(
+        n_jobs=1, n_estimators=2, interactions=interactions, data_n_episodes=50
+    )
+    ebm.fit(X, y)
+    return ebm, X
+
+
+def _native_model(ebm):
+    return NativeEBMModel(
+        ebm.preprocessor_,
+        ebm.attribute_sets_,
+        ebm.attribute_set_models_,
+        ebm.intercept_,
+    )
+
+
+def test_native_model_scores_raw_instances():
+    ebm, X = _fit_ebm(ExplainableBoostingClassifier)
+    with closing(_native_model(ebm)) as model:
+        probabilities = model.score(X.values, link="sigmoid")
+    assert np.allclose(probabilities, ebm.predict_proba(X)[:, 1], rtol=0, atol=1e-12)
+
+    ebm, X = _fit_ebm(ExplainableBoostingRegressor)
+    with closing(_native_model(ebm)) as model:
+        predictions = model.score(X.values)
+    assert np.allclose(predictions, ebm.predict(X), rtol=0, atol=1e-12)
+
+
+def test_native_model_file_round_trip(tmp_path):
+    ebm, X = _fit_ebm(ExplainableBoostingClassifier)
+    path = str(tmp_path / "model.ebm")
+    with closing(_native_model(ebm)) as model:
+        expected = model.score(X.values)
+        model.write_file(path)
+    with closing(NativeEBMModel.from_file(path, 1)) as model:
+        assert np.array_equal(model.score(X.values), expected)
+
+    with pytest.raises(Exception):
+        NativeEBMModel.from_file(str(tmp_path / "missing.ebm"), 1)
+
+
+def test_native_ebm_writes_model_file(tmp_path):
+    X, y, attributes = _binned_data([4, 5, 3], "regression")
+    attribute_sets = EBMUtils.gen_attribute_sets([[0], [1], [2]])
+    # a preprocessor of three continuous columns whose cuts give the bins above
+    ebm = ExplainableBoostingRegressor(n_jobs=1, n_estimators=1, data_n_episodes=1)
+    ebm.fit(pd.DataFrame(X.astype(np.float64), columns=["a", "b", "c"]), y)
+    preprocessor = ebm.preprocessor_
+    X_binned = preprocessor.transform(X.astype(np.float64))
+    attributes = EBMUtils.gen_attributes(
+        preprocessor.col_types_, preprocessor.col_n_bins_
+    )
+
+    path = str(tmp_path / "trained.ebm")
+    with closing(
+        _native_ebm(X_binned, y, attributes, attribute_sets, "regression")
+    ) as native_ebm:
+        native_ebm.boost_cycles([0, 1, 2], 10, early_stopping_run_length=-1)
+        native_ebm.write_model_file(path, preprocessor, 0.5)
+        models = [native_ebm.get_best_model(index) for index in range(3)]
+
+    expected = _score_in_python(X_binned, attribute_sets, models, 0.5)
+    with closing(NativeEBMModel.from_file(path, 1)) as model:
+        assert np.allclose(
+            model.score(X.astype(np.float64)), expected, rtol=0, atol=1e-12
+        )
+
+
+@pytest.mark.parametrize("n_bits", [8, 16])
+def test_native_model_quantize(n_bits, tmp_path):
+    ebm, X = _fit_ebm(ExplainableBoostingRegressor)
+    path = str(tmp_path / "quantized.ebm")
+    with closing(_native_model(ebm)) as model:
+        expected = model.score(X.values)
+        max_errors = model.quantize(n_bits)
+        scores = model.score(X.values)
+        model.write_file(path)
+        with pytest.raises(Exception):
+            model.quantize(n_bits)
+
+    assert max_errors.shape == (len(ebm.attribute_sets_),)
+    assert np.all(0 <= max_errors)
+    assert np.all(np.abs(scores - expected) <= np.sum(max_errors) + 1e-12)
+    with closing(NativeEBMModel.from_file(path, 1)) as model:
+        assert np.array_equal(model.score(X.values), scores)
+        with pytest.raises(Exception):
+            model.quantize(n_bits)
+
+
+def test_native_model_scores_on_threads():
+    ebm, X = _fit_ebm(ExplainableBoostingClassifier)
+    X_large = pd.concat([X] * 40, ignore_index=True).values
+    with closing(_native_model(ebm)) as model:
+        expected = model.score(X_large)
+        model.set_thread_count(3)
+        assert np.array_equal(model.score(X_large), expected)
+        model.set_thread_count(0)
+        assert np.array_equal(model.score(X_large), expected)
+        with pytest.raises(Exception):
+            model.set_thread_count(-1)
@@ -8,6 +8,8 @@ from sklearn.utils.extmath import softmax
 import numbers
 import numpy as np
 
+from .internal import score_binned
+
 
 import logging
 
@@ -69,19 +71,25 @@ class EBMUtils:
         if X.ndim == 1:
             X = X.reshape(1, X.shape[0])
 
-        # Initialize empty vector for predictions
-        if isinstance(intercept, numbers.Number) or len(intercept) == 1:
-            score_vector = np.zeros(X.shape[0])
-        else:
-            score_vector = np.zeros((X.shape[0], len(intercept)))
+        # The native scorer adds the same terms in the same order, so it
+        # gives the same scores as the loop below when it can read X.
+        score_vector = score_binned(
+            X, attribute_sets, attribute_set_models, intercept, skip_attr_set_idxs
+        )
+        if score_vector is None:
+            # Initialize empty vector for predictions
+            if isinstance(intercept, numbers.Number) or len(intercept) == 1:
+                score_vector = np.zeros(X.shape[0])
+            else:
+                score_vector = np.zeros((X.shape[0], len(intercept)))
 
-        score_vector += intercept
+            score_vector += intercept
 
-        scores_gen = EBMUtils.scores_by_attrib_set(
-            X, attribute_sets, attribute_set_models, skip_attr_set_idxs
-        )
-        for _, _, scores in scores_gen:
-            score_vector += scores
+            scores_gen = EBMUtils.scores_by_attrib_set(
+                X, attribute_sets, attribute_set_models, skip_attr_set_idxs
+            )
+            for _, _, scores in scores_gen:
+                score_vector += scores
 
         if not np.all(np.isfinite(score_vector)):  # pragma: no cover
             msg = "Non-finite values present in log odds vector."
@@ -118,6 +126,24 @@ class EBMUtils:
 
     @staticmethod
     def classifier_predict_proba(X, estimator, skip_attr_set_idxs=[]):
+        if X.ndim == 1:
+            X = X.reshape(1, X.shape[0])
+
+        prob = score_binned(
+            X,
+            estimator.attribute_sets_,
+            estimator.attribute_set_models_,
+            estimator.intercept_,
+            skip_attr_set_idxs,
+            link="softmax",
+        )
+        if prob is not None:
+            if not np.all(np.isfinite(prob)):  # pragma: no cover
+                msg = "Non-finite values present in probabilities."
+                log.error(msg)
+                raise Exception(msg)
+            return prob
+
         log_odds_vector = EBMUtils.decision_function(
             X,
             estimator.attribute_sets_,
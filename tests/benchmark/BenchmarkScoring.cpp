@@ -0,0 +1,158 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// measures how many raw instances per second ScoreRawInstances scores as we give the model more threads.  The model and the data are synthetic,
+// but they are shaped like a typical EBM: one main effect per feature with a few hundred bins, and a pair for some of the features.  Every thread
+// count scores the same batch into the same buffer, and the scores are checked against the single thread scores, so a faster run can't be a wrong one
+//
+// usage: benchmark_scoring [countInstances [countFeatures [countPairs [countScores [countThreadsMax [countBitsQuantized]]]]]]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include "ebmcore.h"
+
+static IntegerDataType GetArgument(const int argc, char ** const argv, const int iArgument, const IntegerDataType defaultValue) {
+   return iArgument < argc ? static_cast<IntegerDataType>(atoll(argv[iArgument])) : defaultValue;
+}
+
+// a small deterministic generator, so every run scores the same data
+static uint64_t NextRandom(uint64_t * const pState) {
+   *pState = *pState * 6364136223846793005ULL + 1442695040888963407ULL;
+   return *pState >> 33;
+}
+
+int main(int argc, char ** argv) {
+   const IntegerDataType hardwareThreads = static_cast<IntegerDataType>(std::thread::hardware_concurrency());
+   const IntegerDataType countInstances = GetArgument(argc, argv, 1, 1000000);
+   const IntegerDataType countFeatures = GetArgument(argc, argv, 2, 32);
+   const IntegerDataType countPairs = GetArgument(argc, argv, 3, 16);
+   const IntegerDataType countScores = GetArgument(argc, argv, 4, 1);
+   const IntegerDataType countThreadsMax = GetArgument(argc, argv, 5, 0 == hardwareThreads ? 1 : hardwareThreads);
+   const IntegerDataType countBitsQuantized = GetArgument(argc, argv, 6, 0);
+   constexpr IntegerDataType countBins = 256;
+   constexpr IntegerDataType countPairBins = 32;
+
+   if(countInstances < 1 || countFeatures < 2 || countPairs < 0 || countScores < 1 || countThreadsMax < 1 || (0 != countBitsQuantized && 8 != countBitsQuantized && 16 != countBitsQuantized)) {
+      fprintf(stderr, "usage: benchmark_scoring [countInstances [countFeatures [countPairs [countScores [countThreadsMax [countBitsQuantized]]]]]]\n");
+      return 1;
+   }
+
+   uint64_t randomState = 42;
+
+   // every feature is ordinal with evenly spaced cuts over [0, 1), and the pairs reuse the features with coarser bins through a second copy
+   std::vector<EbmCoreFeature> features(static_cast<size_t>(2 * countFeatures));
+   std::vector<std::vector<FractionalDataType>> cuts(static_cast<size_t>(2 * countFeatures));
+   std::vector<const FractionalDataType *> featureCuts(static_cast<size_t>(2 * countFeatures));
+   for(IntegerDataType iFeature = 0; iFeature < 2 * countFeatures; ++iFeature) {
+      const IntegerDataType cBins = iFeature < countFeatures ? countBins : countPairBins;
+      features[static_cast<size_t>(iFeature)].featureType = FeatureTypeOrdinal;
+      features[static_cast<size_t>(iFeature)].hasMissing = 0;
+      features[static_cast<size_t>(iFeature)].countBins = cBins;
+      for(IntegerDataType iCut = 1; iCut < cBins; ++iCut) {
+         cuts[static_cast<size_t>(iFeature)].push_back(static_cast<FractionalDataType>(iCut) / static_cast<FractionalDataType>(cBins));
+      }
+      featureCuts[static_cast<size_t>(iFeature)] = &cuts[static_cast<size_t>(iFeature)][0];
+   }
+
+   const IntegerDataType countTerms = countFeatures + countPairs;
+   std::vector<EbmCoreFeatureCombination> combinations(static_cast<size_t>(countTerms));
+   std::vector<IntegerDataType> combinationIndexes;
+   std::vector<std::vector<FractionalDataType>> tensors(static_cast<size_t>(countTerms));
+   std::vector<const FractionalDataType *> models(static_cast<size_t>(countTerms));
+   for(IntegerDataType iTerm = 0; iTerm < countTerms; ++iTerm) {
+      size_t cItems = static_cast<size_t>(countScores);
+      if(iTerm < countFeatures) {
+         combinations[static_cast<size_t>(iTerm)].countFeaturesInCombination = 1;
+         combinationIndexes.push_back(iTerm);
+         cItems *= static_cast<size_t>(countBins);
+      } else {
+         const IntegerDataType iPair = iTerm - countFeatures;
+         combinations[static_cast<size_t>(iTerm)].countFeaturesInCombination = 2;
+         combinationIndexes.push_back(countFeatures + iPair % countFeatures);
+         combinationIndexes.push_back(countFeatures + (iPair + 1 + iPair / countFeatures) % countFeatures);
+         cItems *= static_cast<size_t>(countPairBins * countPairBins);
+      }
+      for(size_t iItem = 0; iItem < cItems; ++iItem) {
+         tensors[static_cast<size_t>(iTerm)].push_back(static_cast<FractionalDataType>(NextRandom(&randomState) % 2001) / 1000.0 - 1.0);
+      }
+      models[static_cast<size_t>(iTerm)] = &tensors[static_cast<size_t>(iTerm)][0];
+   }
+
+   PEbmModel ebmModel = CompileModel(countScores, 2 * countFeatures, &features[0], &featureCuts[0], nullptr, countTerms, &combinations[0], &combinationIndexes[0], &models[0], nullptr);
+   if(nullptr == ebmModel) {
+      fprintf(stderr, "CompileModel failed\n");
+      return 1;
+   }
+   if(0 != countBitsQuantized && 0 != QuantizeModel(ebmModel, countBitsQuantized, nullptr)) {
+      fprintf(stderr, "QuantizeModel failed\n");
+      FreeModel(ebmModel);
+      return 1;
+   }
+
+   // the pair copies of a feature get the same value as the feature itself
+   const size_t cInstances = static_cast<size_t>(countInstances);
+   const size_t cFeaturesAll = static_cast<size_t>(2 * countFeatures);
+   std::vector<FractionalDataType> values(cInstances * cFeaturesAll);
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      for(size_t iFeature = 0; iFeature < static_cast<size_t>(countFeatures); ++iFeature) {
+         const FractionalDataType value = static_cast<FractionalDataType>(NextRandom(&randomState) % 1000000) / 1000000.0;
+         values[iInstance * cFeaturesAll + iFeature] = value;
+         values[iInstance * cFeaturesAll + static_cast<size_t>(countFeatures) + iFeature] = value;
+      }
+   }
+
+   const size_t cOutputs = static_cast<size_t>(countScores);
+   std::vector<FractionalDataType> scoresFirst(cInstances * cOutputs);
+   std::vector<FractionalDataType> scores(cInstances * cOutputs);
+
+   printf("instances=%lld features=%lld pairs=%lld scores=%lld bits=%lld\n", static_cast<long long>(countInstances), static_cast<long long>(countFeatures), static_cast<long long>(countPairs), static_cast<long long>(countScores), static_cast<long long>(countBitsQuantized));
+   printf("threads  seconds  instances/second  speedup\n");
+   double secondsFirst = 0;
+   int ret = 0;
+   // we double the threads each time, and finish with countThreadsMax itself
+   for(IntegerDataType countThreads = 1; ; countThreads = countThreadsMax < 2 * countThreads ? countThreadsMax : 2 * countThreads) {
+      if(0 != SetModelThreadCount(ebmModel, countThreads)) {
+         fprintf(stderr, "SetModelThreadCount failed\n");
+         ret = 1;
+         break;
+      }
+      std::vector<FractionalDataType> & scoresRun = 1 == countThreads ? scoresFirst : scores;
+      // one run to page in the data and start the threads, and then the best of three
+      double secondsBest = 0;
+      for(int iRun = 0; iRun < 4; ++iRun) {
+         const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+         if(0 != ScoreRawInstances(ebmModel, countInstances, &values[0], nullptr, ScoreLinkIdentity, &scoresRun[0])) {
+            fprintf(stderr, "ScoreRawInstances failed\n");
+            ret = 1;
+            break;
+         }
+         const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+         if(1 == iRun || (1 < iRun && seconds < secondsBest)) {
+            secondsBest = seconds;
+         }
+      }
+      if(0 != ret) {
+         break;
+      }
+      if(1 == countThreads) {
+         secondsFirst = secondsBest;
+      } else if(scores != scoresFirst) {
+         fprintf(stderr, "the scores of %lld threads differ from the scores of 1 thread\n", static_cast<long long>(countThreads));
+         ret = 1;
+         break;
+      }
+      printf("%7lld  %7.3f  %16.0f  %7.2f\n", static_cast<long long>(countThreads), secondsBest, static_cast<double>(countInstances) / secondsBest, secondsFirst / secondsBest);
+      if(countThreads == countThreadsMax) {
+         break;
+      }
+   }
+
+   FreeModel(ebmModel);
+   return ret;
+}
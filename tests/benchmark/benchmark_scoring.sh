@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# builds the release core library and the scoring benchmark, and then runs the benchmark with any arguments that aren't ours
+
+clang_pp_bin=clang++
+g_pp_bin=g++
+os_type=`uname`
+script_path=`dirname "$0"`
+root_path="$script_path/../.."
+
+build_core=1
+benchmark_args=""
+for arg in "$@"; do
+   if [ "$arg" = "-nobuildcore" ]; then
+      build_core=0
+   else
+      benchmark_args="$benchmark_args $arg"
+   fi
+done
+
+if [ $build_core -eq 1 ]; then
+   echo "Building Core library..."
+   /bin/sh "$root_path/build.sh"
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then 
+      exit $ret_code
+   fi
+else
+   echo "Core library NOT being built"
+fi
+
+compile_all="\"$root_path/tests/benchmark/BenchmarkScoring.cpp\" -I\"$root_path/core/inc\" -std=c++11 -O3 -march=core2 -m64 -DNDEBUG"
+
+if [ "$os_type" = "Darwin" ]; then
+   bin_path="$root_path/tmp/clang/bin/release/mac/x64/BenchmarkScoring"
+   compile_command="$clang_pp_bin $compile_all -L\"$root_path/staging\" -Wl,-rpath,@loader_path -l_ebmcore_mac_x64 -o \"$bin_path/benchmark_scoring\" 2>&1"
+   library="$root_path/staging/lib_ebmcore_mac_x64.dylib"
+elif [ "$os_type" = "Linux" ]; then
+   bin_path="$root_path/tmp/gcc/bin/release/linux/x64/BenchmarkScoring"
+   compile_command="$g_pp_bin $compile_all -L\"$root_path/staging\" -Wl,-rpath-link,\"$root_path/staging\" -Wl,-rpath,'\$ORIGIN/' -pthread -l_ebmcore_linux_x64 -o \"$bin_path/benchmark_scoring\" 2>&1"
+   library="$root_path/staging/lib_ebmcore_linux_x64.so"
+else
+   echo "OS $os_type not recognized.  We support $clang_pp_bin on macOS and $g_pp_bin on Linux"
+   exit 1
+fi
+
+echo "Compiling BenchmarkScoring for $os_type release|x64"
+[ -d "$bin_path" ] || mkdir -p "$bin_path"
+ret_code=$?
+if [ $ret_code -ne 0 ]; then 
+   exit $ret_code
+fi
+compile_out=`eval $compile_command`
+ret_code=$?
+echo -n "$compile_out"
+if [ $ret_code -ne 0 ]; then 
+   exit $ret_code
+fi
+cp "$library" "$bin_path/"
+ret_code=$?
+if [ $ret_code -ne 0 ]; then 
+   exit $ret_code
+fi
+"$bin_path/benchmark_scoring" $benchmark_args
@@ -9,5 +9,6 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <limits>
 #include <assert.h>
 #include <string.h>
@@ -22,10 +22,12 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <limits>
 #include <assert.h>
 #include <string.h>
 
 #include "ebmcore.h"
+#include "ebmcore_test_hooks.h"
 
 #define UNUSED(x) (void)(x)
 
@@ -63,6 +65,14 @@ inline bool IsApproxEqual(const double value, const double expected, const doubl
    return std::abs(expected - value) <= std::abs(expected * percentage);
 }
 
+// a library built with EBM_FLOAT_RESIDUALS stores its per-instance residuals and scores in single precision, so the checks that compare against
+// double precision formulas to a few double epsilons get the same number of float epsilons instead.  Build these tests with the same define
+#ifdef EBM_FLOAT_RESIDUALS
+constexpr double k_residualPrecisionScale = static_cast<double>(std::numeric_limits<float>::epsilon()) / std::numeric_limits<double>::epsilon();
+#else // EBM_FLOAT_RESIDUALS
+constexpr double k_residualPrecisionScale = 1;
+#endif // EBM_FLOAT_RESIDUALS
+
 // this will ONLY work if used inside the root TEST_CASE function.  The testCaseHidden variable comes from TEST_CASE and should be visible inside the function where CHECK(expression) is called
 #define CHECK(expression) \
    do { \
@@ -709,7 +719,7 @@ public:
       m_stage = Stage::ValidationAdded;
    }
 
-   void InitializeTraining(const IntegerDataType countInnerBags = k_countInnerBagsDefault) {
+   void InitializeTraining(const IntegerDataType countInnerBags = k_countInnerBagsDefault, const IntegerDataType seed = randomSeed) {
       if(Stage::ValidationAdded != m_stage) {
          exit(1);
       }
@@ -718,9 +728,9 @@ public:
       }
 
       if(IsClassification(m_learningTypeOrCountTargetClasses)) {
-         m_pEbmTraining = InitializeTrainingClassification(randomSeed, m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_learningTypeOrCountTargetClasses, m_trainingClassificationTargets.size(), 0 == m_trainingClassificationTargets.size() ? nullptr : &m_trainingClassificationTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_bNullTrainingPredictionScores ? nullptr : &m_trainingPredictionScores[0], m_validationClassificationTargets.size(), 0 == m_validationClassificationTargets.size() ? nullptr : &m_validationClassificationTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0], m_bNullValidationPredictionScores ? nullptr : &m_validationPredictionScores[0], countInnerBags);
+         m_pEbmTraining = InitializeTrainingClassification(seed, m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_learningTypeOrCountTargetClasses, m_trainingClassificationTargets.size(), 0 == m_trainingClassificationTargets.size() ? nullptr : &m_trainingClassificationTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_bNullTrainingPredictionScores ? nullptr : &m_trainingPredictionScores[0], m_validationClassificationTargets.size(), 0 == m_validationClassificationTargets.size() ? nullptr : &m_validationClassificationTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0], m_bNullValidationPredictionScores ? nullptr : &m_validationPredictionScores[0], countInnerBags);
       } else if(k_learningTypeRegression == m_learningTypeOrCountTargetClasses) {
-         m_pEbmTraining = InitializeTrainingRegression(randomSeed, m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_trainingRegressionTargets.size(), 0 == m_trainingRegressionTargets.size() ? nullptr : &m_trainingRegressionTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_bNullTrainingPredictionScores ? nullptr : &m_trainingPredictionScores[0], m_validationRegressionTargets.size(), 0 == m_validationRegressionTargets.size() ? nullptr : &m_validationRegressionTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0], m_bNullValidationPredictionScores ? nullptr : &m_validationPredictionScores[0], countInnerBags);
+         m_pEbmTraining = InitializeTrainingRegression(seed, m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_trainingRegressionTargets.size(), 0 == m_trainingRegressionTargets.size() ? nullptr : &m_trainingRegressionTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_bNullTrainingPredictionScores ? nullptr : &m_trainingPredictionScores[0], m_validationRegressionTargets.size(), 0 == m_validationRegressionTargets.size() ? nullptr : &m_validationRegressionTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0], m_bNullValidationPredictionScores ? nullptr : &m_validationPredictionScores[0], countInnerBags);
       } else {
          exit(1);
       }
@@ -731,6 +741,26 @@ public:
       m_stage = Stage::InitializedTraining;
    }
 
+   void SetTrainingThreads(const IntegerDataType countThreads) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      const IntegerDataType ret = SetTrainingThreadCount(m_pEbmTraining, countThreads);
+      if(0 != ret) {
+         exit(1);
+      }
+   }
+
+   void SetPrecomputedDenominators(const bool bPrecomputedDenominators) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      const IntegerDataType ret = SetTrainingPrecomputedDenominators(m_pEbmTraining, bPrecomputedDenominators ? 1 : 0);
+      if(0 != ret) {
+         exit(1);
+      }
+   }
+
    FractionalDataType Train(const IntegerDataType indexFeatureCombination, const std::vector<FractionalDataType> trainingWeights = {}, const std::vector<FractionalDataType> validationWeights = {}, const FractionalDataType learningRate = k_learningRateDefault, const IntegerDataType countTreeSplitsMax = k_countTreeSplitsMaxDefault, const IntegerDataType countInstancesRequiredForParentSplitMin = k_countInstancesRequiredForParentSplitMinDefault) {
       if(Stage::InitializedTraining != m_stage) {
          exit(1);
@@ -762,6 +792,46 @@ public:
       return validationMetricReturn;
    }
 
+   FractionalDataType Boost(const std::vector<IntegerDataType> featureCombinationIndexes, const IntegerDataType countEpisodes, const IntegerDataType earlyStoppingRunLength, const FractionalDataType earlyStoppingTolerance, IntegerDataType * const pCountEpisodesReturn, const IntegerDataType countStepsPerFeatureCombination = 1, const FractionalDataType learningRate = k_learningRateDefault, const IntegerDataType countTreeSplitsMax = k_countTreeSplitsMaxDefault, const IntegerDataType countInstancesRequiredForParentSplitMin = k_countInstancesRequiredForParentSplitMinDefault) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      for(const IntegerDataType indexFeatureCombination : featureCombinationIndexes) {
+         if(indexFeatureCombination < IntegerDataType { 0 }) {
+            exit(1);
+         }
+         if(m_featureCombinations.size() <= static_cast<size_t>(indexFeatureCombination)) {
+            exit(1);
+         }
+      }
+
+      FractionalDataType validationMetricReturn = FractionalDataType { 0 };
+      const IntegerDataType ret = BoostCycles(m_pEbmTraining, featureCombinationIndexes.size(), 0 == featureCombinationIndexes.size() ? nullptr : &featureCombinationIndexes[0], countEpisodes, countStepsPerFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, earlyStoppingRunLength, earlyStoppingTolerance, &validationMetricReturn, pCountEpisodesReturn);
+      if(0 != ret) {
+         exit(1);
+      }
+      return validationMetricReturn;
+   }
+
+   FractionalDataType ApplyUpdate(const IntegerDataType indexFeatureCombination, const std::vector<FractionalDataType> modelFeatureCombinationUpdateTensor) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      if(indexFeatureCombination < IntegerDataType { 0 }) {
+         exit(1);
+      }
+      if(m_featureCombinations.size() <= static_cast<size_t>(indexFeatureCombination)) {
+         exit(1);
+      }
+
+      FractionalDataType validationMetricReturn = FractionalDataType { 0 };
+      const IntegerDataType ret = ApplyModelFeatureCombinationUpdate(m_pEbmTraining, indexFeatureCombination, 0 == modelFeatureCombinationUpdateTensor.size() ? nullptr : &modelFeatureCombinationUpdateTensor[0], &validationMetricReturn);
+      if(0 != ret) {
+         exit(1);
+      }
+      return validationMetricReturn;
+   }
+
    // TODO : change this so that we first call GetCurrentModelExpanded OR GetBestModelExpanded, which will return a tensor expanded as needed THEN  we call an indexing function if desired
    FractionalDataType GetCurrentModelPredictorScore(const size_t iFeatureCombination, const std::vector<size_t> perDimensionIndexArrayForBinnedFeatures, const size_t iTargetClassOrZero) const {
       if(Stage::InitializedTraining != m_stage) {
@@ -984,6 +1054,16 @@ public:
       m_stage = Stage::InitializedInteraction;
    }
 
+   void SetInteractionThreads(const IntegerDataType countThreads) {
+      if(Stage::InitializedInteraction != m_stage) {
+         exit(1);
+      }
+      const IntegerDataType ret = SetInteractionThreadCount(m_pEbmInteraction, countThreads);
+      if(0 != ret) {
+         exit(1);
+      }
+   }
+
    FractionalDataType InteractionScore(const std::vector<IntegerDataType> featuresInCombination) const {
       if(Stage::InitializedInteraction != m_stage) {
          exit(1);
@@ -1004,6 +1084,44 @@ public:
       }
       return interactionScoreReturn;
    }
+
+   // the combinations all need to have the same number of features.  If countTopCombinations is non-zero then pTopCombinationIndexes receives the
+   // indexes of the returned scores
+   std::vector<FractionalDataType> InteractionScores(const std::vector<std::vector<IntegerDataType>> combinations, const IntegerDataType countTopCombinations = 0, std::vector<IntegerDataType> * const pTopCombinationIndexes = nullptr) const {
+      if(Stage::InitializedInteraction != m_stage) {
+         exit(1);
+      }
+      const size_t cFeaturesInCombination = 0 == combinations.size() ? size_t { 0 } : combinations[0].size();
+      std::vector<IntegerDataType> featureIndexes;
+      for(const std::vector<IntegerDataType> & combination : combinations) {
+         if(cFeaturesInCombination != combination.size()) {
+            exit(1);
+         }
+         for(const IntegerDataType oneFeatureIndex : combination) {
+            if(oneFeatureIndex < IntegerDataType { 0 }) {
+               exit(1);
+            }
+            if(m_features.size() <= static_cast<size_t>(oneFeatureIndex)) {
+               exit(1);
+            }
+            featureIndexes.push_back(oneFeatureIndex);
+         }
+      }
+
+      const size_t cReturned = 0 == countTopCombinations || combinations.size() < static_cast<size_t>(countTopCombinations) ? combinations.size() : static_cast<size_t>(countTopCombinations);
+      std::vector<FractionalDataType> scores(cReturned + 1);
+      std::vector<IntegerDataType> topCombinationIndexes(cReturned + 1);
+      const IntegerDataType ret = GetInteractionScores(m_pEbmInteraction, combinations.size(), cFeaturesInCombination, 0 == featureIndexes.size() ? nullptr : &featureIndexes[0], countTopCombinations, &scores[0], &topCombinationIndexes[0]);
+      if(0 != ret) {
+         exit(1);
+      }
+      scores.resize(cReturned);
+      topCombinationIndexes.resize(cReturned);
+      if(nullptr != pTopCombinationIndexes) {
+         *pTopCombinationIndexes = topCombinationIndexes;
+      }
+      return scores;
+   }
 };
 
 TEST_CASE("null validationMetricReturn, training, regression") {
@@ -1197,11 +1315,20 @@ TEST_CASE("negative learning rate, training, binary") {
          }
       }
    }
+#ifdef EBM_FLOAT_RESIDUALS
+   // once the prediction is within a float epsilon of 1 the stored residual rounds to zero and the model stops moving, long before the log loss overflows
+   CHECK_APPROX(validationMetric, 28.148797988892198);
+   modelValue = test.GetCurrentModelPredictorScore(0, {}, 0);
+   CHECK_APPROX(modelValue, 0);
+   modelValue = test.GetCurrentModelPredictorScore(0, {}, 1);
+   CHECK_APPROX(modelValue, 28.14879759064647);
+#else // EBM_FLOAT_RESIDUALS
    CHECK(std::isinf(validationMetric));
    modelValue = test.GetCurrentModelPredictorScore(0, {}, 0);
    CHECK_APPROX(modelValue, 0);
    modelValue = test.GetCurrentModelPredictorScore(0, {}, 1);
    CHECK_APPROX(modelValue, 16785686302.358746);
+#endif // EBM_FLOAT_RESIDUALS
 }
 
 TEST_CASE("negative learning rate, training, multiclass") {
@@ -1237,9 +1364,16 @@ TEST_CASE("negative learning rate, training, multiclass") {
          }
       }
    }
+#ifdef EBM_FLOAT_RESIDUALS
+   // once the prediction is within a float epsilon of 1 the stored residual rounds to zero and the model stops moving, long before the log loss overflows
+   CHECK_APPROX(validationMetric, 40.057282922747447);
+   modelValue = test.GetCurrentModelPredictorScore(0, {}, 0);
+   CHECK_APPROX(modelValue, -19.455875426206507);
+#else // EBM_FLOAT_RESIDUALS
    CHECK(std::isinf(validationMetric));
    modelValue = test.GetCurrentModelPredictorScore(0, {}, 0);
    CHECK_APPROX(modelValue, -10344932.919067673);
+#endif // EBM_FLOAT_RESIDUALS
    modelValue = test.GetCurrentModelPredictorScore(0, {}, 1);
    CHECK_APPROX(modelValue, 19.907994122542746);
    modelValue = test.GetCurrentModelPredictorScore(0, {}, 2);
@@ -1286,6 +1420,43 @@ TEST_CASE("zero countTreeSplitsMax, training, regression") {
    CHECK_APPROX(modelValue, 0.1000000000000000);
 }
 
+TEST_CASE("trees as large as the bins allow, training, regression") {
+   // every bin has its own target, so an unlimited tree splits between every pair of bins and fills the whole TreeNode buffer, while a small
+   // countTreeSplitsMax is the limit instead of the bins
+   std::vector<RegressionInstance> instances;
+   for(IntegerDataType iInstance = 0; iInstance < 4 * 64; ++iInstance) {
+      const IntegerDataType bin = iInstance % 64;
+      instances.push_back(RegressionInstance(static_cast<FractionalDataType>(bin), { bin }));
+   }
+
+   for(const IntegerDataType countTreeSplitsMax : { IntegerDataType { 3 }, IntegerDataType { 1000 } }) {
+      TestApi test = TestApi(k_learningTypeRegression);
+      test.AddFeatures({ FeatureTest(64) });
+      test.AddFeatureCombinations({ { 0 } });
+      test.AddTrainingInstances(instances);
+      test.AddValidationInstances(instances);
+      test.InitializeTraining();
+
+      for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+         test.Train(0, {}, {}, k_learningRateDefault, countTreeSplitsMax);
+      }
+      size_t cDistinct = 1;
+      for(size_t iBin = 1; iBin < 64; ++iBin) {
+         const FractionalDataType modelValuePrev = test.GetCurrentModelPredictorScore(0, { iBin - 1 }, 0);
+         const FractionalDataType modelValue = test.GetCurrentModelPredictorScore(0, { iBin }, 0);
+         CHECK(modelValuePrev <= modelValue);
+         if(modelValuePrev != modelValue) {
+            ++cDistinct;
+         }
+      }
+      if(3 == countTreeSplitsMax) {
+         CHECK(cDistinct <= 3 * (3 + 1));
+      } else {
+         CHECK(64 == cDistinct);
+      }
+   }
+}
+
 
 //TEST_CASE("infinite target training set, training, regression") {
 //   TestApi test = TestApi(k_learningTypeRegression);
@@ -1653,6 +1824,1892 @@ TEST_CASE("features with 1 state in various positions, training") {
    }
 }
 
+TEST_CASE("thread count does not change the model, training, regression") {
+   std::vector<RegressionInstance> trainingInstances;
+   std::vector<RegressionInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 500; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 7;
+      const IntegerDataType bin1 = (iInstance * 13) % 5;
+      const FractionalDataType target = static_cast<FractionalDataType>(bin0 * bin1) + static_cast<FractionalDataType>(iInstance % 3) * 0.25;
+      trainingInstances.push_back(RegressionInstance(target, { bin0, bin1 }));
+      validationInstances.push_back(RegressionInstance(target + 0.5, { bin1, bin0 % 5 }));
+   }
+
+   TestApi test1 = TestApi(k_learningTypeRegression);
+   test1.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   test1.AddFeatureCombinations({ {}, { 0 }, { 1 }, { 0, 1 } });
+   test1.AddTrainingInstances(trainingInstances);
+   test1.AddValidationInstances(validationInstances);
+   test1.InitializeTraining(5);
+   test1.SetTrainingThreads(1);
+
+   TestApi testMany = TestApi(k_learningTypeRegression);
+   testMany.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testMany.AddFeatureCombinations({ {}, { 0 }, { 1 }, { 0, 1 } });
+   testMany.AddTrainingInstances(trainingInstances);
+   testMany.AddValidationInstances(validationInstances);
+   testMany.InitializeTraining(5);
+   testMany.SetTrainingThreads(4);
+
+   for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 4; ++iFeatureCombination) {
+         const FractionalDataType validationMetric1 = test1.Train(iFeatureCombination);
+         const FractionalDataType validationMetricMany = testMany.Train(iFeatureCombination);
+         CHECK(validationMetric1 == validationMetricMany);
+      }
+   }
+   for(IntegerDataType bin0 = 0; bin0 < 7; ++bin0) {
+      CHECK(test1.GetCurrentModelPredictorScore(1, { static_cast<size_t>(bin0) }, 0) == testMany.GetCurrentModelPredictorScore(1, { static_cast<size_t>(bin0) }, 0));
+      for(IntegerDataType bin1 = 0; bin1 < 5; ++bin1) {
+         CHECK(test1.GetCurrentModelPredictorScore(3, { static_cast<size_t>(bin0), static_cast<size_t>(bin1) }, 0) == testMany.GetCurrentModelPredictorScore(3, { static_cast<size_t>(bin0), static_cast<size_t>(bin1) }, 0));
+      }
+   }
+}
+
+TEST_CASE("thread count does not change the model, training, multiclass") {
+   std::vector<ClassificationInstance> trainingInstances;
+   std::vector<ClassificationInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 500; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 7;
+      const IntegerDataType bin1 = (iInstance * 13) % 5;
+      trainingInstances.push_back(ClassificationInstance((bin0 + bin1 + iInstance / 100) % 3, { bin0, bin1 }));
+      validationInstances.push_back(ClassificationInstance((bin0 * bin1) % 3, { bin0, bin1 }));
+   }
+
+   TestApi test1 = TestApi(3);
+   test1.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   test1.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   test1.AddTrainingInstances(trainingInstances);
+   test1.AddValidationInstances(validationInstances);
+   test1.InitializeTraining(3);
+   test1.SetTrainingThreads(1);
+
+   TestApi testMany = TestApi(3);
+   testMany.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testMany.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   testMany.AddTrainingInstances(trainingInstances);
+   testMany.AddValidationInstances(validationInstances);
+   testMany.InitializeTraining(3);
+   testMany.SetTrainingThreads(3);
+
+   for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+         const FractionalDataType validationMetric1 = test1.Train(iFeatureCombination);
+         const FractionalDataType validationMetricMany = testMany.Train(iFeatureCombination);
+         CHECK(validationMetric1 == validationMetricMany);
+      }
+   }
+   for(size_t iClass = 0; iClass < 3; ++iClass) {
+      for(IntegerDataType bin0 = 0; bin0 < 7; ++bin0) {
+         for(IntegerDataType bin1 = 0; bin1 < 5; ++bin1) {
+            CHECK(test1.GetCurrentModelPredictorScore(2, { static_cast<size_t>(bin0), static_cast<size_t>(bin1) }, iClass) == testMany.GetCurrentModelPredictorScore(2, { static_cast<size_t>(bin0), static_cast<size_t>(bin1) }, iClass));
+         }
+      }
+   }
+}
+
+TEST_CASE("more inner bags than threads merge in the same order as one thread, training, binary") {
+   // 8 inner bags on 3 threads means that each worker trains several sampling sets and they arrive at the merge out of order
+   std::vector<ClassificationInstance> trainingInstances;
+   std::vector<ClassificationInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 700; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 9;
+      const IntegerDataType bin1 = (iInstance * 11) % 4;
+      trainingInstances.push_back(ClassificationInstance((bin0 + 2 * bin1 + iInstance / 70) % 2, { bin0, bin1 }));
+      validationInstances.push_back(ClassificationInstance((bin0 * bin1 + iInstance % 3) % 2, { bin0, bin1 }));
+   }
+
+   TestApi test1 = TestApi(2);
+   test1.AddFeatures({ FeatureTest(9), FeatureTest(4) });
+   test1.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   test1.AddTrainingInstances(trainingInstances);
+   test1.AddValidationInstances(validationInstances);
+   test1.InitializeTraining(8);
+   test1.SetTrainingThreads(1);
+
+   TestApi testMany = TestApi(2);
+   testMany.AddFeatures({ FeatureTest(9), FeatureTest(4) });
+   testMany.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   testMany.AddTrainingInstances(trainingInstances);
+   testMany.AddValidationInstances(validationInstances);
+   testMany.InitializeTraining(8);
+   testMany.SetTrainingThreads(3);
+
+   for(int iEpoch = 0; iEpoch < 15; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+         const FractionalDataType validationMetric1 = test1.Train(iFeatureCombination);
+         const FractionalDataType validationMetricMany = testMany.Train(iFeatureCombination);
+         CHECK(validationMetric1 == validationMetricMany);
+      }
+   }
+   // binary models have a single logit, which is the score of class 1
+   for(IntegerDataType bin0 = 0; bin0 < 9; ++bin0) {
+      CHECK(test1.GetCurrentModelPredictorScore(0, { static_cast<size_t>(bin0) }, 1) == testMany.GetCurrentModelPredictorScore(0, { static_cast<size_t>(bin0) }, 1));
+      for(IntegerDataType bin1 = 0; bin1 < 4; ++bin1) {
+         CHECK(test1.GetCurrentModelPredictorScore(2, { static_cast<size_t>(bin0), static_cast<size_t>(bin1) }, 1) == testMany.GetCurrentModelPredictorScore(2, { static_cast<size_t>(bin0), static_cast<size_t>(bin1) }, 1));
+      }
+   }
+}
+
+TEST_CASE("binning in chunks gives the same model as one thread, training, regression") {
+   // above 65536 instances a sampling set is binned in chunks, both with the single sampling set that we get without inner bags and with
+   // 2 inner bags, where each of the 2 workers gets 2 of the 4 threads for binning
+   std::vector<RegressionInstance> trainingInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 140000; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 11;
+      const IntegerDataType bin1 = (iInstance * 7) % 6;
+      const FractionalDataType target = static_cast<FractionalDataType>(bin0 * bin1) * 0.125 + static_cast<FractionalDataType>(iInstance % 17) * 0.03;
+      trainingInstances.push_back(RegressionInstance(target, { bin0, bin1 }));
+   }
+   std::vector<RegressionInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 1000; ++iInstance) {
+      const IntegerDataType bin0 = (iInstance * 3) % 11;
+      const IntegerDataType bin1 = iInstance % 6;
+      validationInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(bin0 * bin1) * 0.125, { bin0, bin1 }));
+   }
+
+   for(const IntegerDataType countInnerBags : { IntegerDataType { 0 }, IntegerDataType { 2 } }) {
+      TestApi test1 = TestApi(k_learningTypeRegression);
+      test1.AddFeatures({ FeatureTest(11), FeatureTest(6) });
+      test1.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+      test1.AddTrainingInstances(trainingInstances);
+      test1.AddValidationInstances(validationInstances);
+      test1.InitializeTraining(countInnerBags);
+      test1.SetTrainingThreads(1);
+
+      TestApi testMany = TestApi(k_learningTypeRegression);
+      testMany.AddFeatures({ FeatureTest(11), FeatureTest(6) });
+      testMany.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+      testMany.AddTrainingInstances(trainingInstances);
+      testMany.AddValidationInstances(validationInstances);
+      testMany.InitializeTraining(countInnerBags);
+      testMany.SetTrainingThreads(4);
+
+      for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+         for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+            const FractionalDataType validationMetric1 = test1.Train(iFeatureCombination);
+            const FractionalDataType validationMetricMany = testMany.Train(iFeatureCombination);
+            CHECK(validationMetric1 == validationMetricMany);
+         }
+      }
+      for(IntegerDataType bin0 = 0; bin0 < 11; ++bin0) {
+         CHECK(test1.GetCurrentModelPredictorScore(0, { static_cast<size_t>(bin0) }, 0) == testMany.GetCurrentModelPredictorScore(0, { static_cast<size_t>(bin0) }, 0));
+         for(IntegerDataType bin1 = 0; bin1 < 6; ++bin1) {
+            CHECK(test1.GetCurrentModelPredictorScore(2, { static_cast<size_t>(bin0), static_cast<size_t>(bin1) }, 0) == testMany.GetCurrentModelPredictorScore(2, { static_cast<size_t>(bin0), static_cast<size_t>(bin1) }, 0));
+         }
+      }
+   }
+}
+
+TEST_CASE("updating scores in chunks gives the same metrics as one thread, training, classification") {
+   // both sets are above the 32768 instances per update chunk, so the training and validation scores are updated in chunks and the validation
+   // metric is summed from per chunk sums.  The training set is below the binning chunk size, so only the updates differ between the runs
+   for(const IntegerDataType countClasses : { IntegerDataType { 2 }, IntegerDataType { 3 } }) {
+      std::vector<ClassificationInstance> trainingInstances;
+      for(IntegerDataType iInstance = 0; iInstance < 50000; ++iInstance) {
+         const IntegerDataType bin0 = iInstance % 7;
+         const IntegerDataType bin1 = (iInstance * 5) % 9;
+         trainingInstances.push_back(ClassificationInstance((bin0 + bin1 + iInstance / 1000) % countClasses, { bin0, bin1 }));
+      }
+      std::vector<ClassificationInstance> validationInstances;
+      for(IntegerDataType iInstance = 0; iInstance < 80000; ++iInstance) {
+         const IntegerDataType bin0 = (iInstance * 3) % 7;
+         const IntegerDataType bin1 = iInstance % 9;
+         validationInstances.push_back(ClassificationInstance((bin0 * bin1 + iInstance % 5) % countClasses, { bin0, bin1 }));
+      }
+
+      TestApi test1 = TestApi(countClasses);
+      test1.AddFeatures({ FeatureTest(7), FeatureTest(9) });
+      test1.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+      test1.AddTrainingInstances(trainingInstances);
+      test1.AddValidationInstances(validationInstances);
+      test1.InitializeTraining(0);
+      test1.SetTrainingThreads(1);
+
+      TestApi testMany = TestApi(countClasses);
+      testMany.AddFeatures({ FeatureTest(7), FeatureTest(9) });
+      testMany.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+      testMany.AddTrainingInstances(trainingInstances);
+      testMany.AddValidationInstances(validationInstances);
+      testMany.InitializeTraining(0);
+      testMany.SetTrainingThreads(3);
+
+      for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+         for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+            const FractionalDataType validationMetric1 = test1.Train(iFeatureCombination);
+            const FractionalDataType validationMetricMany = testMany.Train(iFeatureCombination);
+            CHECK(validationMetric1 == validationMetricMany);
+         }
+      }
+   }
+}
+
+TEST_CASE("thread count does not change the score, interaction, regression") {
+   std::vector<RegressionInstance> instances;
+   for(IntegerDataType iInstance = 0; iInstance < 200; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 3;
+      const IntegerDataType bin1 = (iInstance * 7) % 4;
+      instances.push_back(RegressionInstance(static_cast<FractionalDataType>(bin0 * bin1), { bin0, bin1 }));
+   }
+
+   TestApi test = TestApi(k_learningTypeRegression);
+   test.AddFeatures({ FeatureTest(3), FeatureTest(4) });
+   test.AddInteractionInstances(instances);
+   test.InitializeInteraction();
+
+   test.SetInteractionThreads(1);
+   const FractionalDataType score1 = test.InteractionScore({ 0, 1 });
+   test.SetInteractionThreads(0);
+   const FractionalDataType scoreDefault = test.InteractionScore({ 0, 1 });
+   CHECK(score1 == scoreDefault);
+}
+
+TEST_CASE("bit packing width does not change the score, interaction, regression") {
+   // 203 instances leaves a partially filled data unit at the end for every packing width
+   std::vector<RegressionInstance> instances;
+   for(IntegerDataType iInstance = 0; iInstance < 203; ++iInstance) {
+      const IntegerDataType bin0 = (iInstance / 3) % 2;
+      const IntegerDataType bin1 = (iInstance * 7) % 3;
+      instances.push_back(RegressionInstance(static_cast<FractionalDataType>(bin0 * bin1 + bin1), { bin0, bin1 }));
+   }
+
+   // the same data with a second feature that packs 32 items per data unit and one that packs 7 items per data unit, since the extra bins are empty
+   TestApi testNarrow = TestApi(k_learningTypeRegression);
+   testNarrow.AddFeatures({ FeatureTest(2), FeatureTest(3) });
+   testNarrow.AddInteractionInstances(instances);
+   testNarrow.InitializeInteraction();
+
+   TestApi testWide = TestApi(k_learningTypeRegression);
+   testWide.AddFeatures({ FeatureTest(2), FeatureTest(300) });
+   testWide.AddInteractionInstances(instances);
+   testWide.InitializeInteraction();
+
+   const FractionalDataType scoreNarrow = testNarrow.InteractionScore({ 0, 1 });
+   CHECK(0 < scoreNarrow);
+   CHECK(scoreNarrow == testWide.InteractionScore({ 0, 1 }));
+   CHECK(scoreNarrow == testWide.InteractionScore({ 1, 0 }));
+}
+
+TEST_CASE("narrow instance major and float64 feature major binned data match int64 feature major binned data, training and interaction, regression") {
+   constexpr IntegerDataType countInstances = 150;
+   EbmCoreFeature features[2];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 3;
+   features[1].featureType = FeatureTypeOrdinal;
+   features[1].hasMissing = 0;
+   features[1].countBins = 4;
+   EbmCoreFeatureCombination combinations[1];
+   combinations->countFeaturesInCombination = 2;
+   const IntegerDataType combinationIndexes[] = { 0, 1 };
+
+   std::vector<FractionalDataType> targets;
+   std::vector<IntegerDataType> featureMajor(2 * countInstances);
+   std::vector<uint8_t> instanceMajor8;
+   std::vector<uint16_t> instanceMajor16;
+   std::vector<double> featureMajorFloat64(2 * countInstances);
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 3;
+      const IntegerDataType bin1 = (iInstance * 7) % 4;
+      targets.push_back(static_cast<FractionalDataType>(bin0 * bin1) + FractionalDataType { 0.5 } * bin0);
+      featureMajor[iInstance] = bin0;
+      featureMajor[countInstances + iInstance] = bin1;
+      featureMajorFloat64[iInstance] = static_cast<double>(bin0);
+      featureMajorFloat64[countInstances + iInstance] = static_cast<double>(bin1);
+      instanceMajor8.push_back(static_cast<uint8_t>(bin0));
+      instanceMajor8.push_back(static_cast<uint8_t>(bin1));
+      instanceMajor16.push_back(static_cast<uint16_t>(bin0));
+      instanceMajor16.push_back(static_cast<uint16_t>(bin1));
+   }
+   const EbmCoreBinnedData binnedData8 = { BinnedDataTypeUInt8, 2, 1, &instanceMajor8[0] };
+   const EbmCoreBinnedData binnedData16 = { BinnedDataTypeUInt16, 2, 1, &instanceMajor16[0] };
+   // R hands us its numeric matrices like this, one feature after another in doubles
+   const EbmCoreBinnedData binnedDataFloat64 = { BinnedDataTypeFloat64, 1, countInstances, &featureMajorFloat64[0] };
+
+   PEbmInteraction pEbmInteraction = InitializeInteractionRegression(2, features, countInstances, &targets[0], &featureMajor[0], nullptr);
+   PEbmInteraction pEbmInteractionStrided = InitializeInteractionRegressionStrided(2, features, countInstances, &targets[0], &binnedData8, nullptr);
+   CHECK(nullptr != pEbmInteractionStrided);
+   FractionalDataType score = 0;
+   FractionalDataType scoreStrided = 0;
+   CHECK(0 == GetInteractionScore(pEbmInteraction, 2, combinationIndexes, &score));
+   CHECK(0 == GetInteractionScore(pEbmInteractionStrided, 2, combinationIndexes, &scoreStrided));
+   CHECK(0 < score);
+   CHECK(score == scoreStrided);
+   FreeInteraction(pEbmInteractionStrided);
+   pEbmInteractionStrided = InitializeInteractionRegressionStrided(2, features, countInstances, &targets[0], &binnedDataFloat64, nullptr);
+   CHECK(nullptr != pEbmInteractionStrided);
+   scoreStrided = 0;
+   CHECK(0 == GetInteractionScore(pEbmInteractionStrided, 2, combinationIndexes, &scoreStrided));
+   CHECK(score == scoreStrided);
+   FreeInteraction(pEbmInteractionStrided);
+   FreeInteraction(pEbmInteraction);
+
+   PEbmTraining pEbmTraining = InitializeTrainingRegression(randomSeed, 2, features, 1, combinations, combinationIndexes, countInstances, &targets[0], &featureMajor[0], nullptr, countInstances, &targets[0], &featureMajor[0], nullptr, 0);
+   PEbmTraining pEbmTrainingStrided = InitializeTrainingRegressionStrided(randomSeed, 2, features, 1, combinations, combinationIndexes, countInstances, &targets[0], &binnedData16, nullptr, countInstances, &targets[0], &binnedData8, nullptr, 0);
+   CHECK(nullptr != pEbmTrainingStrided);
+   PEbmTraining pEbmTrainingFloat64 = InitializeTrainingRegressionStrided(randomSeed, 2, features, 1, combinations, combinationIndexes, countInstances, &targets[0], &binnedDataFloat64, nullptr, countInstances, &targets[0], &binnedDataFloat64, nullptr, 0);
+   CHECK(nullptr != pEbmTrainingFloat64);
+   FractionalDataType validationMetric = 0;
+   FractionalDataType validationMetricStrided = 0;
+   FractionalDataType validationMetricFloat64 = 0;
+   CHECK(0 == TrainingStep(pEbmTraining, 0, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, nullptr, nullptr, &validationMetric));
+   CHECK(0 == TrainingStep(pEbmTrainingStrided, 0, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, nullptr, nullptr, &validationMetricStrided));
+   CHECK(0 == TrainingStep(pEbmTrainingFloat64, 0, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, nullptr, nullptr, &validationMetricFloat64));
+   CHECK(validationMetric == validationMetricStrided);
+   CHECK(validationMetric == validationMetricFloat64);
+   const FractionalDataType * const aModel = GetCurrentModelFeatureCombination(pEbmTraining, 0);
+   const FractionalDataType * const aModelStrided = GetCurrentModelFeatureCombination(pEbmTrainingStrided, 0);
+   const FractionalDataType * const aModelFloat64 = GetCurrentModelFeatureCombination(pEbmTrainingFloat64, 0);
+   for(size_t iBin = 0; iBin < 3 * 4; ++iBin) {
+      CHECK(aModel[iBin] == aModelStrided[iBin]);
+      CHECK(aModel[iBin] == aModelFloat64[iBin]);
+   }
+   FreeTraining(pEbmTrainingFloat64);
+   FreeTraining(pEbmTrainingStrided);
+   FreeTraining(pEbmTraining);
+
+   // negative strides are rejected rather than read
+   const EbmCoreBinnedData binnedDataNegativeStride = { BinnedDataTypeUInt8, -2, 1, &instanceMajor8[0] };
+   CHECK(nullptr == InitializeInteractionRegressionStrided(2, features, countInstances, &targets[0], &binnedDataNegativeStride, nullptr));
+}
+
+TEST_CASE("a shared dataset with instance subsets matches passing the subsets directly, training and interaction, multiclass") {
+   constexpr IntegerDataType countInstances = 211;
+   constexpr IntegerDataType countTargetClasses = 3;
+   EbmCoreFeature features[2];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 3;
+   features[1].featureType = FeatureTypeOrdinal;
+   features[1].hasMissing = 0;
+   features[1].countBins = 5;
+   EbmCoreFeatureCombination combinations[2];
+   combinations[0].countFeaturesInCombination = 1;
+   combinations[1].countFeaturesInCombination = 2;
+   const IntegerDataType combinationIndexes[] = { 1, 0, 1 };
+
+   std::vector<IntegerDataType> targets;
+   std::vector<uint8_t> instanceMajor;
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 3;
+      const IntegerDataType bin1 = (iInstance * 7) % 5;
+      targets.push_back((bin0 + bin1 + iInstance / 13) % countTargetClasses);
+      instanceMajor.push_back(static_cast<uint8_t>(bin0));
+      instanceMajor.push_back(static_cast<uint8_t>(bin1));
+   }
+   const EbmCoreBinnedData binnedData = { BinnedDataTypeUInt8, 2, 1, &instanceMajor[0] };
+
+   // a shuffled training subset and a validation subset that overlaps it, gathered by hand for the direct API
+   std::vector<IntegerDataType> trainingIndexes;
+   std::vector<IntegerDataType> validationIndexes;
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      if(0 != iInstance % 4) {
+         trainingIndexes.push_back((iInstance * 37) % countInstances);
+      }
+      if(0 == iInstance % 3) {
+         validationIndexes.push_back(iInstance);
+      }
+   }
+   std::vector<IntegerDataType> trainingTargets;
+   std::vector<IntegerDataType> trainingBinned;
+   for(const IntegerDataType index : trainingIndexes) {
+      trainingTargets.push_back(targets[index]);
+      trainingBinned.push_back(index % 3);
+      trainingBinned.push_back((index * 7) % 5);
+   }
+   std::vector<IntegerDataType> validationTargets;
+   std::vector<IntegerDataType> validationBinned;
+   for(const IntegerDataType index : validationIndexes) {
+      validationTargets.push_back(targets[index]);
+      validationBinned.push_back(index % 3);
+      validationBinned.push_back((index * 7) % 5);
+   }
+   const IntegerDataType countTraining = static_cast<IntegerDataType>(trainingIndexes.size());
+   const IntegerDataType countValidation = static_cast<IntegerDataType>(validationIndexes.size());
+   const EbmCoreBinnedData trainingBinnedData = { BinnedDataTypeInt64, 2, 1, &trainingBinned[0] };
+   const EbmCoreBinnedData validationBinnedData = { BinnedDataTypeInt64, 2, 1, &validationBinned[0] };
+
+   PEbmDataSet pEbmDataSet = CreateDataSetClassification(2, features, countTargetClasses, countInstances, &targets[0], &binnedData);
+   CHECK(nullptr != pEbmDataSet);
+
+   PEbmTraining pEbmTraining = InitializeTrainingClassificationStrided(randomSeed, 2, features, 2, combinations, combinationIndexes, countTargetClasses, countTraining, &trainingTargets[0], &trainingBinnedData, nullptr, countValidation, &validationTargets[0], &validationBinnedData, nullptr, 2);
+   PEbmTraining pEbmTrainingDataSet = InitializeTrainingFromDataSet(randomSeed, pEbmDataSet, 2, combinations, combinationIndexes, countTraining, &trainingIndexes[0], nullptr, countValidation, &validationIndexes[0], nullptr, 2);
+   CHECK(nullptr != pEbmTrainingDataSet);
+   for(IntegerDataType iEpoch = 0; iEpoch < 3; ++iEpoch) {
+      for(IntegerDataType iCombination = 0; iCombination < 2; ++iCombination) {
+         FractionalDataType validationMetric = 0;
+         FractionalDataType validationMetricDataSet = 0;
+         CHECK(0 == TrainingStep(pEbmTraining, iCombination, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, nullptr, nullptr, &validationMetric));
+         CHECK(0 == TrainingStep(pEbmTrainingDataSet, iCombination, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, nullptr, nullptr, &validationMetricDataSet));
+         CHECK(validationMetric == validationMetricDataSet);
+      }
+   }
+   const FractionalDataType * const aModel = GetCurrentModelFeatureCombination(pEbmTraining, 1);
+   const FractionalDataType * const aModelDataSet = GetCurrentModelFeatureCombination(pEbmTrainingDataSet, 1);
+   for(size_t iValue = 0; iValue < 3 * 5 * countTargetClasses; ++iValue) {
+      CHECK(aModel[iValue] == aModelDataSet[iValue]);
+   }
+   FreeTraining(pEbmTrainingDataSet);
+   FreeTraining(pEbmTraining);
+
+   // the interaction over every instance shares the dataset's packed data, so it has to keep working after our caller frees the dataset
+   PEbmInteraction pEbmInteractionAll = InitializeInteractionFromDataSet(pEbmDataSet, countInstances, nullptr, nullptr);
+   PEbmInteraction pEbmInteractionSubset = InitializeInteractionFromDataSet(pEbmDataSet, countTraining, &trainingIndexes[0], nullptr);
+   CHECK(nullptr != pEbmInteractionAll);
+   CHECK(nullptr != pEbmInteractionSubset);
+   // out of range indexes and a mismatched count without indexes are rejected
+   const IntegerDataType badIndexes[] = { 0, countInstances };
+   CHECK(nullptr == InitializeInteractionFromDataSet(pEbmDataSet, 2, badIndexes, nullptr));
+   CHECK(nullptr == InitializeInteractionFromDataSet(pEbmDataSet, countInstances - 1, nullptr, nullptr));
+   FreeDataSet(pEbmDataSet);
+
+   const IntegerDataType pairIndexes[] = { 0, 1 };
+   PEbmInteraction pEbmInteraction = InitializeInteractionClassificationStrided(2, features, countTargetClasses, countInstances, &targets[0], &binnedData, nullptr);
+   FractionalDataType score = 0;
+   FractionalDataType scoreDataSet = 0;
+   CHECK(0 == GetInteractionScore(pEbmInteraction, 2, pairIndexes, &score));
+   CHECK(0 == GetInteractionScore(pEbmInteractionAll, 2, pairIndexes, &scoreDataSet));
+   CHECK(0 < score);
+   CHECK(score == scoreDataSet);
+   FreeInteraction(pEbmInteraction);
+
+   pEbmInteraction = InitializeInteractionClassificationStrided(2, features, countTargetClasses, countTraining, &trainingTargets[0], &trainingBinnedData, nullptr);
+   CHECK(0 == GetInteractionScore(pEbmInteraction, 2, pairIndexes, &score));
+   CHECK(0 == GetInteractionScore(pEbmInteractionSubset, 2, pairIndexes, &scoreDataSet));
+   CHECK(score == scoreDataSet);
+   FreeInteraction(pEbmInteraction);
+
+   FreeInteraction(pEbmInteractionSubset);
+   FreeInteraction(pEbmInteractionAll);
+}
+
+TEST_CASE("a dataset written to a file and mapped back matches the dataset in memory, training and interaction, regression") {
+   constexpr IntegerDataType countInstances = 173;
+   EbmCoreFeature features[2];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 4;
+   features[1].featureType = FeatureTypeOrdinal;
+   features[1].hasMissing = 0;
+   features[1].countBins = 9;
+   EbmCoreFeatureCombination combinations[2];
+   combinations[0].countFeaturesInCombination = 1;
+   combinations[1].countFeaturesInCombination = 2;
+   const IntegerDataType combinationIndexes[] = { 0, 0, 1 };
+
+   std::vector<FractionalDataType> targets;
+   std::vector<FractionalDataType> predictorScores;
+   std::vector<IntegerDataType> binned;
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 4;
+      const IntegerDataType bin1 = (iInstance * 5) % 9;
+      targets.push_back(FractionalDataType { 0.5 } * bin0 - FractionalDataType { 0.25 } * bin1 + FractionalDataType { 0.125 } * (iInstance % 7));
+      predictorScores.push_back(FractionalDataType { 0.0625 } * (iInstance % 5));
+      binned.push_back(bin0);
+      binned.push_back(bin1);
+   }
+   const EbmCoreBinnedData binnedData = { BinnedDataTypeInt64, 2, 1, &binned[0] };
+   std::vector<IntegerDataType> validationIndexes;
+   std::vector<FractionalDataType> validationPredictorScores;
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; iInstance += 3) {
+      validationIndexes.push_back(iInstance);
+      validationPredictorScores.push_back(predictorScores[iInstance]);
+   }
+   const IntegerDataType countValidation = static_cast<IntegerDataType>(validationIndexes.size());
+
+   const char * const path = "test_core_api_dataset.ebmdata";
+   PEbmDataSet pEbmDataSet = CreateDataSetRegression(2, features, countInstances, &targets[0], &binnedData);
+   CHECK(nullptr != pEbmDataSet);
+   CHECK(0 == WriteDataSetFile(pEbmDataSet, &predictorScores[0], path));
+   PEbmDataSet pEbmDataSetMapped = OpenDataSetFile(path);
+   CHECK(nullptr != pEbmDataSetMapped);
+
+   // the mapped dataset starts from the predictor scores in the file, including the validation subset that we gather from them
+   PEbmTraining pEbmTraining = InitializeTrainingFromDataSet(randomSeed, pEbmDataSet, 2, combinations, combinationIndexes, countInstances, nullptr, &predictorScores[0], countValidation, &validationIndexes[0], &validationPredictorScores[0], 0);
+   PEbmTraining pEbmTrainingMapped = InitializeTrainingFromDataSet(randomSeed, pEbmDataSetMapped, 2, combinations, combinationIndexes, countInstances, nullptr, nullptr, countValidation, &validationIndexes[0], nullptr, 0);
+   CHECK(nullptr != pEbmTrainingMapped);
+   PEbmInteraction pEbmInteraction = InitializeInteractionFromDataSet(pEbmDataSet, countInstances, nullptr, &predictorScores[0]);
+   PEbmInteraction pEbmInteractionMapped = InitializeInteractionFromDataSet(pEbmDataSetMapped, countInstances, nullptr, nullptr);
+   CHECK(nullptr != pEbmInteractionMapped);
+   // the states keep the mapping alive after our caller frees the dataset
+   FreeDataSet(pEbmDataSetMapped);
+   FreeDataSet(pEbmDataSet);
+
+   for(IntegerDataType iEpoch = 0; iEpoch < 3; ++iEpoch) {
+      for(IntegerDataType iCombination = 0; iCombination < 2; ++iCombination) {
+         FractionalDataType validationMetric = 0;
+         FractionalDataType validationMetricMapped = 0;
+         CHECK(0 == TrainingStep(pEbmTraining, iCombination, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, nullptr, nullptr, &validationMetric));
+         CHECK(0 == TrainingStep(pEbmTrainingMapped, iCombination, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, nullptr, nullptr, &validationMetricMapped));
+         CHECK(validationMetric == validationMetricMapped);
+      }
+   }
+   const FractionalDataType * const aModel = GetCurrentModelFeatureCombination(pEbmTraining, 1);
+   const FractionalDataType * const aModelMapped = GetCurrentModelFeatureCombination(pEbmTrainingMapped, 1);
+   for(size_t iValue = 0; iValue < 4 * 9; ++iValue) {
+      CHECK(aModel[iValue] == aModelMapped[iValue]);
+   }
+   FreeTraining(pEbmTrainingMapped);
+   FreeTraining(pEbmTraining);
+
+   const IntegerDataType pairIndexes[] = { 0, 1 };
+   FractionalDataType score = 0;
+   FractionalDataType scoreMapped = 0;
+   CHECK(0 == GetInteractionScore(pEbmInteraction, 2, pairIndexes, &score));
+   CHECK(0 == GetInteractionScore(pEbmInteractionMapped, 2, pairIndexes, &scoreMapped));
+   CHECK(0 < score);
+   CHECK(score == scoreMapped);
+   FreeInteraction(pEbmInteractionMapped);
+   FreeInteraction(pEbmInteraction);
+
+   // a missing file and a file that isn't a dataset are rejected
+   CHECK(nullptr == OpenDataSetFile("test_core_api_missing.ebmdata"));
+   FILE * const pFile = fopen(path, "wb");
+   CHECK(nullptr != pFile);
+   const char garbage[64] = { 'n', 'o', 't', ' ', 'a', ' ', 'd', 'a', 't', 'a', 's', 'e', 't' };
+   CHECK(1 == fwrite(garbage, sizeof(garbage), 1, pFile));
+   fclose(pFile);
+   CHECK(nullptr == OpenDataSetFile(path));
+   remove(path);
+}
+
+TEST_CASE("a dataset file with targets or bins out of range is rejected, classification") {
+   constexpr IntegerDataType countInstances = 5;
+   EbmCoreFeature features[1];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 3;
+   const IntegerDataType targets[] = { 0, 1, 1, 0, 1 };
+   const IntegerDataType binned[] = { 0, 1, 2, 2, 1 };
+   const EbmCoreBinnedData binnedData = { BinnedDataTypeInt64, 1, 1, binned };
+
+   const char * const path = "test_core_api_corrupt.ebmdata";
+   PEbmDataSet pEbmDataSet = CreateDataSetClassification(1, features, 2, countInstances, targets, &binnedData);
+   CHECK(nullptr != pEbmDataSet);
+   CHECK(0 == WriteDataSetFile(pEbmDataSet, nullptr, path));
+   FreeDataSet(pEbmDataSet);
+   PEbmDataSet pEbmDataSetMapped = OpenDataSetFile(path);
+   CHECK(nullptr != pEbmDataSetMapped);
+   FreeDataSet(pEbmDataSetMapped);
+
+   FILE * pFile = fopen(path, "rb");
+   CHECK(nullptr != pFile);
+   std::vector<char> fileBytes(4096);
+   fileBytes.resize(fread(&fileBytes[0], 1, fileBytes.size(), pFile));
+   fclose(pFile);
+
+   const auto OpenCorrupted = [&](const size_t iByte, const std::vector<char> & bytes) {
+      std::vector<char> corrupted = fileBytes;
+      memcpy(&corrupted[iByte], &bytes[0], bytes.size());
+      FILE * const pCorruptedFile = fopen(path, "wb");
+      CHECK(nullptr != pCorruptedFile);
+      CHECK(1 == fwrite(&corrupted[0], corrupted.size(), 1, pCorruptedFile));
+      fclose(pCorruptedFile);
+      PEbmDataSet pEbmDataSetCorrupted = OpenDataSetFile(path);
+      if(nullptr == pEbmDataSetCorrupted) {
+         return false;
+      }
+      FreeDataSet(pEbmDataSetCorrupted);
+      return true;
+   };
+
+   // the targets follow the header, which is 8 bytes of magic and 6 integers, and the feature
+   const size_t iTargets = 8 + 6 * sizeof(IntegerDataType) + sizeof(EbmCoreFeature);
+   const IntegerDataType badClass = 2;
+   CHECK(!OpenCorrupted(iTargets + 3 * sizeof(IntegerDataType), std::vector<char>(reinterpret_cast<const char *>(&badClass), reinterpret_cast<const char *>(&badClass + 1))));
+   const IntegerDataType negativeClass = -1;
+   CHECK(!OpenCorrupted(iTargets, std::vector<char>(reinterpret_cast<const char *>(&negativeClass), reinterpret_cast<const char *>(&negativeClass + 1))));
+
+   // the file ends with the single data unit of the only column.  3 bins take 2 bits per item, so setting the bits of the last instance reads bin 3
+   const size_t iColumn = fileBytes.size() - sizeof(size_t);
+   std::vector<char> column(fileBytes.begin() + iColumn, fileBytes.end());
+   size_t packed;
+   memcpy(&packed, &column[0], sizeof(packed));
+   packed |= size_t { 3 } << (2 * (countInstances - 1));
+   memcpy(&column[0], &packed, sizeof(packed));
+   CHECK(!OpenCorrupted(iColumn, column));
+
+   remove(path);
+}
+
+TEST_CASE("vectorized binary log loss and residuals match the scalar formulas, training, binary") {
+   // enough instances for several vector blocks plus a partial vector, with log odds that reach far into the tails of exp
+   constexpr IntegerDataType countInstances = 1003;
+   constexpr IntegerDataType countBins = 7;
+   const std::vector<FractionalDataType> update = { -3, -1.5, -0.25, 0, 0.5, 2, 9 };
+   std::vector<ClassificationInstance> instances;
+   std::vector<FractionalDataType> logOdds;
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const IntegerDataType bin0 = (iInstance * 5) % countBins;
+      const IntegerDataType target = (iInstance / 3) % 2;
+      const FractionalDataType priorLogOdds = FractionalDataType { -60 } + FractionalDataType { 120 } * iInstance / (countInstances - 1);
+      instances.push_back(ClassificationInstance(target, { bin0 }, { 0, priorLogOdds }));
+      logOdds.push_back(priorLogOdds + update[bin0]);
+   }
+
+   TestApi test = TestApi(2);
+   test.AddFeatures({ FeatureTest(countBins) });
+   test.AddFeatureCombinations({ { 0 }, {} });
+   test.AddTrainingInstances(instances);
+   test.AddValidationInstances(instances);
+   test.InitializeTraining(0);
+
+   const FractionalDataType validationMetric = test.ApplyUpdate(0, update);
+   FractionalDataType sumLogLoss = 0;
+   FractionalDataType sumResidualError = 0;
+   FractionalDataType sumDenominator = 0;
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const bool bTargetZero = 0 == (iInstance / 3) % 2;
+      sumLogLoss += std::log(1 + std::exp(bTargetZero ? logOdds[iInstance] : -logOdds[iInstance]));
+      const FractionalDataType residualError = (bTargetZero ? -1 : 1) / (1 + std::exp(bTargetZero ? -logOdds[iInstance] : logOdds[iInstance]));
+      sumResidualError += residualError;
+      sumDenominator += std::abs(residualError) * (1 - std::abs(residualError));
+   }
+   CHECK(IsApproxEqual(validationMetric, sumLogLoss, 1e-13 * k_residualPrecisionScale));
+
+   // the update for a zero feature combination is a single Newton-Raphson step on the residuals that ApplyUpdate left behind
+   test.Train(1, {}, {}, 1);
+   CHECK(IsApproxEqual(test.GetCurrentModelPredictorScore(1, {}, 1), sumResidualError / sumDenominator, 1e-12 * k_residualPrecisionScale));
+}
+
+TEST_CASE("float residuals stay close to the double results, training, binary") {
+   // the expected values come from the default build, which stores residuals and scores as doubles.  A build with EBM_FLOAT_RESIDUALS has to stay
+   // within 1e-6 of them after 150 boosting steps, which is about 10 times the largest difference we've seen.  The default build itself should
+   // only differ from them in the last few digits, whatever vector instructions it uses
+#ifdef EBM_FLOAT_RESIDUALS
+   constexpr double tolerance = 1e-6;
+#else // EBM_FLOAT_RESIDUALS
+   constexpr double tolerance = 1e-12;
+#endif // EBM_FLOAT_RESIDUALS
+
+   std::vector<ClassificationInstance> trainingInstances;
+   std::vector<ClassificationInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 2000; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 8;
+      const IntegerDataType bin1 = (iInstance * 3) % 5;
+      trainingInstances.push_back(ClassificationInstance(0 == (bin0 + bin1 + iInstance / 250) % 3 ? 1 : 0, { bin0, bin1 }));
+      const IntegerDataType validationBin0 = (iInstance * 7) % 8;
+      const IntegerDataType validationBin1 = iInstance % 5;
+      validationInstances.push_back(ClassificationInstance(0 == (validationBin0 * validationBin1 + iInstance / 400) % 3 ? 1 : 0, { validationBin0, validationBin1 }));
+   }
+
+   TestApi test = TestApi(2);
+   test.AddFeatures({ FeatureTest(8), FeatureTest(5) });
+   test.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   test.AddTrainingInstances(trainingInstances);
+   test.AddValidationInstances(validationInstances);
+   test.InitializeTraining(0);
+
+   FractionalDataType validationMetric = 0;
+   for(int iEpoch = 0; iEpoch < 50; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+         validationMetric = test.Train(iFeatureCombination);
+      }
+   }
+   CHECK(IsApproxEqual(validationMetric, 1307.9176635884421, tolerance));
+   CHECK(IsApproxEqual(test.GetCurrentModelPredictorScore(0, { 0 }, 1), -0.19728369164673257, tolerance));
+   CHECK(IsApproxEqual(test.GetCurrentModelPredictorScore(0, { 2 }, 1), -0.16383511681468979, tolerance));
+   CHECK(IsApproxEqual(test.GetCurrentModelPredictorScore(0, { 5 }, 1), -0.15378591929302352, tolerance));
+   CHECK(IsApproxEqual(test.GetCurrentModelPredictorScore(2, { 0, 0 }, 1), -0.15791078867599015, tolerance));
+   CHECK(IsApproxEqual(test.GetCurrentModelPredictorScore(2, { 7, 0 }, 1), -0.24640086098254349, tolerance));
+   CHECK(IsApproxEqual(test.GetCurrentModelPredictorScore(2, { 4, 3 }, 1), -0.18344999426785388, tolerance));
+}
+
+TEST_CASE("vectorized split sweep picks the first of tied split points, training, regression") {
+   // 19 split points covers whole vectors and leftovers for every vector width.  Cutting after bin 4 or after bin 14 gives exactly the same gain
+   constexpr IntegerDataType countBins = 20;
+   TestApi test = TestApi(k_learningTypeRegression);
+   test.AddFeatures({ FeatureTest(countBins) });
+   test.AddFeatureCombinations({ { 0 } });
+   std::vector<RegressionInstance> instances;
+   for(IntegerDataType iBin = 0; iBin < countBins; ++iBin) {
+      instances.push_back(RegressionInstance(iBin < 5 ? 1 : countBins - 5 <= iBin ? -1 : 0, { iBin }));
+   }
+   test.AddTrainingInstances(instances);
+   test.AddValidationInstances({ RegressionInstance(0, { 0 }) });
+   test.InitializeTraining();
+
+   test.Train(0, {}, {}, k_learningRateDefault, 1);
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { 0 }, 0), k_learningRateDefault);
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { 4 }, 0), k_learningRateDefault);
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { 5 }, 0), k_learningRateDefault * -5 / 15);
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { countBins - 1 }, 0), k_learningRateDefault * -5 / 15);
+}
+
+TEST_CASE("vectorized split sweep finds the best split point, training, binary") {
+   constexpr IntegerDataType countBins = 37;
+   TestApi test = TestApi(2);
+   test.AddFeatures({ FeatureTest(countBins) });
+   test.AddFeatureCombinations({ { 0 } });
+   std::vector<ClassificationInstance> instances;
+   for(IntegerDataType iBin = 0; iBin < countBins; ++iBin) {
+      instances.push_back(ClassificationInstance(iBin < 23 ? 0 : 1, { iBin }));
+   }
+   test.AddTrainingInstances(instances);
+   test.AddValidationInstances({ ClassificationInstance(0, { 0 }) });
+   test.InitializeTraining();
+
+   test.Train(0, {}, {}, k_learningRateDefault, 1);
+   // every instance starts at a log odds of zero, so each residual is +-0.5 and each denominator is 0.25
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { 0 }, 1), k_learningRateDefault * -0.5 / 0.25);
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { 22 }, 1), k_learningRateDefault * -0.5 / 0.25);
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { 23 }, 1), k_learningRateDefault * 0.5 / 0.25);
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { countBins - 1 }, 1), k_learningRateDefault * 0.5 / 0.25);
+}
+
+TEST_CASE("every bag of a single instance draws it exactly once, training, regression") {
+   TestApi testBagged = TestApi(k_learningTypeRegression);
+   testBagged.AddFeatures({ FeatureTest(2) });
+   testBagged.AddFeatureCombinations({ { 0 } });
+   testBagged.AddTrainingInstances({ RegressionInstance(10, { 1 }) });
+   testBagged.AddValidationInstances({ RegressionInstance(12, { 1 }) });
+   testBagged.InitializeTraining(10);
+
+   TestApi testFlat = TestApi(k_learningTypeRegression);
+   testFlat.AddFeatures({ FeatureTest(2) });
+   testFlat.AddFeatureCombinations({ { 0 } });
+   testFlat.AddTrainingInstances({ RegressionInstance(10, { 1 }) });
+   testFlat.AddValidationInstances({ RegressionInstance(12, { 1 }) });
+   testFlat.InitializeTraining(0);
+
+   for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+      const FractionalDataType validationMetricBagged = testBagged.Train(0);
+      const FractionalDataType validationMetricFlat = testFlat.Train(0);
+      CHECK_APPROX(validationMetricBagged, validationMetricFlat);
+   }
+   CHECK_APPROX(testBagged.GetCurrentModelPredictorScore(0, { 1 }, 0), testFlat.GetCurrentModelPredictorScore(0, { 1 }, 0));
+}
+
+TEST_CASE("bagged models depend only on the random seed, training, regression") {
+   std::vector<RegressionInstance> trainingInstances;
+   std::vector<RegressionInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 200; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 7;
+      const FractionalDataType target = static_cast<FractionalDataType>(bin0) + static_cast<FractionalDataType>(iInstance % 5) * 0.5;
+      trainingInstances.push_back(RegressionInstance(target, { bin0 }));
+      validationInstances.push_back(RegressionInstance(target + 0.25, { bin0 }));
+   }
+
+   TestApi testSeedA = TestApi(k_learningTypeRegression);
+   testSeedA.AddFeatures({ FeatureTest(7) });
+   testSeedA.AddFeatureCombinations({ { 0 } });
+   testSeedA.AddTrainingInstances(trainingInstances);
+   testSeedA.AddValidationInstances(validationInstances);
+   testSeedA.InitializeTraining(6, 42);
+
+   TestApi testSeedARepeat = TestApi(k_learningTypeRegression);
+   testSeedARepeat.AddFeatures({ FeatureTest(7) });
+   testSeedARepeat.AddFeatureCombinations({ { 0 } });
+   testSeedARepeat.AddTrainingInstances(trainingInstances);
+   testSeedARepeat.AddValidationInstances(validationInstances);
+   testSeedARepeat.InitializeTraining(6, 42);
+
+   TestApi testSeedB = TestApi(k_learningTypeRegression);
+   testSeedB.AddFeatures({ FeatureTest(7) });
+   testSeedB.AddFeatureCombinations({ { 0 } });
+   testSeedB.AddTrainingInstances(trainingInstances);
+   testSeedB.AddValidationInstances(validationInstances);
+   testSeedB.InitializeTraining(6, 12345);
+
+   for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+      const FractionalDataType validationMetricA = testSeedA.Train(0);
+      const FractionalDataType validationMetricARepeat = testSeedARepeat.Train(0);
+      CHECK(validationMetricA == validationMetricARepeat);
+      testSeedB.Train(0);
+   }
+   bool bAnyDifferent = false;
+   for(size_t bin0 = 0; bin0 < 7; ++bin0) {
+      const FractionalDataType scoreA = testSeedA.GetCurrentModelPredictorScore(0, { bin0 }, 0);
+      CHECK(scoreA == testSeedARepeat.GetCurrentModelPredictorScore(0, { bin0 }, 0));
+      bAnyDifferent = bAnyDifferent || scoreA != testSeedB.GetCurrentModelPredictorScore(0, { bin0 }, 0);
+   }
+   CHECK(bAnyDifferent);
+}
+
+TEST_CASE("precomputed denominators do not change the model, training, binary") {
+   std::vector<ClassificationInstance> trainingInstances;
+   std::vector<ClassificationInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 300; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 7;
+      const IntegerDataType bin1 = (iInstance * 13) % 5;
+      trainingInstances.push_back(ClassificationInstance((bin0 + bin1 + iInstance / 100) % 2, { bin0, bin1 }));
+      validationInstances.push_back(ClassificationInstance((bin0 * bin1) % 2, { bin0, bin1 }));
+   }
+
+   TestApi testComputed = TestApi(2);
+   testComputed.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testComputed.AddFeatureCombinations({ {}, { 0 }, { 0, 1 } });
+   testComputed.AddTrainingInstances(trainingInstances);
+   testComputed.AddValidationInstances(validationInstances);
+   testComputed.InitializeTraining(4);
+
+   TestApi testPrecomputed = TestApi(2);
+   testPrecomputed.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testPrecomputed.AddFeatureCombinations({ {}, { 0 }, { 0, 1 } });
+   testPrecomputed.AddTrainingInstances(trainingInstances);
+   testPrecomputed.AddValidationInstances(validationInstances);
+   testPrecomputed.InitializeTraining(4);
+   testPrecomputed.SetPrecomputedDenominators(true);
+
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+         const FractionalDataType validationMetricComputed = testComputed.Train(iFeatureCombination);
+         const FractionalDataType validationMetricPrecomputed = testPrecomputed.Train(iFeatureCombination);
+         CHECK_APPROX(validationMetricComputed, validationMetricPrecomputed);
+      }
+   }
+   for(size_t bin0 = 0; bin0 < 7; ++bin0) {
+      for(size_t bin1 = 0; bin1 < 5; ++bin1) {
+         for(size_t iClass = 0; iClass < 2; ++iClass) {
+            CHECK_APPROX(testComputed.GetCurrentModelPredictorScore(2, { bin0, bin1 }, iClass), testPrecomputed.GetCurrentModelPredictorScore(2, { bin0, bin1 }, iClass));
+         }
+      }
+   }
+}
+
+TEST_CASE("precomputed denominators do not change the model, training, multiclass") {
+   std::vector<ClassificationInstance> trainingInstances;
+   std::vector<ClassificationInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 300; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 7;
+      const IntegerDataType bin1 = (iInstance * 13) % 5;
+      trainingInstances.push_back(ClassificationInstance((bin0 + bin1 + iInstance / 100) % 3, { bin0, bin1 }));
+      validationInstances.push_back(ClassificationInstance((bin0 * bin1) % 3, { bin0, bin1 }));
+   }
+
+   TestApi testComputed = TestApi(3);
+   testComputed.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testComputed.AddFeatureCombinations({ {}, { 0 }, { 0, 1 } });
+   testComputed.AddTrainingInstances(trainingInstances);
+   testComputed.AddValidationInstances(validationInstances);
+   testComputed.InitializeTraining(4);
+
+   TestApi testPrecomputed = TestApi(3);
+   testPrecomputed.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testPrecomputed.AddFeatureCombinations({ {}, { 0 }, { 0, 1 } });
+   testPrecomputed.AddTrainingInstances(trainingInstances);
+   testPrecomputed.AddValidationInstances(validationInstances);
+   testPrecomputed.InitializeTraining(4);
+   testPrecomputed.SetPrecomputedDenominators(true);
+
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+         const FractionalDataType validationMetricComputed = testComputed.Train(iFeatureCombination);
+         const FractionalDataType validationMetricPrecomputed = testPrecomputed.Train(iFeatureCombination);
+         CHECK_APPROX(validationMetricComputed, validationMetricPrecomputed);
+      }
+   }
+   for(size_t bin0 = 0; bin0 < 7; ++bin0) {
+      for(size_t bin1 = 0; bin1 < 5; ++bin1) {
+         for(size_t iClass = 0; iClass < 3; ++iClass) {
+            CHECK_APPROX(testComputed.GetCurrentModelPredictorScore(2, { bin0, bin1 }, iClass), testPrecomputed.GetCurrentModelPredictorScore(2, { bin0, bin1 }, iClass));
+         }
+      }
+   }
+}
+
+#ifdef EBM_TEST_HOOKS
+TEST_CASE("steady state boosting makes no heap allocations, training, multiclass") {
+   // the -test_hooks library counts its own allocations in builds that can, and returns -1 in builds that can't
+   if(GetHeapAllocationCount() < 0) {
+      return;
+   }
+   // enough instances that both the binning (65536 per chunk) and the updates of the training and validation sets (32768 per chunk) are split
+   // into chunks that run on several threads, both with the single sampling set that we get without inner bags and with one per inner bag
+   std::vector<ClassificationInstance> trainingInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 140000; ++iInstance) {
+      trainingInstances.push_back(ClassificationInstance((iInstance % 13 + iInstance % 5) % 3, { iInstance % 13, iInstance * 3 % 7 }));
+   }
+   std::vector<ClassificationInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 70000; ++iInstance) {
+      validationInstances.push_back(ClassificationInstance((iInstance % 11 + iInstance % 3) % 3, { iInstance * 5 % 13, iInstance % 7 }));
+   }
+   for(const IntegerDataType countInnerBags : { IntegerDataType { 0 }, IntegerDataType { 3 } }) {
+      TestApi test = TestApi(3);
+      test.AddFeatures({ FeatureTest(13), FeatureTest(7) });
+      test.AddFeatureCombinations({ { 0 }, { 0, 1 } });
+      test.AddTrainingInstances(trainingInstances);
+      test.AddValidationInstances(validationInstances);
+      test.InitializeTraining(countInnerBags);
+      test.SetTrainingThreads(4);
+
+      // the first steps grow the thread buffers and the tensors that hold each update to the sizes that this data needs
+      for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+         test.Train(0, {}, {}, k_learningRateDefault, 3);
+         test.Train(1, {}, {}, k_learningRateDefault, 3);
+      }
+      const IntegerDataType countHeapAllocationsBefore = GetHeapAllocationCount();
+      for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+         test.Train(0, {}, {}, k_learningRateDefault, 3);
+         test.Train(1, {}, {}, k_learningRateDefault, 3);
+      }
+      CHECK(countHeapAllocationsBefore == GetHeapAllocationCount());
+   }
+}
+
+// the validation metric of every step and the final model, trained with whichever kernels the library is using
+static std::vector<FractionalDataType> TrainWithCurrentKernels(const IntegerDataType learningTypeOrCountTargetClasses) {
+   // 2 inner bags so that the instances are binned with counts other than 1, and pairs so that the totals are built.  The features have different
+   // numbers of bins so that the pairs have different bit packings
+   TestApi test = TestApi(learningTypeOrCountTargetClasses);
+   test.AddFeatures({ FeatureTest(11), FeatureTest(6), FeatureTest(3) });
+   test.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 }, { 1, 2 } });
+   std::vector<RegressionInstance> regressionTrainingInstances;
+   std::vector<RegressionInstance> regressionValidationInstances;
+   std::vector<ClassificationInstance> classificationTrainingInstances;
+   std::vector<ClassificationInstance> classificationValidationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 1000; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 11;
+      const IntegerDataType bin1 = (iInstance * 7) % 6;
+      const IntegerDataType bin2 = (iInstance / 5) % 3;
+      regressionTrainingInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(bin0 * bin1 + bin2) * 0.125 + static_cast<FractionalDataType>(iInstance % 17) * 0.03, { bin0, bin1, bin2 }));
+      regressionValidationInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(bin0 * bin1) * 0.125, { (bin0 * 3) % 11, bin1, bin2 }));
+      classificationTrainingInstances.push_back(ClassificationInstance((bin0 * bin1 + bin2 + iInstance / 100) % 2, { bin0, bin1, bin2 }));
+      classificationValidationInstances.push_back(ClassificationInstance((bin0 + bin1) % 2, { (bin0 * 3) % 11, bin1, bin2 }));
+   }
+   if(k_learningTypeRegression == learningTypeOrCountTargetClasses) {
+      test.AddTrainingInstances(regressionTrainingInstances);
+      test.AddValidationInstances(regressionValidationInstances);
+   } else {
+      test.AddTrainingInstances(classificationTrainingInstances);
+      test.AddValidationInstances(classificationValidationInstances);
+   }
+   test.InitializeTraining(2);
+
+   // a binary model has a single logit, which is the score of class 1
+   const size_t iScore = k_learningTypeRegression == learningTypeOrCountTargetClasses ? 0 : 1;
+   std::vector<FractionalDataType> results;
+   for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 4; ++iFeatureCombination) {
+         results.push_back(test.Train(iFeatureCombination));
+      }
+   }
+   for(size_t bin0 = 0; bin0 < 11; ++bin0) {
+      for(size_t bin1 = 0; bin1 < 6; ++bin1) {
+         results.push_back(test.GetCurrentModelPredictorScore(2, { bin0, bin1 }, iScore));
+      }
+   }
+   for(size_t bin1 = 0; bin1 < 6; ++bin1) {
+      for(size_t bin2 = 0; bin2 < 3; ++bin2) {
+         results.push_back(test.GetCurrentModelPredictorScore(3, { bin1, bin2 }, iScore));
+      }
+   }
+   return results;
+}
+
+TEST_CASE("every instruction set trains the same model as the scalar kernels, training, regression and binary") {
+   constexpr IntegerDataType k_instructionSetScalar = 0;
+   constexpr IntegerDataType k_instructionSetSse2 = 1;
+   constexpr IntegerDataType k_instructionSetAvx512 = 3;
+
+   CHECK(0 == SetInstructionSet(k_instructionSetScalar));
+   const std::vector<FractionalDataType> regressionScalar = TrainWithCurrentKernels(k_learningTypeRegression);
+   const std::vector<FractionalDataType> binaryScalar = TrainWithCurrentKernels(2);
+   std::vector<FractionalDataType> binarySse2;
+   for(IntegerDataType instructionSet = k_instructionSetSse2; instructionSet <= k_instructionSetAvx512; ++instructionSet) {
+      if(0 != SetInstructionSet(instructionSet)) {
+         // this build or processor doesn't have it, and so it doesn't have any wider one either
+         break;
+      }
+      // regression has no exp or log, so its histograms, totals and splits are exactly those of the scalar kernels
+      CHECK(regressionScalar == TrainWithCurrentKernels(k_learningTypeRegression));
+
+      // the vector kernels approximate exp and log within a couple of ULP of the standard library, and every vector width computes the same approximation
+      const std::vector<FractionalDataType> binary = TrainWithCurrentKernels(2);
+      if(binarySse2.empty()) {
+         binarySse2 = binary;
+      }
+      CHECK(binarySse2 == binary);
+      CHECK(binaryScalar.size() == binary.size());
+      for(size_t iResult = 0; iResult < binary.size() && iResult < binaryScalar.size(); ++iResult) {
+         CHECK(IsApproxEqual(binary[iResult], binaryScalar[iResult], 1e-11 * k_residualPrecisionScale));
+      }
+   }
+   CHECK(0 == SetInstructionSet(-1));
+}
+#endif // EBM_TEST_HOOKS
+
+TEST_CASE("batched interaction scores match scoring one pair at a time, interaction, binary") {
+   std::vector<ClassificationInstance> instances;
+   for(IntegerDataType iInstance = 0; iInstance < 300; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 3;
+      const IntegerDataType bin1 = (iInstance * 7) % 4;
+      const IntegerDataType bin2 = (iInstance * 11) % 5;
+      const IntegerDataType bin3 = (iInstance / 7) % 2;
+      instances.push_back(ClassificationInstance((bin0 * bin1 + bin3) % 2, { bin0, bin1, bin2, bin3, 0 }));
+   }
+
+   TestApi test = TestApi(2);
+   test.AddFeatures({ FeatureTest(3), FeatureTest(4), FeatureTest(5), FeatureTest(2), FeatureTest(1) });
+   test.AddInteractionInstances(instances);
+   test.InitializeInteraction();
+
+   std::vector<std::vector<IntegerDataType>> pairs;
+   std::vector<FractionalDataType> scoresOneAtATime;
+   for(IntegerDataType iFeature1 = 0; iFeature1 < 5; ++iFeature1) {
+      for(IntegerDataType iFeature2 = iFeature1 + 1; iFeature2 < 5; ++iFeature2) {
+         pairs.push_back({ iFeature1, iFeature2 });
+         scoresOneAtATime.push_back(test.InteractionScore({ iFeature1, iFeature2 }));
+      }
+   }
+
+   test.SetInteractionThreads(1);
+   const std::vector<FractionalDataType> scores1 = test.InteractionScores(pairs);
+   test.SetInteractionThreads(4);
+   const std::vector<FractionalDataType> scoresMany = test.InteractionScores(pairs);
+   CHECK(scoresOneAtATime == scores1);
+   CHECK(scoresOneAtATime == scoresMany);
+
+   std::vector<size_t> order;
+   for(size_t iPair = 0; iPair < pairs.size(); ++iPair) {
+      order.push_back(iPair);
+   }
+   std::stable_sort(order.begin(), order.end(), [&](const size_t iLeft, const size_t iRight) {
+      return scoresOneAtATime[iRight] < scoresOneAtATime[iLeft];
+   });
+   std::vector<IntegerDataType> topCombinationIndexes;
+   const std::vector<FractionalDataType> topScores = test.InteractionScores(pairs, 4, &topCombinationIndexes);
+   CHECK(4 == topScores.size());
+   for(size_t iTop = 0; iTop < topScores.size(); ++iTop) {
+      CHECK(static_cast<IntegerDataType>(order[iTop]) == topCombinationIndexes[iTop]);
+      CHECK(scoresOneAtATime[order[iTop]] == topScores[iTop]);
+   }
+   // asking for more than there are returns all of them
+   const std::vector<FractionalDataType> allScores = test.InteractionScores(pairs, 100, &topCombinationIndexes);
+   CHECK(pairs.size() == allScores.size());
+   CHECK(static_cast<IntegerDataType>(order.back()) == topCombinationIndexes.back());
+}
+
+TEST_CASE("BoostCycles matches boosting one step at a time, training, regression") {
+   std::vector<RegressionInstance> trainingInstances;
+   std::vector<RegressionInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 100; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 4;
+      const IntegerDataType bin1 = (iInstance * 7) % 3;
+      trainingInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(bin0 + 2 * bin1), { bin0, bin1 }));
+      validationInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(bin0 + 2 * bin1) + 0.5, { bin0, bin1 }));
+   }
+
+   TestApi testCycles = TestApi(k_learningTypeRegression);
+   testCycles.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testCycles.AddFeatureCombinations({ { 0 }, { 1 } });
+   testCycles.AddTrainingInstances(trainingInstances);
+   testCycles.AddValidationInstances(validationInstances);
+   testCycles.InitializeTraining();
+
+   TestApi testSteps = TestApi(k_learningTypeRegression);
+   testSteps.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testSteps.AddFeatureCombinations({ { 0 }, { 1 } });
+   testSteps.AddTrainingInstances(trainingInstances);
+   testSteps.AddValidationInstances(validationInstances);
+   testSteps.InitializeTraining();
+
+   constexpr IntegerDataType countEpisodes = 5000;
+   constexpr IntegerDataType earlyStoppingRunLength = 10;
+   constexpr FractionalDataType earlyStoppingTolerance = 1e-5;
+
+   IntegerDataType countEpisodesCycles = -1;
+   const FractionalDataType validationMetricCycles = testCycles.Boost({ 1, 0 }, countEpisodes, earlyStoppingRunLength, earlyStoppingTolerance, &countEpisodesCycles);
+
+   // the same early stopping rule, driven from out here
+   FractionalDataType validationMetricSteps = std::numeric_limits<FractionalDataType>::infinity();
+   FractionalDataType validationMetricMin = std::numeric_limits<FractionalDataType>::infinity();
+   FractionalDataType validationMetricBreakpoint = std::numeric_limits<FractionalDataType>::infinity();
+   IntegerDataType cNoChangeRunLength = 0;
+   IntegerDataType countEpisodesSteps = 0;
+   while(countEpisodesSteps < countEpisodes) {
+      testSteps.Train(1);
+      validationMetricSteps = testSteps.Train(0);
+      ++countEpisodesSteps;
+      validationMetricMin = validationMetricSteps < validationMetricMin ? validationMetricSteps : validationMetricMin;
+      if(0 == cNoChangeRunLength) {
+         validationMetricBreakpoint = validationMetricMin;
+      }
+      if(validationMetricSteps + earlyStoppingTolerance < validationMetricBreakpoint) {
+         cNoChangeRunLength = 0;
+      } else {
+         ++cNoChangeRunLength;
+      }
+      if(earlyStoppingRunLength <= cNoChangeRunLength) {
+         break;
+      }
+   }
+
+   // we should have stopped early, otherwise this test isn't testing the early stopping
+   CHECK(countEpisodesSteps < countEpisodes);
+   CHECK(countEpisodesSteps == countEpisodesCycles);
+   CHECK(validationMetricSteps == validationMetricCycles);
+   for(size_t bin0 = 0; bin0 < 4; ++bin0) {
+      CHECK(testSteps.GetCurrentModelPredictorScore(0, { bin0 }, 0) == testCycles.GetCurrentModelPredictorScore(0, { bin0 }, 0));
+      CHECK(testSteps.GetBestModelPredictorScore(0, { bin0 }, 0) == testCycles.GetBestModelPredictorScore(0, { bin0 }, 0));
+   }
+   for(size_t bin1 = 0; bin1 < 3; ++bin1) {
+      CHECK(testSteps.GetCurrentModelPredictorScore(1, { bin1 }, 0) == testCycles.GetCurrentModelPredictorScore(1, { bin1 }, 0));
+   }
+}
+
+TEST_CASE("BoostCycles without early stopping runs every episode, training, binary") {
+   TestApi test = TestApi(2);
+   test.AddFeatures({ FeatureTest(2) });
+   test.AddFeatureCombinations({ { 0 } });
+   test.AddTrainingInstances({ ClassificationInstance(0, { 0 }), ClassificationInstance(1, { 1 }) });
+   test.AddValidationInstances({ ClassificationInstance(0, { 0 }), ClassificationInstance(1, { 1 }) });
+   test.InitializeTraining();
+
+   IntegerDataType countEpisodesReturn = -1;
+   const FractionalDataType validationMetric = test.Boost({ 0 }, 100, -1, 0, &countEpisodesReturn);
+   CHECK(100 == countEpisodesReturn);
+   CHECK(validationMetric < std::log(2.0));
+
+   countEpisodesReturn = -1;
+   test.Boost({ 0 }, 0, -1, 0, &countEpisodesReturn);
+   CHECK(0 == countEpisodesReturn);
+}
+
+TEST_CASE("BoostCycles bins each next feature combination while applying the update, training, multiclass") {
+   std::vector<ClassificationInstance> trainingInstances;
+   std::vector<ClassificationInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 300; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 7;
+      const IntegerDataType bin1 = (iInstance * 13) % 5;
+      trainingInstances.push_back(ClassificationInstance((bin0 + bin1 + iInstance / 100) % 3, { bin0, bin1 }));
+      validationInstances.push_back(ClassificationInstance((bin0 * bin1) % 3, { bin0, bin1 }));
+   }
+
+   TestApi testCycles = TestApi(3);
+   testCycles.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testCycles.AddFeatureCombinations({ {}, { 0 }, { 0, 1 } });
+   testCycles.AddTrainingInstances(trainingInstances);
+   testCycles.AddValidationInstances(validationInstances);
+   testCycles.InitializeTraining(4);
+
+   TestApi testSteps = TestApi(3);
+   testSteps.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testSteps.AddFeatureCombinations({ {}, { 0 }, { 0, 1 } });
+   testSteps.AddTrainingInstances(trainingInstances);
+   testSteps.AddValidationInstances(validationInstances);
+   testSteps.InitializeTraining(4);
+
+   const std::vector<IntegerDataType> featureCombinationIndexes = { 2, 0, 1 };
+   IntegerDataType countEpisodesReturn = -1;
+   const FractionalDataType validationMetricCycles = testCycles.Boost(featureCombinationIndexes, 5, -1, 0, &countEpisodesReturn, 2);
+   CHECK(5 == countEpisodesReturn);
+
+   FractionalDataType validationMetricSteps = 0;
+   for(int iEpisode = 0; iEpisode < 5; ++iEpisode) {
+      for(const IntegerDataType indexFeatureCombination : featureCombinationIndexes) {
+         for(int iStep = 0; iStep < 2; ++iStep) {
+            validationMetricSteps = testSteps.Train(indexFeatureCombination);
+         }
+      }
+   }
+
+   // binning in the same pass as the update adds up the same numbers in the same order, so the models are identical
+   CHECK(validationMetricSteps == validationMetricCycles);
+   for(size_t iClass = 0; iClass < 3; ++iClass) {
+      CHECK(testSteps.GetCurrentModelPredictorScore(0, {}, iClass) == testCycles.GetCurrentModelPredictorScore(0, {}, iClass));
+      for(size_t bin0 = 0; bin0 < 7; ++bin0) {
+         CHECK(testSteps.GetCurrentModelPredictorScore(1, { bin0 }, iClass) == testCycles.GetCurrentModelPredictorScore(1, { bin0 }, iClass));
+         for(size_t bin1 = 0; bin1 < 5; ++bin1) {
+            CHECK(testSteps.GetCurrentModelPredictorScore(2, { bin0, bin1 }, iClass) == testCycles.GetCurrentModelPredictorScore(2, { bin0, bin1 }, iClass));
+         }
+      }
+   }
+}
+
+TEST_CASE("BoostCycles bins each next feature combination in chunks while applying the update, training, binary") {
+   // enough instances that the histograms are binned in more than one chunk
+   std::vector<ClassificationInstance> trainingInstances;
+   std::vector<ClassificationInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 140000; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 7;
+      const IntegerDataType bin1 = (iInstance * 13) % 5;
+      trainingInstances.push_back(ClassificationInstance((bin0 + bin1 + iInstance / 1000) % 2, { bin0, bin1 }));
+      if(0 == iInstance % 100) {
+         validationInstances.push_back(ClassificationInstance((bin0 * bin1) % 2, { bin0, bin1 }));
+      }
+   }
+
+   TestApi testCycles = TestApi(2);
+   testCycles.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testCycles.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   testCycles.AddTrainingInstances(trainingInstances);
+   testCycles.AddValidationInstances(validationInstances);
+   testCycles.InitializeTraining(2);
+   // with more threads, the update would be split into more chunks than the histograms, so we wouldn't fuse
+   testCycles.SetTrainingThreads(1);
+
+   TestApi testSteps = TestApi(2);
+   testSteps.AddFeatures({ FeatureTest(7), FeatureTest(5) });
+   testSteps.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   testSteps.AddTrainingInstances(trainingInstances);
+   testSteps.AddValidationInstances(validationInstances);
+   testSteps.InitializeTraining(2);
+
+   const FractionalDataType validationMetricCycles = testCycles.Boost({ 0, 1, 2 }, 2, -1, 0, nullptr);
+
+   FractionalDataType validationMetricSteps = 0;
+   for(int iEpisode = 0; iEpisode < 2; ++iEpisode) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+         validationMetricSteps = testSteps.Train(iFeatureCombination);
+      }
+   }
+
+   CHECK(validationMetricSteps == validationMetricCycles);
+   for(size_t bin0 = 0; bin0 < 7; ++bin0) {
+      CHECK(testSteps.GetCurrentModelPredictorScore(0, { bin0 }, 0) == testCycles.GetCurrentModelPredictorScore(0, { bin0 }, 0));
+      for(size_t bin1 = 0; bin1 < 5; ++bin1) {
+         CHECK(testSteps.GetCurrentModelPredictorScore(2, { bin0, bin1 }, 0) == testCycles.GetCurrentModelPredictorScore(2, { bin0, bin1 }, 0));
+      }
+   }
+}
+
+TEST_CASE("an ensemble with one bag matches training on the split directly, training, regression") {
+   constexpr IntegerDataType countInstances = 300;
+   std::vector<FractionalDataType> targets;
+   std::vector<IntegerDataType> binnedData(2 * countInstances);
+   std::vector<IntegerDataType> validationMask;
+   std::vector<RegressionInstance> trainingInstances;
+   std::vector<RegressionInstance> validationInstances;
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const IntegerDataType bin0 = iInstance % 4;
+      const IntegerDataType bin1 = (iInstance * 7) % 3;
+      const FractionalDataType target = static_cast<FractionalDataType>(bin0 + 2 * bin1) + static_cast<FractionalDataType>(iInstance % 5) * 0.125;
+      const bool bValidation = 0 == iInstance % 4;
+      targets.push_back(target);
+      binnedData[iInstance] = bin0;
+      binnedData[countInstances + iInstance] = bin1;
+      validationMask.push_back(bValidation ? 1 : 0);
+      (bValidation ? validationInstances : trainingInstances).push_back(RegressionInstance(target, { bin0, bin1 }));
+   }
+
+   TestApi test = TestApi(k_learningTypeRegression);
+   test.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   test.AddFeatureCombinations({ { 0 }, { 1 } });
+   test.AddTrainingInstances(trainingInstances);
+   test.AddValidationInstances(validationInstances);
+   test.InitializeTraining(3);
+   IntegerDataType countEpisodes = -1;
+   const FractionalDataType validationMetric = test.Boost({ 0, 1 }, 1000, 10, 1e-5, &countEpisodes);
+
+   const EbmCoreFeature features[] = { { FeatureTypeOrdinal, 0, 4 }, { FeatureTypeOrdinal, 0, 3 } };
+   const EbmCoreFeatureCombination featureCombinations[] = { { 1 }, { 1 } };
+   const IntegerDataType featureCombinationIndexes[] = { 0, 1 };
+   const IntegerDataType randomSeeds[] = { randomSeed };
+   PEbmEnsembleTraining pEbmEnsembleTraining = InitializeEnsembleTrainingRegression(1, randomSeeds, 2, features, 2, featureCombinations, featureCombinationIndexes, countInstances, &targets[0], &binnedData[0], nullptr, &validationMask[0], 3);
+   CHECK(nullptr != pEbmEnsembleTraining);
+   FractionalDataType validationMetricEnsemble = 0;
+   IntegerDataType countEpisodesEnsemble = -1;
+   CHECK(0 == BoostEnsembleCycles(pEbmEnsembleTraining, 2, featureCombinationIndexes, 1000, 1, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, 10, 1e-5, &validationMetricEnsemble, &countEpisodesEnsemble));
+
+   CHECK(countEpisodes < 1000);
+   CHECK(countEpisodes == countEpisodesEnsemble);
+   CHECK(validationMetric == validationMetricEnsemble);
+   FractionalDataType averageModel[4];
+   FractionalDataType standardDeviation[4];
+   CHECK(0 == GetEnsembleModelFeatureCombination(pEbmEnsembleTraining, 0, averageModel, standardDeviation));
+   for(size_t bin0 = 0; bin0 < 4; ++bin0) {
+      CHECK(test.GetBestModelPredictorScore(0, { bin0 }, 0) == averageModel[bin0]);
+      CHECK(0 == standardDeviation[bin0]);
+   }
+   CHECK(0 == GetEnsembleModelFeatureCombination(pEbmEnsembleTraining, 1, averageModel, nullptr));
+   for(size_t bin1 = 0; bin1 < 3; ++bin1) {
+      CHECK(test.GetBestModelPredictorScore(1, { bin1 }, 0) == averageModel[bin1]);
+   }
+   FreeEnsembleTraining(pEbmEnsembleTraining);
+}
+
+TEST_CASE("an ensemble averages the best models of its bags, training, binary") {
+   constexpr IntegerDataType countInstances = 200;
+   constexpr IntegerDataType countBags = 3;
+   std::vector<IntegerDataType> targets;
+   std::vector<IntegerDataType> binnedData(countInstances);
+   std::vector<IntegerDataType> validationMasks;
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const IntegerDataType bin0 = (iInstance * 3) % 5;
+      targets.push_back((bin0 + iInstance / 50) % 2);
+      binnedData[iInstance] = bin0;
+   }
+   for(IntegerDataType iBag = 0; iBag < countBags; ++iBag) {
+      for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+         validationMasks.push_back(iBag == iInstance % 5 ? 1 : 0);
+      }
+   }
+
+   const EbmCoreFeature features[] = { { FeatureTypeOrdinal, 0, 5 } };
+   const EbmCoreFeatureCombination featureCombinations[] = { { 1 } };
+   const IntegerDataType featureCombinationIndexes[] = { 0 };
+   const IntegerDataType randomSeeds[] = { randomSeed, randomSeed, randomSeed };
+   PEbmEnsembleTraining pEbmEnsembleTraining = InitializeEnsembleTrainingClassification(countBags, randomSeeds, 1, features, 1, featureCombinations, featureCombinationIndexes, 2, countInstances, &targets[0], &binnedData[0], nullptr, &validationMasks[0], 2);
+   CHECK(nullptr != pEbmEnsembleTraining);
+   CHECK(0 == SetEnsembleTrainingThreadCount(pEbmEnsembleTraining, 2));
+   FractionalDataType validationMetrics[countBags];
+   IntegerDataType countEpisodesReturn[countBags];
+   CHECK(0 == BoostEnsembleCycles(pEbmEnsembleTraining, 1, featureCombinationIndexes, 300, 1, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, 20, 1e-5, validationMetrics, countEpisodesReturn));
+   FractionalDataType averageModel[5];
+   FractionalDataType standardDeviation[5];
+   CHECK(0 == GetEnsembleModelFeatureCombination(pEbmEnsembleTraining, 0, averageModel, standardDeviation));
+   FreeEnsembleTraining(pEbmEnsembleTraining);
+
+   FractionalDataType sums[5] = { 0, 0, 0, 0, 0 };
+   FractionalDataType bagModels[countBags][5];
+   for(IntegerDataType iBag = 0; iBag < countBags; ++iBag) {
+      std::vector<ClassificationInstance> trainingInstances;
+      std::vector<ClassificationInstance> validationInstances;
+      for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+         const ClassificationInstance instance = ClassificationInstance(targets[iInstance], { binnedData[iInstance] });
+         (0 != validationMasks[iBag * countInstances + iInstance] ? validationInstances : trainingInstances).push_back(instance);
+      }
+      TestApi test = TestApi(2);
+      test.AddFeatures({ FeatureTest(5) });
+      test.AddFeatureCombinations({ { 0 } });
+      test.AddTrainingInstances(trainingInstances);
+      test.AddValidationInstances(validationInstances);
+      test.InitializeTraining(2);
+      IntegerDataType countEpisodes = -1;
+      const FractionalDataType validationMetric = test.Boost({ 0 }, 300, 20, 1e-5, &countEpisodes);
+      CHECK(validationMetric == validationMetrics[iBag]);
+      CHECK(countEpisodes == countEpisodesReturn[iBag]);
+      for(size_t bin0 = 0; bin0 < 5; ++bin0) {
+         bagModels[iBag][bin0] = test.GetBestModelPredictorScore(0, { bin0 }, 1);
+         sums[bin0] += bagModels[iBag][bin0];
+      }
+   }
+   bool bBagsDiffer = false;
+   for(size_t bin0 = 0; bin0 < 5; ++bin0) {
+      const FractionalDataType average = sums[bin0] / countBags;
+      CHECK(average == averageModel[bin0]);
+      FractionalDataType sumSquares = 0;
+      for(IntegerDataType iBag = 0; iBag < countBags; ++iBag) {
+         sumSquares += (bagModels[iBag][bin0] - average) * (bagModels[iBag][bin0] - average);
+         bBagsDiffer = bBagsDiffer || bagModels[iBag][bin0] != bagModels[0][bin0];
+      }
+      CHECK(std::sqrt(sumSquares / countBags) == standardDeviation[bin0]);
+   }
+   // otherwise the standard deviation check isn't checking anything
+   CHECK(bBagsDiffer);
+}
+
+TEST_CASE("batch scoring adds the intercept and each model in order, scoring, multiclass") {
+   constexpr IntegerDataType countScores = 3;
+   constexpr IntegerDataType countInstances = 1000;
+   EbmCoreFeature features[3];
+   const IntegerDataType countBins[] = { 3, 1, 4 };
+   for(size_t iFeature = 0; iFeature < 3; ++iFeature) {
+      features[iFeature].featureType = FeatureTypeOrdinal;
+      features[iFeature].hasMissing = 0;
+      features[iFeature].countBins = countBins[iFeature];
+   }
+   // a zero dimensional model, a main, a pair with a one bin feature, and a pair that we skip
+   EbmCoreFeatureCombination combinations[4];
+   combinations[0].countFeaturesInCombination = 0;
+   combinations[1].countFeaturesInCombination = 1;
+   combinations[2].countFeaturesInCombination = 2;
+   combinations[3].countFeaturesInCombination = 2;
+   const IntegerDataType combinationIndexes[] = { 0, 1, 2, 0, 2 };
+
+   std::vector<FractionalDataType> model0;
+   std::vector<FractionalDataType> model1;
+   std::vector<FractionalDataType> model2;
+   for(size_t iValue = 0; iValue < countScores; ++iValue) {
+      model0.push_back(0.25 * static_cast<FractionalDataType>(iValue) - 0.5);
+   }
+   for(size_t iValue = 0; iValue < 3 * countScores; ++iValue) {
+      model1.push_back(0.1 * static_cast<FractionalDataType>(iValue) - 0.3);
+   }
+   for(size_t iValue = 0; iValue < 1 * 4 * countScores; ++iValue) {
+      model2.push_back(0.7 - 0.15 * static_cast<FractionalDataType>(iValue));
+   }
+   const FractionalDataType * const models[] = { &model0[0], &model1[0], &model2[0], nullptr };
+   const FractionalDataType intercept[] = { 0.5, -1.5, 2.0 };
+
+   std::vector<uint8_t> instanceMajor;
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      instanceMajor.push_back(static_cast<uint8_t>(iInstance % 3));
+      instanceMajor.push_back(0);
+      instanceMajor.push_back(static_cast<uint8_t>((iInstance * 7) % 4));
+   }
+   const EbmCoreBinnedData binnedData = { BinnedDataTypeUInt8, 3, 1, &instanceMajor[0] };
+
+   std::vector<FractionalDataType> logits(countInstances * countScores);
+   std::vector<FractionalDataType> probabilities(countInstances * countScores);
+   CHECK(0 == ScoreBinnedInstances(countScores, 3, features, 4, combinations, combinationIndexes, models, intercept, countInstances, &binnedData, ScoreLinkIdentity, &logits[0]));
+   CHECK(0 == ScoreBinnedInstances(countScores, 3, features, 4, combinations, combinationIndexes, models, intercept, countInstances, &binnedData, ScoreLinkSoftmax, &probabilities[0]));
+   for(size_t iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const size_t bin0 = iInstance % 3;
+      const size_t bin2 = (iInstance * 7) % 4;
+      FractionalDataType expected[countScores];
+      for(size_t iScore = 0; iScore < countScores; ++iScore) {
+         expected[iScore] = intercept[iScore];
+         expected[iScore] += model0[iScore];
+         expected[iScore] += model1[bin0 * countScores + iScore];
+         expected[iScore] += model2[bin2 * countScores + iScore];
+         CHECK(expected[iScore] == logits[iInstance * countScores + iScore]);
+      }
+      FractionalDataType sum = 0;
+      for(size_t iScore = 0; iScore < countScores; ++iScore) {
+         sum += std::exp(expected[iScore]);
+      }
+      for(size_t iScore = 0; iScore < countScores; ++iScore) {
+         CHECK_APPROX(probabilities[iInstance * countScores + iScore], std::exp(expected[iScore]) / sum);
+      }
+   }
+}
+
+TEST_CASE("batch scoring links and argument checks, scoring, binary") {
+   constexpr IntegerDataType countInstances = 37;
+   EbmCoreFeature features[2];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 2;
+   features[1].featureType = FeatureTypeOrdinal;
+   features[1].hasMissing = 0;
+   features[1].countBins = 3;
+   EbmCoreFeatureCombination combinations[2];
+   combinations[0].countFeaturesInCombination = 1;
+   combinations[1].countFeaturesInCombination = 2;
+   const IntegerDataType combinationIndexes[] = { 1, 0, 1 };
+   const FractionalDataType model0[] = { -1.0, 0.5, 2.0 };
+   // the first feature of a pair varies fastest
+   const FractionalDataType model1[] = { 0.0, 0.1, 0.2, 0.3, 0.4, 800.0 };
+   const FractionalDataType * const models[] = { model0, model1 };
+   const FractionalDataType intercept = -0.25;
+
+   std::vector<IntegerDataType> featureMajor(2 * countInstances);
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      featureMajor[iInstance] = iInstance % 2;
+      featureMajor[countInstances + iInstance] = (iInstance / 2) % 3;
+   }
+   const EbmCoreBinnedData binnedData = { BinnedDataTypeInt64, 1, countInstances, &featureMajor[0] };
+
+   std::vector<FractionalDataType> logits(countInstances);
+   std::vector<FractionalDataType> sigmoid(countInstances);
+   std::vector<FractionalDataType> softmax(2 * countInstances);
+   CHECK(0 == ScoreBinnedInstances(1, 2, features, 2, combinations, combinationIndexes, models, &intercept, countInstances, &binnedData, ScoreLinkIdentity, &logits[0]));
+   CHECK(0 == ScoreBinnedInstances(1, 2, features, 2, combinations, combinationIndexes, models, &intercept, countInstances, &binnedData, ScoreLinkSigmoid, &sigmoid[0]));
+   CHECK(0 == ScoreBinnedInstances(1, 2, features, 2, combinations, combinationIndexes, models, &intercept, countInstances, &binnedData, ScoreLinkSoftmax, &softmax[0]));
+   for(size_t iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const size_t bin0 = iInstance % 2;
+      const size_t bin1 = (iInstance / 2) % 3;
+      CHECK(intercept + model0[bin1] + model1[bin1 * 2 + bin0] == logits[iInstance]);
+      // the largest logit is far past where exp overflows, and both links still give finite probabilities
+      CHECK(0 <= sigmoid[iInstance] && sigmoid[iInstance] <= 1);
+      CHECK_APPROX(sigmoid[iInstance], 1 / (1 + std::exp(-logits[iInstance])));
+      CHECK_APPROX(softmax[iInstance * 2 + 1], sigmoid[iInstance]);
+      CHECK_APPROX(softmax[iInstance * 2] + softmax[iInstance * 2 + 1], 1);
+   }
+
+   // the same bins held in doubles, the way R stores them, score the same
+   std::vector<double> featureMajorFloat64(featureMajor.begin(), featureMajor.end());
+   const EbmCoreBinnedData binnedDataFloat64 = { BinnedDataTypeFloat64, 1, countInstances, &featureMajorFloat64[0] };
+   std::vector<FractionalDataType> logitsFloat64(countInstances);
+   CHECK(0 == ScoreBinnedInstances(1, 2, features, 2, combinations, combinationIndexes, models, &intercept, countInstances, &binnedDataFloat64, ScoreLinkIdentity, &logitsFloat64[0]));
+   CHECK(logits == logitsFloat64);
+
+   // sigmoid needs a single logit, and feature indexes, links and bin counts are checked
+   const IntegerDataType badCombinationIndexes[] = { 1, 0, 2 };
+   EbmCoreFeature badFeatures[2] = { features[0], features[1] };
+   badFeatures[0].countBins = 0;
+   CHECK(0 != ScoreBinnedInstances(2, 2, features, 2, combinations, combinationIndexes, models, nullptr, countInstances, &binnedData, ScoreLinkSigmoid, &softmax[0]));
+   CHECK(0 != ScoreBinnedInstances(1, 2, features, 2, combinations, combinationIndexes, models, nullptr, countInstances, &binnedData, 3, &softmax[0]));
+   CHECK(0 != ScoreBinnedInstances(1, 2, features, 2, combinations, badCombinationIndexes, models, nullptr, countInstances, &binnedData, ScoreLinkIdentity, &softmax[0]));
+   CHECK(0 != ScoreBinnedInstances(1, 2, badFeatures, 2, combinations, combinationIndexes, models, nullptr, countInstances, &binnedData, ScoreLinkIdentity, &softmax[0]));
+   CHECK(0 == ScoreBinnedInstances(1, 2, features, 2, combinations, combinationIndexes, models, nullptr, 0, &binnedData, ScoreLinkIdentity, nullptr));
+}
+
+TEST_CASE("raw scoring bins like the binned scorer, scoring, multiclass") {
+   constexpr IntegerDataType countScores = 2;
+   constexpr IntegerDataType countCategories = 40;
+   EbmCoreFeature features[3];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 5;
+   features[1].featureType = FeatureTypeNominal;
+   features[1].hasMissing = 0;
+   features[1].countBins = countCategories;
+   // nothing uses this feature, so its values are never read
+   features[2].featureType = FeatureTypeOrdinal;
+   features[2].hasMissing = 0;
+   features[2].countBins = 3;
+   // repeated cut points are allowed, and leave an empty bin between them
+   const FractionalDataType cuts0[] = { -1.0, 0.0, 0.0, 2.5 };
+   const FractionalDataType cuts2[] = { 1.0, 2.0 };
+   const FractionalDataType * const featureCuts[] = { cuts0, nullptr, cuts2 };
+   std::vector<std::string> categoryStrings;
+   std::vector<const char *> categories1;
+   for(IntegerDataType iCategory = 0; iCategory < countCategories; ++iCategory) {
+      categoryStrings.push_back(0 == iCategory ? std::string() : "category " + std::to_string(iCategory * 7));
+   }
+   for(IntegerDataType iCategory = 0; iCategory < countCategories; ++iCategory) {
+      categories1.push_back(categoryStrings[iCategory].c_str());
+   }
+   const char * const * const featureCategories[] = { nullptr, &categories1[0], nullptr };
+
+   EbmCoreFeatureCombination combinations[3];
+   combinations[0].countFeaturesInCombination = 1;
+   combinations[1].countFeaturesInCombination = 1;
+   combinations[2].countFeaturesInCombination = 2;
+   const IntegerDataType combinationIndexes[] = { 0, 1, 0, 1 };
+   std::vector<FractionalDataType> model0(5 * countScores);
+   std::vector<FractionalDataType> model1(countCategories * countScores);
+   std::vector<FractionalDataType> model2(5 * countCategories * countScores);
+   for(size_t i = 0; i < model0.size(); ++i) {
+      model0[i] = static_cast<FractionalDataType>(i) * 0.5;
+   }
+   for(size_t i = 0; i < model1.size(); ++i) {
+      model1[i] = static_cast<FractionalDataType>(i) * -0.25;
+   }
+   for(size_t i = 0; i < model2.size(); ++i) {
+      model2[i] = static_cast<FractionalDataType>(i % 13) * 0.125;
+   }
+   const FractionalDataType * const models[] = { &model0[0], &model1[0], &model2[0] };
+   const FractionalDataType intercept[] = { 0.75, -1.5 };
+
+   PEbmModel ebmModel = CompileModel(countScores, 3, features, featureCuts, featureCategories, 3, combinations, combinationIndexes, models, intercept);
+   CHECK(nullptr != ebmModel);
+
+   const FractionalDataType ordinalValues[] = { -2.0, -1.0, -0.5, 0.0, 1.0, 2.5, 3.0, -std::numeric_limits<FractionalDataType>::infinity(), std::numeric_limits<FractionalDataType>::infinity(), std::numeric_limits<FractionalDataType>::quiet_NaN() };
+   constexpr size_t cOrdinalValues = sizeof(ordinalValues) / sizeof(ordinalValues[0]);
+   constexpr IntegerDataType countInstances = 97;
+   std::vector<FractionalDataType> values(3 * countInstances);
+   std::vector<const char *> categories(3 * countInstances);
+   std::vector<IntegerDataType> featureMajor(3 * countInstances);
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      const FractionalDataType value = ordinalValues[iInstance % cOrdinalValues];
+      // np.digitize puts a value after every cut point that is not greater than it, and NaN after all of them
+      IntegerDataType bin0 = 0;
+      for(const FractionalDataType cut : cuts0) {
+         bin0 += std::isnan(value) || cut <= value ? 1 : 0;
+      }
+      IntegerDataType bin1 = iInstance % (countCategories + 2);
+      const char * category;
+      if(countCategories == bin1) {
+         category = "an unknown category";
+         bin1 = 0;
+      } else if(countCategories + 1 == bin1) {
+         category = nullptr;
+         bin1 = 0;
+      } else {
+         category = categories1[bin1];
+      }
+      values[iInstance * 3] = value;
+      values[iInstance * 3 + 1] = std::numeric_limits<FractionalDataType>::quiet_NaN();
+      values[iInstance * 3 + 2] = std::numeric_limits<FractionalDataType>::quiet_NaN();
+      categories[iInstance * 3] = nullptr;
+      categories[iInstance * 3 + 1] = category;
+      categories[iInstance * 3 + 2] = nullptr;
+      featureMajor[iInstance] = bin0;
+      featureMajor[countInstances + iInstance] = bin1;
+      featureMajor[2 * countInstances + iInstance] = 0;
+   }
+   const EbmCoreBinnedData binnedData = { BinnedDataTypeInt64, 1, countInstances, &featureMajor[0] };
+
+   std::vector<FractionalDataType> expected(countScores * countInstances);
+   std::vector<FractionalDataType> raw(countScores * countInstances);
+   CHECK(0 == ScoreBinnedInstances(countScores, 3, features, 3, combinations, combinationIndexes, models, intercept, countInstances, &binnedData, ScoreLinkIdentity, &expected[0]));
+   CHECK(0 == ScoreRawInstances(ebmModel, countInstances, &values[0], &categories[0], ScoreLinkIdentity, &raw[0]));
+   for(size_t i = 0; i < expected.size(); ++i) {
+      CHECK(expected[i] == raw[i]);
+   }
+   CHECK(0 == ScoreBinnedInstances(countScores, 3, features, 3, combinations, combinationIndexes, models, intercept, countInstances, &binnedData, ScoreLinkSoftmax, &expected[0]));
+   CHECK(0 == ScoreRawInstances(ebmModel, countInstances, &values[0], &categories[0], ScoreLinkSoftmax, &raw[0]));
+   for(size_t i = 0; i < expected.size(); ++i) {
+      CHECK(expected[i] == raw[i]);
+   }
+   FreeModel(ebmModel);
+}
+
+TEST_CASE("raw scoring rejects bad cuts and categories, scoring, binary") {
+   EbmCoreFeature features[2];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 3;
+   features[1].featureType = FeatureTypeNominal;
+   features[1].hasMissing = 0;
+   features[1].countBins = 3;
+   const FractionalDataType cuts[] = { 1.0, 2.0 };
+   const FractionalDataType descendingCuts[] = { 2.0, 1.0 };
+   const FractionalDataType nanCuts[] = { 1.0, std::numeric_limits<FractionalDataType>::quiet_NaN() };
+   const char * const categories[] = { "a", "b", "c" };
+   const char * const duplicateCategories[] = { "a", "b", "a" };
+   const FractionalDataType * const featureCuts[] = { cuts, nullptr };
+   const FractionalDataType * const descendingFeatureCuts[] = { descendingCuts, nullptr };
+   const FractionalDataType * const nanFeatureCuts[] = { nanCuts, nullptr };
+   const char * const * const featureCategories[] = { nullptr, categories };
+   const char * const * const duplicateFeatureCategories[] = { nullptr, duplicateCategories };
+   EbmCoreFeatureCombination combination;
+   combination.countFeaturesInCombination = 2;
+   const IntegerDataType combinationIndexes[] = { 0, 1 };
+   const FractionalDataType model[] = { 0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0 };
+   const FractionalDataType * const models[] = { model };
+
+   CHECK(nullptr == CompileModel(1, 2, features, descendingFeatureCuts, featureCategories, 1, &combination, combinationIndexes, models, nullptr));
+   CHECK(nullptr == CompileModel(1, 2, features, nanFeatureCuts, featureCategories, 1, &combination, combinationIndexes, models, nullptr));
+   CHECK(nullptr == CompileModel(1, 2, features, featureCuts, duplicateFeatureCategories, 1, &combination, combinationIndexes, models, nullptr));
+   CHECK(nullptr == CompileModel(1, 2, features, featureCuts, nullptr, 1, &combination, combinationIndexes, models, nullptr));
+
+   PEbmModel ebmModel = CompileModel(1, 2, features, featureCuts, featureCategories, 1, &combination, combinationIndexes, models, nullptr);
+   CHECK(nullptr != ebmModel);
+   const FractionalDataType values[] = { 1.5, 0.0, 7.0, 0.0 };
+   const char * const instanceCategories[] = { nullptr, "c", nullptr, "b" };
+   FractionalDataType scores[4];
+   CHECK(0 == ScoreRawInstances(ebmModel, 2, values, instanceCategories, ScoreLinkIdentity, scores));
+   // the first feature of a pair varies fastest
+   CHECK(7.0 == scores[0]);
+   CHECK(5.0 == scores[1]);
+   CHECK(0 == ScoreRawInstances(ebmModel, 2, values, instanceCategories, ScoreLinkSoftmax, scores));
+   CHECK_APPROX(scores[1], 1 / (1 + std::exp(-7.0)));
+   CHECK_APPROX(scores[0] + scores[1], 1);
+   CHECK(0 != ScoreRawInstances(ebmModel, 2, nullptr, instanceCategories, ScoreLinkIdentity, scores));
+   CHECK(0 != ScoreRawInstances(ebmModel, 2, values, nullptr, ScoreLinkIdentity, scores));
+   CHECK(0 != ScoreRawInstances(ebmModel, 2, values, instanceCategories, 3, scores));
+   FreeModel(ebmModel);
+}
+
+TEST_CASE("a model file written from training maps back and scores like the compiled model, scoring, multiclass") {
+   constexpr IntegerDataType countTargetClasses = 3;
+   constexpr IntegerDataType countInstances = 151;
+   EbmCoreFeature features[2];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 4;
+   features[1].featureType = FeatureTypeOrdinal;
+   features[1].hasMissing = 0;
+   features[1].countBins = 3;
+   // the tensors don't depend on how a feature is binned, so a compiled model can look up the same bins of the second feature by category
+   EbmCoreFeature nominalFeatures[2] = { features[0], features[1] };
+   nominalFeatures[1].featureType = FeatureTypeNominal;
+   EbmCoreFeatureCombination combinations[2];
+   combinations[0].countFeaturesInCombination = 1;
+   combinations[1].countFeaturesInCombination = 2;
+   const IntegerDataType combinationIndexes[] = { 1, 0, 1 };
+   const FractionalDataType cuts0[] = { -1.0, 0.5, 3.0 };
+   const FractionalDataType cuts1[] = { 10.0, 20.0 };
+   const FractionalDataType * const featureCuts[] = { cuts0, cuts1 };
+   const char * const categories1[] = { "red", "green", "blue" };
+   const char * const * const featureCategories[] = { nullptr, categories1 };
+   const FractionalDataType intercept[] = { 0.25, -0.5, 0.125 };
+
+   std::vector<IntegerDataType> targets(countInstances);
+   std::vector<IntegerDataType> featureMajor(2 * countInstances);
+   for(IntegerDataType iInstance = 0; iInstance < countInstances; ++iInstance) {
+      featureMajor[iInstance] = iInstance % 4;
+      featureMajor[countInstances + iInstance] = (iInstance / 4) % 3;
+      targets[iInstance] = (iInstance % 4 + (iInstance / 4) % 3) % countTargetClasses;
+   }
+   PEbmTraining pEbmTraining = InitializeTrainingClassification(randomSeed, 2, features, 2, combinations, combinationIndexes, countTargetClasses, countInstances, &targets[0], &featureMajor[0], nullptr, countInstances, &targets[0], &featureMajor[0], nullptr, 0);
+   CHECK(nullptr != pEbmTraining);
+   for(IntegerDataType iEpoch = 0; iEpoch < 5; ++iEpoch) {
+      for(IntegerDataType iCombination = 0; iCombination < 2; ++iCombination) {
+         FractionalDataType validationMetric = 0;
+         CHECK(0 == TrainingStep(pEbmTraining, iCombination, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, nullptr, nullptr, &validationMetric));
+      }
+   }
+
+   const char * const path = "test_core_api_model.ebmmodel";
+   CHECK(0 == WriteTrainingModelFile(pEbmTraining, featureCuts, featureCategories, intercept, path));
+   PEbmModel ebmModelMapped = OpenModelFile(path);
+   CHECK(nullptr != ebmModelMapped);
+   const FractionalDataType * const models[] = { GetBestModelFeatureCombination(pEbmTraining, 0), GetBestModelFeatureCombination(pEbmTraining, 1) };
+   PEbmModel ebmModel = CompileModel(countTargetClasses, 2, nominalFeatures, featureCuts, featureCategories, 2, combinations, combinationIndexes, models, intercept);
+   CHECK(nullptr != ebmModel);
+
+   // each row lands in the same bins through the values of the ordinal model and the categories of the nominal one
+   const FractionalDataType values[] = { -3.0, 0.0, 0.5, 10.0, 2.0, 25.0, 9.0, 0.0, std::numeric_limits<FractionalDataType>::quiet_NaN(), 0.0 };
+   const char * const categories[] = { nullptr, "red", nullptr, "green", nullptr, "blue", nullptr, "purple", nullptr, nullptr };
+   constexpr IntegerDataType countRaw = 5;
+   FractionalDataType scores[countRaw * countTargetClasses];
+   FractionalDataType scoresMapped[countRaw * countTargetClasses];
+   CHECK(0 == ScoreRawInstances(ebmModel, countRaw, values, categories, ScoreLinkIdentity, scores));
+   CHECK(0 == ScoreRawInstances(ebmModelMapped, countRaw, values, categories, ScoreLinkIdentity, scoresMapped));
+   for(size_t i = 0; i < sizeof(scores) / sizeof(scores[0]); ++i) {
+      CHECK(scores[i] == scoresMapped[i]);
+   }
+   FreeModel(ebmModelMapped);
+   FreeTraining(pEbmTraining);
+
+   // a compiled model keeps its category tables in the file, and a mapped model can be written again
+   const char * const pathCopy = "test_core_api_model_copy.ebmmodel";
+   CHECK(0 == WriteModelFile(ebmModel, path));
+   ebmModelMapped = OpenModelFile(path);
+   CHECK(nullptr != ebmModelMapped);
+   CHECK(0 == WriteModelFile(ebmModelMapped, pathCopy));
+   FreeModel(ebmModelMapped);
+   ebmModelMapped = OpenModelFile(pathCopy);
+   CHECK(nullptr != ebmModelMapped);
+   CHECK(0 == ScoreRawInstances(ebmModelMapped, countRaw, values, categories, ScoreLinkIdentity, scoresMapped));
+   for(size_t i = 0; i < sizeof(scores) / sizeof(scores[0]); ++i) {
+      CHECK(scores[i] == scoresMapped[i]);
+   }
+   FreeModel(ebmModelMapped);
+   FreeModel(ebmModel);
+
+   // a missing file, a truncated file, and a file that isn't a model are rejected
+   CHECK(nullptr == OpenModelFile("test_core_api_missing.ebmmodel"));
+   std::vector<char> file;
+   FILE * pFile = fopen(path, "rb");
+   CHECK(nullptr != pFile);
+   char buffer[256];
+   size_t cBytesRead;
+   while(0 != (cBytesRead = fread(buffer, 1, sizeof(buffer), pFile))) {
+      file.insert(file.end(), buffer, buffer + cBytesRead);
+   }
+   fclose(pFile);
+   pFile = fopen(pathCopy, "wb");
+   CHECK(nullptr != pFile);
+   CHECK(1 == fwrite(&file[0], file.size() - 1, 1, pFile));
+   fclose(pFile);
+   CHECK(nullptr == OpenModelFile(pathCopy));
+   file[0] = 'X';
+   pFile = fopen(pathCopy, "wb");
+   CHECK(nullptr != pFile);
+   CHECK(1 == fwrite(&file[0], file.size(), 1, pFile));
+   fclose(pFile);
+   CHECK(nullptr == OpenModelFile(pathCopy));
+   remove(pathCopy);
+   remove(path);
+}
+
+TEST_CASE("a quantized model scores within its max errors and maps back unchanged, scoring, regression") {
+   EbmCoreFeature features[2];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 3;
+   features[1].featureType = FeatureTypeNominal;
+   features[1].hasMissing = 0;
+   features[1].countBins = 3;
+   const FractionalDataType cuts[] = { 1.0, 2.0 };
+   const char * const categories[] = { "a", "b", "c" };
+   const FractionalDataType * const featureCuts[] = { cuts, nullptr };
+   const char * const * const featureCategories[] = { nullptr, categories };
+   EbmCoreFeatureCombination combinations[2];
+   combinations[0].countFeaturesInCombination = 1;
+   combinations[1].countFeaturesInCombination = 2;
+   const IntegerDataType combinationIndexes[] = { 0, 0, 1 };
+   // an odd number of items per tensor, so the quantized tensors need padding in the file
+   const FractionalDataType model0[] = { -1.5, 0.25, 2.0 };
+   const FractionalDataType model1[] = { 0.1, -0.7, 3.3, 1.0 / 3.0, 0.0, -2.25, 5.0, 0.6, -0.05 };
+   const FractionalDataType * const models[] = { model0, model1 };
+   const FractionalDataType intercept[] = { 0.5 };
+
+   FractionalDataType values[18];
+   const char * instanceCategories[18];
+   for(size_t iInstance = 0; iInstance < 9; ++iInstance) {
+      values[2 * iInstance] = static_cast<FractionalDataType>(iInstance % 3) + 0.5;
+      values[2 * iInstance + 1] = 0.0;
+      instanceCategories[2 * iInstance] = nullptr;
+      instanceCategories[2 * iInstance + 1] = categories[iInstance / 3];
+   }
+   PEbmModel ebmModel = CompileModel(1, 2, features, featureCuts, featureCategories, 2, combinations, combinationIndexes, models, intercept);
+   CHECK(nullptr != ebmModel);
+   FractionalDataType scores[9];
+   CHECK(0 == ScoreRawInstances(ebmModel, 9, values, instanceCategories, ScoreLinkIdentity, scores));
+   CHECK(0 != QuantizeModel(ebmModel, 12, nullptr));
+   FreeModel(ebmModel);
+
+   const char * const path = "test_core_api_quantized.ebmmodel";
+   const IntegerDataType aCountBits[] = { 8, 16 };
+   for(const IntegerDataType countBits : aCountBits) {
+      ebmModel = CompileModel(1, 2, features, featureCuts, featureCategories, 2, combinations, combinationIndexes, models, intercept);
+      CHECK(nullptr != ebmModel);
+      FractionalDataType maxErrors[2];
+      CHECK(0 == QuantizeModel(ebmModel, countBits, maxErrors));
+      CHECK(0 != QuantizeModel(ebmModel, countBits, nullptr));
+      // half a step of each term's range
+      CHECK(maxErrors[0] <= 3.5 / ((1 << countBits) - 1) / 2 * 1.000001);
+      CHECK(maxErrors[1] <= 7.25 / ((1 << countBits) - 1) / 2 * 1.000001);
+      FractionalDataType scoresQuantized[9];
+      CHECK(0 == ScoreRawInstances(ebmModel, 9, values, instanceCategories, ScoreLinkIdentity, scoresQuantized));
+      for(size_t i = 0; i < 9; ++i) {
+         CHECK(std::abs(scores[i] - scoresQuantized[i]) <= (maxErrors[0] + maxErrors[1]) * 1.000001);
+      }
+
+      CHECK(0 == WriteModelFile(ebmModel, path));
+      FreeModel(ebmModel);
+      ebmModel = OpenModelFile(path);
+      CHECK(nullptr != ebmModel);
+      CHECK(0 != QuantizeModel(ebmModel, countBits, nullptr));
+      FractionalDataType scoresMapped[9];
+      CHECK(0 == ScoreRawInstances(ebmModel, 9, values, instanceCategories, ScoreLinkIdentity, scoresMapped));
+      for(size_t i = 0; i < 9; ++i) {
+         CHECK(scoresQuantized[i] == scoresMapped[i]);
+      }
+      FreeModel(ebmModel);
+   }
+   remove(path);
+}
+
+TEST_CASE("raw scoring on threads matches scoring one instance at a time, scoring, binary and multiclass") {
+   EbmCoreFeature features[3];
+   features[0].featureType = FeatureTypeOrdinal;
+   features[0].hasMissing = 0;
+   features[0].countBins = 5;
+   features[1].featureType = FeatureTypeNominal;
+   features[1].hasMissing = 0;
+   features[1].countBins = 3;
+   features[2].featureType = FeatureTypeOrdinal;
+   features[2].hasMissing = 0;
+   features[2].countBins = 4;
+   const FractionalDataType cuts0[] = { -1.0, 0.0, 1.0, 2.0 };
+   const FractionalDataType cuts2[] = { 10.0, 20.0, 30.0 };
+   const char * const categories1[] = { "x", "y", "z" };
+   const FractionalDataType * const featureCuts[] = { cuts0, nullptr, cuts2 };
+   const char * const * const featureCategories[] = { nullptr, categories1, nullptr };
+   EbmCoreFeatureCombination combinations[3];
+   combinations[0].countFeaturesInCombination = 1;
+   combinations[1].countFeaturesInCombination = 2;
+   combinations[2].countFeaturesInCombination = 1;
+   const IntegerDataType combinationIndexes[] = { 0, 1, 2, 2 };
+
+   // more instances than fit in one chunk, and a count that leaves a partial block and a partial vector at the end
+   constexpr size_t cInstances = 10007;
+   std::vector<FractionalDataType> values(3 * cInstances);
+   std::vector<const char *> categories(3 * cInstances);
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      values[3 * iInstance] = static_cast<FractionalDataType>(iInstance % 7) * 0.75 - 2.0;
+      values[3 * iInstance + 2] = static_cast<FractionalDataType>(iInstance % 41);
+      categories[3 * iInstance + 1] = 0 == iInstance % 5 ? nullptr : categories1[iInstance % 3];
+   }
+
+   for(size_t cScores = 1; cScores <= 3; cScores += 2) {
+      std::vector<FractionalDataType> model0(5 * cScores);
+      std::vector<FractionalDataType> model1(3 * 4 * cScores);
+      std::vector<FractionalDataType> model2(4 * cScores);
+      for(size_t i = 0; i < model0.size(); ++i) {
+         model0[i] = 0.125 * static_cast<FractionalDataType>(i) - 0.3;
+      }
+      for(size_t i = 0; i < model1.size(); ++i) {
+         model1[i] = 1.0 / static_cast<FractionalDataType>(i + 3);
+      }
+      for(size_t i = 0; i < model2.size(); ++i) {
+         model2[i] = -0.0625 * static_cast<FractionalDataType>(i * i);
+      }
+      const FractionalDataType * const models[] = { &model0[0], &model1[0], &model2[0] };
+      const IntegerDataType link = 1 == cScores ? ScoreLinkSoftmax : ScoreLinkIdentity;
+      const size_t cOutputs = 1 == cScores ? 2 : cScores;
+
+      for(IntegerDataType countBits = 0; countBits <= 8; countBits += 8) {
+         PEbmModel ebmModel = CompileModel(static_cast<IntegerDataType>(cScores), 3, features, featureCuts, featureCategories, 3, combinations, combinationIndexes, models, nullptr);
+         CHECK(nullptr != ebmModel);
+         if(0 != countBits) {
+            CHECK(0 == QuantizeModel(ebmModel, countBits, nullptr));
+         }
+         std::vector<FractionalDataType> scoresSingle(cOutputs * cInstances);
+         for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+            CHECK(0 == ScoreRawInstances(ebmModel, 1, &values[3 * iInstance], &categories[3 * iInstance], link, &scoresSingle[cOutputs * iInstance]));
+         }
+         CHECK(0 != SetModelThreadCount(ebmModel, -1));
+         CHECK(0 == SetModelThreadCount(ebmModel, 4));
+         std::vector<FractionalDataType> scores(cOutputs * cInstances);
+         CHECK(0 == ScoreRawInstances(ebmModel, static_cast<IntegerDataType>(cInstances), &values[0], &categories[0], link, &scores[0]));
+         for(size_t i = 0; i < scores.size(); ++i) {
+            CHECK(scoresSingle[i] == scores[i]);
+         }
+         FreeModel(ebmModel);
+      }
+   }
+}
+
 TEST_CASE("zero FeatureCombinations, training, regression") {
    TestApi test = TestApi(k_learningTypeRegression);
    test.AddFeatures({});
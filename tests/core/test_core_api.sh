@@ -7,20 +7,37 @@ script_path=`dirname "$0"`
 root_path="$script_path/../.."
 
 build_core=1
+float_residuals=0
 for arg in "$@"; do
    if [ "$arg" = "-nobuildcore" ]; then
       build_core=0
    fi
+   if [ "$arg" = "-float_residuals" ]; then
+      float_residuals=1
+   fi
 done
 
+# the tests call the diagnostic functions in ebmcore_test_hooks.h, which only the -test_hooks build of the library has
+build_core_args="-32bit -test_hooks"
+library_suffix=""
+if [ $float_residuals -eq 1 ]; then
+   build_core_args="$build_core_args -float_residuals"
+   library_suffix="_float"
+fi
+library_suffix="${library_suffix}_test"
+
 if [ $build_core -eq 1 ]; then
    echo "Building Core library..."
-   /bin/sh "$root_path/build.sh" -32bit
+   /bin/sh "$root_path/build.sh" $build_core_args
 else
    echo "Core library NOT being built"
 fi
 
-compile_all="\"$root_path/tests/core/TestCoreApi.cpp\" -I\"$root_path/tests/core\" -I\"$root_path/core/inc\" -std=c++11 -fpermissive -O3 -march=core2"
+compile_all="\"$root_path/tests/core/TestCoreApi.cpp\" -I\"$root_path/tests/core\" -I\"$root_path/core/inc\" -std=c++11 -fpermissive -O3 -march=core2 -DEBM_TEST_HOOKS"
+if [ $float_residuals -eq 1 ]; then
+   # the tests loosen the checks that compare against double precision formulas when the library stores its residuals as floats
+   compile_all="$compile_all -DEBM_FLOAT_RESIDUALS"
+fi
 
 if [ "$os_type" = "Darwin" ]; then
    # reference on rpath & install_name: https://www.mikeash.com/pyblog/friday-qa-2009-11-06-linking-and-install-names.html
@@ -39,7 +56,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$clang_pp_bin $compile_mac -m64 -DNDEBUG -l_ebmcore_mac_x64 -o \"$root_path/tmp/clang/bin/release/mac/x64/TestCoreApi/test_core_api\" 2>&1"
+   compile_command="$clang_pp_bin $compile_mac -m64 -DNDEBUG -l_ebmcore_mac_x64${library_suffix} -o \"$root_path/tmp/clang/bin/release/mac/x64/TestCoreApi/test_core_api\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    echo -n "$compile_out"
@@ -47,7 +64,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/staging/lib_ebmcore_mac_x64.dylib" "$root_path/tmp/clang/bin/release/mac/x64/TestCoreApi/"
+   cp "$root_path/staging/lib_ebmcore_mac_x64${library_suffix}.dylib" "$root_path/tmp/clang/bin/release/mac/x64/TestCoreApi/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -69,7 +86,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$clang_pp_bin $compile_mac -m64 -l_ebmcore_mac_x64_debug -o \"$root_path/tmp/clang/bin/debug/mac/x64/TestCoreApi/test_core_api\" 2>&1"
+   compile_command="$clang_pp_bin $compile_mac -m64 -l_ebmcore_mac_x64${library_suffix}_debug -o \"$root_path/tmp/clang/bin/debug/mac/x64/TestCoreApi/test_core_api\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    echo -n "$compile_out"
@@ -77,7 +94,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/staging/lib_ebmcore_mac_x64_debug.dylib" "$root_path/tmp/clang/bin/debug/mac/x64/TestCoreApi/"
+   cp "$root_path/staging/lib_ebmcore_mac_x64${library_suffix}_debug.dylib" "$root_path/tmp/clang/bin/debug/mac/x64/TestCoreApi/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -99,7 +116,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$clang_pp_bin $compile_mac -m32 -DNDEBUG -l_ebmcore_mac_x86 -o \"$root_path/tmp/clang/bin/release/mac/x86/TestCoreApi/test_core_api\" 2>&1"
+   compile_command="$clang_pp_bin $compile_mac -m32 -DNDEBUG -l_ebmcore_mac_x86${library_suffix} -o \"$root_path/tmp/clang/bin/release/mac/x86/TestCoreApi/test_core_api\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    echo -n "$compile_out"
@@ -107,7 +124,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/staging/lib_ebmcore_mac_x86.dylib" "$root_path/tmp/clang/bin/release/mac/x86/TestCoreApi/"
+   cp "$root_path/staging/lib_ebmcore_mac_x86${library_suffix}.dylib" "$root_path/tmp/clang/bin/release/mac/x86/TestCoreApi/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -129,7 +146,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$clang_pp_bin $compile_mac -m32 -l_ebmcore_mac_x86_debug -o \"$root_path/tmp/clang/bin/debug/mac/x86/TestCoreApi/test_core_api\" 2>&1"
+   compile_command="$clang_pp_bin $compile_mac -m32 -l_ebmcore_mac_x86${library_suffix}_debug -o \"$root_path/tmp/clang/bin/debug/mac/x86/TestCoreApi/test_core_api\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    echo -n "$compile_out"
@@ -137,7 +154,7 @@ if [ "$os_type" = "Darwin" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/staging/lib_ebmcore_mac_x86_debug.dylib" "$root_path/tmp/clang/bin/debug/mac/x86/TestCoreApi/"
+   cp "$root_path/staging/lib_ebmcore_mac_x86${library_suffix}_debug.dylib" "$root_path/tmp/clang/bin/debug/mac/x86/TestCoreApi/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -166,7 +183,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$g_pp_bin $compile_linux -m64 -DNDEBUG -l_ebmcore_linux_x64 -o \"$root_path/tmp/gcc/bin/release/linux/x64/TestCoreApi/test_core_api\" 2>&1"
+   compile_command="$g_pp_bin $compile_linux -m64 -DNDEBUG -l_ebmcore_linux_x64${library_suffix} -o \"$root_path/tmp/gcc/bin/release/linux/x64/TestCoreApi/test_core_api\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    echo -n "$compile_out"
@@ -174,7 +191,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/staging/lib_ebmcore_linux_x64.so" "$root_path/tmp/gcc/bin/release/linux/x64/TestCoreApi/"
+   cp "$root_path/staging/lib_ebmcore_linux_x64${library_suffix}.so" "$root_path/tmp/gcc/bin/release/linux/x64/TestCoreApi/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -196,7 +213,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$g_pp_bin $compile_linux -m64 -l_ebmcore_linux_x64_debug -o \"$root_path/tmp/gcc/bin/debug/linux/x64/TestCoreApi/test_core_api\" 2>&1"
+   compile_command="$g_pp_bin $compile_linux -m64 -l_ebmcore_linux_x64${library_suffix}_debug -o \"$root_path/tmp/gcc/bin/debug/linux/x64/TestCoreApi/test_core_api\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    echo -n "$compile_out"
@@ -204,7 +221,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/staging/lib_ebmcore_linux_x64_debug.so" "$root_path/tmp/gcc/bin/debug/linux/x64/TestCoreApi/"
+   cp "$root_path/staging/lib_ebmcore_linux_x64${library_suffix}_debug.so" "$root_path/tmp/gcc/bin/debug/linux/x64/TestCoreApi/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -226,7 +243,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$g_pp_bin $compile_linux -m32 -DNDEBUG -l_ebmcore_linux_x86 -o \"$root_path/tmp/gcc/bin/release/linux/x86/TestCoreApi/test_core_api\" 2>&1"
+   compile_command="$g_pp_bin $compile_linux -m32 -DNDEBUG -l_ebmcore_linux_x86${library_suffix} -o \"$root_path/tmp/gcc/bin/release/linux/x86/TestCoreApi/test_core_api\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    echo -n "$compile_out"
@@ -234,7 +251,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/staging/lib_ebmcore_linux_x86.so" "$root_path/tmp/gcc/bin/release/linux/x86/TestCoreApi/"
+   cp "$root_path/staging/lib_ebmcore_linux_x86${library_suffix}.so" "$root_path/tmp/gcc/bin/release/linux/x86/TestCoreApi/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
@@ -256,7 +273,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   compile_command="$g_pp_bin $compile_linux -m32 -l_ebmcore_linux_x86_debug -o \"$root_path/tmp/gcc/bin/debug/linux/x86/TestCoreApi/test_core_api\" 2>&1"
+   compile_command="$g_pp_bin $compile_linux -m32 -l_ebmcore_linux_x86${library_suffix}_debug -o \"$root_path/tmp/gcc/bin/debug/linux/x86/TestCoreApi/test_core_api\" 2>&1"
    compile_out=`eval $compile_command`
    ret_code=$?
    echo -n "$compile_out"
@@ -264,7 +281,7 @@ elif [ "$os_type" = "Linux" ]; then
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code
    fi
-   cp "$root_path/staging/lib_ebmcore_linux_x86_debug.so" "$root_path/tmp/gcc/bin/debug/linux/x86/TestCoreApi/"
+   cp "$root_path/staging/lib_ebmcore_linux_x86${library_suffix}_debug.so" "$root_path/tmp/gcc/bin/debug/linux/x86/TestCoreApi/"
    ret_code=$?
    if [ $ret_code -ne 0 ]; then 
       exit $ret_code